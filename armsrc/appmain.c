@@ -2160,6 +2160,19 @@ static void PacketReceived(PacketCommandNG *packet) {
             reply_ng(CMD_HF_MIFARE_READBL, retval, outbuf, sizeof(outbuf));
             break;
         }
+        case CMD_HF_MIFARE_READBLS: {
+            mf_readblocks_t *payload = (mf_readblocks_t *)packet->data.asBytes;
+            mf_readblocks_resp_t resp = { .blockno = payload->blockno, .count = 0 };
+            int16_t retval = PM3_EINVARG;
+            if (payload->count > 0 && payload->count <= sizeof(resp.data) / 16) {
+                retval = mifare_cmd_readblocks(MF_WAKE_WUPA, MIFARE_AUTH_KEYA + (payload->keytype & 0xF), payload->key, ISO14443A_CMD_READBLOCK, payload->blockno, payload->count, resp.data);
+            }
+            if (retval == PM3_SUCCESS) {
+                resp.count = payload->count;
+            }
+            reply_ng(CMD_HF_MIFARE_READBLS, retval, (uint8_t *)&resp, 2 + (resp.count * 16));
+            break;
+        }
         case CMD_HF_MIFARE_READBL_EX: {
             mf_readblock_ex_t *payload = (mf_readblock_ex_t *)packet->data.asBytes;
             uint8_t outbuf[16];
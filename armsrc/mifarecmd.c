@@ -2452,27 +2452,29 @@ OUT:
 
     crypto1_deinit(pcs);
 
-    // All keys found, send to client, or last keychunk from client
-    if (foundkeys == allkeys || lastchunk) {
+    // keys found so far, sector table followed by the found bitmap
+    uint64_t foo = 0;
+    for (uint8_t m = 0; m < 64; m++) {
+        foo |= ((uint64_t)(found[m] & 1) << m);
+    }
 
-        uint64_t foo = 0;
-        for (uint8_t m = 0; m < 64; m++) {
-            foo |= ((uint64_t)(found[m] & 1) << m);
-        }
+    uint16_t bar = 0;
+    uint8_t j = 0;
+    for (uint8_t m = 64; m < ARRAYLEN(found); m++) {
+        bar |= ((uint16_t)(found[m] & 1) << j++);
+    }
 
-        uint16_t bar = 0;
-        uint8_t j = 0;
-        for (uint8_t m = 64; m < ARRAYLEN(found); m++) {
-            bar |= ((uint16_t)(found[m] & 1) << j++);
-        }
+    uint8_t tmp[480 + 10] = {0};
+    memcpy(tmp, k_sector, MIN(sectorcnt, 40) * sizeof(sector_t));
+    num_to_bytes(foo, 8, tmp + 480);
+    tmp[488] = bar & 0xFF;
+    tmp[489] = bar >> 8 & 0xFF;
 
-        uint8_t *tmp = BigBuf_calloc(480 + 10);
-        memcpy(tmp, k_sector, sectorcnt * sizeof(sector_t));
-        num_to_bytes(foo, 8, tmp + 480);
-        tmp[488] = bar & 0xFF;
-        tmp[489] = bar >> 8 & 0xFF;
+    // the table goes with every chunk reply, the client reorders the rest of its dictionary on it
+    reply_old(CMD_ACK, foundkeys, 0, 0, tmp, sizeof(tmp));
 
-        reply_old(CMD_ACK, foundkeys, 0, 0, tmp, 480 + 10);
+    // All keys found, or last keychunk from client
+    if (foundkeys == allkeys || lastchunk) {
 
         set_tracing(false);
         FpgaWriteConfWord(FPGA_MAJOR_MODE_OFF);
@@ -2503,9 +2505,6 @@ OUT:
             MifareECardLoad(sectorcnt, MF_KEY_A, NULL);
             MifareECardLoad(sectorcnt, MF_KEY_B, NULL);
         }
-    } else {
-        // partial/none keys found
-        reply_mix(CMD_ACK, foundkeys, 0, 0, 0, 0);
     }
 
     g_dbglevel = oldbg;
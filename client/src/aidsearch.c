@@ -19,39 +19,32 @@
 #include <ctype.h>
 #include <string.h>
 #include "fileutils.h"
+#include "rescache.h"
 #include "pm3_cmd.h"
 #include "util.h"
 
 static int openAIDFile(json_t **root, bool verbose) {
-    json_error_t error;
-
-    char *path;
-    int res = searchFile(&path, RESOURCES_SUBDIR, "aidlist", ".json", false);
-    if (res != PM3_SUCCESS) {
+    // parsed once per session, see rescache.c
+    *root = rescache_json_load("aidlist", ".json", false);
+    if (*root == NULL) {
         return PM3_EFILE;
     }
 
-    int retval = PM3_SUCCESS;
-    *root = json_load_file(path, 0, &error);
-    if (!*root) {
-        PrintAndLogEx(ERR, "json (%s) error on line %d: %s", path, error.line, error.text);
-        retval = PM3_ESOFT;
-        goto out;
-    }
+    char path[FILE_PATH_SIZE];
+    rescache_json_path(*root, path, sizeof(path));
 
     if (!json_is_array(*root)) {
         PrintAndLogEx(ERR, "Invalid json (%s) format. root must be an array.", path);
-        retval = PM3_ESOFT;
-        goto out;
+        json_decref(*root);
+        *root = NULL;
+        return PM3_ESOFT;
     }
 
     PrintAndLogEx(DEBUG, "Loaded file " _YELLOW_("%s") " " _GREEN_("%zu") " records ( " _GREEN_("ok") " )"
                   , path
                   , json_array_size(*root)
                  );
-out:
-    free(path);
-    return retval;
+    return PM3_SUCCESS;
 }
 
 static int closeAIDFile(json_t *root) {
@@ -101,17 +94,6 @@ static const char *jsonStrGet(json_t *data, const char *name) {
     return cstr;
 }
 
-static bool aidCompare(const char *aidlarge, const char *aidsmall) {
-    if (strcmp(aidlarge, aidsmall) == 0)
-        return true;
-
-    if (strlen(aidlarge) > strlen(aidsmall))
-        if (strncmp(aidlarge, aidsmall, strlen(aidsmall)) == 0)
-            return true;
-
-    return false;
-}
-
 bool AIDGetFromElm(json_t *data, uint8_t *aid, size_t aidmaxlen, int *aidlen) {
     *aidlen = 0;
     const char *hexaid = jsonStrGet(data, "AID");
@@ -193,43 +175,28 @@ int PrintAIDDescriptionEx(json_t *xroot, char *aid, const uint8_t *response, siz
 
     json_t *fallback_elm = NULL;
     json_t *contains_elm = NULL;
-    size_t maxaidlen = 0;
 
-    for (size_t elmindx = 0; elmindx < json_array_size(root); elmindx++) {
-        json_t *data = AIDSearchGetElm(root, elmindx);
-        if (data == NULL) {
-            continue;
-        }
-
-        const char *dictaid = jsonStrGet(data, "AID");
-        if (dictaid == NULL) {
-            continue;
-        }
-
-        if (!aidCompare(aid, dictaid)) {  // dictaid may be less length than requested aid
-            continue;
-        }
-
-        size_t dictaidlen = strlen(dictaid);
-        if (dictaidlen > strlen(aid)) {
-            continue;
-        }
+    // the longest dictionary AID the requested one starts with,
+    // looked up in the index one prefix length at a time
+    char *prefix = strdup(aid);
+    for (size_t plen = strlen(aid); prefix && plen > 0 && fallback_elm == NULL; plen--) {
+        prefix[plen] = '\0';
 
-        if (dictaidlen > maxaidlen) {
-            maxaidlen = dictaidlen;
-            fallback_elm = data;
-            contains_elm = NULL;
-        } else if (dictaidlen < maxaidlen) {
-            continue;
-        }
+        json_t *data;
+        for (size_t nth = 0; (data = rescache_json_find(root, "AID", prefix, nth)) != NULL; nth++) {
+            if (fallback_elm == NULL) {
+                fallback_elm = data;
+            }
 
-        if (response_hex != NULL) {
-            const char *response_regex = jsonStrGet(data, "ResponseRegex");
-            if (response_regex && str_regex_match_case_insensitive(response_regex, response_hex)) {
-                contains_elm = data;
+            if (response_hex != NULL) {
+                const char *response_regex = jsonStrGet(data, "ResponseRegex");
+                if (response_regex && str_regex_match_case_insensitive(response_regex, response_hex)) {
+                    contains_elm = data;
+                }
             }
         }
     }
+    free(prefix);
 
     json_t *elm = contains_elm ? contains_elm : fallback_elm;
     if (elm != NULL) {
@@ -29,6 +29,7 @@
 #include "crc.h"
 #include "crc16.h"        // crc16 ccitt
 #include "crc32.h"        // crc32_ex
+#include "crc64.h"        // crc64
 #include "legic_prng.h"
 #include "cmddata.h"      // g_DemodBuffer
 #include "graph.h"
@@ -37,6 +38,16 @@
 #include "generator.h"    // generate nuid
 #include "iso14b.h"       // defines for ETU conversions
 #include "util.h"         // regex utility
+#include "util_posix.h"   // msclock
+#include "cmdcrc.h"       // crc_search_*
+#include "pm3_bench.h"    // pm3_bench_run
+#include "fileutils.h"    // collect_file_paths_recursive
+#include "jansson.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/x509_crt.h"
+#include "emv/emv_roca.h" // emv_rocacheck_batch
+#include "emv/emv_oda.h"  // emv_oda_recover_keys
+#include "emv/emv_pk.h"
 
 static int CmdHelp(const char *Cmd);
 
@@ -271,26 +282,211 @@ static int CmdAnalyseLRC(const char *Cmd) {
     return PM3_SUCCESS;
 }
 
+// bit by bit references for the table driven crc16 / crc32 / crc64
+static uint16_t crc16_bitwise(const uint8_t *d, size_t n, uint16_t crc, uint16_t poly, bool refin, bool refout) {
+    while (n--) {
+        crc ^= (refin ? reflect8(*d++) : *d++) << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ poly : (crc << 1);
+        }
+    }
+    return (refout) ? reflect16(crc) : crc;
+}
+
+static uint32_t crc32_bitwise(const uint8_t *d, size_t n) {
+    uint32_t c = 0xFFFFFFFF;
+    while (n--) {
+        c ^= *d++;
+        for (int i = 0; i < 8; i++) {
+            c = (c >> 1) ^ ((c & 1) ? 0xEDB88320 : 0);
+        }
+    }
+    return c;
+}
+
+static uint64_t crc64_bitwise(const uint8_t *d, size_t n, uint64_t c) {
+    while (n--) {
+        c ^= (uint64_t) * d++ << 56;
+        for (int i = 0; i < 8; i++) {
+            c = (c << 1) ^ ((c >> 63) ? 0x42F0E1EBA9EA3693 : 0);
+        }
+    }
+    return c;
+}
+
+#define CRC_BENCH_ROUNDS 256
+
+static double crc_rate(uint64_t bytes, uint64_t ms) {
+    return (double)bytes / 1000.0 / (ms ? ms : 1);
+}
+
+// Checks every CrcType_t, crc32 and crc64 against a bit by bit reference and
+// measures the throughput of both.
+static int crc_selftest_bench(void) {
+
+    static const struct {
+        CrcType_t ct;
+        const char *name;
+        uint16_t poly;
+        uint16_t init;
+        bool refin;
+        bool refout;
+        uint16_t xorout;
+    } crcs[] = {
+        {CRC_11784,    "11784",    CRC16_POLY_CCITT,     0x0000, false, true,  0x0000},
+        {CRC_14443_A,  "14443_A",  CRC16_POLY_CCITT,     0xC6C6, true,  true,  0x0000},
+        {CRC_14443_B,  "14443_B",  CRC16_POLY_CCITT,     0xFFFF, true,  true,  0xFFFF},
+        {CRC_15693,    "15693",    CRC16_POLY_CCITT,     0xFFFF, true,  true,  0xFFFF},
+        {CRC_ICLASS,   "ICLASS",   CRC16_POLY_CCITT,     0x4807, true,  true,  0x0000},
+        {CRC_FELICA,   "FELICA",   CRC16_POLY_CCITT,     0x0000, false, false, 0x0000},
+        {CRC_LEGIC,    "LEGIC",    CRC16_POLY_LEGIC,     0x7878, true,  false, 0x0000},
+        {CRC_LEGIC_16, "LEGIC_16", CRC16_POLY_LEGIC_16,  0x7878, true,  false, 0x0000},
+        {CRC_CCITT,    "CCITT",    CRC16_POLY_CCITT,     0xFFFF, false, false, 0x0000},
+        {CRC_KERMIT,   "KERMIT",   CRC16_POLY_CCITT,     0x0000, true,  true,  0x0000},
+        {CRC_XMODEM,   "XMODEM",   CRC16_POLY_CCITT,     0x0000, false, false, 0x0000},
+        {CRC_CRYPTORF, "CRYPTORF", CRC16_POLY_CCITT,     0xFFFF, true,  true,  0xFFFF},
+        {CRC_PHILIPS,  "PHILIPS",  CRC16_POLY_CCITT,     0x49A3, false, false, 0x0000},
+    };
+
+    const size_t bufsize = 0x10000;
+    uint8_t *buf = calloc(bufsize, sizeof(uint8_t));
+    if (buf == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < bufsize; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        buf[i] = x & 0xFF;
+    }
+
+    // every tail length of the 8 byte kernels, and odd offsets
+    static const size_t lens[] = {3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 64, 255, 1021};
+
+    bool isok = true;
+
+    PrintAndLogEx(INFO, "type        table MB/s   bitwise MB/s");
+    PrintAndLogEx(INFO, "----------- ----------   ------------");
+
+    for (size_t t = 0; t < ARRAYLEN(crcs); t++) {
+
+        bool typeok = true;
+        for (size_t l = 0; l < ARRAYLEN(lens); l++) {
+            const uint8_t *d = buf + l;
+            uint16_t want = crc16_bitwise(d, lens[l], crcs[t].init, crcs[t].poly, crcs[t].refin, crcs[t].refout) ^ crcs[t].xorout;
+            uint16_t got = crc16_fast_ex(crcs[t].ct, d, lens[l], crcs[t].init, crcs[t].refin, crcs[t].refout) ^ crcs[t].xorout;
+            typeok &= (want == got);
+
+            // the CrcType_t entry points where they are implemented
+            if (crcs[t].ct != CRC_LEGIC && crcs[t].ct != CRC_LEGIC_16) {
+                typeok &= (Crc16ex(crcs[t].ct, d, lens[l]) == want);
+            }
+        }
+        isok &= typeok;
+
+        uint16_t c16 = crcs[t].init;
+        uint64_t t1 = msclock();
+        for (int r = 0; r < CRC_BENCH_ROUNDS; r++) {
+            c16 = crc16_fast_ex(crcs[t].ct, buf, bufsize, c16, crcs[t].refin, crcs[t].refout);
+        }
+        uint64_t t_tab = msclock() - t1;
+
+        t1 = msclock();
+        for (int r = 0; r < CRC_BENCH_ROUNDS / 16; r++) {
+            c16 = crc16_bitwise(buf, bufsize, c16, crcs[t].poly, crcs[t].refin, crcs[t].refout);
+        }
+        uint64_t t_bit = msclock() - t1;
+
+        PrintAndLogEx(INFO, "%-11s " _YELLOW_("%10.1f") "   %12.1f   ( %s )"
+                      , crcs[t].name
+                      , crc_rate(CRC_BENCH_ROUNDS * bufsize, t_tab)
+                      , crc_rate(CRC_BENCH_ROUNDS / 16 * bufsize, t_bit)
+                      , typeok ? _GREEN_("ok") : _RED_("fail")
+                     );
+    }
+
+    // crc32 (desfire)
+    bool typeok = true;
+    for (size_t l = 0; l < ARRAYLEN(lens); l++) {
+        uint8_t crc[4] = {0};
+        crc32_ex(buf + l, lens[l], crc);
+        typeok &= (MemLeToUint4byte(crc) == crc32_bitwise(buf + l, lens[l]));
+    }
+    isok &= typeok;
+
+    uint8_t crc[4] = {0};
+    uint64_t t1 = msclock();
+    for (int r = 0; r < CRC_BENCH_ROUNDS; r++) {
+        buf[0] ^= crc[0];
+        crc32_ex(buf, bufsize, crc);
+    }
+    uint64_t t_tab = msclock() - t1;
+    t1 = msclock();
+    for (int r = 0; r < CRC_BENCH_ROUNDS / 16; r++) {
+        buf[0] ^= crc32_bitwise(buf, bufsize);
+    }
+    uint64_t t_bit = msclock() - t1;
+    PrintAndLogEx(INFO, "%-11s " _YELLOW_("%10.1f") "   %12.1f   ( %s )", "CRC32", crc_rate(CRC_BENCH_ROUNDS * bufsize, t_tab), crc_rate(CRC_BENCH_ROUNDS / 16 * bufsize, t_bit), typeok ? _GREEN_("ok") : _RED_("fail"));
+
+    // crc64 (ecma)
+    typeok = true;
+    for (size_t l = 0; l < ARRAYLEN(lens); l++) {
+        uint64_t c = 0xFFFFFFFFFFFFFFFF;
+        crc64(buf + l, lens[l], &c);
+        typeok &= (c == crc64_bitwise(buf + l, lens[l], 0xFFFFFFFFFFFFFFFF));
+    }
+    isok &= typeok;
+
+    uint64_t c64 = 0;
+    t1 = msclock();
+    for (int r = 0; r < CRC_BENCH_ROUNDS; r++) {
+        crc64(buf, bufsize, &c64);
+    }
+    t_tab = msclock() - t1;
+    t1 = msclock();
+    for (int r = 0; r < CRC_BENCH_ROUNDS / 16; r++) {
+        c64 = crc64_bitwise(buf, bufsize, c64);
+    }
+    t_bit = msclock() - t1;
+    PrintAndLogEx(INFO, "%-11s " _YELLOW_("%10.1f") "   %12.1f   ( %s )", "CRC64", crc_rate(CRC_BENCH_ROUNDS * bufsize, t_tab), crc_rate(CRC_BENCH_ROUNDS / 16 * bufsize, t_bit), typeok ? _GREEN_("ok") : _RED_("fail"));
+
+    free(buf);
+
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx((isok) ? SUCCESS : FAILED, "CRC tables ( %s )", (isok) ? _GREEN_("ok") : _RED_("fail"));
+    return (isok) ? PM3_SUCCESS : PM3_ESOFT;
+}
+
 static int CmdAnalyseCRC(const char *Cmd) {
     CLIParserContext *ctx;
     CLIParserInit(&ctx, "analyse crc",
                   "A stub method to test different crc implementations inside the PM3 sourcecode.\n"
                   "Just because you figured out the poly, doesn't mean you get the desired output",
-                  "analyse crc -d 137AF00A0A0D"
+                  "analyse crc -d 137AF00A0A0D\n"
+                  "analyse crc --bench          -> self test and benchmark of all CRC types"
                  );
 
     void *argtable[] = {
         arg_param_begin,
-        arg_str1("d", "data", "<hex>", "bytes to calc crc"),
+        arg_str0("d", "data", "<hex>", "bytes to calc crc"),
+        arg_lit0(NULL, "bench", "self test and benchmark the CRC tables"),
         arg_param_end
     };
-    CLIExecWithReturn(ctx, Cmd, argtable, true);
+    CLIExecWithReturn(ctx, Cmd, argtable, false);
     int dlen = 0;
     uint8_t data[1024] = {0x00};
     int res = CLIParamHexToBuf(arg_get_str(ctx, 1), data, sizeof(data), &dlen);
+    bool bench = arg_get_lit(ctx, 2);
     CLIParserFree(ctx);
 
-    if (res) {
+    if (bench) {
+        return crc_selftest_bench();
+    }
+
+    if (res || dlen == 0) {
         PrintAndLogEx(FAILED, "Error parsing bytes");
         return PM3_EINVARG;
     }
@@ -1254,10 +1450,547 @@ static int CmdAnalyseRegex(const char *Cmd) {
     return PM3_SUCCESS;
 }
 
+static int CmdAnalyseCrcSearch(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "analyse crcsearch",
+                  "Identify the CRC of captured frames. Each sample is the frame data with its CRC appended,\n"
+                  "a model has to match all samples.\n"
+                  "Without width all reveng presets are tried, straight and reversed.\n"
+                  "With width every polynomial of that width is tried on all cores and init / xorout are solved,\n"
+                  "which needs at least two samples of the same length.",
+                  "analyse crcsearch -d 313233343536373839cbf43926\n"
+                  "analyse crcsearch -w 16 -d 0102030405060708C8F0 -d 1122334455667788E2B6 -d A1A2A3A4A5A6A7A8CF3E\n"
+                  "analyse crcsearch --test"
+                 );
+
+    void *argtable[] = {
+        arg_param_begin,
+        arg_strx0("d", "data", "<hex>", "sample, data with CRC appended (repeat for more samples)"),
+        arg_u64_0("w", "width", "<dec>", "exhaustive polynomial search of this CRC width (1-32)"),
+        arg_lit0(NULL, "be", "only big endian (refin / refout false) models"),
+        arg_lit0(NULL, "le", "only little endian (refin / refout true) models"),
+        arg_lit0(NULL, "test", "self test and benchmark the search engine"),
+        arg_param_end
+    };
+    CLIExecWithReturn(ctx, Cmd, argtable, false);
+
+    struct arg_str *arg_data = arg_get_str(ctx, 1);
+    uint64_t width = arg_get_u64_def(ctx, 2, 0);
+    bool be = arg_get_lit(ctx, 3);
+    bool le = arg_get_lit(ctx, 4);
+    bool selftest = arg_get_lit(ctx, 5);
+
+    int count = arg_data->count;
+    char **hexs = calloc(count + 1, sizeof(char *));
+    if (hexs == NULL) {
+        CLIParserFree(ctx);
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+    for (int i = 0; i < count; i++) {
+        hexs[i] = strdup(arg_data->sval[i]);
+    }
+    CLIParserFree(ctx);
+
+    int res = PM3_EINVARG;
+    if (selftest) {
+        res = crc_search_selftest();
+    } else if (count == 0) {
+        PrintAndLogEx(ERR, "at least one sample is required unless --test is used");
+    } else if (be && le) {
+        PrintAndLogEx(ERR, "select only one of --be / --le");
+    } else if (width > 32) {
+        PrintAndLogEx(ERR, "width must be between 1 and 32");
+    } else if (width) {
+        res = crc_search_sweep(width, (be) ? 'b' : (le) ? 'l' : 0, false, false, hexs, count);
+    } else {
+        res = crc_search_presets(hexs, count);
+    }
+
+    for (int i = 0; i < count; i++) {
+        free(hexs[i]);
+    }
+    free(hexs);
+    return res;
+}
+
+// moduli collected by `analyse roca`, every key owns its buffer and label
+typedef struct {
+    roca_key_t *keys;
+    char **labels;
+    size_t count;
+    size_t size;
+    size_t files;
+    emv_oda_cache_t *emv;       // CA and issuer keys shared by the card files
+} roca_corpus_t;
+
+#define ROCA_MIN_MODULUS    32
+#define ROCA_MAX_FILES      8192
+#define ROCA_PATH_LEN       256
+
+static void roca_corpus_free(roca_corpus_t *c) {
+    for (size_t i = 0; i < c->count; i++) {
+        free((void *)c->keys[i].modulus);
+        free(c->labels[i]);
+    }
+    free(c->keys);
+    free(c->labels);
+    emv_oda_cache_free(c->emv);
+    memset(c, 0, sizeof(roca_corpus_t));
+}
+
+static int roca_corpus_add(roca_corpus_t *c, const uint8_t *modulus, size_t len, const char *label) {
+    // leading zero bytes of a DER integer or a hex dump do not change the residues
+    while (len && modulus[0] == 0) {
+        modulus++;
+        len--;
+    }
+    if (len < ROCA_MIN_MODULUS) {
+        return PM3_SUCCESS;
+    }
+
+    if (c->count == c->size) {
+        size_t size = c->size ? c->size * 2 : 256;
+        roca_key_t *keys = realloc(c->keys, size * sizeof(roca_key_t));
+        if (keys == NULL) {
+            return PM3_EMALLOC;
+        }
+        c->keys = keys;
+        char **labels = realloc(c->labels, size * sizeof(char *));
+        if (labels == NULL) {
+            return PM3_EMALLOC;
+        }
+        c->labels = labels;
+        c->size = size;
+    }
+
+    uint8_t *buf = malloc(len);
+    char *lbl = strdup(label);
+    if (buf == NULL || lbl == NULL) {
+        free(buf);
+        free(lbl);
+        return PM3_EMALLOC;
+    }
+    memcpy(buf, modulus, len);
+    c->keys[c->count] = (roca_key_t) { .modulus = buf, .len = len };
+    c->labels[c->count] = lbl;
+    c->count++;
+    return PM3_SUCCESS;
+}
+
+static int roca_add_pk(roca_corpus_t *c, mbedtls_pk_context *pk, const char *label) {
+    if (mbedtls_pk_get_type(pk) != MBEDTLS_PK_RSA) {
+        return PM3_SUCCESS;
+    }
+    mbedtls_rsa_context *rsa = mbedtls_pk_rsa(*pk);
+    uint8_t n[1024];
+    size_t nlen = mbedtls_mpi_size(&rsa->N);
+    if (nlen > sizeof(n) || mbedtls_mpi_write_binary(&rsa->N, n, nlen)) {
+        return PM3_SUCCESS;
+    }
+    return roca_corpus_add(c, n, nlen, label);
+}
+
+// PEM or DER certificates, a chain in one file gives one key per certificate.
+// Files that are no certificate are tried as public key
+static int roca_load_x509(roca_corpus_t *c, const char *fn, const uint8_t *data, size_t len, bool pem) {
+    mbedtls_x509_crt crt;
+    mbedtls_x509_crt_init(&crt);
+
+    // PEM parsing needs the terminating zero in the length
+    int res = (pem) ? mbedtls_x509_crt_parse(&crt, data, len + 1) : mbedtls_x509_crt_parse_der(&crt, data, len);
+    if (res >= 0 && crt.version) {
+        int n = 0;
+        for (mbedtls_x509_crt *cur = &crt; cur && cur->version; cur = cur->next, n++) {
+            char label[ROCA_PATH_LEN + 16];
+            snprintf(label, sizeof(label), (n || cur->next) ? "%s #%d" : "%s", fn, n + 1);
+            res = roca_add_pk(c, &cur->pk, label);
+            if (res != PM3_SUCCESS) {
+                break;
+            }
+        }
+        mbedtls_x509_crt_free(&crt);
+        return (res == PM3_EMALLOC) ? res : PM3_SUCCESS;
+    }
+    mbedtls_x509_crt_free(&crt);
+
+    mbedtls_pk_context pk;
+    mbedtls_pk_init(&pk);
+    res = PM3_SUCCESS;
+    if (mbedtls_pk_parse_public_key(&pk, data, (pem) ? len + 1 : len) == 0) {
+        res = roca_add_pk(c, &pk, fn);
+    } else {
+        PrintAndLogEx(DEBUG, "no certificate or public key in " _YELLOW_("%s"), fn);
+    }
+    mbedtls_pk_free(&pk);
+    return res;
+}
+
+static bool roca_is_modulus_key(const char *key) {
+    char lower[64] = {0};
+    for (size_t i = 0; key[i] && i < sizeof(lower) - 1; i++) {
+        lower[i] = tolower((unsigned char)key[i]);
+    }
+    return strstr(lower, "modulus") != NULL;
+}
+
+// hex strings of the members named like *modulus
+static int roca_load_json_obj(roca_corpus_t *c, const char *fn, json_t *obj) {
+    const char *key;
+    json_t *value;
+    size_t index;
+
+    if (json_is_array(obj)) {
+        json_array_foreach(obj, index, value) {
+            int res = roca_load_json_obj(c, fn, value);
+            if (res != PM3_SUCCESS) {
+                return res;
+            }
+        }
+        return PM3_SUCCESS;
+    }
+
+    json_object_foreach(obj, key, value) {
+        int res = PM3_SUCCESS;
+        if (json_is_string(value) && roca_is_modulus_key(key)) {
+            const char *hex = json_string_value(value);
+            size_t hexlen = strlen(hex);
+            uint8_t *buf = malloc(hexlen / 2 + 1);
+            if (buf == NULL) {
+                return PM3_EMALLOC;
+            }
+            int n = hex_to_bytes(hex, buf, hexlen / 2 + 1);
+            if (n > 0) {
+                char label[ROCA_PATH_LEN + 64];
+                snprintf(label, sizeof(label), "%s %s", fn, key);
+                res = roca_corpus_add(c, buf, n, label);
+            }
+            free(buf);
+        } else if (json_is_object(value) || json_is_array(value)) {
+            res = roca_load_json_obj(c, fn, value);
+        }
+        if (res != PM3_SUCCESS) {
+            return res;
+        }
+    }
+    return PM3_SUCCESS;
+}
+
+// `emv scan` files hold certificates, the issuer and ICC keys are recovered from them
+static int roca_load_emv(roca_corpus_t *c, const char *fn, json_t *root) {
+    struct tlvdb *tlv = emv_oda_load_json(root);
+    if (tlv == NULL) {
+        return PM3_SUCCESS;
+    }
+    if (c->emv == NULL) {
+        c->emv = emv_oda_cache_new();
+        if (c->emv == NULL) {
+            tlvdb_free(tlv);
+            return PM3_EMALLOC;
+        }
+    }
+
+    struct emv_pk *issuer = NULL, *icc = NULL;
+    emv_oda_recover_keys(c->emv, tlv, &issuer, &icc);
+    tlvdb_free(tlv);
+
+    char label[ROCA_PATH_LEN + 16];
+    int res = PM3_SUCCESS;
+    if (issuer) {
+        snprintf(label, sizeof(label), "%s issuer", fn);
+        res = roca_corpus_add(c, issuer->modulus, issuer->mlen, label);
+    }
+    if (icc && res == PM3_SUCCESS) {
+        snprintf(label, sizeof(label), "%s ICC", fn);
+        res = roca_corpus_add(c, icc->modulus, icc->mlen, label);
+    }
+    if (issuer == NULL) {
+        PrintAndLogEx(DEBUG, "no public key recovered from " _YELLOW_("%s"), fn);
+    }
+    emv_pk_free(issuer);
+    emv_pk_free(icc);
+    return res;
+}
+
+// one hex modulus per line, ':' separators and # comments allowed
+static int roca_load_text(roca_corpus_t *c, const char *fn, char *text) {
+    uint8_t buf[1024];
+    size_t lineno = 0;
+    char *save = NULL;
+    for (char *line = strtok_r(text, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        lineno++;
+
+        char *p = strchr(line, '#');
+        if (p) {
+            *p = '\0';
+        }
+        // squeeze out separators and an optional 0x prefix
+        char *w = line;
+        for (p = line; *p; p++) {
+            if (*p == ':' || isspace((unsigned char)*p)) {
+                continue;
+            }
+            *w++ = *p;
+        }
+        *w = '\0';
+        p = line;
+        if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+            p += 2;
+        }
+        if (*p == '\0') {
+            continue;
+        }
+
+        int n = hex_to_bytes(p, buf, sizeof(buf));
+        if (n < 0) {
+            PrintAndLogEx(DEBUG, "%s:%zu not a hex modulus", fn, lineno);
+            continue;
+        }
+        char label[ROCA_PATH_LEN + 16];
+        snprintf(label, sizeof(label), "%s:%zu", fn, lineno);
+        int res = roca_corpus_add(c, buf, n, label);
+        if (res != PM3_SUCCESS) {
+            return res;
+        }
+    }
+    return PM3_SUCCESS;
+}
+
+static int roca_load_file(roca_corpus_t *c, const char *fn) {
+    FILE *f = fopen(fn, "rb");
+    if (f == NULL) {
+        PrintAndLogEx(WARNING, "could not open " _YELLOW_("%s"), fn);
+        return PM3_EFILE;
+    }
+    fseek(f, 0, SEEK_END);
+    long fsize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (fsize < 0) {
+        fclose(f);
+        return PM3_EFILE;
+    }
+
+    uint8_t *data = calloc(fsize + 1, sizeof(uint8_t));
+    if (data == NULL) {
+        fclose(f);
+        return PM3_EMALLOC;
+    }
+    size_t len = fread(data, 1, fsize, f);
+    fclose(f);
+    c->files++;
+
+    const char *text = (const char *)data;
+    while (*text && isspace((unsigned char)*text)) {
+        text++;
+    }
+
+    int res = PM3_SUCCESS;
+    if (strstr(text, "-----BEGIN ")) {
+        res = roca_load_x509(c, fn, data, len, true);
+    } else if (len && data[0] == 0x30) {
+        res = roca_load_x509(c, fn, data, len, false);
+    } else {
+        // anything that is not JSON is read as text
+        json_t *root = NULL;
+        if (*text == '{' || *text == '[') {
+            json_error_t error;
+            root = json_loadb((const char *)data, len, 0, &error);
+        }
+        if (json_object_get(root, "Application")) {
+            res = roca_load_emv(c, fn, root);
+        } else if (root) {
+            res = roca_load_json_obj(c, fn, root);
+        } else {
+            res = roca_load_text(c, fn, (char *)data);
+        }
+        json_decref(root);
+    }
+    free(data);
+    return res;
+}
+
+static int roca_load_path(roca_corpus_t *c, const char *path) {
+    if (path_is_directory(path) == false) {
+        return roca_load_file(c, path);
+    }
+
+    char *paths = calloc(ROCA_MAX_FILES, ROCA_PATH_LEN);
+    if (paths == NULL) {
+        return PM3_EMALLOC;
+    }
+    size_t count = 0;
+    int res = collect_file_paths_recursive(path, paths, ROCA_PATH_LEN, ROCA_MAX_FILES, &count, false, 8);
+    if (res == PM3_EOVFLOW) {
+        PrintAndLogEx(WARNING, "only the first %u files of " _YELLOW_("%s") " are scanned", ROCA_MAX_FILES, path);
+    } else if (res != PM3_SUCCESS) {
+        PrintAndLogEx(WARNING, "could not read directory " _YELLOW_("%s"), path);
+        free(paths);
+        return res;
+    }
+
+    res = PM3_SUCCESS;
+    for (size_t i = 0; i < count && res != PM3_EMALLOC; i++) {
+        res = roca_load_file(c, paths + i * ROCA_PATH_LEN);
+    }
+    free(paths);
+    return (res == PM3_EMALLOC) ? res : PM3_SUCCESS;
+}
+
+static int CmdAnalyseRoca(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "analyse roca",
+                  "ROCA (CVE-2017-15361) fingerprint test of a corpus of RSA moduli.\n"
+                  "A path is a file or a directory scanned recursively. Files may hold\n"
+                  "PEM / DER certificates or public keys, one hex modulus per line, JSON with\n"
+                  "*modulus hex members or card data saved by emv scan, whose issuer and ICC\n"
+                  "keys are recovered with the CA keys.\n"
+                  "The keys are checked in parallel, only the weak ones are listed",
+                  "analyse roca -f moduli.txt\n"
+                  "analyse roca -f certs/ -f card.json --threads 4 -v"
+                 );
+
+    void *argtable[] = {
+        arg_param_begin,
+        arg_strn("f",  "file",    "<fn>", 1, 64, "file or directory"),
+        arg_int0(NULL, "threads", "<dec>", "number of threads (def: number of CPUs)"),
+        arg_lit0("v",  "verbose", "list every key"),
+        arg_param_end
+    };
+    CLIExecWithReturn(ctx, Cmd, argtable, false);
+
+    struct arg_str *files_arg = arg_get_str(ctx, 1);
+    int threads = arg_get_int_def(ctx, 2, 0);
+    bool verbose = arg_get_lit(ctx, 3);
+
+    if (threads < 0) {
+        PrintAndLogEx(ERR, "Number of threads must be positive");
+        CLIParserFree(ctx);
+        return PM3_EINVARG;
+    }
+
+    roca_corpus_t corpus = {0};
+    int res = PM3_SUCCESS;
+    uint64_t t0 = msclock();
+    for (int i = 0; i < files_arg->count && res != PM3_EMALLOC; i++) {
+        res = roca_load_path(&corpus, files_arg->sval[i]);
+    }
+    uint64_t load_ms = msclock() - t0;
+    CLIParserFree(ctx);
+
+    if (res == PM3_EMALLOC) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        roca_corpus_free(&corpus);
+        return res;
+    }
+    if (corpus.count == 0) {
+        PrintAndLogEx(FAILED, "No RSA modulus found in %zu file(s)", corpus.files);
+        roca_corpus_free(&corpus);
+        return PM3_ENODATA;
+    }
+
+    bool *weak = calloc(corpus.count, sizeof(bool));
+    if (weak == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        roca_corpus_free(&corpus);
+        return PM3_EMALLOC;
+    }
+
+    uint64_t t1 = usclock();
+    size_t found = emv_rocacheck_batch(corpus.keys, corpus.count, threads, weak);
+    uint64_t check_us = usclock() - t1;
+
+    PrintAndLogEx(NORMAL, "");
+    for (size_t i = 0; i < corpus.count; i++) {
+        if (weak[i]) {
+            PrintAndLogEx(WARNING, _RED_("weak") "   %4zu bits  %s", corpus.keys[i].len * 8, corpus.labels[i]);
+        } else if (verbose) {
+            PrintAndLogEx(INFO, _GREEN_("ok") "     %4zu bits  %s", corpus.keys[i].len * 8, corpus.labels[i]);
+        }
+    }
+
+    PrintAndLogEx(INFO, "%zu key(s) from %zu file(s), loaded in " _YELLOW_("%" PRIu64) " ms", corpus.count, corpus.files, load_ms);
+    PrintAndLogEx(INFO, "checked in " _YELLOW_("%.3f") " ms, " _YELLOW_("%.0f") " keys/s with %d thread(s)",
+                  check_us / 1000.0,
+                  check_us ? corpus.count * 1000000.0 / check_us : 0.0,
+                  (threads) ? threads : num_CPUs()
+                 );
+    if (found) {
+        PrintAndLogEx(WARNING, "ROCA fingerprint found in " _RED_("%zu") " of %zu key(s)", found, corpus.count);
+    } else {
+        PrintAndLogEx(SUCCESS, "No ROCA fingerprint found ( %s )", _GREEN_("ok"));
+    }
+
+    free(weak);
+    roca_corpus_free(&corpus);
+    return PM3_SUCCESS;
+}
+
+static int CmdAnalyseBench(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "analyse bench",
+                  "Offline benchmarks of the client kernels (crapto1, hardnested, iCLASS / loclass,\n"
+                  "DES / AES, LZ4, lfdemod) on fixed inputs. Every case checks its result.\n"
+                  "Rates are ops/s, mean of the repetitions with their standard deviation.\n"
+                  "`make bench` / tools/pm3_bench.py run this and compare two builds",
+                  "analyse bench --list\n"
+                  "analyse bench                     -> run all cases\n"
+                  "analyse bench -n loclass -r 10    -> only loclass cases, 10 reps\n"
+                  "analyse bench --json -f bench     -> JSON, also saved to bench.json"
+                 );
+
+    void *argtable[] = {
+        arg_param_begin,
+        arg_lit0("l", "list", "list the cases"),
+        arg_str0("n", "name", "<str>", "only run cases whose name contains this"),
+        arg_u64_0("r", "reps", "<dec>", "repetitions per case (def 5)"),
+        arg_u64_0("t", "time", "<ms>", "minimum time of a micro repetition (def 200)"),
+        arg_lit0("j", "json", "print JSON"),
+        arg_str0("f", "file", "<fn>", "save JSON to file"),
+        arg_param_end
+    };
+    CLIExecWithReturn(ctx, Cmd, argtable, true);
+
+    bool list = arg_get_lit(ctx, 1);
+
+    char name[64] = {0};
+    int nlen = 0;
+    CLIParamStrToBuf(arg_get_str(ctx, 2), (uint8_t *)name, sizeof(name) - 1, &nlen);
+
+    uint32_t reps = arg_get_u32_def(ctx, 3, 5);
+    uint32_t min_ms = arg_get_u32_def(ctx, 4, 200);
+    bool json = arg_get_lit(ctx, 5);
+
+    char filename[FILE_PATH_SIZE] = {0};
+    int fnlen = 0;
+    CLIParamStrToBuf(arg_get_str(ctx, 6), (uint8_t *)filename, FILE_PATH_SIZE, &fnlen);
+    CLIParserFree(ctx);
+
+    if (list) {
+        pm3_bench_list();
+        return PM3_SUCCESS;
+    }
+
+    if (reps == 0 || min_ms == 0) {
+        PrintAndLogEx(ERR, "reps and time must be greater than zero");
+        return PM3_EINVARG;
+    }
+
+    pm3_bench_opts_t opts = {
+        .filter = (nlen) ? name : NULL,
+        .reps = reps,
+        .min_ms = min_ms,
+        .json = json,
+        .filename = (fnlen) ? filename : NULL,
+    };
+    return pm3_bench_run(&opts);
+}
+
 static command_t CommandTable[] = {
     {"help",    CmdHelp,            AlwaysAvailable, "This help"},
+    {"bench",   CmdAnalyseBench,    AlwaysAvailable, "Benchmark the client crypto and demod kernels"},
     {"lrc",     CmdAnalyseLRC,      AlwaysAvailable, "Generate final byte for XOR LRC"},
     {"crc",     CmdAnalyseCRC,      AlwaysAvailable, "Stub method for CRC evaluations"},
+    {"crcsearch", CmdAnalyseCrcSearch, AlwaysAvailable, "Identify a CRC model from captured samples"},
     {"chksum",  CmdAnalyseCHKSUM,   AlwaysAvailable, "Checksum with adding, masking and one's complement"},
     {"dates",   CmdAnalyseDates,    AlwaysAvailable, "Look for datestamps in a given array of bytes"},
     {"lfsr",    CmdAnalyseLfsr,     AlwaysAvailable, "LFSR tests"},
@@ -1266,6 +1999,7 @@ static command_t CommandTable[] = {
     {"demodbuff", CmdAnalyseDemodBuffer, AlwaysAvailable, "Load binary string to DemodBuffer"},
     {"freq",    CmdAnalyseFreq,     AlwaysAvailable, "Calc wave lengths"},
     {"foo",     CmdAnalyseFoo,      AlwaysAvailable, "muxer"},
+    {"roca",    CmdAnalyseRoca,     AlwaysAvailable, "ROCA fingerprint test of RSA moduli and certificates"},
     {"regex",   CmdAnalyseRegex,    AlwaysAvailable, "Regex utility (subset: ^ $ . * with \\\\ escape)"},
     {"units",   CmdAnalyseUnits,    AlwaysAvailable, "convert ETU <> US <> SSP_CLK (3.39MHz)"},
     {NULL, NULL, NULL, NULL}
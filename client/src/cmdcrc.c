@@ -23,6 +23,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <inttypes.h>
 
 #ifdef _WIN32
 #  include <io.h>
@@ -35,6 +36,9 @@
 #include "reveng.h"
 #include "ui.h"
 #include "util.h"
+#include "util_posix.h"
+#include "commonutil.h"
+#include "crcsearch.h"
 #include "pm3_cmd.h"
 
 #define MAX_ARGS 20
@@ -429,155 +433,724 @@ static int CmdrevengTestC(const char *Cmd) {
     return 1;
 }
 */
-//returns a calloced string (needs to be freed)
-static char *SwapEndianStr(const char *inStr, const size_t len, const uint8_t blockSize) {
-    char *tmp = calloc(len + 1, sizeof(char));
-    if (tmp == NULL) {
-        PrintAndLogEx(WARNING, "Failed to allocate memory");
-        return NULL;
+//-----------------------------------------------------------------------------
+// Table driven model search, see crcsearch.c
+//-----------------------------------------------------------------------------
+
+// reveng keeps polys MSB first in bmp_t words, values are MSB aligned to width
+static uint64_t crc_poly_u64(const poly_t p, uint8_t width) {
+    uint64_t v = 0;
+    unsigned long n = plen(p);
+    for (unsigned long i = 0; i < n && i < width; i++) {
+        if ((p.bitmap[i / BMP_BIT] >> (BMP_BIT - 1 - (i % BMP_BIT))) & 1) {
+            v |= 1ULL << (width - 1 - i);
+        }
     }
+    return v;
+}
 
-    for (uint8_t block = 0; block < (uint8_t)(len / blockSize); block++) {
-        for (size_t i = 0; i < blockSize; i += 2) {
-            tmp[i + (blockSize * block)] = inStr[(blockSize - 1 - i - 1) + (blockSize * block)];
-            tmp[i + (blockSize * block) + 1] = inStr[(blockSize - 1 - i) + (blockSize * block)];
+static poly_t crc_u64_poly(uint64_t v, uint8_t width) {
+    poly_t p = PZERO;
+    palloc(&p, width);
+    for (unsigned long i = 0; i < width; i++) {
+        if ((v >> (width - 1 - i)) & 1) {
+            p.bitmap[i / BMP_BIT] |= BMP_C(1) << (BMP_BIT - 1 - (i % BMP_BIT));
         }
     }
-    return tmp;
+    return p;
 }
 
-// takes hex string in and searches for a matching result (hex string must include checksum)
-static int CmdrevengSearch(const char *Cmd) {
+// codeword polys as MSB first byte strings. bits[] is one allocation
+static crcs_bitstr_t *crc_polys_to_bitstr(const poly_t *polys, int count) {
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        total += (plen(polys[i]) + 7) / 8;
+    }
 
-#define NMODELS 106
+    crcs_bitstr_t *cw = calloc(count, sizeof(crcs_bitstr_t));
+    uint8_t *bits = calloc(total + 1, sizeof(uint8_t));
+    if (cw == NULL || bits == NULL) {
+        free(cw);
+        free(bits);
+        return NULL;
+    }
 
-    char inHexStr[1024] = {0};
-    int dataLen = param_getstr(Cmd, 0, inHexStr, sizeof(inHexStr));
-    if (dataLen < 4) {
-        return 0;
+    for (int i = 0; i < count; i++) {
+        unsigned long n = plen(polys[i]);
+        for (unsigned long j = 0; j < n; j++) {
+            if ((polys[i].bitmap[j / BMP_BIT] >> (BMP_BIT - 1 - (j % BMP_BIT))) & 1) {
+                bits[j >> 3] |= 0x80 >> (j & 7);
+            }
+        }
+        cw[i].bits = bits;
+        cw[i].nbits = n;
+        bits += (n + 7) / 8;
     }
+    return cw;
+}
 
-    // these two arrays, must match preset size.
-    char *Models[NMODELS];
-    uint8_t width[NMODELS] = {0};
-    int count = 0;
+static void crc_free_bitstr(crcs_bitstr_t *cw) {
+    if (cw) {
+        free((void *)cw[0].bits);
+        free(cw);
+    }
+}
+
+typedef struct {
+    const char *name;
+    uint8_t width;
+    int flags;
+    bool reverse;
+    bool compiled;              // false for widths the kernels can't do, RunModel() is used then
+    crcs_kernel_t k;
+} crc_compiled_t;
+
+// Same parameter handling as RunModel() with endian 0, once per model
+// instead of once per call.
+static void crc_compile_preset(int num, bool reverse, crc_compiled_t *out) {
+    model_t model = MZERO;
+    mbynum(&model, num);
+    mcanon(&model);
 
-    char result[50 + 1] = {0};
-    char revResult[50 + 1] = {0};
-    int ans = GetModels(Models, &count, width);
-    if (ans == 0) {
-        for (int i = 0; i < count; i++) {
-            free(Models[i]);
+    out->name = model.name;
+    out->width = (uint8_t)plen(model.spoly);
+    out->flags = model.flags;
+    out->reverse = reverse;
+    out->compiled = (plen(model.spoly) > 0 && plen(model.spoly) <= CRCS_MAX_WIDTH);
+
+    if (out->compiled) {
+        if (reverse) {
+            prcp(&model.spoly);
+            if (~model.flags & P_REFOUT) {
+                prev(&model.init);
+                prev(&model.xorout);
+            }
+            poly_t tmp = model.init;
+            model.init = model.xorout;
+            model.xorout = tmp;
         }
-        return 0;
+        if (model.flags & P_REFOUT) {
+            prev(&model.xorout);
+        }
+        crcs_kernel_init(&out->k, out->width,
+                         crc_poly_u64(model.spoly, out->width),
+                         crc_poly_u64(model.init, out->width),
+                         crc_poly_u64(model.xorout, out->width)
+                        );
     }
+    mfree(&model);
+}
 
-    bool found = false;
+// the ptostr(crc, flags, 8) of RunModel()
+static void crc_format(uint64_t reg, uint8_t width, int flags, bool reverse, char *out) {
+    if (reverse) {
+        reg = reflect64(reg) >> (64 - width);
+    }
+    int nb = (width + 7) / 8;
+    uint64_t v = (flags & P_RTJUST) ? reg : reg << ((nb * 8) - width);
+    for (int i = 0; i < nb; i++) {
+        uint8_t b = (v >> (8 * (nb - 1 - i))) & 0xFF;
+        if (flags & P_REFOUT) {
+            b = reflect8(b);
+        }
+        snprintf(out + (i * 2), 3, "%02x", b);
+    }
+}
+
+typedef struct {
+    char *hex;                  // lower case
+    size_t hexlen;
+    uint8_t *fwd;               // bytes as given
+    uint8_t *fwd_ref;           // every byte reflected, P_REFIN
+    size_t nbytes;
+} crc_sample_t;
 
-    str_lower(inHexStr);
+static void crc_free_samples(crc_sample_t *s, int count) {
+    for (int i = 0; i < count; i++) {
+        free(s[i].hex);
+        free(s[i].fwd);
+    }
+    free(s);
+}
+
+static crc_sample_t *crc_load_samples(char *hexs[], int count) {
+    crc_sample_t *s = calloc(count, sizeof(crc_sample_t));
+    if (s == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return NULL;
+    }
 
-    // try each model and get result
     for (int i = 0; i < count; i++) {
-        /*if (found) {
-            free(Models[i]);
-            continue;
-        }*/
-        // round up to # of characters in this model's crc
-        uint8_t crcChars = ((width[i] + 7) / 8) * 2;
-        // can't test a model that has more crc digits than our data
-        if (crcChars >= dataLen) {
-            free(Models[i]);
-            continue;
-        }
-
-        PrintAndLogEx(DEBUG
-                      , "DEBUG: dataLen %d, crcChars %u,  width[i] %u"
-                      , dataLen
-                      , crcChars
-                      , width[i]
-                     );
-
-        if (crcChars == 0) {
-            free(Models[i]);
-            continue;
-        }
-
-        memset(result, 0, sizeof(result));
-        char *inCRC = calloc(crcChars + 1, sizeof(char));
-        if (inCRC == NULL) {
+        s[i].hexlen = strlen(hexs[i]);
+        s[i].hex = strdup(hexs[i]);
+        s[i].nbytes = s[i].hexlen / 2;
+        s[i].fwd = calloc((s[i].nbytes * 2) + 1, sizeof(uint8_t));
+        if (s[i].hex == NULL || s[i].fwd == NULL) {
             PrintAndLogEx(WARNING, "Failed to allocate memory");
-            return 0;
+            crc_free_samples(s, count);
+            return NULL;
+        }
+        str_lower(s[i].hex);
+        s[i].fwd_ref = s[i].fwd + s[i].nbytes;
+
+        for (size_t j = 0; j < s[i].hexlen; j++) {
+            if (isxdigit((unsigned char)s[i].hex[j]) == 0) {
+                PrintAndLogEx(ERR, "invalid character in hexadecimal argument " _YELLOW_("%s"), s[i].hex);
+                crc_free_samples(s, count);
+                return NULL;
+            }
+        }
+        for (size_t j = 0; j < s[i].nbytes; j++) {
+            char b[3] = { s[i].hex[j * 2], s[i].hex[(j * 2) + 1], 0 };
+            s[i].fwd[j] = (uint8_t)strtoul(b, NULL, 16);
+            s[i].fwd_ref[j] = reflect8(s[i].fwd[j]);
         }
+    }
+    return s;
+}
 
-        memcpy(inCRC, inHexStr + (dataLen - crcChars), crcChars);
+// CRC string the model gives for the sample, less the trailing crc chars
+static bool crc_sample_value(const crc_compiled_t *m, const crc_sample_t *s, size_t crcchars, uint8_t *tmp, char *out) {
+    size_t mlen = (s->hexlen - crcchars) / 2;
 
-        char *outHex = calloc(dataLen - crcChars + 1, sizeof(char));
-        if (outHex == NULL) {
-            PrintAndLogEx(WARNING, "Failed to allocate memory");
-            free(inCRC);
-            return 0;
+    if (m->compiled == false) {
+        char *msg = calloc(s->hexlen - crcchars + 1, sizeof(char));
+        if (msg == NULL) {
+            return false;
+        }
+        memcpy(msg, s->hex, s->hexlen - crcchars);
+        char result[50 + 1] = {0};
+        int ans = RunModel((char *)m->name, msg, m->reverse, 0, result);
+        free(msg);
+        if (ans == 0) {
+            return false;
+        }
+        str_lower(result);
+        memcpy(out, result, crcchars);
+        out[crcchars] = 0;
+        return true;
+    }
+
+    // the reversed model runs over the whole bit string backwards, so the
+    // bytes come in reverse order and each byte flips its reflection
+    const uint8_t *msg;
+    if (m->reverse) {
+        const uint8_t *src = (m->flags & P_REFIN) ? s->fwd : s->fwd_ref;
+        for (size_t i = 0; i < mlen; i++) {
+            tmp[i] = src[mlen - 1 - i];
         }
+        msg = tmp;
+    } else {
+        msg = (m->flags & P_REFIN) ? s->fwd_ref : s->fwd;
+    }
 
-        memcpy(outHex, inHexStr, dataLen - crcChars);
+    crc_format(crcs_kernel_run(&m->k, msg, mlen * 8), m->width, m->flags, m->reverse, out);
+    return true;
+}
 
-        ans = RunModel(Models[i], outHex, false, 0, result);
-        if (ans) {
+static void crc_swap_hex(const char *in, size_t len, char *out) {
+    for (size_t i = 0; i < len; i += 2) {
+        out[i] = in[len - 2 - i];
+        out[i + 1] = in[len - 1 - i];
+    }
+    out[len] = 0;
+}
 
-            str_lower(result);
+// takes hex strings in and searches for a model matching all of them
+// (every hex string must include its checksum)
+int crc_search_presets(char *hexs[], int count) {
 
-            // test for match
-            if (memcmp(result, inCRC, crcChars) == 0) {
-                PrintAndLogEx(SUCCESS, "model... " _YELLOW_("%s"), Models[i]);
-                PrintAndLogEx(SUCCESS, "value... %s\n", result);
-                //optional - stop searching if found...
-                found = true;
-            } else {
-                if (crcChars > 2) {
-                    char *swapEndian = SwapEndianStr(result, crcChars, crcChars);
-                    if (memcmp(swapEndian, inCRC, crcChars) == 0) {
-                        PrintAndLogEx(SUCCESS, "model... " _YELLOW_("%s"), Models[i]);
-                        PrintAndLogEx(SUCCESS, "value endian swapped... %s\n", swapEndian);
-                        // optional - stop searching if found...
-                        found = true;
+    if (count < 1) {
+        return PM3_EINVARG;
+    }
+
+    crc_sample_t *s = crc_load_samples(hexs, count);
+    if (s == NULL) {
+        return PM3_EINVARG;
+    }
+
+    size_t minlen = SIZE_MAX, maxbytes = 0;
+    for (int i = 0; i < count; i++) {
+        minlen = MIN(minlen, s[i].hexlen);
+        maxbytes = MAX(maxbytes, s[i].nbytes);
+    }
+
+    if (minlen < 4) {
+        crc_free_samples(s, count);
+        return PM3_EINVARG;
+    }
+
+    uint8_t *tmp = calloc(maxbytes + 1, sizeof(uint8_t));
+    if (tmp == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        crc_free_samples(s, count);
+        return PM3_EMALLOC;
+    }
+
+    SETBMP();
+
+    bool found = false;
+    int nmodels = mcount();
+
+    for (int i = 0; i < nmodels; i++) {
+        for (int r = 0; r < 2; r++) {
+
+            crc_compiled_t m;
+            crc_compile_preset(i, r, &m);
+
+            // round up to # of characters in this model's crc
+            size_t crcchars = ((m.width + 7) / 8) * 2;
+            // can't test a model that has more crc digits than our data
+            if (crcchars == 0 || crcchars >= minlen || m.name == NULL) {
+                continue;
+            }
+
+            PrintAndLogEx(DEBUG, "DEBUG: dataLen %zu, crcChars %zu,  width[i] %u", minlen, crcchars, m.width);
+
+            // a model matches when every sample matches, straight or
+            // endian swapped. Stop at the first sample that matches neither.
+            char val[50 + 1] = {0}, swp[50 + 1] = {0};
+            char first[50 + 1] = {0}, first_swp[50 + 1] = {0};
+            bool direct = true, swapped = (crcchars > 2);
+
+            for (int j = 0; j < count && (direct || swapped); j++) {
+                if (crc_sample_value(&m, &s[j], crcchars, tmp, val) == false) {
+                    direct = swapped = false;
+                    break;
+                }
+                const char *incrc = s[j].hex + s[j].hexlen - crcchars;
+                if (direct && memcmp(val, incrc, crcchars)) {
+                    direct = false;
+                }
+                if (swapped) {
+                    crc_swap_hex(val, crcchars, swp);
+                    if (memcmp(swp, incrc, crcchars)) {
+                        swapped = false;
                     }
-                    free(swapEndian);
+                }
+                if (j == 0) {
+                    memcpy(first, val, sizeof(first));
+                    memcpy(first_swp, swp, sizeof(first_swp));
                 }
             }
-        }
-        ans = RunModel(Models[i], outHex, true, 0, revResult);
-        if (ans) {
-            str_lower(revResult);
 
-            // test for match
-            if (memcmp(revResult, inCRC, crcChars) == 0) {
-                PrintAndLogEx(SUCCESS, "model reversed... " _YELLOW_("%s"), Models[i]);
-                PrintAndLogEx(SUCCESS, "value... %s\n", revResult);
-                // optional - stop searching if found...
+            if (direct) {
+                PrintAndLogEx(SUCCESS, "model%s... " _YELLOW_("%s"), r ? " reversed" : "", m.name);
+                PrintAndLogEx(SUCCESS, "value... %s\n", first);
+                found = true;
+            } else if (swapped) {
+                PrintAndLogEx(SUCCESS, "model%s... " _YELLOW_("%s"), r ? " reversed" : "", m.name);
+                PrintAndLogEx(SUCCESS, "value endian swapped... %s\n", first_swp);
                 found = true;
-            } else {
-                if (crcChars > 2) {
-                    char *swapEndian = SwapEndianStr(revResult, crcChars, crcChars);
-                    if (memcmp(swapEndian, inCRC, crcChars) == 0) {
-                        PrintAndLogEx(SUCCESS, "model reversed... " _YELLOW_("%s"), Models[i]);
-                        PrintAndLogEx(SUCCESS, "value endian swapped... %s\n", swapEndian);
-                        // optional - stop searching if found...
-                        found = true;
-                    }
-                    free(swapEndian);
-                }
             }
         }
-        free(inCRC);
-        free(outHex);
-        free(Models[i]);
     }
 
+    free(tmp);
+    crc_free_samples(s, count);
+
     if (found == false) {
         PrintAndLogEx(FAILED, "\nno matches found\n");
     }
     return PM3_SUCCESS;
 }
 
+// reveng -w <width> -s with the preset pass and the polynomial sweep on the
+// search engine. Init / xorout of every candidate poly are still solved and
+// reported by reveng itself. endian is 0 (both), 'b' or 'l'
+int crc_search_sweep(uint8_t width, char endian, bool nopresets, bool nobrute, char *hexs[], int count) {
+
+    if (width == 0 || width > CRCS_SWEEP_MAX_WIDTH || count < 1) {
+        return PM3_EINVARG;
+    }
+
+    SETBMP();
+
+    model_t model = MZERO;
+    int rflags = 0;
+    if (endian == 'b') {
+        model.flags &= ~(P_REFIN | P_REFOUT);
+        model.flags |= P_RTJUST;
+        rflags |= R_HAVERI | R_HAVERO;
+    } else if (endian == 'l') {
+        model.flags |= (P_REFIN | P_REFOUT);
+        model.flags &= ~P_RTJUST;
+        rflags |= R_HAVERI | R_HAVERO;
+    }
+
+    poly_t *apolys = calloc(count, sizeof(poly_t));
+    if (apolys == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+    for (int i = 0; i < count; i++) {
+        apolys[i] = strtop(hexs[i], model.flags, 8);
+    }
+
+    bool found = false;
+    int pass = 0;
+    int res = PM3_SUCCESS;
+
+    // scan against preset models
+    if (nopresets == false) {
+        do {
+            crcs_bitstr_t *cw = crc_polys_to_bitstr(apolys, count);
+            if (cw == NULL) {
+                res = PM3_EMALLOC;
+                goto out;
+            }
+
+            model_t pset = MZERO;
+            for (int psets = mcount(); psets > 0;) {
+                mbynum(&pset, --psets);
+                // skip if different width, or refin or refout don't match
+                if (plen(pset.spoly) != width || (model.flags ^ pset.flags) & (P_REFIN | P_REFOUT)) {
+                    continue;
+                }
+
+                poly_t x = pclone(pset.xorout);
+                if (pset.flags & P_REFOUT) {
+                    prev(&x);
+                }
+                crcs_kernel_t k;
+                crcs_kernel_init(&k, width, crc_poly_u64(pset.spoly, width), crc_poly_u64(pset.init, width), crc_poly_u64(x, width));
+                pfree(&x);
+
+                int j = 0;
+                while (j < count && crcs_codeword_ok(&k, &cw[j])) {
+                    j++;
+                }
+                if (j == count) {
+                    // the selected model solved all arguments
+                    ufound(&pset);
+                    found = true;
+                }
+            }
+            mfree(&pset);
+            crc_free_bitstr(cw);
+
+            // toggle refIn/refOut and reflect arguments
+            if (~rflags & R_HAVERI) {
+                model.flags ^= P_REFIN | P_REFOUT;
+                for (int i = 0; i < count; i++) {
+                    prevch(&apolys[i], 8);
+                }
+            }
+        } while (~rflags & R_HAVERI && ++pass < 2);
+    }
+
+    if (found) {
+        goto out;
+    }
+
+    if (nobrute) {
+        uerror("no models found");
+        goto out;
+    }
+
+    if (width > 16) {
+        PrintAndLogEx(INFO, "searching " _YELLOW_("2^%u") " polynomials per pass on " _YELLOW_("%d") " threads...", width - 1, num_CPUs());
+    }
+
+    bool have_pair = false;
+    uint64_t t1 = msclock();
+
+    pass = 0;
+    do {
+        crcs_bitstr_t *cw = crc_polys_to_bitstr(apolys, count);
+        if (cw == NULL) {
+            res = PM3_EMALLOC;
+            goto out;
+        }
+
+        uint64_t *polys = NULL;
+        size_t npolys = 0;
+        int sres = crcs_sweep(width, cw, count, 0, &polys, &npolys);
+        crc_free_bitstr(cw);
+        if (sres == PM3_EMALLOC) {
+            PrintAndLogEx(WARNING, "Failed to allocate memory");
+            res = sres;
+            goto out;
+        }
+        have_pair |= (sres == PM3_SUCCESS);
+
+        // candidates come out ascending, the order reveng itself finds them in
+        for (size_t i = 0; i < npolys; i++) {
+            model_t guess = MZERO;
+            guess.flags = model.flags;
+            guess.spoly = crc_u64_poly(polys[i], width);
+            poly_t qpoly = PZERO;
+
+            model_t *candmods = reveng(&guess, qpoly, rflags | R_HAVEP, count, apolys);
+            model_t *mptr = candmods;
+            while (mptr && plen(mptr->spoly)) {
+                found = true;
+                mfree(mptr++);
+            }
+            free(candmods);
+            pfree(&guess.spoly);
+        }
+        free(polys);
+
+        if (~rflags & R_HAVERI) {
+            model.flags ^= P_REFIN | P_REFOUT;
+            for (int i = 0; i < count; i++) {
+                prevch(&apolys[i], 8);
+            }
+        }
+    } while (~rflags & R_HAVERI && ++pass < 2);
+
+    PrintAndLogEx(DEBUG, "sweep took %.1f s", (float)(msclock() - t1) / 1000.0);
+
+    if (have_pair == false) {
+        PrintAndLogEx(HINT, "Hint: the search needs at least two samples of the same length");
+    }
+    if (found == false) {
+        uerror("no models found");
+    }
+
+out:
+    for (int i = 0; i < count; i++) {
+        pfree(&apolys[i]);
+    }
+    free(apolys);
+    mfree(&model);
+    return res;
+}
+
+// reveng -w <width> -s [-b|-l|-F|-G] <hex> ... is all the sweep takes over,
+// anything else stays with reveng_main()
+static bool crc_parse_sweep(int argc, char *argv[], uint8_t *width, char *endian, bool *nopresets, bool *nobrute, int *first) {
+    bool search = false;
+    long w = 0;
+    int i = 1;
+
+    *endian = 0;
+    *nopresets = false;
+    *nobrute = false;
+
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        const char *a = argv[i];
+        if (strcmp(a, "-s") == 0) {
+            search = true;
+        } else if (strcmp(a, "-b") == 0 || strcmp(a, "-l") == 0) {
+            *endian = a[1];
+        } else if (strcmp(a, "-F") == 0) {
+            *nopresets = true;
+        } else if (strcmp(a, "-G") == 0) {
+            *nobrute = true;
+        } else if (strncmp(a, "-w", 2) == 0) {
+            const char *v = a + 2;
+            if (*v == 0) {
+                if (++i >= argc) {
+                    return false;
+                }
+                v = argv[i];
+            }
+            char *end = NULL;
+            w = strtol(v, &end, 10);
+            if (end == v || *end != 0) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    if (search == false || w < 1 || w > CRCS_SWEEP_MAX_WIDTH || i >= argc) {
+        return false;
+    }
+
+    for (int j = i; j < argc; j++) {
+        if (argv[j][0] == '-') {
+            return false;
+        }
+    }
+
+    *width = (uint8_t)w;
+    *first = i;
+    return true;
+}
+
+// frames in the preset pass benchmark
+#define CRC_SEARCH_FRAMES 64
+
+static uint32_t crc_rand(uint32_t *x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+int crc_search_selftest(void) {
+
+    PrintAndLogEx(INFO, "------- " _CYAN_("CRC search self test") " -------");
+
+    SETBMP();
+
+    uint32_t seed = 0x1234567;
+    static const size_t lens[] = { 1, 3, 9, 33 };
+    char hex[2 * 64 + 1];
+    uint8_t tmp[64];
+    bool isok = true;
+    int res = PM3_SUCCESS;
+    char *frames[CRC_SEARCH_FRAMES] = {0};
+    char *msgs[CRC_SEARCH_FRAMES] = {0};
+    crc_sample_t *s = NULL;
+
+    // every preset, straight and reversed, against RunModel()
+    int nmodels = mcount();
+    int tested = 0;
+    for (int i = 0; i < nmodels && isok; i++) {
+        for (int r = 0; r < 2 && isok; r++) {
+            crc_compiled_t m;
+            crc_compile_preset(i, r, &m);
+            if (m.compiled == false) {
+                continue;
+            }
+
+            size_t crcchars = ((m.width + 7) / 8) * 2;
+            for (size_t l = 0; l < ARRAYLEN(lens); l++) {
+                for (size_t j = 0; j < lens[l]; j++) {
+                    snprintf(hex + (j * 2), 3, "%02x", crc_rand(&seed) & 0xFF);
+                }
+                memset(hex + (lens[l] * 2), '0', crcchars);
+                hex[(lens[l] * 2) + crcchars] = 0;
+
+                char *p = hex;
+                s = crc_load_samples(&p, 1);
+                if (s == NULL) {
+                    res = PM3_EMALLOC;
+                    goto out;
+                }
+
+                char want[50 + 1] = {0}, got[50 + 1] = {0};
+                char msg[2 * 64 + 1] = {0};
+                memcpy(msg, hex, lens[l] * 2);
+                RunModel((char *)m.name, msg, r, 0, want);
+                str_lower(want);
+                crc_sample_value(&m, s, crcchars, tmp, got);
+                crc_free_samples(s, 1);
+                s = NULL;
+
+                if (strncmp(want, got, crcchars)) {
+                    PrintAndLogEx(FAILED, "%s%s, %s... got %s, want %s", m.name, r ? " reversed" : "", msg, got, want);
+                    isok = false;
+                    break;
+                }
+                tested++;
+            }
+        }
+    }
+    PrintAndLogEx((isok) ? SUCCESS : FAILED, "presets.... %d vectors ( %s )", tested, isok ? _GREEN_("ok") : _RED_("fail"));
+
+    // preset pass over a batch of captured frames, every model on every
+    // frame, straight and reversed. reveng's string API against the kernels
+    for (int i = 0; i < CRC_SEARCH_FRAMES; i++) {
+        frames[i] = calloc((2 * 40) + 1, sizeof(char));
+        msgs[i] = calloc((2 * 32) + 1, sizeof(char));
+        if (frames[i] == NULL || msgs[i] == NULL) {
+            res = PM3_EMALLOC;
+            goto out;
+        }
+        for (int j = 0; j < 40; j++) {
+            snprintf(frames[i] + (j * 2), 3, "%02x", crc_rand(&seed) & 0xFF);
+        }
+        memcpy(msgs[i], frames[i], 2 * 32);
+    }
+
+    char *models[128];
+    uint8_t widths[128] = {0};
+    int cnt = 0;
+    uint64_t t1 = msclock();
+    if (nmodels <= ARRAYLEN(models) && GetModels(models, &cnt, widths)) {
+        for (int i = 0; i < cnt; i++) {
+            for (int j = 0; j < CRC_SEARCH_FRAMES; j++) {
+                char val[50 + 1];
+                RunModel(models[i], msgs[j], false, 0, val);
+                RunModel(models[i], msgs[j], true, 0, val);
+            }
+            free(models[i]);
+        }
+    }
+    t1 = msclock() - t1;
+
+    uint64_t t2 = msclock();
+    s = crc_load_samples(frames, CRC_SEARCH_FRAMES);
+    if (s == NULL) {
+        res = PM3_EMALLOC;
+        goto out;
+    }
+    for (int i = 0; i < nmodels; i++) {
+        for (int r = 0; r < 2; r++) {
+            crc_compiled_t m;
+            crc_compile_preset(i, r, &m);
+            size_t crcchars = ((m.width + 7) / 8) * 2;
+            char val[50 + 1];
+            for (int j = 0; j < CRC_SEARCH_FRAMES && m.compiled; j++) {
+                crc_sample_value(&m, &s[j], crcchars, tmp, val);
+            }
+        }
+    }
+    crc_free_samples(s, CRC_SEARCH_FRAMES);
+    s = NULL;
+    t2 = msclock() - t2;
+    PrintAndLogEx(INFO, "preset pass %d frames... reveng " _YELLOW_("%" PRIu64) " ms, table kernels " _YELLOW_("%" PRIu64) " ms"
+                  , CRC_SEARCH_FRAMES
+                  , t1
+                  , t2
+                 );
+
+    // sweep, CRC-16/IBM-3740 (poly 0x1021) codewords of equal length
+    uint8_t cwbuf[4][10];
+    crcs_bitstr_t cw[4];
+    crcs_kernel_t k;
+    crcs_kernel_init(&k, 16, 0x1021, 0xFFFF, 0);
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 8; j++) {
+            cwbuf[i][j] = crc_rand(&seed) & 0xFF;
+        }
+        uint16_t crc = crcs_kernel_run(&k, cwbuf[i], 64);
+        cwbuf[i][8] = crc >> 8;
+        cwbuf[i][9] = crc & 0xFF;
+        cw[i].bits = cwbuf[i];
+        cw[i].nbits = 80;
+    }
+
+    uint64_t *polys = NULL;
+    size_t npolys = 0;
+    bool sweepok = false;
+    t1 = msclock();
+    if (crcs_sweep(16, cw, 4, 0, &polys, &npolys) == PM3_SUCCESS) {
+        for (size_t i = 0; i < npolys; i++) {
+            sweepok |= (polys[i] == 0x1021);
+        }
+    }
+    t1 = msclock() - t1;
+    free(polys);
+    isok &= sweepok;
+    PrintAndLogEx((sweepok) ? SUCCESS : FAILED, "sweep...... width 16, %zu candidate(s) in %" PRIu64 " ms, %d threads ( %s )"
+                  , npolys
+                  , t1
+                  , num_CPUs()
+                  , sweepok ? _GREEN_("ok") : _RED_("fail")
+                 );
+
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx((isok) ? SUCCESS : FAILED, "CRC search ( %s )", isok ? _GREEN_("ok") : _RED_("fail"));
+    res = isok ? PM3_SUCCESS : PM3_ESOFT;
+
+out:
+    for (int i = 0; i < CRC_SEARCH_FRAMES; i++) {
+        free(frames[i]);
+        free(msgs[i]);
+    }
+    if (res == PM3_EMALLOC) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+    }
+    return res;
+}
+
 int CmdCrc(const char *Cmd) {
     char c[1024 + 7];
     snprintf(c, sizeof(c), "reveng ");
@@ -586,8 +1159,15 @@ int CmdCrc(const char *Cmd) {
     char *argv[MAX_ARGS];
     int argc = split(c, argv);
 
-    if (argc == 3 && memcmp(argv[1], "-g", 2) == 0) {
-        CmdrevengSearch(argv[2]);
+    uint8_t width = 0;
+    char endian = 0;
+    bool nopresets = false, nobrute = false;
+    int first = 0;
+
+    if (argc >= 3 && memcmp(argv[1], "-g", 2) == 0) {
+        crc_search_presets(argv + 2, argc - 2);
+    } else if (crc_parse_sweep(argc, argv, &width, &endian, &nopresets, &nobrute, &first)) {
+        crc_search_sweep(width, endian, nopresets, nobrute, argv + first, argc - first);
     } else {
         reveng_main(argc, argv);
     }
@@ -597,4 +1177,3 @@ int CmdCrc(const char *Cmd) {
     }
     return PM3_SUCCESS;
 }
-
@@ -27,4 +27,9 @@ int CmdCrc(const char *Cmd);
 
 int GetModels(char *Models[], int *count, uint8_t *width);
 int RunModel(char *inModel, char *inHexStr, bool reverse, char endian, char *result);
+
+// table driven search, every hex string is data with its CRC appended
+int crc_search_presets(char *hexs[], int count);
+int crc_search_sweep(uint8_t width, char endian, bool nopresets, bool nobrute, char *hexs[], int count);
+int crc_search_selftest(void);
 #endif
@@ -45,6 +45,7 @@
 #include "qrcode/qrcode.h"       // QR Code lib
 #include "pm3_dsp.h"             // FFT, windows, spectra
 #include "pm3_fit.h"             // matched filter hypothesis bank
+#include "util_posix.h"          // msclock
 
 #define FITSCORE_DEFAULT_WINDOW  16384
 #define FITSCORE_MIN_SYMBOLS     128
@@ -1104,6 +1105,7 @@ static int detectclock_fit(int mod_mask, pm3_hyp_t *hyp) {
     pm3_fit_t fit;
     int res = pm3_fit_run(sig, count, &opts, &fit);
     free(sig);
+    pm3_fit_cache_clear();
 
     if (res != PM3_SUCCESS) {
         return res;
@@ -4191,6 +4193,261 @@ static int dsp_prepare(int start, int size, double **sig, size_t *count, size_t
     return PM3_SUCCESS;
 }
 
+static uint64_t dsp_test_rand(uint64_t *x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+static double dsp_test_sample(uint64_t *x) {
+    return ((double)(dsp_test_rand(x) >> 11) / (double)(1ULL << 53)) - 0.5;
+}
+
+// largest difference between two spectra, relative to the largest magnitude
+static double dsp_test_err(const pm3_cplx_t *a, const pm3_cplx_t *b, size_t n) {
+    double err = 0.0, top = 1e-30;
+    for (size_t i = 0; i < n; i++) {
+        const double dr = a[i].re - b[i].re;
+        const double di = a[i].im - b[i].im;
+        err = MAX(err, sqrt((dr * dr) + (di * di)));
+        top = MAX(top, sqrt((b[i].re * b[i].re) + (b[i].im * b[i].im)));
+    }
+    return err / top;
+}
+
+static void dsp_test_dft(const pm3_cplx_t *in, pm3_cplx_t *out, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            const double ang = -2.0 * M_PI * (double)((k * i) % n) / (double)n;
+            re += (in[i].re * cos(ang)) - (in[i].im * sin(ang));
+            im += (in[i].re * sin(ang)) + (in[i].im * cos(ang));
+        }
+        out[k].re = re;
+        out[k].im = im;
+    }
+}
+
+// pm3_fft and pm3_rfft / pm3_irfft against a plain DFT for the small sizes, every kernel
+// against the radix-2 reference at the largest size and the threaded STFT
+// against a single thread.  --bench adds timings over a full graph buffer.
+static int dsp_selftest(bool bench) {
+
+    const size_t big = PM3_DSP_MAX_FFT;
+    pm3_cplx_t *in = calloc(big, sizeof(pm3_cplx_t));
+    pm3_cplx_t *ref = calloc(big, sizeof(pm3_cplx_t));
+    pm3_cplx_t *got = calloc(big, sizeof(pm3_cplx_t));
+    double *real = calloc(MAX_GRAPH_TRACE_LEN, sizeof(double));
+    if (in == NULL || ref == NULL || got == NULL || real == NULL) {
+        free(in);
+        free(ref);
+        free(got);
+        free(real);
+        return PM3_EMALLOC;
+    }
+
+    const pm3_fft_kernel_t *kernels = NULL;
+    const size_t nkernels = pm3_fft_kernels(&kernels);
+    uint64_t x = 0x2545F4914F6CDD1DULL;
+    bool isok = true;
+
+    for (size_t k = 0; k < nkernels; k++) {
+
+        bool kok = true;
+
+        for (size_t n = 2; n <= 2048; n <<= 1) {
+
+            pm3_fft_plan_t *plan = pm3_fft_plan_create(n);
+            if (plan == NULL) {
+                kok = false;
+                break;
+            }
+            plan->pass = kernels[k].pass;
+
+            for (size_t i = 0; i < n; i++) {
+                in[i].re = dsp_test_sample(&x);
+                in[i].im = dsp_test_sample(&x);
+            }
+            dsp_test_dft(in, ref, n);
+
+            memcpy(got, in, n * sizeof(pm3_cplx_t));
+            pm3_fft(plan, got, false);
+            kok &= (dsp_test_err(got, ref, n) < 1e-12);
+
+            pm3_fft(plan, got, true);
+            kok &= (dsp_test_err(got, in, n) < 1e-12);
+
+            pm3_fft_plan_destroy(plan);
+        }
+
+        pm3_fft_plan_t *plan = pm3_fft_plan_create(big);
+        if (plan == NULL) {
+            kok = false;
+        } else {
+            plan->pass = kernels[k].pass;
+            for (size_t i = 0; i < big; i++) {
+                in[i].re = dsp_test_sample(&x);
+                in[i].im = dsp_test_sample(&x);
+            }
+            memcpy(ref, in, big * sizeof(pm3_cplx_t));
+            pm3_fft_radix2(plan, ref, false);
+            memcpy(got, in, big * sizeof(pm3_cplx_t));
+            pm3_fft(plan, got, false);
+            kok &= (dsp_test_err(got, ref, big) < 1e-12);
+            pm3_fft_plan_destroy(plan);
+        }
+
+        PrintAndLogEx(INFO, "FFT kernel %-6s ( %s )", kernels[k].name, kok ? _GREEN_("ok") : _RED_("fail"));
+        isok &= kok;
+    }
+
+    bool rok = true;
+    for (size_t n = 2; n <= 4096; n <<= 1) {
+
+        pm3_rfft_plan_t *plan = pm3_rfft_plan_create(n);
+        if (plan == NULL) {
+            rok = false;
+            break;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            real[i] = dsp_test_sample(&x);
+            in[i].re = real[i];
+            in[i].im = 0.0;
+        }
+        dsp_test_dft(in, ref, n);
+        pm3_rfft(plan, real, got);
+        rok &= (dsp_test_err(got, ref, (n / 2) + 1) < 1e-12);
+
+        // and back again, into the spare half of the input buffer
+        double *back = (double *)&in[n];
+        pm3_irfft(plan, got, back);
+        for (size_t i = 0; i < n; i++) {
+            rok &= (fabs(back[i] - real[i]) < 1e-12);
+        }
+
+        pm3_rfft_plan_destroy(plan);
+    }
+    PrintAndLogEx(INFO, "real FFT          ( %s )", rok ? _GREEN_("ok") : _RED_("fail"));
+    isok &= rok;
+
+    // an FSK like test signal, two tones switching every 640 samples
+    for (size_t i = 0; i < MAX_GRAPH_TRACE_LEN; i++) {
+        const double f = ((i / 640) & 1) ? 1.0 / 8.0 : 1.0 / 10.0;
+        real[i] = sin(2.0 * M_PI * f * (double)i) + (0.1 * dsp_test_sample(&x));
+    }
+
+    pm3_stft_t st1, stn;
+    bool sok = (pm3_stft_threads(real, 400000, 1024, 256, PM3_WIN_HANN, 0.0, 1, &st1) == PM3_SUCCESS);
+    if (sok) {
+        sok = (pm3_stft_threads(real, 400000, 1024, 256, PM3_WIN_HANN, 0.0, 4, &stn) == PM3_SUCCESS);
+        if (sok) {
+            sok = (st1.nframes == stn.nframes) &&
+                  (memcmp(st1.ridge, stn.ridge, st1.nframes * st1.nbins * sizeof(double)) == 0) &&
+                  (memcmp(st1.peak_freq, stn.peak_freq, st1.nframes * sizeof(double)) == 0);
+            pm3_stft_free(&stn);
+        }
+        pm3_stft_free(&st1);
+    }
+    PrintAndLogEx(INFO, "threaded STFT     ( %s )", sok ? _GREEN_("ok") : _RED_("fail"));
+    isok &= sok;
+
+    if (bench && isok) {
+
+        PrintAndLogEx(NORMAL, "");
+        PrintAndLogEx(INFO, "--- " _CYAN_("benchmark") " ---------------------------------");
+
+        const int rounds = 8;
+        pm3_fft_plan_t *plan = pm3_fft_plan_create(big);
+        pm3_rfft_plan_t *rplan = pm3_rfft_plan_create(big);
+
+        if (plan != NULL && rplan != NULL) {
+
+            uint64_t t1 = msclock();
+            for (int r = 0; r < rounds; r++) {
+                memcpy(got, in, big * sizeof(pm3_cplx_t));
+                pm3_fft_radix2(plan, got, false);
+            }
+            t1 = msclock() - t1;
+            const double base_ms = (double)t1 / rounds;
+            PrintAndLogEx(INFO, "%zu point complex, radix-2  " _YELLOW_("%7.2f") " ms", big, base_ms);
+
+            for (size_t k = 0; k < nkernels; k++) {
+                plan->pass = kernels[k].pass;
+                t1 = msclock();
+                for (int r = 0; r < rounds; r++) {
+                    memcpy(got, in, big * sizeof(pm3_cplx_t));
+                    pm3_fft(plan, got, false);
+                }
+                t1 = msclock() - t1;
+                const double ms = (double)t1 / rounds;
+                PrintAndLogEx(INFO, "%zu point complex, %-8s " _YELLOW_("%7.2f") " ms  x%.1f", big, kernels[k].name, ms, base_ms / MAX(ms, 0.01));
+            }
+
+            t1 = msclock();
+            for (int r = 0; r < rounds; r++) {
+                pm3_rfft(rplan, real, got);
+            }
+            t1 = msclock() - t1;
+            const double ms = (double)t1 / rounds;
+            PrintAndLogEx(INFO, "%zu point real, %-8s    " _YELLOW_("%7.2f") " ms  x%.1f", big, kernels[nkernels - 1].name, ms, base_ms / MAX(ms, 0.01));
+        }
+        pm3_fft_plan_destroy(plan);
+        pm3_rfft_plan_destroy(rplan);
+
+        // a whole graph buffer through the spectrogram, the old way first:
+        // one radix-2 complex transform per frame
+        const size_t n = 1024, hop = 256;
+        const size_t nframes = ((MAX_GRAPH_TRACE_LEN - n) / hop) + 1;
+
+        plan = pm3_fft_plan_create(n);
+        if (plan != NULL) {
+            double sink = 0.0;
+            uint64_t t1 = msclock();
+            for (size_t f = 0; f < nframes; f++) {
+                for (size_t i = 0; i < n; i++) {
+                    got[i].re = real[(f * hop) + i];
+                    got[i].im = 0.0;
+                }
+                pm3_fft_radix2(plan, got, false);
+                for (size_t i = 0; i <= n / 2; i++) {
+                    sink += sqrt((got[i].re * got[i].re) + (got[i].im * got[i].im));
+                }
+            }
+            t1 = msclock() - t1;
+            pm3_fft_plan_destroy(plan);
+            PrintAndLogEx(INFO, "STFT %zu frames, radix-2 complex  " _YELLOW_("%5" PRIu64) " ms  ( %.0f )", nframes, t1, sink);
+
+            const int threads[] = { 1, 0 };
+            for (size_t i = 0; i < ARRAYLEN(threads); i++) {
+                pm3_stft_t st;
+                uint64_t t2 = msclock();
+                int res = pm3_stft_threads(real, MAX_GRAPH_TRACE_LEN, n, hop, PM3_WIN_HANN, 0.0, threads[i], &st);
+                t2 = msclock() - t2;
+                if (res == PM3_SUCCESS) {
+                    pm3_stft_free(&st);
+                }
+                PrintAndLogEx(INFO, "STFT %zu frames, real, %2d threads  " _YELLOW_("%5" PRIu64) " ms  x%.1f"
+                              , nframes
+                              , threads[i] ? threads[i] : num_CPUs()
+                              , t2
+                              , (double)t1 / (double)(t2 ? t2 : 1)
+                             );
+            }
+        }
+    }
+
+    free(in);
+    free(ref);
+    free(got);
+    free(real);
+
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx(INFO, "DSP self test ( %s )", isok ? _GREEN_("ok") : _RED_("fail"));
+    return isok ? PM3_SUCCESS : PM3_ESOFT;
+}
+
 // Frequencies are reported in cycles/sample as the primary unit.  Hz is only
 // printed when the user tells us the sample rate with --fs: the client keeps no
 // record of the divisor a trace was captured with, and assuming 125 kHz would
@@ -4207,6 +4464,8 @@ static int CmdFFT(const char *Cmd) {
                   "data fft --size 4096 --win blackman         --> 4096 point transform, blackman window\n"
                   "data fft --start 1000 --size 8192 --db      --> magnitudes in dB relative to the peak\n"
                   "data fft --size 4096 --graph                --> put the spectrum in the graph window\n"
+                  "data fft --test                             --> check the FFT kernels\n"
+                  "data fft --bench                            --> check and time the FFT kernels"
                  );
 
     void *argtable[] = {
@@ -4218,6 +4477,8 @@ static int CmdFFT(const char *Cmd) {
         arg_lit0(NULL, "graph", "write the magnitude spectrum into the GraphBuffer and repaint"),
         arg_int0(NULL, "fs", "<int>", "sample rate in Hz, adds a frequency column in Hz"),
         arg_int0(NULL, "bins", "<int>", "how many bins to print (def 32, 0 for all)"),
+        arg_lit0(NULL, "test", "self test of the FFT kernels, real FFT and threaded STFT"),
+        arg_lit0(NULL, "bench", "self test, then time them over a full sized graph buffer"),
         arg_param_end
     };
     CLIExecWithReturn(ctx, Cmd, argtable, true);
@@ -4233,8 +4494,14 @@ static int CmdFFT(const char *Cmd) {
     bool to_graph = arg_get_lit(ctx, 5);
     int fs = arg_get_int_def(ctx, 6, 0);
     int want_bins = arg_get_int_def(ctx, 7, 32);
+    bool selftest = arg_get_lit(ctx, 8);
+    bool bench = arg_get_lit(ctx, 9);
     CLIParserFree(ctx);
 
+    if (selftest || bench) {
+        return dsp_selftest(bench);
+    }
+
     pm3_window_t win = PM3_WIN_HANN;
     if (win_len > 0 && pm3_window_from_str(win_str, &win) == false) {
         PrintAndLogEx(WARNING, "unknown window `%s`, expected hann, hamming, blackman or rect", win_str);
@@ -4953,6 +5220,27 @@ static void print_fit_table(const pm3_fit_t *fit, size_t rows) {
     }
 }
 
+static void print_fit_timing(const pm3_fit_timing_t *t) {
+
+    const uint64_t total = MAX(t->total_us, (uint64_t)1);
+
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx(INFO, "--- " _CYAN_("Timing") " ---------------------------------------------");
+    PrintAndLogEx(INFO, "  signal stats.. %8.2f ms  %5.1f %%", t->stats_us / 1000.0, (100.0 * t->stats_us) / total);
+    PrintAndLogEx(INFO, "  trace FFT..... %8.2f ms  %5.1f %%", t->sig_fft_us / 1000.0, (100.0 * t->sig_fft_us) / total);
+    PrintAndLogEx(INFO, "  bank.......... %8.2f ms  %5.1f %%  ( %d thread%s )"
+                  , t->bank_us / 1000.0
+                  , (100.0 * t->bank_us) / total
+                  , t->threads
+                  , (t->threads == 1) ? "" : "s"
+                 );
+    PrintAndLogEx(INFO, "    templates... %8.2f ms  ( %u cached, %u built )", t->tpl_us / 1000.0, t->cache_hits, t->cache_misses);
+    PrintAndLogEx(INFO, "    correlate... %8.2f ms", t->corr_us / 1000.0);
+    PrintAndLogEx(INFO, "    score....... %8.2f ms", t->score_us / 1000.0);
+    PrintAndLogEx(INFO, "  ranking....... %8.2f ms  %5.1f %%", t->rank_us / 1000.0, (100.0 * t->rank_us) / total);
+    PrintAndLogEx(INFO, "  total......... " _YELLOW_("%8.2f") " ms", t->total_us / 1000.0);
+}
+
 static int CmdFitScore(const char *Cmd) {
 
     CLIParserContext *ctx;
@@ -4968,6 +5256,7 @@ static int CmdFitScore(const char *Cmd) {
                   "data fitscore --mod ask --top 5      --> ASK hypotheses only\n"
                   "data fitscore --clk 64 --all         --> everything at clock 64\n"
                   "data fitscore --verbose              --> also put the rank 1 correlator output in the graph\n"
+                  "data fitscore --timing --threads 1   --> single threaded, show where the time went\n"
                  );
 
     void *argtable[] = {
@@ -4979,6 +5268,8 @@ static int CmdFitScore(const char *Cmd) {
         arg_int0(NULL, "top", "<int>", "rows to print (def 10)"),
         arg_lit0(NULL, "all", "print every scored hypothesis"),
         arg_lit0("v", "verbose", "write the rank 1 correlator output into the GraphBuffer"),
+        arg_lit0(NULL, "timing", "show where the time went"),
+        arg_int0(NULL, "threads", "<int>", "scoring threads (def one per CPU)"),
         arg_param_end
     };
     CLIExecWithReturn(ctx, Cmd, argtable, true);
@@ -4994,9 +5285,12 @@ static int CmdFitScore(const char *Cmd) {
     int top = arg_get_int_def(ctx, 5, 10);
     bool show_all = arg_get_lit(ctx, 6);
     bool verbose = arg_get_lit(ctx, 7);
+    bool show_timing = arg_get_lit(ctx, 8);
+    int threads = arg_get_int_def(ctx, 9, 0);
     CLIParserFree(ctx);
 
     pm3_fit_opts_t opts = {0};
+    opts.threads = MAX(threads, 0);
 
     if (parse_mod_mask(mod_str, &opts.mod_mask) != PM3_SUCCESS) {
         PrintAndLogEx(WARNING, "unknown modulation `%s`, expected ask, fsk, psk or nrz", mod_str);
@@ -5054,6 +5348,7 @@ static int CmdFitScore(const char *Cmd) {
     pm3_fit_t fit;
     res = pm3_fit_run(sig, count, &opts, &fit);
     free(sig);
+    pm3_fit_cache_clear();
 
     if (res == PM3_ESOFT) {
         PrintAndLogEx(WARNING, "no hypothesis had enough symbols to score");
@@ -5120,6 +5415,10 @@ static int CmdFitScore(const char *Cmd) {
         PrintAndLogEx(WARNING, "  confidence.... " _RED_("%.2f") " dB ahead of the next different decode, this is ambiguous", best->margin);
     }
 
+    if (show_timing) {
+        print_fit_timing(&fit.timing);
+    }
+
     PrintAndLogEx(INFO, "");
 
     if (verbose && fit.corr != NULL) {
@@ -5457,6 +5756,7 @@ static int CmdAutoDemod(const char *Cmd) {
                   "data autodemod --dry-run           --> decide and print, demodulate nothing\n"
                   "data autodemod --thres 6           --> insist on a 6 dB margin before trusting rank 1\n"
                   "data autodemod --invert --amp      --> pass invert and amplify through to the demod\n"
+                  "data autodemod --dry-run --timing  --> decide only, show where the time went\n"
                  );
 
     void *argtable[] = {
@@ -5468,6 +5768,7 @@ static int CmdAutoDemod(const char *Cmd) {
         arg_lit0("a", "amp", "amplify the signal before ASK demodulation"),
         arg_lit0("i", "invert", "invert the demodulated output"),
         arg_lit0("v", "verbose", "show the demodulator's own output"),
+        arg_lit0(NULL, "timing", "show where the hypothesis scoring spent its time"),
         arg_param_end
     };
     CLIExecWithReturn(ctx, Cmd, argtable, true);
@@ -5479,6 +5780,7 @@ static int CmdAutoDemod(const char *Cmd) {
     bool amp = arg_get_lit(ctx, 5);
     bool invert = arg_get_lit(ctx, 6);
     bool verbose = arg_get_lit(ctx, 7);
+    bool show_timing = arg_get_lit(ctx, 8);
     CLIParserFree(ctx);
 
     if (size == 0) {
@@ -5589,6 +5891,8 @@ static int CmdAutoDemod(const char *Cmd) {
         res = pm3_fit_run(sig, count, &opts, &fit);
     }
     free(sig);
+    // kept for the retry only, not for the rest of the session
+    pm3_fit_cache_clear();
 
     if (res != PM3_SUCCESS) {
         PrintAndLogEx(WARNING, "no hypothesis fit the signal");
@@ -5596,6 +5900,11 @@ static int CmdAutoDemod(const char *Cmd) {
         return res;
     }
 
+    if (show_timing) {
+        print_fit_timing(&fit.timing);
+        PrintAndLogEx(NORMAL, "");
+    }
+
     const pm3_hyp_t *best = &fit.items[0];
 
     PrintAndLogEx(SUCCESS, "  decision...... " _GREEN_("%s / %s") " at clock " _GREEN_("%.2f")
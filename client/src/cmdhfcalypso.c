@@ -33,6 +33,7 @@
 #include "emv/emvcore.h"
 #include "emv/tlv.h"
 #include "fileutils.h"
+#include "rescache.h"
 #include "iso7816/apduinfo.h"
 #include "iso7816/iso7816core.h"
 #include "protocols.h"
@@ -690,35 +691,40 @@ static json_t *calypso_json_resource_root(calypso_resource_t *resource) {
         return NULL;
     }
 
-    if (resource->loaded) {
-        return resource->root;
+    // once a file was found missing or invalid, don't look again this session
+    if (resource->loaded && resource->root == NULL) {
+        return NULL;
     }
     resource->loaded = true;
 
-    char *path = NULL;
-    if (searchFile(&path, RESOURCES_SUBDIR, resource->path, ".json", true) != PM3_SUCCESS) {
+    // the session cache parses the file once, and again only when it changed on disk
+    json_t *root = rescache_json_load(resource->path, ".json", true);
+    if (root == NULL) {
+        json_decref(resource->root);
+        resource->root = NULL;
         return NULL;
     }
 
-    json_error_t error;
-    resource->root = json_load_file(path, 0, &error);
-    if (resource->root == NULL) {
-        PrintAndLogEx(ERR, "json (%s) error on line %d: %s", path, error.line, error.text);
-        free(path);
-        return NULL;
+    if (root == resource->root) {
+        json_decref(root);
+        return resource->root;
     }
 
-    if (json_is_array(resource->root) == false) {
+    char path[FILE_PATH_SIZE];
+    rescache_json_path(root, path, sizeof(path));
+
+    if (json_is_array(root) == false) {
         PrintAndLogEx(ERR, "Invalid json (%s) format. root must be an array.", path);
-        json_decref(resource->root);
-        resource->root = NULL;
+        json_decref(root);
+        root = NULL;
     } else {
         PrintAndLogEx(DEBUG, "Loaded file " _YELLOW_("%s") " " _GREEN_("%zu") " records ( " _GREEN_("ok") " )",
                       path,
-                      json_array_size(resource->root));
+                      json_array_size(root));
     }
 
-    free(path);
+    json_decref(resource->root);
+    resource->root = root;
     return resource->root;
 }
 
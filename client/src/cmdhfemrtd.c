@@ -53,6 +53,29 @@
 
 #define EMRTD_KMAC_LEN              16
 
+// EF.ATR/INFO on the MF, ICAO 9303-10 3.11.1
+#define EMRTD_EF_ATRINFO            0x2F01
+
+// max files in a dump, for the timing summary
+#define EMRTD_MAX_TIMINGS           24
+
+typedef struct {
+    const char *name;
+    size_t bytes;
+    uint32_t apdus;
+    uint64_t ms;
+} emrtd_read_stats_t;
+
+// what the document told us in EF.ATR/INFO, reset on every connect
+static emrtd_atrinfo_t emrtd_atrinfo;
+// plain bytes per READ BINARY, 0 picks them from EF.ATR/INFO and the frame size
+static size_t emrtd_read_chunk_size = 0;
+static bool emrtd_read_chunk_warned = false;
+// last file read, and every file of the running dump
+static emrtd_read_stats_t emrtd_read_stats;
+static emrtd_read_stats_t emrtd_timings[EMRTD_MAX_TIMINGS];
+static size_t emrtd_timings_count = 0;
+
 // DESKey Types
 static const uint8_t KENC_type[4] = {0x00, 0x00, 0x00, 0x01};
 static const uint8_t KMAC_type[4] = {0x00, 0x00, 0x00, 0x02};
@@ -315,8 +338,28 @@ static int emrtd_external_authenticate(uint8_t *data, int length, uint8_t *datao
     return emrtd_exchange_commands((sAPDU_t) {0, ISO7816_EXTERNAL_AUTHENTICATION, 0, 0, length, data}, true, length, dataout, maxdataoutlen, dataoutlen, false, true);
 }
 
+// Le above 256 goes out as an extended length APDU
+static bool emrtd_exchange_le(sAPDU_t apdu, size_t le, uint8_t *dataout, size_t maxdataoutlen, size_t *dataoutlen) {
+    emrtd_read_stats.apdus++;
+    if (le <= 0x100) {
+        return emrtd_exchange_commands(apdu, true, le, dataout, maxdataoutlen, dataoutlen, false, true);
+    }
+
+    uint16_t sw;
+    int res = Iso7816ExchangeExtended(CC_CONTACTLESS, true, apdu, le, dataout, maxdataoutlen, dataoutlen, &sw);
+    if (res != PM3_SUCCESS) {
+        return false;
+    }
+
+    if (sw != ISO7816_OK) {
+        PrintAndLogEx(DEBUG, "Command failed (%04x - %s).", sw, GetAPDUCodeDescription(sw >> 8, sw & 0xff));
+        return false;
+    }
+    return true;
+}
+
 static int _emrtd_read_binary(int offset, int bytes_to_read, uint8_t *dataout, size_t maxdataoutlen, size_t *dataoutlen) {
-    return emrtd_exchange_commands((sAPDU_t) {0, ISO7816_READ_BINARY, offset >> 8, offset & 0xFF, 0, NULL}, true, bytes_to_read, dataout, maxdataoutlen, dataoutlen, false, true);
+    return emrtd_exchange_le((sAPDU_t) {0, ISO7816_READ_BINARY, offset >> 8, offset & 0xFF, 0, NULL}, bytes_to_read, dataout, maxdataoutlen, dataoutlen);
 }
 
 // Walks the secure messaging response DOs. Returns the offset of DO'8E' and,
@@ -444,17 +487,27 @@ static bool emrtd_secure_select_file_by_ef(emrtd_session_t *ssn, uint16_t file)
 
 static bool _emrtd_secure_read_binary(emrtd_session_t *ssn, int offset, int bytes_to_read, uint8_t *dataout, size_t maxdataoutlen, size_t *dataoutlen) {
     const uint8_t header[4] = {0x0C, ISO7816_READ_BINARY, (uint8_t)(offset >> 8), (uint8_t)(offset & 0xFF)};
-    uint8_t do97[3] = {0x97, 0x01, (uint8_t)bytes_to_read};
+    uint8_t do97[4] = {0x97, 0x01, (uint8_t)bytes_to_read};
+    size_t do97len = 3;
+    // the protected Le follows the length of the unprotected one
+    size_t le = 0;
+    if (bytes_to_read > 0x100) {
+        do97[1] = 0x02;
+        do97[2] = (uint8_t)(bytes_to_read >> 8);
+        do97[3] = (uint8_t)(bytes_to_read & 0xFF);
+        do97len = 4;
+        le = emrtd_sm_read_resplen(ssn, bytes_to_read);
+    }
 
     emrtd_sm_bump_ssc(ssn);
 
     uint8_t data[16] = { 0x00 };
     size_t lc = 0;
-    if (emrtd_sm_finish_command(ssn, header, do97, sizeof(do97), data, sizeof(data), &lc) == false) {
+    if (emrtd_sm_finish_command(ssn, header, do97, do97len, data, sizeof(data), &lc) == false) {
         return false;
     }
 
-    if (emrtd_exchange_commands((sAPDU_t) {0x0C, ISO7816_READ_BINARY, offset >> 8, offset & 0xFF, lc, data}, true, 0, dataout, maxdataoutlen, dataoutlen, false, true) == false) {
+    if (emrtd_exchange_le((sAPDU_t) {0x0C, ISO7816_READ_BINARY, offset >> 8, offset & 0xFF, lc, data}, le, dataout, maxdataoutlen, dataoutlen) == false) {
         return false;
     }
 
@@ -462,8 +515,8 @@ static bool _emrtd_secure_read_binary(emrtd_session_t *ssn, int offset, int byte
 }
 
 static bool _emrtd_secure_read_binary_decrypt(emrtd_session_t *ssn, int offset, int bytes_to_read, uint8_t *dataout, size_t *dataoutlen) {
-    uint8_t response[500] = { 0x00 };
-    uint8_t temp[500] = { 0x00 };
+    uint8_t response[EMRTD_EXT_MAX_LE + 64] = { 0x00 };
+    uint8_t temp[EMRTD_EXT_MAX_LE + 64] = { 0x00 };
     size_t resplen = 0;
     size_t off8e = 0;
     const uint8_t *do87 = NULL;
@@ -507,53 +560,105 @@ static bool _emrtd_secure_read_binary_decrypt(emrtd_session_t *ssn, int offset,
     return true;
 }
 
-static int emrtd_read_file(uint8_t *dataout, size_t *dataoutlen, emrtd_session_t *ssn) {
-    uint8_t response[EMRTD_MAX_FILE_SIZE] = { 0x00 };
+// Plain bytes per READ BINARY. By default as many as fit one ISO14443-4 frame
+// once secure messaging is added, or what the chip allows with extended length
+static size_t emrtd_read_size(const emrtd_session_t *ssn) {
+    size_t extresp = EMRTD_EXT_MAX_LE;
+    if (emrtd_atrinfo.max_resp && (emrtd_atrinfo.max_resp < extresp)) {
+        extresp = emrtd_atrinfo.max_resp;
+    }
+
+    if (emrtd_read_chunk_size) {
+        // a short Le tops out at 256 bytes, more needs extended length on the chip
+        size_t limit = emrtd_read_chunk(ssn, emrtd_atrinfo.extended ? extresp : 0x100);
+        if (emrtd_read_chunk_size <= limit) {
+            return emrtd_read_chunk_size;
+        }
+        if (emrtd_read_chunk_warned == false) {
+            PrintAndLogEx(WARNING, "chip %s, chunk clamped to " _YELLOW_("%zu") " bytes"
+                          , emrtd_atrinfo.extended ? "limits the response size" : "has no extended length support"
+                          , limit
+                         );
+            emrtd_read_chunk_warned = true;
+        }
+        return limit;
+    }
+
+    // PCB, CRC and SW around the response data
+    size_t maxresp = EMRTD_FSD - 3 - 2;
+    if (emrtd_atrinfo.extended) {
+        maxresp = extresp;
+    }
+    return emrtd_read_chunk(ssn, maxresp);
+}
+
+// dataout holds EMRTD_MAX_FILE_SIZE bytes. With a sink the plain data is also
+// written out chunk by chunk, *dataoutlen is what was read even on failure
+static int emrtd_read_file_ex(uint8_t *dataout, size_t *dataoutlen, emrtd_session_t *ssn, FILE *sink) {
     size_t resplen = 0;
-    uint8_t tempresponse[500] = { 0x00 };
-    size_t tempresplen = 0;
     int toread = 4;
     int offset = 0;
     bool use_secure = (ssn->type != EMRTD_SM_NONE);
+    uint64_t t0 = msclock();
+
+    *dataoutlen = 0;
+    memset(&emrtd_read_stats, 0, sizeof(emrtd_read_stats));
 
     if (use_secure) {
-        if (_emrtd_secure_read_binary_decrypt(ssn, offset, toread, response, &resplen) == false) {
+        if (_emrtd_secure_read_binary_decrypt(ssn, offset, toread, dataout, &resplen) == false) {
             return false;
         }
     } else {
-        if (_emrtd_read_binary(offset, toread, response, sizeof(response), &resplen) == false) {
+        if (_emrtd_read_binary(offset, toread, dataout, EMRTD_MAX_FILE_SIZE, &resplen) == false) {
             return false;
         }
     }
 
-    int datalen = emrtd_get_asn1_data_length(response, resplen, 1);
-    int readlen = datalen - (3 - emrtd_get_asn1_field_length(response, resplen, 1));
+    int datalen = emrtd_get_asn1_data_length(dataout, resplen, 1);
+    int readlen = datalen - (3 - emrtd_get_asn1_field_length(dataout, resplen, 1));
     offset = 4;
 
+    if ((readlen > 0) && (resplen + readlen > EMRTD_MAX_FILE_SIZE)) {
+        PrintAndLogEx(ERR, "File too large, %zu bytes", resplen + readlen);
+        return false;
+    }
+
+    if (sink) {
+        fwrite(dataout, 1, resplen, sink);
+    }
+    *dataoutlen = resplen;
+
+    size_t chunk = emrtd_read_size(ssn);
+    if (chunk == 0) {
+        return false;
+    }
+    PrintAndLogEx(DEBUG, "reading %i bytes in chunks of %zu", readlen, chunk);
+
     uint8_t lnbreak = 32;
     PrintAndLogEx(INFO, "." NOLF);
     while (readlen > 0) {
-        toread = readlen;
-        if (readlen > 118) {
-            toread = 118;
-        }
+        toread = MIN((size_t)readlen, chunk);
 
+        size_t tempresplen = 0;
         if (use_secure) {
-            if (_emrtd_secure_read_binary_decrypt(ssn, offset, toread, tempresponse, &tempresplen) == false) {
+            if (_emrtd_secure_read_binary_decrypt(ssn, offset, toread, dataout + resplen, &tempresplen) == false) {
                 PrintAndLogEx(NORMAL, "");
                 return false;
             }
         } else {
-            if (_emrtd_read_binary(offset, toread, tempresponse, sizeof(tempresponse), &tempresplen) == false) {
+            if (_emrtd_read_binary(offset, toread, dataout + resplen, EMRTD_MAX_FILE_SIZE - resplen, &tempresplen) == false) {
                 PrintAndLogEx(NORMAL, "");
                 return false;
             }
         }
 
-        memcpy(response + resplen, tempresponse, tempresplen);
+        if (sink) {
+            fwrite(dataout + resplen, 1, tempresplen, sink);
+        }
         offset += toread;
         readlen -= toread;
         resplen += tempresplen;
+        *dataoutlen = resplen;
 
         PrintAndLogEx(NORMAL, "." NOLF);
         fflush(stdout);
@@ -566,11 +671,46 @@ static int emrtd_read_file(uint8_t *dataout, size_t *dataoutlen, emrtd_session_t
     }
     PrintAndLogEx(NORMAL, "");
 
-    memcpy(dataout, &response, resplen);
-    *dataoutlen = resplen;
+    emrtd_read_stats.bytes = resplen;
+    emrtd_read_stats.ms = msclock() - t0;
     return true;
 }
 
+static int emrtd_read_file(uint8_t *dataout, size_t *dataoutlen, emrtd_session_t *ssn) {
+    return emrtd_read_file_ex(dataout, dataoutlen, ssn, NULL);
+}
+
+// EF.ATR/INFO sits on the MF next to EF_CardAccess and is never protected.
+// It is a list of DOs rather than one, so it is read in one go
+static void emrtd_read_atrinfo(void) {
+    memset(&emrtd_atrinfo, 0, sizeof(emrtd_atrinfo));
+
+    if (emrtd_select_file_by_ef(EMRTD_EF_ATRINFO) == false) {
+        PrintAndLogEx(DEBUG, "No EF.ATR/INFO, short READ BINARY only");
+        return;
+    }
+
+    uint8_t response[APDU_RES_LEN] = { 0x00 };
+    size_t resplen = 0;
+    uint16_t sw = 0;
+    int res = Iso7816ExchangeEx(CC_CONTACTLESS, false, true, (sAPDU_t) {0, ISO7816_READ_BINARY, 0, 0, 0, NULL}, true, 0, response, sizeof(response), &resplen, &sw);
+    // 6282, end of file reached before Le bytes
+    if ((res != PM3_SUCCESS) || ((sw != ISO7816_OK) && (sw != 0x6282))) {
+        PrintAndLogEx(DEBUG, "Couldn't read EF.ATR/INFO (%04x)", sw);
+        return;
+    }
+
+    if (emrtd_parse_atrinfo(response, resplen, &emrtd_atrinfo) != PM3_SUCCESS) {
+        PrintAndLogEx(DEBUG, "Couldn't parse EF.ATR/INFO %s", sprint_hex_inrow(response, resplen));
+        memset(&emrtd_atrinfo, 0, sizeof(emrtd_atrinfo));
+        return;
+    }
+
+    if (emrtd_atrinfo.extended) {
+        PrintAndLogEx(INFO, "Extended length supported, max response " _YELLOW_("%zu") " bytes", emrtd_atrinfo.max_resp);
+    }
+}
+
 static int emrtd_lds_determine_tag_length(uint8_t tag) {
     if ((tag == 0x5F) || (tag == 0x7F)) {
         return 2;
@@ -619,7 +759,7 @@ static bool emrtd_lds_get_data_by_tag(uint8_t *datain, size_t datainlen, uint8_t
     return false;
 }
 
-static bool emrtd_select_and_read(uint8_t *dataout, size_t *dataoutlen, uint16_t file, emrtd_session_t *ssn) {
+static bool emrtd_select_and_read_ex(uint8_t *dataout, size_t *dataoutlen, uint16_t file, emrtd_session_t *ssn, FILE *sink) {
     if (ssn->type != EMRTD_SM_NONE) {
         if (emrtd_secure_select_file_by_ef(ssn, file) == false) {
             PrintAndLogEx(ERR, "Failed to secure select %04X", file);
@@ -632,13 +772,17 @@ static bool emrtd_select_and_read(uint8_t *dataout, size_t *dataoutlen, uint16_t
         }
     }
 
-    if (emrtd_read_file(dataout, dataoutlen, ssn) == false) {
+    if (emrtd_read_file_ex(dataout, dataoutlen, ssn, sink) == false) {
         PrintAndLogEx(ERR, "Failed to read %04X", file);
         return false;
     }
     return true;
 }
 
+static bool emrtd_select_and_read(uint8_t *dataout, size_t *dataoutlen, uint16_t file, emrtd_session_t *ssn) {
+    return emrtd_select_and_read_ex(dataout, dataoutlen, file, ssn, NULL);
+}
+
 static const uint8_t jpeg_header[4] = { 0xFF, 0xD8, 0xFF, 0xE0 };
 static const uint8_t jpeg2k_header[6] = { 0x00, 0x00, 0x00, 0x0C, 0x6A, 0x50 };
 static const uint8_t jpeg2k_cs_header[4] = { 0xFF, 0x4F, 0xFF, 0x51 };
@@ -800,15 +944,89 @@ static bool emrtd_save_file(uint8_t *response, size_t resplen, uint16_t file, co
     return true;
 }
 
+// The file is written while it is read, so whatever a lost card left us with
+// is kept on disk
 static bool emrtd_dump_file(emrtd_session_t *ssn, uint16_t file, const char *name, const char *path) {
     uint8_t response[EMRTD_MAX_FILE_SIZE] = { 0x00 };
     size_t resplen = 0;
 
-    if (emrtd_select_and_read(response, &resplen, file, ssn) == false) {
+    char *filepath = calloc(strlen(path) + 100, sizeof(char));
+    if (filepath == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
         return false;
     }
 
-    return emrtd_save_file(response, resplen, file, name, path);
+    strcpy(filepath, path);
+    strncat(filepath, PATHSEP, 2);
+    strcat(filepath, name);
+
+    char *fn = newfilenamemcopy(filepath, ".bin");
+    free(filepath);
+    if (fn == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return false;
+    }
+
+    FILE *f = fopen(fn, "wb");
+    if (f == NULL) {
+        PrintAndLogEx(WARNING, "file not found or locked `" _YELLOW_("%s") "`", fn);
+        free(fn);
+        return false;
+    }
+
+    bool res = emrtd_select_and_read_ex(response, &resplen, file, ssn, f);
+    fclose(f);
+
+    if (res == false) {
+        if (resplen) {
+            PrintAndLogEx(WARNING, "Kept " _YELLOW_("%zu") " bytes of partial %s in `" _YELLOW_("%s") "`", resplen, name, fn);
+        } else {
+            remove(fn);
+        }
+        free(fn);
+        return false;
+    }
+
+    PrintAndLogEx(INFO, "Read " _YELLOW_("%s") ", len %zu", name, resplen);
+    PrintAndLogEx(SUCCESS, "Saved " _YELLOW_("%zu") " bytes to binary file `" _YELLOW_("%s") "`", resplen, fn);
+    free(fn);
+
+    if (emrtd_timings_count < EMRTD_MAX_TIMINGS) {
+        emrtd_timings[emrtd_timings_count] = emrtd_read_stats;
+        emrtd_timings[emrtd_timings_count].name = name;
+        emrtd_timings_count++;
+    }
+
+    emrtd_dg_t *dg = emrtd_fileid_to_dg(file);
+    if ((dg != NULL) && (dg->dumper != NULL)) {
+        dg->dumper(response, resplen, path);
+    }
+    return true;
+}
+
+static void emrtd_print_timings(void) {
+    if (emrtd_timings_count == 0) {
+        return;
+    }
+
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx(INFO, "--- " _CYAN_("Read timing") " ---------------------------------");
+    PrintAndLogEx(INFO, " file           |  bytes | APDUs |      ms |   kB/s");
+    PrintAndLogEx(INFO, "----------------+--------+-------+---------+--------");
+    size_t bytes = 0;
+    uint32_t apdus = 0;
+    uint64_t ms = 0;
+    for (size_t i = 0; i < emrtd_timings_count; i++) {
+        const emrtd_read_stats_t *t = &emrtd_timings[i];
+        PrintAndLogEx(INFO, " %-14s | %6zu | %5u | %7" PRIu64 " | %6.1f",
+                      t->name, t->bytes, t->apdus, t->ms, t->ms ? (double)t->bytes / t->ms : 0.0);
+        bytes += t->bytes;
+        apdus += t->apdus;
+        ms += t->ms;
+    }
+    PrintAndLogEx(INFO, "----------------+--------+-------+---------+--------");
+    PrintAndLogEx(INFO, " %-14s | %6zu | %5u | %7" PRIu64 " | %6.1f",
+                  "total", bytes, apdus, ms, ms ? (double)bytes / ms : 0.0);
 }
 
 static void rng(int length, uint8_t *dataout) {
@@ -931,7 +1149,11 @@ static bool emrtd_do_bac(const char *documentnumber, const char *dob, const char
 
 static bool emrtd_connect(void) {
     int res = Iso7816Connect(CC_CONTACTLESS);
-    return res == PM3_SUCCESS;
+    if (res != PM3_SUCCESS) {
+        return false;
+    }
+    emrtd_read_atrinfo();
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -1610,6 +1832,7 @@ int dumpHF_EMRTD(const emrtd_auth_t *auth, const char *path) {
     emrtd_sm_clear(&ssn);
     memset(&ca, 0, sizeof(ca));
     ca.best = -1;
+    emrtd_timings_count = 0;
 
     // Select the eMRTD
     if (emrtd_connect() == false) {
@@ -1687,6 +1910,7 @@ int dumpHF_EMRTD(const emrtd_auth_t *auth, const char *path) {
         }
     }
     DropField();
+    emrtd_print_timings();
     return PM3_SUCCESS;
 }
 
@@ -2833,7 +3057,8 @@ static int CmdHFeMRTDDump(const char *Cmd) {
                   "hf emrtd dump -n 123456789 -d 890101 -e 250401\n"
                   "hf emrtd dump --can 123456                    -> PACE with the Card Access Number\n"
                   "hf emrtd dump --can 123456 --pace             -> PACE only, no BAC fallback\n"
-                  "hf emrtd dump -n 123456789 -d 890101 -e 250401 --bac -> force BAC"
+                  "hf emrtd dump -n 123456789 -d 890101 -e 250401 --bac -> force BAC\n"
+                  "hf emrtd dump -n 123456789 -d 890101 -e 250401 --chunk 118 -> fixed READ BINARY size"
                  );
 
     void *argtable[] = {
@@ -2846,6 +3071,7 @@ static int CmdHFeMRTDDump(const char *Cmd) {
         arg_lit0(NULL, "pace", "force PACE, fail instead of falling back to BAC"),
         arg_lit0(NULL, "bac", "force BAC, skip PACE"),
         arg_str0(NULL, "dir", "<str>", "save dump to the given dirpath"),
+        arg_u64_0(NULL, "chunk", "<dec>", "bytes per READ BINARY, 0 = from frame size / EF.ATR/INFO (def 0), clamped to what the chip supports"),
         arg_param_end
     };
     CLIExecWithReturn(ctx, Cmd, argtable, true);
@@ -2929,6 +3155,12 @@ static int CmdHFeMRTDDump(const char *Cmd) {
         path[0] = '.';
     }
 
+    uint64_t chunk = arg_get_u64_def(ctx, 9, 0);
+    if (chunk > EMRTD_EXT_MAX_LE) {
+        PrintAndLogEx(ERR, "Chunk must be at most %u bytes", EMRTD_EXT_MAX_LE);
+        error = true;
+    }
+
     CLIParserFree(ctx);
 
     if (emrtd_check_auth_args(BAC, CAN, force_pace, force_bac) == false) {
@@ -2949,7 +3181,10 @@ static int CmdHFeMRTDDump(const char *Cmd) {
     emrtd_fill_auth(&auth, (const char *)docnum, (const char *)dob, (const char *)expiry,
                     (const char *)can, BAC, CAN, force_pace, force_bac);
 
+    emrtd_read_chunk_size = chunk;
+    emrtd_read_chunk_warned = false;
     int res = dumpHF_EMRTD(&auth, (const char *)path);
+    emrtd_read_chunk_size = 0;
 
     PrintAndLogEx(SUCCESS, "time: %" PRIu64 " seconds\n", (msclock() - t1) / 1000);
 
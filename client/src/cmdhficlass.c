@@ -52,6 +52,7 @@
 #include "generator.h"
 #include "cmdhw.h"
 #include "hidsio.h"
+#include "perf.h"
 
 
 #define ICLASS_DEBIT_KEYTYPE   ( 0x88 )
@@ -7141,6 +7142,7 @@ static int CmdHFiClassLookUp(const char *Cmd) {
 
     // Run time
     uint64_t t1 = msclock();
+    uint64_t perf_t0 = perf_start();
 
     uint8_t *keyBlock = NULL;
     uint32_t keycount = 0;
@@ -7204,6 +7206,7 @@ static int CmdHFiClassLookUp(const char *Cmd) {
         add_key(item->key);
     }
 
+    perf_stop(PERF_ICLASS_LOOKUP, perf_t0);
     t1 = msclock() - t1;
     PrintAndLogEx(SUCCESS, "Time in iclass lookup " _YELLOW_("%.3f") " seconds", (float)t1 / 1000.0);
 
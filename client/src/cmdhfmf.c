@@ -46,6 +46,8 @@
 #include "generator.h"              // keygens.
 #include "fpga.h"
 #include "mifare/mifarehost.h"
+#include "mifare/keyorder.h"         // adaptive fchk key order
+#include "mifare/mfsession.h"        // autopwn session
 #include "crypto/originality.h"
 #include "cmdhfmfsen.h"     // Mifare Classic Static Nonce
 #include "cmdmad.h"
@@ -910,7 +912,8 @@ static int mf_analyse_st_block(uint8_t blockno, uint8_t *block, bool force) {
  * @param numSectors: size of the card
  * @param keyFileName: filename containing keys or NULL.
 */
-static int mfc_read_tag(iso14a_card_select_t *card, uint8_t *carddata, uint8_t numSectors, char *keyfn) {
+// select the card and load the per sector keys A then B, as written by `hf mf chk --dump`
+static int mfc_read_tag_init(iso14a_card_select_t *card, uint8_t numSectors, char *keyfn, uint8_t **pkeyA, uint8_t **pkeyB) {
 
     // Select card to get UID/UIDLEN/ATQA/SAK information
     clearCommandBuffer();
@@ -950,9 +953,25 @@ static int mfc_read_tag(iso14a_card_select_t *card, uint8_t *carddata, uint8_t n
 
     if ((alen < (numSectors * MIFARE_KEY_SIZE)) || (blen < (numSectors * MIFARE_KEY_SIZE))) {
         PrintAndLogEx(WARNING, "Key file is too small for selected card type");
+        free(keyA);
+        free(keyB);
         return PM3_ELENGTH;
     }
 
+    *pkeyA = keyA;
+    *pkeyB = keyB;
+    return PM3_SUCCESS;
+}
+
+static int mfc_read_tag(iso14a_card_select_t *card, uint8_t *carddata, uint8_t numSectors, char *keyfn) {
+
+    uint8_t *keyA = NULL, *keyB = NULL;
+    int res = mfc_read_tag_init(card, numSectors, keyfn, &keyA, &keyB);
+    if (res != PM3_SUCCESS) {
+        return res;
+    }
+
+    PacketResponseNG resp;
     PrintAndLogEx(INFO, "Reading sector access bits...");
     PrintAndLogEx(INFO, "." NOLF);
 
@@ -1112,6 +1131,212 @@ static int mfc_read_tag(iso14a_card_select_t *card, uint8_t *carddata, uint8_t n
     return PM3_SUCCESS ;
 }
 
+//-----------------------------------------------------------------------------
+// Batched dump. A sector is read with one authentication, with the request of
+// the next sector already sent while the reply of the previous one is parsed.
+// Sectors the optimistic key A read fails on are planned from their access
+// bits and read in runs of blocks that share a key.
+//-----------------------------------------------------------------------------
+
+#define MFC_FAST_DEPTH  2       // requests in flight
+
+// older firmware ignores CMD_HF_MIFARE_READBLS, only the first dump of the
+// session waits for the reply that never comes
+static bool mfc_readbls_missing = false;
+
+typedef struct {
+    uint32_t requests;
+    uint32_t blocks;
+    uint32_t planned;           // sectors read from their access bits
+} mfc_fast_stats_t;
+
+static void mfc_send_readblocks(uint8_t blockno, uint8_t count, uint8_t keytype, const uint8_t *key, mfc_fast_stats_t *stats) {
+    mf_readblocks_t payload = { .blockno = blockno, .keytype = keytype, .count = count };
+    memcpy(payload.key, key, MIFARE_KEY_SIZE);
+    SendCommandNG(CMD_HF_MIFARE_READBLS, (uint8_t *)&payload, sizeof(mf_readblocks_t));
+    stats->requests++;
+}
+
+// reply to the request for blockno, stale replies of an earlier timeout are skipped
+static int mfc_wait_readblocks(uint8_t blockno, uint8_t count, uint8_t *out) {
+    PacketResponseNG resp;
+    while (WaitForResponseTimeout(CMD_HF_MIFARE_READBLS, &resp, 1500)) {
+        const mf_readblocks_resp_t *r = (const mf_readblocks_resp_t *)resp.data.asBytes;
+        if (resp.status == PM3_ENOTIMPL) {
+            return PM3_ENOTIMPL;
+        }
+        if (resp.length < 2 || r->blockno != blockno) {
+            continue;
+        }
+        if (resp.status != PM3_SUCCESS || r->count != count || resp.length < 2 + (count * MFBLOCK_SIZE)) {
+            return PM3_ESOFT;
+        }
+        memcpy(out, r->data, count * MFBLOCK_SIZE);
+        return PM3_SUCCESS;
+    }
+    return PM3_ETIMEOUT;
+}
+
+static int mfc_readblocks(uint8_t blockno, uint8_t count, uint8_t keytype, const uint8_t *key, uint8_t *out, mfc_fast_stats_t *stats) {
+    mfc_send_readblocks(blockno, count, keytype, key, stats);
+    return mfc_wait_readblocks(blockno, count, out);
+}
+
+// key A is never readable, key B only when the access bits allow it
+static void mfc_fix_trailer(uint8_t *trailer, const uint8_t *keyA, const uint8_t *keyB) {
+    memcpy(trailer, keyA, MIFARE_KEY_SIZE);
+    uint8_t trailer_acl = mf_get_accesscondition(3, &trailer[6]);
+    if (trailer_acl != 0 && trailer_acl != 1 && trailer_acl != 2) {
+        memcpy(trailer + 10, keyB, MIFARE_KEY_SIZE);
+    }
+}
+
+static void mfc_read_sector_planned(uint8_t sectorNo, uint8_t *keyA, const uint8_t *keyB, uint8_t *carddata, mfc_fast_stats_t *stats) {
+    uint8_t first = mfFirstBlockOfSector(sectorNo);
+    uint8_t n = mfNumBlocksPerSector(sectorNo);
+    uint8_t *sector = carddata + (first * MFBLOCK_SIZE);
+    uint8_t *trailer = sector + ((n - 1) * MFBLOCK_SIZE);
+    const uint8_t *keys[2] = { keyA + (sectorNo * MIFARE_KEY_SIZE), keyB + (sectorNo * MIFARE_KEY_SIZE) };
+
+    stats->planned++;
+
+    // which keys authenticate, and the access bits
+    bool key_ok[2] = { false, false };
+    for (uint8_t kt = MF_KEY_A; kt <= MF_KEY_B; kt++) {
+        if (mfc_readblocks(first + n - 1, 1, kt, keys[kt], trailer, stats) == PM3_SUCCESS) {
+            key_ok[kt] = true;
+            break;
+        }
+    }
+    if (key_ok[MF_KEY_A] == false && key_ok[MF_KEY_B] == false) {
+        PrintAndLogEx(FAILED, "\nSector... %2d  no key reads the sector trailer ( " _RED_("fail") " )", sectorNo);
+        return;
+    }
+    if (key_ok[MF_KEY_A] == false) {
+        // clear out keyA since it failed
+        memset(keyA + (sectorNo * MIFARE_KEY_SIZE), 0x00, MIFARE_KEY_SIZE);
+    } else {
+        key_ok[MF_KEY_B] = true;    // not tried yet, given a go where only key B reads
+    }
+
+    uint8_t trailer_acl = mf_get_accesscondition(3, &trailer[6]);
+    bool keyb_readable = (trailer_acl == 0 || trailer_acl == 1 || trailer_acl == 2);
+
+    // key per data block, -1 when none reads it
+    int8_t plan[16];
+    for (uint8_t b = 0; b < n - 1; b++) {
+        uint8_t acl = mf_get_accesscondition((sectorNo < 32) ? b : b / 5, &trailer[6]);
+        plan[b] = -1;
+        if (acl == 0x07) {
+            PrintAndLogEx(WARNING, "Access rights prevent reading sector... " _YELLOW_("%2d") " block... " _YELLOW_("%3d") " ( skip )", sectorNo, b);
+        } else if (acl == 0x03 || acl == 0x05) {
+            plan[b] = (keyb_readable == false && key_ok[MF_KEY_B]) ? MF_KEY_B : -1;
+        } else if (key_ok[MF_KEY_A]) {
+            plan[b] = MF_KEY_A;
+        } else if (keyb_readable == false) {
+            plan[b] = MF_KEY_B;
+        }
+    }
+
+    // runs of blocks with the same key, block by block when a run fails
+    for (uint8_t b = 0; b < n - 1;) {
+        uint8_t len = 1;
+        while (b + len < n - 1 && plan[b + len] == plan[b]) {
+            len++;
+        }
+        if (plan[b] >= 0 && mfc_readblocks(first + b, len, plan[b], keys[plan[b]], sector + (b * MFBLOCK_SIZE), stats) != PM3_SUCCESS) {
+            for (uint8_t i = b; i < b + len; i++) {
+                if (mfc_readblocks(first + i, 1, plan[i], keys[plan[i]], sector + (i * MFBLOCK_SIZE), stats) != PM3_SUCCESS) {
+                    PrintAndLogEx(FAILED, "\nSector... %2d Block... %2d ( " _RED_("fail") " )", sectorNo, i);
+                } else {
+                    stats->blocks++;
+                }
+            }
+        } else if (plan[b] >= 0) {
+            stats->blocks += len;
+        }
+        b += len;
+    }
+
+    mfc_fix_trailer(trailer, keys[MF_KEY_A], keys[MF_KEY_B]);
+    stats->blocks++;
+}
+
+static int mfc_read_tag_fast(iso14a_card_select_t *card, uint8_t *carddata, uint8_t numSectors, char *keyfn) {
+
+    uint8_t *keyA = NULL, *keyB = NULL;
+    int res = mfc_read_tag_init(card, numSectors, keyfn, &keyA, &keyB);
+    if (res != PM3_SUCCESS) {
+        return res;
+    }
+
+    PrintAndLogEx(INFO, "Dumping all blocks from card, one request per sector...");
+
+    mfc_fast_stats_t stats = {0};
+    bool planned[MIFARE_4K_MAXSECTOR] = {false};
+    bool replied = false;
+    uint8_t next = 0;
+    uint64_t t1 = usclock();
+
+    clearCommandBuffer();
+    for (uint8_t sectorNo = 0; sectorNo < numSectors; sectorNo++) {
+
+        if (kbd_enter_pressed()) {
+            PrintAndLogEx(WARNING, "\naborted via keyboard!\n");
+            free(keyA);
+            free(keyB);
+            return PM3_EOPABORTED;
+        }
+
+        // keep the device busy while this sector is parsed
+        while (next < numSectors && next < sectorNo + MFC_FAST_DEPTH) {
+            mfc_send_readblocks(mfFirstBlockOfSector(next), mfNumBlocksPerSector(next), MF_KEY_A, keyA + (next * MIFARE_KEY_SIZE), &stats);
+            next++;
+        }
+
+        uint8_t first = mfFirstBlockOfSector(sectorNo);
+        uint8_t n = mfNumBlocksPerSector(sectorNo);
+        uint8_t *sector = carddata + (first * MFBLOCK_SIZE);
+
+        res = mfc_wait_readblocks(first, n, sector);
+        if ((res == PM3_ETIMEOUT && replied == false) || res == PM3_ENOTIMPL) {
+            // firmware without batched reads
+            mfc_readbls_missing = true;
+            free(keyA);
+            free(keyB);
+            return PM3_ENOTIMPL;
+        }
+        replied = true;
+
+        if (res != PM3_SUCCESS) {
+            planned[sectorNo] = true;
+            continue;
+        }
+
+        mfc_fix_trailer(sector + ((n - 1) * MFBLOCK_SIZE), keyA + (sectorNo * MIFARE_KEY_SIZE), keyB + (sectorNo * MIFARE_KEY_SIZE));
+        stats.blocks += n;
+        PrintAndLogEx(INPLACE, "Sector... " _YELLOW_("%2d") " ( " _GREEN_("ok") " )", sectorNo);
+    }
+
+    for (uint8_t sectorNo = 0; sectorNo < numSectors; sectorNo++) {
+        if (planned[sectorNo]) {
+            clearCommandBuffer();
+            mfc_read_sector_planned(sectorNo, keyA, keyB, carddata, &stats);
+        }
+    }
+
+    uint64_t dt = usclock() - t1;
+
+    free(keyA);
+    free(keyB);
+
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx(SUCCESS, "Read " _YELLOW_("%u") " blocks in " _YELLOW_("%u") " requests, " _YELLOW_("%u") " sector(s) planned from access bits",
+                  stats.blocks, stats.requests, stats.planned);
+    PrintAndLogEx(SUCCESS, "%.0f ms, " _YELLOW_("%.0f") " blocks/s", dt / 1000.0, dt ? stats.blocks * 1000000.0 / dt : 0.0);
+    return PM3_SUCCESS;
+}
+
 static int mf_load_keys(uint8_t **pkeyBlock, uint32_t *pkeycnt, uint8_t *userkey, int userkeylen, const char *filename, int fnlen, bool load_default) {
     // Handle Keys
     *pkeycnt = 0;
@@ -1631,7 +1856,8 @@ static int CmdHF14AMfDump(const char *Cmd) {
                   "hf mf dump --1k                          --> MIFARE Classic 1k\n"
                   "hf mf dump --2k                          --> MIFARE 2k\n"
                   "hf mf dump --4k                          --> MIFARE 4k\n"
-                  "hf mf dump --keys hf-mf-066C8B78-key.bin --> MIFARE 1k with keys from specified file\n");
+                  "hf mf dump --keys hf-mf-066C8B78-key.bin --> MIFARE 1k with keys from specified file\n"
+                  "hf mf dump --4k --fast                   --> MIFARE 4k, one batched read per sector\n");
 
     void *argtable[] = {
         arg_param_begin,
@@ -1643,6 +1869,7 @@ static int CmdHF14AMfDump(const char *Cmd) {
         arg_lit0(NULL, "4k", "MIFARE Classic 4k / S70"),
         arg_lit0(NULL, "ns", "no save to file"),
         arg_lit0("v", "verbose", "verbose output"),
+        arg_lit0(NULL, "fast", "read a sector per request, pipelined (needs recent firmware)"),
         arg_param_end
     };
     CLIExecWithReturn(ctx, Cmd, argtable, true);
@@ -1661,6 +1888,7 @@ static int CmdHF14AMfDump(const char *Cmd) {
     bool m4 = arg_get_lit(ctx, 6);
     bool nosave = arg_get_lit(ctx, 7);
     bool verbose = arg_get_lit(ctx, 8);
+    bool fast = arg_get_lit(ctx, 9);
     CLIParserFree(ctx);
 
     uint64_t t1 = msclock();
@@ -1705,7 +1933,18 @@ static int CmdHF14AMfDump(const char *Cmd) {
         PrintAndLogEx(WARNING, "Failed to allocate memory");
         return PM3_EMALLOC;
     }
-    int res = mfc_read_tag(&card, mem, numSectors, keyFilename);
+    int res = PM3_ENOTIMPL;
+    if (fast) {
+        if (mfc_readbls_missing == false) {
+            res = mfc_read_tag_fast(&card, mem, numSectors, keyFilename);
+        }
+        if (res == PM3_ENOTIMPL) {
+            PrintAndLogEx(WARNING, "Device firmware has no batched reads, falling back to block reads");
+        }
+    }
+    if (res == PM3_ENOTIMPL) {
+        res = mfc_read_tag(&card, mem, numSectors, keyFilename);
+    }
     if (res != PM3_SUCCESS) {
         free(mem);
         return res;
@@ -2666,6 +2905,7 @@ static int CmdHF14AMfNestedHard(const char *Cmd) {
                   "hf mf hardnested --blk 0 -a -k FFFFFFFFFFFF --tblk 4 --ta\n"
                   "hf mf hardnested --blk 0 -a -k FFFFFFFFFFFF --tblk 4 --ta -w\n"
                   "hf mf hardnested --blk 0 -a -k FFFFFFFFFFFF --tblk 4 --ta -f nonces.bin -w -s\n"
+                  "hf mf hardnested --blk 0 -a -k FFFFFFFFFFFF --tblk 4 --ta --resume --> add nonces to the file of an interrupted -w run\n"
                   "hf mf hardnested -r\n"
                   "hf mf hardnested -r --tk a0a1a2a3a4a5\n"
                   "hf mf hardnested -t --tk a0a1a2a3a4a5\n"
@@ -2688,6 +2928,7 @@ static int CmdHF14AMfNestedHard(const char *Cmd) {
         arg_lit0("s",  "slow",           "Slower acquisition (required by some non standard cards)"),
         arg_lit0("t",  "tests",          "Run tests"),
         arg_lit0("w",  "wr",             "Acquire nonces and UID, and write them to file `hf-mf-<UID>-nonces.bin`"),
+        arg_lit0(NULL, "resume",         "Like -w, but keep the nonces already in the file and add new ones"),
 
         arg_lit0(NULL, "in", "None (use CPU regular instruction set)"),
 #if defined(COMPILER_HAS_SIMD_X86)
@@ -2748,19 +2989,20 @@ static int CmdHF14AMfNestedHard(const char *Cmd) {
     bool slow = arg_get_lit(ctx, 12);
     bool tests = arg_get_lit(ctx, 13);
     bool nonce_file_write = arg_get_lit(ctx, 14);
+    bool nonce_file_resume = arg_get_lit(ctx, 15);
 
-    bool in = arg_get_lit(ctx, 15);
+    bool in = arg_get_lit(ctx, 16);
 #if defined(COMPILER_HAS_SIMD_X86)
-    bool im = arg_get_lit(ctx, 16);
-    bool is = arg_get_lit(ctx, 17);
-    bool ia = arg_get_lit(ctx, 18);
-    bool i2 = arg_get_lit(ctx, 19);
+    bool im = arg_get_lit(ctx, 17);
+    bool is = arg_get_lit(ctx, 18);
+    bool ia = arg_get_lit(ctx, 19);
+    bool i2 = arg_get_lit(ctx, 20);
 #endif
 #if defined(COMPILER_HAS_SIMD_AVX512)
-    bool i5 = arg_get_lit(ctx, 20);
+    bool i5 = arg_get_lit(ctx, 21);
 #endif
 #if defined(COMPILER_HAS_SIMD_NEON)
-    bool ie = arg_get_lit(ctx, 16);
+    bool ie = arg_get_lit(ctx, 17);
 #endif
     CLIParserFree(ctx);
 
@@ -2800,6 +3042,10 @@ static int CmdHF14AMfNestedHard(const char *Cmd) {
 
     bool known_target_key = (trg_keylen);
 
+    if (nonce_file_resume) {
+        nonce_file_write = true;
+    }
+
     if (nonce_file_read) {
         char *fptr = GenerateFilename("hf-mf-", "-nonces.bin");
         if (fptr == NULL)
@@ -2859,12 +3105,12 @@ static int CmdHF14AMfNestedHard(const char *Cmd) {
                   known_target_key ? "" : " (not set)"
                  );
     PrintAndLogEx(INFO, "File action: " _YELLOW_("%s") " Slow: " _YELLOW_("%s") " Tests: " _YELLOW_("%d"),
-                  nonce_file_write ? "write" : nonce_file_read ? "read" : "none",
+                  nonce_file_resume ? "resume" : nonce_file_write ? "write" : nonce_file_read ? "read" : "none",
                   slow ? "Yes" : "No",
                   tests);
 
     uint64_t foundkey = 0;
-    int16_t isOK = mfnestedhard(blockno, keytype, key, trg_blockno, trg_keytype, known_target_key ? trg_key : NULL, nonce_file_read, nonce_file_write, slow, tests, &foundkey, filename);
+    int16_t isOK = mfnestedhard(blockno, keytype, key, trg_blockno, trg_keytype, known_target_key ? trg_key : NULL, nonce_file_read, nonce_file_write, nonce_file_resume, slow, tests, &foundkey, filename);
     switch (isOK) {
         case PM3_ETIMEOUT :
             PrintAndLogEx(ERR, "Error: No response from Proxmark3\n");
@@ -2898,13 +3144,17 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
                   "It uses the fchk, chk, darkside, nested, hardnested and staticnested to recover keys.\n"
                   "If all keys are found, it try dumping card content both to file and emulator memory.\n"
                   "\n"
+                  "Progress is saved to `hf-mf-<uid>-session.json`, a new run on the same card resumes from it\n"
+                  "and skips what is done: the dictionary pass, the keys found and the nonces collected.\n"
+                  "\n"
                   "default file name template is `hf-mf-<uid>-<dump|key>.`\n"
                   "using suffix the template becomes `hf-mf-<uid>-<dump|key>-<suffix>.` \n",
                   "hf mf autopwn\n"
                   "hf mf autopwn -s 0 -a -k FFFFFFFFFFFF     --> target MFC 1K card, Sector 0 with known key A 'FFFFFFFFFFFF'\n"
                   "hf mf autopwn --1k -f mfc_default_keys    --> target MFC 1K card, default dictionary\n"
                   "hf mf autopwn --1k -s 0 -a -k FFFFFFFFFFFF -f mfc_default_keys  --> combo of the two above samples\n"
-                  "hf mf autopwn --1k -s 0 -a -k FFFFFFFFFFFF -k a0a1a2a3a4a5      --> multiple user supplied keys"
+                  "hf mf autopwn --1k -s 0 -a -k FFFFFFFFFFFF -k a0a1a2a3a4a5      --> multiple user supplied keys\n"
+                  "hf mf autopwn --fresh                     --> ignore the saved session and start over"
                  );
 
     void *argtable[] = {
@@ -2921,6 +3171,7 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
         arg_lit0(NULL, "mem", "Use dictionary from flashmemory"),
 
         arg_lit0(NULL, "ns", "No save to file"),
+        arg_lit0(NULL, "fresh", "Discard the saved session of the card"),
 
         arg_lit0(NULL, "mini", "MIFARE Classic Mini / S20"),
         arg_lit0(NULL, "1k", "MIFARE Classic 1k / S50 (default)"),
@@ -2973,24 +3224,25 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
     bool use_flashmemory = arg_get_lit(ctx, 10);
 
     bool no_save = arg_get_lit(ctx, 11);
+    bool fresh = arg_get_lit(ctx, 12);
 
-    bool m0 = arg_get_lit(ctx, 12);
-    bool m1 = arg_get_lit(ctx, 13);
-    bool m2 = arg_get_lit(ctx, 14);
-    bool m4 = arg_get_lit(ctx, 15);
+    bool m0 = arg_get_lit(ctx, 13);
+    bool m1 = arg_get_lit(ctx, 14);
+    bool m2 = arg_get_lit(ctx, 15);
+    bool m4 = arg_get_lit(ctx, 16);
 
-    bool in = arg_get_lit(ctx, 16);
+    bool in = arg_get_lit(ctx, 17);
 #if defined(COMPILER_HAS_SIMD_X86)
-    bool im = arg_get_lit(ctx, 17);
-    bool is = arg_get_lit(ctx, 18);
-    bool ia = arg_get_lit(ctx, 19);
-    bool i2 = arg_get_lit(ctx, 20);
+    bool im = arg_get_lit(ctx, 18);
+    bool is = arg_get_lit(ctx, 19);
+    bool ia = arg_get_lit(ctx, 20);
+    bool i2 = arg_get_lit(ctx, 21);
 #endif
 #if defined(COMPILER_HAS_SIMD_AVX512)
-    bool i5 = arg_get_lit(ctx, 21);
+    bool i5 = arg_get_lit(ctx, 22);
 #endif
 #if defined(COMPILER_HAS_SIMD_NEON)
-    bool ie = arg_get_lit(ctx, 17);
+    bool ie = arg_get_lit(ctx, 18);
 #endif
 
     CLIParserFree(ctx);
@@ -3233,6 +3485,22 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
         return PM3_EMALLOC;
     }
 
+    // pick up where an earlier run on this card stopped
+    mfsession_t session;
+    mfsession_init(&session, card.uid, card.uidlen, sector_cnt, (no_save == false));
+    if (fresh) {
+        mfsession_remove(&session);
+    } else if (mfsession_load(&session) == PM3_SUCCESS) {
+        PrintAndLogEx(INFO, "Resuming session " _YELLOW_("%s") ", " _YELLOW_("%u") " of " _YELLOW_("%u") " keys known%s",
+                      session.path,
+                      mfsession_found(&session),
+                      sector_cnt * 2,
+                      session.dictionary_done ? ", dictionary done" : ""
+                     );
+        PrintAndLogEx(HINT, "Hint: use `" _YELLOW_("--fresh") "` to start over");
+    }
+    session.runs++;
+
     if (is_ev1) {
         PrintAndLogEx(INFO, "MIFARE Classic EV1 card detected");
 
@@ -3313,6 +3581,7 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
 
         PrintAndLogEx(INFO, "Dictionary .... " _YELLOW_("%s"), strlen(filename) ? filename : "n/a");
         PrintAndLogEx(INFO, "Legacy mode ... %s", (legacy_mfchk) ? _YELLOW_("yes") : "no");
+        PrintAndLogEx(INFO, "Session ....... %s", (session.enabled == false) ? "n/a" : (session.resumed) ? _YELLOW_("resumed") : "new");
 
         PrintAndLogEx(INFO, "----------------------------------------------------------------");
     }
@@ -3327,16 +3596,42 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
 
     // If we use the dictionary in flash memory, we don't want to load keys
     // from hard drive dictionary as it could exceed BigBuf capacity
+    const char *dictionary = (use_flashmemory) ? "flash memory" : (fnlen) ? filename : "none";
+    bool dictionary_done = (session.dictionary_done && strcmp(session.dictionary, dictionary) == 0);
+    bool dictionary_aborted = false;
+    if (dictionary_done) {
+        use_flashmemory = false;
+    }
+
     if (use_flashmemory) {
         fnlen = 0;
     }
 
-    int ret = mf_load_keys(&keyBlock, &key_cnt, in_keys, in_keys_len, filename, fnlen, true);
+    int ret = mf_load_keys(&keyBlock, &key_cnt, in_keys, in_keys_len, filename, (dictionary_done) ? 0 : fnlen, true);
     if (ret != PM3_SUCCESS) {
         free(e_sector);
         return ret;
     }
 
+    // keys of the session first, they are checked again in case the card changed
+    uint8_t *session_keys = NULL;
+    uint32_t session_key_cnt = mfsession_keys(&session, &session_keys);
+    if (session_key_cnt) {
+        uint8_t *tmp = realloc(session_keys, (session_key_cnt + key_cnt) * MIFARE_KEY_SIZE);
+        if (tmp) {
+            memcpy(tmp + (session_key_cnt * MIFARE_KEY_SIZE), keyBlock, key_cnt * MIFARE_KEY_SIZE);
+            free(keyBlock);
+            keyBlock = tmp;
+            key_cnt += session_key_cnt;
+            session_keys = NULL;
+        }
+    }
+    free(session_keys);
+
+    if (dictionary_done) {
+        PrintAndLogEx(INFO, "Dictionary " _YELLOW_("%s") " was run before, checking " _YELLOW_("%u") " session and default keys", dictionary, key_cnt);
+    }
+
     res = PM3_SUCCESS;
 
     // Use the dictionary to find sector keys on the card
@@ -3382,6 +3677,7 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
 
                     if (kbd_enter_pressed()) {
                         PrintAndLogEx(WARNING, "\naborted via keyboard!\n");
+                        dictionary_aborted = true;
                         i = key_cnt;
                         strategy = 3;
                         break; // Exit the loop
@@ -3416,13 +3712,18 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
     for (int i = 0; i < sector_cnt; i++) {
         for (int j = MF_KEY_A; j <= MF_KEY_B; j++) {
 
-            if (e_sector[i].foundKey[j] != 1) {
+            if (e_sector[i].foundKey[j] == 0) {
                 continue;
             }
 
             ++num_found_keys;
 
-            e_sector[i].foundKey[j] = 'D';
+            // keys of the session keep the attack that found them
+            if (session.keys[i].foundKey[j] && session.keys[i].Key[j] == e_sector[i].Key[j]) {
+                e_sector[i].foundKey[j] = session.keys[i].foundKey[j];
+            } else {
+                e_sector[i].foundKey[j] = 'D';
+            }
             num_to_bytes(e_sector[i].Key[j], MIFARE_KEY_SIZE, tmp_key);
 
             // Store valid credentials for the nested / hardnested attack if none exist
@@ -3436,6 +3737,13 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
         }
     }
 
+    if (dictionary_done == false && dictionary_aborted == false) {
+        session.dictionary_done = true;
+        snprintf(session.dictionary, sizeof(session.dictionary), "%s", dictionary);
+        session.dictionary_keys = key_cnt;
+    }
+    mfsession_save(&session, e_sector);
+
     if (num_found_keys == sector_cnt * 2) {
         goto all_found;
     }
@@ -3453,7 +3761,7 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
 
     for (int i = 0; i < sector_cnt; i++) {
         for (int j = MF_KEY_A; j <= MF_KEY_B; j++) {
-            if (e_sector[i].foundKey[j] != 'D') {
+            if (e_sector[i].foundKey[j] == 0) {
                 continue;
             }
 
@@ -3478,6 +3786,9 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
 
             PrintAndLogEx(NORMAL, "");
 
+            session.darkside++;
+            mfsession_save(&session, e_sector);
+
             isOK = mf_dark_side(mfFirstBlockOfSector(sectorno), MIFARE_AUTH_KEYA + keytype, &key64);
 
             if (isOK != PM3_SUCCESS) {
@@ -3490,6 +3801,7 @@ static int CmdHF14AMfAutoPWN(const char *Cmd) {
             num_to_bytes(key64, MIFARE_KEY_SIZE, key);
             e_sector[sectorno].Key[keytype] = key64;
             e_sector[sectorno].foundKey[keytype] = 'S';
+            mfsession_save(&session, e_sector);
             PrintAndLogEx(SUCCESS, "Target sector " _GREEN_("%3u") " key type "_GREEN_("%c") " -- found valid key [ " _GREEN_("%012" PRIX64) " ] (used for nested / hardnested attack)",
                           sectorno,
                           (keytype == MF_KEY_B) ? 'B' : 'A',
@@ -3530,7 +3842,7 @@ noValidKeyFound:
     free(keyBlock);
     // Clear the needed variables
     num_to_bytes(0, MIFARE_KEY_SIZE, tmp_key);
-    bool nested_failed = false;
+    bool nested_failed = session.nested_failed;
 
     // Iterate over each sector and key(A/B)
     for (current_sector_i = 0; current_sector_i < sector_cnt; current_sector_i++) {
@@ -3559,6 +3871,7 @@ noValidKeyFound:
                             if (mf_check_keys(mfFirstBlockOfSector(i), j, true, 1, tmp_key, &key64) == PM3_SUCCESS) {
                                 e_sector[i].Key[j] = bytes_to_num(tmp_key, MIFARE_KEY_SIZE);
                                 e_sector[i].foundKey[j] = 'R';
+                                mfsession_save(&session, e_sector);
                                 PrintAndLogEx(SUCCESS, "Target sector " _GREEN_("%3u") " key type " _GREEN_("%c") " -- found valid key [ " _GREEN_("%s") " ]",
                                               i,
                                               (j == MF_KEY_B) ? 'B' : 'A',
@@ -3604,6 +3917,7 @@ noValidKeyFound:
                         if (key64) {
                             e_sector[current_sector_i].foundKey[current_key_type_i] = 'A';
                             e_sector[current_sector_i].Key[current_key_type_i] = key64;
+                            mfsession_save(&session, e_sector);
                             num_to_bytes(key64, MIFARE_KEY_SIZE, tmp_key);
                             PrintAndLogEx(SUCCESS, "Target sector " _GREEN_("%3u") " key type " _GREEN_("%c") " -- found valid key [ " _GREEN_("%s") " ]",
                                           current_sector_i,
@@ -3643,7 +3957,9 @@ skipReadBKey:
                                           (current_key_type_i == MF_KEY_B) ? 'B' : 'A');
                         }
 tryNested:
+                        session.slots[current_sector_i][current_key_type_i].nested++;
                         isOK = mf_nested(mfFirstBlockOfSector(sectorno), keytype, key, mfFirstBlockOfSector(current_sector_i), current_key_type_i, tmp_key, calibrate);
+                        mfsession_save(&session, e_sector);
 
                         switch (isOK) {
                             case PM3_ETIMEOUT: {
@@ -3661,6 +3977,7 @@ tryNested:
                             case PM3_EFAILED: {
                                 PrintAndLogEx(FAILED, "Tag isn't vulnerable to Nested Attack (PRNG is probably not predictable).");
                                 PrintAndLogEx(FAILED, "Nested attack failed --> try hardnested");
+                                session.nested_failed = true;
                                 goto tryHardnested;
                             }
                             case PM3_ESOFT: {
@@ -3673,6 +3990,7 @@ tryNested:
                                 } else {
                                     PrintAndLogEx(FAILED, "Nested attack failed, moving to hardnested");
                                     nested_failed = true;
+                                    session.nested_failed = true;
                                     goto tryHardnested;
                                 }
                                 break;
@@ -3722,9 +4040,26 @@ tryHardnested: // If the nested attack fails then we try the hardnested attack
                                           slow ? "Yes" : "No");
                         }
 
+                        // nonces go to a file of the session, a later run adds to them
+                        char nonce_file[FILE_PATH_SIZE] = {0};
+                        mfsession_nonce_file(&session, current_sector_i, current_key_type_i, nonce_file, sizeof(nonce_file));
+                        mfsession_slot_t *slot = &session.slots[current_sector_i][current_key_type_i];
+                        if (slot->nonces) {
+                            PrintAndLogEx(INFO, "Resuming with the nonces in " _YELLOW_("%s"), nonce_file);
+                        }
+                        slot->hardnested++;
+                        slot->nonces = session.enabled;
+                        mfsession_save(&session, e_sector);
+
                         foundkey = 0;
-                        isOK = mfnestedhard(mfFirstBlockOfSector(sectorno), keytype, key, mfFirstBlockOfSector(current_sector_i), current_key_type_i, NULL, false, false, slow, 0, &foundkey, NULL);
+                        isOK = mfnestedhard(mfFirstBlockOfSector(sectorno), keytype, key, mfFirstBlockOfSector(current_sector_i), current_key_type_i, NULL,
+                                            false, session.enabled, session.enabled, slow, 0, &foundkey, (session.enabled) ? nonce_file : NULL);
                         DropField();
+                        if (isOK == PM3_SUCCESS && slot->nonces) {
+                            remove(nonce_file);
+                            slot->nonces = false;
+                        }
+                        mfsession_save(&session, e_sector);
                         if (isOK != PM3_SUCCESS) {
                             switch (isOK) {
                                 case PM3_ETIMEOUT: {
@@ -3774,8 +4109,10 @@ tryStaticnested:
 
                         force_detect_dist = 0; // First time to decrypt staticnested tag, we can auto detect dist by tag type.
                         for (static_nested_retry_i = 0; static_nested_retry_i < 2; static_nested_retry_i++) {
+                            session.slots[current_sector_i][current_key_type_i].staticnested++;
                             isOK = mf_static_nested(mfFirstBlockOfSector(sectorno), keytype, key, mfFirstBlockOfSector(current_sector_i), current_key_type_i, tmp_key, force_detect_dist);
                             DropField();
+                            mfsession_save(&session, e_sector);
                             switch (isOK) {
                                 case PM3_ETIMEOUT: {
                                     PrintAndLogEx(ERR, "\nError: No response from Proxmark3");
@@ -3815,6 +4152,7 @@ tryStaticnested:
                                       sprint_hex_inrow(tmp_key, sizeof(tmp_key))
                                      );
                     }
+                    mfsession_save(&session, e_sector);
                 }
             }
         }
@@ -3832,6 +4170,7 @@ all_found:
         if (createMfcKeyDump(fptr, sector_cnt, e_sector) != PM3_SUCCESS) {
             PrintAndLogEx(ERR, "Failed to save keys to file");
         }
+        mfsession_save(&session, e_sector);
     }
 
     // clear emulator mem
@@ -3929,7 +4268,8 @@ static int CmdHF14AMfChk_fast(const char *Cmd) {
                   "hf mf fchk --1k -f mfc_default_keys.dic        --> Target 1K using default dictionary file\n"
                   "hf mf fchk --1k --emu                          --> Target 1K, write keys to emulator memory\n"
                   "hf mf fchk --1k --dump                         --> Target 1K, write keys to file\n"
-                  "hf mf fchk --1k --mem                          --> Target 1K, use dictionary from flash memory");
+                  "hf mf fchk --1k --mem                          --> Target 1K, use dictionary from flash memory\n"
+                  "hf mf fchk --1k -f mfc_default_keys --no-adapt --> Target 1K, send keys in dictionary order");
 
     void *argtable[] = {
         arg_param_begin,
@@ -3946,6 +4286,7 @@ static int CmdHF14AMfChk_fast(const char *Cmd) {
         arg_lit0("a", NULL, "single block recovery key A"),
         arg_lit0("b", NULL, "single block recovery key B"),
         arg_lit0(NULL, "no-default", "Skip check default keys"),
+        arg_lit0(NULL, "no-adapt", "Send keys in dictionary order, don't use or update the key statistics"),
         arg_param_end
     };
     CLIExecWithReturn(ctx, Cmd, argtable, true);
@@ -3977,6 +4318,7 @@ static int CmdHF14AMfChk_fast(const char *Cmd) {
         keytype = MF_KEY_B;
     }
     bool load_default = ! arg_get_lit(ctx, 13);
+    bool adapt = ! arg_get_lit(ctx, 14);
 
     CLIParserFree(ctx);
 
@@ -4003,6 +4345,10 @@ static int CmdHF14AMfChk_fast(const char *Cmd) {
         return PM3_EINVARG;
     }
 
+    if (use_flashmemory) {
+        adapt = false;
+    }
+
     uint8_t *keyBlock = NULL;
     uint32_t keycnt = 0;
     // If we use the dictionary in flash memory, we don't want to load keys
@@ -4022,9 +4368,32 @@ static int CmdHF14AMfChk_fast(const char *Cmd) {
         return PM3_EMALLOC;
     }
 
-    uint32_t chunksize = (keycnt > (PM3_CMD_DATA_SIZE / MIFARE_KEY_SIZE)) ? (PM3_CMD_DATA_SIZE / MIFARE_KEY_SIZE) : keycnt;
+    // keys found before go first, the rest of their dictionary block next
+    keystats_t stats = {0};
+    keyorder_t *ko = NULL;
+    if (adapt) {
+        keystats_load(&stats);
+        ko = keyorder_new(keyBlock, keycnt, keylen / MIFARE_KEY_SIZE, &stats, (fnlen > 0) ? filename : "mfc_default_keys");
+        if (ko) {
+            PrintAndLogEx(INFO, "Adaptive key order, " _YELLOW_("%u") " distinct keys, " _YELLOW_("%u") " ranked from " _YELLOW_("%u") " cards, " _YELLOW_("%u") " in key families",
+                          keyorder_count(ko), keyorder_ranked(ko), stats.cards, keyorder_families(ko));
+        }
+    }
+    uint32_t total = (ko) ? keyorder_count(ko) : keycnt;
+
+    uint32_t chunksize = (total > (PM3_CMD_DATA_SIZE / MIFARE_KEY_SIZE)) ? (PM3_CMD_DATA_SIZE / MIFARE_KEY_SIZE) : total;
     bool firstChunk = true, lastChunk = false;
 
+    uint8_t *chunk = calloc(chunksize + 1, MIFARE_KEY_SIZE);
+    if (chunk == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        keyorder_free(ko);
+        keystats_free(&stats);
+        free(keyBlock);
+        free(e_sector);
+        return PM3_EMALLOC;
+    }
+
     int i = 0;
 
     // time
@@ -4043,8 +4412,12 @@ static int CmdHF14AMfChk_fast(const char *Cmd) {
         for (uint8_t strategy = 1; strategy < 3; strategy++) {
             PrintAndLogEx(INFO, "Running strategy " _YELLOW_("%u"), strategy);
 
+            if (ko) {
+                keyorder_begin(ko, strategy, e_sector, sectorsCnt);
+            }
+
             // main keychunk loop
-            for (i = 0; i < keycnt; i += chunksize) {
+            for (i = 0; i < total; i += chunksize) {
 
                 if (kbd_enter_pressed()) {
                     clearCommandBuffer();
@@ -4055,13 +4428,18 @@ static int CmdHF14AMfChk_fast(const char *Cmd) {
                     goto out;
                 }
 
-                uint32_t size = ((keycnt - i)  > chunksize) ? chunksize : keycnt - i;
+                uint32_t size = ((total - i)  > chunksize) ? chunksize : total - i;
+                if (ko) {
+                    keyorder_next(ko, chunk, size);
+                } else {
+                    memcpy(chunk, keyBlock + (i * MIFARE_KEY_SIZE), size * MIFARE_KEY_SIZE);
+                }
 
                 // last chunk?
-                if (size == keycnt - i) {
+                if (size == total - i) {
                     lastChunk = true;
                 }
-                int res = mf_check_keys_fast_ex(sectorsCnt, firstChunk, lastChunk, strategy, size, keyBlock + (i * MIFARE_KEY_SIZE), e_sector, false, false, false, singleSectorParams);
+                int res = mf_check_keys_fast_ex(sectorsCnt, firstChunk, lastChunk, strategy, size, chunk, e_sector, false, false, false, singleSectorParams);
                 if (firstChunk)
                     firstChunk = false;
 
@@ -4070,10 +4448,17 @@ static int CmdHF14AMfChk_fast(const char *Cmd) {
                     PrintAndLogEx(NORMAL, "");
                     goto out;
                 }
-                PrintAndLogEx(INPLACE, "Testing %5i/%5i ( " _YELLOW_("%02.1f %%") " )", i, keycnt, (float)i * 100 / keycnt);
+
+                if (ko && lastChunk == false) {
+                    uint32_t moved = keyorder_update(ko, e_sector, sectorsCnt);
+                    if (moved) {
+                        PrintAndLogEx(DEBUG, "moved up " _YELLOW_("%u") " keys", moved);
+                    }
+                }
+                PrintAndLogEx(INPLACE, "Testing %5i/%5i ( " _YELLOW_("%02.1f %%") " )", i, total, (float)i * 100 / total);
             } // end chunks of keys
 
-            PrintAndLogEx(INPLACE, "Testing %5i/%5i ( " _YELLOW_("100 %%") " )  ", keycnt, keycnt);
+            PrintAndLogEx(INPLACE, "Testing %5i/%5i ( " _YELLOW_("100 %%") " )  ", total, total);
             PrintAndLogEx(NORMAL, "");
 
             // reset chunks when swapping strategies
@@ -4110,6 +4495,21 @@ out:
 
         printKeyTable(sectorsCnt, e_sector);
 
+        if (ko && g_session.incognito == false) {
+            // a card checked again only counts once
+            uint8_t uid[10] = {0};
+            int uidlen = 0;
+            if (mf_read_uid(uid, &uidlen, NULL) != PM3_SUCCESS) {
+                uidlen = 0;
+            }
+            int res = keystats_add_card(&stats, uid, uidlen, e_sector, sectorsCnt);
+            if (res == PM3_SUCCESS) {
+                keystats_save(&stats);
+            } else if (res == PM3_EOPABORTED) {
+                PrintAndLogEx(INFO, "Card " _YELLOW_("%s") " already counted in the key statistics", sprint_hex_inrow(uid, uidlen));
+            }
+        }
+
         if (use_flashmemory && found_keys == (sectorsCnt << 1)) {
             PrintAndLogEx(SUCCESS, "Card dumped as well. run " _YELLOW_("`%s %c`"),
                           "hf mf esave",
@@ -4154,12 +4554,160 @@ out:
         }
     }
 out2:
+    keyorder_free(ko);
+    keystats_free(&stats);
+    free(chunk);
     free(keyBlock);
     free(e_sector);
     PrintAndLogEx(NORMAL, "");
     return PM3_SUCCESS;
 }
 
+static int keystats_cmp_cards(const void *a, const void *b) {
+    const keystats_entry_t *ka = (const keystats_entry_t *)a;
+    const keystats_entry_t *kb = (const keystats_entry_t *)b;
+    if (ka->cards != kb->cards) {
+        return (ka->cards < kb->cards) - (ka->cards > kb->cards);
+    }
+    return (ka->sectors < kb->sectors) - (ka->sectors > kb->sectors);
+}
+
+static int CmdHF14AMfKeyStats(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "hf mf keystats",
+                  "Show the key statistics `hf mf fchk` orders its dictionary on.\n"
+                  "Every card checked adds the keys found, keys that opened many cards are sent first.\n"
+                  "The simulator replays fchk against synthetic cards keyed from the dictionary, in dictionary\n"
+                  "order and in adaptive order, and reports the round trips and authentications each needs",
+                  "hf mf keystats                       --> show the 20 most successful keys\n"
+                  "hf mf keystats --reset               --> forget the statistics\n"
+                  "hf mf keystats --sim 500             --> simulate 500 MIFARE Classic 1k cards\n"
+                  "hf mf keystats --sim 200 --4k -f mfc_default_keys --seed 7");
+
+    void *argtable[] = {
+        arg_param_begin,
+        arg_int0("n", NULL, "<dec>", "number of keys to show (def 20)"),
+        arg_lit0(NULL, "reset", "forget the key statistics"),
+        arg_u64_0(NULL, "sim", "<dec>", "simulate fchk on this many cards"),
+        arg_u64_0(NULL, "seed", "<dec>", "simulator seed (def 1)"),
+        arg_str0("f", "file", "<fn>", "simulator dictionary (def mfc_default_keys)"),
+        arg_lit0(NULL, "mini", "MIFARE Classic Mini / S20"),
+        arg_lit0(NULL, "1k", "MIFARE Classic 1k / S50 (default)"),
+        arg_lit0(NULL, "2k", "MIFARE Classic/Plus 2k"),
+        arg_lit0(NULL, "4k", "MIFARE Classic 4k / S70"),
+        arg_param_end
+    };
+    CLIExecWithReturn(ctx, Cmd, argtable, true);
+
+    int top = arg_get_int_def(ctx, 1, 20);
+    bool reset = arg_get_lit(ctx, 2);
+    uint32_t cards = arg_get_u32_def(ctx, 3, 0);
+    uint32_t seed = arg_get_u32_def(ctx, 4, 1);
+
+    int fnlen = 0;
+    char filename[FILE_PATH_SIZE] = {0};
+    CLIParamStrToBuf(arg_get_str(ctx, 5), (uint8_t *)filename, FILE_PATH_SIZE, &fnlen);
+
+    bool m0 = arg_get_lit(ctx, 6);
+    bool m1 = arg_get_lit(ctx, 7);
+    bool m2 = arg_get_lit(ctx, 8);
+    bool m4 = arg_get_lit(ctx, 9);
+    CLIParserFree(ctx);
+
+    if ((m0 + m1 + m2 + m4) > 1) {
+        PrintAndLogEx(WARNING, "Only specify one MIFARE Type");
+        return PM3_EINVARG;
+    }
+
+    uint8_t sectorsCnt = MIFARE_1K_MAXSECTOR;
+    if (m0) {
+        sectorsCnt = MIFARE_MINI_MAXSECTOR;
+    } else if (m2) {
+        sectorsCnt = MIFARE_2K_MAXSECTOR;
+    } else if (m4) {
+        sectorsCnt = MIFARE_4K_MAXSECTOR;
+    }
+
+    if (reset) {
+        char *path = NULL;
+        if (searchHomeFilePath(&path, NULL, KEYSTATS_FILE, false) != PM3_SUCCESS) {
+            return PM3_EFILE;
+        }
+        if (fileExists(path) && remove(path) != 0) {
+            PrintAndLogEx(WARNING, "Failed to remove " _YELLOW_("%s"), path);
+            free(path);
+            return PM3_EFILE;
+        }
+        PrintAndLogEx(SUCCESS, "Key statistics cleared");
+        free(path);
+        return PM3_SUCCESS;
+    }
+
+    if (cards) {
+        if (fnlen == 0) {
+            strcpy(filename, "mfc_default_keys");
+            fnlen = strlen(filename);
+        }
+
+        // the keys `hf mf fchk -f` would send
+        uint8_t *keyBlock = NULL;
+        uint32_t keycnt = 0;
+        int res = mf_load_keys(&keyBlock, &keycnt, NULL, 0, filename, fnlen, true);
+        if (res != PM3_SUCCESS) {
+            return res;
+        }
+
+        PrintAndLogEx(INFO, "Simulating fchk on " _YELLOW_("%u") " synthetic cards of " _YELLOW_("%u") " sectors...", cards, sectorsCnt);
+        uint64_t t1 = msclock();
+        keyorder_sim_t sim;
+        res = keyorder_simulate(keyBlock, keycnt, filename, cards, sectorsCnt, seed, &sim);
+        free(keyBlock);
+        if (res != PM3_SUCCESS) {
+            PrintAndLogEx(FAILED, "Simulation failed ( %d )", res);
+            return res;
+        }
+        t1 = msclock() - t1;
+
+        PrintAndLogEx(NORMAL, "");
+        PrintAndLogEx(INFO, " order      | round trips / card | auths / card");
+        PrintAndLogEx(INFO, "------------+--------------------+-------------");
+        PrintAndLogEx(INFO, " dictionary | %18.1f | %12.0f", (double)sim.chunks[0] / sim.cards, (double)sim.auths[0] / sim.cards);
+        PrintAndLogEx(INFO, " adaptive   | %18.1f | %12.0f", (double)sim.chunks[1] / sim.cards, (double)sim.auths[1] / sim.cards);
+        PrintAndLogEx(NORMAL, "");
+        PrintAndLogEx(SUCCESS, "Round trips saved " _GREEN_("%.1f %%") ", authentications saved " _GREEN_("%.1f %%") ", " _YELLOW_("%u") "/" _YELLOW_("%u") " cards opened",
+                      sim.chunks[0] ? 100.0 * ((double)sim.chunks[0] - sim.chunks[1]) / sim.chunks[0] : 0.0,
+                      sim.auths[0] ? 100.0 * ((double)sim.auths[0] - sim.auths[1]) / sim.auths[0] : 0.0,
+                      sim.opened, sim.cards);
+        PrintAndLogEx(INFO, "simulated in %" PRIu64 " ms, synthetic site-keyed cards, not a measurement on real cards", t1);
+        return PM3_SUCCESS;
+    }
+
+    keystats_t stats = {0};
+    int res = keystats_load(&stats);
+    if (res != PM3_SUCCESS) {
+        return res;
+    }
+    if (stats.count == 0) {
+        PrintAndLogEx(INFO, "No key statistics yet, they grow with every " _YELLOW_("hf mf fchk"));
+        keystats_free(&stats);
+        return PM3_SUCCESS;
+    }
+
+    qsort(stats.keys, stats.count, sizeof(keystats_entry_t), keystats_cmp_cards);
+
+    PrintAndLogEx(INFO, "Key statistics of " _YELLOW_("%u") " cards, " _YELLOW_("%zu") " keys", stats.cards, stats.count);
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx(INFO, " key          | cards | sectors | sector 0");
+    PrintAndLogEx(INFO, "--------------+-------+---------+---------");
+    for (size_t i = 0; i < stats.count && i < (size_t)top; i++) {
+        const keystats_entry_t *e = &stats.keys[i];
+        PrintAndLogEx(INFO, " " _GREEN_("%012" PRIX64) " | %5u | %7u | %8u", e->key, e->cards, e->sectors, e->sector0);
+    }
+    PrintAndLogEx(NORMAL, "");
+    keystats_free(&stats);
+    return PM3_SUCCESS;
+}
+
 static int CmdHF14AMfSmartBrute(const char *Cmd) {
     CLIParserContext *ctx;
     CLIParserInit(&ctx, "hf mf brute",
@@ -12039,6 +12587,7 @@ static command_t CommandTable[] = {
     {"nack",        CmdHf14AMfNack,         IfPm3Iso14443a,  "Test for MIFARE NACK bug"},
     {"chk",         CmdHF14AMfChk,          IfPm3Iso14443a,  "Check keys"},
     {"fchk",        CmdHF14AMfChk_fast,     IfPm3Iso14443a,  "Check keys fast, targets all keys on card"},
+    {"keystats",    CmdHF14AMfKeyStats,     AlwaysAvailable, "Show or simulate the key statistics of fchk"},
     {"decrypt",     CmdHf14AMfDecryptBytes, AlwaysAvailable, "Decrypt Crypto1 data from sniff or trace"},
     {"supercard",   CmdHf14AMfSuperCard,    IfPm3Iso14443a,  "Extract info from a `super card`"},
     {"keygen",      CmdHF14AMfKeyGen,       AlwaysAvailable, "Generate key table for some known KDFs"},
@@ -44,6 +44,7 @@
 #include "hardnested_bf_core.h"
 #include "hardnested_bitarray_core.h"
 #include "fileutils.h"
+#include "perf.h"
 
 #define NUM_CHECK_BITFLIPS_THREADS      (num_CPUs())
 #define NUM_REDUCTION_WORKING_THREADS   (num_CPUs())
@@ -1283,7 +1284,26 @@ static void estimate_sum_a8(void) {
     }
 }
 
-static int read_nonce_file(char *filename) {
+// the target a nonce file was acquired for, false if it can't be read
+static bool nonce_file_target(const char *filename, uint8_t *trgBlockNo, uint8_t *trgKeyType) {
+    FILE *fnonces = fopen(filename, "rb");
+    if (fnonces == NULL) {
+        return false;
+    }
+    uint8_t header[6];
+    size_t bytes_read = fread(header, 1, sizeof(header), fnonces);
+    fclose(fnonces);
+    if (bytes_read != sizeof(header)) {
+        return false;
+    }
+    *trgBlockNo = header[4];
+    *trgKeyType = header[5];
+    return true;
+}
+
+// partial: the file is from an interrupted acquisition, the first byte sum
+// isn't complete yet and gets checked once acquire_nonces has all of them
+static int read_nonce_file(char *filename, bool partial) {
 
     if (filename == NULL) {
         PrintAndLogEx(WARNING, "Filename is NULL");
@@ -1338,6 +1358,10 @@ static int read_nonce_file(char *filename) {
     snprintf(progress_string, sizeof(progress_string), "Target Block=%d, Keytype=%c", trgBlockNo, trgKeyType == 0 ? 'A' : 'B');
     hardnested_print_progress(num_acquired_nonces, progress_string, (float)(1LL << 47), 0);
 
+    if (partial) {
+        return PM3_SUCCESS;
+    }
+
     bool got_match = false;
     for (uint8_t i = 0; i < NUM_SUMS; i++) {
         if (first_byte_Sum == sums[i]) {
@@ -1645,11 +1669,16 @@ static int simulate_acquire_nonces(void) {
     return PM3_SUCCESS;
 }
 
-static int acquire_nonces(uint8_t blockNo, uint8_t keyType, uint8_t *key, uint8_t trgBlockNo, uint8_t trgKeyType, bool nonce_file_write, bool slow, char *filename) {
+// resume: the nonces of an earlier acquisition are already loaded from filename,
+// new ones are appended to it
+static int acquire_nonces(uint8_t blockNo, uint8_t keyType, uint8_t *key, uint8_t trgBlockNo, uint8_t trgKeyType, bool nonce_file_write, bool resume, bool slow, char *filename) {
 
     last_sample_clock = msclock();
     hardnested_stage = CHECK_1ST_BYTES;
-    num_acquired_nonces = 0;
+    uint32_t resume_cuid = cuid;
+    if (resume == false) {
+        num_acquired_nonces = 0;
+    }
 
     // initial rough estimate. Will be refined.
     sample_period = 2000;
@@ -1698,21 +1727,32 @@ static int acquire_nonces(uint8_t blockNo, uint8_t keyType, uint8_t *key, uint8_
             }
 
             cuid = resp.oldarg[1];
+            if (resume && cuid != resume_cuid) {
+                PrintAndLogEx(WARNING, "Nonces in " _YELLOW_("%s") " are from another card, cuid %08x", filename, resume_cuid);
+                DropField();
+                return PM3_ESOFT;
+            }
+
             if (nonce_file_write && fnonces == NULL) {
 
-                if ((fnonces = fopen(filename, "wb")) == NULL) {
+                if ((fnonces = fopen(filename, resume ? "ab" : "wb")) == NULL) {
                     PrintAndLogEx(WARNING, "Could not create file " _YELLOW_("%s"), filename);
                     DropField();
                     return PM3_EFILE;
                 }
 
-                snprintf(progress_text, 80, "Writing acquired nonces to binary file %s", filename);
-                hardnested_print_progress(0, progress_text, (float)(1LL << 47), 0);
-                num_to_bytes(cuid, 4, write_buf);
-                fwrite(write_buf, 1, 4, fnonces);
-                fwrite(&trgBlockNo, 1, 1, fnonces);
-                fwrite(&trgKeyType, 1, 1, fnonces);
-                fflush(fnonces);
+                if (resume) {
+                    snprintf(progress_text, 80, "Appending acquired nonces to binary file %s", filename);
+                    hardnested_print_progress(num_acquired_nonces, progress_text, (float)(1LL << 47), 0);
+                } else {
+                    snprintf(progress_text, 80, "Writing acquired nonces to binary file %s", filename);
+                    hardnested_print_progress(0, progress_text, (float)(1LL << 47), 0);
+                    num_to_bytes(cuid, 4, write_buf);
+                    fwrite(write_buf, 1, 4, fnonces);
+                    fwrite(&trgBlockNo, 1, 1, fnonces);
+                    fwrite(&trgKeyType, 1, 1, fnonces);
+                    fflush(fnonces);
+                }
             }
         }
 
@@ -2388,7 +2428,10 @@ static bool brute_force(uint64_t *found_key) {
     if (known_target_key != -1) {
         TestIfKeyExists(known_target_key);
     }
-    return brute_force_bs(NULL, candidates, cuid, num_acquired_nonces, maximum_states, nonces, best_first_bytes, found_key);
+    uint64_t perf_t0 = perf_start();
+    bool found = brute_force_bs(NULL, candidates, cuid, num_acquired_nonces, maximum_states, nonces, best_first_bytes, found_key);
+    perf_stop(PERF_HARDNESTED_BRUTE, perf_t0);
+    return found;
 }
 
 static uint16_t SumProperty(struct Crypto1State *s) {
@@ -2494,7 +2537,7 @@ static void init_it_all(void) {
     memset(sum_a0_bitarrays, 0, sizeof(sum_a0_bitarrays));
 }
 
-int mfnestedhard(uint8_t blockNo, uint8_t keyType, uint8_t *key, uint8_t trgBlockNo, uint8_t trgKeyType, uint8_t *trgkey, bool nonce_file_read, bool nonce_file_write, bool slow, int tests, uint64_t *foundkey, char *filename) {
+int mfnestedhard(uint8_t blockNo, uint8_t keyType, uint8_t *key, uint8_t trgBlockNo, uint8_t trgKeyType, uint8_t *trgkey, bool nonce_file_read, bool nonce_file_write, bool nonce_file_resume, bool slow, int tests, uint64_t *foundkey, char *filename) {
     char progress_text[80];
     char instr_set[12] = {0};
 
@@ -2647,9 +2690,22 @@ int mfnestedhard(uint8_t blockNo, uint8_t keyType, uint8_t *key, uint8_t trgBloc
         update_reduction_rate(0.0, true);
 
         int res;
+        // an interrupted acquisition goes on in the same file
+        bool resume = false;
+        if (nonce_file_resume && nonce_file_write && nonce_file_read == false) {
+            uint8_t file_blockno = 0, file_keytype = 0;
+            if (nonce_file_target(filename, &file_blockno, &file_keytype)) {
+                if (file_blockno == trgBlockNo && file_keytype == trgKeyType) {
+                    resume = true;
+                } else {
+                    PrintAndLogEx(WARNING, "Nonces in " _YELLOW_("%s") " are for block %u key %c, starting over", filename, file_blockno, file_keytype ? 'B' : 'A');
+                }
+            }
+        }
+
         if (nonce_file_read) {  // use pre-acquired data from file nonces.bin
 
-            res = read_nonce_file(filename);
+            res = read_nonce_file(filename, false);
 
             if (res != PM3_SUCCESS) {
                 free_bitflip_bitarrays();
@@ -2668,7 +2724,20 @@ int mfnestedhard(uint8_t blockNo, uint8_t keyType, uint8_t *key, uint8_t trgBloc
 
         } else { // acquire nonces.
 
-            res = acquire_nonces(blockNo, keyType, key, trgBlockNo, trgKeyType, nonce_file_write, slow, filename);
+            if (resume) {
+                res = read_nonce_file(filename, true);
+                if (res != PM3_SUCCESS) {
+                    free_bitflip_bitarrays();
+                    free_nonces_memory();
+                    free_bitarray(all_bitflips_bitarray[ODD_STATE]);
+                    free_bitarray(all_bitflips_bitarray[EVEN_STATE]);
+                    free_sum_bitarrays();
+                    free_part_sum_bitarrays();
+                    return res;
+                }
+            }
+
+            res = acquire_nonces(blockNo, keyType, key, trgBlockNo, trgKeyType, nonce_file_write, resume, slow, filename);
 
             if (res != PM3_SUCCESS) {
                 free_bitflip_bitarrays();
@@ -45,6 +45,8 @@
 #include "cmdflashmem.h" // get_signature..
 #include "uart/uart.h"   // configure timeout
 #include "util_posix.h"
+#include "perf.h"
+#include "fileutils.h"
 #include "flash.h" // reboot to bootloader mode
 #include "proxgui.h"
 #include "graph.h" // for graph data
@@ -1566,6 +1568,67 @@ static int CmdTimeout(const char *Cmd) {
     return PM3_SUCCESS;
 }
 
+static int CmdPerf(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "hw perf",
+                  "Show client performance counters.\n"
+                  "Counters are only collected while perf is enabled, persistently with `prefs set perf --on`\n"
+                  "or for this session with `hw perf --on`. Enabling resets them.",
+                  "hw perf --on              --> enable for this session\n"
+                  "hw perf                   --> show as table\n"
+                  "hw perf -j                --> show as JSON\n"
+                  "hw perf -f perf --reset   --> save as JSON to perf.json, then reset"
+                 );
+
+    void *argtable[] = {
+        arg_param_begin,
+        arg_lit0(NULL, "on", "enable counters for this session"),
+        arg_lit0(NULL, "off", "disable counters for this session"),
+        arg_lit0("r", "reset", "reset counters after showing them"),
+        arg_lit0("j", "json", "show as JSON"),
+        arg_str0("f", "file", "<fn>", "save as JSON to file"),
+        arg_param_end
+    };
+    CLIExecWithReturn(ctx, Cmd, argtable, true);
+    bool use_on = arg_get_lit(ctx, 1);
+    bool use_off = arg_get_lit(ctx, 2);
+    bool reset = arg_get_lit(ctx, 3);
+    bool json = arg_get_lit(ctx, 4);
+    int fnlen = 0;
+    char filename[FILE_PATH_SIZE] = {0};
+    CLIParamStrToBuf(arg_get_str(ctx, 5), (uint8_t *)filename, FILE_PATH_SIZE, &fnlen);
+    CLIParserFree(ctx);
+
+    if (use_on && use_off) {
+        PrintAndLogEx(FAILED, "Can only set one option");
+        return PM3_EINVARG;
+    }
+
+    if (use_on || use_off) {
+        perf_set_enabled(use_on);
+        PrintAndLogEx(INFO, "perf counters... %s", (use_on) ? _GREEN_("on") : _RED_("off"));
+        return PM3_SUCCESS;
+    }
+
+    if (fnlen) {
+        perf_save_json(filename);
+    } else if (json) {
+        perf_print_json();
+    } else {
+        if (g_perf_enabled == false) {
+            PrintAndLogEx(HINT, "Hint: perf is off, try `" _YELLOW_("hw perf --on") "` or `" _YELLOW_("prefs set perf --on") "`");
+        }
+        PrintAndLogEx(NORMAL, "");
+        perf_print_table();
+        PrintAndLogEx(NORMAL, "");
+    }
+
+    if (reset) {
+        perf_reset();
+    }
+    return PM3_SUCCESS;
+}
+
 static int CmdPing(const char *Cmd) {
     CLIParserContext *ctx;
     CLIParserInit(&ctx, "hw ping",
@@ -1941,6 +2004,7 @@ static command_t CommandTable[] = {
     {"help", CmdHelp, AlwaysAvailable, "This help"},
     {"-------------", CmdHelp, AlwaysAvailable, "----------------------- " _CYAN_("Operation") " -----------------------"},
     {"detectreader", CmdDetectReader, IfPm3Present, "Detect external reader field"},
+    {"perf", CmdPerf, AlwaysAvailable, "Show client performance counters"},
     {"status", CmdStatus, IfPm3Present, "Show runtime status information about the connected Proxmark3"},
     {"tearoff", CmdTearoff, IfPm3Present, "Program a tearoff hook for the next command supporting tearoff"},
     {"timeout", CmdTimeout, AlwaysAvailable, "Set the communication timeout on the client side"},
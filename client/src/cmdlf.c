@@ -78,6 +78,8 @@
 #include "pm3_cmd.h"        // for LF_CMDREAD_MAX_EXTRA_SYMBOLS
 #include "fpga.h"           // for set_fpga_mode
 #include "util_posix.h"         // msleep
+#include "lfstream.h"       // lf monitor
+#include "fileutils.h"      // searchFile
 
 
 static int CmdHelp(const char *Cmd);
@@ -1921,6 +1923,250 @@ int CmdLFRelay(const char *Cmd) {
     return PM3_SUCCESS;
 }
 
+//-----------------------------------------------------------------------------
+// lf monitor, streaming demodulation of live or recorded samples
+//-----------------------------------------------------------------------------
+
+typedef struct {
+    bool verbose;
+    uint32_t ids;
+} lf_monitor_ctx_t;
+
+static void lf_monitor_report(const lfstream_id_t *id, void *ctx) {
+    lf_monitor_ctx_t *mon = (lf_monitor_ctx_t *)ctx;
+    mon->ids++;
+    uint64_t lat_us = (id->reported - id->frame_end) * LFSTREAM_US_PER_SAMPLE;
+    if (mon->verbose) {
+        PrintAndLogEx(SUCCESS, "%10.3f s  " _GREEN_("%s") "  ( latency %" PRIu64 " ms )",
+                      (double)(id->frame_end * LFSTREAM_US_PER_SAMPLE) / 1000000.0, id->text, lat_us / 1000);
+    } else {
+        PrintAndLogEx(SUCCESS, _GREEN_("%s"), id->text);
+    }
+}
+
+// pm3 trace file, one signed sample per line, pushed chunk by chunk
+static int lf_monitor_file(lfstream_t *s, const char *filename, size_t chunk) {
+    char *path = NULL;
+    if (searchFile(&path, TRACES_SUBDIR, filename, ".pm3", true) != PM3_SUCCESS) {
+        if (searchFile(&path, TRACES_SUBDIR, filename, "", false) != PM3_SUCCESS) {
+            return PM3_EFILE;
+        }
+    }
+
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        PrintAndLogEx(WARNING, "couldn't open '%s'", path);
+        free(path);
+        return PM3_EFILE;
+    }
+    PrintAndLogEx(DEBUG, "streaming '%s'", path);
+    free(path);
+
+    uint8_t *buf = calloc(chunk, sizeof(uint8_t));
+    if (buf == NULL) {
+        fclose(f);
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+
+    size_t n = 0;
+    char line[80];
+    while (fgets(line, sizeof(line), f)) {
+        int v = atoi(line) + 128;
+        buf[n++] = (v < 0) ? 0 : (v > 255) ? 255 : v;
+        if (n == chunk) {
+            lfstream_push(s, buf, n);
+            n = 0;
+        }
+    }
+    lfstream_push(s, buf, n);
+    free(buf);
+    fclose(f);
+    return PM3_SUCCESS;
+}
+
+static int lf_monitor_live(lfstream_t *s) {
+    if (g_session.pm3_present == false) {
+        return PM3_ENOTTY;
+    }
+
+    sample_config config;
+    int res = lf_getconfig(&config);
+    if (res != PM3_SUCCESS) {
+        PrintAndLogEx(ERR, "failed to get current device config");
+        return res;
+    }
+    if (config.bits_per_sample != 8 || config.decimation != 1 || config.divisor != LF_DIVISOR_125) {
+        PrintAndLogEx(ERR, "monitor needs 125 kHz, 8 bits per sample and no decimation, try `" _YELLOW_("lf config --125 --bps 8 --dec 1") "`");
+        return PM3_EINVARG;
+    }
+
+    // the raw receive ring bounds the memory however long we listen,
+    // a whole second of samples gives plenty of slack to the decoders
+    const size_t ring_len = 0x20000;
+    uint8_t *ring = calloc(ring_len, sizeof(uint8_t));
+    if (ring == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+
+    // load the LF bitstream first, else the first samples may contain the CMD_WTX reply
+    res = set_fpga_mode(FPGA_BITSTREAM_LF);
+    if (res != PM3_SUCCESS) {
+        PrintAndLogEx(FAILED, "failed to load LF bitstream to FPGA");
+        free(ring);
+        return res;
+    }
+
+    clearCommandBuffer();
+    SetCommunicationRawReceiveRing(ring, ring_len);
+    SetCommunicationReceiveMode(true);
+
+    lf_sample_payload_t payload = {0};
+    payload.realtime = true;
+    SendCommandNG(CMD_LF_ACQ_RAW_ADC, (uint8_t *)&payload, sizeof(payload));
+
+    PrintAndLogEx(INFO, "Monitoring, press " _GREEN_("<Enter>") " to exit");
+
+    size_t consumed = 0;
+    uint64_t dropped = 0;
+    bool lost = false;
+    while (kbd_enter_pressed() == false) {
+        size_t pos = GetCommunicationRawReceiveNum();
+        if (pos == consumed) {
+            // nothing more will arrive once the device is gone
+            if (IsCommunicationThreadDead() || g_session.pm3_present == false) {
+                lost = true;
+                break;
+            }
+            msleep(1);
+            continue;
+        }
+
+        // we fell a whole ring behind the receiver, skip what is gone
+        if (pos - consumed > ring_len) {
+            dropped += pos - consumed - ring_len;
+            consumed = pos - ring_len;
+        }
+        while (consumed < pos) {
+            size_t off = consumed % ring_len;
+            size_t n = MIN(pos - consumed, ring_len - off);
+            lfstream_push(s, ring + off, n);
+            consumed += n;
+        }
+    }
+
+    if (lost == false) {
+        SendCommandNG(CMD_BREAK_LOOP, NULL, 0);
+        // let the device stop streaming before packets are parsed again
+        msleep(200);
+    }
+    SetCommunicationReceiveMode(false);
+    free(ring);
+
+    if (dropped) {
+        PrintAndLogEx(WARNING, "decoders fell behind, " _YELLOW_("%" PRIu64) " samples dropped", dropped);
+    }
+    if (lost) {
+        PrintAndLogEx(WARNING, "lost connection to the device, monitor stopped");
+        return PM3_EIO;
+    }
+    return PM3_SUCCESS;
+}
+
+static int CmdLFMonitor(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "lf monitor",
+                  "Continuously read LF samples and report EM410x, HID Prox and IO Prox IDs as soon as\n"
+                  "they are decoded. Samples go through a fixed size ring buffer, every hop samples the\n"
+                  "last window is demodulated, an ID is reported again only after it was gone for a while.\n"
+                  "With files, the recorded samples are streamed through the same pipeline, in order.",
+                  "lf monitor                                  -> monitor the antenna until <Enter>\n"
+                  "lf monitor --em                             -> only look for EM410x\n"
+                  "lf monitor -f lf_ATA5577_em410x -f lf_ATA5577_hid   -> stream two recordings\n"
+                  "lf monitor -f lf_ATA5577_io -l 5 -v         -> replay a recording five times, with timing"
+                 );
+
+    void *argtable[] = {
+        arg_param_begin,
+        arg_strx0("f", "file", "<fn>", "stream samples from this pm3 trace file (repeat for more)"),
+        arg_int0("l", "loop", "<dec>", "stream the files this many times (default 1)"),
+        arg_int0("c", "chunk", "<dec>", "samples per push when streaming files (default 512)"),
+        arg_int0("w", "window", "<dec>", "samples handed to the decoders (default 16384)"),
+        arg_int0(NULL, "hop", "<dec>", "samples between two decoder runs (default 2048)"),
+        arg_lit0(NULL, "em", "EM410x"),
+        arg_lit0(NULL, "hid", "HID Prox"),
+        arg_lit0(NULL, "io", "IO Prox"),
+        arg_lit0("v", "verbose", "verbose output, timestamps and latency"),
+        arg_param_end
+    };
+    CLIExecWithReturn(ctx, Cmd, argtable, true);
+
+    struct arg_str *arg_files = arg_get_str(ctx, 1);
+    int loops = arg_get_int_def(ctx, 2, 1);
+    int chunk = arg_get_int_def(ctx, 3, 512);
+    int window = arg_get_int_def(ctx, 4, LFSTREAM_DEFAULT_WINDOW);
+    int hop = arg_get_int_def(ctx, 5, LFSTREAM_DEFAULT_HOP);
+    uint32_t decoders = 0;
+    if (arg_get_lit(ctx, 6)) decoders |= LFSTREAM_MASK(LFSTREAM_EM410X);
+    if (arg_get_lit(ctx, 7)) decoders |= LFSTREAM_MASK(LFSTREAM_HID);
+    if (arg_get_lit(ctx, 8)) decoders |= LFSTREAM_MASK(LFSTREAM_IOPROX);
+    lf_monitor_ctx_t mon = { .verbose = arg_get_lit(ctx, 9) };
+
+    int nfiles = arg_files->count;
+    char **files = calloc(nfiles + 1, sizeof(char *));
+    if (files == NULL) {
+        CLIParserFree(ctx);
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+    for (int i = 0; i < nfiles; i++) {
+        files[i] = strdup(arg_files->sval[i]);
+    }
+    CLIParserFree(ctx);
+
+    if (decoders == 0) {
+        decoders = LFSTREAM_ALL;
+    }
+
+    int res = PM3_EINVARG;
+    lfstream_t *s = NULL;
+    if (loops < 1 || chunk < 1) {
+        PrintAndLogEx(ERR, "loop and chunk must be positive");
+    } else if (window < 1024 || hop < 1 || hop > window) {
+        PrintAndLogEx(ERR, "window must be at least 1024 samples and hop between 1 and the window");
+    } else if ((s = lfstream_new(window, hop, decoders, lf_monitor_report, &mon)) == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        res = PM3_EMALLOC;
+    } else if (nfiles) {
+        res = PM3_SUCCESS;
+        for (int l = 0; l < loops && res == PM3_SUCCESS; l++) {
+            for (int i = 0; i < nfiles && res == PM3_SUCCESS; i++) {
+                res = lf_monitor_file(s, files[i], chunk);
+            }
+        }
+        lfstream_flush(s);
+    } else {
+        res = lf_monitor_live(s);
+        lfstream_flush(s);
+    }
+
+    if (s) {
+        PrintAndLogEx(NORMAL, "");
+        PrintAndLogEx(INFO, "%u ID(s) reported", mon.ids);
+        if (mon.verbose) {
+            lfstream_print_stats(s);
+        }
+        lfstream_free(s);
+    }
+
+    for (int i = 0; i < nfiles; i++) {
+        free(files[i]);
+    }
+    free(files);
+    return res;
+}
+
 int CmdLFfind(const char *Cmd) {
 
     CLIParserContext *ctx;
@@ -2419,6 +2665,7 @@ static command_t CommandTable[] = {
     {"-----------", CmdHelp,            AlwaysAvailable, "--------------------- " _CYAN_("General") " ---------------------"},
     {"config",      CmdLFConfig,        IfPm3Lf,         "Get/Set config for LF sampling, bit/sample, decimation, frequency"},
     {"cmdread",     CmdLFCommandRead,   IfPm3Lf,         "Modulate LF reader field to send command before read"},
+    {"monitor",     CmdLFMonitor,       AlwaysAvailable, "Stream samples and report IDs as they are decoded"},
     {"read",        CmdLFRead,          IfPm3Lf,         "Read LF tag"},
     {"relay",       CmdLFRelay,         IfPm3Lf,         "LF relay between two pm3 devices (tag/rdr mode)"},
     {"search",      CmdLFfind,          AlwaysAvailable, "Read and Search for valid known tag"},
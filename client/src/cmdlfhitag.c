@@ -32,6 +32,8 @@
 #include "cmddata.h"    // setDemodBuff
 #include "pm3_cmd.h"    // return codes
 #include "hitag2/hitag2_crypto.h"
+#include "hitag2/hitag2_bs.h"
+#include "hitag2/hitag2_crack5.h"
 #include "util_posix.h"             // msclock
 
 static int CmdHelp(const char *Cmd);
@@ -460,27 +462,32 @@ static bool ht2_check_cryptokeys(const uint64_t *keys, const uint32_t keycount,
         return false;
     }
 
-    uint32_t iv = REV32((nrar[3] << 24) + (nrar[2] << 16) + (nrar[1] << 8) + nrar[0]);
-    uint32_t ar = (nrar[4] << 24) + (nrar[5] << 16) + (nrar[6] << 8) + nrar[7];
+    ht2_nrar_t pair = {
+        .nr = REV32((nrar[3] << 24) + (nrar[2] << 16) + (nrar[1] << 8) + nrar[0]),
+        .ar = (nrar[4] << 24) + (nrar[5] << 16) + (nrar[6] << 8) + nrar[7],
+    };
 
-    bool found = false;
-    for (uint32_t i = 0; i < keycount; i++) {
+    uint64_t *revkeys = calloc(keycount, sizeof(uint64_t));
+    if (revkeys == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return false;
+    }
 
+    for (uint32_t i = 0; i < keycount; i++) {
         uint64_t key = keys[i];
         key = BSWAP_48(key);
-        key = REV64(key);
-
-        hitag_state_t hs2;
-        ht2_hitag2_init_ex(&hs2, key, _ht2state.uid, iv);
+        revkeys[i] = REV64(key);
+    }
 
-        uint32_t tbits = ht2_hitag2_nstep(&hs2, 32);
-        if ((ar ^ tbits) == 0xFFFFFFFF) {
-            _ht2state.found_key = true;
-            _ht2state.key = key;
-            found = true;
-            break;
-        }
+    bool found = false;
+    uint32_t idx = 0;
+    if (ht2_bs_check_keys(revkeys, keycount, _ht2state.uid, &pair, 1, &idx) == PM3_SUCCESS) {
+        _ht2state.found_key = true;
+        _ht2state.key = revkeys[idx];
+        found = true;
     }
+
+    free(revkeys);
     return found;
 }
 
@@ -1987,11 +1994,13 @@ static int CmdLFHitag2Lookup(const char *Cmd) {
                   "This command take sniffed trace data and try to recovery a Hitag 2 crypto key.\n"
                   " You can either\n"
                   " - verify that NR/AR matches a known crypto key\n"
-                  " - verify if NR/AR matches a known 6 byte crypto key in a dictionary",
+                  " - verify if NR/AR matches a known 6 byte crypto key in a dictionary\n"
+                  " Multiple NR/AR pairs can be given, a dictionary key must match all of them.",
                   "lf hitag lookup --uid 11223344 --nr 73AA5A62 --ar EAB8529C -k 010203040506 -> check key\n"
                   "lf hitag lookup --uid 11223344 --nr 73AA5A62 --ar EAB8529C                 -> use def dictionary\n"
                   "lf hitag lookup --uid 11223344 --nr 73AA5A62 --ar EAB8529C -f my.dic       -> use custom dictionary\n"
-                  "lf hitag lookup --uid 11223344 --nrar 73AA5A62EAB8529C"
+                  "lf hitag lookup --uid 11223344 --nrar 73AA5A62EAB8529C\n"
+                  "lf hitag lookup --uid 11223344 --nrar 73AA5A62EAB8529C --nrar 998AB2C1D4B5F2E7"
                  );
 
     void *argtable[] = {
@@ -2001,7 +2010,7 @@ static int CmdLFHitag2Lookup(const char *Cmd) {
         arg_str1("u", "uid", "<hex>", "specify UID as 4 hex bytes"),
         arg_str0(NULL, "nr", "<hex>", "specify nonce as 4 hex bytes"),
         arg_str0(NULL, "ar", "<hex>", "specify answer as 4 hex bytes"),
-        arg_str0(NULL, "nrar", "<hex>", "specify nonce / answer as 8 hex bytes"),
+        arg_strx0(NULL, "nrar", "<hex>", "specify nonce / answer as 8 hex bytes (can be specified multiple times)"),
         arg_param_end
     };
 
@@ -2027,7 +2036,7 @@ static int CmdLFHitag2Lookup(const char *Cmd) {
     CLIGetHexWithReturn(ctx, 5, aarr, &alen);
 
     int nalen = 0;
-    uint8_t nrar[8] = {0};
+    uint8_t nrar[HITAG_MAX_NRAR_PAIRS * 8] = {0};
     CLIGetHexWithReturn(ctx, 6, nrar, &nalen);
 
     CLIParserFree(ctx);
@@ -2053,8 +2062,8 @@ static int CmdLFHitag2Lookup(const char *Cmd) {
         return PM3_EINVARG;
     }
 
-    if (nalen && nalen != 8) {
-        PrintAndLogEx(INFO, "NrAr wrong length. expected 8, got %i", nalen);
+    if (nalen % 8) {
+        PrintAndLogEx(INFO, "NrAr wrong length. expected multiple of 8, got %i", nalen);
         return PM3_EINVARG;
     }
 
@@ -2094,52 +2103,62 @@ static int CmdLFHitag2Lookup(const char *Cmd) {
     rev_msb_array(inkey, sizeof(inkey));
     rev_msb_array(uidarr, sizeof(uidarr));
     rev_msb_array(narr, sizeof(narr));
-    rev_msb_array(nrar, 4);
 
 
     // Little Endian
     uint64_t knownkey = MemLeToUint6byte(inkey);
     uint32_t uid = MemLeToUint4byte(uidarr);
 
-    uint32_t nr;
-    // Big Endian
-    uint32_t ar;
+    // Nr in Little Endian, Ar in Big Endian
+    ht2_nrar_t pairs[HITAG_MAX_NRAR_PAIRS + 1];
+    uint32_t paircount = 0;
 
     if (nlen && alen) {
-        nr = MemLeToUint4byte(narr);
-        ar = MemBeToUint4byte(aarr);
-    } else if (nalen) {
-        nr = MemLeToUint4byte(nrar);
-        ar = MemBeToUint4byte(nrar + 4);
-    } else {
-        PrintAndLogEx(INFO, "No nr or ar was supplied");
-        return PM3_EINVARG;
+        pairs[paircount].nr = MemLeToUint4byte(narr);
+        pairs[paircount].ar = MemBeToUint4byte(aarr);
+        paircount++;
     }
 
-    uint32_t iv = nr;
+    for (int i = 0; i < nalen; i += 8) {
+        rev_msb_array(nrar + i, 4);
+        pairs[paircount].nr = MemLeToUint4byte(nrar + i);
+        pairs[paircount].ar = MemBeToUint4byte(nrar + i + 4);
+        paircount++;
+    }
 
+    if (paircount == 0) {
+        PrintAndLogEx(INFO, "No nr or ar was supplied");
+        return PM3_EINVARG;
+    }
 
     if (inkeylen) {
 
         PrintAndLogEx(DEBUG, "UID... %08" PRIx32, uid);
-        PrintAndLogEx(DEBUG, "IV.... %08" PRIx32, iv);
         PrintAndLogEx(DEBUG, "Key... %012" PRIx64, knownkey);
 
-        //  initialize state
-        hitag_state_t hstate;
-        ht2_hitag2_init_ex(&hstate, knownkey, uid, iv);
+        for (uint32_t i = 0; i < paircount; i++) {
 
-        // get 32 bits of crypto stream.
-        uint32_t cbits = ht2_hitag2_nstep(&hstate, 32);
-        bool isok = (ar == (cbits ^ 0xFFFFFFFF));
+            uint32_t iv = pairs[i].nr;
+            uint32_t ar = pairs[i].ar;
 
-        PrintAndLogEx(DEBUG, "state.shiftreg...... %012" PRIx64, hstate.shiftreg);
-        PrintAndLogEx(DEBUG, "state.lfsr.......... %012" PRIx64, hstate.lfsr);
-        PrintAndLogEx(DEBUG, "c bits.............. %08x", cbits);
-        PrintAndLogEx(DEBUG, "c-bits ^ FFFFFFFF... %08x", cbits ^ 0xFFFFFFFF);
-        PrintAndLogEx(DEBUG, "Ar.................. %08" PRIx32 "  ( %s )", ar, (isok) ? _GREEN_("ok") : _RED_("fail"));
+            PrintAndLogEx(DEBUG, "IV.... %08" PRIx32, iv);
 
-        PrintAndLogEx(INFO, "Nr/Ar match key ( %s )", (isok) ? _GREEN_("ok") : _RED_("fail"));
+            //  initialize state
+            hitag_state_t hstate;
+            ht2_hitag2_init_ex(&hstate, knownkey, uid, iv);
+
+            // get 32 bits of crypto stream.
+            uint32_t cbits = ht2_hitag2_nstep(&hstate, 32);
+            bool isok = (ar == (cbits ^ 0xFFFFFFFF));
+
+            PrintAndLogEx(DEBUG, "state.shiftreg...... %012" PRIx64, hstate.shiftreg);
+            PrintAndLogEx(DEBUG, "state.lfsr.......... %012" PRIx64, hstate.lfsr);
+            PrintAndLogEx(DEBUG, "c bits.............. %08x", cbits);
+            PrintAndLogEx(DEBUG, "c-bits ^ FFFFFFFF... %08x", cbits ^ 0xFFFFFFFF);
+            PrintAndLogEx(DEBUG, "Ar.................. %08" PRIx32 "  ( %s )", ar, (isok) ? _GREEN_("ok") : _RED_("fail"));
+
+            PrintAndLogEx(INFO, "Nr/Ar match key ( %s )", (isok) ? _GREEN_("ok") : _RED_("fail"));
+        }
         PrintAndLogEx(NORMAL, "");
         return PM3_SUCCESS;
     }
@@ -2160,31 +2179,37 @@ static int CmdLFHitag2Lookup(const char *Cmd) {
         return res;
     }
 
-    bool found = false;
-    for (uint32_t i = 0; i < key_count; i++) {
+    uint64_t *revkeys = calloc(key_count, sizeof(uint64_t));
+    if (revkeys == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        free(keys);
+        return PM3_EMALLOC;
+    }
 
-        uint8_t *pkey = keys + (i * HITAG_CRYPTOKEY_SIZE);
-        uint64_t mykey = MemLeToUint6byte(pkey);
-        mykey = REV64(mykey);
+    for (uint32_t i = 0; i < key_count; i++) {
+        uint64_t mykey = MemLeToUint6byte(keys + (i * HITAG_CRYPTOKEY_SIZE));
+        revkeys[i] = REV64(mykey);
+    }
 
-        hitag_state_t hs2;
-        ht2_hitag2_init_ex(&hs2, mykey, uid, iv);
+    PrintAndLogEx(INFO, "Checking " _YELLOW_("%u") " keys against " _YELLOW_("%u") " Nr/Ar pair%s, using " _YELLOW_("%s") " bitslice"
+                  , key_count
+                  , paircount
+                  , (paircount > 1) ? "s" : ""
+                  , ht2_bs_best_backend()->name
+                 );
 
-        uint32_t tbits = ht2_hitag2_nstep(&hs2, 32);
-        if ((ar ^ tbits) == 0xFFFFFFFF) {
-            PrintAndLogEx(SUCCESS, "Found valid key [ " _GREEN_("%s")" ]", sprint_hex_inrow(pkey, HITAG_CRYPTOKEY_SIZE));
-            found = true;
-            break;
-        }
+    uint64_t t1 = msclock();
+    uint32_t found_idx = 0;
+    bool found = (ht2_bs_check_keys(revkeys, key_count, uid, pairs, paircount, &found_idx) == PM3_SUCCESS);
+    t1 = msclock() - t1;
 
-        if (g_debugMode) {
-            PrintAndLogEx(DEBUG, " tbits... %08" PRIx32 " Known ar... %08" PRIx32, tbits, ar);
-            PrintAndLogEx(DEBUG, " 0xFFFFFFFF ^ tbits... %08" PRIx32, tbits ^ 0xFFFFFFFF);
-            PrintAndLogEx(DEBUG, " 0xFFFFFFFF ^ ar...... %08" PRIx32, ar ^ 0xFFFFFFFF);
-            PrintAndLogEx(DEBUG, " tbits ^ ar........... %08" PRIx32 " ( 0xFFFFFFFF )",  ar ^ tbits);
-        }
+    if (found) {
+        PrintAndLogEx(SUCCESS, "Found valid key [ " _GREEN_("%s")" ]", sprint_hex_inrow(keys + (found_idx * HITAG_CRYPTOKEY_SIZE), HITAG_CRYPTOKEY_SIZE));
     }
 
+    PrintAndLogEx(DEBUG, "time in lookup " _YELLOW_("%" PRIu64) " ms, %.0f keys/s", t1, (t1) ? (float)(found ? found_idx + 1 : key_count) * 1000.0 / t1 : 0.0);
+
+    free(revkeys);
     free(keys);
 
     if (found == false) {
@@ -2275,6 +2300,233 @@ static int CmdLFHitag2Crack2(const char *Cmd) {
     return PM3_SUCCESS;
 }
 
+// Collects Nr/Ar pairs from a Hitag 2 trace, the crypto handshake is
+//   START_AUTH (reader, 5 bits) -> UID (tag, 32 bits) -> Nr Ar (reader, 64 bits)
+// Only pairs belonging to the first UID seen are kept.
+static uint32_t ht2_get_nrar_from_trace(const uint8_t *trace, uint16_t trace_len, uint32_t *uid, ht2_nrar_t *pairs, uint32_t max_pairs) {
+
+    uint32_t cnt = 0;
+    uint32_t cur_uid = 0;
+    bool have_uid = false;
+    bool in_auth = false;
+
+    uint32_t pos = 0;
+    while (pos + TRACELOG_HDR_LEN <= trace_len && cnt < max_pairs) {
+
+        const tracelog_hdr_t *hdr = (const tracelog_hdr_t *)(trace + pos);
+        if (hdr->data_len == 0 || pos + TRACELOG_HDR_LEN + hdr->data_len + TRACELOG_PARITY_LEN(hdr) > trace_len) {
+            break;
+        }
+        pos += TRACELOG_HDR_LEN + hdr->data_len + TRACELOG_PARITY_LEN(hdr);
+
+        // parity byte 0 holds the number of bits in the last byte
+        const uint8_t *frame = hdr->frame;
+        uint8_t nbits = frame[hdr->data_len];
+        size_t bn = (nbits) ? ((hdr->data_len - 1) * 8) + nbits : hdr->data_len * 8;
+
+        if (hdr->isResponse == false && bn == 5) {
+            in_auth = ((frame[0] & 0xF8) == 0xC0);
+            continue;
+        }
+
+        if (in_auth == false) {
+            continue;
+        }
+
+        if (hdr->isResponse && bn == 32) {
+            uint8_t u[4];
+            memcpy(u, frame, sizeof(u));
+            rev_msb_array(u, sizeof(u));
+            cur_uid = MemLeToUint4byte(u);
+            if (have_uid == false) {
+                *uid = cur_uid;
+                have_uid = true;
+            }
+            continue;
+        }
+
+        if (hdr->isResponse == false && bn == 64 && have_uid && cur_uid == *uid) {
+            uint8_t n[4];
+            memcpy(n, frame, sizeof(n));
+            rev_msb_array(n, sizeof(n));
+            pairs[cnt].nr = MemLeToUint4byte(n);
+            pairs[cnt].ar = MemBeToUint4byte(frame + 4);
+
+            // skip replayed handshakes
+            bool dup = false;
+            for (uint32_t i = 0; i < cnt; i++) {
+                if (pairs[i].nr == pairs[cnt].nr) {
+                    dup = true;
+                    break;
+                }
+            }
+            if (dup == false) {
+                cnt++;
+            }
+        }
+        in_auth = false;
+    }
+    return cnt;
+}
+
+static int CmdLFHitag2Crack5(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "lf hitag crack5",
+                  "This command recovers the Hitag 2 crypto key from the UID and two sniffed Nr/Ar pairs.\n"
+                  "It is the ht2crack5 attack, bitsliced and running on all CPU cores.\n"
+                  "Without --uid / --nrar the pairs are taken from the trace, downloaded from the device\n"
+                  "or, with -1, from the trace buffer (see `lf hitag sniff` and `trace load`).\n"
+                  "Press <Enter> to abort.",
+                  "lf hitag crack5 -1                -> use pairs from trace buffer\n"
+                  "lf hitag crack5 --uid 12345678 --nrar 71DA20AA7EFDF3FA --nrar 2A4265F959653B07"
+                 );
+
+    void *argtable[] = {
+        arg_param_begin,
+        arg_lit0("1", "buffer", "use data from trace buffer"),
+        arg_str0("u", "uid", "<hex>", "specify UID as 4 hex bytes"),
+        arg_strx0(NULL, "nrar", "<hex>", "specify nonce / answer as 8 hex bytes (at least two)"),
+        arg_int0("t", "threads", "<n>", "worker threads (default: all logical CPUs)"),
+        arg_param_end
+    };
+
+    CLIExecWithReturn(ctx, Cmd, argtable, true);
+    bool use_buffer = arg_get_lit(ctx, 1);
+
+    int ulen = 0;
+    uint8_t uidarr[4] = {0};
+    CLIGetHexWithReturn(ctx, 2, uidarr, &ulen);
+
+    int nalen = 0;
+    uint8_t nrar[HITAG_MAX_NRAR_PAIRS * 8] = {0};
+    CLIGetHexWithReturn(ctx, 3, nrar, &nalen);
+
+    int threads = arg_get_int_def(ctx, 4, num_CPUs());
+    CLIParserFree(ctx);
+
+    // sanity checks
+    if (ulen && ulen != 4) {
+        PrintAndLogEx(INFO, "UID wrong length. expected 4, got %i", ulen);
+        return PM3_EINVARG;
+    }
+
+    if (nalen % 8) {
+        PrintAndLogEx(INFO, "NrAr wrong length. expected multiple of 8, got %i", nalen);
+        return PM3_EINVARG;
+    }
+
+    if ((ulen == 0) != (nalen == 0)) {
+        PrintAndLogEx(INFO, "Specify both --uid and --nrar, or neither to use the trace");
+        return PM3_EINVARG;
+    }
+
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    uint32_t uid = 0;
+    ht2_nrar_t pairs[HITAG_MAX_NRAR_PAIRS];
+    uint32_t paircount = 0;
+
+    if (ulen) {
+        rev_msb_array(uidarr, sizeof(uidarr));
+        uid = MemLeToUint4byte(uidarr);
+
+        // Nr in Little Endian, Ar in Big Endian
+        for (int i = 0; i < nalen; i += 8) {
+            rev_msb_array(nrar + i, 4);
+            pairs[paircount].nr = MemLeToUint4byte(nrar + i);
+            pairs[paircount].ar = MemBeToUint4byte(nrar + i + 4);
+            paircount++;
+        }
+    } else {
+        const uint8_t *trace = NULL;
+        uint16_t trace_len = 0;
+        int res = GetTraceBuffer(use_buffer, &trace, &trace_len);
+        if (res != PM3_SUCCESS) {
+            return res;
+        }
+
+        paircount = ht2_get_nrar_from_trace(trace, trace_len, &uid, pairs, ARRAYLEN(pairs));
+        PrintAndLogEx(INFO, "Found " _YELLOW_("%u") " Nr/Ar pair%s in trace", paircount, (paircount == 1) ? "" : "s");
+    }
+
+    if (paircount < 2) {
+        PrintAndLogEx(FAILED, "Need at least two Nr/Ar pairs");
+        return PM3_EINVARG;
+    }
+
+    uint8_t uidout[4];
+    Uint4byteToMemLe(uidout, uid);
+    rev_msb_array(uidout, sizeof(uidout));
+
+    PrintAndLogEx(INFO, _YELLOW_("Hitag 2") " - Crack5 key recovery");
+    PrintAndLogEx(INFO, "UID........ " _GREEN_("%s"), sprint_hex_inrow(uidout, sizeof(uidout)));
+    PrintAndLogEx(INFO, "Pairs...... " _YELLOW_("%u"), paircount);
+
+    uint64_t t1 = msclock();
+
+    ht2_crack5_t *c = ht2_crack5_start(uid, pairs, paircount, threads);
+    if (c == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+
+    PrintAndLogEx(INFO, "Threads.... " _YELLOW_("%d") " ( %s bitslice )", ht2_crack5_threads(c), ht2_crack5_backend(c));
+    PrintAndLogEx(INFO, "press " _GREEN_("<Enter>") " to abort");
+
+    // each layer 0 candidate covers 2^28 of the 2^48 states
+    uint64_t done = 0, total = 0;
+    while (ht2_crack5_status(c, &done, &total)) {
+
+        if (kbd_enter_pressed()) {
+            ht2_crack5_abort(c);
+            break;
+        }
+
+        uint64_t elapsed = msclock() - t1;
+        double rate = (elapsed) ? (double)done * 1000.0 / elapsed : 0.0;
+        uint32_t eta = (rate > 0.0) ? (uint32_t)((total - done) / rate) : 0;
+
+        PrintAndLogEx(INPLACE, "%5.1f%%  " _YELLOW_("%.0f") " Mstates/s  ETA " _YELLOW_("%u") " s"
+                      , (total) ? (double)done * 100.0 / total : 0.0
+                      , rate * (1 << 28) / 1e6
+                      , eta
+                     );
+        msleep(250);
+    }
+    PrintAndLogEx(NORMAL, "");
+
+    uint64_t key = 0;
+    int res = ht2_crack5_finish(c, &key);
+    t1 = msclock() - t1;
+
+    PrintAndLogEx(INFO, "Searched " _YELLOW_("%.1f") "%% in " _YELLOW_("%.1f") " s, " _YELLOW_("%.0f") " Mstates/s"
+                  , (total) ? (double)done * 100.0 / total : 0.0
+                  , (float)t1 / 1000.0
+                  , (t1) ? (double)done * (1 << 28) / t1 / 1000.0 : 0.0
+                 );
+
+    if (res == PM3_EOPABORTED) {
+        PrintAndLogEx(WARNING, "\naborted via keyboard!");
+        return res;
+    }
+
+    if (res != PM3_SUCCESS) {
+        PrintAndLogEx(FAILED, "Key not found");
+        return res;
+    }
+
+    uint8_t keyout[HITAG_CRYPTOKEY_SIZE];
+    for (int i = 0; i < HITAG_CRYPTOKEY_SIZE; i++) {
+        keyout[i] = reflect8((key >> (8 * i)) & 0xFF);
+    }
+
+    PrintAndLogEx(SUCCESS, "Found valid key [ " _GREEN_("%s") " ]", sprint_hex_inrow(keyout, sizeof(keyout)));
+    PrintAndLogEx(NORMAL, "");
+    return PM3_SUCCESS;
+}
+
 /* Test code
 
    Test data and below information about it comes from
@@ -2421,8 +2673,10 @@ static int CmdLFHitag2Selftest(const char *Cmd) {
     test |= hitag2_benchtest(1000);
     PrintAndLogEx(INFO, "Hitag 2 crypto, init + gen 32 bits, x1000 ( us: %" PRIu64 " )", test);
 
+    bool bs_ok = (ht2_bs_selftest() == PM3_SUCCESS);
+
     PrintAndLogEx(INFO, "--------------------------------------------------------");
-    PrintAndLogEx(SUCCESS, "Tests ( %s )", (test) ? _GREEN_("ok") : _RED_("fail"));
+    PrintAndLogEx(SUCCESS, "Tests ( %s )", (test && bs_ok) ? _GREEN_("ok") : _RED_("fail"));
     PrintAndLogEx(NORMAL, "");
     return PM3_SUCCESS;
 }
@@ -2491,6 +2745,7 @@ static command_t CommandTable[] = {
     {"-----------", CmdHelp,                    IfPm3Hitag,      "----------------------- " _CYAN_("Recovery") " -----------------------"},
     {"cc",          CmdLFHitagSCheckChallenges, IfPm3Hitag,      "Hitag S: test all provided challenges"},
     {"crack2",      CmdLFHitag2Crack2,          IfPm3Hitag,      "Recover 2048bits of crypto stream"},
+    {"crack5",      CmdLFHitag2Crack5,          AlwaysAvailable, "Recover key from two Nr/Ar pairs"},
     {"chk",         CmdLFHitag2Chk,             IfPm3Hitag,      "Check keys"},
     {"lookup",      CmdLFHitag2Lookup,          AlwaysAvailable, "Uses authentication trace to check for key in dictionary file"},
     {"ta",          CmdLFHitag2CheckChallenges, IfPm3Hitag,      "Hitag 2: test all recorded authentications"},
@@ -24,6 +24,7 @@
 
 #define HITAG2_CONFIG_OFFSET    (HITAG_BLOCK_SIZE * HITAG2_CONFIG_BLOCK)
 #define HITAG_DICTIONARY        "ht2_default"
+#define HITAG_MAX_NRAR_PAIRS    16
 
 int CmdLFHitag(const char *Cmd);
 
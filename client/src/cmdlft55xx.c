@@ -55,6 +55,13 @@
 
 #define T55XX_PSK3_MAX_CAND 32
 
+// samples downloaded per block read
+#define T55XX_SAMPLES              12000
+// first window used by the bruteforce quick check, 32 bit periods at RF/128
+#define T55XX_QUICK_WINDOW         4096
+// passwords handed to the pipelined search at a time
+#define T55XX_FAST_CHUNK           256
+
 static size_t t55xx_psk3_block0_candidates(uint32_t observed, uint8_t clk, uint32_t *out, size_t max);
 static bool t55xx_config_psk3_ambiguous(void);
 static bool t55xx_psk3_probe(bool usepwd, uint32_t password, uint8_t downlink_mode);
@@ -1570,6 +1577,8 @@ static void t55xx_detect_fallback(t55xx_conf_block_t *tests, uint8_t *hits, uint
     }
 
     free(sig);
+    // the template spectra are only worth keeping for the rounds above
+    pm3_fit_cache_clear();
 }
 
 bool t55xxTryDetectModulationEx(uint8_t downlink_mode, bool print_config, uint32_t wanted_conf, uint64_t pwd) {
@@ -3390,7 +3399,7 @@ static int CmdT55xxRestore(const char *Cmd) {
     return res;
 }
 */
-bool AcquireData(uint8_t page, uint8_t block, bool pwdmode, uint32_t password, uint8_t downlink_mode) {
+static void t55xx_send_readbl(uint8_t page, uint8_t block, bool pwdmode, uint32_t password, uint8_t downlink_mode) {
     // arg0 bitmodes:
     //  b0 = pwdmode
     //  b1 = page to read from
@@ -3413,12 +3422,24 @@ bool AcquireData(uint8_t page, uint8_t block, bool pwdmode, uint32_t password, u
 
     clearCommandBuffer();
     SendCommandNG(CMD_LF_T55XX_READBL, (uint8_t *)&payload, sizeof(payload));
+}
+
+static bool t55xx_wait_readbl(void) {
     if (WaitForResponseTimeout(CMD_LF_T55XX_READBL, NULL, 2500) == false) {
         PrintAndLogEx(WARNING, "command execution time out");
         return false;
     }
+    return true;
+}
+
+bool AcquireData(uint8_t page, uint8_t block, bool pwdmode, uint32_t password, uint8_t downlink_mode) {
+
+    t55xx_send_readbl(page, block, pwdmode, password, downlink_mode);
+    if (t55xx_wait_readbl() == false) {
+        return false;
+    }
 
-    getSamples(12000, false);
+    getSamples(T55XX_SAMPLES, false);
     bool ok = !getSignalProperties()->isnoise;
 
     config.usepwd = pwdmode;
@@ -4126,6 +4147,277 @@ out:
     return PM3_SUCCESS;
 }
 
+// Quick check on the first window in the graph buffer. A password protected
+// tag in answer-on-request mode stays silent on a wrong password, leaving only
+// the carrier. A window without energy, or without any bit clock, can't carry
+// a config block and is dropped without downloading the rest of the samples.
+static bool t55xx_quick_check(void) {
+
+    if (g_GraphTraceLen < SIGNAL_MIN_SAMPLES || getSignalProperties()->isnoise) {
+        return false;
+    }
+
+    if (GetAskClock("", false) > 0) {
+        return true;
+    }
+
+    if (GetFskClock("", false) > 0) {
+        return true;
+    }
+
+    if (GetPskClock("", false) > 0) {
+        return true;
+    }
+
+    return (GetNrzClock("", false) > 0);
+}
+
+typedef struct {
+    uint32_t tried;      // block reads, one per password and downlink mode
+    uint32_t rejected;   // dropped on the first window
+    uint64_t start;      // msclock() when the search started
+} t55xx_fast_stats_t;
+
+static void t55xx_print_rate(const char *what, const t55xx_fast_stats_t *st) {
+    uint64_t t = msclock() - st->start;
+    double secs = (double)t / 1000.0;
+    PrintAndLogEx(SUCCESS, "time in %s " _YELLOW_("%.1f") " seconds, " _YELLOW_("%u") " reads ( " _YELLOW_("%.1f") " pwd/s )"
+                  , what
+                  , secs
+                  , st->tried
+                  , (t) ? (double)st->tried / secs : 0.0
+                 );
+    if (st->rejected) {
+        PrintAndLogEx(INFO, "quick rejected %u / %u reads", st->rejected, st->tried);
+    }
+}
+
+// Pipelined password search used by bruteforce and recoverpw --fast.
+//
+// Only the first T55XX_QUICK_WINDOW samples of a read are downloaded. The read
+// of the next candidate is sent right after that download, so the quick check
+// of candidate i runs while the device acquires candidate i + 1. The device
+// overwrites its sample buffer with every read, a window passing the quick
+// check is therefore read again in full and goes through the normal detection.
+//
+// On success *found is 1 + (dl_mode << 1), like t55xx_try_one_password()
+static int t55xx_fast_search(const uint32_t *pwds, uint32_t count, uint8_t downlink_mode, bool try_all_dl_modes,
+                             t55xx_fast_stats_t *st, uint8_t *found, uint32_t *found_pwd) {
+
+    *found = 0;
+    downlink_mode &= 3;
+
+    const uint32_t nmodes = (try_all_dl_modes) ? 4 - downlink_mode : 1;
+    const uint32_t total = count * nmodes;
+    if (total == 0) {
+        return PM3_SUCCESS;
+    }
+
+#define FAST_PWD(c)  pwds[(c) / nmodes]
+#define FAST_DL(c)   (uint8_t)(downlink_mode + ((c) % nmodes))
+
+    t55xx_send_readbl(T55x7_PAGE0, T55x7_CONFIGURATION_BLOCK, true, FAST_PWD(0), FAST_DL(0));
+
+    for (uint32_t c = 0; c < total; c++) {
+
+        if (t55xx_wait_readbl() == false) {
+            return PM3_ETIMEOUT;
+        }
+
+        if (getSamples(T55XX_QUICK_WINDOW, false) != PM3_SUCCESS) {
+            return PM3_ETIMEOUT;
+        }
+
+        st->tried++;
+
+        bool more = (c + 1 < total);
+        if (more) {
+            t55xx_send_readbl(T55x7_PAGE0, T55x7_CONFIGURATION_BLOCK, true, FAST_PWD(c + 1), FAST_DL(c + 1));
+        }
+
+        if (t55xx_quick_check() == false) {
+            st->rejected++;
+        } else {
+
+            // let the read in flight finish before reading this candidate again
+            if (more && t55xx_wait_readbl() == false) {
+                return PM3_ETIMEOUT;
+            }
+
+            PrintAndLogEx(NORMAL, "");
+            PrintAndLogEx(INFO, "Trying password %08X", FAST_PWD(c));
+
+            if (AcquireData(T55x7_PAGE0, T55x7_CONFIGURATION_BLOCK, true, FAST_PWD(c), FAST_DL(c)) &&
+                    t55xxTryDetectModulationEx(FAST_DL(c), T55XX_PrintConfig, 0, FAST_PWD(c))) {
+                *found = 1 + (FAST_DL(c) << 1);
+                *found_pwd = FAST_PWD(c);
+                return PM3_SUCCESS;
+            }
+
+            if (more) {
+                t55xx_send_readbl(T55x7_PAGE0, T55x7_CONFIGURATION_BLOCK, true, FAST_PWD(c + 1), FAST_DL(c + 1));
+            }
+        }
+
+        if ((st->tried & 0x0F) == 0) {
+            uint64_t t = msclock() - st->start;
+            PrintAndLogEx(INPLACE, "Trying %08X  ( %.1f pwd/s )", FAST_PWD(c), (t) ? (double)st->tried * 1000.0 / t : 0.0);
+        }
+
+        if (IsCancelled()) {
+            if (more) {
+                t55xx_wait_readbl();
+            }
+            return PM3_EOPABORTED;
+        }
+    }
+
+#undef FAST_PWD
+#undef FAST_DL
+
+    return PM3_SUCCESS;
+}
+
+// Loads a recorded capture the same way `data load` does.
+static int t55xx_load_trace(const char *fn) {
+
+    char *path = NULL;
+    if (searchFile(&path, TRACES_SUBDIR, fn, ".pm3", true) != PM3_SUCCESS) {
+        return PM3_EFILE;
+    }
+
+    FILE *f = fopen(path, "r");
+    free(path);
+    if (f == NULL) {
+        return PM3_EFILE;
+    }
+
+    g_GraphTraceLen = 0;
+    char line[80];
+    while (fgets(line, sizeof(line), f) && g_GraphTraceLen < MAX_GRAPH_TRACE_LEN) {
+        g_GraphBuffer[g_GraphTraceLen++] = atoi(line);
+    }
+    fclose(f);
+
+    uint8_t *bits = calloc(g_GraphTraceLen, sizeof(uint8_t));
+    if (bits == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+    size_t size = getFromGraphBuffer(bits);
+    removeSignalOffset(bits, size);
+    setGraphBuffer(bits, size);
+    free(bits);
+    return PM3_SUCCESS;
+}
+
+// Offline validation of the quick check against the T55x7 / Q5 captures in
+// traces/, covering every modulation and bit rate. The first window of every
+// capture must pass, carrier only windows must be rejected.
+static int t55xx_fast_selftest(void) {
+
+    static const char *traces[] = {
+        "lf_ATA5577_HID-FC1-C9", "lf_ATA5577_awid_26", "lf_ATA5577_awid_50",
+        "lf_ATA5577_em410x", "lf_ATA5577_fdxb_animal", "lf_ATA5577_fdxb_extended",
+        "lf_ATA5577_gallagher", "lf_ATA5577_gproxii", "lf_ATA5577_hid",
+        "lf_ATA5577_hid_48", "lf_ATA5577_indala", "lf_ATA5577_indala_224",
+        "lf_ATA5577_indala_hedem", "lf_ATA5577_io", "lf_ATA5577_jablotron",
+        "lf_ATA5577_keri", "lf_ATA5577_keri_internalid", "lf_ATA5577_keri_msid",
+        "lf_ATA5577_motorola", "lf_ATA5577_nedap", "lf_ATA5577_nexwatch",
+        "lf_ATA5577_nexwatch_nexkey", "lf_ATA5577_nexwatch_quadrakey", "lf_ATA5577_noralsy",
+        "lf_ATA5577_pac", "lf_ATA5577_paradox", "lf_ATA5577_presco",
+        "lf_ATA5577_pyramid", "lf_ATA5577_securakey", "lf_ATA5577_viking",
+        "lf_ATA5577_visa2000", "lf_Q5_mod-ask-biph-50", "lf_Q5_mod-ask-man-100",
+        "lf_Q5_mod-ask-man-128", "lf_Q5_mod-ask-man-16", "lf_Q5_mod-ask-man-32",
+        "lf_Q5_mod-ask-man-40", "lf_Q5_mod-ask-man-8", "lf_Q5_mod-biphase",
+        "lf_Q5_mod-direct-32", "lf_Q5_mod-direct-40", "lf_Q5_mod-direct-50",
+        "lf_Q5_mod-fsk1", "lf_Q5_mod-fsk1-50", "lf_Q5_mod-fsk1a-50",
+        "lf_Q5_mod-fsk2", "lf_Q5_mod-fsk2-50", "lf_Q5_mod-fsk2a-40",
+        "lf_Q5_mod-fsk2a-50", "lf_Q5_mod-manchester", "lf_Q5_mod-nrz",
+        "lf_Q5_mod-psk1", "lf_Q5_mod-psk1-32-4", "lf_Q5_mod-psk1-64-8",
+        "lf_Q5_mod-psk2", "lf_Q5_mod-psk2-32-2", "lf_Q5_mod-psk3",
+        "lf_Q5_mod-psk3-32-8",
+    };
+
+    uint8_t *bits = calloc(MAX_GRAPH_TRACE_LEN, sizeof(uint8_t));
+    if (bits == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+
+    // detection sets the global config, keep the user's
+    t55xx_conf_block_t saved = config;
+
+    uint32_t detected = 0, passed = 0, false_reject = 0, loaded = 0;
+    uint64_t quick_us = 0, full_us = 0;
+
+    for (size_t i = 0; i < ARRAYLEN(traces); i++) {
+
+        if (t55xx_load_trace(traces[i]) != PM3_SUCCESS) {
+            PrintAndLogEx(WARNING, "couldn't load `" _YELLOW_("%s") "`", traces[i]);
+            continue;
+        }
+        loaded++;
+
+        size_t size = getFromGraphBuffer(bits);
+        size_t full = MIN(size, (size_t)T55XX_SAMPLES);
+        size_t window = MIN(size, (size_t)T55XX_QUICK_WINDOW);
+
+        // what a normal block read would see
+        uint64_t t = usclock();
+        setGraphBuffer(bits, full);
+        computeSignalProperties(bits, full);
+        bool det = t55xxTryDetectModulationEx(0, false, 0, -1);
+        full_us += usclock() - t;
+
+        // what the fast mode sees on the first window
+        t = usclock();
+        setGraphBuffer(bits, window);
+        computeSignalProperties(bits, window);
+        bool quick = t55xx_quick_check();
+        quick_us += usclock() - t;
+
+        detected += det;
+        passed += quick;
+        if (quick == false) {
+            false_reject++;
+            PrintAndLogEx(FAILED, "quick check rejects `" _YELLOW_("%s") "`", traces[i]);
+        }
+        PrintAndLogEx(DEBUG, "%-32s detect %s  quick %s", traces[i], det ? "yes" : "no ", quick ? "pass" : "reject");
+    }
+
+    // field on, tag silent
+    uint32_t silent_pass = 0;
+    for (int k = 0; k < 2; k++) {
+        for (size_t i = 0; i < T55XX_QUICK_WINDOW; i++) {
+            bits[i] = (k == 0) ? 128 : 128 + (i % 3);
+        }
+        setGraphBuffer(bits, T55XX_QUICK_WINDOW);
+        computeSignalProperties(bits, T55XX_QUICK_WINDOW);
+        silent_pass += t55xx_quick_check();
+    }
+
+    free(bits);
+    config = saved;
+    g_GraphTraceLen = 0;
+
+    PrintAndLogEx(INFO, "captures........ %u / %zu", loaded, ARRAYLEN(traces));
+    PrintAndLogEx(INFO, "full detect..... %u", detected);
+    PrintAndLogEx(INFO, "quick pass...... %u", passed);
+    PrintAndLogEx(INFO, "false rejects... %u", false_reject);
+    PrintAndLogEx(INFO, "carrier pass.... %u / 2", silent_pass);
+    if (loaded) {
+        PrintAndLogEx(INFO, "quick check " _YELLOW_("%" PRIu64) " us, full detect " _YELLOW_("%" PRIu64) " us per capture"
+                      , quick_us / loaded
+                      , full_us / loaded
+                     );
+    }
+
+    bool isok = (loaded == ARRAYLEN(traces)) && (false_reject == 0) && (silent_pass == 0);
+    PrintAndLogEx((isok) ? SUCCESS : FAILED, "bruteforce quick check ( %s )", (isok) ? _GREEN_("ok") : _RED_("fail"));
+    return (isok) ? PM3_SUCCESS : PM3_ESOFT;
+}
+
 // Bruteforce - incremental password range search
 static int CmdT55xxBruteForce(const char *Cmd) {
     CLIParserContext *ctx;
@@ -4134,15 +4426,19 @@ static int CmdT55xxBruteForce(const char *Cmd) {
                   "Try reading Page 0, block 7 before.\n\n"
                   _RED_("WARNING") _CYAN_(" this may brick non-password protected chips!"),
                   "lf t55xx bruteforce --r2 -s aaaaaa77 -e aaaaaa99\n"
+                  "lf t55xx bruteforce --fast -s aaaaaa77 -e aaaaaa99  -> quick reject on first window, pipelined reads\n"
+                  "lf t55xx bruteforce --test                          -> validate quick reject against traces/"
                  );
 
-    // 1 (help) + 2 (two user specified params) + (6 T55XX_DLMODE_ALL)
-    void *argtable[3 + 6] = {
+    // 1 (help) + 4 (four user specified params) + (6 T55XX_DLMODE_ALL)
+    void *argtable[5 + 6] = {
         arg_param_begin,
-        arg_str1("s", "start", "<hex>", "search start password (4 hex bytes)"),
-        arg_str1("e", "end", "<hex>", "search end password (4 hex bytes)"),
+        arg_str0("s", "start", "<hex>", "search start password (4 hex bytes)"),
+        arg_str0("e", "end", "<hex>", "search end password (4 hex bytes)"),
+        arg_lit0(NULL, "fast", "download first window only, overlap reads with detection"),
+        arg_lit0(NULL, "test", "offline self test of the quick reject"),
     };
-    uint8_t idx = 3;
+    uint8_t idx = 5;
     arg_add_t55xx_downloadlink(argtable, &idx, T55XX_DLMODE_ALL, T55XX_DLMODE_ALL);
     CLIExecWithReturn(ctx, Cmd, argtable, true);
 
@@ -4162,13 +4458,30 @@ static int CmdT55xxBruteForce(const char *Cmd) {
         return PM3_EINVARG;
     }
 
-    bool r0 = arg_get_lit(ctx, 3);
-    bool r1 = arg_get_lit(ctx, 4);
-    bool r2 = arg_get_lit(ctx, 5);
-    bool r3 = arg_get_lit(ctx, 6);
-    bool ra = arg_get_lit(ctx, 7);
+    bool fast = arg_get_lit(ctx, 3);
+    bool selftest = arg_get_lit(ctx, 4);
+    bool r0 = arg_get_lit(ctx, 5);
+    bool r1 = arg_get_lit(ctx, 6);
+    bool r2 = arg_get_lit(ctx, 7);
+    bool r3 = arg_get_lit(ctx, 8);
+    bool ra = arg_get_lit(ctx, 9);
+    bool has_range = (arg_get_str_len(ctx, 1) && arg_get_str_len(ctx, 2));
     CLIParserFree(ctx);
 
+    if (selftest) {
+        return t55xx_fast_selftest();
+    }
+
+    if (has_range == false) {
+        PrintAndLogEx(FAILED, "Must specify start and end password");
+        return PM3_EINVARG;
+    }
+
+    if (g_session.pm3_present == false) {
+        PrintAndLogEx(WARNING, "Your proxmark3 device is offline, only " _YELLOW_("--test") " is available");
+        return PM3_ENODATA;
+    }
+
     if ((r0 + r1 + r2 + r3 + ra) > 1) {
         PrintAndLogEx(FAILED, "Error multiple downlink encoding");
         return PM3_EINVARG;
@@ -4197,7 +4510,32 @@ static int CmdT55xxBruteForce(const char *Cmd) {
     PrintAndLogEx(INFO, "Press " _GREEN_("<Enter>") " to exit");
     PrintAndLogEx(INFO, "Search password range [%08X -> %08X]", start_password, end_password);
 
-    uint64_t t1 = msclock();
+    t55xx_fast_stats_t st = { .start = msclock() };
+
+    if (fast) {
+        uint32_t chunk[T55XX_FAST_CHUNK];
+        uint64_t next = start_password;
+        int ret = PM3_SUCCESS;
+
+        while (found == 0 && ret == PM3_SUCCESS && next <= end_password) {
+            uint32_t n = 0;
+            while (n < T55XX_FAST_CHUNK && next <= end_password) {
+                chunk[n++] = (uint32_t)next++;
+            }
+            ret = t55xx_fast_search(chunk, n, downlink_mode, ra, &st, &found, &curr);
+        }
+
+        PrintAndLogEx(NORMAL, "");
+        if (found) {
+            PrintAndLogEx(SUCCESS, "Found valid password: [ " _GREEN_("%08X") " ]", curr);
+            T55xx_Print_DownlinkMode((found >> 1) & 3);
+        } else if (ret == PM3_SUCCESS) {
+            PrintAndLogEx(WARNING, "Bruteforce failed, last tried: [ " _YELLOW_("%08X") " ]", end_password);
+        }
+        t55xx_print_rate("bruteforce", &st);
+        return ret;
+    }
+
     curr = start_password;
 
     while (found == 0) {
@@ -4209,6 +4547,7 @@ static int CmdT55xxBruteForce(const char *Cmd) {
         }
 
         found = t55xx_try_one_password(curr, downlink_mode, ra);
+        st.tried++;
 
         if (curr == end_password)
             break;
@@ -4227,8 +4566,7 @@ static int CmdT55xxBruteForce(const char *Cmd) {
     } else
         PrintAndLogEx(WARNING, "Bruteforce failed, last tried: [ " _YELLOW_("%08X") " ]", curr);
 
-    t1 = msclock() - t1;
-    PrintAndLogEx(SUCCESS, "\ntime in bruteforce " _YELLOW_("%.0f") " seconds\n", (float)t1 / 1000.0);
+    t55xx_print_rate("bruteforce", &st);
     return PM3_SUCCESS;
 }
 
@@ -4266,14 +4604,16 @@ static int CmdT55xxRecoverPW(const char *Cmd) {
                   "lf t55xx recoverpw\n"
                   "lf t55xx recoverpw -p 11223344\n"
                   "lf t55xx recoverpw -p 11223344 --r3\n"
+                  "lf t55xx recoverpw -p 11223344 --fast\n"
                  );
 
-    // 1 (help) + 1 (one user specified params) + (6 T55XX_DLMODE_ALL)
-    void *argtable[2 + 6] = {
+    // 1 (help) + 2 (two user specified params) + (6 T55XX_DLMODE_ALL)
+    void *argtable[3 + 6] = {
         arg_param_begin,
         arg_str0("p", "pwd", "<hex>", "password (4 hex bytes)"),
+        arg_lit0(NULL, "fast", "download first window only, overlap reads with detection"),
     };
-    uint8_t idx = 2;
+    uint8_t idx = 3;
     arg_add_t55xx_downloadlink(argtable, &idx, T55XX_DLMODE_ALL, T55XX_DLMODE_ALL);
     CLIExecWithReturn(ctx, Cmd, argtable, true);
 
@@ -4283,11 +4623,12 @@ static int CmdT55xxRecoverPW(const char *Cmd) {
         PrintAndLogEx(INFO, "Password should be 4 bytes, using default pwd instead");
     }
 
-    bool r0 = arg_get_lit(ctx, 2);
-    bool r1 = arg_get_lit(ctx, 3);
-    bool r2 = arg_get_lit(ctx, 4);
-    bool r3 = arg_get_lit(ctx, 5);
-    bool ra = arg_get_lit(ctx, 6);
+    bool fast = arg_get_lit(ctx, 2);
+    bool r0 = arg_get_lit(ctx, 3);
+    bool r1 = arg_get_lit(ctx, 4);
+    bool r2 = arg_get_lit(ctx, 5);
+    bool r3 = arg_get_lit(ctx, 6);
+    bool ra = arg_get_lit(ctx, 7);
     CLIParserFree(ctx);
 
     if ((r0 + r1 + r2 + r3 + ra) > 1) {
@@ -4313,6 +4654,47 @@ static int CmdT55xxRecoverPW(const char *Cmd) {
     uint32_t mask = 0x0;
     uint8_t found = 0;
 
+    if (fast) {
+        // same candidates, same order, as the loops below
+        uint32_t cand[3 * 32];
+        uint32_t n = 0;
+
+        for (bit = 0; bit < 32; bit++) {
+            cand[n++] = orig_password ^ (1u << bit);
+        }
+
+        for (bit = 0; bit < 32; bit++) {
+            mask += (1u << bit);
+            curr_password = orig_password & mask;
+            if (prev_password != curr_password) {
+                cand[n++] = curr_password;
+            }
+            prev_password = curr_password;
+        }
+
+        mask = 0xffffffff;
+        for (bit = 0; bit < 32; bit++) {
+            mask -= (1u << bit);
+            curr_password = orig_password & mask;
+            if (prev_password != curr_password) {
+                cand[n++] = curr_password;
+            }
+            prev_password = curr_password;
+        }
+
+        t55xx_fast_stats_t st = { .start = msclock() };
+        int ret = t55xx_fast_search(cand, n, downlink_mode, ra, &st, &found, &curr_password);
+        PrintAndLogEx(NORMAL, "");
+        if (found > 0) {
+            PrintAndLogEx(SUCCESS, "Found valid password: [ " _GREEN_("%08X") " ]", curr_password);
+            T55xx_Print_DownlinkMode((found >> 1) & 3);
+        } else if (ret == PM3_SUCCESS) {
+            PrintAndLogEx(FAILED, "Recover password failed");
+        }
+        t55xx_print_rate("recoverpw", &st);
+        return ret;
+    }
+
     // first try fliping each bit in the expected password
     while (bit < 32) {
         curr_password = orig_password ^ (1u << bit);
@@ -5358,7 +5740,7 @@ static command_t CommandTable[] = {
     {"view",         CmdT55xxView,            AlwaysAvailable, "Display content from tag dump file"},
     {"write",        CmdT55xxWriteBlock,      IfPm3Lf,         "Write T55xx block data"},
     {"-----------",  CmdHelp,                 AlwaysAvailable, "------------------------------ " _CYAN_("recovery") " --------------------------------"},
-    {"bruteforce",   CmdT55xxBruteForce,      IfPm3Lf,         "Simple bruteforce attack to find password"},
+    {"bruteforce",   CmdT55xxBruteForce,      AlwaysAvailable, "Simple bruteforce attack to find password"},
     {"chk",          CmdT55xxChkPwds,         IfPm3Lf,         "Check passwords"},
     {"protect",      CmdT55xxProtect,         IfPm3Lf,         "Password protect tag"},
     {"recoverpw",    CmdT55xxRecoverPW,       IfPm3Lf,         "Try to recover from bad password write from a cloner"},
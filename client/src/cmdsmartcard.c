@@ -30,6 +30,7 @@
 #include "ui.h"
 #include "util.h"
 #include "fileutils.h"
+#include "rescache.h"
 #include "crc16.h"              // crc
 #include "cliparser.h"          // cliparsing
 #include "atrs.h"               // ATR lookup
@@ -48,36 +49,28 @@ static int CmdHelp(const char *Cmd);
 
 static int smart_loadjson(const char *preferredName, json_t **root) {
 
-    json_error_t error;
-
     if (preferredName == NULL) {
         return 1;
     }
 
-    char *path;
-    int res = searchFile(&path, RESOURCES_SUBDIR, preferredName, ".json", false);
-    if (res != PM3_SUCCESS) {
+    // parsed once per session, see rescache.c
+    *root = rescache_json_load(preferredName, ".json", false);
+    if (*root == NULL) {
         return PM3_EFILE;
     }
 
-    int retval = PM3_SUCCESS;
-    *root = json_load_file(path, 0, &error);
-    if (!*root) {
-        PrintAndLogEx(ERR, "json (%s) error on line %d: %s", path, error.line, error.text);
-        retval = PM3_ESOFT;
-        goto out;
-    }
+    char path[FILE_PATH_SIZE];
+    rescache_json_path(*root, path, sizeof(path));
 
     if (!json_is_array(*root)) {
         PrintAndLogEx(ERR, "Invalid json (%s) format. root must be an array.", path);
-        retval = PM3_ESOFT;
-        goto out;
+        json_decref(*root);
+        *root = NULL;
+        return PM3_ESOFT;
     }
 
     PrintAndLogEx(SUCCESS, "Loaded file (%s) OK.", path);
-out:
-    free(path);
-    return retval;
+    return PM3_SUCCESS;
 }
 
 static uint8_t GetATRTA1(const uint8_t *atr, size_t atrlen) {
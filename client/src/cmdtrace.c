@@ -1167,6 +1167,27 @@ static int download_trace(void) {
     return PM3_SUCCESS;
 }
 
+// Read-only view of the client trace buffer for protocol code that wants to
+// mine it (e.g. nonce pairs). Downloads the device trace first unless
+// use_buffer is set, like the `-1` option of `trace list`.
+int GetTraceBuffer(bool use_buffer, const uint8_t **trace, uint16_t *trace_len) {
+
+    if (use_buffer == false) {
+        int res = download_trace();
+        if (res != PM3_SUCCESS) {
+            return res;
+        }
+    } else if (gs_traceLen == 0 || gs_trace == NULL) {
+        PrintAndLogEx(FAILED, "You requested the trace buffer but there is no trace.");
+        PrintAndLogEx(FAILED, "Consider using `" _YELLOW_("trace load") "` or removing parameter `" _YELLOW_("-1") "`");
+        return PM3_EINVARG;
+    }
+
+    *trace = gs_trace;
+    *trace_len = gs_traceLen;
+    return PM3_SUCCESS;
+}
+
 // sanity check. Don't use proxmark if it is offline and you didn't specify useTraceBuffer
 /*
 static int SanityOfflineCheck( bool useTraceBuffer ){
@@ -30,6 +30,7 @@
 #include "util_posix.h" // msclock
 #include "util_darwin.h" // en/dis-ableNapp();
 #include "usart_defs.h"
+#include "perf.h"
 
 // #define COMMS_DEBUG
 // #define COMMS_DEBUG_RAW
@@ -50,6 +51,25 @@ static bool comm_raw_mode = false;
 static uint8_t *comm_raw_data = NULL;
 static size_t comm_raw_len = 0;
 static size_t comm_raw_pos = 0;
+static bool comm_raw_ring = false;
+
+// Bulk download, the communication thread stores the chunks of the running
+// download straight into the caller buffer instead of queueing every chunk
+// through rxBuffer.  Chunks must follow each other, offset by offset.
+typedef struct {
+    uint16_t cmd;        // reply carrying the chunks
+    uint8_t *dest;
+    uint32_t len;
+    uint32_t next;       // offset the next chunk must start at
+    uint32_t received;   // bytes stored
+    uint32_t chunks;
+    uint32_t errors;     // chunks out of sequence or out of bounds
+    uint64_t start_us;
+} comm_bulk_t;
+
+static comm_bulk_t comm_bulk;
+static bool comm_bulk_active = false;
+static pthread_mutex_t comm_bulk_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 // Transmit buffer.
 static PacketCommandOLD txBuffer;
@@ -59,6 +79,10 @@ static bool txBuffer_pending = false;
 static pthread_mutex_t txBufferMutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t txBufferSig = PTHREAD_COND_INITIALIZER;
 
+// perf, when the pending command was queued and when the last one was written
+static uint64_t txBuffer_queued_us = 0;
+static uint64_t last_tx_us = 0;
+
 // Used by PacketResponseReceived as a ring buffer for messages that are yet to be
 // processed by a command handler (WaitForResponse{,Timeout})
 static PacketResponseNG rxBuffer[CMD_BUFFER_SIZE];
@@ -78,7 +102,21 @@ static uint64_t timeout_start_time;
 
 static uint64_t last_packet_time;
 
-static bool dl_it(uint8_t *dest, uint32_t bytes, PacketResponseNG *response, size_t ms_timeout, bool show_warning, uint32_t rec_cmd);
+// called with txBufferMutex held, right after a command was written to the port
+static void perf_comms_sent(uint16_t cmd, size_t len) {
+    if (perf_enabled() == false) {
+        return;
+    }
+
+    uint64_t now = usclock();
+    perf_comms_tx(cmd, len);
+    if (txBuffer_queued_us) {
+        perf_record(PERF_COMMS_TXQUEUE, now - txBuffer_queued_us);
+    }
+    __atomic_store_n(&last_tx_us, now, __ATOMIC_RELAXED);
+}
+
+static bool dl_it(uint32_t bytes, PacketResponseNG *response, size_t ms_timeout, bool show_warning);
 
 // Simple alias to track usages linked to the Bootloader, these commands must not be migrated.
 // - commands sent to enter bootloader mode as we might have to talk to old firmwares
@@ -132,12 +170,16 @@ void SendCommandOLD(uint64_t cmd, uint64_t arg0, uint64_t arg1, uint64_t arg2, c
 
     txBuffer = c;
     txBuffer_pending = true;
+    txBuffer_queued_us = perf_start();
 
     // tell communication thread that a new command can be send
     pthread_cond_signal(&txBufferSig);
 
     pthread_mutex_unlock(&txBufferMutex);
 
+    // don't let it wait for the receive timeout first
+    uart_wakeup();
+
 //__atomic_test_and_set(&txcmd_pending, __ATOMIC_SEQ_CST);
 }
 
@@ -196,12 +238,16 @@ static void SendCommandNG_internal(uint16_t cmd, uint8_t *data, size_t len, bool
     print_hex_break((uint8_t *)tx_post, sizeof(PacketCommandNGPostamble), 32);
 #endif
     txBuffer_pending = true;
+    txBuffer_queued_us = perf_start();
 
     // tell communication thread that a new command can be send
     pthread_cond_signal(&txBufferSig);
 
     pthread_mutex_unlock(&txBufferMutex);
 
+    // don't let it wait for the receive timeout first
+    uart_wakeup();
+
 //__atomic_test_and_set(&txcmd_pending, __ATOMIC_SEQ_CST);
 }
 
@@ -278,6 +324,72 @@ static int getReply(PacketResponseNG *packet) {
     return 1;
 }
 
+static void comm_bulk_begin(uint16_t cmd, uint8_t *dest, uint32_t len) {
+    pthread_mutex_lock(&comm_bulk_mutex);
+    memset(&comm_bulk, 0, sizeof(comm_bulk));
+    comm_bulk.cmd = cmd;
+    comm_bulk.dest = dest;
+    comm_bulk.len = len;
+    comm_bulk.start_us = usclock();
+    __atomic_store_n(&comm_bulk_active, true, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&comm_bulk_mutex);
+}
+
+// stops the download, the communication thread doesn't touch dest anymore when it returns
+static void comm_bulk_end(comm_bulk_t *stats) {
+    pthread_mutex_lock(&comm_bulk_mutex);
+    __atomic_store_n(&comm_bulk_active, false, __ATOMIC_SEQ_CST);
+    *stats = comm_bulk;
+    pthread_mutex_unlock(&comm_bulk_mutex);
+
+    uint64_t us = usclock() - stats->start_us;
+    perf_add(PERF_COMMS_BULK, us);
+    perf_add(PERF_COMMS_BULK_BYTES, stats->received);
+    PrintAndLogEx(DEBUG, "downloaded %u/%u bytes, %u chunks, %u errors in %" PRIu64 " ms ( %.1f kB/s )"
+                  , stats->received
+                  , stats->len
+                  , stats->chunks
+                  , stats->errors
+                  , us / 1000
+                  , (us) ? (stats->received * 1000.0) / us : 0.0
+                 );
+}
+
+// Called by the communication thread for every OLD / MIX frame.
+// Returns true when the frame was a chunk of the running download.
+static bool comm_bulk_store(uint64_t cmd, uint64_t offset, uint64_t len, const uint8_t *data, size_t datalen) {
+
+    if (__atomic_load_n(&comm_bulk_active, __ATOMIC_SEQ_CST) == false) {
+        return false;
+    }
+
+    pthread_mutex_lock(&comm_bulk_mutex);
+    if (comm_bulk_active == false || cmd != comm_bulk.cmd) {
+        pthread_mutex_unlock(&comm_bulk_mutex);
+        return false;
+    }
+
+    if (len > datalen || offset > comm_bulk.len || len > comm_bulk.len - offset) {
+        PrintAndLogEx(FAILED, "ERROR: Out of bounds when downloading from device,  offset %" PRIu64 " | len %" PRIu64 " | buf_size %u", offset, len, comm_bulk.len);
+        comm_bulk.errors++;
+    } else {
+        // a lost or repeated chunk shows as a gap
+        if (offset != comm_bulk.next) {
+            PrintAndLogEx(DEBUG, "download chunk out of sequence, offset %" PRIu64 " expected %u", offset, comm_bulk.next);
+            comm_bulk.errors++;
+        }
+        memcpy(comm_bulk.dest + offset, data, len);
+        comm_bulk.next = offset + len;
+        comm_bulk.received += len;
+        comm_bulk.chunks++;
+    }
+    pthread_mutex_unlock(&comm_bulk_mutex);
+
+    // we got a packet, reset dl_it timeout
+    __atomic_store_n(&timeout_start_time, msclock(), __ATOMIC_SEQ_CST);
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 // Entry point into our code: called whenever we received a packet over USB
 // that we weren't necessarily expecting, for example a debug print.
@@ -452,16 +564,23 @@ __attribute__((force_align_arg_pointer))
             uint8_t *bufferData = __atomic_load_n(&comm_raw_data, __ATOMIC_SEQ_CST); // read only
             size_t bufferLen = __atomic_load_n(&comm_raw_len, __ATOMIC_SEQ_CST); // read only
             size_t bufferPos = __atomic_load_n(&comm_raw_pos, __ATOMIC_SEQ_CST); // read and write
-            if (bufferPos < bufferLen) {
-                size_t rxMaxLen = bufferLen - bufferPos;
+            bool ring = __atomic_load_n(&comm_raw_ring, __ATOMIC_SEQ_CST);
+            if (ring || bufferPos < bufferLen) {
+                // a ring wraps around, bufferPos keeps counting all bytes received
+                size_t offset = ring ? bufferPos % bufferLen : bufferPos;
+                size_t rxMaxLen = bufferLen - offset;
 
                 rxMaxLen = MIN(COMM_RAW_RECEIVE_LEN, rxMaxLen);
 
-                res = uart_receive(sp, bufferData + bufferPos, rxMaxLen, &rxlen);
+                res = uart_receive_wakeable(sp, bufferData + offset, rxMaxLen, &rxlen);
                 if (res == PM3_SUCCESS) {
                     uint64_t clk = msclock();
                     __atomic_store_n(&timeout_start_time,  clk, __ATOMIC_SEQ_CST);
                     __atomic_store_n(&comm_raw_pos, bufferPos + rxlen, __ATOMIC_SEQ_CST);
+                    // raw reads are accounted to the command which started them
+                    if (perf_enabled()) {
+                        perf_comms_rx(g_conn.last_command, rxlen);
+                    }
                 } else if (res != PM3_ENODATA) {
                     PrintAndLogEx(WARNING, "Error when reading raw data: %zu/%zu, %d", bufferPos, bufferLen, res);
                     error = true;
@@ -473,7 +592,7 @@ __attribute__((force_align_arg_pointer))
                 // Ignore data when bufferPos >= bufferLen and is_receiving_raw has not been set to false
                 uint8_t dummyData[64];
                 uint32_t dummyLen;
-                uart_receive(sp, dummyData, sizeof(dummyData), &dummyLen);
+                uart_receive_wakeable(sp, dummyData, sizeof(dummyData), &dummyLen);
             }
         } else {
             if (is_receiving_raw_last) {
@@ -483,7 +602,7 @@ __attribute__((force_align_arg_pointer))
                 // comm_raw_data == NULL is used in SetCommunicationReceiveMode()
                 __atomic_store_n(&comm_raw_data, NULL, __ATOMIC_SEQ_CST);
             }
-            res = uart_receive(sp, (uint8_t *)&rx_raw.pre, sizeof(PacketResponseNGPreamble), &rxlen);
+            res = uart_receive_wakeable(sp, (uint8_t *)&rx_raw.pre, sizeof(PacketResponseNGPreamble), &rxlen);
 
             if ((res == PM3_SUCCESS) && (rxlen == sizeof(PacketResponseNGPreamble))) {
 
@@ -584,7 +703,12 @@ __attribute__((force_align_arg_pointer))
                         print_hex_break((uint8_t *)&rx_raw.data, rx_raw.pre.length, 32);
                         print_hex_break((uint8_t *)&rx_raw.foopost, sizeof(PacketResponseNGPostamble), 32);
 #endif
-                        PacketResponseReceived(&rx);
+                        if (perf_enabled()) {
+                            perf_comms_rx(rx.cmd, sizeof(PacketResponseNGPreamble) + length + sizeof(PacketResponseNGPostamble));
+                        }
+                        if (rx.ng || (comm_bulk_store(rx.cmd, rx.oldarg[0], rx.oldarg[1], rx.data.asBytes, rx.length) == false)) {
+                            PacketResponseReceived(&rx);
+                        }
                     }
                 } else {                               // Old style reply
                     PacketResponseOLD rx_old;
@@ -595,7 +719,12 @@ __attribute__((force_align_arg_pointer))
                         PrintAndLogEx(WARNING, "Received packet OLD frame with payload too short? %d/%zu", rxlen, sizeof(PacketResponseOLD) - sizeof(PacketResponseNGPreamble));
                         error = true;
                     }
-                    if (!error) {
+                    if ((!error) && comm_bulk_store(rx_old.cmd, rx_old.arg[0], rx_old.arg[1], rx_old.d.asBytes, sizeof(rx_old.d))) {
+                        // download chunk, already in place
+                        if (perf_enabled()) {
+                            perf_comms_rx(rx_old.cmd, sizeof(PacketResponseOLD));
+                        }
+                    } else if (!error) {
 #ifdef COMMS_DEBUG
                         PrintAndLogEx(NORMAL, "Receiving OLD:");
 #endif
@@ -614,6 +743,9 @@ __attribute__((force_align_arg_pointer))
                         rx.oldarg[2] = rx_old.arg[2];
                         rx.length = PM3_CMD_DATA_SIZE;
                         memcpy(&rx.data, &rx_old.d, rx.length);
+                        if (perf_enabled()) {
+                            perf_comms_rx(rx.cmd, sizeof(PacketResponseOLD));
+                        }
                         PacketResponseReceived(&rx);
                         if (rx.cmd == CMD_ACK) {
                             ACK_received = true;
@@ -657,6 +789,7 @@ __attribute__((force_align_arg_pointer))
                     commfailed = true;
                 }
                 g_conn.last_command = txBufferNG.pre.cmd;
+                perf_comms_sent(txBufferNG.pre.cmd, txBufferNGLen);
                 txBufferNGLen = 0;
             } else {
                 res = uart_send(sp, (uint8_t *) &txBuffer, sizeof(PacketCommandOLD));
@@ -664,6 +797,7 @@ __attribute__((force_align_arg_pointer))
                     commfailed = true;
                 }
                 g_conn.last_command = txBuffer.cmd;
+                perf_comms_sent(txBuffer.cmd, sizeof(PacketCommandOLD));
             }
 
             txBuffer_pending = false;
@@ -709,7 +843,10 @@ bool IsCommunicationThreadDead(void) {
 // SetCommunicationReceiveMode(false) to stop the raw receiving process.
 // 2. If the received size >= len used in SetCommunicationRawReceiveBuffer(),
 // The receiving thread will ignore the incoming data to prevent overflow.
-// 3. Normally you only need WaitForRawDataTimeout() rather than the
+// 3. SetCommunicationRawReceiveRing(...) sets a buffer the receiving thread
+// wraps around in instead, GetCommunicationRawReceiveNum() then counts all
+// bytes received and the caller has to keep up with the writer.
+// 4. Normally you only need WaitForRawDataTimeout() rather than the
 // low level functions like SetCommunicationReceiveMode(),
 // SetCommunicationRawReceiveBuffer() and GetCommunicationRawReceiveNum()
 
@@ -726,11 +863,17 @@ bool SetCommunicationReceiveMode(bool isRawMode) {
 }
 
 void SetCommunicationRawReceiveBuffer(uint8_t *buffer, size_t len) {
+    __atomic_store_n(&comm_raw_ring,  false, __ATOMIC_SEQ_CST);
     __atomic_store_n(&comm_raw_data,  buffer, __ATOMIC_SEQ_CST);
     __atomic_store_n(&comm_raw_len,  len, __ATOMIC_SEQ_CST);
     __atomic_store_n(&comm_raw_pos,  0, __ATOMIC_SEQ_CST);
 }
 
+void SetCommunicationRawReceiveRing(uint8_t *buffer, size_t len) {
+    SetCommunicationRawReceiveBuffer(buffer, len);
+    __atomic_store_n(&comm_raw_ring,  true, __ATOMIC_SEQ_CST);
+}
+
 size_t GetCommunicationRawReceiveNum(void) {
     return __atomic_load_n(&comm_raw_pos, __ATOMIC_SEQ_CST);
 }
@@ -1110,6 +1253,12 @@ bool WaitForResponseTimeoutW(uint32_t cmd, PacketResponseNG *response, size_t ms
         while (getReply(response)) {
 
             if (cmd == CMD_UNKNOWN || response->cmd == cmd) {
+                if (perf_enabled()) {
+                    uint64_t tx = __atomic_load_n(&last_tx_us, __ATOMIC_RELAXED);
+                    if (tx) {
+                        perf_record(PERF_COMMS_ROUNDTRIP, usclock() - tx);
+                    }
+                }
                 return true;
             }
 
@@ -1135,6 +1284,7 @@ bool WaitForResponseTimeoutW(uint32_t cmd, PacketResponseNG *response, size_t ms
         // just to avoid CPU busy loop:
         msleep(1);
     }
+    perf_add(PERF_COMMS_TIMEOUT, 1);
     return false;
 }
 
@@ -1181,45 +1331,65 @@ bool GetFromDevice(DeviceMemType_t memtype, uint8_t *dest, uint32_t bytes, uint3
     // clear
     clearCommandBuffer();
 
+    // the chunks go straight to dest, register it before the first one can arrive
     switch (memtype) {
         case BIG_BUF: {
+            comm_bulk_begin(CMD_DOWNLOADED_BIGBUF, dest, bytes);
             SendCommandMIX(CMD_DOWNLOAD_BIGBUF, start_index, bytes, 0, NULL, 0);
-            return dl_it(dest, bytes, response, ms_timeout, show_warning, CMD_DOWNLOADED_BIGBUF);
+            return dl_it(bytes, response, ms_timeout, show_warning);
         }
         case BIG_BUF_EML: {
+            comm_bulk_begin(CMD_DOWNLOADED_EML_BIGBUF, dest, bytes);
             SendCommandMIX(CMD_DOWNLOAD_EML_BIGBUF, start_index, bytes, 0, NULL, 0);
-            return dl_it(dest, bytes, response, ms_timeout, show_warning, CMD_DOWNLOADED_EML_BIGBUF);
+            return dl_it(bytes, response, ms_timeout, show_warning);
         }
         case SPIFFS: {
+            comm_bulk_begin(CMD_SPIFFS_DOWNLOADED, dest, bytes);
             SendCommandMIX(CMD_SPIFFS_DOWNLOAD, start_index, bytes, 0, data, datalen);
-            return dl_it(dest, bytes, response, ms_timeout, show_warning, CMD_SPIFFS_DOWNLOADED);
+            return dl_it(bytes, response, ms_timeout, show_warning);
         }
         case FLASH_MEM: {
+            comm_bulk_begin(CMD_FLASHMEM_DOWNLOADED, dest, bytes);
             SendCommandMIX(CMD_FLASHMEM_DOWNLOAD, start_index, bytes, 0, NULL, 0);
-            return dl_it(dest, bytes, response, ms_timeout, show_warning, CMD_FLASHMEM_DOWNLOADED);
+            return dl_it(bytes, response, ms_timeout, show_warning);
         }
         case SIM_MEM: {
             //SendCommandMIX(CMD_DOWNLOAD_SIM_MEM, start_index, bytes, 0, NULL, 0);
-            //return dl_it(dest, bytes, response, ms_timeout, show_warning, CMD_DOWNLOADED_SIMMEM);
+            //return dl_it(bytes, response, ms_timeout, show_warning);
             return false;
         }
         case FPGA_MEM: {
+            comm_bulk_begin(CMD_FPGAMEM_DOWNLOADED, dest, bytes);
             SendCommandNG(CMD_FPGAMEM_DOWNLOAD, NULL, 0);
-            return dl_it(dest, bytes, response, ms_timeout, show_warning, CMD_FPGAMEM_DOWNLOADED);
+            return dl_it(bytes, response, ms_timeout, show_warning);
         }
         case MCU_FLASH:
         case MCU_MEM: {
             uint32_t flags = (memtype == MCU_MEM) ? READ_MEM_DOWNLOAD_FLAG_RAW : 0;
+            comm_bulk_begin(CMD_READ_MEM_DOWNLOADED, dest, bytes);
             SendCommandBL(CMD_READ_MEM_DOWNLOAD, start_index, bytes, flags, NULL, 0);
-            return dl_it(dest, bytes, response, ms_timeout, show_warning, CMD_READ_MEM_DOWNLOADED);
+            return dl_it(bytes, response, ms_timeout, show_warning);
         }
     }
     return false;
 }
 
-static bool dl_it(uint8_t *dest, uint32_t bytes, PacketResponseNG *response, size_t ms_timeout, bool show_warning, uint32_t rec_cmd) {
+// true when every one of the bytes arrived intact
+static bool dl_complete(uint32_t bytes) {
+    comm_bulk_t stats;
+    comm_bulk_end(&stats);
+    if (stats.errors || stats.received != bytes) {
+        PrintAndLogEx(FAILED, "Download from device incomplete, got %u/%u bytes, %u bad chunks", stats.received, bytes, stats.errors);
+        return false;
+    }
+    return true;
+}
+
+// the chunks are stored by the communication thread, see comm_bulk_store()
+static bool dl_it(uint32_t bytes, PacketResponseNG *response, size_t ms_timeout, bool show_warning) {
+
+    comm_bulk_t stats;
 
-    uint32_t bytes_completed = 0;
     __atomic_store_n(&timeout_start_time,  msclock(), __ATOMIC_SEQ_CST);
 
     // Add delay depending on the communication channel & speed
@@ -1228,39 +1398,21 @@ static bool dl_it(uint8_t *dest, uint32_t bytes, PacketResponseNG *response, siz
 
     while (true) {
 
-        if (getReply(response)) {
+        while (getReply(response)) {
 
-            if (response->cmd == CMD_ACK)
-                return true;
-            if (response->cmd == CMD_SPIFFS_DOWNLOAD && response->status == PM3_EMALLOC)
+            if (response->cmd == CMD_ACK) {
+                return dl_complete(bytes);
+            }
+            if (response->cmd == CMD_SPIFFS_DOWNLOAD && response->status == PM3_EMALLOC) {
+                comm_bulk_end(&stats);
                 return false;
+            }
             // Spiffs // fpgamem-plot download is converted to NG,
-            if (response->cmd == CMD_SPIFFS_DOWNLOAD || response->cmd == CMD_FPGAMEM_DOWNLOAD)
-                return true;
-
-            // sample_buf is a array pointer, located in data.c
-            // arg0 = offset in transfer. Startindex of this chunk
-            // arg1 = length bytes to transfer
-            // arg2 = bigbuff tracelength (?)
-            if (response->cmd == rec_cmd) {
-
-                uint32_t offset = response->oldarg[0];
-                uint32_t copy_bytes = MIN(bytes - bytes_completed, response->oldarg[1]);
-                //uint32_t tracelen = response->oldarg[2];
-
-                // extended bounds check1.  upper limit is PM3_CMD_DATA_SIZE
-                // shouldn't happen
-                copy_bytes = MIN(copy_bytes, PM3_CMD_DATA_SIZE);
-
-                // extended bounds check2.
-                if (offset + copy_bytes > bytes) {
-                    PrintAndLogEx(FAILED, "ERROR: Out of bounds when downloading from device,  offset %u | len %u | total len %u > buf_size %u", offset, copy_bytes,  offset + copy_bytes,  bytes);
-                    break;
-                }
+            if (response->cmd == CMD_SPIFFS_DOWNLOAD || response->cmd == CMD_FPGAMEM_DOWNLOAD) {
+                return dl_complete(bytes);
+            }
 
-                memcpy(dest + offset, response->data.asBytes, copy_bytes);
-                bytes_completed += copy_bytes;
-            } else if (response->cmd == CMD_WTX && response->length == sizeof(uint16_t)) {
+            if (response->cmd == CMD_WTX && response->length == sizeof(uint16_t)) {
                 uint16_t wtx = response->data.asDwords[0] & 0xFFFF;
                 PrintAndLogEx(DEBUG, "Got Waiting Time eXtension request %i ms", wtx);
                 if (ms_timeout != (size_t) - 1)
@@ -1280,6 +1432,10 @@ static bool dl_it(uint8_t *dest, uint32_t bytes, PacketResponseNG *response, siz
             PrintAndLogEx(INFO, "You can cancel this operation by pressing the pm3 button");
             show_warning = false;
         }
+
+        // just to avoid CPU busy loop:
+        msleep(1);
     }
+    comm_bulk_end(&stats);
     return false;
 }
@@ -107,6 +107,7 @@ bool IsReconnectedOk(void);
 bool IsCommunicationThreadDead(void);
 bool SetCommunicationReceiveMode(bool isRawMode);
 void SetCommunicationRawReceiveBuffer(uint8_t *buffer, size_t len);
+void SetCommunicationRawReceiveRing(uint8_t *buffer, size_t len);
 size_t GetCommunicationRawReceiveNum(void);
 
 bool OpenProxmarkSilent(pm3_device_t **dev, const char *port, uint32_t speed);
@@ -0,0 +1,377 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Table driven CRC model search engine
+//-----------------------------------------------------------------------------
+#include "crcsearch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "util.h"           // num_CPUs
+#include "pm3_cmd.h"        // PM3_*
+
+// polys handed out per cursor step
+#define CRCS_SWEEP_CHUNK    (1U << 16)
+
+void crcs_kernel_init(crcs_kernel_t *k, uint8_t width, uint64_t poly, uint64_t init, uint64_t xorout) {
+    const uint64_t mask = (width == 64) ? UINT64_MAX : ((1ULL << width) - 1);
+    k->width = width;
+    k->poly = poly & mask;
+    k->init = init & mask;
+    k->xorout = xorout & mask;
+
+    // the table is linear, only the single bit entries need the shift loop
+    const uint64_t top = k->poly << (64 - width);
+    k->table[0] = 0;
+    for (int b = 1; b < 256; b <<= 1) {
+        uint64_t r = (uint64_t)b << 56;
+        for (int i = 0; i < 8; i++) {
+            r = (r << 1) ^ ((r >> 63) ? top : 0);
+        }
+        k->table[b] = r;
+    }
+    for (int b = 3; b < 256; b++) {
+        if (b & (b - 1)) {
+            k->table[b] = k->table[b & (b - 1)] ^ k->table[b & -b];
+        }
+    }
+}
+
+uint64_t crcs_get_bits(const uint8_t *bits, size_t start, uint8_t n) {
+    uint64_t v = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        size_t p = start + i;
+        v = (v << 1) | ((bits[p >> 3] >> (7 - (p & 7))) & 1);
+    }
+    return v;
+}
+
+uint64_t crcs_kernel_run(const crcs_kernel_t *k, const uint8_t *bits, size_t nbits) {
+    const uint8_t shift = 64 - k->width;
+    const uint64_t top = k->poly << shift;
+    uint64_t reg = k->init << shift;
+
+    size_t nbytes = nbits >> 3;
+    for (size_t i = 0; i < nbytes; i++) {
+        reg = (reg << 8) ^ k->table[(reg >> 56) ^ bits[i]];
+    }
+
+    // trailing bits of a non byte aligned string
+    for (size_t p = nbytes << 3; p < nbits; p++) {
+        uint64_t in = (bits[p >> 3] >> (7 - (p & 7))) & 1;
+        uint64_t t = (reg >> 63) ^ in;
+        reg = (reg << 1) ^ (t ? top : 0);
+    }
+    return (reg >> shift) ^ k->xorout;
+}
+
+bool crcs_codeword_ok(const crcs_kernel_t *k, const crcs_bitstr_t *cw) {
+    if (cw->nbits < k->width) {
+        return false;
+    }
+    size_t mlen = cw->nbits - k->width;
+    return crcs_kernel_run(k, cw->bits, mlen) == crcs_get_bits(cw->bits, mlen, k->width);
+}
+
+//-----------------------------------------------------------------------------
+// polynomial sweep
+//-----------------------------------------------------------------------------
+
+// one codeword difference, one all-ones / all-zero word per bit so the vector
+// loop doesn't need to extract bits
+typedef struct {
+    uint32_t *mask;
+    size_t nbits;
+} crcs_diff_t;
+
+typedef uint32_t crcs_v8_t __attribute__((vector_size(32)));
+
+typedef struct {
+    uint8_t width;
+    const crcs_diff_t *diffs;
+    int ndiffs;
+    uint64_t total;             // odd polys to test
+    uint64_t *next;             // shared cursor
+    uint64_t *found;
+    size_t nfound;
+    size_t cap;
+    bool failed;                // out of memory, candidates were lost
+} crcs_sweep_arg_t;
+
+// remainder of a difference divided by x^width + poly, MSB aligned register
+static bool crcs_divides(uint32_t poly_msb, const crcs_diff_t *d) {
+    uint32_t reg = 0;
+    for (size_t i = 0; i < d->nbits; i++) {
+        uint32_t t = (uint32_t)(-(int32_t)(reg >> 31)) ^ d->mask[i];
+        reg = (reg << 1) ^ (poly_msb & t);
+    }
+    return reg == 0;
+}
+
+static bool crcs_sweep_add(crcs_sweep_arg_t *a, uint64_t poly) {
+    if (a->nfound == a->cap) {
+        size_t cap = a->cap ? a->cap * 2 : 64;
+        uint64_t *tmp = realloc(a->found, cap * sizeof(uint64_t));
+        if (tmp == NULL) {
+            return false;
+        }
+        a->found = tmp;
+        a->cap = cap;
+    }
+    a->found[a->nfound++] = poly;
+    return true;
+}
+
+// Remainders of one difference for CRCS_SWEEP_VECS * 8 polys at once, all
+// lanes share the difference bits. The independent vectors keep the shift /
+// xor chains of the lanes interleaved.
+#define CRCS_SWEEP_VECS     4
+#define CRCS_SWEEP_LANES    (CRCS_SWEEP_VECS * 8)
+
+#define CRCS_DIVIDE_BODY \
+    crcs_v8_t r[CRCS_SWEEP_VECS] = {{0}}; \
+    for (size_t b = 0; b < d->nbits; b++) { \
+        const uint32_t m = d->mask[b]; \
+        for (int v = 0; v < CRCS_SWEEP_VECS; v++) { \
+            crcs_v8_t t = -(r[v] >> 31); \
+            t ^= m; \
+            r[v] = (r[v] << 1) ^ (g[v] & t); \
+        } \
+    } \
+    memcpy(reg, r, sizeof(r));
+
+static void crcs_divide_v8(const crcs_v8_t *g, const crcs_diff_t *d, crcs_v8_t *reg) {
+    CRCS_DIVIDE_BODY
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+__attribute__((target("avx2")))
+static void crcs_divide_v8_avx2(const crcs_v8_t *g, const crcs_diff_t *d, crcs_v8_t *reg) {
+    CRCS_DIVIDE_BODY
+}
+#endif
+
+typedef void (*crcs_divide_fn)(const crcs_v8_t *g, const crcs_diff_t *d, crcs_v8_t *reg);
+
+static crcs_divide_fn crcs_divide_best(void) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return crcs_divide_v8_avx2;
+    }
+#endif
+    return crcs_divide_v8;
+}
+
+static void *crcs_sweep_thread(void *arg) {
+    crcs_sweep_arg_t *a = (crcs_sweep_arg_t *)arg;
+    const uint8_t shift = 32 - a->width;
+    const crcs_divide_fn divide = crcs_divide_best();
+
+    for (;;) {
+        uint64_t start = __atomic_fetch_add(a->next, CRCS_SWEEP_CHUNK, __ATOMIC_SEQ_CST);
+        if (start >= a->total) {
+            break;
+        }
+        uint64_t end = start + CRCS_SWEEP_CHUNK;
+        if (end > a->total) {
+            end = a->total;
+        }
+
+        for (uint64_t i = start; i < end; i += CRCS_SWEEP_LANES) {
+
+            // odd polys only. Lanes past the end repeat the last poly and
+            // are dropped below.
+            crcs_v8_t g[CRCS_SWEEP_VECS], reg[CRCS_SWEEP_VECS];
+            for (int l = 0; l < CRCS_SWEEP_LANES; l++) {
+                uint64_t idx = (i + l < end) ? i + l : end - 1;
+                g[l / 8][l % 8] = (uint32_t)((idx << 1) | 1) << shift;
+            }
+
+            // shortest difference first, nearly every poly fails right here
+            divide(g, &a->diffs[0], reg);
+
+            for (int l = 0; l < CRCS_SWEEP_LANES && i + l < end; l++) {
+                if (reg[l / 8][l % 8]) {
+                    continue;
+                }
+                const uint32_t gl = g[l / 8][l % 8];
+                int j = 1;
+                while (j < a->ndiffs && crcs_divides(gl, &a->diffs[j])) {
+                    j++;
+                }
+                if (j == a->ndiffs && crcs_sweep_add(a, gl >> shift) == false) {
+                    // the result is incomplete anyway, stop the other threads too
+                    a->failed = true;
+                    __atomic_store_n(a->next, a->total, __ATOMIC_SEQ_CST);
+                    return NULL;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+static int crcs_cmp_diff(const void *a, const void *b) {
+    const crcs_diff_t *x = a, *y = b;
+    return (x->nbits > y->nbits) - (x->nbits < y->nbits);
+}
+
+static int crcs_cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Sums every pair of equal length codewords and strips the leading zeroes,
+// like reveng's modpol() does without a known init.
+static int crcs_make_diffs(const crcs_bitstr_t *cw, int count, crcs_diff_t **out) {
+    int n = 0;
+    crcs_diff_t *diffs = calloc(((count * (count - 1)) / 2) + 1, sizeof(crcs_diff_t));
+    if (diffs == NULL) {
+        return -1;
+    }
+
+    for (int a = 0; a < count; a++) {
+        for (int b = a + 1; b < count; b++) {
+            if (cw[a].nbits != cw[b].nbits) {
+                continue;
+            }
+
+            size_t len = cw[a].nbits, first = len;
+            for (size_t p = 0; p < len; p++) {
+                if (((cw[a].bits[p >> 3] ^ cw[b].bits[p >> 3]) >> (7 - (p & 7))) & 1) {
+                    first = p;
+                    break;
+                }
+            }
+            if (first == len) {
+                continue;
+            }
+
+            uint32_t *mask = calloc(len - first, sizeof(uint32_t));
+            if (mask == NULL) {
+                for (int i = 0; i < n; i++) {
+                    free(diffs[i].mask);
+                }
+                free(diffs);
+                return -1;
+            }
+            for (size_t p = first; p < len; p++) {
+                if (((cw[a].bits[p >> 3] ^ cw[b].bits[p >> 3]) >> (7 - (p & 7))) & 1) {
+                    mask[p - first] = UINT32_MAX;
+                }
+            }
+            diffs[n].mask = mask;
+            diffs[n].nbits = len - first;
+            n++;
+        }
+    }
+
+    qsort(diffs, n, sizeof(crcs_diff_t), crcs_cmp_diff);
+    *out = diffs;
+    return n;
+}
+
+int crcs_sweep(uint8_t width, const crcs_bitstr_t *cw, int count, int threads,
+               uint64_t **polys, size_t *npolys) {
+
+    *polys = NULL;
+    *npolys = 0;
+
+    if (width == 0 || width > CRCS_SWEEP_MAX_WIDTH || count < 2) {
+        return PM3_EINVARG;
+    }
+
+    crcs_diff_t *diffs = NULL;
+    int ndiffs = crcs_make_diffs(cw, count, &diffs);
+    if (ndiffs < 0) {
+        return PM3_EMALLOC;
+    }
+    if (ndiffs == 0) {
+        free(diffs);
+        return PM3_EINVARG;
+    }
+
+    if (threads <= 0) {
+        threads = num_CPUs();
+    }
+
+    uint64_t next = 0;
+    crcs_sweep_arg_t args[threads];
+    pthread_t th[threads];
+    memset(args, 0, sizeof(args));
+
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        args[i].width = width;
+        args[i].diffs = diffs;
+        args[i].ndiffs = ndiffs;
+        args[i].total = 1ULL << (width - 1);
+        args[i].next = &next;
+        if (pthread_create(&th[i], NULL, crcs_sweep_thread, &args[i])) {
+            break;
+        }
+        started++;
+    }
+
+    // no thread at all, do the work here
+    if (started == 0) {
+        crcs_sweep_thread(&args[0]);
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(th[i], NULL);
+    }
+
+    int res = PM3_SUCCESS;
+    for (int i = 0; i < threads; i++) {
+        total += args[i].nfound;
+        if (args[i].failed) {
+            res = PM3_EMALLOC;
+        }
+    }
+
+    uint64_t *out = NULL;
+    if (total && res == PM3_SUCCESS) {
+        out = calloc(total, sizeof(uint64_t));
+        if (out == NULL) {
+            res = PM3_EMALLOC;
+        }
+    }
+
+    size_t n = 0;
+    for (int i = 0; i < threads; i++) {
+        if (out != NULL) {
+            memcpy(out + n, args[i].found, args[i].nfound * sizeof(uint64_t));
+            n += args[i].nfound;
+        }
+        free(args[i].found);
+    }
+
+    for (int i = 0; i < ndiffs; i++) {
+        free(diffs[i].mask);
+    }
+    free(diffs);
+
+    if (out != NULL) {
+        qsort(out, n, sizeof(uint64_t), crcs_cmp_u64);
+        *polys = out;
+        *npolys = n;
+    }
+    return res;
+}
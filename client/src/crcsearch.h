@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Table driven CRC model search engine used by reveng -g / -s and
+// analyse crcsearch.
+//
+// All bit strings are MSB first, in the same order reveng keeps its poly_t
+// bitmaps. Reflected models are handled by the caller, by handing in bit
+// strings whose bytes are already reflected.
+//-----------------------------------------------------------------------------
+
+#ifndef CRCSEARCH_H__
+#define CRCSEARCH_H__
+
+#include "common.h"
+
+#define CRCS_MAX_WIDTH          64
+#define CRCS_SWEEP_MAX_WIDTH    32
+
+typedef struct {
+    uint8_t width;
+    uint64_t poly;              // normal form, x^width term implied
+    uint64_t init;              // register before the first bit
+    uint64_t xorout;            // added to the register after the last bit
+    uint64_t table[256];        // register kept MSB aligned in 64 bits
+} crcs_kernel_t;
+
+typedef struct {
+    const uint8_t *bits;
+    size_t nbits;
+} crcs_bitstr_t;
+
+// Builds the byte table of a model. width 1..64
+void crcs_kernel_init(crcs_kernel_t *k, uint8_t width, uint64_t poly, uint64_t init, uint64_t xorout);
+
+// CRC register, xorout applied, of the first nbits of bits.
+uint64_t crcs_kernel_run(const crcs_kernel_t *k, const uint8_t *bits, size_t nbits);
+
+// True if the last width bits of the codeword are the CRC of the bits before.
+bool crcs_codeword_ok(const crcs_kernel_t *k, const crcs_bitstr_t *cw);
+
+// Reads n <= 64 bits starting at bit offset start, MSB first.
+uint64_t crcs_get_bits(const uint8_t *bits, size_t start, uint8_t n);
+
+// Exhaustive search over all odd polynomials of the given width (1..32) that
+// divide the difference of every pair of equal length codewords. Candidates
+// are returned sorted ascending in a malloc()ed array, init and xorout still
+// need solving by the caller. threads <= 0 uses all CPUs.
+// Returns PM3_SUCCESS, PM3_EINVARG when no equal length pair exists,
+// PM3_EMALLOC without candidates when memory ran out.
+int crcs_sweep(uint8_t width, const crcs_bitstr_t *cw, int count, int threads,
+               uint64_t **polys, size_t *npolys);
+
+#endif
@@ -33,6 +33,7 @@
 #include "util.h"
 #include "proxmark3.h"
 #include "fileutils.h"
+#include "rescache.h"
 #include "pm3_cmd.h"
 
 enum asn1_tag_t {
@@ -286,20 +287,11 @@ cleanup:
 }
 
 static char *asn1_oid_description(const char *oid, bool with_group_desc) {
-    json_error_t error;
-    json_t *root = NULL;
     static char res[300];
     memset(res, 0x00, sizeof(res));
 
-    char *path;
-    if (searchFile(&path, RESOURCES_SUBDIR, "oids", ".json", false) != PM3_SUCCESS) {
-        return NULL;
-    }
-
-    // load `oids.json`
-    root = json_load_file(path, 0, &error);
-    free(path);
-
+    // `oids.json`, parsed once per session
+    json_t *root = rescache_json_load("oids", ".json", false);
     if (!root || !json_is_object(root)) {
         goto error;
     }
@@ -28,6 +28,7 @@
 #include <mbedtls/bignum.h>
 
 #include "crypto/libpcrypto.h"      // sha1hash, sha256hash, des_encrypt/decrypt, pcrypto_rng_*
+#include "commonutil.h"             // ARRAYLEN
 #include "ui.h"                     // PrintAndLogEx
 #include "util.h"                   // sprint_hex_inrow
 #include "commonutil.h"             // ARRAYLEN
@@ -465,6 +466,97 @@ size_t emrtd_tlv_write_header(uint8_t *out, size_t outlen, uint32_t tag, size_t
     return o;
 }
 
+//-----------------------------------------------------------------------------
+// EF.ATR/INFO and READ BINARY sizing
+//-----------------------------------------------------------------------------
+
+static size_t emrtd_be_value(const uint8_t *val, size_t vlen) {
+    size_t v = 0;
+    for (size_t i = 0; i < vlen; i++) {
+        v = (v << 8) | val[i];
+    }
+    return v;
+}
+
+int emrtd_parse_atrinfo(const uint8_t *data, size_t datalen, emrtd_atrinfo_t *out) {
+    if ((data == NULL) || (out == NULL)) {
+        return PM3_EINVARG;
+    }
+    memset(out, 0, sizeof(emrtd_atrinfo_t));
+
+    const uint8_t *cur = data;
+    const uint8_t *end = data + datalen;
+    uint32_t tag = 0;
+    const uint8_t *val = NULL;
+    size_t vlen = 0;
+
+    while (cur < end) {
+        // some chips pad the file
+        if ((*cur == 0x00) || (*cur == 0xFF)) {
+            cur++;
+            continue;
+        }
+        if (emrtd_tlv_next(&cur, end, &tag, &val, &vlen) == false) {
+            return PM3_ESOFT;
+        }
+
+        // third software function table, b7: extended Lc and Le fields
+        if ((tag == 0x47) && (vlen >= 3) && (val[2] & 0x40)) {
+            out->extended = true;
+        }
+
+        // 02 <max command> 02 <max response>
+        if (tag == 0x7F66) {
+            const uint8_t *icur = val;
+            const uint8_t *iend = val + vlen;
+            const uint8_t *ival = NULL;
+            size_t ivlen = 0;
+            size_t lens[2] = { 0 };
+            size_t n = 0;
+            while ((icur < iend) && (n < ARRAYLEN(lens))) {
+                if (emrtd_tlv_next(&icur, iend, &tag, &ival, &ivlen) == false) {
+                    return PM3_ESOFT;
+                }
+                if ((tag == 0x02) && (ivlen > 0) && (ivlen <= 3)) {
+                    lens[n++] = emrtd_be_value(ival, ivlen);
+                }
+            }
+            if (n == ARRAYLEN(lens)) {
+                out->max_cmd = lens[0];
+                out->max_resp = lens[1];
+                out->extended = true;
+            }
+        }
+    }
+    return PM3_SUCCESS;
+}
+
+static size_t emrtd_der_lenlen(size_t len) {
+    return (len < 0x80) ? 1 : (len < 0x100) ? 2 : 3;
+}
+
+size_t emrtd_sm_read_resplen(const emrtd_session_t *ssn, size_t plainlen) {
+    // DO'87' (01 || cryptogram), DO'99' (4 bytes) and DO'8E' (10 bytes). The
+    // cryptogram is padded to a whole block with at least one byte of padding
+    size_t bs = emrtd_sm_blocksize(ssn);
+    size_t crypto = (plainlen / bs + 1) * bs;
+    return 1 + emrtd_der_lenlen(crypto + 1) + crypto + 1 + 4 + 10;
+}
+
+size_t emrtd_read_chunk(const emrtd_session_t *ssn, size_t maxresp) {
+    if (ssn->type == EMRTD_SM_NONE) {
+        return maxresp;
+    }
+
+    size_t bs = emrtd_sm_blocksize(ssn);
+    for (size_t crypto = (maxresp / bs) * bs; crypto >= bs; crypto -= bs) {
+        if (emrtd_sm_read_resplen(ssn, crypto - 1) <= maxresp) {
+            return crypto - 1;
+        }
+    }
+    return 0;
+}
+
 //-----------------------------------------------------------------------------
 // EF_CardAccess
 //-----------------------------------------------------------------------------
@@ -173,6 +173,28 @@ bool emrtd_tlv_next(const uint8_t **cur, const uint8_t *end, uint32_t *tag, cons
 // Writes tag (1 or 2 bytes, big endian) + length, returns bytes written, 0 on overflow
 size_t emrtd_tlv_write_header(uint8_t *out, size_t outlen, uint32_t tag, size_t len);
 
+//-----------------------------------------------------------------------------
+// EF.ATR/INFO and READ BINARY sizing
+//-----------------------------------------------------------------------------
+// Frame size the reader asks for, FSDI 8 in both RATS and ATTRIB
+#define EMRTD_FSD               256
+// Upper bound of one extended length READ BINARY, whatever the chip allows
+#define EMRTD_EXT_MAX_LE        4096
+
+typedef struct {
+    bool extended;          // extended Lc / Le supported
+    size_t max_cmd;         // from DO'7F66', 0 when not given
+    size_t max_resp;
+} emrtd_atrinfo_t;
+
+// ISO 7816-4 12.7.1: card capabilities DO'47' and extended length DO'7F66'
+int emrtd_parse_atrinfo(const uint8_t *data, size_t datalen, emrtd_atrinfo_t *out);
+// Largest plain chunk one READ BINARY may ask for when the response data,
+// secure messaging included, must not exceed maxresp bytes
+size_t emrtd_read_chunk(const emrtd_session_t *ssn, size_t maxresp);
+// Size of the protected response to a READ BINARY of plainlen bytes
+size_t emrtd_sm_read_resplen(const emrtd_session_t *ssn, size_t plainlen);
+
 //-----------------------------------------------------------------------------
 // EF_CardAccess
 //-----------------------------------------------------------------------------
@@ -654,6 +654,39 @@ static bool test_tlv(void) {
     return res;
 }
 
+static bool test_readsize(void) {
+    uint8_t atrinfo[32] = { 0x00 };
+    size_t atrinfolen = unhex("4301B8470300C0407F66080202040002020F00", atrinfo, sizeof(atrinfo));
+
+    emrtd_atrinfo_t ai;
+    bool res = (emrtd_parse_atrinfo(atrinfo, atrinfolen, &ai) == PM3_SUCCESS);
+    res = res && ai.extended && (ai.max_cmd == 0x400) && (ai.max_resp == 0xF00);
+
+    // capabilities without extended length
+    atrinfolen = unhex("4703008000", atrinfo, sizeof(atrinfo));
+    res = res && (emrtd_parse_atrinfo(atrinfo, atrinfolen, &ai) == PM3_SUCCESS);
+    res = res && (ai.extended == false) && (ai.max_resp == 0);
+
+    // truncated DO
+    atrinfolen = unhex("7F660802020400", atrinfo, sizeof(atrinfo));
+    res = res && (emrtd_parse_atrinfo(atrinfo, atrinfolen, &ai) != PM3_SUCCESS);
+
+    // response data of one FSD frame: 256 - PCB - CRC - SW
+    emrtd_session_t ssn;
+    emrtd_sm_clear(&ssn);
+    res = res && (emrtd_read_chunk(&ssn, 251) == 251);
+    ssn.type = EMRTD_SM_3DES;
+    res = res && (emrtd_read_chunk(&ssn, 251) == 231);
+    res = res && (emrtd_read_chunk(&ssn, 4096) == 4071);
+    ssn.type = EMRTD_SM_AES;
+    res = res && (emrtd_read_chunk(&ssn, 251) == 223);
+    res = res && (emrtd_read_chunk(&ssn, 4096) == 4063);
+    res = res && (emrtd_read_chunk(&ssn, 20) == 0);
+
+    PrintAndLogEx(SUCCESS, "Read sizing...... ( %s )", (res) ? _GREEN_("ok") : _RED_("fail"));
+    return res;
+}
+
 bool emrtd_test(bool verbose) {
     (void)verbose;
     bool res = true;
@@ -674,6 +707,7 @@ bool emrtd_test(bool verbose) {
     res = test_ssc() && res;
     res = test_sm_3des() && res;
     res = test_sm_aes() && res;
+    res = test_readsize() && res;
 
     PrintAndLogEx(INFO, "---------------------------");
     PrintAndLogEx(SUCCESS, "Tests ( %s )", (res) ? _GREEN_("ok") : _RED_("fail"));
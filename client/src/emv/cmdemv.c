@@ -27,6 +27,7 @@
 #include "cmdparser.h"
 #include "proxmark3.h"
 #include "emv_roca.h"
+#include "emv_oda.h"
 #include "emvcore.h"
 #include "cmdhf14a.h"
 #include "dol.h"
@@ -38,6 +39,7 @@
 #include <mbedtls/des.h>    // DES
 #include "crypto/libpcrypto.h"
 #include "iso4217.h"        // currency lookup
+#include "util_posix.h"     // msclock
 
 static int CmdHelp(const char *Cmd);
 
@@ -2312,6 +2314,8 @@ static int CmdEMVScan(const char *Cmd) {
         return PM3_ESOFT;
     }
     PrintAndLogEx(INFO, "PDOL data[%zu]: %s", pdol_data_tlv_data_len, sprint_hex(pdol_data_tlv_data, pdol_data_tlv_data_len));
+    // terminal data a fDDA signature covers, `emv oda` needs it
+    JsonSaveBufAsHex(root, "$.Application.PDOLData", (uint8_t *)pdol_data_tlv->value, pdol_data_tlv->len);
 
     PrintAndLogEx(INFO, "GPO");
     res = EMVGPO(channel, true, pdol_data_tlv_data, pdol_data_tlv_data_len, buf, sizeof(buf), &len, &sw, tlvRoot);
@@ -2497,6 +2501,249 @@ static int CmdEMVTest(const char *Cmd) {
     return ExecuteCryptoTests(true, ignoreTimeTest, runSlowTests);
 }
 
+#define ODA_MAX_FILES   8192
+#define ODA_PATH_LEN    256
+
+// `*` and `?` in a file name pattern
+static bool oda_name_match(const char *pat, const char *name) {
+    if (*pat == '*') {
+        for (;;) {
+            if (oda_name_match(pat + 1, name)) {
+                return true;
+            }
+            if (*name == '\0') {
+                return false;
+            }
+            name++;
+        }
+    }
+    if (*pat == '\0') {
+        return (*name == '\0');
+    }
+    if (*name == '\0' || (*pat != '?' && *pat != *name)) {
+        return false;
+    }
+    return oda_name_match(pat + 1, name + 1);
+}
+
+static int oda_path_cmp(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+// appends the files of a plain file, a directory (its .json files, recursively)
+// or a pattern matching file names in one directory to paths
+static int oda_collect_path(const char *arg, char *paths, size_t *count) {
+    const char *sep = strrchr(arg, '/');
+    const char *bsep = strrchr(arg, '\\');
+    if (bsep && (sep == NULL || bsep > sep)) {
+        sep = bsep;
+    }
+    const char *pattern = (sep) ? sep + 1 : arg;
+    bool wildcard = (strpbrk(pattern, "*?") != NULL);
+    bool dir = (wildcard == false) && path_is_directory(arg);
+
+    if (wildcard == false && dir == false) {
+        if (*count >= ODA_MAX_FILES) {
+            return PM3_EOVFLOW;
+        }
+        if (strlen(arg) >= ODA_PATH_LEN) {
+            PrintAndLogEx(WARNING, "path too long " _YELLOW_("%s"), arg);
+            return PM3_EINVARG;
+        }
+        snprintf(paths + (*count)++ * ODA_PATH_LEN, ODA_PATH_LEN, "%s", arg);
+        return PM3_SUCCESS;
+    }
+
+    char dirpath[ODA_PATH_LEN] = ".";
+    if (dir) {
+        snprintf(dirpath, sizeof(dirpath), "%s", arg);
+    } else if (sep) {
+        snprintf(dirpath, sizeof(dirpath), "%.*s", (int)(sep - arg + 1), arg);
+    }
+
+    size_t start = *count;
+    int res = collect_file_paths_recursive(dirpath, paths, ODA_PATH_LEN, ODA_MAX_FILES, count, false, dir ? 8 : 0);
+    if (res != PM3_SUCCESS && res != PM3_EOVFLOW) {
+        PrintAndLogEx(WARNING, "could not read directory " _YELLOW_("%s"), dirpath);
+        return res;
+    }
+
+    // keep the card files only
+    size_t kept = start;
+    for (size_t i = start; i < *count; i++) {
+        const char *fn = paths + i * ODA_PATH_LEN;
+        bool keep = (dir) ? str_endswith(fn, ".json") : oda_name_match(pattern, path_basename(fn));
+        if (keep && kept != i) {
+            memcpy(paths + kept * ODA_PATH_LEN, fn, ODA_PATH_LEN);
+        }
+        kept += (keep) ? 1 : 0;
+    }
+    *count = kept;
+    qsort(paths + start * ODA_PATH_LEN, kept - start, ODA_PATH_LEN, oda_path_cmp);
+
+    if (kept == start) {
+        PrintAndLogEx(WARNING, "no file matches " _YELLOW_("%s"), arg);
+    }
+    return res;
+}
+
+static int CmdEMVOda(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "emv oda",
+                  "Offline data authentication of card data saved by `emv scan`.\n"
+                  "Files are checked in parallel. CA keys and recovered issuer keys are cached,\n"
+                  "cards of the same issuer recover the issuer key once.\n"
+                  "A fDDA signature is only checked in files holding the GPO terminal data.\n"
+                  "A path is a file, a directory whose .json files are read recursively, or a\n"
+                  "file name pattern with * and ?. Cards whose keys are recovered without any\n"
+                  "signature to check are reported as unverified.",
+                  "emv oda -f card1.json\n"
+                  "emv oda -f card1.json -f card2.json -f card3.json --threads 2 -v\n"
+                  "emv oda -f scans/                    -> every .json below scans\n"
+                  "emv oda -f \"scans/visa_*.json\""
+                 );
+
+    void *argtable[] = {
+        arg_param_begin,
+        arg_strn("f",  "file",    "<fn>", 1, 64, "JSON file saved by `emv scan`, directory or pattern"),
+        arg_int0(NULL, "threads", "<dec>", "number of threads (def: number of CPUs)"),
+        arg_lit0("v",  "verbose", "Show why a file failed"),
+        arg_param_end
+    };
+    CLIExecWithReturn(ctx, Cmd, argtable, false);
+
+    struct arg_str *files_arg = arg_get_str(ctx, 1);
+    int threads = arg_get_int_def(ctx, 2, 0);
+    bool verbose = arg_get_lit(ctx, 3);
+
+    if (threads < 0) {
+        PrintAndLogEx(ERR, "Number of threads must be positive");
+        CLIParserFree(ctx);
+        return PM3_EINVARG;
+    }
+
+    char *paths = calloc(ODA_MAX_FILES, ODA_PATH_LEN);
+    if (paths == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        CLIParserFree(ctx);
+        return PM3_EMALLOC;
+    }
+
+    size_t count = 0;
+    for (int i = 0; i < files_arg->count; i++) {
+        int res = oda_collect_path(files_arg->sval[i], paths, &count);
+        if (res == PM3_EOVFLOW) {
+            PrintAndLogEx(WARNING, "only the first %u files are checked", ODA_MAX_FILES);
+            break;
+        }
+        if (res != PM3_SUCCESS) {
+            free(paths);
+            CLIParserFree(ctx);
+            return res;
+        }
+    }
+    CLIParserFree(ctx);
+
+    if (count == 0) {
+        PrintAndLogEx(FAILED, "No file to check");
+        free(paths);
+        return PM3_EINVARG;
+    }
+
+    const char **files = calloc(count, sizeof(char *));
+    emv_oda_result_t *results = calloc(count, sizeof(emv_oda_result_t));
+    emv_oda_cache_t *cache = emv_oda_cache_new();
+    if (files == NULL || results == NULL || cache == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        free(files);
+        free(results);
+        emv_oda_cache_free(cache);
+        free(paths);
+        return PM3_EMALLOC;
+    }
+    for (size_t i = 0; i < count; i++) {
+        files[i] = paths + i * ODA_PATH_LEN;
+    }
+
+    uint64_t t0 = msclock();
+    emv_oda_verify_files(cache, files, count, threads, results);
+    uint64_t wall = msclock() - t0;
+
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx(INFO, "--- " _CYAN_("Offline data authentication") " ---------------------------");
+    PrintAndLogEx(INFO, "  # | RID       IDX | method | issuer | result");
+    PrintAndLogEx(INFO, "----+---------------+--------+--------+--------------------------");
+
+    size_t ok = 0, failed = 0, unverified = 0;
+    uint64_t stage_us[ODA_STAGES] = {0};
+    for (size_t i = 0; i < count; i++) {
+        emv_oda_result_t *r = &results[i];
+        for (int s = 0; s < ODA_STAGES; s++) {
+            stage_us[s] += r->stage_us[s];
+        }
+
+        const char *result = _YELLOW_("no data");
+        if (r->status == ODA_OK) {
+            result = _GREEN_("ok");
+            ok++;
+        } else if (r->status == ODA_FAIL) {
+            result = _RED_("fail");
+            failed++;
+        } else if (r->status == ODA_UNVERIFIED) {
+            result = _YELLOW_("unverified");
+            unverified++;
+        }
+
+        PrintAndLogEx(INFO, "%3zu | %s %02X | %-6s | %-6s | %s %s",
+                      i + 1,
+                      sprint_hex_inrow(r->rid, sizeof(r->rid)),
+                      r->index,
+                      emv_oda_method_name(r->method),
+                      r->issuer_cached ? "cached" : (r->stage >= ODA_STAGE_ISSUER ? "RSA" : ""),
+                      result,
+                      files[i]
+                     );
+        if (r->reason && (verbose || r->status == ODA_FAIL || r->status == ODA_UNVERIFIED)) {
+            PrintAndLogEx(INFO, "    | %s: %s", emv_oda_stage_name(r->stage), r->reason);
+        }
+    }
+
+    uint64_t total_us = 0;
+    for (int s = 0; s < ODA_STAGES; s++) {
+        total_us += stage_us[s];
+    }
+
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx(INFO, "--- " _CYAN_("Stage timing") " (all files) -----------------------");
+    for (int s = 0; s < ODA_STAGES; s++) {
+        PrintAndLogEx(INFO, "  %-7s %10.3f ms  %5.1f%%",
+                      emv_oda_stage_name(s),
+                      stage_us[s] / 1000.0,
+                      total_us ? stage_us[s] * 100.0 / total_us : 0.0
+                     );
+    }
+
+    size_t ca_keys = 0, issuer_keys = 0, issuer_hits = 0;
+    emv_oda_cache_stats(cache, &ca_keys, &issuer_keys, &issuer_hits);
+    PrintAndLogEx(INFO, "CA keys " _YELLOW_("%zu") ", issuer keys " _YELLOW_("%zu") ", issuer cache hits " _YELLOW_("%zu"),
+                  ca_keys, issuer_keys, issuer_hits);
+    PrintAndLogEx(INFO, "%zu file(s) in " _YELLOW_("%" PRIu64) " ms", count, wall);
+
+    if (failed) {
+        PrintAndLogEx(FAILED, "ODA ( " _GREEN_("%zu") " ok, " _RED_("%zu") " failed, " _YELLOW_("%zu") " unverified )", ok, failed, unverified);
+    } else if (unverified) {
+        PrintAndLogEx(WARNING, "ODA ( " _GREEN_("%zu") " ok, " _YELLOW_("%zu") " unverified )", ok, unverified);
+    } else {
+        PrintAndLogEx(SUCCESS, "ODA ( %s ) %zu verified", _GREEN_("ok"), ok);
+    }
+
+    emv_oda_cache_free(cache);
+    free(results);
+    free(files);
+    free(paths);
+    return failed ? PM3_ESOFT : PM3_SUCCESS;
+}
+
 static int CmdEMVRoca(const char *Cmd) {
     CLIParserContext *ctx;
     CLIParserInit(&ctx, "emv roca",
@@ -2981,6 +3228,7 @@ static command_t CommandTable[] =  {
     {"-----------", CmdHelp,                        AlwaysAvailable, "----------------------- " _CYAN_("General") " -----------------------"},
     {"help",        CmdHelp,                        AlwaysAvailable, "This help"},
     {"list",        CmdEMVList,                     AlwaysAvailable, "List ISO7816 history"},
+    {"oda",         CmdEMVOda,                      AlwaysAvailable, "Offline data authentication of emv scan files"},
     {"test",        CmdEMVTest,                     AlwaysAvailable, "Perform crypto logic self tests"},
     {"-----------", CmdHelp,                        IfPm3Iso14443a,  "---------------------- " _CYAN_("Operations") " ---------------------"},
     {"challenge",   CmdEMVGenerateChallenge,        IfPm3Iso14443,   "Generate challenge"},
@@ -0,0 +1,696 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Batch offline data authentication of recorded EMV transactions
+//-----------------------------------------------------------------------------
+
+#include "emv_oda.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "commonutil.h"
+#include "util.h"               // hex_to_bytes, num_CPUs
+#include "util_posix.h"         // usclock
+#include "ui.h"
+#include "jansson_path.h"
+#include "crypto.h"
+#include "dol.h"
+#include "emv_pk.h"
+#include "emv_pki.h"
+#include "emvjson.h"
+
+#define ODA_MAX_DATA     4096
+#define ODA_MAX_THREADS  64
+
+typedef struct {
+    uint8_t rid[5];
+    uint8_t index;
+    struct emv_pk *pk;          // NULL when capk.txt does not know the key
+} oda_ca_key_t;
+
+typedef struct {
+    uint8_t rid[5];
+    uint8_t index;
+    uint8_t hash[20];           // certificate, remainder and exponent
+    struct emv_pk *pk;
+} oda_issuer_key_t;
+
+// keys are only added while the cache lives, a key handed out stays valid
+struct emv_oda_cache_s {
+    pthread_mutex_t lock;
+    oda_ca_key_t *ca;
+    size_t ca_count;
+    oda_issuer_key_t *issuer;
+    size_t issuer_count;
+    size_t issuer_hits;
+};
+
+static const char *oda_stage_names[ODA_STAGES] = { "load", "CA key", "issuer", "ICC", "verify" };
+static const char *oda_method_names[] = { "none", "keys", "SDA", "fDDA" };
+
+const char *emv_oda_stage_name(emv_oda_stage_t stage) {
+    return (stage < ODA_STAGES) ? oda_stage_names[stage] : "?";
+}
+
+const char *emv_oda_method_name(emv_oda_method_t method) {
+    return (method < ARRAYLEN(oda_method_names)) ? oda_method_names[method] : "?";
+}
+
+emv_oda_cache_t *emv_oda_cache_new(void) {
+    emv_oda_cache_t *cache = calloc(1, sizeof(emv_oda_cache_t));
+    if (cache == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+void emv_oda_cache_free(emv_oda_cache_t *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < cache->ca_count; i++) {
+        emv_pk_free(cache->ca[i].pk);
+    }
+    for (size_t i = 0; i < cache->issuer_count; i++) {
+        emv_pk_free(cache->issuer[i].pk);
+    }
+    free(cache->ca);
+    free(cache->issuer);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+void emv_oda_cache_stats(emv_oda_cache_t *cache, size_t *ca_keys, size_t *issuer_keys, size_t *issuer_hits) {
+    pthread_mutex_lock(&cache->lock);
+    if (ca_keys) {
+        *ca_keys = cache->ca_count;
+    }
+    if (issuer_keys) {
+        *issuer_keys = cache->issuer_count;
+    }
+    if (issuer_hits) {
+        *issuer_hits = cache->issuer_hits;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+//-----------------------------------------------------------------------------
+// `emv scan` files back to TLV
+//-----------------------------------------------------------------------------
+
+static const char *oda_str(json_t *elm) {
+    const char *s = json_string_value(elm);
+    return s ? s : "";
+}
+
+static bool oda_put_len(uint8_t *buf, size_t max, size_t *pos, size_t hdr, size_t vlen) {
+    uint8_t lb[3];
+    size_t ll;
+    if (vlen < 0x80) {
+        lb[0] = vlen;
+        ll = 1;
+    } else if (vlen < 0x100) {
+        lb[0] = 0x81;
+        lb[1] = vlen;
+        ll = 2;
+    } else if (vlen < 0x10000) {
+        lb[0] = 0x82;
+        lb[1] = vlen >> 8;
+        lb[2] = vlen;
+        ll = 3;
+    } else {
+        return false;
+    }
+
+    // the value was written after room for the longest length field
+    memmove(buf + hdr + ll, buf + hdr + 3, vlen);
+    memcpy(buf + hdr, lb, ll);
+    *pos = hdr + ll + vlen;
+    return *pos <= max;
+}
+
+static bool oda_put_hex(const char *hex, uint8_t *buf, size_t max, size_t *pos) {
+    if (hex == NULL) {
+        return false;
+    }
+    if (*pos >= max) {
+        return hex[0] == '\0';
+    }
+    int n = hex_to_bytes(hex, buf + *pos, max - *pos);
+    if (n < 0) {
+        return false;
+    }
+    *pos += n;
+    return true;
+}
+
+// one element as JsonSaveTLVTree() wrote it: {tag, value}, {tag, Childs}
+// or a link {appdata} to a value kept in $.ApplicationData
+static bool oda_encode_elm(json_t *appdata, json_t *elm, uint8_t *buf, size_t max, size_t *pos) {
+    if (json_is_object(elm) == false || *pos + 7 > max) {
+        return false;
+    }
+
+    const char *name = json_string_value(json_object_get(elm, "appdata"));
+    const char *value = NULL;
+    if (name) {
+        tlv_tag_t tag = GetApplicationDataTag(name);
+        if (tag == 0) {
+            return false;
+        }
+        bool started = false;
+        for (int sh = 24; sh >= 0; sh -= 8) {
+            if (started || (tag >> sh) & 0xff) {
+                buf[(*pos)++] = (tag >> sh) & 0xff;
+                started = true;
+            }
+        }
+        value = json_string_value(json_object_get(appdata, name));
+        if (value == NULL) {
+            return false;
+        }
+    } else {
+        int n = hex_to_bytes(oda_str(json_object_get(elm, "tag")), buf + *pos, 4);
+        if (n < 1) {
+            return false;
+        }
+        *pos += n;
+        value = json_string_value(json_object_get(elm, "value"));
+    }
+
+    size_t hdr = *pos;
+    *pos += 3;
+
+    json_t *childs = json_object_get(elm, "Childs");
+    if (json_is_array(childs)) {
+        for (size_t i = 0; i < json_array_size(childs); i++) {
+            if (oda_encode_elm(appdata, json_array_get(childs, i), buf, max, pos) == false) {
+                return false;
+            }
+        }
+    } else if (oda_put_hex(value ? value : "", buf, max, pos) == false) {
+        return false;
+    }
+
+    return oda_put_len(buf, max, pos, hdr, *pos - hdr - 3);
+}
+
+static bool oda_encode_tree(json_t *appdata, json_t *tree, uint8_t *buf, size_t max, size_t *len) {
+    *len = 0;
+    if (json_is_object(tree)) {
+        return oda_encode_elm(appdata, tree, buf, max, len);
+    }
+    if (json_is_array(tree) == false) {
+        return false;
+    }
+    for (size_t i = 0; i < json_array_size(tree); i++) {
+        if (oda_encode_elm(appdata, json_array_get(tree, i), buf, max, len) == false) {
+            return false;
+        }
+    }
+    return *len > 0;
+}
+
+static int oda_json_byte(json_t *elm, const char *name) {
+    uint8_t b = 0;
+    const char *hex = json_string_value(json_object_get(elm, name));
+    if (hex == NULL || hex_to_bytes(hex, &b, 1) != 1) {
+        return -1;
+    }
+    return b;
+}
+
+// EMV 4.3 book 3, 10.3: the first `offline` records of every AFL entry
+static bool oda_record_offline(const uint8_t *afl, size_t afl_len, int sfi, int rec) {
+    for (size_t i = 0; i + 4 <= afl_len; i += 4) {
+        if ((afl[i] >> 3) == sfi && rec >= afl[i + 1] && rec <= afl[i + 2] && rec < afl[i + 1] + afl[i + 3]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void oda_add(struct tlvdb **tlv, struct tlvdb *elm) {
+    if (elm == NULL) {
+        return;
+    }
+    if (*tlv == NULL) {
+        *tlv = elm;
+    } else {
+        tlvdb_add(*tlv, elm);
+    }
+}
+
+struct tlvdb *emv_oda_load_json(json_t *root) {
+    uint8_t *buf = calloc(ODA_MAX_DATA, 1);
+    uint8_t *oda = calloc(ODA_MAX_DATA, 1);
+    if (buf == NULL || oda == NULL) {
+        free(buf);
+        free(oda);
+        return NULL;
+    }
+
+    json_t *appdata = json_path_get(root, "$.ApplicationData");
+    struct tlvdb *tlv = NULL;
+    size_t len = 0;
+    size_t oda_len = 0;
+
+    static const char *trees[] = { "$.Application.FCITemplate", "$.Application.GPO" };
+    for (size_t i = 0; i < ARRAYLEN(trees); i++) {
+        if (oda_encode_tree(appdata, json_path_get(root, trees[i]), buf, ODA_MAX_DATA, &len)) {
+            oda_add(&tlv, tlvdb_parse_multi(buf, len));
+        }
+    }
+
+    uint8_t afl[252] = {0};
+    int afl_len = hex_to_bytes(oda_str(json_object_get(appdata, "AFL")), afl, sizeof(afl));
+
+    json_t *records = json_path_get(root, "$.Application.Records");
+    for (size_t i = 0; i < json_array_size(records); i++) {
+        json_t *rec = json_array_get(records, i);
+        if (oda_encode_tree(appdata, json_object_get(rec, "Data"), buf, ODA_MAX_DATA, &len) == false) {
+            continue;
+        }
+        oda_add(&tlv, tlvdb_parse_multi(buf, len));
+
+        int sfi = oda_json_byte(rec, "SFI");
+        if (afl_len <= 0 || oda_record_offline(afl, afl_len, sfi, oda_json_byte(rec, "RecordNum")) == false) {
+            continue;
+        }
+
+        // the record template is left out for SFI 1 to 10
+        const unsigned char *data = buf;
+        size_t left = len;
+        if (sfi < 11) {
+            struct tlv e;
+            if (tlv_parse_tl(&data, &left, &e) == false) {
+                continue;
+            }
+        }
+        if (oda_len + left <= ODA_MAX_DATA) {
+            memcpy(oda + oda_len, data, left);
+            oda_len += left;
+        }
+    }
+
+    // application data the trees above did not carry, e.g. after a format 1 GPO response
+    const char *key;
+    json_t *value;
+    json_object_foreach(appdata, key, value) {
+        tlv_tag_t tag = GetApplicationDataTag(key);
+        if (tag == 0 || tlvdb_get(tlv, tag, NULL)) {
+            continue;
+        }
+        int n = hex_to_bytes(oda_str(value), buf, ODA_MAX_DATA);
+        if (n > 0) {
+            oda_add(&tlv, tlvdb_fixed(tag, n, buf));
+        }
+    }
+
+    // input list for Offline Data Authentication, not a standard tag
+    if (oda_len) {
+        oda_add(&tlv, tlvdb_fixed(0x21, oda_len, oda));
+    }
+
+    // terminal data sent with GPO, signed by a fDDA card
+    const char *pdol_data = json_string_value(json_path_get(root, "$.Application.PDOLData"));
+    const struct tlv *pdol = tlvdb_get(tlv, 0x9f38, NULL);
+    if (pdol_data && pdol) {
+        int n = hex_to_bytes(pdol_data, buf, ODA_MAX_DATA);
+        if (n > 0) {
+            oda_add(&tlv, dol_parse(pdol, buf, n));
+        }
+    }
+
+    free(buf);
+    free(oda);
+    return tlv;
+}
+
+//-----------------------------------------------------------------------------
+// verification
+//-----------------------------------------------------------------------------
+
+static uint64_t oda_stage_end(emv_oda_result_t *res, emv_oda_stage_t stage, uint64_t t) {
+    uint64_t now = usclock();
+    res->stage_us[stage] += now - t;
+    res->stage = stage;
+    return now;
+}
+
+static void oda_fail(emv_oda_result_t *res, const char *reason) {
+    res->status = ODA_FAIL;
+    res->reason = reason;
+}
+
+static const struct emv_pk *oda_get_ca(emv_oda_cache_t *cache, const uint8_t *rid, uint8_t index) {
+    const struct emv_pk *pk = NULL;
+    pthread_mutex_lock(&cache->lock);
+
+    for (size_t i = 0; i < cache->ca_count; i++) {
+        if (memcmp(cache->ca[i].rid, rid, 5) == 0 && cache->ca[i].index == index) {
+            pk = cache->ca[i].pk;
+            goto out;
+        }
+    }
+
+    // unknown keys are kept too, capk.txt is not searched again for them
+    oda_ca_key_t *tmp = realloc(cache->ca, (cache->ca_count + 1) * sizeof(oda_ca_key_t));
+    if (tmp == NULL) {
+        goto out;
+    }
+    cache->ca = tmp;
+    oda_ca_key_t *e = &cache->ca[cache->ca_count++];
+    memcpy(e->rid, rid, 5);
+    e->index = index;
+    e->pk = emv_pk_get_ca_pk_ex(rid, index, false);
+    pk = e->pk;
+
+out:
+    pthread_mutex_unlock(&cache->lock);
+    return pk;
+}
+
+static bool oda_issuer_hash(const struct tlvdb *db, uint8_t *hash) {
+    struct crypto_hash *ch = crypto_hash_open(HASH_SHA_1);
+    if (ch == NULL) {
+        return false;
+    }
+
+    static const tlv_tag_t tags[] = { 0x90, 0x92, 0x9f32 };
+    for (size_t i = 0; i < ARRAYLEN(tags); i++) {
+        const struct tlv *t = tlvdb_get(db, tags[i], NULL);
+        uint8_t l[2] = { 0 };
+        if (t) {
+            l[0] = t->len >> 8;
+            l[1] = t->len;
+        }
+        crypto_hash_write(ch, l, sizeof(l));
+        if (t) {
+            crypto_hash_write(ch, t->value, t->len);
+        }
+    }
+
+    memcpy(hash, crypto_hash_read(ch), 20);
+    crypto_hash_close(ch);
+    return true;
+}
+
+static uint8_t oda_digit(const uint8_t *data, size_t len, size_t i) {
+    if (i / 2 >= len) {
+        return 0xf;
+    }
+    return (i % 2) ? data[i / 2] & 0x0f : data[i / 2] >> 4;
+}
+
+// a cached issuer key was checked against another card, its issuer
+// identifier must lead this PAN too
+static bool oda_pan_match(const struct emv_pk *pk, const struct tlv *pan) {
+    if (pan == NULL) {
+        return false;
+    }
+    size_t i;
+    for (i = 0; i < 8; i++) {
+        uint8_t d = oda_digit(pk->pan, 4, i);
+        if (d == 0xf) {
+            break;
+        }
+        if (oda_digit(pan->value, pan->len, i) != d) {
+            return false;
+        }
+    }
+    return i >= 4;
+}
+
+static const struct emv_pk *oda_find_issuer(emv_oda_cache_t *cache, const struct emv_pk *ca, const uint8_t *hash) {
+    for (size_t i = 0; i < cache->issuer_count; i++) {
+        oda_issuer_key_t *e = &cache->issuer[i];
+        if (e->index == ca->index && memcmp(e->rid, ca->rid, 5) == 0 && memcmp(e->hash, hash, 20) == 0) {
+            return e->pk;
+        }
+    }
+    return NULL;
+}
+
+static const struct emv_pk *oda_get_issuer(emv_oda_cache_t *cache, const struct emv_pk *ca, struct tlvdb *db, emv_oda_result_t *res) {
+    uint8_t hash[20];
+    if (oda_issuer_hash(db, hash) == false) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    const struct emv_pk *pk = oda_find_issuer(cache, ca, hash);
+    if (pk) {
+        cache->issuer_hits++;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    if (pk) {
+        res->issuer_cached = true;
+        return oda_pan_match(pk, tlvdb_get(db, 0x5a, NULL)) ? pk : NULL;
+    }
+
+    // the RSA runs unlocked, two threads may recover the same key once each
+    struct emv_pk *ipk = emv_pki_recover_issuer_cert(ca, db);
+    if (ipk == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    pk = oda_find_issuer(cache, ca, hash);
+    if (pk) {
+        emv_pk_free(ipk);
+    } else {
+        oda_issuer_key_t *tmp = realloc(cache->issuer, (cache->issuer_count + 1) * sizeof(oda_issuer_key_t));
+        if (tmp == NULL) {
+            emv_pk_free(ipk);
+        } else {
+            cache->issuer = tmp;
+            oda_issuer_key_t *e = &cache->issuer[cache->issuer_count++];
+            memcpy(e->rid, ca->rid, 5);
+            e->index = ca->index;
+            memcpy(e->hash, hash, 20);
+            e->pk = ipk;
+            pk = ipk;
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return pk;
+}
+
+static void oda_verify(emv_oda_cache_t *cache, struct tlvdb *tlv, emv_oda_result_t *res) {
+    uint64_t t = usclock();
+
+    const struct tlv *df = tlvdb_get(tlv, 0x84, NULL);
+    const struct tlv *caidx = tlvdb_get(tlv, 0x8f, NULL);
+    if (df == NULL || df->len < 6 || caidx == NULL || caidx->len < 1 || tlvdb_get(tlv, 0x90, NULL) == NULL) {
+        oda_stage_end(res, ODA_STAGE_CA, t);
+        res->status = ODA_NODATA;
+        res->reason = "no issuer certificate";
+        return;
+    }
+    memcpy(res->rid, df->value, 5);
+    res->index = caidx->value[0];
+
+    const struct emv_pk *ca = oda_get_ca(cache, res->rid, res->index);
+    t = oda_stage_end(res, ODA_STAGE_CA, t);
+    if (ca == NULL) {
+        oda_fail(res, "CA key not found");
+        return;
+    }
+
+    const struct emv_pk *issuer = oda_get_issuer(cache, ca, tlv, res);
+    t = oda_stage_end(res, ODA_STAGE_ISSUER, t);
+    if (issuer == NULL) {
+        oda_fail(res, "issuer certificate");
+        return;
+    }
+    res->method = ODA_KEYS;
+
+    const struct tlv *sda_tlv = tlvdb_get(tlv, 0x21, NULL);
+    struct emv_pk *icc_pk = NULL;
+    if (tlvdb_get(tlv, 0x9f46, NULL)) {
+        icc_pk = emv_pki_recover_icc_cert(issuer, tlv, sda_tlv);
+        t = oda_stage_end(res, ODA_STAGE_ICC, t);
+        if (icc_pk == NULL) {
+            oda_fail(res, "ICC certificate");
+            return;
+        }
+    }
+
+    if (icc_pk && tlvdb_get(tlv, 0x9f4b, NULL)) {
+        if (tlvdb_get(tlv, 0x9f37, NULL) == NULL) {
+            res->reason = "no terminal data for the GPO signature";
+        } else {
+            res->method = ODA_FDDA;
+            struct tlvdb *atc_db = emv_pki_recover_atc_ex(icc_pk, tlv, false);
+            const struct tlv *atc = tlvdb_get(atc_db, 0x9f36, NULL);
+            if (atc == NULL) {
+                oda_fail(res, "signed dynamic data");
+            } else if (tlv_equal(atc, tlvdb_get(tlv, 0x9f36, NULL)) == false) {
+                oda_fail(res, "ATC mismatch");
+            }
+            tlvdb_free(atc_db);
+        }
+    } else if (tlvdb_get(tlv, 0x93, NULL)) {
+        res->method = ODA_SDA;
+        struct tlvdb *dac_db = emv_pki_recover_dac(issuer, tlv, sda_tlv);
+        if (dac_db == NULL) {
+            oda_fail(res, "signed static data");
+        }
+        tlvdb_free(dac_db);
+    }
+
+    oda_stage_end(res, ODA_STAGE_VERIFY, t);
+    emv_pk_free(icc_pk);
+
+    // recovering the keys alone authenticates nothing
+    if (res->status == ODA_OK && res->method == ODA_KEYS) {
+        res->status = ODA_UNVERIFIED;
+        if (res->reason == NULL) {
+            res->reason = "no signed data";
+        }
+    }
+}
+
+void emv_oda_verify(emv_oda_cache_t *cache, struct tlvdb *tlv, emv_oda_result_t *res) {
+    memset(res, 0, sizeof(emv_oda_result_t));
+    oda_verify(cache, tlv, res);
+}
+
+void emv_oda_recover_keys(emv_oda_cache_t *cache, struct tlvdb *tlv, struct emv_pk **issuer, struct emv_pk **icc) {
+    *issuer = NULL;
+    *icc = NULL;
+
+    const struct tlv *df = tlvdb_get(tlv, 0x84, NULL);
+    const struct tlv *caidx = tlvdb_get(tlv, 0x8f, NULL);
+    if (df == NULL || df->len < 6 || caidx == NULL || caidx->len < 1 || tlvdb_get(tlv, 0x90, NULL) == NULL) {
+        return;
+    }
+
+    const struct emv_pk *ca = oda_get_ca(cache, df->value, caidx->value[0]);
+    if (ca == NULL) {
+        return;
+    }
+
+    emv_oda_result_t res = {0};
+    const struct emv_pk *ipk = oda_get_issuer(cache, ca, tlv, &res);
+    if (ipk == NULL) {
+        return;
+    }
+    *issuer = emv_pk_dup(ipk);
+
+    if (tlvdb_get(tlv, 0x9f46, NULL)) {
+        *icc = emv_pki_recover_icc_cert(ipk, tlv, tlvdb_get(tlv, 0x21, NULL));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// batches
+//-----------------------------------------------------------------------------
+
+typedef struct {
+    emv_oda_cache_t *cache;
+    const char **files;
+    json_t **roots;
+    size_t count;
+    size_t next;
+    emv_oda_result_t *results;
+} oda_job_t;
+
+static void oda_run_one(oda_job_t *job, size_t i) {
+    emv_oda_result_t *res = &job->results[i];
+    memset(res, 0, sizeof(emv_oda_result_t));
+    uint64_t t = usclock();
+
+    // roots given by the caller are borrowed, several workers must not refcount one
+    json_t *root = job->roots ? job->roots[i] : NULL;
+    if (job->files) {
+        json_error_t error;
+        root = json_load_file(job->files[i], 0, &error);
+    }
+
+    bool loaded = (root != NULL);
+    struct tlvdb *tlv = NULL;
+    if (loaded) {
+        tlv = emv_oda_load_json(root);
+        if (job->files) {
+            json_decref(root);
+        }
+    }
+
+    oda_stage_end(res, ODA_STAGE_LOAD, t);
+    if (tlv == NULL) {
+        oda_fail(res, loaded ? "no card data" : "can't load file");
+        return;
+    }
+
+    oda_verify(job->cache, tlv, res);
+    tlvdb_free(tlv);
+}
+
+static void *oda_worker(void *arg) {
+    oda_job_t *job = (oda_job_t *)arg;
+    size_t i;
+    while ((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->count) {
+        oda_run_one(job, i);
+    }
+    return NULL;
+}
+
+static int oda_run(oda_job_t *job, size_t threads) {
+    if (threads == 0) {
+        threads = num_CPUs();
+    }
+    threads = MIN(threads, MIN(job->count, ODA_MAX_THREADS));
+
+    if (threads <= 1) {
+        oda_worker(job);
+        return PM3_SUCCESS;
+    }
+
+    // seed the object hashes before the workers race for it
+    json_object_seed(0);
+
+    pthread_t th[ODA_MAX_THREADS];
+    size_t started = 0;
+    for (; started < threads; started++) {
+        if (pthread_create(&th[started], NULL, oda_worker, job)) {
+            break;
+        }
+    }
+
+    // whatever was not started, the running workers pick up its share
+    if (started == 0) {
+        oda_worker(job);
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(th[i], NULL);
+    }
+    return PM3_SUCCESS;
+}
+
+int emv_oda_verify_files(emv_oda_cache_t *cache, const char **files, size_t count, size_t threads, emv_oda_result_t *results) {
+    oda_job_t job = { .cache = cache, .files = files, .count = count, .results = results };
+    return oda_run(&job, threads);
+}
+
+int emv_oda_verify_json(emv_oda_cache_t *cache, json_t **roots, size_t count, size_t threads, emv_oda_result_t *results) {
+    oda_job_t job = { .cache = cache, .roots = roots, .count = count, .results = results };
+    return oda_run(&job, threads);
+}
@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Batch offline data authentication of recorded EMV transactions
+//
+// Card data saved by `emv scan` is turned back into a TLV tree and its
+// certificates are checked offline.  CA keys are cached by (RID, index) and
+// recovered issuer keys by (RID, index, SHA-1 of the issuer certificate), so
+// a batch of cards from the same issuer pays for the issuer RSA once.
+//-----------------------------------------------------------------------------
+
+#ifndef EMV_ODA_H__
+#define EMV_ODA_H__
+
+#include "common.h"
+#include "jansson.h"
+#include "tlv.h"
+
+typedef enum {
+    ODA_STAGE_LOAD = 0,
+    ODA_STAGE_CA,
+    ODA_STAGE_ISSUER,
+    ODA_STAGE_ICC,
+    ODA_STAGE_VERIFY,
+    ODA_STAGES
+} emv_oda_stage_t;
+
+typedef enum {
+    ODA_NONE = 0,       // nothing to check
+    ODA_KEYS,           // keys recovered, no signature recorded
+    ODA_SDA,
+    ODA_FDDA,           // signature from the GPO response
+} emv_oda_method_t;
+
+typedef enum {
+    ODA_OK = 0,
+    ODA_FAIL,
+    ODA_NODATA,         // card data without certificates
+    ODA_UNVERIFIED,     // keys recovered, but no signature could be checked
+} emv_oda_status_t;
+
+typedef struct {
+    emv_oda_status_t status;
+    emv_oda_method_t method;
+    emv_oda_stage_t stage;      // last stage run, the failing one on ODA_FAIL
+    const char *reason;
+    uint8_t rid[5];
+    uint8_t index;
+    bool issuer_cached;
+    uint64_t stage_us[ODA_STAGES];
+} emv_oda_result_t;
+
+typedef struct emv_oda_cache_s emv_oda_cache_t;
+
+emv_oda_cache_t *emv_oda_cache_new(void);
+void emv_oda_cache_free(emv_oda_cache_t *cache);
+void emv_oda_cache_stats(emv_oda_cache_t *cache, size_t *ca_keys, size_t *issuer_keys, size_t *issuer_hits);
+
+// transaction TLV tree of an `emv scan` file, NULL when nothing usable is found
+struct tlvdb *emv_oda_load_json(json_t *root);
+
+// the cache may be shared by several threads
+void emv_oda_verify(emv_oda_cache_t *cache, struct tlvdb *tlv, emv_oda_result_t *res);
+
+// issuer and ICC public keys of a card, copies to free with emv_pk_free().
+// Either one is NULL when it can not be recovered
+struct emv_pk;
+void emv_oda_recover_keys(emv_oda_cache_t *cache, struct tlvdb *tlv, struct emv_pk **issuer, struct emv_pk **icc);
+
+// results come in input order, threads 0 picks the number of CPUs
+int emv_oda_verify_files(emv_oda_cache_t *cache, const char **files, size_t count, size_t threads, emv_oda_result_t *results);
+int emv_oda_verify_json(emv_oda_cache_t *cache, json_t **roots, size_t count, size_t threads, emv_oda_result_t *results);
+
+const char *emv_oda_stage_name(emv_oda_stage_t stage);
+const char *emv_oda_method_name(emv_oda_method_t method);
+
+#endif
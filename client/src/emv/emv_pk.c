@@ -30,6 +30,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 #include "ui.h"
 #include "crypto.h"
@@ -432,18 +434,83 @@ void emv_pk_free(struct emv_pk *pk) {
     free(pk);
 }
 
-static struct emv_pk *emv_pk_get_ca_pk_from_file(const char *fname,
-                                                 const unsigned char *rid,
-                                                 unsigned char idx) {
-    if (!fname)
+struct emv_pk *emv_pk_dup(const struct emv_pk *pk) {
+    if (!pk)
         return NULL;
 
+    struct emv_pk *res = emv_pk_new(pk->mlen, pk->elen);
+    if (!res)
+        return NULL;
+
+    unsigned char *modulus = res->modulus;
+    memcpy(res, pk, sizeof(*res));
+    res->modulus = modulus;
+    memcpy(res->modulus, pk->modulus, pk->mlen);
+    return res;
+}
+
+// capk.txt is parsed and verified once, then kept until it changes on disk
+struct emv_pk_ca_entry {
+    struct emv_pk *pk;
+    bool verified;
+};
+
+static pthread_mutex_t emv_pk_ca_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+    char *path;
+    time_t mtime;
+    off_t size;
+    struct emv_pk_ca_entry *keys;
+    size_t count;
+} emv_pk_ca;
+
+static bool emv_pk_file_stamp(const char *fname, time_t *mtime, off_t *size) {
+#ifdef _WIN32
+    struct _stat st;
+    if (_stat(fname, &st) != 0)
+        return false;
+#else
+    struct stat st;
+    if (stat(fname, &st) != 0)
+        return false;
+#endif
+    *mtime = st.st_mtime;
+    *size = st.st_size;
+    return true;
+}
+
+static void emv_pk_ca_drop(void) {
+    for (size_t i = 0; i < emv_pk_ca.count; i++)
+        emv_pk_free(emv_pk_ca.keys[i].pk);
+
+    free(emv_pk_ca.keys);
+    free(emv_pk_ca.path);
+    memset(&emv_pk_ca, 0, sizeof(emv_pk_ca));
+}
+
+static bool emv_pk_ca_load(const char *fname) {
+    time_t mtime = 0;
+    off_t size = 0;
+    if (!emv_pk_file_stamp(fname, &mtime, &size)) {
+        PrintAndLogEx(ERR, "Error: can't open file %s.", fname);
+        return false;
+    }
+
+    if (emv_pk_ca.path && !strcmp(emv_pk_ca.path, fname) && emv_pk_ca.mtime == mtime && emv_pk_ca.size == size)
+        return true;
+
+    emv_pk_ca_drop();
+
     FILE *f = fopen(fname, "r");
     if (!f) {
         PrintAndLogEx(ERR, "Error: can't open file %s.", fname);
-        return NULL;
+        return false;
     }
 
+    emv_pk_ca.path = strdup(fname);
+    emv_pk_ca.mtime = mtime;
+    emv_pk_ca.size = size;
+
     while (!feof(f)) {
         char buf[2048];
         if (fgets(buf, sizeof(buf), f) == NULL)
@@ -453,17 +520,51 @@ static struct emv_pk *emv_pk_get_ca_pk_from_file(const char *fname,
         if (!pk)
             continue;
 
-        if (memcmp(pk->rid, rid, 5) || pk->index != idx) {
+        struct emv_pk_ca_entry *tmp = realloc(emv_pk_ca.keys, (emv_pk_ca.count + 1) * sizeof(struct emv_pk_ca_entry));
+        if (!tmp) {
             emv_pk_free(pk);
-            continue;
+            break;
         }
-
-        fclose(f);
-        return pk;
+        emv_pk_ca.keys = tmp;
+        emv_pk_ca.keys[emv_pk_ca.count].pk = pk;
+        emv_pk_ca.keys[emv_pk_ca.count].verified = emv_pk_verify(pk);
+        emv_pk_ca.count++;
     }
 
     fclose(f);
-    return NULL;
+    return true;
+}
+
+static struct emv_pk *emv_pk_get_ca_pk_from_file(const char *fname,
+                                                 const unsigned char *rid,
+                                                 unsigned char idx,
+                                                 bool *verified) {
+    if (!fname)
+        return NULL;
+
+    struct emv_pk *res = NULL;
+    pthread_mutex_lock(&emv_pk_ca_lock);
+
+    if (emv_pk_ca_load(fname)) {
+        for (size_t i = 0; i < emv_pk_ca.count; i++) {
+            const struct emv_pk *pk = emv_pk_ca.keys[i].pk;
+            if (memcmp(pk->rid, rid, 5) || pk->index != idx)
+                continue;
+
+            res = emv_pk_dup(pk);
+            *verified = emv_pk_ca.keys[i].verified;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&emv_pk_ca_lock);
+    return res;
+}
+
+void emv_pk_free_ca_cache(void) {
+    pthread_mutex_lock(&emv_pk_ca_lock);
+    emv_pk_ca_drop();
+    pthread_mutex_unlock(&emv_pk_ca_lock);
 }
 
 // not used
@@ -513,6 +614,10 @@ char *emv_pk_get_ca_pk_rid_file(const char *dirname, const unsigned char *rid) {
 */
 
 struct emv_pk *emv_pk_get_ca_pk(const unsigned char *rid, unsigned char idx) {
+    return emv_pk_get_ca_pk_ex(rid, idx, true);
+}
+
+struct emv_pk *emv_pk_get_ca_pk_ex(const unsigned char *rid, unsigned char idx, bool verbose) {
     struct emv_pk *pk = NULL;
 
     /*  if (!pk) {
@@ -535,24 +640,25 @@ struct emv_pk *emv_pk_get_ca_pk(const unsigned char *rid, unsigned char idx) {
     if (searchFile(&path, RESOURCES_SUBDIR, "capk", ".txt", false) != PM3_SUCCESS) {
         return NULL;
     }
-    pk = emv_pk_get_ca_pk_from_file(path, rid, idx);
+    bool isok = false;
+    pk = emv_pk_get_ca_pk_from_file(path, rid, idx, &isok);
     free(path);
 
     if (!pk)
         return NULL;
 
-    bool isok = emv_pk_verify(pk);
-
-    PrintAndLogEx(INFO, "Verifying CA PK for %02hhx:%02hhx:%02hhx:%02hhx:%02hhx IDX %02hhx %zu bits.  ( %s )",
-                  pk->rid[0],
-                  pk->rid[1],
-                  pk->rid[2],
-                  pk->rid[3],
-                  pk->rid[4],
-                  pk->index,
-                  pk->mlen * 8,
-                  (isok) ? _GREEN_("ok") : _RED_("failed")
-                 );
+    if (verbose || !isok) {
+        PrintAndLogEx(INFO, "Verifying CA PK for %02hhx:%02hhx:%02hhx:%02hhx:%02hhx IDX %02hhx %zu bits.  ( %s )",
+                      pk->rid[0],
+                      pk->rid[1],
+                      pk->rid[2],
+                      pk->rid[3],
+                      pk->rid[4],
+                      pk->index,
+                      pk->mlen * 8,
+                      (isok) ? _GREEN_("ok") : _RED_("failed")
+                     );
+    }
 
     if (isok) {
         return pk;
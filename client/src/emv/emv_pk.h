@@ -44,10 +44,15 @@ struct emv_pk {
 struct emv_pk *emv_pk_parse_pk(char *buf, size_t buflen);
 struct emv_pk *emv_pk_new(size_t modlen, size_t explen);
 void emv_pk_free(struct emv_pk *pk);
+struct emv_pk *emv_pk_dup(const struct emv_pk *pk);
 char *emv_pk_dump_pk(const struct emv_pk *pk);
 bool emv_pk_verify(const struct emv_pk *pk);
 
 // char *emv_pk_get_ca_pk_file(const char *dirname, const unsigned char *rid, unsigned char idx);
 // char *emv_pk_get_ca_pk_rid_file(const char *dirname, const unsigned char *rid);
+// CA keys come from capk.txt, parsed once and kept until the file changes.
+// The returned key is a copy, free it with emv_pk_free()
 struct emv_pk *emv_pk_get_ca_pk(const unsigned char *rid, unsigned char idx);
+struct emv_pk *emv_pk_get_ca_pk_ex(const unsigned char *rid, unsigned char idx, bool verbose);
+void emv_pk_free_ca_cache(void);
 #endif
@@ -21,124 +21,146 @@
 
 #include "emv_roca.h"
 
+#include <pthread.h>
+#include "commonutil.h"  // ARRAYLEN
 #include "ui.h"  // Print...
-#include "bignum.h"
-
-static void rocacheck_init(mbedtls_mpi *prints) {
-
-    for (int i = 0; i < ROCA_PRINTS_LENGTH; i++)
-        mbedtls_mpi_init(&prints[i]);
-
-    mbedtls_mpi_read_string(&prints[0], 10, "1026");
-    mbedtls_mpi_read_string(&prints[1], 10, "5658");
-    mbedtls_mpi_read_string(&prints[2], 10, "107286");
-    mbedtls_mpi_read_string(&prints[3], 10, "199410");
-    mbedtls_mpi_read_string(&prints[4], 10, "67109890");
-    mbedtls_mpi_read_string(&prints[5], 10, "5310023542746834");
-    mbedtls_mpi_read_string(&prints[6], 10, "1455791217086302986");
-    mbedtls_mpi_read_string(&prints[7], 10, "20052041432995567486");
-    mbedtls_mpi_read_string(&prints[8], 10, "6041388139249378920330");
-    mbedtls_mpi_read_string(&prints[9], 10, "207530445072488465666");
-    mbedtls_mpi_read_string(&prints[10], 10, "79228162521181866724264247298");
-    mbedtls_mpi_read_string(&prints[11], 10, "1760368345969468176824550810518");
-    mbedtls_mpi_read_string(&prints[12], 10, "50079290986288516948354744811034");
-    mbedtls_mpi_read_string(&prints[13], 10, "473022961816146413042658758988474");
-    mbedtls_mpi_read_string(&prints[14], 10, "144390480366845522447407333004847678774");
-    mbedtls_mpi_read_string(&prints[15], 10, "1800793591454480341970779146165214289059119882");
-    mbedtls_mpi_read_string(&prints[16], 10, "126304807362733370595828809000324029340048915994");
-}
-
-static void rocacheck_cleanup(mbedtls_mpi *prints) {
-    for (int i = 0; i < ROCA_PRINTS_LENGTH; i++)
-        mbedtls_mpi_free(&prints[i]);
+#include "util.h"  // num_CPUs
+
+// A ROCA key is 65537^a mod M for the primorial M of the Infineon library,
+// so the modulus reduced by every small prime p of M lands in the subgroup
+// generated by 65537 mod p.  prints[] is that subgroup as a bit set per prime.
+static const struct {
+    uint8_t prime;
+    uint64_t print[3];
+} roca_prints[ROCA_PRINTS_LENGTH] = {
+    {  11, { 0x0000000000000402ULL, 0x0000000000000000ULL, 0x0000000000000000ULL } },
+    {  13, { 0x000000000000161aULL, 0x0000000000000000ULL, 0x0000000000000000ULL } },
+    {  17, { 0x000000000001a316ULL, 0x0000000000000000ULL, 0x0000000000000000ULL } },
+    {  19, { 0x0000000000030af2ULL, 0x0000000000000000ULL, 0x0000000000000000ULL } },
+    {  37, { 0x0000000004000402ULL, 0x0000000000000000ULL, 0x0000000000000000ULL } },
+    {  53, { 0x0012dd703303aed2ULL, 0x0000000000000000ULL, 0x0000000000000000ULL } },
+    {  61, { 0x1434026619900b0aULL, 0x0000000000000000ULL, 0x0000000000000000ULL } },
+    {  71, { 0x164729716b1d977eULL, 0x0000000000000001ULL, 0x0000000000000000ULL } },
+    {  73, { 0x811a48004962078aULL, 0x0000000000000147ULL, 0x0000000000000000ULL } },
+    {  79, { 0x4010404000640502ULL, 0x000000000000000bULL, 0x0000000000000000ULL } },
+    {  97, { 0x6000001800000002ULL, 0x0000000100000000ULL, 0x0000000000000000ULL } },
+    { 103, { 0xbd964257768fe396ULL, 0x00000016380e9115ULL, 0x0000000000000000ULL } },
+    { 107, { 0x633397be6a897e1aULL, 0x0000027816ea9821ULL, 0x0000000000000000ULL } },
+    { 109, { 0xb003685cbe7192baULL, 0x00001752639f4e85ULL, 0x0000000000000000ULL } },
+    { 127, { 0xa04c81430a190536ULL, 0x6ca09850c2813205ULL, 0x0000000000000000ULL } },
+    { 151, { 0x1a2412003d18030aULL, 0xbc00482458dac35bULL, 0x000000000050c018ULL } },
+    { 157, { 0x071bd5baca0b7e1aULL, 0xd76af63826461899ULL, 0x00000000161fb414ULL } },
+};
+
+// the primes above grouped so that every product fits 32 bits. The modulus is
+// reduced once per group with 64 bit words, then per prime from the remainder
+static const struct {
+    uint32_t product;
+    uint8_t first;
+    uint8_t count;
+} roca_groups[] = {
+    {   90576629U,  0, 6 },     // 11 .. 53
+    { 2422757069U,  6, 5 },     // 61 .. 97
+    {  152563703U, 11, 4 },     // 103 .. 127
+    {      23707U, 15, 2 },     // 151, 157
+};
+
+static uint32_t roca_mod(const unsigned char *buf, size_t buflen, uint32_t m) {
+    uint64_t r = 0;
+    size_t head = buflen % 4;
+    for (size_t i = 0; i < head; i++) {
+        r = ((r << 8) | buf[i]) % m;
+    }
+    for (size_t i = head; i < buflen; i += 4) {
+        uint32_t w = ((uint32_t)buf[i] << 24) | ((uint32_t)buf[i + 1] << 16) | ((uint32_t)buf[i + 2] << 8) | buf[i + 3];
+        r = ((r << 32) | w) % m;
+    }
+    return r;
 }
 
-static int bitand_is_zero(mbedtls_mpi *a, mbedtls_mpi *b) {
-
-    for (int i = 0; i < mbedtls_mpi_bitlen(a); i++) {
+static bool roca_fingerprint(const unsigned char *buf, size_t buflen) {
+    for (size_t g = 0; g < ARRAYLEN(roca_groups); g++) {
+        uint32_t r = roca_mod(buf, buflen, roca_groups[g].product);
 
-        if (mbedtls_mpi_get_bit(a, i) && mbedtls_mpi_get_bit(b, i))
-            return 0;
+        for (size_t i = roca_groups[g].first; i < roca_groups[g].first + roca_groups[g].count; i++) {
+            uint32_t rp = r % roca_prints[i].prime;
+            if (((roca_prints[i].print[rp / 64] >> (rp % 64)) & 1) == 0) {
+                return false;
+            }
+        }
     }
-    return 1;
+    return true;
 }
 
+bool emv_rocacheck(const unsigned char *buf, size_t buflen, bool verbose) {
 
-static mbedtls_mpi_uint mpi_get_uint(const mbedtls_mpi *X) {
-
-    if (X->n == 1 && X->s > 0) {
-        return X->p[0];
+    bool ret = roca_fingerprint(buf, buflen);
+    if (verbose) {
+        if (ret)
+            PrintAndLogEx(SUCCESS, "Fingerprint found!\n");
+        else
+            PrintAndLogEx(FAILED, "No fingerprint found.\n");
     }
-
-    PrintAndLogEx(WARNING, "ZERRRRO!!!\n");
-    return 0;
+    return ret;
 }
 
-/*
-static void print_mpi(const char *msg, int radix, const mbedtls_mpi *X) {
-
-    char Xchar[400] = {0};
-    size_t len = 0;
+#define ROCA_MAX_THREADS  64
+#define ROCA_CHUNK        256
+
+typedef struct {
+    const roca_key_t *keys;
+    size_t count;
+    bool *weak;
+    size_t next;
+    size_t found;
+} roca_job_t;
+
+static void *roca_worker(void *arg) {
+    roca_job_t *job = (roca_job_t *)arg;
+    size_t found = 0;
+
+    for (;;) {
+        size_t start = __atomic_fetch_add(&job->next, ROCA_CHUNK, __ATOMIC_RELAXED);
+        if (start >= job->count) {
+            break;
+        }
+        size_t end = MIN(start + ROCA_CHUNK, job->count);
+        for (size_t i = start; i < end; i++) {
+            job->weak[i] = roca_fingerprint(job->keys[i].modulus, job->keys[i].len);
+            found += job->weak[i];
+        }
+    }
 
-    mbedtls_mpi_write_string(X, radix, Xchar, sizeof(Xchar), &len);
-    PrintAndLogEx(INFO, "%s[%zu] %s\n", msg, len, Xchar);
+    __atomic_add_fetch(&job->found, found, __ATOMIC_RELAXED);
+    return NULL;
 }
-*/
-bool emv_rocacheck(const unsigned char *buf, size_t buflen, bool verbose) {
-
-    mbedtls_mpi t_modulus;
-    mbedtls_mpi_init(&t_modulus);
 
-    bool ret = false;
-    mbedtls_mpi prints[ROCA_PRINTS_LENGTH];
-    uint8_t primes[ROCA_PRINTS_LENGTH] = {
-        11, 13, 17, 19, 37, 53, 61, 71, 73, 79, 97, 103, 107, 109, 127, 151, 157
-    };
+size_t emv_rocacheck_batch(const roca_key_t *keys, size_t count, size_t threads, bool *weak) {
+    roca_job_t job = { .keys = keys, .count = count, .weak = weak };
 
-    rocacheck_init(prints);
-
-    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&t_modulus, buf, buflen));
-
-    for (int i = 0; i < ROCA_PRINTS_LENGTH; i++) {
-
-        mbedtls_mpi t_temp;
-        mbedtls_mpi t_prime;
-        mbedtls_mpi g_one;
-
-        mbedtls_mpi_init(&t_temp);
-        mbedtls_mpi_init(&t_prime);
-        mbedtls_mpi_init(&g_one);
-
-        MBEDTLS_MPI_CHK(mbedtls_mpi_read_string(&g_one, 10, "1"));
-
-        MBEDTLS_MPI_CHK(mbedtls_mpi_add_int(&t_prime, &t_prime, primes[i]));
-
-        MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&t_temp, &t_modulus, &t_prime));
-
-        MBEDTLS_MPI_CHK(mbedtls_mpi_shift_l(&g_one, mpi_get_uint(&t_temp)));
-
-        mbedtls_mpi_free(&t_temp);
-        mbedtls_mpi_free(&t_prime);
-
-        if (bitand_is_zero(&g_one, &prints[i])) {
-            if (verbose) {
-                PrintAndLogEx(FAILED, "No fingerprint found.\n");
+    if (threads == 0) {
+        threads = num_CPUs();
+    }
+    threads = MIN(threads, MIN((count + ROCA_CHUNK - 1) / ROCA_CHUNK, ROCA_MAX_THREADS));
+
+    pthread_t th[ROCA_MAX_THREADS];
+    size_t started = 0;
+    if (threads > 1) {
+        for (; started < threads; started++) {
+            if (pthread_create(&th[started], NULL, roca_worker, &job)) {
+                break;
             }
-            mbedtls_mpi_free(&g_one);
-            goto cleanup;
         }
-        mbedtls_mpi_free(&g_one);
     }
 
-    ret = true;
-    if (verbose)
-        PrintAndLogEx(SUCCESS, "Fingerprint found!\n");
-
-cleanup:
-    mbedtls_mpi_free(&t_modulus);
-
-    rocacheck_cleanup(prints);
-    return ret;
+    // run in this thread as well when no worker was started
+    if (started == 0) {
+        roca_worker(&job);
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(th[i], NULL);
+    }
+    return job.found;
 }
 
 int roca_self_test(void) {
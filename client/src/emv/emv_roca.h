@@ -26,7 +26,15 @@
 
 #define ROCA_PRINTS_LENGTH 17
 
+typedef struct {
+    const uint8_t *modulus;     // big endian
+    size_t len;
+} roca_key_t;
+
 bool emv_rocacheck(const unsigned char *buf, size_t buflen, bool verbose);
+// keys checked by `threads` workers (0 for the number of CPUs), weak[i] is set
+// for the fingerprinted ones. Returns how many were found
+size_t emv_rocacheck_batch(const roca_key_t *keys, size_t count, size_t threads, bool *weak);
 int roca_self_test(void);
 
 #endif
@@ -74,6 +74,17 @@ const char *GetApplicationDataName(tlv_tag_t tag) {
     return NULL;
 }
 
+tlv_tag_t GetApplicationDataTag(const char *name) {
+    if (!name)
+        return 0;
+
+    for (int i = 0; i < ARRAYLEN(ApplicationData) - 1; i++)
+        if (strcmp(ApplicationData[i].Name, name) == 0)
+            return ApplicationData[i].Tag;
+
+    return 0;
+}
+
 int JsonSaveJsonObject(json_t *root, const char *path, json_t *value) {
     json_error_t error;
 
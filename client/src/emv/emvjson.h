@@ -30,6 +30,8 @@ typedef struct {
 } ApplicationDataElm_t;
 
 const char *GetApplicationDataName(tlv_tag_t tag);
+// reverse of GetApplicationDataName(), 0 when the name is unknown
+tlv_tag_t GetApplicationDataTag(const char *name);
 
 int JsonSaveJsonObject(json_t *root, const char *path, json_t *value);
 int JsonSaveStr(json_t *root, const char *path, const char *value);
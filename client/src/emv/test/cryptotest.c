@@ -36,6 +36,7 @@
 #include "sda_test.h"
 #include "dda_test.h"
 #include "cda_test.h"
+#include "oda_test.h"
 #include "crypto/libpcrypto.h"
 #include "emv/emv_roca.h"
 
@@ -102,6 +103,9 @@ int ExecuteCryptoTests(bool verbose, bool ignore_time, bool include_slow_tests)
     res = exec_cda_test(verbose);
     if (res) TestFail = true;
 
+    res = exec_oda_test(verbose);
+    if (res) TestFail = true;
+
     res = exec_crypto_test(verbose, include_slow_tests);
     if (res) TestFail = true;
 
@@ -0,0 +1,223 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Batch offline data authentication test, SDA card of the SDA test
+//-----------------------------------------------------------------------------
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "../emv_oda.h"
+#include "../emvjson.h"
+#include "../tlv.h"
+#include "ui.h"         // printandlog
+#include "oda_test.h"
+
+static const unsigned char oda_issuer_cert[] = {
+    0x3c, 0x5f, 0xea, 0xd4, 0xdd, 0x7b, 0xca, 0x44, 0xf9, 0x3e, 0x90, 0xc4, 0x4f, 0x76, 0xed, 0xe5,
+    0x4a, 0x32, 0x88, 0xec, 0xdc, 0x78, 0x46, 0x9f, 0xcb, 0x12, 0x25, 0xc0, 0x3b, 0x2c, 0x04, 0xf2,
+    0xc2, 0xf4, 0x12, 0x28, 0x1a, 0x08, 0x22, 0xdf, 0x14, 0x64, 0x92, 0x30, 0x98, 0x9f, 0xb1, 0x49,
+    0x40, 0x70, 0xda, 0xf8, 0xc9, 0x53, 0x4a, 0x78, 0x81, 0x96, 0x01, 0x48, 0x61, 0x6a, 0xce, 0x58,
+    0x17, 0x88, 0x12, 0x0d, 0x35, 0x06, 0xac, 0xe4, 0xce, 0xe5, 0x64, 0xfb, 0x27, 0xee, 0x53, 0x34,
+    0x1c, 0x22, 0xf0, 0xb4, 0x5b, 0x31, 0x87, 0x3d, 0x05, 0xde, 0x54, 0x5e, 0xfe, 0x33, 0xbc, 0xd2,
+    0x9b, 0x21, 0x85, 0xd0, 0x35, 0xa8, 0x06, 0xad, 0x08, 0xc6, 0x97, 0x6f, 0x35, 0x05, 0xa1, 0x99,
+    0x99, 0x93, 0x0c, 0xa8, 0xa0, 0x3e, 0xfa, 0x32, 0x1c, 0x48, 0x60, 0x61, 0xf7, 0xdc, 0xec, 0x9f,
+};
+
+static const unsigned char oda_issuer_rem[] = {
+    0x1e, 0xbc, 0xa3, 0x0f, 0x00, 0xce, 0x59, 0x62, 0xa8, 0xc6, 0xe1, 0x30, 0x54, 0x4b, 0x82, 0x89,
+    0x1b, 0x23, 0x6c, 0x65, 0xde, 0x29, 0x31, 0x7f, 0x36, 0x47, 0x35, 0xde, 0xe6, 0x3f, 0x65, 0x98,
+    0x97, 0x58, 0x35, 0xd5
+};
+
+static const unsigned char oda_ssad_cr[] = {
+    0x99, 0xa5, 0x58, 0xb6, 0x2b, 0x67, 0x4a, 0xa5, 0xe7, 0xd2, 0xa5, 0x7e, 0x5e, 0xf6, 0xa6, 0xf2,
+    0x25, 0x8e, 0x5d, 0xa0, 0x52, 0xd0, 0x5b, 0x54, 0xe5, 0xc1, 0x15, 0xff, 0x1c, 0xec, 0xf9, 0x4a,
+    0xa2, 0xdf, 0x8f, 0x39, 0xa0, 0x1d, 0x71, 0xc6, 0x19, 0xeb, 0x81, 0x9d, 0xa5, 0x2e, 0xf3, 0x81,
+    0xe8, 0x49, 0x79, 0x58, 0x6a, 0xea, 0x78, 0x55, 0xff, 0xbe, 0xf4, 0x0a, 0xa3, 0xa7, 0x1c, 0xd3,
+    0xb0, 0x4c, 0xfd, 0xf2, 0x70, 0xae, 0xc8, 0x15, 0x8a, 0x27, 0x97, 0xf2, 0x4f, 0xd6, 0x13, 0xb7,
+    0x48, 0x13, 0x46, 0x61, 0x13, 0x5c, 0xd2, 0x90, 0xe4, 0x5b, 0x04, 0xa8, 0xe0, 0xcc, 0xc7, 0x11,
+    0xae, 0x04, 0x2f, 0x15, 0x9e, 0x73, 0xc8, 0x9c, 0x2a, 0x7e, 0x65, 0xa4, 0xc2, 0xfd, 0x1d, 0x61,
+    0x06, 0x02, 0x4a, 0xa2, 0x71, 0x30, 0xb0, 0xec, 0xec, 0x02, 0x38, 0xf9, 0x16, 0x59, 0xde, 0x96,
+};
+
+// FCI with the Visa RID, GPO with AIP and AFL: SFI 2 records 1..3, the first one signed
+static const unsigned char oda_fci[] = {
+    0x6f, 0x09, 0x84, 0x07, 0xa0, 0x00, 0x00, 0x00, 0x03, 0x10, 0x10,
+};
+
+static const unsigned char oda_gpo[] = {
+    0x77, 0x0a, 0x82, 0x02, 0x40, 0x00, 0x94, 0x04, 0x10, 0x01, 0x03, 0x01,
+};
+
+const unsigned char oda_records1[] = {
+    0x5f, 0x24, 0x03, 0x08, 0x12, 0x31, 0x5a, 0x08, 0x42, 0x76, 0x55, 0x00, 0x13, 0x23, 0x45, 0x99, 0x5f, 0x34, 0x01, 0x01, 0x9f, 0x07, 0x02, 0xff, 0x00, 0x9f, 0x0d, 0x05, 0xd0, 0x40, 0xac, 0xa8, 0x00, 0x9f, 0x0e, 0x05, 0x00, 0x10, 0x00, 0x00, 0x00, 0x9f, 0x0f, 0x05, 0xd0, 0x68, 0xbc, 0xf8, 0x00,
+    0x5c, 0x00,
+};
+
+#define ODA_TEST_FILES   10
+#define ODA_TEST_BAD_SDA  8
+#define ODA_TEST_BAD_PAN  9
+
+static size_t oda_test_put(unsigned char *buf, size_t pos, const unsigned char *hdr, size_t hdr_len, const unsigned char *data, size_t len) {
+    memcpy(buf + pos, hdr, hdr_len);
+    if (len) {
+        memcpy(buf + pos + hdr_len, data, len);
+    }
+    return pos + hdr_len + len;
+}
+
+static void oda_test_tree(json_t *root, json_t *elm, const char *path, const unsigned char *data, size_t len, bool extract) {
+    struct tlvdb *tlv = tlvdb_parse_multi(data, len);
+    if (extract) {
+        JsonSaveTLVTree(root, elm, path, tlv);
+    } else {
+        JsonSaveTLVTreeElm(elm, path, tlv, true, true, false);
+    }
+    tlvdb_free(tlv);
+}
+
+// the card data as `emv scan` saves it, with or without `--extract`
+static json_t *oda_test_json(bool extract, bool bad_sda, bool bad_pan) {
+    json_t *root = json_object();
+    JsonSaveStr(root, "$.File.Created", "emv oda test");
+    JsonSaveBufAsHex(root, "$.Application.AID", (uint8_t *)oda_fci + 4, 7);
+    oda_test_tree(root, root, "$.Application.FCITemplate", oda_fci, sizeof(oda_fci), extract);
+    oda_test_tree(root, root, "$.Application.GPO", oda_gpo, sizeof(oda_gpo), extract);
+    JsonSaveBufAsHex(root, "$.ApplicationData.AIP", (uint8_t *)oda_gpo + 4, 2);
+    JsonSaveBufAsHex(root, "$.ApplicationData.AFL", (uint8_t *)oda_gpo + 8, 4);
+
+    json_t *records = json_array();
+    json_object_set_new(json_path_get(root, "$.Application"), "Records", records);
+
+    unsigned char rec[3][256];
+    size_t len[3];
+
+    len[0] = oda_test_put(rec[0], 0, (const unsigned char[]) { 0x70, sizeof(oda_records1) }, 2, oda_records1, sizeof(oda_records1));
+    if (bad_pan) {
+        // 5A is the second element, another issuer identifier
+        rec[0][2 + 8] = 0x52;
+    }
+
+    len[1] = oda_test_put(rec[1], 0, (const unsigned char[]) { 0x70, 0x81, 0xb0, 0x8f, 0x01, 0x01 }, 6, NULL, 0);
+    len[1] = oda_test_put(rec[1], len[1], (const unsigned char[]) { 0x90, 0x81, 0x80 }, 3, oda_issuer_cert, sizeof(oda_issuer_cert));
+    len[1] = oda_test_put(rec[1], len[1], (const unsigned char[]) { 0x92, sizeof(oda_issuer_rem) }, 2, oda_issuer_rem, sizeof(oda_issuer_rem));
+    len[1] = oda_test_put(rec[1], len[1], (const unsigned char[]) { 0x9f, 0x32, 0x01, 0x03 }, 4, NULL, 0);
+
+    len[2] = oda_test_put(rec[2], 0, (const unsigned char[]) { 0x70, 0x81, 0x83, 0x93, 0x81, 0x80 }, 6, oda_ssad_cr, sizeof(oda_ssad_cr));
+    if (bad_sda) {
+        rec[2][len[2] - 1] ^= 0x01;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        json_t *jrec = json_object();
+        json_array_append_new(records, jrec);
+        JsonSaveHex(jrec, "SFI", 2, 1);
+        JsonSaveHex(jrec, "RecordNum", i + 1, 1);
+        JsonSaveHex(jrec, "Offline", 1, 1);
+        oda_test_tree(root, jrec, "$.Data", rec[i], len[i], extract);
+    }
+    return root;
+}
+
+static int oda_test_check(emv_oda_result_t *res, bool verbose) {
+    for (size_t i = 0; i < ODA_TEST_FILES; i++) {
+        emv_oda_status_t status = ODA_OK;
+        emv_oda_stage_t stage = ODA_STAGE_VERIFY;
+        if (i == ODA_TEST_BAD_SDA) {
+            status = ODA_FAIL;
+        }
+        if (i == ODA_TEST_BAD_PAN) {
+            status = ODA_FAIL;
+            stage = ODA_STAGE_ISSUER;
+        }
+
+        if (verbose) {
+            PrintAndLogEx(INFO, "file %zu: %s %s %s", i, emv_oda_method_name(res[i].method),
+                          emv_oda_stage_name(res[i].stage), res[i].reason ? res[i].reason : "");
+        }
+
+        if (res[i].status != status || res[i].stage != stage) {
+            PrintAndLogEx(WARNING, "File %zu: status %d stage %s", i, res[i].status, emv_oda_stage_name(res[i].stage));
+            return 1;
+        }
+        if (status == ODA_OK && res[i].method != ODA_SDA) {
+            PrintAndLogEx(WARNING, "File %zu: method %s", i, emv_oda_method_name(res[i].method));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int exec_oda_test(bool verbose) {
+    json_t *roots[ODA_TEST_FILES];
+    for (size_t i = 0; i < ODA_TEST_FILES; i++) {
+        roots[i] = oda_test_json(i % 2, i == ODA_TEST_BAD_SDA, i == ODA_TEST_BAD_PAN);
+    }
+
+    emv_oda_result_t res[ODA_TEST_FILES];
+    int ret = 0;
+
+    // one thread, the issuer key is recovered once and found for every other card
+    emv_oda_cache_t *cache = emv_oda_cache_new();
+    emv_oda_verify_json(cache, roots, ODA_TEST_FILES, 1, res);
+    ret = oda_test_check(res, verbose);
+
+    size_t ca_keys = 0, issuer_keys = 0, issuer_hits = 0;
+    emv_oda_cache_stats(cache, &ca_keys, &issuer_keys, &issuer_hits);
+    emv_oda_cache_free(cache);
+    if (ret == 0 && (ca_keys != 1 || issuer_keys != 1 || issuer_hits != ODA_TEST_FILES - 1)) {
+        PrintAndLogEx(WARNING, "Cache: CA keys %zu issuer keys %zu hits %zu", ca_keys, issuer_keys, issuer_hits);
+        ret = 1;
+    }
+
+    // several threads sharing a cold cache
+    if (ret == 0) {
+        cache = emv_oda_cache_new();
+        emv_oda_verify_json(cache, roots, ODA_TEST_FILES, 4, res);
+        ret = oda_test_check(res, verbose);
+        emv_oda_cache_stats(cache, &ca_keys, &issuer_keys, NULL);
+        emv_oda_cache_free(cache);
+        if (ret == 0 && (ca_keys != 1 || issuer_keys != 1)) {
+            PrintAndLogEx(WARNING, "Cache: CA keys %zu issuer keys %zu", ca_keys, issuer_keys);
+            ret = 1;
+        }
+    }
+
+    // issuer key recovered, but without the signed static data nothing is verified
+    if (ret == 0) {
+        json_t *root = oda_test_json(false, false, false);
+        json_array_remove(json_path_get(root, "$.Application.Records"), 2);
+        cache = emv_oda_cache_new();
+        emv_oda_verify_json(cache, &root, 1, 1, res);
+        emv_oda_cache_free(cache);
+        json_decref(root);
+        if (res[0].status != ODA_UNVERIFIED || res[0].method != ODA_KEYS) {
+            PrintAndLogEx(WARNING, "No signed data: status %d method %s", res[0].status, emv_oda_method_name(res[0].method));
+            ret = 1;
+        }
+    }
+
+    for (size_t i = 0; i < ODA_TEST_FILES; i++) {
+        json_decref(roots[i]);
+    }
+
+    if (ret) {
+        PrintAndLogEx(WARNING, "ODA batch test ( %s )", _RED_("fail"));
+        return ret;
+    }
+    PrintAndLogEx(SUCCESS, "ODA batch test ( %s )", _GREEN_("ok"));
+    return 0;
+}
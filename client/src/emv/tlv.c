@@ -113,12 +113,62 @@ bool tlv_parse_tl(const unsigned char **buf, size_t *len, struct tlv *tlv) {
     return true;
 }
 
-static struct tlvdb *tlvdb_parse_children(struct tlvdb *parent);
+// elements of one parse, handed out in order
+struct tlvdb_arena {
+    struct tlvdb *next;
+    struct tlvdb *end;
+};
+
+#define TLVDB_INDEX_MIN     8       // smaller trees are searched linearly
+
+struct tlvdb_index_slot {
+    tlv_tag_t tag;
+    struct tlvdb *elm;
+};
+
+struct tlvdb_index {
+    uint32_t generation;
+    uint8_t bits;                   // log2 of the slot count, 0 when not indexed
+    struct tlvdb_index_slot slots[];
+};
+
+// bumped whenever a tree changes shape, the indexes built before are stale.
+// Trees may live in several threads, so it is only touched atomically
+static uint32_t tlvdb_generation = 1;
+
+// number of elements in a buffer, checked the same way tlvdb_parse_one() does
+static bool tlvdb_count(const unsigned char **tmp, size_t *left, size_t *count) {
+    struct tlv tlv;
+
+    if (!tlv_parse_tl(tmp, left, &tlv))
+        return false;
+
+    if (tlv.len > *left)
+        return false;
+
+    const unsigned char *value = *tmp;
+    *tmp += tlv.len;
+    *left -= tlv.len;
+    (*count)++;
+
+    if (tlv_is_constructed(&tlv)) {
+        size_t vleft = tlv.len;
+        while (vleft != 0) {
+            if (!tlvdb_count(&value, &vleft, count))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static struct tlvdb *tlvdb_parse_children(struct tlvdb *parent, struct tlvdb_arena *arena);
 
 static bool tlvdb_parse_one(struct tlvdb *tlvdb,
                             struct tlvdb *parent,
                             const unsigned char **tmp,
-                            size_t *left) {
+                            size_t *left,
+                            struct tlvdb_arena *arena) {
     if (tlvdb == NULL) {
         return false;
     }
@@ -142,7 +192,7 @@ static bool tlvdb_parse_one(struct tlvdb *tlvdb,
     *left -= tlvdb->tag.len;
 
     if (tlv_is_constructed(&tlvdb->tag) && (tlvdb->tag.len != 0)) {
-        tlvdb->children = tlvdb_parse_children(tlvdb);
+        tlvdb->children = tlvdb_parse_children(tlvdb, arena);
         if (!tlvdb->children)
             goto err;
     } else {
@@ -155,7 +205,7 @@ err:
     return false;
 }
 
-static struct tlvdb *tlvdb_parse_children(struct tlvdb *parent) {
+static struct tlvdb *tlvdb_parse_children(struct tlvdb *parent, struct tlvdb_arena *arena) {
     if (parent == NULL) {
         return NULL;
     }
@@ -164,71 +214,87 @@ static struct tlvdb *tlvdb_parse_children(struct tlvdb *parent) {
     struct tlvdb *tlvdb, *first = NULL, *prev = NULL;
 
     while (left != 0) {
-        tlvdb = calloc(1, sizeof(*tlvdb));
-        if (tlvdb == NULL) {
-            goto err;
+        if (arena->next == arena->end) {
+            return NULL;
         }
+        tlvdb = arena->next++;
+        tlvdb->flags = TLVDB_F_ARENA;
+
         if (prev)
             prev->next = tlvdb;
         else
             first = tlvdb;
         prev = tlvdb;
 
-        if (!tlvdb_parse_one(tlvdb, parent, &tmp, &left))
-            goto err;
-
-        tlvdb->parent = parent;
+        if (!tlvdb_parse_one(tlvdb, parent, &tmp, &left, arena))
+            return NULL;
     }
 
     return first;
+}
 
-err:
-    tlvdb_free(first);
+// parse root->buf into root->db, its children and, with multi, its siblings.
+// The elements are counted first so they all fit in one block
+static bool tlvdb_parse_buf(struct tlvdb_root *root, bool multi) {
+    const unsigned char *tmp = root->buf;
+    size_t left = root->len;
+    size_t count = 0;
 
-    return NULL;
-}
+    root->db.flags = TLVDB_F_ROOT;
+    root->db.next = root->db.children = NULL;
+    free(root->nodes);
+    root->nodes = NULL;
+    free(root->index);
+    root->index = NULL;
+    root->seen = 0;
 
-struct tlvdb *tlvdb_parse(const unsigned char *buf, size_t len) {
-    struct tlvdb_root *root;
-    const unsigned char *tmp;
-    size_t left;
+    do {
+        if (!tlvdb_count(&tmp, &left, &count))
+            return false;
+    } while (multi && left != 0);
 
-    if (!len || !buf)
-        return NULL;
+    if (left != 0)
+        return false;
 
-    root = calloc(1, sizeof(*root) + len);
-    if (root == NULL) {
-        return NULL;
+    struct tlvdb_arena arena = { NULL, NULL };
+    if (count > 1) {
+        root->nodes = calloc(count - 1, sizeof(struct tlvdb));
+        if (root->nodes == NULL) {
+            return false;
+        }
+        arena.next = root->nodes;
+        arena.end = root->nodes + count - 1;
     }
-    root->len = len;
-    memcpy(root->buf, buf, len);
 
     tmp = root->buf;
-    left = len;
+    left = root->len;
+    if (!tlvdb_parse_one(&root->db, NULL, &tmp, &left, &arena))
+        return false;
 
-    if (!tlvdb_parse_one(&root->db, NULL, &tmp, &left))
-        goto err;
+    struct tlvdb *last = &root->db;
+    while (left != 0) {
+        if (arena.next == arena.end) {
+            return false;
+        }
+        struct tlvdb *db = arena.next++;
+        db->flags = TLVDB_F_ARENA;
 
-    if (left)
-        goto err;
+        if (!tlvdb_parse_one(db, NULL, &tmp, &left, &arena))
+            return false;
 
-    return &root->db;
+        last->next = db;
+        last = db;
+    }
 
-err:
-    tlvdb_root_free(root);
-    return NULL;
+    return true;
 }
 
-struct tlvdb *tlvdb_parse_multi(const unsigned char *buf, size_t len) {
-    struct tlvdb_root *root;
-    const unsigned char *tmp;
-    size_t left;
-
+static struct tlvdb *tlvdb_parse_copy(const unsigned char *buf, size_t len, bool multi) {
     if (len == 0 || buf == NULL) {
         return NULL;
     }
 
-    root = calloc(1, sizeof(*root) + len);
+    struct tlvdb_root *root = calloc(1, sizeof(*root) + len);
     if (root == NULL) {
         return NULL;
     }
@@ -236,32 +302,20 @@ struct tlvdb *tlvdb_parse_multi(const unsigned char *buf, size_t len) {
     root->len = len;
     memcpy(root->buf, buf, len);
 
-    tmp = root->buf;
-    left = len;
-
-    if (tlvdb_parse_one(&root->db, NULL, &tmp, &left) == false) {
-        goto err;
-    }
-
-    while (left != 0) {
-        struct tlvdb *db = calloc(1, sizeof(*db));
-        if (db == NULL) {
-            goto err;
-        }
-
-        if (tlvdb_parse_one(db, NULL, &tmp, &left) == false) {
-            free(db);
-            goto err;
-        }
-
-        tlvdb_add(&root->db, db);
+    if (tlvdb_parse_buf(root, multi) == false) {
+        tlvdb_root_free(root);
+        return NULL;
     }
 
     return &root->db;
+}
 
-err:
-    tlvdb_root_free(root);
-    return NULL;
+struct tlvdb *tlvdb_parse(const unsigned char *buf, size_t len) {
+    return tlvdb_parse_copy(buf, len, false);
+}
+
+struct tlvdb *tlvdb_parse_multi(const unsigned char *buf, size_t len) {
+    return tlvdb_parse_copy(buf, len, true);
 }
 
 bool tlvdb_parse_root(struct tlvdb_root *root) {
@@ -269,17 +323,7 @@ bool tlvdb_parse_root(struct tlvdb_root *root) {
         return false;
     }
 
-    const uint8_t *tmp;
-    size_t left;
-
-    tmp = root->buf;
-    left = root->len;
-    if (tlvdb_parse_one(&root->db, NULL, &tmp, &left) == true) {
-        if (left == 0) {
-            return true;
-        }
-    }
-    return false;
+    return tlvdb_parse_buf(root, false);
 }
 
 bool tlvdb_parse_root_multi(struct tlvdb_root *root) {
@@ -287,27 +331,7 @@ bool tlvdb_parse_root_multi(struct tlvdb_root *root) {
         return false;
     }
 
-    const uint8_t *tmp;
-    size_t left;
-
-    tmp = root->buf;
-    left = root->len;
-    if (tlvdb_parse_one(&root->db, NULL, &tmp, &left) == true) {
-        while (left > 0) {
-            struct tlvdb *db = calloc(1, sizeof(*db));
-            if (db == NULL) {
-                return false;
-            }
-            if (tlvdb_parse_one(db, NULL, &tmp, &left) == true) {
-                tlvdb_add(&root->db, db);
-            } else {
-                free(db);
-                return false;
-            }
-        }
-        return true;
-    }
-    return false;
+    return tlvdb_parse_buf(root, true);
 }
 
 struct tlvdb *tlvdb_fixed(tlv_tag_t tag, size_t len, const unsigned char *value) {
@@ -323,6 +347,7 @@ struct tlvdb *tlvdb_fixed(tlv_tag_t tag, size_t len, const unsigned char *value)
     root->db.tag.tag = tag;
     root->db.tag.len = len;
     root->db.tag.value = root->buf;
+    root->db.flags = TLVDB_F_ROOT;
 
     return &root->db;
 }
@@ -339,21 +364,45 @@ struct tlvdb *tlvdb_external(tlv_tag_t tag, size_t len, const unsigned char *val
     root->db.tag.tag = tag;
     root->db.tag.len = len;
     root->db.tag.value = value;
+    root->db.flags = TLVDB_F_ROOT;
 
     return &root->db;
 }
 
-void tlvdb_free(struct tlvdb *tlvdb) {
+static void tlvdb_root_release(struct tlvdb_root *root) {
+    free(root->nodes);
+    free(root->index);
+    free(root);
+}
+
+// roots are collected and released once the walk is over, the elements still
+// to visit may live in their blocks
+static void tlvdb_free_list(struct tlvdb *tlvdb, struct tlvdb **roots) {
     struct tlvdb *next = NULL;
 
+    for (; tlvdb; tlvdb = next) {
+        next = tlvdb->next;
+        tlvdb_free_list(tlvdb->children, roots);
+        if (tlvdb->flags & TLVDB_F_ROOT) {
+            tlvdb->next = *roots;
+            *roots = tlvdb;
+        }
+    }
+}
+
+void tlvdb_free(struct tlvdb *tlvdb) {
+    struct tlvdb *roots = NULL;
+
     if (tlvdb == NULL) {
         return;
     }
 
-    for (; tlvdb; tlvdb = next) {
-        next = tlvdb->next;
-        tlvdb_free(tlvdb->children);
-        free(tlvdb);
+    tlvdb_free_list(tlvdb, &roots);
+
+    while (roots) {
+        struct tlvdb *next = roots->next;
+        tlvdb_root_release((struct tlvdb_root *)roots);
+        roots = next;
     }
 }
 
@@ -369,7 +418,93 @@ void tlvdb_root_free(struct tlvdb_root *root) {
         tlvdb_free(root->db.next);
         root->db.next = NULL;
     }
-    free(root);
+    tlvdb_root_release(root);
+}
+
+static size_t tlvdb_index_count(const struct tlvdb *tlvdb) {
+    size_t n = 0;
+    for (; tlvdb; tlvdb = tlvdb->next) {
+        n += 1 + tlvdb_index_count(tlvdb->children);
+    }
+    return n;
+}
+
+static inline size_t tlvdb_index_slot(tlv_tag_t tag, uint8_t bits) {
+    return (uint32_t)(tag * 2654435761U) >> (32 - bits);
+}
+
+static void tlvdb_index_add(struct tlvdb_index *index, struct tlvdb *tlvdb) {
+    size_t mask = ((size_t)1 << index->bits) - 1;
+
+    for (; tlvdb; tlvdb = tlvdb->next) {
+        for (size_t i = tlvdb_index_slot(tlvdb->tag.tag, index->bits); ; i = (i + 1) & mask) {
+            struct tlvdb_index_slot *slot = &index->slots[i];
+            if (slot->elm == NULL) {
+                slot->tag = tlvdb->tag.tag;
+                slot->elm = tlvdb;
+                break;
+            }
+            // first one in tree order wins, as with the linear search
+            if (slot->tag == tlvdb->tag.tag) {
+                break;
+            }
+        }
+        tlvdb_index_add(index, tlvdb->children);
+    }
+}
+
+// whole tree lookup through the index of a root. Returns false when the tree
+// has to be searched linearly
+static bool tlvdb_index_find(struct tlvdb *tlvdb, tlv_tag_t tag, struct tlvdb **res) {
+    if (tlvdb == NULL || (tlvdb->flags & TLVDB_F_ROOT) == 0) {
+        return false;
+    }
+    struct tlvdb_root *root = (struct tlvdb_root *)tlvdb;
+    uint32_t generation = __atomic_load_n(&tlvdb_generation, __ATOMIC_ACQUIRE);
+
+    if (root->index == NULL || root->index->generation != generation) {
+        // a tree searched only once is not worth the index
+        if (root->seen != generation) {
+            root->seen = generation;
+            return false;
+        }
+
+        free(root->index);
+        size_t n = tlvdb_index_count(tlvdb);
+        uint8_t bits = 0;
+        if (n >= TLVDB_INDEX_MIN) {
+            while (((size_t)1 << bits) < 2 * n) {
+                bits++;
+            }
+        }
+
+        size_t slots = bits ? ((size_t)1 << bits) : 0;
+        root->index = calloc(1, sizeof(struct tlvdb_index) + slots * sizeof(struct tlvdb_index_slot));
+        if (root->index == NULL) {
+            return false;
+        }
+        root->index->generation = generation;
+        root->index->bits = bits;
+        if (bits) {
+            tlvdb_index_add(root->index, tlvdb);
+        }
+    }
+
+    struct tlvdb_index *index = root->index;
+    if (index->bits == 0) {
+        return false;
+    }
+
+    size_t mask = ((size_t)1 << index->bits) - 1;
+    for (size_t i = tlvdb_index_slot(tag, index->bits); index->slots[i].elm; i = (i + 1) & mask) {
+        if (index->slots[i].tag == tag) {
+            *res = index->slots[i].elm;
+            return true;
+        }
+    }
+
+    *res = NULL;
+    return true;
 }
 
 struct tlvdb *tlvdb_find_next(struct tlvdb *tlvdb, tlv_tag_t tag) {
@@ -399,6 +534,11 @@ struct tlvdb *tlvdb_find_full(struct tlvdb *tlvdb, tlv_tag_t tag) {
         return NULL;
     }
 
+    struct tlvdb *res = NULL;
+    if (tlvdb_index_find(tlvdb, tag, &res)) {
+        return res;
+    }
+
     for (; tlvdb; tlvdb = tlvdb->next) {
         if (tlvdb->tag.tag == tag) {
             return tlvdb;
@@ -435,6 +575,8 @@ void tlvdb_add(struct tlvdb *tlvdb, struct tlvdb *other) {
         return;
     }
 
+    __atomic_add_fetch(&tlvdb_generation, 1, __ATOMIC_RELEASE);
+
     while (tlvdb->next) {
         if (tlvdb->next == other) {
             return;
@@ -449,6 +591,7 @@ void tlvdb_add(struct tlvdb *tlvdb, struct tlvdb *other) {
 void tlvdb_change_or_add_node_ex(struct tlvdb *tlvdb, tlv_tag_t tag, size_t len, const unsigned char *value, struct tlvdb **tlvdb_elm) {
 
     struct tlvdb *telm = tlvdb_find_full(tlvdb, tag);
+    __atomic_add_fetch(&tlvdb_generation, 1, __ATOMIC_RELEASE);
     if (telm == NULL) {
         // new tlv element
         struct tlvdb *elm = tlvdb_fixed(tag, len, value);
@@ -549,6 +692,12 @@ const struct tlv *tlvdb_get(const struct tlvdb *tlvdb, tlv_tag_t tag, const stru
     if (prev) {
 // tlvdb = tlvdb_next(container_of(prev, struct tlvdb, tag));
         tlvdb = tlvdb_next((struct tlvdb *)prev);
+    } else if (tlvdb && tlvdb->parent == NULL) {
+        // from a root the walk below is the same as tlvdb_find_full()
+        struct tlvdb *res = NULL;
+        if (tlvdb_index_find((struct tlvdb *)tlvdb, tag, &res)) {
+            return res ? &res->tag : NULL;
+        }
     }
 
 
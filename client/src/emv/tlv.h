@@ -32,16 +32,30 @@ struct tlv {
     const unsigned char *value;
 };
 
+// element flags
+#define TLVDB_F_ROOT        0x01    // db member of a struct tlvdb_root
+#define TLVDB_F_ARENA       0x02    // lives in the nodes block of its root, never freed alone
+
 struct tlvdb {
     struct tlv tag;
     struct tlvdb *next;
     struct tlvdb *parent;
     struct tlvdb *children;
+    uint8_t flags;
 };
 
+struct tlvdb_index;
+
+// A parsed buffer is one root.  The elements below db are allocated as a
+// single block and their values point into buf, so parsing costs two
+// allocations whatever the number of elements.  Lookups of a whole tree go
+// through a per tag hash table once the same tree is searched twice.
 struct tlvdb_root {
     struct tlvdb db;
     size_t len;
+    struct tlvdb *nodes;            // parsed elements, NULL when there are none
+    struct tlvdb_index *index;      // tag index, built on demand
+    uint32_t seen;                  // tree generation of the last linear lookup
     unsigned char buf[];
 };
 
@@ -18,6 +18,7 @@
 #define _GNU_SOURCE
 #include "fileutils.h"
 #include "preferences.h"
+#include "perf.h"
 
 #include <dirent.h>
 #include <ctype.h>
@@ -429,6 +430,8 @@ int saveFileEx(const char *preferredName, const char *suffix, const void *data,
         return PM3_EINVARG;
     }
 
+    uint64_t perf_t0 = perf_start();
+
     char *fileName = newfilenamemcopyEx(preferredName, suffix, e_save_path);
     if (fileName == NULL) {
         return PM3_EMALLOC;
@@ -446,6 +449,8 @@ int saveFileEx(const char *preferredName, const char *suffix, const void *data,
     fwrite(data, 1, datalen, f);
     fflush(f);
     fclose(f);
+    perf_stop(PERF_FILE_SAVE, perf_t0);
+    perf_add(PERF_FILE_SAVE_BYTES, datalen);
     PrintAndLogEx(SUCCESS, "Saved " _YELLOW_("%zu") " bytes to binary file `" _YELLOW_("%s") "`", datalen, fileName);
     free(fileName);
     return PM3_SUCCESS;
@@ -985,6 +990,8 @@ int saveFileJSONrootEx(const char *preferredName, const void *root, size_t flags
         return PM3_EINVARG;
     }
 
+    uint64_t perf_t0 = perf_start();
+
     char *filename = NULL;
     if (overwrite)
         filename = filenamemcopy(preferredName, ".json");
@@ -997,6 +1004,7 @@ int saveFileJSONrootEx(const char *preferredName, const void *root, size_t flags
     int res = json_dump_file(root, filename, flags);
 
     if (res == 0) {
+        perf_stop(PERF_FILE_SAVE, perf_t0);
         if (verbose) {
             PrintAndLogEx(SUCCESS, "Saved to json file " _YELLOW_("%s"), filename);
         }
@@ -1156,6 +1164,8 @@ int loadFile_safe(const char *preferredName, const char *suffix, void **pdata, s
 }
 int loadFile_safeEx(const char *preferredName, const char *suffix, void **pdata, size_t *datalen, bool verbose) {
 
+    uint64_t perf_t0 = perf_start();
+
     char *path;
     int res = searchFile(&path, RESOURCES_SUBDIR, preferredName, suffix, false);
     if (res != PM3_SUCCESS) {
@@ -1200,6 +1210,9 @@ int loadFile_safeEx(const char *preferredName, const char *suffix, void **pdata,
 
     *datalen = bytes_read;
 
+    perf_stop(PERF_FILE_LOAD, perf_t0);
+    perf_add(PERF_FILE_LOAD_BYTES, bytes_read);
+
     if (verbose) {
         PrintAndLogEx(SUCCESS, "Loaded " _YELLOW_("%zu") " bytes from binary file `" _YELLOW_("%s") "`", bytes_read, preferredName);
     }
@@ -1692,6 +1705,7 @@ int loadFileJSONex(const char *preferredName, void *data, size_t maxdatalen, siz
 
     *datalen = 0;
     int retval = PM3_SUCCESS;
+    uint64_t perf_t0 = perf_start();
 
     char *path;
     int res = searchFile(&path, RESOURCES_SUBDIR, preferredName, ".json", false);
@@ -2411,6 +2425,10 @@ out:
     }
 
     json_decref(root);
+    if (retval == PM3_SUCCESS) {
+        perf_stop(PERF_FILE_LOAD, perf_t0);
+        perf_add(PERF_FILE_LOAD_BYTES, *datalen);
+    }
     return retval;
 }
 
@@ -2476,6 +2494,8 @@ int loadFileDICTIONARYEx(const char *preferredName, void *data, size_t maxdatale
         *endFilePosition = 0;
     }
 
+    uint64_t perf_t0 = perf_start();
+
     char *path;
     if (searchFile(&path, DICTIONARIES_SUBDIR, preferredName, ".dic", false) != PM3_SUCCESS) {
         return PM3_EFILE;
@@ -2567,6 +2587,9 @@ int loadFileDICTIONARYEx(const char *preferredName, void *data, size_t maxdatale
         *keycnt = vkeycnt;
     }
 
+    perf_stop(PERF_FILE_LOAD, perf_t0);
+    perf_add(PERF_FILE_LOAD_BYTES, counter);
+
     free(path);
     return retval;
 }
@@ -2579,6 +2602,7 @@ int loadFileDICTIONARY_safe(const char *preferredName, void **pdata, uint8_t key
 int loadFileDICTIONARY_safe_ex(const char *preferredName, const char *suffix, void **pdata, uint8_t keylen, uint32_t *keycnt, bool verbose) {
 
     int retval = PM3_SUCCESS;
+    uint64_t perf_t0 = perf_start();
 
     char *path;
     if (searchFile(&path, DICTIONARIES_SUBDIR, preferredName, suffix, false) != PM3_SUCCESS) {
@@ -2682,6 +2706,9 @@ int loadFileDICTIONARY_safe_ex(const char *preferredName, const char *suffix, vo
     }
     fclose(f);
 
+    perf_stop(PERF_FILE_LOAD, perf_t0);
+    perf_add(PERF_FILE_LOAD_BYTES, *keycnt * (keylen >> 1));
+
     if (verbose) {
         PrintAndLogEx(SUCCESS, "Loaded " _GREEN_("%d") " keys from dictionary file `" _YELLOW_("%s") "`", *keycnt, path);
     }
@@ -0,0 +1,202 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Bitsliced Hitag2 keystream evaluator, portable u64 backend and dispatcher.
+//-----------------------------------------------------------------------------
+
+#include "hitag2_bs.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "hitag2_bs_avx2.h"
+#include "hitag2/hitag2_crypto.h"
+#include "ui.h"
+#include "commonutil.h"  // ARRAYLEN
+#include "pm3_cmd.h"     // return codes
+
+#define HT2_BS_T        uint64_t
+#define HT2_BS_WORDS    1
+#define HT2_BS_ANY(x)   ((x) != 0)
+#define HT2_BS_FN       ht2_bs_match_64
+#include "hitag2_bs_kernel.h"
+
+static const ht2_bs_backend_t backend_u64 = {
+    .width = 64,
+    .words = 1,
+    .name  = "u64",
+    .match = ht2_bs_match_64,
+};
+
+static const ht2_bs_backend_t backend_avx2 = {
+    .width = HT2_BS256_WIDTH,
+    .words = HT2_BS256_WORDS,
+    .name  = "AVX2",
+    .match = ht2_bs_match_256,
+};
+
+const ht2_bs_backend_t *ht2_bs_best_backend(void) {
+    static const ht2_bs_backend_t *cached = NULL;
+    if (cached != NULL) {
+        return cached;
+    }
+
+    if (ht2_bs_avx2_supported()) {
+        cached = &backend_avx2;
+    } else {
+        cached = &backend_u64;
+    }
+    return cached;
+}
+
+// Classic 64x64 bit matrix transpose. Row r of the input is key r, after the
+// transpose row b holds bit b of every key.
+void ht2_bs_transpose64(const uint64_t *keys, uint32_t n, uint64_t planes[48]) {
+    uint64_t m[64] = {0};
+    if (n > 64) {
+        n = 64;
+    }
+    memcpy(m, keys, n * sizeof(uint64_t));
+
+    uint64_t mask = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, mask ^= (mask << j)) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            const uint64_t t = ((m[k] >> j) ^ m[k | j]) & mask;
+            m[k] ^= t << j;
+            m[k | j] ^= t;
+        }
+    }
+    memcpy(planes, m, 48 * sizeof(uint64_t));
+}
+
+static void ht2_bs_build_planes(const ht2_bs_backend_t *be, const uint64_t *keys, uint32_t n, uint64_t *kb) {
+    uint64_t planes[48];
+    for (int w = 0; w < be->words; w++) {
+        uint32_t start = w * 64;
+        uint32_t cnt = (n > start) ? n - start : 0;
+        if (cnt > 64) {
+            cnt = 64;
+        }
+        ht2_bs_transpose64(keys + start, cnt, planes);
+        for (int b = 0; b < 48; b++) {
+            kb[b * be->words + w] = planes[b];
+        }
+    }
+}
+
+static bool ht2_scalar_check(uint64_t key, uint32_t uid, const ht2_nrar_t *p) {
+    hitag_state_t hs;
+    ht2_hitag2_init_ex(&hs, key, uid, p->nr);
+    return ((p->ar ^ ht2_hitag2_nstep(&hs, 32)) == 0xFFFFFFFF);
+}
+
+int ht2_bs_check_keys(const uint64_t *keys, uint32_t keycount, uint32_t uid,
+                      const ht2_nrar_t *pairs, uint32_t paircount, uint32_t *found_idx) {
+
+    if (keys == NULL || keycount == 0 || pairs == NULL || paircount == 0) {
+        return PM3_EINVARG;
+    }
+
+    const ht2_bs_backend_t *be = ht2_bs_best_backend();
+
+    uint64_t kb[48 * HT2_BS_MAX_WORDS];
+    uint64_t match[HT2_BS_MAX_WORDS];
+
+    for (uint32_t base = 0; base < keycount; base += be->width) {
+
+        uint32_t n = keycount - base;
+        if (n > (uint32_t)be->width) {
+            n = be->width;
+        }
+
+        ht2_bs_build_planes(be, keys + base, n, kb);
+        be->match(kb, uid, pairs[0].nr, pairs[0].ar, match);
+
+        for (int w = 0; w < be->words; w++) {
+
+            uint64_t m = match[w];
+            while (m) {
+                uint32_t lane = (w * 64) + __builtin_ctzll(m);
+                m &= m - 1;
+
+                // padding lanes are all-zero keys
+                if (lane >= n) {
+                    continue;
+                }
+
+                // survivors of the first pair are rare, confirm the rest scalar
+                bool ok = true;
+                for (uint32_t p = 1; p < paircount && ok; p++) {
+                    ok = ht2_scalar_check(keys[base + lane], uid, &pairs[p]);
+                }
+
+                if (ok) {
+                    if (found_idx) {
+                        *found_idx = base + lane;
+                    }
+                    return PM3_SUCCESS;
+                }
+            }
+        }
+    }
+    return PM3_ESOFT;
+}
+
+int ht2_bs_selftest(void) {
+
+    const uint32_t uid = 0x69574349;
+    const uint32_t nr = 0x72456E65;
+    const uint64_t secret = 0x524B494D4E4FULL;
+
+    hitag_state_t hs;
+    ht2_hitag2_init_ex(&hs, secret, uid, nr);
+    const ht2_nrar_t pair = { .nr = nr, .ar = ~ht2_hitag2_nstep(&hs, 32) };
+
+    uint64_t keys[HT2_BS256_WIDTH];
+    uint64_t x = 0x0123456789ABULL;
+    for (int i = 0; i < HT2_BS256_WIDTH; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        keys[i] = x & 0xFFFFFFFFFFFFULL;
+    }
+    keys[HT2_BS256_WIDTH - 3] = secret;
+
+    const ht2_bs_backend_t *backends[] = { &backend_u64, &backend_avx2 };
+    bool isok = true;
+
+    for (size_t i = 0; i < ARRAYLEN(backends); i++) {
+        const ht2_bs_backend_t *be = backends[i];
+        if (be == &backend_avx2 && ht2_bs_avx2_supported() == false) {
+            continue;
+        }
+
+        uint64_t kb[48 * HT2_BS_MAX_WORDS];
+        uint64_t match[HT2_BS_MAX_WORDS];
+        bool be_ok = true;
+
+        for (int base = 0; base < HT2_BS256_WIDTH; base += be->width) {
+            ht2_bs_build_planes(be, keys + base, be->width, kb);
+            be->match(kb, uid, pair.nr, pair.ar, match);
+
+            for (int lane = 0; lane < be->width; lane++) {
+                bool want = ht2_scalar_check(keys[base + lane], uid, &pair);
+                bool got = (match[lane / 64] >> (lane % 64)) & 1;
+                if (want != got) {
+                    be_ok = false;
+                }
+            }
+        }
+        PrintAndLogEx(INFO, "bitslice %-4s ( %s )", be->name, be_ok ? _GREEN_("ok") : _RED_("fail"));
+        isok &= be_ok;
+    }
+    return isok ? PM3_SUCCESS : PM3_ESOFT;
+}
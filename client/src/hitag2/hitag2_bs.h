@@ -0,0 +1,58 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Bitsliced Hitag2 keystream evaluator for dictionary checks against sniffed
+// nR/aR pairs. Same approach as tools/hitag2crack/crack5: each bit of the 48
+// bit cipher state is stored as one lane word holding that bit for 64 (u64)
+// or 256 (AVX2) different keys, so one pass of the cipher tests a whole batch.
+//
+// Keys use the same bit order as ht2_hitag2_init_ex() (the "sharedkey"
+// argument), nR is the clear-text reader nonce / IV and aR the encrypted
+// reader answer as it appears on air (BE/MSB), ie. the pair is valid for a
+// key iff  aR ^ ht2_hitag2_nstep(32) == 0xFFFFFFFF.
+//-----------------------------------------------------------------------------
+
+#ifndef HITAG2_BS_H__
+#define HITAG2_BS_H__
+
+#include "common.h"
+
+#define HT2_BS_MAX_WORDS    4   // AVX2
+
+typedef struct {
+    uint32_t nr;
+    uint32_t ar;
+} ht2_nrar_t;
+
+typedef struct ht2_bs_backend_s {
+    int width;      // 64 or 256
+    int words;      // width / 64
+    const char *name;
+    // kb holds the transposed keys, 48 bit planes of `words` uint64_t each.
+    // Writes a lane mask of keys whose keystream matches nR/aR into match_out.
+    void (*match)(const uint64_t *kb, uint32_t uid, uint32_t nr, uint32_t ar, uint64_t *match_out);
+} ht2_bs_backend_t;
+
+// Returns the widest backend the running CPU supports. Never NULL.
+const ht2_bs_backend_t *ht2_bs_best_backend(void);
+
+// Test keycount keys against all given nR/aR pairs. On a hit, the index of
+// the first key matching every pair is stored in found_idx.
+// Returns PM3_SUCCESS when found, PM3_ESOFT when no key matched.
+int ht2_bs_check_keys(const uint64_t *keys, uint32_t keycount, uint32_t uid,
+                      const ht2_nrar_t *pairs, uint32_t paircount, uint32_t *found_idx);
+
+// Transpose up to 64 keys (48 bit) into 48 bit planes.
+void ht2_bs_transpose64(const uint64_t *keys, uint32_t n, uint64_t planes[48]);
+
+// Cross checks all backends against the scalar implementation.
+int ht2_bs_selftest(void);
+
+#endif
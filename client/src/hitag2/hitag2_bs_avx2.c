@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// AVX2 256-wide bitsliced Hitag2. Same kernel as the u64 backend, with a
+// 256 bit GCC vector type as lane word.
+//-----------------------------------------------------------------------------
+
+#include "hitag2_bs_avx2.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+#if !defined(__ANDROID__)
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+#endif
+
+typedef uint64_t ht2_bs256_t __attribute__((vector_size(32)));
+
+static inline int ht2_bs256_any(ht2_bs256_t v) {
+    return (v[0] | v[1] | v[2] | v[3]) != 0;
+}
+
+#define HT2_BS_T        ht2_bs256_t
+#define HT2_BS_WORDS    HT2_BS256_WORDS
+#define HT2_BS_ANY(x)   ht2_bs256_any(x)
+#define HT2_BS_FN       ht2_bs_match_256_impl
+#include "hitag2_bs_kernel.h"
+
+void ht2_bs_match_256(const uint64_t *kb, uint32_t uid, uint32_t nr, uint32_t ar, uint64_t *match_out) {
+    ht2_bs_match_256_impl(kb, uid, nr, ar, match_out);
+}
+
+#if !defined(__ANDROID__)
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
+
+bool ht2_bs_avx2_supported(void) {
+    static int cached = -1;
+    if (cached < 0) {
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__ANDROID__)
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+        cached = 0;
+#endif
+    }
+    return cached != 0;
+}
+
+#else // non-x86 build: no-op, ht2_bs_avx2_supported returns false.
+
+bool ht2_bs_avx2_supported(void) { return false; }
+
+void ht2_bs_match_256(const uint64_t *kb, uint32_t uid, uint32_t nr, uint32_t ar, uint64_t *match_out) {
+    (void)kb;
+    (void)uid;
+    (void)nr;
+    (void)ar;
+    memset(match_out, 0, HT2_BS256_WORDS * sizeof(uint64_t));
+}
+
+#endif
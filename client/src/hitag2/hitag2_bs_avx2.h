@@ -0,0 +1,35 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// 256-wide bitsliced Hitag2 (AVX2). The interface uses plain uint64_t arrays
+// so callers do not need the AVX2 headers.
+//
+// On non-x86 builds (or when AVX2 is absent at runtime) the match function is
+// a safe no-op; gate use with ht2_bs_avx2_supported().
+//-----------------------------------------------------------------------------
+
+#ifndef HITAG2_BS_AVX2_H__
+#define HITAG2_BS_AVX2_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HT2_BS256_WIDTH 256
+#define HT2_BS256_WORDS 4
+
+// Returns true iff the running CPU supports AVX2 and this translation unit
+// was built for an x86 target. Cached after first call.
+bool ht2_bs_avx2_supported(void);
+
+// kb: 48 bit planes of HT2_BS256_WORDS uint64_t (lane L = bit L % 64 of
+// word L / 64). match_out receives HT2_BS256_WORDS words of lane mask.
+void ht2_bs_match_256(const uint64_t *kb, uint32_t uid, uint32_t nr, uint32_t ar, uint64_t *match_out);
+
+#endif
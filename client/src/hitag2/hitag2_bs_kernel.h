@@ -0,0 +1,88 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Bitsliced Hitag2 kernel body, shared by the u64 and AVX2 backends.
+//
+// Not a regular header: the including file defines
+//   HT2_BS_T       lane type (uint64_t or a GCC vector type)
+//   HT2_BS_WORDS   number of uint64_t per lane word
+//   HT2_BS_ANY(x)  non-zero iff any lane of x is set
+//   HT2_BS_FN      name of the generated match function
+// and gets a function with the ht2_bs_backend_t match signature.
+//
+// The state is kept as a sliding window: bit j of the cipher state at step t
+// lives in s[t + j], so shifting the register costs nothing.
+//-----------------------------------------------------------------------------
+
+// the filter functions, arguments in ascending state bit order
+#define HT2_BS_FA(a,b,c,d)       (~(((a|b)&c)^(a|d)^b))
+#define HT2_BS_FB(a,b,c,d)       (~(((d|c)&(a^b))^(d|a|b)))
+#define HT2_BS_FC(a,b,c,d,e)     (~((((((c^e)|d)&a)^b)&(c^b))^(((d^e)|a)&((d^b)|c))))
+
+#define HT2_BS_F20(s, w) HT2_BS_FC( \
+        HT2_BS_FA((s)[(w) +  1], (s)[(w) +  2], (s)[(w) +  4], (s)[(w) +  5]), \
+        HT2_BS_FB((s)[(w) +  7], (s)[(w) + 11], (s)[(w) + 13], (s)[(w) + 14]), \
+        HT2_BS_FB((s)[(w) + 16], (s)[(w) + 20], (s)[(w) + 22], (s)[(w) + 25]), \
+        HT2_BS_FB((s)[(w) + 27], (s)[(w) + 28], (s)[(w) + 30], (s)[(w) + 32]), \
+        HT2_BS_FA((s)[(w) + 33], (s)[(w) + 42], (s)[(w) + 43], (s)[(w) + 45]))
+
+#define HT2_BS_LFSR(s, w) ( \
+        (s)[(w) +  0] ^ (s)[(w) +  2] ^ (s)[(w) +  3] ^ (s)[(w) +  6] ^ \
+        (s)[(w) +  7] ^ (s)[(w) +  8] ^ (s)[(w) + 16] ^ (s)[(w) + 22] ^ \
+        (s)[(w) + 23] ^ (s)[(w) + 26] ^ (s)[(w) + 30] ^ (s)[(w) + 41] ^ \
+        (s)[(w) + 42] ^ (s)[(w) + 43] ^ (s)[(w) + 46] ^ (s)[(w) + 47])
+
+static void HT2_BS_FN(const uint64_t *kb, uint32_t uid, uint32_t nr, uint32_t ar, uint64_t *match_out) {
+
+    const HT2_BS_T zero = (HT2_BS_T) {0};
+    const HT2_BS_T ones = ~zero;
+
+    // 48 bit initial state, 32 init steps, 32 keystream steps
+    HT2_BS_T s[48 + 32 + 32];
+    HT2_BS_T k[48];
+
+    memcpy(k, kb, sizeof(k));
+
+    for (int i = 0; i < 32; i++) {
+        s[i] = ((uid >> i) & 1) ? ones : zero;
+    }
+    for (int i = 0; i < 16; i++) {
+        s[32 + i] = k[i];
+    }
+
+    // initialisation, the IV xor upper 32 key bits are shifted in
+    for (int i = 0; i < 32; i++) {
+        const HT2_BS_T ivbit = ((nr >> i) & 1) ? ones : zero;
+        s[48 + i] = HT2_BS_F20(s, i + 1) ^ ivbit ^ k[16 + i];
+    }
+
+    // keystream, first bit ends up as MSB of the 32 bit answer
+    const uint32_t expect = ~ar;
+    HT2_BS_T match = ones;
+    for (int i = 0; i < 32; i++) {
+        const int w = 32 + i;
+        s[w + 48] = HT2_BS_LFSR(s, w);
+        const HT2_BS_T bit = HT2_BS_F20(s, w + 1);
+        const HT2_BS_T want = ((expect >> (31 - i)) & 1) ? ones : zero;
+        match &= ~(bit ^ want);
+
+        if ((i & 7) == 7 && HT2_BS_ANY(match) == 0) {
+            break;
+        }
+    }
+
+    memcpy(match_out, &match, HT2_BS_WORDS * sizeof(uint64_t));
+}
+
+#undef HT2_BS_F20
+#undef HT2_BS_LFSR
+#undef HT2_BS_FA
+#undef HT2_BS_FB
+#undef HT2_BS_FC
@@ -0,0 +1,269 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// In-client Hitag2 crack5, thread handling and key recovery.
+//-----------------------------------------------------------------------------
+
+#include "hitag2_crack5.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "hitag2/hitag2_crypto.h"
+#include "hitag2_bs_avx2.h"     // ht2_bs_avx2_supported
+#include "pm3_cmd.h"            // return codes
+
+#define HT2C5_FN    ht2c5_search_generic
+#include "hitag2_crack5_kernel.h"
+
+#define HT2C5_LAYER0_BITS   20
+#define HT2C5_LAYER0_MASK   0x5806b4a2d16cULL
+#define HT2C5_CHUNK         16
+
+typedef bool (*ht2c5_search_fn)(ht2_crack5_t *ctx, const ht2c5_tables_t *t, uint64_t state0);
+
+struct ht2_crack5_s {
+    uint32_t uid;
+    ht2_nrar_t pairs[HT2_CRACK5_MAX_PAIRS];
+    uint32_t paircount;
+
+    uint64_t *candidates;
+    uint64_t count;
+
+    ht2c5_search_fn search;
+    const char *backend;
+
+    pthread_t *tids;
+    int threads;
+
+    // shared between workers
+    uint64_t next;
+    uint64_t done;
+    int running;
+    bool found;
+    bool aborted;
+    uint64_t key;
+};
+
+static uint64_t ht2c5_expand(uint64_t mask, uint64_t value) {
+    uint64_t fill = 0;
+    for (uint64_t bit_index = 0; bit_index < 48; bit_index++) {
+        if (mask & 1) {
+            fill |= (value & 1) << bit_index;
+            value >>= 1;
+        }
+        mask >>= 1;
+    }
+    return fill;
+}
+
+static void ht2c5_build_tables(ht2c5_tables_t *t, uint32_t ar) {
+
+    memset(t->ones.bytes, 0xff, HT2C5_VECTOR_SIZE);
+    memset(t->zeroes.bytes, 0x00, HT2C5_VECTOR_SIZE);
+
+    // bitslice inverse target bits
+    ht2c5_bitslice(t, ar, t->keystream, 32, true);
+
+    // bitslice all possible 256 values in the lowest 8 bits
+    memset(t->initial_bitslices[0].bytes, 0xaa, HT2C5_VECTOR_SIZE);
+    memset(t->initial_bitslices[1].bytes, 0xcc, HT2C5_VECTOR_SIZE);
+    memset(t->initial_bitslices[2].bytes, 0xf0, HT2C5_VECTOR_SIZE);
+    size_t interval = 1;
+    for (size_t bit = 3; bit < 8; bit++) {
+        for (size_t byte = 0; byte < HT2C5_VECTOR_SIZE;) {
+            for (size_t length = 0; length < interval; length++) {
+                t->initial_bitslices[bit].bytes[byte++] = 0x00;
+            }
+            for (size_t length = 0; length < interval; length++) {
+                t->initial_bitslices[bit].bytes[byte++] = 0xff;
+            }
+        }
+        interval <<= 1;
+    }
+}
+
+bool ht2c5_try_state(ht2_crack5_t *ctx, uint64_t s) {
+
+    hitag_state_t hs;
+    hs.shiftreg = s;
+
+    // recover key
+    uint64_t keyrev = hs.shiftreg & 0xffff;
+    uint64_t nR1xk = (hs.shiftreg >> 16) & 0xffffffff;
+    uint32_t b = 0;
+    for (int i = 0; i < 32; i++) {
+        hs.shiftreg = (hs.shiftreg << 1) | ((ctx->uid >> (31 - i)) & 0x1);
+        b = (b << 1) | ht2_fnf(hs.shiftreg);
+    }
+    keyrev |= (nR1xk ^ ctx->pairs[0].nr ^ b) << 16;
+
+    // test key against the remaining pairs
+    for (uint32_t p = 1; p < ctx->paircount; p++) {
+        ht2_hitag2_init_ex(&hs, keyrev, ctx->uid, ctx->pairs[p].nr);
+        if ((ctx->pairs[p].ar ^ ht2_hitag2_nstep(&hs, 32)) != 0xffffffff) {
+            return false;
+        }
+    }
+
+    ctx->key = keyrev;
+    __atomic_store_n(&ctx->found, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool ht2c5_should_stop(ht2_crack5_t *c) {
+    return __atomic_load_n(&c->found, __ATOMIC_ACQUIRE) || __atomic_load_n(&c->aborted, __ATOMIC_RELAXED);
+}
+
+static void *ht2c5_worker(void *arg) {
+
+    ht2_crack5_t *c = (ht2_crack5_t *)arg;
+
+    // per thread copy, keeps the vector tables aligned and in local cache
+    ht2c5_tables_t t;
+    ht2c5_build_tables(&t, c->pairs[0].ar);
+
+    while (ht2c5_should_stop(c) == false) {
+
+        uint64_t start = __atomic_fetch_add(&c->next, HT2C5_CHUNK, __ATOMIC_RELAXED);
+        if (start >= c->count) {
+            break;
+        }
+
+        uint64_t end = start + HT2C5_CHUNK;
+        if (end > c->count) {
+            end = c->count;
+        }
+
+        for (uint64_t i = start; i < end; i++) {
+            if (c->search(c, &t, c->candidates[i])) {
+                break;
+            }
+        }
+
+        __atomic_fetch_add(&c->done, end - start, __ATOMIC_RELAXED);
+    }
+
+    __atomic_fetch_sub(&c->running, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+ht2_crack5_t *ht2_crack5_start(uint32_t uid, const ht2_nrar_t *pairs, uint32_t paircount, int threads) {
+
+    if (pairs == NULL || paircount < 2) {
+        return NULL;
+    }
+
+    if (paircount > HT2_CRACK5_MAX_PAIRS) {
+        paircount = HT2_CRACK5_MAX_PAIRS;
+    }
+
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    ht2_crack5_t *c = calloc(1, sizeof(ht2_crack5_t));
+    if (c == NULL) {
+        return NULL;
+    }
+
+    c->uid = uid;
+    c->paircount = paircount;
+    memcpy(c->pairs, pairs, paircount * sizeof(ht2_nrar_t));
+
+    if (ht2_bs_avx2_supported()) {
+        c->search = ht2c5_search_avx2;
+        c->backend = "AVX2";
+    } else {
+        c->search = ht2c5_search_generic;
+        c->backend = "generic";
+    }
+
+    // layer 0, about half of the 2^20 partial states produce the first keystream bit
+    c->candidates = calloc(1 << HT2C5_LAYER0_BITS, sizeof(uint64_t));
+    c->tids = calloc(threads, sizeof(pthread_t));
+    if (c->candidates == NULL || c->tids == NULL) {
+        free(c->candidates);
+        free(c->tids);
+        free(c);
+        return NULL;
+    }
+
+    const uint32_t first_bit = (pairs[0].ar >> 31) & 1;
+    for (uint64_t i0 = 0; i0 < (1 << HT2C5_LAYER0_BITS); i0++) {
+        uint64_t state0 = ht2c5_expand(HT2C5_LAYER0_MASK, i0);
+        if ((uint32_t)ht2_fnf(state0) != first_bit) {
+            c->candidates[c->count++] = state0;
+        }
+    }
+
+    c->running = threads;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&c->tids[i], NULL, ht2c5_worker, c) != 0) {
+            // run with what we got
+            __atomic_fetch_sub(&c->running, threads - i, __ATOMIC_RELEASE);
+            break;
+        }
+        c->threads++;
+    }
+
+    if (c->threads == 0) {
+        free(c->candidates);
+        free(c->tids);
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+bool ht2_crack5_status(ht2_crack5_t *c, uint64_t *done, uint64_t *total) {
+    if (done) {
+        *done = __atomic_load_n(&c->done, __ATOMIC_RELAXED);
+    }
+    if (total) {
+        *total = c->count;
+    }
+    return __atomic_load_n(&c->running, __ATOMIC_ACQUIRE) > 0;
+}
+
+void ht2_crack5_abort(ht2_crack5_t *c) {
+    __atomic_store_n(&c->aborted, true, __ATOMIC_RELAXED);
+}
+
+const char *ht2_crack5_backend(const ht2_crack5_t *c) {
+    return c->backend;
+}
+
+int ht2_crack5_threads(const ht2_crack5_t *c) {
+    return c->threads;
+}
+
+int ht2_crack5_finish(ht2_crack5_t *c, uint64_t *key) {
+
+    for (int i = 0; i < c->threads; i++) {
+        pthread_join(c->tids[i], NULL);
+    }
+
+    int res = PM3_ESOFT;
+    if (c->found) {
+        if (key) {
+            *key = c->key;
+        }
+        res = PM3_SUCCESS;
+    } else if (c->aborted) {
+        res = PM3_EOPABORTED;
+    }
+
+    free(c->candidates);
+    free(c->tids);
+    free(c);
+    return res;
+}
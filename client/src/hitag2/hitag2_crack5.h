@@ -0,0 +1,58 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// In-client Hitag2 crack5: recovers the key from a UID and two sniffed
+// nR/aR pairs by a bitsliced search over the 48 bit cipher state.
+//
+// The search runs in worker threads; the caller polls the progress, may
+// abort it at any time and finally collects the result:
+//
+//   ht2_crack5_t *c = ht2_crack5_start(uid, pairs, 2, threads);
+//   while (ht2_crack5_status(c, &done, &total)) { ... }
+//   res = ht2_crack5_finish(c, &key);
+//
+// uid, nR and aR use the same conventions as ht2_bs_check_keys(), the key
+// is returned in the ht2_hitag2_init_ex() bit order.
+//-----------------------------------------------------------------------------
+
+#ifndef HITAG2_CRACK5_H__
+#define HITAG2_CRACK5_H__
+
+#include "common.h"
+#include "hitag2_bs.h"
+
+#define HT2_CRACK5_MAX_PAIRS    16
+
+typedef struct ht2_crack5_s ht2_crack5_t;
+
+// Builds the layer 0 candidates and starts the workers. The first pair drives
+// the search, the others verify candidate keys. Needs at least two pairs.
+// Returns NULL on bad input or out of memory.
+ht2_crack5_t *ht2_crack5_start(uint32_t uid, const ht2_nrar_t *pairs, uint32_t paircount, int threads);
+
+// Number of layer 0 candidates searched so far and in total.
+// Returns false once all workers are done (key found, exhausted or aborted).
+bool ht2_crack5_status(ht2_crack5_t *c, uint64_t *done, uint64_t *total);
+
+// Asks the workers to stop after their current candidate.
+void ht2_crack5_abort(ht2_crack5_t *c);
+
+// Name of the search backend in use, "AVX2" or "generic".
+const char *ht2_crack5_backend(const ht2_crack5_t *c);
+
+// Number of workers actually started, may be fewer than asked for.
+int ht2_crack5_threads(const ht2_crack5_t *c);
+
+// Joins the workers and frees the context.
+// Returns PM3_SUCCESS with the key, PM3_ESOFT when the key space was exhausted
+// and PM3_EOPABORTED when stopped by ht2_crack5_abort().
+int ht2_crack5_finish(ht2_crack5_t *c, uint64_t *key);
+
+#endif
@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// AVX2 build of the crack5 state search. The kernel is identical to the
+// generic one, only compiled for AVX2 so the 256 bit lanes map to single
+// ymm registers. Selected at runtime via ht2_bs_avx2_supported().
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+#if !defined(__ANDROID__)
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+#endif
+
+#define HT2C5_FN    ht2c5_search_avx2_impl
+#include "hitag2_crack5_kernel.h"
+
+bool ht2c5_search_avx2(ht2_crack5_t *ctx, const ht2c5_tables_t *t, uint64_t state0) {
+    return ht2c5_search_avx2_impl(ctx, t, state0);
+}
+
+#if !defined(__ANDROID__)
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
+
+#else // non-x86 build, never selected since ht2_bs_avx2_supported() is false
+
+#include "hitag2_crack5_kernel.h"
+
+bool ht2c5_search_avx2(ht2_crack5_t *ctx, const ht2c5_tables_t *t, uint64_t state0) {
+    (void)ctx;
+    (void)t;
+    (void)state0;
+    return false;
+}
+
+#endif
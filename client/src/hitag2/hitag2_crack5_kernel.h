@@ -0,0 +1,697 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Hitag2 crack5 state search, ported from tools/hitag2crack/crack5 which in
+// turn is based on the HiTag2 Hell CPU implementation by FactorIT B.V.
+//
+// Not a regular header: the first part holds the types shared between
+// hitag2_crack5.c and hitag2_crack5_avx2.c, the second part is the search
+// body. The body is only emitted when the including file defines
+//   HT2C5_FN       name of the generated search function
+// and gets
+//   static bool HT2C5_FN(ht2_crack5_t *ctx, const ht2c5_tables_t *t, uint64_t state0);
+// which walks all states below one layer 0 candidate and returns true once
+// ht2c5_try_state() confirmed a key.
+//-----------------------------------------------------------------------------
+
+#ifndef HITAG2_CRACK5_KERNEL_TYPES__
+#define HITAG2_CRACK5_KERNEL_TYPES__
+
+#include "hitag2_crack5.h"
+
+#define HT2C5_BITSLICES     256
+#define HT2C5_VECTOR_SIZE   (HT2C5_BITSLICES / 8)
+
+typedef unsigned int __attribute__((aligned(HT2C5_VECTOR_SIZE))) __attribute__((vector_size(HT2C5_VECTOR_SIZE))) ht2c5_value_t;
+typedef union {
+    ht2c5_value_t value;
+    uint64_t bytes64[HT2C5_BITSLICES / 64];
+    uint8_t bytes[HT2C5_BITSLICES / 8];
+} ht2c5_bitslice_t;
+
+// read-only tables built once per crack run
+typedef struct {
+    ht2c5_bitslice_t keystream[32];
+    ht2c5_bitslice_t initial_bitslices[8];
+    ht2c5_bitslice_t ones;
+    ht2c5_bitslice_t zeroes;
+} ht2c5_tables_t;
+
+#define HT2C5_LFSR_INV(state) (((state)<<1) | (__builtin_parityll((state) & ((0xce0044c101cd>>1)|(1ull<<(47))))))
+#define HT2C5_BIT(n, word) (((word) >> (n)) & 1)
+#define HT2C5_VECTOR_BIT(slice, v) HT2C5_BIT((slice) & 0x3f, (v).bytes64[(slice) >> 6])
+
+static inline void ht2c5_bitslice(const ht2c5_tables_t *t, const uint64_t value, ht2c5_bitslice_t *bitsliced_value, const size_t bit_len, bool reverse) {
+    for (size_t bit_idx = 0; bit_idx < bit_len; bit_idx++) {
+        bool bit;
+        if (reverse) {
+            bit = HT2C5_BIT(bit_len - 1 - bit_idx, value);
+        } else {
+            bit = HT2C5_BIT(bit_idx, value);
+        }
+        bitsliced_value[bit_idx].value = (bit) ? t->ones.value : t->zeroes.value;
+    }
+}
+
+static inline uint64_t ht2c5_unbitslice(const ht2c5_bitslice_t *b, const uint8_t s, const uint8_t n) {
+    uint64_t result = 0;
+    for (uint8_t i = 0; i < n; ++i) {
+        result <<= 1;
+        result |= HT2C5_VECTOR_BIT(s, b[n - 1 - i]);
+    }
+    return result;
+}
+
+// Rolls the 48 bit state back to the key and checks it against all pairs.
+bool ht2c5_try_state(ht2_crack5_t *ctx, uint64_t s);
+
+// AVX2 build of the search, see hitag2_crack5_avx2.c
+bool ht2c5_search_avx2(ht2_crack5_t *ctx, const ht2c5_tables_t *t, uint64_t state0);
+
+#endif
+
+#ifdef HT2C5_FN
+
+static const uint8_t ht2c5_bits[9] = {20, 14, 4, 3, 1, 1, 1, 1, 1};
+static const uint8_t ht2c5_filter_pos[8] = {4, 7, 9, 13, 16, 18, 22, 24};
+
+#define HT2C5_FA(a,b,c,d)       (~(((a|b)&c)^(a|d)^b)) // 6 ops
+#define HT2C5_FB(a,b,c,d)       (~(((d|c)&(a^b))^(d|a|b))) // 7 ops
+#define HT2C5_FC(a,b,c,d,e)     (~((((((c^e)|d)&a)^b)&(c^b))^(((d^e)|a)&((d^b)|c)))) // 13 ops
+#define HT2C5_LFSR_BS(i) (state[-2+i+ 0].value ^ state[-2+i+ 2].value ^ state[-2+i+ 3].value ^ state[-2+i+ 6].value ^ \
+                          state[-2+i+ 7].value ^ state[-2+i+ 8].value ^ state[-2+i+16].value ^ state[-2+i+22].value ^ \
+                          state[-2+i+23].value ^ state[-2+i+26].value ^ state[-2+i+30].value ^ state[-2+i+41].value ^ \
+                          state[-2+i+42].value ^ state[-2+i+43].value ^ state[-2+i+46].value ^ state[-2+i+47].value)
+
+static bool HT2C5_FN(ht2_crack5_t *ctx, const ht2c5_tables_t *t, uint64_t state0) {
+
+    // we never actually set or use the lowest 2 bits the initial state, so we can save 2 bitslices everywhere
+    ht2c5_bitslice_t state[-2 + 32 + 48];
+
+    ht2c5_bitslice(t, state0 >> 2, &state[0], 46, false);
+
+    for (size_t bit = 0; bit < 8; bit++) {
+        state[-2 + ht2c5_filter_pos[bit]] = t->initial_bitslices[bit];
+    }
+
+    for (uint16_t i1 = 0; i1 < (1 << (ht2c5_bits[1] + 1) >> 8); i1++) {
+        state[-2 + 27].value = ((bool)(i1 & 0x1)) ? t->ones.value : t->zeroes.value;
+        state[-2 + 30].value = ((bool)(i1 & 0x2)) ? t->ones.value : t->zeroes.value;
+        state[-2 + 32].value = ((bool)(i1 & 0x4)) ? t->ones.value : t->zeroes.value;
+        state[-2 + 35].value = ((bool)(i1 & 0x8)) ? t->ones.value : t->zeroes.value;
+        state[-2 + 45].value = ((bool)(i1 & 0x10)) ? t->ones.value : t->zeroes.value;
+        state[-2 + 47].value = ((bool)(i1 & 0x20)) ? t->ones.value : t->zeroes.value;
+        state[-2 + 48].value = ((bool)(i1 & 0x40)) ? t->ones.value : t->zeroes.value; // guess lfsr output 0
+        // 0xfc07fef3f9fe
+        const ht2c5_value_t filter1_0 = HT2C5_FA(state[-2 + 3].value, state[-2 + 4].value, state[-2 + 6].value, state[-2 + 7].value);
+        const ht2c5_value_t filter1_1 = HT2C5_FB(state[-2 + 9].value, state[-2 + 13].value, state[-2 + 15].value, state[-2 + 16].value);
+        const ht2c5_value_t filter1_2 = HT2C5_FB(state[-2 + 18].value, state[-2 + 22].value, state[-2 + 24].value, state[-2 + 27].value);
+        const ht2c5_value_t filter1_3 = HT2C5_FB(state[-2 + 29].value, state[-2 + 30].value, state[-2 + 32].value, state[-2 + 34].value);
+        const ht2c5_value_t filter1_4 = HT2C5_FA(state[-2 + 35].value, state[-2 + 44].value, state[-2 + 45].value, state[-2 + 47].value);
+        const ht2c5_value_t filter1 = HT2C5_FC(filter1_0, filter1_1, filter1_2, filter1_3, filter1_4);
+        ht2c5_bitslice_t results1;
+        results1.value = filter1 ^ t->keystream[1].value;
+
+        if (results1.bytes64[0] == 0
+                && results1.bytes64[1] == 0
+                && results1.bytes64[2] == 0
+                && results1.bytes64[3] == 0
+           ) {
+            continue;
+        }
+        const ht2c5_value_t filter2_0 = HT2C5_FA(state[-2 + 4].value, state[-2 + 5].value, state[-2 + 7].value, state[-2 + 8].value);
+        const ht2c5_value_t filter2_3 = HT2C5_FB(state[-2 + 30].value, state[-2 + 31].value, state[-2 + 33].value, state[-2 + 35].value);
+        const ht2c5_value_t filter3_0 = HT2C5_FA(state[-2 + 5].value, state[-2 + 6].value, state[-2 + 8].value, state[-2 + 9].value);
+        const ht2c5_value_t filter5_2 = HT2C5_FB(state[-2 + 22].value, state[-2 + 26].value, state[-2 + 28].value, state[-2 + 31].value);
+        const ht2c5_value_t filter6_2 = HT2C5_FB(state[-2 + 23].value, state[-2 + 27].value, state[-2 + 29].value, state[-2 + 32].value);
+        const ht2c5_value_t filter7_2 = HT2C5_FB(state[-2 + 24].value, state[-2 + 28].value, state[-2 + 30].value, state[-2 + 33].value);
+        const ht2c5_value_t filter9_1 = HT2C5_FB(state[-2 + 17].value, state[-2 + 21].value, state[-2 + 23].value, state[-2 + 24].value);
+        const ht2c5_value_t filter9_2 = HT2C5_FB(state[-2 + 26].value, state[-2 + 30].value, state[-2 + 32].value, state[-2 + 35].value);
+        const ht2c5_value_t filter10_0 = HT2C5_FA(state[-2 + 12].value, state[-2 + 13].value, state[-2 + 15].value, state[-2 + 16].value);
+        const ht2c5_value_t filter11_0 = HT2C5_FA(state[-2 + 13].value, state[-2 + 14].value, state[-2 + 16].value, state[-2 + 17].value);
+        const ht2c5_value_t filter12_0 = HT2C5_FA(state[-2 + 14].value, state[-2 + 15].value, state[-2 + 17].value, state[-2 + 18].value);
+
+        for (uint16_t i2 = 0; i2 < (1 << (ht2c5_bits[2] + 1)); i2++) {
+            state[-2 + 10].value = ((bool)(i2 & 0x1)) ? t->ones.value : t->zeroes.value;
+            state[-2 + 19].value = ((bool)(i2 & 0x2)) ? t->ones.value : t->zeroes.value;
+            state[-2 + 25].value = ((bool)(i2 & 0x4)) ? t->ones.value : t->zeroes.value;
+            state[-2 + 36].value = ((bool)(i2 & 0x8)) ? t->ones.value : t->zeroes.value;
+            state[-2 + 49].value = ((bool)(i2 & 0x10)) ? t->ones.value : t->zeroes.value; // guess lfsr output 1
+            // 0xfe07fffbfdff
+            const ht2c5_value_t filter2_1 = HT2C5_FB(state[-2 + 10].value, state[-2 + 14].value, state[-2 + 16].value, state[-2 + 17].value);
+            const ht2c5_value_t filter2_2 = HT2C5_FB(state[-2 + 19].value, state[-2 + 23].value, state[-2 + 25].value, state[-2 + 28].value);
+            const ht2c5_value_t filter2_4 = HT2C5_FA(state[-2 + 36].value, state[-2 + 45].value, state[-2 + 46].value, state[-2 + 48].value);
+            const ht2c5_value_t filter2 = HT2C5_FC(filter2_0, filter2_1, filter2_2, filter2_3, filter2_4);
+            ht2c5_bitslice_t results2;
+            results2.value = results1.value & (filter2 ^ t->keystream[2].value);
+
+            if (results2.bytes64[0] == 0
+                    && results2.bytes64[1] == 0
+                    && results2.bytes64[2] == 0
+                    && results2.bytes64[3] == 0
+               ) {
+                continue;
+            }
+            state[-2 + 50].value = HT2C5_LFSR_BS(2);
+            const ht2c5_value_t filter3_3 = HT2C5_FB(state[-2 + 31].value, state[-2 + 32].value, state[-2 + 34].value, state[-2 + 36].value);
+            const ht2c5_value_t filter4_0 = HT2C5_FA(state[-2 + 6].value, state[-2 + 7].value, state[-2 + 9].value, state[-2 + 10].value);
+            const ht2c5_value_t filter4_1 = HT2C5_FB(state[-2 + 12].value, state[-2 + 16].value, state[-2 + 18].value, state[-2 + 19].value);
+            const ht2c5_value_t filter4_2 = HT2C5_FB(state[-2 + 21].value, state[-2 + 25].value, state[-2 + 27].value, state[-2 + 30].value);
+            const ht2c5_value_t filter7_0 = HT2C5_FA(state[-2 + 9].value, state[-2 + 10].value, state[-2 + 12].value, state[-2 + 13].value);
+            const ht2c5_value_t filter7_1 = HT2C5_FB(state[-2 + 15].value, state[-2 + 19].value, state[-2 + 21].value, state[-2 + 22].value);
+            const ht2c5_value_t filter8_2 = HT2C5_FB(state[-2 + 25].value, state[-2 + 29].value, state[-2 + 31].value, state[-2 + 34].value);
+            const ht2c5_value_t filter10_1 = HT2C5_FB(state[-2 + 18].value, state[-2 + 22].value, state[-2 + 24].value, state[-2 + 25].value);
+            const ht2c5_value_t filter10_2 = HT2C5_FB(state[-2 + 27].value, state[-2 + 31].value, state[-2 + 33].value, state[-2 + 36].value);
+            const ht2c5_value_t filter11_1 = HT2C5_FB(state[-2 + 19].value, state[-2 + 23].value, state[-2 + 25].value, state[-2 + 26].value);
+
+            for (uint8_t i3 = 0; i3 < (1 << ht2c5_bits[3]); i3++) {
+                state[-2 + 11].value = ((bool)(i3 & 0x1)) ? t->ones.value : t->zeroes.value;
+                state[-2 + 20].value = ((bool)(i3 & 0x2)) ? t->ones.value : t->zeroes.value;
+                state[-2 + 37].value = ((bool)(i3 & 0x4)) ? t->ones.value : t->zeroes.value;
+                // 0xff07ffffffff
+                const ht2c5_value_t filter3_1 = HT2C5_FB(state[-2 + 11].value, state[-2 + 15].value, state[-2 + 17].value, state[-2 + 18].value);
+                const ht2c5_value_t filter3_2 = HT2C5_FB(state[-2 + 20].value, state[-2 + 24].value, state[-2 + 26].value, state[-2 + 29].value);
+                const ht2c5_value_t filter3_4 = HT2C5_FA(state[-2 + 37].value, state[-2 + 46].value, state[-2 + 47].value, state[-2 + 49].value);
+                const ht2c5_value_t filter3 = HT2C5_FC(filter3_0, filter3_1, filter3_2, filter3_3, filter3_4);
+                ht2c5_bitslice_t results3;
+                results3.value = results2.value & (filter3 ^ t->keystream[3].value);
+
+                if (results3.bytes64[0] == 0
+                        && results3.bytes64[1] == 0
+                        && results3.bytes64[2] == 0
+                        && results3.bytes64[3] == 0
+                   ) {
+                    continue;
+                }
+
+                state[-2 + 51].value = HT2C5_LFSR_BS(3);
+                state[-2 + 52].value = HT2C5_LFSR_BS(4);
+                state[-2 + 53].value = HT2C5_LFSR_BS(5);
+                state[-2 + 54].value = HT2C5_LFSR_BS(6);
+                state[-2 + 55].value = HT2C5_LFSR_BS(7);
+                const ht2c5_value_t filter4_3 = HT2C5_FB(state[-2 + 32].value, state[-2 + 33].value, state[-2 + 35].value, state[-2 + 37].value);
+                const ht2c5_value_t filter5_0 = HT2C5_FA(state[-2 + 7].value, state[-2 + 8].value, state[-2 + 10].value, state[-2 + 11].value);
+                const ht2c5_value_t filter5_1 = HT2C5_FB(state[-2 + 13].value, state[-2 + 17].value, state[-2 + 19].value, state[-2 + 20].value);
+                const ht2c5_value_t filter6_0 = HT2C5_FA(state[-2 + 8].value, state[-2 + 9].value, state[-2 + 11].value, state[-2 + 12].value);
+                const ht2c5_value_t filter6_1 = HT2C5_FB(state[-2 + 14].value, state[-2 + 18].value, state[-2 + 20].value, state[-2 + 21].value);
+                const ht2c5_value_t filter8_0 = HT2C5_FA(state[-2 + 10].value, state[-2 + 11].value, state[-2 + 13].value, state[-2 + 14].value);
+                const ht2c5_value_t filter8_1 = HT2C5_FB(state[-2 + 16].value, state[-2 + 20].value, state[-2 + 22].value, state[-2 + 23].value);
+                const ht2c5_value_t filter9_0 = HT2C5_FA(state[-2 + 11].value, state[-2 + 12].value, state[-2 + 14].value, state[-2 + 15].value);
+                const ht2c5_value_t filter9_4 = HT2C5_FA(state[-2 + 43].value, state[-2 + 52].value, state[-2 + 53].value, state[-2 + 55].value);
+                const ht2c5_value_t filter11_2 = HT2C5_FB(state[-2 + 28].value, state[-2 + 32].value, state[-2 + 34].value, state[-2 + 37].value);
+                const ht2c5_value_t filter12_1 = HT2C5_FB(state[-2 + 20].value, state[-2 + 24].value, state[-2 + 26].value, state[-2 + 27].value);
+
+                for (uint8_t i4 = 0; i4 < (1 << ht2c5_bits[4]); i4++) {
+                    state[-2 + 38].value = ((bool)(i4 & 0x1)) ? t->ones.value : t->zeroes.value;
+                    // 0xff87ffffffff
+                    const ht2c5_value_t filter4_4 = HT2C5_FA(state[-2 + 38].value, state[-2 + 47].value, state[-2 + 48].value, state[-2 + 50].value);
+                    const ht2c5_value_t filter4 = HT2C5_FC(filter4_0, filter4_1, filter4_2, filter4_3, filter4_4);
+                    ht2c5_bitslice_t results4;
+                    results4.value = results3.value & (filter4 ^ t->keystream[4].value);
+                    if (results4.bytes64[0] == 0
+                            && results4.bytes64[1] == 0
+                            && results4.bytes64[2] == 0
+                            && results4.bytes64[3] == 0
+                       ) {
+                        continue;
+                    }
+
+                    state[-2 + 56].value = HT2C5_LFSR_BS(8);
+                    const ht2c5_value_t filter5_3 = HT2C5_FB(state[-2 + 33].value, state[-2 + 34].value, state[-2 + 36].value, state[-2 + 38].value);
+                    const ht2c5_value_t filter10_4 = HT2C5_FA(state[-2 + 44].value, state[-2 + 53].value, state[-2 + 54].value, state[-2 + 56].value);
+                    const ht2c5_value_t filter12_2 = HT2C5_FB(state[-2 + 29].value, state[-2 + 33].value, state[-2 + 35].value, state[-2 + 38].value);
+
+                    for (uint8_t i5 = 0; i5 < (1 << ht2c5_bits[5]); i5++) {
+                        state[-2 + 39].value = ((bool)(i5 & 0x1)) ? t->ones.value : t->zeroes.value;
+                        // 0xffc7ffffffff
+                        const ht2c5_value_t filter5_4 = HT2C5_FA(state[-2 + 39].value, state[-2 + 48].value, state[-2 + 49].value, state[-2 + 51].value);
+                        const ht2c5_value_t filter5 = HT2C5_FC(filter5_0, filter5_1, filter5_2, filter5_3, filter5_4);
+                        ht2c5_bitslice_t results5;
+                        results5.value = results4.value & (filter5 ^ t->keystream[5].value);
+
+                        if (results5.bytes64[0] == 0
+                                && results5.bytes64[1] == 0
+                                && results5.bytes64[2] == 0
+                                && results5.bytes64[3] == 0
+                           ) {
+                            continue;
+                        }
+
+                        state[-2 + 57].value = HT2C5_LFSR_BS(9);
+                        const ht2c5_value_t filter6_3 = HT2C5_FB(state[-2 + 34].value, state[-2 + 35].value, state[-2 + 37].value, state[-2 + 39].value);
+                        const ht2c5_value_t filter11_4 = HT2C5_FA(state[-2 + 45].value, state[-2 + 54].value, state[-2 + 55].value, state[-2 + 57].value);
+                        for (uint8_t i6 = 0; i6 < (1 << ht2c5_bits[6]); i6++) {
+                            state[-2 + 40].value = ((bool)(i6 & 0x1)) ? t->ones.value : t->zeroes.value;
+                            // 0xffe7ffffffff
+                            const ht2c5_value_t filter6_4 = HT2C5_FA(state[-2 + 40].value, state[-2 + 49].value, state[-2 + 50].value, state[-2 + 52].value);
+                            const ht2c5_value_t filter6 = HT2C5_FC(filter6_0, filter6_1, filter6_2, filter6_3, filter6_4);
+                            ht2c5_bitslice_t results6;
+                            results6.value = results5.value & (filter6 ^ t->keystream[6].value);
+
+                            if (results6.bytes64[0] == 0
+                                    && results6.bytes64[1] == 0
+                                    && results6.bytes64[2] == 0
+                                    && results6.bytes64[3] == 0
+                               ) {
+                                continue;
+                            }
+
+                            state[-2 + 58].value = HT2C5_LFSR_BS(10);
+                            const ht2c5_value_t filter7_3 = HT2C5_FB(state[-2 + 35].value, state[-2 + 36].value, state[-2 + 38].value, state[-2 + 40].value);
+                            const ht2c5_value_t filter12_4 = HT2C5_FA(state[-2 + 46].value, state[-2 + 55].value, state[-2 + 56].value, state[-2 + 58].value);
+                            for (uint8_t i7 = 0; i7 < (1 << ht2c5_bits[7]); i7++) {
+                                state[-2 + 41].value = ((bool)(i7 & 0x1)) ? t->ones.value : t->zeroes.value;
+                                // 0xfff7ffffffff
+                                const ht2c5_value_t filter7_4 = HT2C5_FA(state[-2 + 41].value, state[-2 + 50].value, state[-2 + 51].value, state[-2 + 53].value);
+                                const ht2c5_value_t filter7 = HT2C5_FC(filter7_0, filter7_1, filter7_2, filter7_3, filter7_4);
+                                ht2c5_bitslice_t results7;
+                                results7.value = results6.value & (filter7 ^ t->keystream[7].value);
+                                if (results7.bytes64[0] == 0
+                                        && results7.bytes64[1] == 0
+                                        && results7.bytes64[2] == 0
+                                        && results7.bytes64[3] == 0
+                                   ) {
+                                    continue;
+                                }
+
+                                state[-2 + 59].value = HT2C5_LFSR_BS(11);
+                                const ht2c5_value_t filter8_3 = HT2C5_FB(state[-2 + 36].value, state[-2 + 37].value, state[-2 + 39].value, state[-2 + 41].value);
+                                const ht2c5_value_t filter10_3 = HT2C5_FB(state[-2 + 38].value, state[-2 + 39].value, state[-2 + 41].value, state[-2 + 43].value);
+                                const ht2c5_value_t filter12_3 = HT2C5_FB(state[-2 + 40].value, state[-2 + 41].value, state[-2 + 43].value, state[-2 + 45].value);
+                                for (uint8_t i8 = 0; i8 < (1 << ht2c5_bits[8]); i8++) {
+                                    state[-2 + 42].value = ((bool)(i8 & 0x1)) ? t->ones.value : t->zeroes.value;
+                                    // 0xffffffffffff
+                                    const ht2c5_value_t filter8_4 = HT2C5_FA(state[-2 + 42].value, state[-2 + 51].value, state[-2 + 52].value, state[-2 + 54].value);
+                                    const ht2c5_value_t filter8 = HT2C5_FC(filter8_0, filter8_1, filter8_2, filter8_3, filter8_4);
+                                    ht2c5_bitslice_t results8;
+                                    results8.value = results7.value & (filter8 ^ t->keystream[8].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    const ht2c5_value_t filter9_3 = HT2C5_FB(state[-2 + 37].value, state[-2 + 38].value, state[-2 + 40].value, state[-2 + 42].value);
+                                    const ht2c5_value_t filter9 = HT2C5_FC(filter9_0, filter9_1, filter9_2, filter9_3, filter9_4);
+                                    results8.value &= (filter9 ^ t->keystream[9].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    const ht2c5_value_t filter10 = HT2C5_FC(filter10_0, filter10_1, filter10_2, filter10_3, filter10_4);
+                                    results8.value &= (filter10 ^ t->keystream[10].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    const ht2c5_value_t filter11_3 = HT2C5_FB(state[-2 + 39].value, state[-2 + 40].value, state[-2 + 42].value, state[-2 + 44].value);
+                                    const ht2c5_value_t filter11 = HT2C5_FC(filter11_0, filter11_1, filter11_2, filter11_3, filter11_4);
+                                    results8.value &= (filter11 ^ t->keystream[11].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    const ht2c5_value_t filter12 = HT2C5_FC(filter12_0, filter12_1, filter12_2, filter12_3, filter12_4);
+                                    results8.value &= (filter12 ^ t->keystream[12].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    const ht2c5_value_t filter13_0 = HT2C5_FA(state[-2 + 15].value, state[-2 + 16].value, state[-2 + 18].value, state[-2 + 19].value);
+                                    const ht2c5_value_t filter13_1 = HT2C5_FB(state[-2 + 21].value, state[-2 + 25].value, state[-2 + 27].value, state[-2 + 28].value);
+                                    const ht2c5_value_t filter13_2 = HT2C5_FB(state[-2 + 30].value, state[-2 + 34].value, state[-2 + 36].value, state[-2 + 39].value);
+                                    const ht2c5_value_t filter13_3 = HT2C5_FB(state[-2 + 41].value, state[-2 + 42].value, state[-2 + 44].value, state[-2 + 46].value);
+                                    const ht2c5_value_t filter13_4 = HT2C5_FA(state[-2 + 47].value, state[-2 + 56].value, state[-2 + 57].value, state[-2 + 59].value);
+                                    const ht2c5_value_t filter13 = HT2C5_FC(filter13_0, filter13_1, filter13_2, filter13_3, filter13_4);
+                                    results8.value &= (filter13 ^ t->keystream[13].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 60].value = HT2C5_LFSR_BS(12);
+                                    const ht2c5_value_t filter14_0 = HT2C5_FA(state[-2 + 16].value, state[-2 + 17].value, state[-2 + 19].value, state[-2 + 20].value);
+                                    const ht2c5_value_t filter14_1 = HT2C5_FB(state[-2 + 22].value, state[-2 + 26].value, state[-2 + 28].value, state[-2 + 29].value);
+                                    const ht2c5_value_t filter14_2 = HT2C5_FB(state[-2 + 31].value, state[-2 + 35].value, state[-2 + 37].value, state[-2 + 40].value);
+                                    const ht2c5_value_t filter14_3 = HT2C5_FB(state[-2 + 42].value, state[-2 + 43].value, state[-2 + 45].value, state[-2 + 47].value);
+                                    const ht2c5_value_t filter14_4 = HT2C5_FA(state[-2 + 48].value, state[-2 + 57].value, state[-2 + 58].value, state[-2 + 60].value);
+                                    const ht2c5_value_t filter14 = HT2C5_FC(filter14_0, filter14_1, filter14_2, filter14_3, filter14_4);
+                                    results8.value &= (filter14 ^ t->keystream[14].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 61].value = HT2C5_LFSR_BS(13);
+                                    const ht2c5_value_t filter15_0 = HT2C5_FA(state[-2 + 17].value, state[-2 + 18].value, state[-2 + 20].value, state[-2 + 21].value);
+                                    const ht2c5_value_t filter15_1 = HT2C5_FB(state[-2 + 23].value, state[-2 + 27].value, state[-2 + 29].value, state[-2 + 30].value);
+                                    const ht2c5_value_t filter15_2 = HT2C5_FB(state[-2 + 32].value, state[-2 + 36].value, state[-2 + 38].value, state[-2 + 41].value);
+                                    const ht2c5_value_t filter15_3 = HT2C5_FB(state[-2 + 43].value, state[-2 + 44].value, state[-2 + 46].value, state[-2 + 48].value);
+                                    const ht2c5_value_t filter15_4 = HT2C5_FA(state[-2 + 49].value, state[-2 + 58].value, state[-2 + 59].value, state[-2 + 61].value);
+                                    const ht2c5_value_t filter15 = HT2C5_FC(filter15_0, filter15_1, filter15_2, filter15_3, filter15_4);
+                                    results8.value &= (filter15 ^ t->keystream[15].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 62].value = HT2C5_LFSR_BS(14);
+                                    const ht2c5_value_t filter16_0 = HT2C5_FA(state[-2 + 18].value, state[-2 + 19].value, state[-2 + 21].value, state[-2 + 22].value);
+                                    const ht2c5_value_t filter16_1 = HT2C5_FB(state[-2 + 24].value, state[-2 + 28].value, state[-2 + 30].value, state[-2 + 31].value);
+                                    const ht2c5_value_t filter16_2 = HT2C5_FB(state[-2 + 33].value, state[-2 + 37].value, state[-2 + 39].value, state[-2 + 42].value);
+                                    const ht2c5_value_t filter16_3 = HT2C5_FB(state[-2 + 44].value, state[-2 + 45].value, state[-2 + 47].value, state[-2 + 49].value);
+                                    const ht2c5_value_t filter16_4 = HT2C5_FA(state[-2 + 50].value, state[-2 + 59].value, state[-2 + 60].value, state[-2 + 62].value);
+                                    const ht2c5_value_t filter16 = HT2C5_FC(filter16_0, filter16_1, filter16_2, filter16_3, filter16_4);
+                                    results8.value &= (filter16 ^ t->keystream[16].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 63].value = HT2C5_LFSR_BS(15);
+                                    const ht2c5_value_t filter17_0 = HT2C5_FA(state[-2 + 19].value, state[-2 + 20].value, state[-2 + 22].value, state[-2 + 23].value);
+                                    const ht2c5_value_t filter17_1 = HT2C5_FB(state[-2 + 25].value, state[-2 + 29].value, state[-2 + 31].value, state[-2 + 32].value);
+                                    const ht2c5_value_t filter17_2 = HT2C5_FB(state[-2 + 34].value, state[-2 + 38].value, state[-2 + 40].value, state[-2 + 43].value);
+                                    const ht2c5_value_t filter17_3 = HT2C5_FB(state[-2 + 45].value, state[-2 + 46].value, state[-2 + 48].value, state[-2 + 50].value);
+                                    const ht2c5_value_t filter17_4 = HT2C5_FA(state[-2 + 51].value, state[-2 + 60].value, state[-2 + 61].value, state[-2 + 63].value);
+                                    const ht2c5_value_t filter17 = HT2C5_FC(filter17_0, filter17_1, filter17_2, filter17_3, filter17_4);
+                                    results8.value &= (filter17 ^ t->keystream[17].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 64].value = HT2C5_LFSR_BS(16);
+                                    const ht2c5_value_t filter18_0 = HT2C5_FA(state[-2 + 20].value, state[-2 + 21].value, state[-2 + 23].value, state[-2 + 24].value);
+                                    const ht2c5_value_t filter18_1 = HT2C5_FB(state[-2 + 26].value, state[-2 + 30].value, state[-2 + 32].value, state[-2 + 33].value);
+                                    const ht2c5_value_t filter18_2 = HT2C5_FB(state[-2 + 35].value, state[-2 + 39].value, state[-2 + 41].value, state[-2 + 44].value);
+                                    const ht2c5_value_t filter18_3 = HT2C5_FB(state[-2 + 46].value, state[-2 + 47].value, state[-2 + 49].value, state[-2 + 51].value);
+                                    const ht2c5_value_t filter18_4 = HT2C5_FA(state[-2 + 52].value, state[-2 + 61].value, state[-2 + 62].value, state[-2 + 64].value);
+                                    const ht2c5_value_t filter18 = HT2C5_FC(filter18_0, filter18_1, filter18_2, filter18_3, filter18_4);
+                                    results8.value &= (filter18 ^ t->keystream[18].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 65].value = HT2C5_LFSR_BS(17);
+                                    const ht2c5_value_t filter19_0 = HT2C5_FA(state[-2 + 21].value, state[-2 + 22].value, state[-2 + 24].value, state[-2 + 25].value);
+                                    const ht2c5_value_t filter19_1 = HT2C5_FB(state[-2 + 27].value, state[-2 + 31].value, state[-2 + 33].value, state[-2 + 34].value);
+                                    const ht2c5_value_t filter19_2 = HT2C5_FB(state[-2 + 36].value, state[-2 + 40].value, state[-2 + 42].value, state[-2 + 45].value);
+                                    const ht2c5_value_t filter19_3 = HT2C5_FB(state[-2 + 47].value, state[-2 + 48].value, state[-2 + 50].value, state[-2 + 52].value);
+                                    const ht2c5_value_t filter19_4 = HT2C5_FA(state[-2 + 53].value, state[-2 + 62].value, state[-2 + 63].value, state[-2 + 65].value);
+                                    const ht2c5_value_t filter19 = HT2C5_FC(filter19_0, filter19_1, filter19_2, filter19_3, filter19_4);
+                                    results8.value &= (filter19 ^ t->keystream[19].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 66].value = HT2C5_LFSR_BS(18);
+                                    const ht2c5_value_t filter20_0 = HT2C5_FA(state[-2 + 22].value, state[-2 + 23].value, state[-2 + 25].value, state[-2 + 26].value);
+                                    const ht2c5_value_t filter20_1 = HT2C5_FB(state[-2 + 28].value, state[-2 + 32].value, state[-2 + 34].value, state[-2 + 35].value);
+                                    const ht2c5_value_t filter20_2 = HT2C5_FB(state[-2 + 37].value, state[-2 + 41].value, state[-2 + 43].value, state[-2 + 46].value);
+                                    const ht2c5_value_t filter20_3 = HT2C5_FB(state[-2 + 48].value, state[-2 + 49].value, state[-2 + 51].value, state[-2 + 53].value);
+                                    const ht2c5_value_t filter20_4 = HT2C5_FA(state[-2 + 54].value, state[-2 + 63].value, state[-2 + 64].value, state[-2 + 66].value);
+                                    const ht2c5_value_t filter20 = HT2C5_FC(filter20_0, filter20_1, filter20_2, filter20_3, filter20_4);
+                                    results8.value &= (filter20 ^ t->keystream[20].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 67].value = HT2C5_LFSR_BS(19);
+                                    const ht2c5_value_t filter21_0 = HT2C5_FA(state[-2 + 23].value, state[-2 + 24].value, state[-2 + 26].value, state[-2 + 27].value);
+                                    const ht2c5_value_t filter21_1 = HT2C5_FB(state[-2 + 29].value, state[-2 + 33].value, state[-2 + 35].value, state[-2 + 36].value);
+                                    const ht2c5_value_t filter21_2 = HT2C5_FB(state[-2 + 38].value, state[-2 + 42].value, state[-2 + 44].value, state[-2 + 47].value);
+                                    const ht2c5_value_t filter21_3 = HT2C5_FB(state[-2 + 49].value, state[-2 + 50].value, state[-2 + 52].value, state[-2 + 54].value);
+                                    const ht2c5_value_t filter21_4 = HT2C5_FA(state[-2 + 55].value, state[-2 + 64].value, state[-2 + 65].value, state[-2 + 67].value);
+                                    const ht2c5_value_t filter21 = HT2C5_FC(filter21_0, filter21_1, filter21_2, filter21_3, filter21_4);
+                                    results8.value &= (filter21 ^ t->keystream[21].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 68].value = HT2C5_LFSR_BS(20);
+                                    const ht2c5_value_t filter22_0 = HT2C5_FA(state[-2 + 24].value, state[-2 + 25].value, state[-2 + 27].value, state[-2 + 28].value);
+                                    const ht2c5_value_t filter22_1 = HT2C5_FB(state[-2 + 30].value, state[-2 + 34].value, state[-2 + 36].value, state[-2 + 37].value);
+                                    const ht2c5_value_t filter22_2 = HT2C5_FB(state[-2 + 39].value, state[-2 + 43].value, state[-2 + 45].value, state[-2 + 48].value);
+                                    const ht2c5_value_t filter22_3 = HT2C5_FB(state[-2 + 50].value, state[-2 + 51].value, state[-2 + 53].value, state[-2 + 55].value);
+                                    const ht2c5_value_t filter22_4 = HT2C5_FA(state[-2 + 56].value, state[-2 + 65].value, state[-2 + 66].value, state[-2 + 68].value);
+                                    const ht2c5_value_t filter22 = HT2C5_FC(filter22_0, filter22_1, filter22_2, filter22_3, filter22_4);
+                                    results8.value &= (filter22 ^ t->keystream[22].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 69].value = HT2C5_LFSR_BS(21);
+                                    const ht2c5_value_t filter23_0 = HT2C5_FA(state[-2 + 25].value, state[-2 + 26].value, state[-2 + 28].value, state[-2 + 29].value);
+                                    const ht2c5_value_t filter23_1 = HT2C5_FB(state[-2 + 31].value, state[-2 + 35].value, state[-2 + 37].value, state[-2 + 38].value);
+                                    const ht2c5_value_t filter23_2 = HT2C5_FB(state[-2 + 40].value, state[-2 + 44].value, state[-2 + 46].value, state[-2 + 49].value);
+                                    const ht2c5_value_t filter23_3 = HT2C5_FB(state[-2 + 51].value, state[-2 + 52].value, state[-2 + 54].value, state[-2 + 56].value);
+                                    const ht2c5_value_t filter23_4 = HT2C5_FA(state[-2 + 57].value, state[-2 + 66].value, state[-2 + 67].value, state[-2 + 69].value);
+                                    const ht2c5_value_t filter23 = HT2C5_FC(filter23_0, filter23_1, filter23_2, filter23_3, filter23_4);
+                                    results8.value &= (filter23 ^ t->keystream[23].value);
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+                                    state[-2 + 70].value = HT2C5_LFSR_BS(22);
+                                    const ht2c5_value_t filter24_0 = HT2C5_FA(state[-2 + 26].value, state[-2 + 27].value, state[-2 + 29].value, state[-2 + 30].value);
+                                    const ht2c5_value_t filter24_1 = HT2C5_FB(state[-2 + 32].value, state[-2 + 36].value, state[-2 + 38].value, state[-2 + 39].value);
+                                    const ht2c5_value_t filter24_2 = HT2C5_FB(state[-2 + 41].value, state[-2 + 45].value, state[-2 + 47].value, state[-2 + 50].value);
+                                    const ht2c5_value_t filter24_3 = HT2C5_FB(state[-2 + 52].value, state[-2 + 53].value, state[-2 + 55].value, state[-2 + 57].value);
+                                    const ht2c5_value_t filter24_4 = HT2C5_FA(state[-2 + 58].value, state[-2 + 67].value, state[-2 + 68].value, state[-2 + 70].value);
+                                    const ht2c5_value_t filter24 = HT2C5_FC(filter24_0, filter24_1, filter24_2, filter24_3, filter24_4);
+                                    results8.value &= (filter24 ^ t->keystream[24].value);
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+                                    state[-2 + 71].value = HT2C5_LFSR_BS(23);
+                                    const ht2c5_value_t filter25_0 = HT2C5_FA(state[-2 + 27].value, state[-2 + 28].value, state[-2 + 30].value, state[-2 + 31].value);
+                                    const ht2c5_value_t filter25_1 = HT2C5_FB(state[-2 + 33].value, state[-2 + 37].value, state[-2 + 39].value, state[-2 + 40].value);
+                                    const ht2c5_value_t filter25_2 = HT2C5_FB(state[-2 + 42].value, state[-2 + 46].value, state[-2 + 48].value, state[-2 + 51].value);
+                                    const ht2c5_value_t filter25_3 = HT2C5_FB(state[-2 + 53].value, state[-2 + 54].value, state[-2 + 56].value, state[-2 + 58].value);
+                                    const ht2c5_value_t filter25_4 = HT2C5_FA(state[-2 + 59].value, state[-2 + 68].value, state[-2 + 69].value, state[-2 + 71].value);
+                                    const ht2c5_value_t filter25 = HT2C5_FC(filter25_0, filter25_1, filter25_2, filter25_3, filter25_4);
+                                    results8.value &= (filter25 ^ t->keystream[25].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 72].value = HT2C5_LFSR_BS(24);
+                                    const ht2c5_value_t filter26_0 = HT2C5_FA(state[-2 + 28].value, state[-2 + 29].value, state[-2 + 31].value, state[-2 + 32].value);
+                                    const ht2c5_value_t filter26_1 = HT2C5_FB(state[-2 + 34].value, state[-2 + 38].value, state[-2 + 40].value, state[-2 + 41].value);
+                                    const ht2c5_value_t filter26_2 = HT2C5_FB(state[-2 + 43].value, state[-2 + 47].value, state[-2 + 49].value, state[-2 + 52].value);
+                                    const ht2c5_value_t filter26_3 = HT2C5_FB(state[-2 + 54].value, state[-2 + 55].value, state[-2 + 57].value, state[-2 + 59].value);
+                                    const ht2c5_value_t filter26_4 = HT2C5_FA(state[-2 + 60].value, state[-2 + 69].value, state[-2 + 70].value, state[-2 + 72].value);
+                                    const ht2c5_value_t filter26 = HT2C5_FC(filter26_0, filter26_1, filter26_2, filter26_3, filter26_4);
+                                    results8.value &= (filter26 ^ t->keystream[26].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 73].value = HT2C5_LFSR_BS(25);
+                                    const ht2c5_value_t filter27_0 = HT2C5_FA(state[-2 + 29].value, state[-2 + 30].value, state[-2 + 32].value, state[-2 + 33].value);
+                                    const ht2c5_value_t filter27_1 = HT2C5_FB(state[-2 + 35].value, state[-2 + 39].value, state[-2 + 41].value, state[-2 + 42].value);
+                                    const ht2c5_value_t filter27_2 = HT2C5_FB(state[-2 + 44].value, state[-2 + 48].value, state[-2 + 50].value, state[-2 + 53].value);
+                                    const ht2c5_value_t filter27_3 = HT2C5_FB(state[-2 + 55].value, state[-2 + 56].value, state[-2 + 58].value, state[-2 + 60].value);
+                                    const ht2c5_value_t filter27_4 = HT2C5_FA(state[-2 + 61].value, state[-2 + 70].value, state[-2 + 71].value, state[-2 + 73].value);
+                                    const ht2c5_value_t filter27 = HT2C5_FC(filter27_0, filter27_1, filter27_2, filter27_3, filter27_4);
+                                    results8.value &= (filter27 ^ t->keystream[27].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 74].value = HT2C5_LFSR_BS(26);
+                                    const ht2c5_value_t filter28_0 = HT2C5_FA(state[-2 + 30].value, state[-2 + 31].value, state[-2 + 33].value, state[-2 + 34].value);
+                                    const ht2c5_value_t filter28_1 = HT2C5_FB(state[-2 + 36].value, state[-2 + 40].value, state[-2 + 42].value, state[-2 + 43].value);
+                                    const ht2c5_value_t filter28_2 = HT2C5_FB(state[-2 + 45].value, state[-2 + 49].value, state[-2 + 51].value, state[-2 + 54].value);
+                                    const ht2c5_value_t filter28_3 = HT2C5_FB(state[-2 + 56].value, state[-2 + 57].value, state[-2 + 59].value, state[-2 + 61].value);
+                                    const ht2c5_value_t filter28_4 = HT2C5_FA(state[-2 + 62].value, state[-2 + 71].value, state[-2 + 72].value, state[-2 + 74].value);
+                                    const ht2c5_value_t filter28 = HT2C5_FC(filter28_0, filter28_1, filter28_2, filter28_3, filter28_4);
+                                    results8.value &= (filter28 ^ t->keystream[28].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 75].value = HT2C5_LFSR_BS(27);
+                                    const ht2c5_value_t filter29_0 = HT2C5_FA(state[-2 + 31].value, state[-2 + 32].value, state[-2 + 34].value, state[-2 + 35].value);
+                                    const ht2c5_value_t filter29_1 = HT2C5_FB(state[-2 + 37].value, state[-2 + 41].value, state[-2 + 43].value, state[-2 + 44].value);
+                                    const ht2c5_value_t filter29_2 = HT2C5_FB(state[-2 + 46].value, state[-2 + 50].value, state[-2 + 52].value, state[-2 + 55].value);
+                                    const ht2c5_value_t filter29_3 = HT2C5_FB(state[-2 + 57].value, state[-2 + 58].value, state[-2 + 60].value, state[-2 + 62].value);
+                                    const ht2c5_value_t filter29_4 = HT2C5_FA(state[-2 + 63].value, state[-2 + 72].value, state[-2 + 73].value, state[-2 + 75].value);
+                                    const ht2c5_value_t filter29 = HT2C5_FC(filter29_0, filter29_1, filter29_2, filter29_3, filter29_4);
+                                    results8.value &= (filter29 ^ t->keystream[29].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 76].value = HT2C5_LFSR_BS(28);
+                                    const ht2c5_value_t filter30_0 = HT2C5_FA(state[-2 + 32].value, state[-2 + 33].value, state[-2 + 35].value, state[-2 + 36].value);
+                                    const ht2c5_value_t filter30_1 = HT2C5_FB(state[-2 + 38].value, state[-2 + 42].value, state[-2 + 44].value, state[-2 + 45].value);
+                                    const ht2c5_value_t filter30_2 = HT2C5_FB(state[-2 + 47].value, state[-2 + 51].value, state[-2 + 53].value, state[-2 + 56].value);
+                                    const ht2c5_value_t filter30_3 = HT2C5_FB(state[-2 + 58].value, state[-2 + 59].value, state[-2 + 61].value, state[-2 + 63].value);
+                                    const ht2c5_value_t filter30_4 = HT2C5_FA(state[-2 + 64].value, state[-2 + 73].value, state[-2 + 74].value, state[-2 + 76].value);
+                                    const ht2c5_value_t filter30 = HT2C5_FC(filter30_0, filter30_1, filter30_2, filter30_3, filter30_4);
+                                    results8.value &= (filter30 ^ t->keystream[30].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    state[-2 + 77].value = HT2C5_LFSR_BS(29);
+                                    const ht2c5_value_t filter31_0 = HT2C5_FA(state[-2 + 33].value, state[-2 + 34].value, state[-2 + 36].value, state[-2 + 37].value);
+                                    const ht2c5_value_t filter31_1 = HT2C5_FB(state[-2 + 39].value, state[-2 + 43].value, state[-2 + 45].value, state[-2 + 46].value);
+                                    const ht2c5_value_t filter31_2 = HT2C5_FB(state[-2 + 48].value, state[-2 + 52].value, state[-2 + 54].value, state[-2 + 57].value);
+                                    const ht2c5_value_t filter31_3 = HT2C5_FB(state[-2 + 59].value, state[-2 + 60].value, state[-2 + 62].value, state[-2 + 64].value);
+                                    const ht2c5_value_t filter31_4 = HT2C5_FA(state[-2 + 65].value, state[-2 + 74].value, state[-2 + 75].value, state[-2 + 77].value);
+                                    const ht2c5_value_t filter31 = HT2C5_FC(filter31_0, filter31_1, filter31_2, filter31_3, filter31_4);
+                                    results8.value &= (filter31 ^ t->keystream[31].value);
+
+                                    if (results8.bytes64[0] == 0
+                                            && results8.bytes64[1] == 0
+                                            && results8.bytes64[2] == 0
+                                            && results8.bytes64[3] == 0
+                                       ) {
+                                        continue;
+                                    }
+
+                                    for (size_t r = 0; r < HT2C5_BITSLICES; r++) {
+                                        if (HT2C5_VECTOR_BIT(r, results8) == 0) {
+                                            continue;
+                                        }
+                                        // take the state from layer 2 so we can recover the lowest 2 bits by inverting the LFSR
+                                        uint64_t state31 = ht2c5_unbitslice(&state[-2 + 2], r, 48);
+                                        state31 = HT2C5_LFSR_INV(state31);
+                                        state31 = HT2C5_LFSR_INV(state31);
+                                        if (ht2c5_try_state(ctx, state31 & ((1ull << 48) - 1))) {
+                                            return true;
+                                        }
+                                    }
+                                } // 8
+                            } // 7
+                        } // 6
+                    } // 5
+                } // 4
+            } // 3
+        } // 2
+    } // 1
+    return false;
+}
+
+#undef HT2C5_FA
+#undef HT2C5_FB
+#undef HT2C5_FC
+#undef HT2C5_LFSR_BS
+#undef HT2C5_FN
+
+#endif
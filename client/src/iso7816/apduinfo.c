@@ -473,14 +473,16 @@ int APDUEncode(APDU_t *apdu, uint8_t *data, int *len) {
 
     if (apdu->le) {
         if (apdu->extended_apdu) {
-            if (apdu->le != 0x10000) {
+            // the leading 00 is only there when no extended Lc came before
+            if (apdu->lc == 0) {
                 data[dptr++] = 0x00;
+            }
+            if (apdu->le != 0x10000) {
                 data[dptr++] = (apdu->le >> 8) & 0xff;
                 data[dptr++] = (apdu->le) & 0xff;
             } else {
                 data[dptr++] = 0x00;
                 data[dptr++] = 0x00;
-                data[dptr++] = 0x00;
             }
         } else {
             if (apdu->le != 0x100)
@@ -496,7 +498,7 @@ int APDUEncode(APDU_t *apdu, uint8_t *data, int *len) {
 }
 
 int APDUEncodeS(sAPDU_t *sapdu, bool extended, uint16_t le, uint8_t *data, int *len) {
-    if (extended && le > 0x100)
+    if (extended == false && le > 0x100)
         return 10;
 
     APDU_t apdu;
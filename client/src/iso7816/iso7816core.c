@@ -80,9 +80,9 @@ int Iso7816Connect(Iso7816CommandChannel channel) {
     return res;
 }
 
-int Iso7816ExchangeEx(Iso7816CommandChannel channel, bool activate_field, bool leave_field_on,
-                      sAPDU_t apdu, bool include_le, uint16_t le, uint8_t *result,
-                      size_t max_result_len, size_t *result_len, uint16_t *sw) {
+static int Iso7816ExchangeApdu(Iso7816CommandChannel channel, bool activate_field, bool leave_field_on,
+                               sAPDU_t apdu, bool extended, uint16_t le, uint8_t *result,
+                               size_t max_result_len, size_t *result_len, uint16_t *sw) {
 
     *result_len = 0;
     if (sw) {
@@ -94,18 +94,10 @@ int Iso7816ExchangeEx(Iso7816CommandChannel channel, bool activate_field, bool l
         msleep(50);
     }
 
-    // COMPUTE APDU
+    // COMPUTE APDU, extended Lc and Le take two more bytes each
     int datalen = 0;
-    if (include_le) {
-        if (le == 0) {
-            le = 0x100;
-        }
-    } else {
-        le = 0;
-    }
-
-    uint8_t data[APDU_RES_LEN] = {0};
-    if (APDUEncodeS(&apdu, false, le, data, &datalen)) {
+    uint8_t data[APDU_RES_LEN + 4] = {0};
+    if (APDUEncodeS(&apdu, extended, le, data, &datalen)) {
         PrintAndLogEx(ERR, "APDU encoding error.");
         return 201;
     }
@@ -191,6 +183,26 @@ int Iso7816ExchangeEx(Iso7816CommandChannel channel, bool activate_field, bool l
     return PM3_SUCCESS;
 }
 
+int Iso7816ExchangeEx(Iso7816CommandChannel channel, bool activate_field, bool leave_field_on,
+                      sAPDU_t apdu, bool include_le, uint16_t le, uint8_t *result,
+                      size_t max_result_len, size_t *result_len, uint16_t *sw) {
+
+    if (include_le) {
+        if (le == 0) {
+            le = 0x100;
+        }
+    } else {
+        le = 0;
+    }
+
+    return Iso7816ExchangeApdu(channel, activate_field, leave_field_on, apdu, false, le, result, max_result_len, result_len, sw);
+}
+
+int Iso7816ExchangeExtended(Iso7816CommandChannel channel, bool leave_field_on, sAPDU_t apdu, uint16_t le,
+                            uint8_t *result, size_t max_result_len, size_t *result_len, uint16_t *sw) {
+    return Iso7816ExchangeApdu(channel, false, leave_field_on, apdu, true, le, result, max_result_len, result_len, sw);
+}
+
 int Iso7816Exchange(Iso7816CommandChannel channel, bool leave_field_on, sAPDU_t apdu, uint8_t *result, size_t max_result_len, size_t *result_len, uint16_t *sw) {
     return Iso7816ExchangeEx(channel
                              , false
@@ -55,6 +55,11 @@ int Iso7816Exchange(Iso7816CommandChannel channel, bool leave_field_on, sAPDU_t
 int Iso7816ExchangeEx(Iso7816CommandChannel channel, bool activate_field, bool leave_field_on, sAPDU_t apdu, bool include_le,
                       uint16_t le, uint8_t *result,  size_t max_result_len, size_t *result_len, uint16_t *sw);
 
+// extended length APDU (ISO 7816-4 5.1), 3 byte Lc when there is data and 2 / 3 byte Le.
+// The chip has to announce support for it, in its ATR / ATS historical bytes or EF.ATR/INFO
+int Iso7816ExchangeExtended(Iso7816CommandChannel channel, bool leave_field_on, sAPDU_t apdu, uint16_t le,
+                            uint8_t *result, size_t max_result_len, size_t *result_len, uint16_t *sw);
+
 // search application
 int Iso7816Select(Iso7816CommandChannel channel, bool activate_field, bool leave_field_on, uint8_t *aid, size_t aid_len,
                   uint8_t *result, size_t max_result_len, size_t *result_len, uint16_t *sw);
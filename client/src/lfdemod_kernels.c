@@ -0,0 +1,402 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Sample scanning kernels of common/lfdemod.c, scalar, SSE2, AVX2 and NEON
+//-----------------------------------------------------------------------------
+
+#include "lfdemod_kernels.h"
+
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include "commonutil.h"     // MIN, MAX, ARRAYLEN
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LFK_HAVE_X86 1
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define LFK_HAVE_NEON 1
+#endif
+
+//-----------------------------------------------------------------------------
+// scalar, the reference and the tails of the vector kernels
+//-----------------------------------------------------------------------------
+
+static size_t count_peaks_scalar(const uint8_t *s, size_t n, uint8_t hi, uint8_t lo) {
+    size_t cnt = 0;
+    for (size_t i = 0; i < n; i++) {
+        cnt += (s[i] >= hi || s[i] <= lo);
+    }
+    return cnt;
+}
+
+static void peak_miss_range(const uint8_t *s, size_t from, size_t n, uint8_t hi, uint8_t lo, uint8_t tol, uint8_t *miss) {
+    for (size_t i = MAX(from, (size_t)tol); i + tol < n; i++) {
+        bool pk = false;
+        for (size_t k = i - tol; k <= i + tol; k++) {
+            pk |= (s[k] >= hi || s[k] <= lo);
+        }
+        miss[i] = !pk;
+    }
+}
+
+static void peak_miss_scalar(const uint8_t *s, size_t n, uint8_t hi, uint8_t lo, uint8_t tol, uint8_t *miss) {
+    peak_miss_range(s, tol, n, hi, lo, tol, miss);
+}
+
+static void stride_sum_scalar(const uint8_t *miss, size_t count, size_t stride, size_t terms, uint32_t *out) {
+    for (size_t l = 0; l < count; l++) {
+        uint32_t acc = 0;
+        for (size_t t = 0; t < terms; t++) {
+            acc += miss[l + (t * stride)];
+        }
+        out[l] = acc;
+    }
+}
+
+static void threshold_scalar(uint8_t *s, size_t n, uint8_t level) {
+    for (size_t i = 0; i < n; i++) {
+        s[i] = (s[i] >= level);
+    }
+}
+
+static void offset_scalar(uint8_t *s, size_t n, int off) {
+    for (size_t i = 0; i < n; i++) {
+        int v = s[i] - off;
+        s[i] = (v < 0) ? 0 : (v > 255) ? 255 : v;
+    }
+}
+
+static size_t find_ge_scalar(const uint8_t *s, size_t from, size_t to, uint8_t v) {
+    while (from < to && s[from] < v) {
+        from++;
+    }
+    return from;
+}
+
+static size_t find_le_scalar(const uint8_t *s, size_t from, size_t to, uint8_t v) {
+    while (from < to && s[from] > v) {
+        from++;
+    }
+    return from;
+}
+
+static size_t find_ne_scalar(const uint8_t *s, size_t from, size_t to, uint8_t v) {
+    while (from < to && s[from] == v) {
+        from++;
+    }
+    return from;
+}
+
+static size_t find_rise_scalar(const uint8_t *s, size_t from, size_t to) {
+    while (from < to && s[from] <= s[from - 1]) {
+        from++;
+    }
+    return from;
+}
+
+static size_t find_top_scalar(const uint8_t *s, size_t from, size_t to, uint8_t fc) {
+    while (from < to && (s[from] + fc < s[from + 1] && s[from + 1] >= s[from + 2]) == false) {
+        from++;
+    }
+    return from;
+}
+
+static size_t pair_equal_scalar(const uint8_t *s, size_t from, size_t to, size_t limit) {
+    size_t cnt = 0;
+    for (size_t i = from; i < to; i += 2) {
+        if (s[i] == s[i + 1] && ++cnt > limit) {
+            break;
+        }
+    }
+    return cnt;
+}
+
+static void man_decode_scalar(const uint8_t *s, size_t pairs, uint8_t invert, uint8_t *dst) {
+    for (size_t k = 0; k < pairs; k++) {
+        uint8_t a = s[2 * k];
+        uint8_t b = s[(2 * k) + 1];
+        if (a == 1 && b == 0) {
+            dst[k] = invert;
+        } else if (a == 0 && b == 1) {
+            dst[k] = invert ^ 1;
+        } else {
+            dst[k] = 7;
+        }
+    }
+}
+
+static void pack_bits_scalar(const uint8_t *bits, size_t n, uint64_t *val, uint64_t *bad) {
+    memset(val, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    memset(bad, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    for (size_t i = 0; i < n; i++) {
+        val[i / 64] |= (uint64_t)(bits[i] == 1) << (i % 64);
+        bad[i / 64] |= (uint64_t)(bits[i] > 1) << (i % 64);
+    }
+}
+
+static const lfdemod_kernel_t kernel_scalar = {
+    "scalar",
+    count_peaks_scalar,
+    peak_miss_scalar,
+    stride_sum_scalar,
+    threshold_scalar,
+    offset_scalar,
+    find_ge_scalar,
+    find_le_scalar,
+    find_ne_scalar,
+    find_rise_scalar,
+    find_top_scalar,
+    pair_equal_scalar,
+    man_decode_scalar,
+    pack_bits_scalar,
+};
+
+//-----------------------------------------------------------------------------
+// SSE2 and AVX2
+//-----------------------------------------------------------------------------
+
+#if defined(LFK_HAVE_X86)
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#define LFK_NAME            "SSE2"
+#define LFK_FN(f)           f##_sse2
+#define LFK_V               __m128i
+#define LFK_W               16
+#define LFK_FULL            0xFFFFu
+#define LFK_LOAD(p)         _mm_loadu_si128((const __m128i *)(const void *)(p))
+#define LFK_STORE(p, v)     _mm_storeu_si128((__m128i *)(void *)(p), (v))
+#define LFK_SET1(x)         _mm_set1_epi8((char)(x))
+#define LFK_ZERO()          _mm_setzero_si128()
+#define LFK_OR(a, b)        _mm_or_si128((a), (b))
+#define LFK_AND(a, b)       _mm_and_si128((a), (b))
+#define LFK_ANDNOT(a, b)    _mm_andnot_si128((b), (a))
+#define LFK_MAX(a, b)       _mm_max_epu8((a), (b))
+#define LFK_MIN(a, b)       _mm_min_epu8((a), (b))
+#define LFK_EQ(a, b)        _mm_cmpeq_epi8((a), (b))
+#define LFK_SUBS(a, b)      _mm_subs_epu8((a), (b))
+#define LFK_ADDS(a, b)      _mm_adds_epu8((a), (b))
+#define LFK_ADD(a, b)       _mm_add_epi8((a), (b))
+#define LFK_MASK(v)         ((uint32_t)_mm_movemask_epi8(v))
+// even bytes of lo:hi
+#define LFK_EVENS(lo, hi)   _mm_packus_epi16(_mm_and_si128((lo), _mm_set1_epi16(0xFF)), _mm_and_si128((hi), _mm_set1_epi16(0xFF)))
+
+#include "lfdemod_kernels_simd.h"
+
+#undef LFK_NAME
+#undef LFK_FN
+#undef LFK_V
+#undef LFK_W
+#undef LFK_FULL
+#undef LFK_LOAD
+#undef LFK_STORE
+#undef LFK_SET1
+#undef LFK_ZERO
+#undef LFK_OR
+#undef LFK_AND
+#undef LFK_ANDNOT
+#undef LFK_MAX
+#undef LFK_MIN
+#undef LFK_EQ
+#undef LFK_SUBS
+#undef LFK_ADDS
+#undef LFK_ADD
+#undef LFK_MASK
+#undef LFK_EVENS
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#define LFK_NAME            "AVX2"
+#define LFK_FN(f)           f##_avx2
+#define LFK_V               __m256i
+#define LFK_W               32
+#define LFK_FULL            0xFFFFFFFFu
+#define LFK_LOAD(p)         _mm256_loadu_si256((const __m256i *)(const void *)(p))
+#define LFK_STORE(p, v)     _mm256_storeu_si256((__m256i *)(void *)(p), (v))
+#define LFK_SET1(x)         _mm256_set1_epi8((char)(x))
+#define LFK_ZERO()          _mm256_setzero_si256()
+#define LFK_OR(a, b)        _mm256_or_si256((a), (b))
+#define LFK_AND(a, b)       _mm256_and_si256((a), (b))
+#define LFK_ANDNOT(a, b)    _mm256_andnot_si256((b), (a))
+#define LFK_MAX(a, b)       _mm256_max_epu8((a), (b))
+#define LFK_MIN(a, b)       _mm256_min_epu8((a), (b))
+#define LFK_EQ(a, b)        _mm256_cmpeq_epi8((a), (b))
+#define LFK_SUBS(a, b)      _mm256_subs_epu8((a), (b))
+#define LFK_ADDS(a, b)      _mm256_adds_epu8((a), (b))
+#define LFK_ADD(a, b)       _mm256_add_epi8((a), (b))
+#define LFK_MASK(v)         ((uint32_t)_mm256_movemask_epi8(v))
+// packus works per 128 bit lane, the permute puts the quarters back in order
+#define LFK_EVENS(lo, hi)   _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256((lo), _mm256_set1_epi16(0xFF)), \
+                                                                         _mm256_and_si256((hi), _mm256_set1_epi16(0xFF))), 0xD8)
+
+#include "lfdemod_kernels_simd.h"
+
+#undef LFK_NAME
+#undef LFK_FN
+#undef LFK_V
+#undef LFK_W
+#undef LFK_FULL
+#undef LFK_LOAD
+#undef LFK_STORE
+#undef LFK_SET1
+#undef LFK_ZERO
+#undef LFK_OR
+#undef LFK_AND
+#undef LFK_ANDNOT
+#undef LFK_MAX
+#undef LFK_MIN
+#undef LFK_EQ
+#undef LFK_SUBS
+#undef LFK_ADDS
+#undef LFK_ADD
+#undef LFK_MASK
+#undef LFK_EVENS
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+static bool cpu_supports(int avx2) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return avx2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("sse2");
+#else
+    (void)avx2;
+    return false;
+#endif
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+// NEON
+//-----------------------------------------------------------------------------
+
+#if defined(LFK_HAVE_NEON)
+
+// lane msb to bit, like movemask on x86
+static inline uint32_t neon_movemask(uint8x16_t v) {
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint8x16_t bits = vandq_u8(vtstq_u8(v, vdupq_n_u8(0x80)), vld1q_u8(weights));
+    return vaddv_u8(vget_low_u8(bits)) | ((uint32_t)vaddv_u8(vget_high_u8(bits)) << 8);
+}
+
+#define LFK_NAME            "NEON"
+#define LFK_FN(f)           f##_neon
+#define LFK_V               uint8x16_t
+#define LFK_W               16
+#define LFK_FULL            0xFFFFu
+#define LFK_LOAD(p)         vld1q_u8((const uint8_t *)(p))
+#define LFK_STORE(p, v)     vst1q_u8((uint8_t *)(p), (v))
+#define LFK_SET1(x)         vdupq_n_u8((uint8_t)(x))
+#define LFK_ZERO()          vdupq_n_u8(0)
+#define LFK_OR(a, b)        vorrq_u8((a), (b))
+#define LFK_AND(a, b)       vandq_u8((a), (b))
+#define LFK_ANDNOT(a, b)    vbicq_u8((a), (b))
+#define LFK_MAX(a, b)       vmaxq_u8((a), (b))
+#define LFK_MIN(a, b)       vminq_u8((a), (b))
+#define LFK_EQ(a, b)        vceqq_u8((a), (b))
+#define LFK_SUBS(a, b)      vqsubq_u8((a), (b))
+#define LFK_ADDS(a, b)      vqaddq_u8((a), (b))
+#define LFK_ADD(a, b)       vaddq_u8((a), (b))
+#define LFK_MASK(v)         neon_movemask(v)
+#define LFK_EVENS(lo, hi)   vuzp1q_u8((lo), (hi))
+
+#include "lfdemod_kernels_simd.h"
+
+#endif
+
+//-----------------------------------------------------------------------------
+// dispatch
+//-----------------------------------------------------------------------------
+
+static lfdemod_kernel_t lfk_usable[4];
+static size_t lfk_usable_count = 0;
+static pthread_once_t lfk_usable_once = PTHREAD_ONCE_INIT;
+
+static void lfk_usable_init(void) {
+    lfk_usable[lfk_usable_count++] = kernel_scalar;
+#if defined(LFK_HAVE_NEON)
+    lfk_usable[lfk_usable_count++] = kernel_neon;
+#endif
+#if defined(LFK_HAVE_X86)
+    if (cpu_supports(0)) {
+        lfk_usable[lfk_usable_count++] = kernel_sse2;
+    }
+    if (cpu_supports(1)) {
+        lfk_usable[lfk_usable_count++] = kernel_avx2;
+    }
+#endif
+}
+
+size_t lfdemod_kernels(const lfdemod_kernel_t **list) {
+
+    // lfdemod runs from the live monitor and bench threads as well
+    pthread_once(&lfk_usable_once, lfk_usable_init);
+
+    if (list != NULL) {
+        *list = lfk_usable;
+    }
+    return lfk_usable_count;
+}
+
+const lfdemod_kernel_t *lfdemod_kernel_by_name(const char *name) {
+    const lfdemod_kernel_t *list = NULL;
+    size_t n = lfdemod_kernels(&list);
+    for (size_t i = 0; i < n; i++) {
+        if (strcasecmp(list[i].name, name) == 0) {
+            return &list[i];
+        }
+    }
+    return NULL;
+}
+
+// per thread, so a bench run never switches the kernel under another thread
+static __thread const lfdemod_kernel_t *lfk_override = NULL;
+
+const lfdemod_kernel_t *lfdemod_kernel(void) {
+    if (lfk_override != NULL) {
+        return lfk_override;
+    }
+    const lfdemod_kernel_t *list = NULL;
+    size_t n = lfdemod_kernels(&list);
+    return &list[n - 1];
+}
+
+void lfdemod_kernel_set(const lfdemod_kernel_t *k) {
+    lfk_override = k;
+}
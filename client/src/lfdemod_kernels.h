@@ -0,0 +1,72 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Sample scanning kernels of common/lfdemod.c, scalar, SSE2, AVX2 and NEON
+//
+// Client side only, the firmware keeps the plain loops of lfdemod.c.  Every
+// kernel gives the same result as its scalar version on any input, the
+// `lfdemod.all.*` cases of `analyse bench` check it on the traces/ files.
+//-----------------------------------------------------------------------------
+
+#ifndef LFDEMOD_KERNELS_H__
+#define LFDEMOD_KERNELS_H__
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *name;
+    // samples >= hi or <= lo
+    size_t (*count_peaks)(const uint8_t *s, size_t n, uint8_t hi, uint8_t lo);
+    // miss[i] = 1 when none of s[i - tol] .. s[i + tol] is a peak, for tol <= i < n - tol.  tol is 0 or 1
+    void (*peak_miss)(const uint8_t *s, size_t n, uint8_t hi, uint8_t lo, uint8_t tol, uint8_t *miss);
+    // out[l] = sum of miss[l + t * stride] for t < terms, l < count.  miss holds 0 and 1
+    void (*stride_sum)(const uint8_t *miss, size_t count, size_t stride, size_t terms, uint32_t *out);
+    // s[i] = s[i] >= level, in place
+    void (*threshold)(uint8_t *s, size_t n, uint8_t level);
+    // s[i] - off, saturated to 0..255
+    void (*offset)(uint8_t *s, size_t n, int off);
+    // first i in [from, to) with s[i] >= v, s[i] <= v or s[i] != v, to when there is none
+    size_t (*find_ge)(const uint8_t *s, size_t from, size_t to, uint8_t v);
+    size_t (*find_le)(const uint8_t *s, size_t from, size_t to, uint8_t v);
+    size_t (*find_ne)(const uint8_t *s, size_t from, size_t to, uint8_t v);
+    // first i in [from, to) with s[i] > s[i - 1], from > 0
+    size_t (*find_rise)(const uint8_t *s, size_t from, size_t to);
+    // first i in [from, to) with s[i] + fc < s[i + 1] and s[i + 1] >= s[i + 2], the top edge of a wave
+    size_t (*find_top)(const uint8_t *s, size_t from, size_t to, uint8_t fc);
+    // i = from, from + 2 .. < to with s[i] == s[i + 1], counted up to limit + 1
+    size_t (*pair_equal)(const uint8_t *s, size_t from, size_t to, size_t limit);
+    // manchester pairs: 10 -> invert, 01 -> invert ^ 1, else 7.  dst may be s
+    void (*man_decode)(const uint8_t *s, size_t pairs, uint8_t invert, uint8_t *dst);
+    // bit i of val is set when bits[i] == 1, of bad when bits[i] > 1.  (n + 63) / 64 words each
+    void (*pack_bits)(const uint8_t *bits, size_t n, uint64_t *val, uint64_t *bad);
+} lfdemod_kernel_t;
+
+// kernels the CPU runs, scalar first and the fastest last
+size_t lfdemod_kernels(const lfdemod_kernel_t **list);
+const lfdemod_kernel_t *lfdemod_kernel_by_name(const char *name);
+
+// the one lfdemod uses, the fastest unless set
+const lfdemod_kernel_t *lfdemod_kernel(void);
+// only for the calling thread, NULL goes back to the fastest
+void lfdemod_kernel_set(const lfdemod_kernel_t *k);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,244 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// lfdemod kernels over LFK_W byte vectors, included once per instruction set
+// by lfdemod_kernels.c with the LFK_* operations defined.  Whole vectors are
+// done here, what is left over by the scalar kernels.
+//-----------------------------------------------------------------------------
+
+// s >= v, s <= v as 0xFF lanes
+#define LFK_GE(s, v)    LFK_EQ(LFK_MAX((s), (v)), (s))
+#define LFK_LE(s, v)    LFK_EQ(LFK_MIN((s), (v)), (s))
+#define LFK_PEAK(s)     LFK_OR(LFK_GE((s), vhi), LFK_LE((s), vlo))
+
+static size_t LFK_FN(count_peaks)(const uint8_t *s, size_t n, uint8_t hi, uint8_t lo) {
+    const LFK_V vhi = LFK_SET1(hi);
+    const LFK_V vlo = LFK_SET1(lo);
+    size_t cnt = 0, i = 0;
+    for (; i + LFK_W <= n; i += LFK_W) {
+        const LFK_V x = LFK_LOAD(s + i);
+        cnt += __builtin_popcount(LFK_MASK(LFK_PEAK(x)));
+    }
+    return cnt + count_peaks_scalar(s + i, n - i, hi, lo);
+}
+
+static void LFK_FN(peak_miss)(const uint8_t *s, size_t n, uint8_t hi, uint8_t lo, uint8_t tol, uint8_t *miss) {
+    const LFK_V vhi = LFK_SET1(hi);
+    const LFK_V vlo = LFK_SET1(lo);
+    const LFK_V one = LFK_SET1(1);
+    size_t i = tol;
+    for (; i + LFK_W + tol <= n; i += LFK_W) {
+        LFK_V pk = LFK_PEAK(LFK_LOAD(s + i));
+        if (tol) {
+            const LFK_V before = LFK_LOAD(s + i - 1);
+            const LFK_V after = LFK_LOAD(s + i + 1);
+            pk = LFK_OR(pk, LFK_OR(LFK_PEAK(before), LFK_PEAK(after)));
+        }
+        LFK_STORE(miss + i, LFK_ANDNOT(one, pk));
+    }
+    peak_miss_range(s, i, n, hi, lo, tol, miss);
+}
+
+static void LFK_FN(stride_sum)(const uint8_t *miss, size_t count, size_t stride, size_t terms, uint32_t *out) {
+    size_t l = 0;
+    for (; l + LFK_W <= count; l += LFK_W) {
+        uint8_t part[LFK_W];
+        memset(out + l, 0, LFK_W * sizeof(uint32_t));
+        size_t t = 0;
+        while (t < terms) {
+            // byte lanes take 255 terms before they go to the 32 bit sums
+            size_t end = MIN(terms, t + 255);
+            LFK_V acc = LFK_ZERO();
+            for (; t < end; t++) {
+                acc = LFK_ADD(acc, LFK_LOAD(miss + l + (t * stride)));
+            }
+            LFK_STORE(part, acc);
+            for (size_t k = 0; k < LFK_W; k++) {
+                out[l + k] += part[k];
+            }
+        }
+    }
+    stride_sum_scalar(miss + l, count - l, stride, terms, out + l);
+}
+
+static void LFK_FN(threshold)(uint8_t *s, size_t n, uint8_t level) {
+    const LFK_V vl = LFK_SET1(level);
+    const LFK_V one = LFK_SET1(1);
+    size_t i = 0;
+    for (; i + LFK_W <= n; i += LFK_W) {
+        const LFK_V x = LFK_LOAD(s + i);
+        LFK_STORE(s + i, LFK_AND(LFK_GE(x, vl), one));
+    }
+    threshold_scalar(s + i, n - i, level);
+}
+
+static void LFK_FN(offset)(uint8_t *s, size_t n, int off) {
+    const LFK_V vo = LFK_SET1((off > 0) ? off : -off);
+    size_t i = 0;
+    if (off == 0 || off > 255 || off < -255) {
+        offset_scalar(s, n, off);
+        return;
+    }
+    for (; i + LFK_W <= n; i += LFK_W) {
+        const LFK_V x = LFK_LOAD(s + i);
+        LFK_STORE(s + i, (off > 0) ? LFK_SUBS(x, vo) : LFK_ADDS(x, vo));
+    }
+    offset_scalar(s + i, n - i, off);
+}
+
+static size_t LFK_FN(find_ge)(const uint8_t *s, size_t from, size_t to, uint8_t v) {
+    const LFK_V vv = LFK_SET1(v);
+    size_t i = from;
+    for (; i + LFK_W <= to; i += LFK_W) {
+        const uint32_t m = LFK_MASK(LFK_GE(LFK_LOAD(s + i), vv));
+        if (m) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    return find_ge_scalar(s, i, to, v);
+}
+
+static size_t LFK_FN(find_le)(const uint8_t *s, size_t from, size_t to, uint8_t v) {
+    const LFK_V vv = LFK_SET1(v);
+    size_t i = from;
+    for (; i + LFK_W <= to; i += LFK_W) {
+        const uint32_t m = LFK_MASK(LFK_LE(LFK_LOAD(s + i), vv));
+        if (m) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    return find_le_scalar(s, i, to, v);
+}
+
+static size_t LFK_FN(find_ne)(const uint8_t *s, size_t from, size_t to, uint8_t v) {
+    const LFK_V vv = LFK_SET1(v);
+    size_t i = from;
+    for (; i + LFK_W <= to; i += LFK_W) {
+        const uint32_t m = ~LFK_MASK(LFK_EQ(LFK_LOAD(s + i), vv)) & LFK_FULL;
+        if (m) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    return find_ne_scalar(s, i, to, v);
+}
+
+static size_t LFK_FN(find_rise)(const uint8_t *s, size_t from, size_t to) {
+    const LFK_V zero = LFK_ZERO();
+    size_t i = from;
+    for (; i + LFK_W <= to; i += LFK_W) {
+        const LFK_V rise = LFK_SUBS(LFK_LOAD(s + i), LFK_LOAD(s + i - 1));
+        const uint32_t m = ~LFK_MASK(LFK_EQ(rise, zero)) & LFK_FULL;
+        if (m) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    return find_rise_scalar(s, i, to);
+}
+
+static size_t LFK_FN(find_top)(const uint8_t *s, size_t from, size_t to, uint8_t fc) {
+    // s[i] + fc < s[i + 1] never holds for bytes
+    if (fc == 0xFF) {
+        return MAX(from, to);
+    }
+    const LFK_V zero = LFK_ZERO();
+    const LFK_V vfc = LFK_SET1(fc + 1);
+    size_t i = from;
+    for (; i + LFK_W <= to; i += LFK_W) {
+        const LFK_V s0 = LFK_LOAD(s + i);
+        const LFK_V s1 = LFK_LOAD(s + i + 1);
+        const LFK_V s2 = LFK_LOAD(s + i + 2);
+        // s1 - s0 > fc, s2 - s1 <= 0
+        const LFK_V up = LFK_GE(LFK_SUBS(s1, s0), vfc);
+        const LFK_V top = LFK_EQ(LFK_SUBS(s2, s1), zero);
+        const uint32_t m = LFK_MASK(LFK_AND(up, top));
+        if (m) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    return find_top_scalar(s, i, to, fc);
+}
+
+static size_t LFK_FN(pair_equal)(const uint8_t *s, size_t from, size_t to, size_t limit) {
+    // lanes 0, 2, 4 .. start the pairs
+    const uint32_t even = (uint32_t)(0x5555555555555555ULL & LFK_FULL);
+    size_t cnt = 0, i = from;
+    for (; i + LFK_W <= to; i += LFK_W) {
+        const uint32_t m = LFK_MASK(LFK_EQ(LFK_LOAD(s + i), LFK_LOAD(s + i + 1))) & even;
+        cnt += __builtin_popcount(m);
+        if (cnt > limit) {
+            return limit + 1;
+        }
+    }
+    return cnt + pair_equal_scalar(s, i, to, limit - cnt);
+}
+
+static void LFK_FN(man_decode)(const uint8_t *s, size_t pairs, uint8_t invert, uint8_t *dst) {
+    const LFK_V zero = LFK_ZERO();
+    const LFK_V one = LFK_SET1(1);
+    const LFK_V v10 = LFK_SET1(invert);
+    const LFK_V v01 = LFK_SET1(invert ^ 1);
+    const LFK_V err = LFK_SET1(7);
+    size_t k = 0;
+    // reads one byte past the pairs of a vector, and writes behind what it reads
+    for (; k + LFK_W < pairs; k += LFK_W) {
+        const uint8_t *p = s + (2 * k);
+        const LFK_V a = LFK_EVENS(LFK_LOAD(p), LFK_LOAD(p + LFK_W));
+        const LFK_V b = LFK_EVENS(LFK_LOAD(p + 1), LFK_LOAD(p + 1 + LFK_W));
+        const LFK_V is10 = LFK_AND(LFK_EQ(a, one), LFK_EQ(b, zero));
+        const LFK_V is01 = LFK_AND(LFK_EQ(a, zero), LFK_EQ(b, one));
+        LFK_V r = LFK_AND(is10, v10);
+        r = LFK_OR(r, LFK_AND(is01, v01));
+        r = LFK_OR(r, LFK_ANDNOT(err, LFK_OR(is10, is01)));
+        LFK_STORE(dst + k, r);
+    }
+    man_decode_scalar(s + (2 * k), pairs - k, invert, dst + k);
+}
+
+static void LFK_FN(pack_bits)(const uint8_t *bits, size_t n, uint64_t *val, uint64_t *bad) {
+    const LFK_V one = LFK_SET1(1);
+    size_t w = 0;
+    for (; (w + 1) * 64 <= n; w++) {
+        uint64_t v = 0, b = 0;
+        for (size_t c = 0; c < 64; c += LFK_W) {
+            const LFK_V x = LFK_LOAD(bits + (w * 64) + c);
+            v |= (uint64_t)LFK_MASK(LFK_EQ(x, one)) << c;
+            b |= (uint64_t)(~LFK_MASK(LFK_LE(x, one)) & LFK_FULL) << c;
+        }
+        val[w] = v;
+        bad[w] = b;
+    }
+    pack_bits_scalar(bits + (w * 64), n - (w * 64), val + w, bad + w);
+}
+
+static const lfdemod_kernel_t LFK_FN(kernel) = {
+    LFK_NAME,
+    LFK_FN(count_peaks),
+    LFK_FN(peak_miss),
+    LFK_FN(stride_sum),
+    LFK_FN(threshold),
+    LFK_FN(offset),
+    LFK_FN(find_ge),
+    LFK_FN(find_le),
+    LFK_FN(find_ne),
+    LFK_FN(find_rise),
+    LFK_FN(find_top),
+    LFK_FN(pair_equal),
+    LFK_FN(man_decode),
+    LFK_FN(pack_bits),
+};
+
+#undef LFK_GE
+#undef LFK_LE
+#undef LFK_PEAK
@@ -0,0 +1,384 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Streaming LF demodulation
+//-----------------------------------------------------------------------------
+
+#include "lfstream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "lfdemod.h"
+#include "ui.h"
+#include "util_posix.h"
+#include "wiegand_formats.h"
+#include "wiegand_formatutils.h"
+
+typedef struct {
+    uint64_t runs;          // windows handed to the decoder
+    uint64_t hits;          // windows it decoded an ID from
+    uint64_t reported;      // IDs passed to the callback
+    uint64_t us;            // time spent decoding
+    uint64_t us_max;
+    uint64_t lat_min;       // samples from end of frame to report
+    uint64_t lat_max;
+    uint64_t lat_sum;
+} lfstream_stat_t;
+
+typedef struct {
+    bool valid;
+    lfstream_id_t id;
+    uint64_t last_seen;     // stream index of the end of the newest frame with this ID
+} lfstream_last_t;
+
+struct lfstream_s {
+    uint8_t *ring;
+    size_t ring_mask;
+    uint8_t *lin;           // the window, oldest sample first
+    uint8_t *work;          // decoders demodulate in place
+    size_t window;
+    size_t hop;
+    uint64_t holdoff;       // samples an ID must be absent before it is reported again
+    uint32_t decoders;
+    uint64_t total;         // samples pushed
+    uint64_t last_run;      // value of total at the last run
+    uint64_t runs;
+    uint64_t noise;         // runs skipped as noise
+    uint64_t start_us;
+    uint64_t busy_us;
+    lfstream_cb_t cb;
+    void *ctx;
+    lfstream_stat_t stats[LFSTREAM_DECODERS];
+    lfstream_last_t last[LFSTREAM_DECODERS];
+};
+
+typedef bool (*lfstream_decode_t)(uint8_t *work, size_t n, lfstream_id_t *out);
+
+static const char *decoder_names[LFSTREAM_DECODERS] = {
+    "EM410x",
+    "HID Prox",
+    "IO Prox",
+};
+
+const char *lfstream_decoder_name(lfstream_decoder_t d) {
+    return (d < LFSTREAM_DECODERS) ? decoder_names[d] : "?";
+}
+
+//-----------------------------------------------------------------------------
+// decoders, same demod path as the 'lf <tag> demod' commands.
+// frame_end is relative to the start of the window
+//-----------------------------------------------------------------------------
+
+static bool decode_em410x(uint8_t *work, size_t n, lfstream_id_t *out) {
+    size_t size = n;
+    int clk = 0, invert = 0, start = 0;
+    if (askdemod_ext(work, &size, &clk, &invert, 100, 0, 1, &start) < 0 || clk == 0) {
+        return false;
+    }
+
+    size_t idx = 0;
+    uint32_t hi = 0;
+    uint64_t lo = 0;
+    if (Em410xDecode(work, &size, &idx, &hi, &lo) < 0) {
+        return false;
+    }
+
+    out->hi = hi;
+    out->lo = lo;
+    // 64 raw bits, or 128 for the long formats
+    out->frame_end = start + (idx + ((hi == 0) ? 64 : 128)) * clk;
+    if (hi) {
+        snprintf(out->text, sizeof(out->text), "EM 410x XL ID %06X%016" PRIX64, hi, lo);
+    } else {
+        snprintf(out->text, sizeof(out->text), "EM 410x ID %010" PRIX64, lo);
+    }
+    return true;
+}
+
+static bool decode_hid(uint8_t *work, size_t n, lfstream_id_t *out) {
+    size_t size = n;
+    uint32_t hi2 = 0, hi = 0, lo = 0;
+    int wave = 0;
+    int idx = HIDdemodFSK(work, &size, &hi2, &hi, &lo, &wave);
+    if (idx < 0 || (hi2 == 0 && hi == 0 && lo == 0)) {
+        return false;
+    }
+
+    out->hi2 = hi2;
+    out->hi = hi;
+    out->lo = lo;
+    out->frame_end = wave + (idx + size) * 50;
+
+    // the same format table `lf hid reader` decodes with
+    wiegand_message_t packed = initialize_message_object(hi2, hi, lo, 0);
+    wiegand_card_t card;
+    int fmt = HIDFindUnpack(&packed, &card);
+
+    char raw[32];
+    if (hi2) {
+        snprintf(raw, sizeof(raw), "%x%08x%08x", hi2, hi, lo);
+    } else {
+        snprintf(raw, sizeof(raw), "%x%08x", hi, lo);
+    }
+
+    if (fmt < 0) {
+        snprintf(out->text, sizeof(out->text), "HID Prox raw %s - %u bit", raw, packed.Length);
+        return true;
+    }
+    snprintf(out->text, sizeof(out->text), "HID Prox raw %s - %u bit %s, FC: %u  CN: %" PRIu64
+             , raw, packed.Length, HIDGetCardFormat(fmt).Name, card.FacilityCode, card.CardNumber);
+    return true;
+}
+
+static bool decode_ioprox(uint8_t *work, size_t n, lfstream_id_t *out) {
+    size_t size = n;
+    int wave = 0;
+    int idx = detectIOProx(work, &size, &wave);
+    if (idx <= 0) {
+        return false;
+    }
+
+    uint8_t crc = bytebits_to_byte(work + idx + 54, 8);
+    uint8_t calccrc = 0;
+    for (uint8_t i = 1; i < 6; ++i) {
+        calccrc += bytebits_to_byte(work + idx + 9 * i, 8);
+    }
+    calccrc = 0xff - calccrc;
+    if (crc != calccrc) {
+        return false;
+    }
+
+    uint32_t code = bytebits_to_byte(work + idx, 32);
+    uint32_t code2 = bytebits_to_byte(work + idx + 32, 32);
+    uint8_t version = bytebits_to_byte(work + idx + 27, 8);
+    uint8_t facilitycode = bytebits_to_byte(work + idx + 18, 8);
+    uint16_t number = (bytebits_to_byte(work + idx + 36, 8) << 8) | (bytebits_to_byte(work + idx + 45, 8));
+
+    out->hi = code;
+    out->lo = code2;
+    out->frame_end = wave + (idx + 64) * 64;
+    snprintf(out->text, sizeof(out->text), "IO Prox - XSF(%02d)%02x:%05d, Raw: %08x%08x", version, facilitycode, number, code, code2);
+    return true;
+}
+
+static const lfstream_decode_t decoders[LFSTREAM_DECODERS] = {
+    decode_em410x,
+    decode_hid,
+    decode_ioprox,
+};
+
+//-----------------------------------------------------------------------------
+// pipeline
+//-----------------------------------------------------------------------------
+
+lfstream_t *lfstream_new(size_t window, size_t hop, uint32_t decoders_mask, lfstream_cb_t cb, void *ctx) {
+    if (window < 256 || hop == 0 || hop > window) {
+        return NULL;
+    }
+
+    size_t ring_len = 1;
+    while (ring_len < window) {
+        ring_len <<= 1;
+    }
+
+    lfstream_t *s = calloc(1, sizeof(lfstream_t));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->ring = calloc(ring_len, sizeof(uint8_t));
+    s->lin = calloc(window, sizeof(uint8_t));
+    s->work = calloc(window, sizeof(uint8_t));
+    if (s->ring == NULL || s->lin == NULL || s->work == NULL) {
+        lfstream_free(s);
+        return NULL;
+    }
+    s->ring_mask = ring_len - 1;
+    s->window = window;
+    s->hop = hop;
+    s->holdoff = 2 * window;
+    s->decoders = decoders_mask & LFSTREAM_ALL;
+    s->cb = cb;
+    s->ctx = ctx;
+    s->start_us = usclock();
+    return s;
+}
+
+void lfstream_free(lfstream_t *s) {
+    if (s == NULL) {
+        return;
+    }
+    free(s->ring);
+    free(s->lin);
+    free(s->work);
+    free(s);
+}
+
+void lfstream_reset_ids(lfstream_t *s) {
+    memset(s->last, 0, sizeof(s->last));
+}
+
+uint64_t lfstream_samples(const lfstream_t *s) {
+    return s->total;
+}
+
+size_t lfstream_memory(const lfstream_t *s) {
+    return sizeof(lfstream_t) + (s->ring_mask + 1) + 2 * s->window;
+}
+
+static void lfstream_report(lfstream_t *s, lfstream_decoder_t d, lfstream_id_t *id) {
+    lfstream_last_t *last = &s->last[d];
+    bool same = last->valid &&
+                last->id.hi2 == id->hi2 && last->id.hi == id->hi && last->id.lo == id->lo;
+
+    // overlapping windows decode the same frames over and over,
+    // report an ID again only after it was gone for a while
+    if (same && id->frame_end < last->last_seen + s->holdoff) {
+        if (id->frame_end > last->last_seen) {
+            last->last_seen = id->frame_end;
+        }
+        return;
+    }
+
+    last->valid = true;
+    last->id = *id;
+    last->last_seen = id->frame_end;
+
+    lfstream_stat_t *st = &s->stats[d];
+    uint64_t lat = id->reported - id->frame_end;
+    if (st->reported == 0 || lat < st->lat_min) {
+        st->lat_min = lat;
+    }
+    if (lat > st->lat_max) {
+        st->lat_max = lat;
+    }
+    st->lat_sum += lat;
+    st->reported++;
+
+    if (s->cb) {
+        s->cb(id, s->ctx);
+    }
+}
+
+static void lfstream_run(lfstream_t *s) {
+    size_t n = (s->total < s->window) ? (size_t)s->total : s->window;
+    s->last_run = s->total;
+    if (n < 256) {
+        return;
+    }
+
+    uint64_t t0 = usclock();
+    uint64_t first = s->total - n;
+
+    // linearise the window, the ring wraps at most once
+    size_t pos = (size_t)(first & s->ring_mask);
+    size_t part = MIN(n, s->ring_mask + 1 - pos);
+    memcpy(s->lin, s->ring + pos, part);
+    memcpy(s->lin + part, s->ring, n - part);
+
+    s->runs++;
+    computeSignalProperties(s->lin, n);
+    if (getSignalProperties()->isnoise) {
+        s->noise++;
+        s->busy_us += usclock() - t0;
+        return;
+    }
+
+    for (uint8_t d = 0; d < LFSTREAM_DECODERS; d++) {
+        if ((s->decoders & LFSTREAM_MASK(d)) == 0) {
+            continue;
+        }
+
+        lfstream_stat_t *st = &s->stats[d];
+        lfstream_id_t id = { .decoder = (lfstream_decoder_t)d };
+
+        uint64_t td = usclock();
+        memcpy(s->work, s->lin, n);
+        bool found = decoders[d](s->work, n, &id);
+        td = usclock() - td;
+
+        st->runs++;
+        st->us += td;
+        if (td > st->us_max) {
+            st->us_max = td;
+        }
+        if (found == false) {
+            continue;
+        }
+
+        st->hits++;
+        id.frame_end = first + MIN(id.frame_end, n);
+        id.reported = s->total;
+        lfstream_report(s, (lfstream_decoder_t)d, &id);
+    }
+    s->busy_us += usclock() - t0;
+}
+
+void lfstream_push(lfstream_t *s, const uint8_t *samples, size_t len) {
+    while (len) {
+        size_t pos = (size_t)(s->total & s->ring_mask);
+        size_t todo = s->hop - (size_t)(s->total - s->last_run);
+        todo = MIN(todo, len);
+        todo = MIN(todo, s->ring_mask + 1 - pos);
+
+        memcpy(s->ring + pos, samples, todo);
+        s->total += todo;
+        samples += todo;
+        len -= todo;
+
+        if (s->total - s->last_run >= s->hop) {
+            lfstream_run(s);
+        }
+    }
+}
+
+void lfstream_flush(lfstream_t *s) {
+    if (s->total != s->last_run) {
+        lfstream_run(s);
+    }
+}
+
+void lfstream_print_stats(const lfstream_t *s) {
+    uint64_t wall = usclock() - s->start_us;
+
+    PrintAndLogEx(INFO, "samples...... %" PRIu64 " ( %" PRIu64 " ms of signal )", s->total, s->total * LFSTREAM_US_PER_SAMPLE / 1000);
+    PrintAndLogEx(INFO, "windows...... %" PRIu64 " of %zu samples, every %zu ( %" PRIu64 " noise )", s->runs, s->window, s->hop, s->noise);
+    PrintAndLogEx(INFO, "memory....... %zu bytes", lfstream_memory(s));
+    if (s->busy_us) {
+        PrintAndLogEx(INFO, "decode load.. %" PRIu64 " ms, %.1fx realtime",
+                      s->busy_us / 1000, (double)(s->total * LFSTREAM_US_PER_SAMPLE) / (double)s->busy_us);
+    }
+    PrintAndLogEx(INFO, "wall......... %" PRIu64 " ms", wall / 1000);
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx(INFO, " decoder  | windows |  hits | reported | avg us | max us | latency ms min / avg / max");
+    PrintAndLogEx(INFO, "----------+---------+-------+----------+--------+--------+---------------------------");
+    for (uint8_t d = 0; d < LFSTREAM_DECODERS; d++) {
+        if ((s->decoders & LFSTREAM_MASK(d)) == 0) {
+            continue;
+        }
+        const lfstream_stat_t *st = &s->stats[d];
+        char lat[40] = "-";
+        if (st->reported) {
+            snprintf(lat, sizeof(lat), "%.1f / %.1f / %.1f",
+                     (double)(st->lat_min * LFSTREAM_US_PER_SAMPLE) / 1000.0,
+                     (double)(st->lat_sum * LFSTREAM_US_PER_SAMPLE) / (double)st->reported / 1000.0,
+                     (double)(st->lat_max * LFSTREAM_US_PER_SAMPLE) / 1000.0);
+        }
+        PrintAndLogEx(INFO, " %-8s | %7" PRIu64 " | %5" PRIu64 " | %8" PRIu64 " | %6" PRIu64 " | %6" PRIu64 " | %s",
+                      decoder_names[d], st->runs, st->hits, st->reported,
+                      st->runs ? st->us / st->runs : 0, st->us_max, lat);
+    }
+}
@@ -0,0 +1,81 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Streaming LF demodulation
+//
+// Samples are pushed in chunks of any size into a ring buffer.  Every hop
+// samples the last window of the ring is handed to the enabled decoders, and
+// an ID is reported through the callback as soon as a decoder finds one it
+// has not reported recently.  Memory is fixed at creation, whatever the
+// length of the stream.
+//-----------------------------------------------------------------------------
+
+#ifndef LFSTREAM_H__
+#define LFSTREAM_H__
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 125 kHz, divisor 95
+#define LFSTREAM_US_PER_SAMPLE  8
+
+#define LFSTREAM_DEFAULT_WINDOW 16384
+#define LFSTREAM_DEFAULT_HOP    2048
+
+typedef enum {
+    LFSTREAM_EM410X = 0,
+    LFSTREAM_HID,
+    LFSTREAM_IOPROX,
+    LFSTREAM_DECODERS
+} lfstream_decoder_t;
+
+#define LFSTREAM_MASK(d)   (1U << (d))
+#define LFSTREAM_ALL       (LFSTREAM_MASK(LFSTREAM_DECODERS) - 1)
+
+typedef struct {
+    lfstream_decoder_t decoder;
+    uint32_t hi2;
+    uint32_t hi;
+    uint64_t lo;
+    char text[128];
+    uint64_t frame_end;     // stream index just past the last sample of the frame
+    uint64_t reported;      // stream index when the ID was reported
+} lfstream_id_t;
+
+typedef void (*lfstream_cb_t)(const lfstream_id_t *id, void *ctx);
+
+typedef struct lfstream_s lfstream_t;
+
+// window and hop in samples, hop <= window, decoders is a LFSTREAM_MASK() set
+lfstream_t *lfstream_new(size_t window, size_t hop, uint32_t decoders, lfstream_cb_t cb, void *ctx);
+void lfstream_push(lfstream_t *s, const uint8_t *samples, size_t len);
+// decode the samples pushed since the last run, at the end of a stream
+void lfstream_flush(lfstream_t *s);
+// forget the reported IDs, e.g. between two independent recordings
+void lfstream_reset_ids(lfstream_t *s);
+uint64_t lfstream_samples(const lfstream_t *s);
+size_t lfstream_memory(const lfstream_t *s);
+void lfstream_print_stats(const lfstream_t *s);
+void lfstream_free(lfstream_t *s);
+
+const char *lfstream_decoder_name(lfstream_decoder_t d);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -15,6 +15,8 @@
 
 #include "cipher_bs.h"
 
+#include <string.h>
+
 #define BS_ALL_ONES (~(uint64_t)0)
 
 // Bitsliced 3-bit select over 8 key bytes. Each z/nz is the bit across all
@@ -188,6 +190,38 @@ void build_bitslice_key_64(const uint8_t partial_key[8], uint64_t index_start, u
     }
 }
 
+// Classic 64x64 bit matrix transpose, row L of the input is the key of lane
+// L, afterwards row b holds bit b of every lane.
+static void bs_transpose64(uint64_t m[64]) {
+    uint64_t mask = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, mask ^= (mask << j)) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            const uint64_t t = ((m[k] >> j) ^ m[k | j]) & mask;
+            m[k] ^= t << j;
+            m[k | j] ^= t;
+        }
+    }
+}
+
+void build_bitslice_key_list(const uint64_t *keys, uint32_t n, int words, uint64_t *kb) {
+
+    for (int w = 0; w < words; w++) {
+
+        uint64_t m[64] = {0};
+        const uint32_t start = w * 64;
+        if (n > start) {
+            const uint32_t cnt = (n - start > 64) ? 64 : n - start;
+            memcpy(m, keys + start, cnt * sizeof(uint64_t));
+        }
+
+        bs_transpose64(m);
+
+        for (int b = 0; b < 64; b++) {
+            kb[b * words + w] = m[b];
+        }
+    }
+}
+
 // init(k) for the iClass cipher with k[0] variable and b, t constants:
 //   l = ((k[0] ^ 0x4c) + 0xEC) & 0xff
 //   r = ((k[0] ^ 0x4c) + 0x21) & 0xff
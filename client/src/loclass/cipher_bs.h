@@ -35,6 +35,12 @@ void prepare_target_mac_bs(const uint8_t target_mac[4], uint64_t target_mac_bs[3
 // are the pure lane index.
 void build_bitslice_key_64(const uint8_t partial_key[8], uint64_t index_start, uint64_t kb[64]);
 
+// Bitslice an arbitrary list of n (<= 64 * words) diversified keys for any
+// backend. keys[L] holds the key of lane L with key byte j in bits 8j..8j+7,
+// kb receives 64 bit planes of `words` uint64_t each (lane L = bit L % 64 of
+// word L / 64). Lanes past n are zero keys.
+void build_bitslice_key_list(const uint64_t *keys, uint32_t n, int words, uint64_t *kb);
+
 // Run the bitsliced MAC against a pre-expanded target and return a 64-bit
 // lane mask: bit L is set iff candidate (index_start + L) produces target_mac.
 // Early-exits after any 8-bit MAC byte that rules out every lane.
@@ -80,3 +80,18 @@ const bs_backend_t *bs_best_backend(void) {
     }
     return cached;
 }
+
+const bs_backend_t *bs_backend_by_width(int width) {
+    switch (width) {
+        case 64:
+            return &backend_u64;
+        case 128:
+            return bs_neon_supported() ? &backend_neon : NULL;
+        case 256:
+            return bs_avx2_supported() ? &backend_avx2 : NULL;
+        case 512:
+            return bs_avx512_supported() ? &backend_avx512 : NULL;
+        default:
+            return NULL;
+    }
+}
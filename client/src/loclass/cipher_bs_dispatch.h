@@ -38,4 +38,7 @@ typedef struct bs_backend_s {
 // the universal fallback). Cached after first call; safe to call repeatedly.
 const bs_backend_t *bs_best_backend(void);
 
+// Returns the backend of the given width, NULL when the CPU lacks it.
+const bs_backend_t *bs_backend_by_width(int width);
+
 #endif // CIPHER_BS_DISPATCH_H
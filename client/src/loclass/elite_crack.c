@@ -39,11 +39,14 @@
 #include <time.h>
 #include "cipherutils.h"
 #include "cipher.h"
+#include "cipher_bs.h"
+#include "cipher_bs_dispatch.h"
 #include "ikeys.h"
 #include "elite_crack.h"
 #include "fileutils.h"
 #include "mbedtls/des.h"
 #include "util_posix.h"
+#include "perf.h"
 
 /**
  * @brief Permutes a key from standard NIST format to Iclass specific format
@@ -289,13 +292,23 @@ static int _readFromDump(uint8_t dump[], dumpdata *item, uint8_t i) {
 }
 */
 
+/**
+ * The DES key schedule is linear over GF(2), every subkey bit is a plain key bit.
+ * The subkeys of a candidate K_sel are therefore the xor of the subkeys of the
+ * already known key bytes and of each bruteforced byte on its own, computed once
+ * per item and shared by all threads.
+ */
+typedef struct {
+    uint32_t fixed[32];
+    uint32_t brute[3][256][32];
+} loclass_sk_table_t;
+
 typedef struct {
     int thread_idx;
     uint32_t endmask;
     uint8_t numbytes_to_recover;
     uint8_t bytes_to_recover[3];
-    uint8_t key_index[8];
-    uint16_t keytable[128];
+    const loclass_sk_table_t *sk;
     loclass_dumpdata_t item;
 } loclass_thread_arg_t;
 
@@ -305,125 +318,179 @@ typedef struct {
 
 static size_t loclass_tc = 1;
 static int loclass_found = 0;
+static uint32_t loclass_next = 0;
+static uint64_t loclass_tested = 0;
+
+static void build_sk_table(const uint16_t keytable[], const uint8_t key_index[8], const uint8_t bytes_to_recover[3], uint8_t numbytes_to_recover, loclass_sk_table_t *sk) {
+
+    uint8_t key_sel[8] = {0};
+    uint8_t key_sel_p[8] = {0};
+
+    // known bytes, the bruteforced positions left zero
+    for (uint8_t i = 0; i < 8; i++) {
+        key_sel[i] = keytable[key_index[i]] & 0xFF;
+        for (uint8_t j = 0; j < numbytes_to_recover; j++) {
+            if (key_index[i] == bytes_to_recover[j]) {
+                key_sel[i] = 0;
+            }
+        }
+    }
+    permutekey_rev(key_sel, key_sel_p);
+    mbedtls_des_setkey(sk->fixed, key_sel_p);
+
+    // one bruteforced byte at all of its positions, everything else zero
+    for (uint8_t j = 0; j < numbytes_to_recover; j++) {
+        for (uint16_t v = 0; v < 256; v++) {
+            for (uint8_t i = 0; i < 8; i++) {
+                key_sel[i] = (key_index[i] == bytes_to_recover[j]) ? v : 0;
+            }
+            permutekey_rev(key_sel, key_sel_p);
+            mbedtls_des_setkey(sk->brute[j][v], key_sel_p);
+        }
+    }
+}
 
 static void *bf_thread(void *thread_arg) {
 
     loclass_thread_arg_t *targ = (loclass_thread_arg_t *)thread_arg;
     const uint32_t endmask = targ->endmask;
     const uint8_t numbytes_to_recover = targ->numbytes_to_recover;
-    uint32_t brute = targ->thread_idx;
+    const loclass_sk_table_t *sk = targ->sk;
+    const bs_backend_t *bs = bs_best_backend();
 
     uint8_t csn[8];
     uint8_t cc_nr[12];
     uint8_t mac[4];
-    uint8_t key_index[8];
     uint8_t bytes_to_recover[3];
-    uint16_t keytable[128];
 
     memcpy(csn, targ->item.csn, sizeof(csn));
     memcpy(cc_nr, targ->item.cc_nr, sizeof(cc_nr));
     memcpy(mac, targ->item.mac, sizeof(mac));
-    memcpy(key_index, targ->key_index, sizeof(key_index));
     memcpy(bytes_to_recover, targ->bytes_to_recover, sizeof(bytes_to_recover));
-    memcpy(keytable, targ->keytable, sizeof(keytable));
 
-    // Precompute which key_sel positions are fixed (already-cracked) vs. brute-forced.
-    // sel_brute_idx[i] == 0xFF: key_sel[i] is constant for this entire brute-force run.
-    // sel_brute_idx[i] == j:    key_sel[i] = (brute >> (j*8)) & 0xFF each iteration.
-    uint8_t sel_brute_idx[8];
-    uint8_t key_sel[8];
-    for (uint8_t i = 0; i < 8; i++) {
-        sel_brute_idx[i] = 0xFF;
-        for (uint8_t j = 0; j < numbytes_to_recover; j++) {
-            if (key_index[i] == bytes_to_recover[j]) {
-                sel_brute_idx[i] = j;
-                break;
-            }
-        }
-        if (sel_brute_idx[i] == 0xFF) {
-            key_sel[i] = keytable[key_index[i]] & 0xFF;
-        }
-    }
+    uint64_t y_bits_bs[96 * BS_MAX_WORDS];
+    uint64_t target_mac_bs[32 * BS_MAX_WORDS];
+    bs->prepare_ccnr(cc_nr, y_bits_bs);
+    bs->prepare_mac(mac, target_mac_bs);
+
+    uint64_t div_keys[64 * BS_MAX_WORDS];
+    uint64_t kb[64 * BS_MAX_WORDS];
+    uint64_t match[BS_MAX_WORDS];
 
-    while (!(brute & endmask)) {
+    mbedtls_des_context ctx;
+    mbedtls_des_init(&ctx);
+
+    // progress is printed by whichever batch crosses a step mark
+    const uint32_t step = (endmask >> 8) > 0x1000 ? (endmask >> 8) : 0x1000;
 
-        int found = __atomic_load_n(&loclass_found, __ATOMIC_SEQ_CST);
+    loclass_thread_ret_t *r = NULL;
 
-        if (found != 0xFF) {
-            return NULL;
+    while (r == NULL) {
+
+        if (__atomic_load_n(&loclass_found, __ATOMIC_SEQ_CST) != 0xFF) {
+            break;
         }
 
-        // Update only the bruted positions of key_sel directly from brute
-        for (uint8_t i = 0; i < 8; i++) {
-            if (sel_brute_idx[i] != 0xFF) {
-                key_sel[i] = (brute >> (sel_brute_idx[i] * 8)) & 0xFF;
-            }
+        const uint32_t start = __atomic_fetch_add(&loclass_next, (uint32_t)bs->width, __ATOMIC_SEQ_CST);
+        if (start >= endmask) {
+            break;
         }
 
-        // Permute from iclass format to standard format
+        const uint32_t cnt = (endmask - start < (uint32_t)bs->width) ? endmask - start : (uint32_t)bs->width;
 
-        uint8_t key_sel_p[8] = {0};
-        permutekey_rev(key_sel, key_sel_p);
+        // diversify the whole batch with DES, subkeys assembled from the table
+        for (uint32_t i = 0; i < cnt; i++) {
 
-        // Diversify
-        uint8_t div_key[8] = {0};
-        diversifyKey(csn, key_sel_p, div_key);
+            const uint32_t brute = start + i;
 
-        // Calc mac
-        uint8_t calculated_MAC[4] = {0};
-        doMAC_brute(cc_nr, div_key, calculated_MAC);
+            memcpy(ctx.sk, sk->fixed, sizeof(ctx.sk));
+            for (uint8_t j = 0; j < numbytes_to_recover; j++) {
+                const uint32_t *bsk = sk->brute[j][(brute >> (j * 8)) & 0xFF];
+                for (uint8_t n = 0; n < 32; n++) {
+                    ctx.sk[n] ^= bsk[n];
+                }
+            }
 
-        // success
-        if (memcmp(calculated_MAC, mac, 4) == 0) {
+            uint8_t crypted_csn[8] = {0};
+            mbedtls_des_crypt_ecb(&ctx, csn, crypted_csn);
 
-            loclass_thread_ret_t *r = (loclass_thread_ret_t *)calloc(sizeof(loclass_thread_ret_t), sizeof(uint8_t));
-            if (r == NULL) {
-                PrintAndLogEx(WARNING, "Failed to allocate memory");
-                pthread_exit(NULL);
-            }
+            uint8_t div_key[8] = {0};
+            hash0(x_bytes_to_num(crypted_csn, sizeof(crypted_csn)), div_key);
 
-            for (uint8_t i = 0 ; i < numbytes_to_recover && i < sizeof(r->values); i++) {
-                r->values[i] = (brute >> (i * 8)) & 0xFF;
+            uint64_t packed = 0;
+            for (uint8_t j = 0; j < 8; j++) {
+                packed |= (uint64_t)div_key[j] << (j * 8);
             }
-            __atomic_store_n(&loclass_found, targ->thread_idx, __ATOMIC_SEQ_CST);
-            pthread_exit((void *)r);
+            div_keys[i] = packed;
         }
 
-        brute += loclass_tc;
-
-        if (numbytes_to_recover == 3) {
-
-            if ((brute > 0) && ((brute & 0xFFFF) == 0)) {
-                PrintAndLogEx(INPLACE, "[ %02x %02x %02x ] %8u / %u", bytes_to_recover[0], bytes_to_recover[1], bytes_to_recover[2], brute, 0xFFFFFF);
+        // and run the MAC over all of them at once
+        build_bitslice_key_list(div_keys, cnt, bs->words, kb);
+        bs->match(y_bits_bs, kb, target_mac_bs, match);
+
+        for (int w = 0; w < bs->words && r == NULL; w++) {
+            uint64_t m = match[w];
+            while (m) {
+                const uint32_t lane = (w * 64) + __builtin_ctzll(m);
+                m &= m - 1;
+                if (lane >= cnt) {
+                    continue;
+                }
+
+                // confirm with the scalar MAC
+                uint8_t div_key[8] = {0};
+                for (uint8_t j = 0; j < 8; j++) {
+                    div_key[j] = (div_keys[lane] >> (j * 8)) & 0xFF;
+                }
+
+                uint8_t calculated_MAC[4] = {0};
+                doMAC_brute(cc_nr, div_key, calculated_MAC);
+                if (memcmp(calculated_MAC, mac, 4) != 0) {
+                    continue;
+                }
+
+                r = (loclass_thread_ret_t *)calloc(sizeof(loclass_thread_ret_t), sizeof(uint8_t));
+                if (r == NULL) {
+                    PrintAndLogEx(WARNING, "Failed to allocate memory");
+                    break;
+                }
+
+                for (uint8_t i = 0 ; i < numbytes_to_recover && i < sizeof(r->values); i++) {
+                    r->values[i] = ((start + lane) >> (i * 8)) & 0xFF;
+                }
+                __atomic_store_n(&loclass_found, targ->thread_idx, __ATOMIC_SEQ_CST);
+                break;
             }
+        }
 
-        } else if (numbytes_to_recover == 2) {
+        __atomic_fetch_add(&loclass_tested, cnt, __ATOMIC_RELAXED);
 
-            if ((brute > 0) && ((brute & 0x3F) == 0)) {
-                PrintAndLogEx(INPLACE, "[ %02x %02x ] %5u / %u" _CLR_, bytes_to_recover[0], bytes_to_recover[1], brute, 0xFFFF);
-            }
+        if ((start / step) == ((start + cnt) / step) || (start + cnt) >= endmask) {
+            continue;
+        }
 
+        const uint32_t done = start + cnt;
+        if (numbytes_to_recover == 3) {
+            PrintAndLogEx(INPLACE, "[ %02x %02x %02x ] %8u / %u", bytes_to_recover[0], bytes_to_recover[1], bytes_to_recover[2], done, 0xFFFFFF);
+        } else if (numbytes_to_recover == 2) {
+            PrintAndLogEx(INPLACE, "[ %02x %02x ] %5u / %u" _CLR_, bytes_to_recover[0], bytes_to_recover[1], done, 0xFFFF);
         } else {
-
-            if ((brute > 0) && ((brute & 0x1F) == 0)) {
-                PrintAndLogEx(INPLACE, "[ %02x ] %3u / %u" _CLR_, bytes_to_recover[0], brute, 0xFF);
-            }
+            PrintAndLogEx(INPLACE, "[ %02x ] %3u / %u" _CLR_, bytes_to_recover[0], done, 0xFF);
         }
     }
-    pthread_exit(NULL);
+
+    mbedtls_des_free(&ctx);
+    pthread_exit((void *)r);
 
     void *dummyptr = NULL;
     return dummyptr;
 }
 
-int bruteforceItem(loclass_dumpdata_t item, uint16_t keytable[]) {
+static int bruteforce_item_hashed(loclass_dumpdata_t item, const uint8_t key_index[8], uint16_t keytable[]) {
 
     // reset thread signals
     loclass_found = 0xFF;
-
-    //Get the key index (hash1)
-    uint8_t key_index[8] = {0};
-    hash1(item.csn, key_index);
+    loclass_next = 0;
 
     /*
      * Determine which bytes to retrieve. A hash is typically
@@ -468,17 +535,23 @@ int bruteforceItem(loclass_dumpdata_t item, uint16_t keytable[]) {
         return PM3_ESOFT;
     }
 
+    loclass_sk_table_t *sk = calloc(1, sizeof(loclass_sk_table_t));
+    if (sk == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+    build_sk_table(keytable, key_index, bytes_to_recover, numbytes_to_recover, sk);
+
     loclass_thread_arg_t args[loclass_tc];
     // init thread arguments
     for (size_t i = 0; i < loclass_tc; i++) {
         args[i].thread_idx = i;
         args[i].numbytes_to_recover = numbytes_to_recover;
         args[i].endmask = 1 << 8 * numbytes_to_recover;
+        args[i].sk = sk;
 
         memcpy((void *)&args[i].item, (void *)&item, sizeof(loclass_dumpdata_t));
         memcpy(args[i].bytes_to_recover, bytes_to_recover, sizeof(args[i].bytes_to_recover));
-        memcpy(args[i].key_index, key_index, sizeof(args[i].key_index));
-        memcpy(args[i].keytable, keytable, sizeof(args[i].keytable));
     }
 
     pthread_t threads[loclass_tc];
@@ -488,6 +561,7 @@ int bruteforceItem(loclass_dumpdata_t item, uint16_t keytable[]) {
         if (res) {
             PrintAndLogEx(NORMAL, "");
             PrintAndLogEx(WARNING, "Failed to create pthreads. Quitting");
+            free(sk);
             return PM3_ESOFT;
         }
     }
@@ -497,6 +571,8 @@ int bruteforceItem(loclass_dumpdata_t item, uint16_t keytable[]) {
         pthread_join(threads[i], &ptrs[i]);
     }
 
+    free(sk);
+
     // was it a success?
     int res = PM3_SUCCESS;
     if (loclass_found == 0xFF) {
@@ -519,9 +595,10 @@ int bruteforceItem(loclass_dumpdata_t item, uint16_t keytable[]) {
             keytable[bytes_to_recover[i]] &= 0xFF;
             keytable[bytes_to_recover[i]] |= LOCLASS_CRACKED;
         }
-        for (size_t i = 0; i < loclass_tc; i++) {
-            free(ptrs[i]);
-        }
+    }
+
+    for (size_t i = 0; i < loclass_tc; i++) {
+        free(ptrs[i]);
     }
 
     memset(args, 0x00, sizeof(args));
@@ -529,6 +606,13 @@ int bruteforceItem(loclass_dumpdata_t item, uint16_t keytable[]) {
     return res;
 }
 
+int bruteforceItem(loclass_dumpdata_t item, uint16_t keytable[]) {
+    //Get the key index (hash1)
+    uint8_t key_index[8] = {0};
+    hash1(item.csn, key_index);
+    return bruteforce_item_hashed(item, key_index, keytable);
+}
+
 /**
  * @brief Performs brute force attack against a dump-data item, containing csn, cc_nr and mac.
  *This method calculates the hash1 for the CSN, and determines what bytes need to be bruteforced
@@ -751,35 +835,59 @@ int calculateMasterKey(uint8_t first16bytes[], uint8_t kcus[]) {
 int bruteforceDump(uint8_t dump[], size_t dumpsize, uint16_t keytable[]) {
 
     size_t itemsize = sizeof(loclass_dumpdata_t);
-    loclass_dumpdata_t *attack = (loclass_dumpdata_t *) calloc(itemsize, sizeof(uint8_t));
-    if (attack == NULL) {
+    size_t items = dumpsize / itemsize;
+
+    // hash1 of every CSN up front, also tells how much work is ahead
+    uint8_t (*key_indexes)[8] = calloc(items ? items : 1, sizeof(*key_indexes));
+    if (key_indexes == NULL) {
         PrintAndLogEx(WARNING, "Failed to allocate memory");
         return PM3_EMALLOC;
     }
 
+    uint8_t seen[128] = {0};
+    uint32_t bytes_total = 0;
+    for (size_t i = 0; i < items; i++) {
+        hash1(((loclass_dumpdata_t *)(dump + i * itemsize))->csn, key_indexes[i]);
+        for (uint8_t j = 0; j < 8; j++) {
+            if (seen[key_indexes[i][j]] == 0 && (keytable[key_indexes[i][j]] & LOCLASS_CRACKED) == 0) {
+                seen[key_indexes[i][j]] = 1;
+                bytes_total++;
+            }
+        }
+    }
+
     loclass_tc = num_CPUs();
-    PrintAndLogEx(INFO, "bruteforce using " _YELLOW_("%zu") " threads", loclass_tc);
+    loclass_tested = 0;
+    PrintAndLogEx(INFO, "bruteforce using " _YELLOW_("%zu") " threads, " _YELLOW_("%s") " bitslice", loclass_tc, bs_best_backend()->name);
+    PrintAndLogEx(INFO, _YELLOW_("%zu") " items, " _YELLOW_("%u") " keytable bytes to recover", items, bytes_total);
 
     int res = 0;
 
     uint64_t t1 = msclock();
-    for (uint16_t i = 0 ; i * itemsize < dumpsize ; i++) {
+    uint64_t perf_t0 = perf_start();
+    for (size_t i = 0 ; i < items ; i++) {
 
-        memcpy(attack, dump + i * itemsize, itemsize);
+        loclass_dumpdata_t attack;
+        memcpy(&attack, dump + i * itemsize, itemsize);
 
-        res = bruteforceItem(*attack, keytable);
+        res = bruteforce_item_hashed(attack, key_indexes[i], keytable);
         if (res != PM3_SUCCESS) {
             break;
         }
     }
 
-    free(attack);
+    free(key_indexes);
 
+    perf_stop(PERF_LOCLASS_RECOVERY, perf_t0);
     t1 = msclock() - t1;
     if (res == PM3_SUCCESS) {
         PrintAndLogEx(NORMAL, "");
     }
-    PrintAndLogEx(SUCCESS, "time " _YELLOW_("%" PRIu64) " seconds", t1 / 1000);
+    PrintAndLogEx(SUCCESS, "time " _YELLOW_("%" PRIu64) " seconds, " _YELLOW_("%" PRIu64) " candidates ( %.0f / s )"
+                  , t1 / 1000
+                  , loclass_tested
+                  , (double)loclass_tested * 1000.0 / (t1 ? t1 : 1)
+                 );
 
     if (res != PM3_SUCCESS) {
         PrintAndLogEx(ERR, "loclass key recovery( %s )", _RED_("fail"));
@@ -908,6 +1016,77 @@ static int _testHash1(void) {
     return PM3_SUCCESS;
 }
 
+// Recovers `numbytes` keytable bytes of a synthetic item and compares the candidate
+// rate against the scalar per candidate DES + MAC path.
+static int _testBruteforceSpeed(const uint8_t hs_keytable[128], uint8_t numbytes) {
+
+    loclass_dumpdata_t item = {
+        .csn = {0x01, 0x02, 0x03, 0x04, 0xF7, 0xFF, 0x12, 0xE0},
+        .cc_nr = {0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00},
+    };
+
+    // hash1 of this CSN is 7E 72 2F 40 2D 02 51 42, eight distinct indexes
+    uint8_t key_index[8] = {0};
+    hash1(item.csn, key_index);
+
+    uint8_t key_sel[8] = {0};
+    uint8_t key_sel_p[8] = {0};
+    uint8_t div_key[8] = {0};
+    for (uint8_t i = 0; i < 8; i++) {
+        key_sel[i] = hs_keytable[key_index[i]];
+    }
+    permutekey_rev(key_sel, key_sel_p);
+    diversifyKey(item.csn, key_sel_p, div_key);
+    doMAC(item.cc_nr, div_key, item.mac);
+
+    // scalar reference
+    const uint32_t n = 0x2000;
+    uint8_t mac[4] = {0};
+    uint64_t t1 = msclock();
+    for (uint32_t i = 0; i < n; i++) {
+        key_sel[0] = i & 0xFF;
+        key_sel[1] = (i >> 8) & 0xFF;
+        permutekey_rev(key_sel, key_sel_p);
+        diversifyKey(item.csn, key_sel_p, div_key);
+        doMAC_brute(item.cc_nr, div_key, mac);
+    }
+    t1 = msclock() - t1;
+    const double scalar_rate = (double)n * 1000.0 / (t1 ? t1 : 1);
+
+    uint16_t keytable[128] = {0};
+    for (uint8_t i = 0; i < 128; i++) {
+        keytable[i] = hs_keytable[i] | LOCLASS_CRACKED;
+    }
+    for (uint8_t i = 0; i < numbytes; i++) {
+        keytable[key_index[i]] = 0;
+    }
+
+    loclass_tc = num_CPUs();
+    loclass_tested = 0;
+
+    t1 = msclock();
+    int res = bruteforceItem(item, keytable);
+    t1 = msclock() - t1;
+    PrintAndLogEx(NORMAL, "");
+
+    for (uint8_t i = 0; i < numbytes && res == PM3_SUCCESS; i++) {
+        if (keytable[key_index[i]] != (hs_keytable[key_index[i]] | LOCLASS_CRACKED)) {
+            res = PM3_ESOFT;
+        }
+    }
+
+    const double rate = (double)loclass_tested * 1000.0 / (t1 ? t1 : 1);
+    PrintAndLogEx(INFO, "    scalar............. " _YELLOW_("%10.0f") " keys/s", scalar_rate);
+    PrintAndLogEx(INFO, "    %-7s x %2zu ....... " _YELLOW_("%10.0f") " keys/s  x%.1f"
+                  , bs_best_backend()->name
+                  , loclass_tc
+                  , rate
+                  , rate / scalar_rate
+                 );
+    PrintAndLogEx(INFO, "    %u bytes recovered in " _YELLOW_("%" PRIu64) " ms, %" PRIu64 " candidates", numbytes, t1, loclass_tested);
+    return res;
+}
+
 int testElite(bool slowtests) {
     PrintAndLogEx(INFO, "Testing iClass Elite functionality...");
     PrintAndLogEx(INFO, "Testing hash2...");
@@ -944,6 +1123,10 @@ int testElite(bool slowtests) {
     res += _test_iclass_key_permutation();
     PrintAndLogEx((res == PM3_SUCCESS) ? SUCCESS : WARNING, "    Key diversification ( %s )", (res == PM3_SUCCESS) ? _GREEN_("ok") : _RED_("fail"));
 
+    PrintAndLogEx(INFO, "Testing bruteforce speed...");
+    res += _testBruteforceSpeed(keytable, slowtests ? 3 : 2);
+    PrintAndLogEx((res == PM3_SUCCESS) ? SUCCESS : WARNING, "    Bruteforce ( %s )", (res == PM3_SUCCESS) ? _GREEN_("ok") : _RED_("fail"));
+
     if (slowtests) {
         res += _testBruteforce();
     }
@@ -23,6 +23,7 @@
 #include <string.h>
 #include "pm3_cmd.h"
 #include "fileutils.h"
+#include "rescache.h"
 #include "jansson.h"
 
 // NXP Appnote AN10787 - Application Directory (MAD)
@@ -221,59 +222,37 @@ const char *nxp_cluster_to_text(uint8_t cluster) {
     return "Reserved";
 }
 
+// reference to the cached `aid_desfire.json`, renewed when the file changes
 static json_t *df_known_aids = NULL;
 static bool df_known_aids_load_tried = false;
 
-static int open_aiddf_file(json_t **root, bool verbose) {
-
-    char *path;
-    int res = searchFile(&path, RESOURCES_SUBDIR, "aid_desfire", ".json", true);
-    if (res != PM3_SUCCESS) {
+static int ensure_aiddf_file_loaded(void) {
+    // a missing or broken file is only looked for once per session
+    if (df_known_aids == NULL && df_known_aids_load_tried) {
         return PM3_EFILE;
     }
+    df_known_aids_load_tried = true;
 
-    int retval = PM3_SUCCESS;
-    json_error_t error;
-
-    *root = NULL;
-    *root = json_load_file(path, 0, &error);
-    if (!*root) {
-        PrintAndLogEx(ERR, "json (%s) error on line %d: %s", path, error.line, error.text);
-        retval = PM3_ESOFT;
-        goto out;
+    json_t *root = rescache_json_load("aid_desfire", ".json", true);
+    if (root == NULL) {
+        json_decref(df_known_aids);
+        df_known_aids = NULL;
+        return PM3_EFILE;
     }
 
-    if (!json_is_array(*root)) {
+    if (!json_is_array(root)) {
+        char path[FILE_PATH_SIZE];
+        rescache_json_path(root, path, sizeof(path));
         PrintAndLogEx(ERR, "Invalid json (%s) format. root must be an array.", path);
-        json_decref(*root);
-        *root = NULL;
-        retval = PM3_ESOFT;
-        goto out;
+        json_decref(root);
+        json_decref(df_known_aids);
+        df_known_aids = NULL;
+        return PM3_ESOFT;
     }
 
-    if (verbose) {
-        PrintAndLogEx(SUCCESS, "Loaded file `" _YELLOW_("%s") "` " _GREEN_("%zu") " records ( " _GREEN_("ok") " )"
-                      , path
-                      , json_array_size(*root)
-                     );
-    }
-
-out:
-    free(path);
-    return retval;
-}
-
-static int ensure_aiddf_file_loaded(void) {
-    if (df_known_aids != NULL) {
-        return PM3_SUCCESS;
-    }
-
-    if (df_known_aids_load_tried) {
-        return PM3_EFILE;
-    }
-
-    df_known_aids_load_tried = true;
-    return open_aiddf_file(&df_known_aids, false);
+    json_decref(df_known_aids);
+    df_known_aids = root;
+    return PM3_SUCCESS;
 }
 
 static const char *aiddf_json_get_str_ex(json_t *data, const char *name, bool verbose) {
@@ -303,49 +282,10 @@ static const char *aiddf_json_get_str_quiet(json_t *data, const char *name) {
     return aiddf_json_get_str_ex(data, name, false);
 }
 
-static bool aiddf_parse_aid_str(const char *aid_str, uint32_t *aid) {
-    if (aid_str == NULL || aid == NULL || strlen(aid_str) != 6) {
-        return false;
-    }
-
-    for (int c = 0; c < 6; c++) {
-        if (isxdigit((uint8_t)aid_str[c]) == 0) {
-            return false;
-        }
-    }
-
-    char *end = NULL;
-    unsigned long parsed_aid = strtoul(aid_str, &end, 16);
-    if (end == NULL || *end != '\0' || parsed_aid > 0xFFFFFFUL) {
-        return false;
-    }
-
-    *aid = (uint32_t)parsed_aid;
-    return true;
-}
-
 static json_t *find_aiddf_entry(json_t *root, uint32_t aid) {
-    if (json_is_array(root) == false) {
-        return NULL;
-    }
-
-    for (uint32_t idx = 0; idx < json_array_size(root); idx++) {
-        json_t *data = json_array_get(root, idx);
-        if (!json_is_object(data)) {
-            continue;
-        }
-
-        uint32_t db_aid = 0;
-        if (aiddf_parse_aid_str(aiddf_json_get_str_quiet(data, "AID"), &db_aid) == false) {
-            continue;
-        }
-
-        if (db_aid == aid) {
-            return data;
-        }
-    }
-
-    return NULL;
+    char key[7] = {0};
+    snprintf(key, sizeof(key), "%06X", aid & 0xFFFFFF);
+    return rescache_json_find(root, "AID", key, 0);
 }
 
 static int print_aiddf_description(json_t *root, uint8_t aid[3], char *fmt, bool verbose) {
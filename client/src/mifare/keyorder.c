@@ -0,0 +1,881 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Adaptive key order for `hf mf fchk`
+//-----------------------------------------------------------------------------
+
+#include "keyorder.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "commonutil.h"
+#include "fileutils.h"
+#include "ui.h"
+#include "util.h"
+#include "jansson.h"
+
+// blocks bigger than this are lists, not vendor families
+#define KEYORDER_MAX_FAMILY     16
+// keys per fchk chunk, as sent by the client
+#define KEYORDER_SIM_CHUNK      (PM3_CMD_DATA_SIZE / MIFARE_KEY_SIZE)
+#define KEYORDER_SIM_SITES      8
+#define KEYORDER_SIM_MAX_SECTOR 40
+
+typedef enum {
+    KO_PINNED = 0,  // user keys
+    KO_FOUND,       // opened a sector of this card
+    KO_FAMILY,      // same dictionary block as a found key
+    KO_RANKED,      // everything else, on statistics then dictionary order
+} keyorder_class_t;
+
+typedef struct {
+    uint64_t key;
+    uint32_t family;
+    uint32_t pos;
+} keyfam_t;
+
+typedef struct {
+    uint64_t key;
+    uint32_t index;         // first position in the key list
+    uint32_t family;        // 0 when not in a family
+    uint64_t score[2];      // rank for strategy 1 and 2
+    uint64_t rank;          // score of the current strategy
+    uint8_t class;
+} keyorder_key_t;
+
+struct keyorder_s {
+    keyorder_key_t *keys;
+    uint32_t count;
+    uint32_t pinned_index;  // keys listed before it are the user's
+    uint32_t ranked;
+    uint32_t pos;
+    uint8_t strategy;
+    uint64_t *found;        // sorted keys found on the card
+    uint32_t nfound;
+    bool *hot;              // families of found keys
+    uint32_t families;
+};
+
+//-----------------------------------------------------------------------------
+// hit statistics
+//-----------------------------------------------------------------------------
+static int keystats_cmp(const void *a, const void *b) {
+    uint64_t ka = ((const keystats_entry_t *)a)->key;
+    uint64_t kb = ((const keystats_entry_t *)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+int keystats_load(keystats_t *st) {
+    memset(st, 0, sizeof(keystats_t));
+
+    char *path = NULL;
+    if (searchHomeFilePath(&path, NULL, KEYSTATS_FILE, false) != PM3_SUCCESS) {
+        return PM3_EFILE;
+    }
+    if (fileExists(path) == false) {
+        free(path);
+        return PM3_SUCCESS;
+    }
+
+    json_error_t error;
+    json_t *root = json_load_file(path, 0, &error);
+    if (root == NULL) {
+        PrintAndLogEx(ERR, "json (%s) error on line %d: %s", path, error.line, error.text);
+        free(path);
+        return PM3_EFILE;
+    }
+    free(path);
+
+    json_t *keys = json_object_get(root, "keys");
+    json_t *uids = json_object_get(root, "uids");
+    st->cards = json_integer_value(json_object_get(root, "cards"));
+    st->keys = calloc(json_array_size(keys) + 1, sizeof(keystats_entry_t));
+    st->uids = calloc(KEYSTATS_MAX_UIDS, sizeof(keystats_uid_t));
+    if (st->keys == NULL || st->uids == NULL) {
+        json_decref(root);
+        keystats_free(st);
+        return PM3_EMALLOC;
+    }
+
+    for (size_t i = 0; i < json_array_size(uids) && st->nuids < KEYSTATS_MAX_UIDS; i++) {
+        const char *hex = json_string_value(json_array_get(uids, i));
+        keystats_uid_t *u = &st->uids[st->nuids];
+        size_t hexlen = (hex) ? strlen(hex) : 0;
+        if (hexlen == 0 || hexlen > KEYSTATS_UID_LEN * 2 || (hexlen % 2) != 0 || hex_to_bytes(hex, u->uid, sizeof(u->uid)) != (int)(hexlen / 2)) {
+            continue;
+        }
+        u->uidlen = hexlen / 2;
+        st->nuids++;
+    }
+
+    for (size_t i = 0; i < json_array_size(keys); i++) {
+        json_t *elm = json_array_get(keys, i);
+        const char *hex = json_string_value(json_object_get(elm, "key"));
+        uint8_t key[MIFARE_KEY_SIZE];
+        if (hex == NULL || strlen(hex) != MIFARE_KEY_SIZE * 2 || hex_to_bytes(hex, key, sizeof(key)) != sizeof(key)) {
+            continue;
+        }
+        keystats_entry_t *e = &st->keys[st->count++];
+        e->key = bytes_to_num(key, sizeof(key));
+        e->cards = json_integer_value(json_object_get(elm, "cards"));
+        e->sectors = json_integer_value(json_object_get(elm, "sectors"));
+        e->sector0 = json_integer_value(json_object_get(elm, "sector0"));
+    }
+    json_decref(root);
+
+    qsort(st->keys, st->count, sizeof(keystats_entry_t), keystats_cmp);
+    return PM3_SUCCESS;
+}
+
+int keystats_save(const keystats_t *st) {
+    char *path = NULL;
+    if (searchHomeFilePath(&path, NULL, KEYSTATS_FILE, true) != PM3_SUCCESS) {
+        return PM3_EFILE;
+    }
+
+    json_t *root = json_object();
+    json_t *keys = json_array();
+    json_object_set_new(root, "Created", json_string("proxmark3"));
+    json_object_set_new(root, "FileType", json_string("mfc key stats"));
+    json_object_set_new(root, "cards", json_integer(st->cards));
+    for (size_t i = 0; i < st->count; i++) {
+        const keystats_entry_t *e = &st->keys[i];
+        char hex[MIFARE_KEY_SIZE * 2 + 1];
+        snprintf(hex, sizeof(hex), "%012" PRIX64, e->key);
+        json_t *elm = json_object();
+        json_object_set_new(elm, "key", json_string(hex));
+        json_object_set_new(elm, "cards", json_integer(e->cards));
+        json_object_set_new(elm, "sectors", json_integer(e->sectors));
+        json_object_set_new(elm, "sector0", json_integer(e->sector0));
+        json_array_append_new(keys, elm);
+    }
+    json_object_set_new(root, "keys", keys);
+
+    json_t *uids = json_array();
+    for (size_t i = 0; i < st->nuids; i++) {
+        json_array_append_new(uids, json_string(sprint_hex_inrow(st->uids[i].uid, st->uids[i].uidlen)));
+    }
+    json_object_set_new(root, "uids", uids);
+
+    int res = PM3_SUCCESS;
+    if (json_dump_file(root, path, JSON_INDENT(2)) != 0) {
+        PrintAndLogEx(WARNING, "Failed to save key statistics to " _YELLOW_("%s"), path);
+        res = PM3_EFILE;
+    }
+    json_decref(root);
+    free(path);
+    return res;
+}
+
+void keystats_free(keystats_t *st) {
+    free(st->keys);
+    free(st->uids);
+    memset(st, 0, sizeof(keystats_t));
+}
+
+const keystats_entry_t *keystats_get(const keystats_t *st, uint64_t key) {
+    if (st == NULL || st->count == 0) {
+        return NULL;
+    }
+    keystats_entry_t k = { .key = key };
+    return bsearch(&k, st->keys, st->count, sizeof(keystats_entry_t), keystats_cmp);
+}
+
+static keystats_entry_t *keystats_get_or_add(keystats_t *st, uint64_t key) {
+    keystats_entry_t *e = (keystats_entry_t *)keystats_get(st, key);
+    if (e) {
+        return e;
+    }
+
+    keystats_entry_t *tmp = realloc(st->keys, (st->count + 1) * sizeof(keystats_entry_t));
+    if (tmp == NULL) {
+        return NULL;
+    }
+    st->keys = tmp;
+
+    // keep it sorted
+    size_t i = st->count;
+    while (i > 0 && st->keys[i - 1].key > key) {
+        st->keys[i] = st->keys[i - 1];
+        i--;
+    }
+    memset(&st->keys[i], 0, sizeof(keystats_entry_t));
+    st->keys[i].key = key;
+    st->count++;
+    return &st->keys[i];
+}
+
+// remembers the uid, false when it was already known
+static bool keystats_add_uid(keystats_t *st, const uint8_t *uid, uint8_t uidlen) {
+    for (size_t i = 0; i < st->nuids; i++) {
+        if (st->uids[i].uidlen == uidlen && memcmp(st->uids[i].uid, uid, uidlen) == 0) {
+            return false;
+        }
+    }
+
+    if (st->uids == NULL) {
+        st->uids = calloc(KEYSTATS_MAX_UIDS, sizeof(keystats_uid_t));
+        if (st->uids == NULL) {
+            return true;
+        }
+    }
+
+    // forget the oldest card once the list is full
+    if (st->nuids == KEYSTATS_MAX_UIDS) {
+        memmove(st->uids, st->uids + 1, (KEYSTATS_MAX_UIDS - 1) * sizeof(keystats_uid_t));
+        st->nuids--;
+    }
+    keystats_uid_t *u = &st->uids[st->nuids++];
+    memcpy(u->uid, uid, uidlen);
+    u->uidlen = uidlen;
+    return true;
+}
+
+int keystats_add_card(keystats_t *st, const uint8_t *uid, uint8_t uidlen, const sector_t *e_sector, uint8_t sectors) {
+
+    if (uid && uidlen && uidlen <= KEYSTATS_UID_LEN && keystats_add_uid(st, uid, uidlen) == false) {
+        return PM3_EOPABORTED;
+    }
+
+    uint64_t seen[KEYORDER_SIM_MAX_SECTOR * 2];
+    size_t nseen = 0;
+
+    for (uint8_t s = 0; s < sectors; s++) {
+        for (uint8_t kt = 0; kt < 2; kt++) {
+            if (e_sector[s].foundKey[kt] == false) {
+                continue;
+            }
+
+            uint64_t key = e_sector[s].Key[kt];
+            keystats_entry_t *e = keystats_get_or_add(st, key);
+            if (e == NULL) {
+                return PM3_EMALLOC;
+            }
+            e->sectors++;
+
+            bool first = true;
+            for (size_t i = 0; i < nseen; i++) {
+                if (seen[i] == key) {
+                    first = false;
+                    break;
+                }
+            }
+            // sector 0 comes first, a key on it is always seen there first
+            if (first && nseen < ARRAYLEN(seen)) {
+                seen[nseen++] = key;
+                e->cards++;
+                if (s == 0) {
+                    e->sector0++;
+                }
+            }
+        }
+    }
+    st->cards++;
+    return PM3_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+// key families, the comment blocks of a dictionary
+//-----------------------------------------------------------------------------
+static int keyfam_cmp(const void *a, const void *b) {
+    const keyfam_t *fa = (const keyfam_t *)a;
+    const keyfam_t *fb = (const keyfam_t *)b;
+    if (fa->key != fb->key) {
+        return (fa->key > fb->key) - (fa->key < fb->key);
+    }
+    return (fa->pos > fb->pos) - (fa->pos < fb->pos);
+}
+
+// keys in file order, families too big to mean anything are 0
+static int keyorder_parse(const char *dictionary, keyfam_t **out, size_t *count, uint32_t *families) {
+    *out = NULL;
+    *count = 0;
+    *families = 0;
+
+    char *path = NULL;
+    if (dictionary == NULL || searchFile(&path, DICTIONARIES_SUBDIR, dictionary, ".dic", true) != PM3_SUCCESS) {
+        return PM3_EFILE;
+    }
+
+    FILE *f = fopen(path, "r");
+    free(path);
+    if (f == NULL) {
+        return PM3_EFILE;
+    }
+
+    size_t size = 1024;
+    keyfam_t *keys = calloc(size, sizeof(keyfam_t));
+    if (keys == NULL) {
+        fclose(f);
+        return PM3_EMALLOC;
+    }
+
+    uint32_t family = 1;
+    bool in_keys = false;
+    char line[255];
+    while (fgets(line, sizeof(line), f)) {
+
+        if (line[0] == '#') {
+            if (in_keys) {
+                family++;
+                in_keys = false;
+            }
+            continue;
+        }
+
+        // a key, maybe followed by an inline comment
+        size_t n = 0;
+        while (n <= MIFARE_KEY_SIZE * 2 && isxdigit((uint8_t)line[n])) {
+            n++;
+        }
+        uint8_t key[MIFARE_KEY_SIZE];
+        line[n] = '\0';
+        if (n != MIFARE_KEY_SIZE * 2 || hex_to_bytes(line, key, sizeof(key)) != sizeof(key)) {
+            continue;
+        }
+
+        if (*count == size) {
+            size *= 2;
+            keyfam_t *tmp = realloc(keys, size * sizeof(keyfam_t));
+            if (tmp == NULL) {
+                free(keys);
+                fclose(f);
+                return PM3_EMALLOC;
+            }
+            keys = tmp;
+        }
+        keys[*count] = (keyfam_t) { .key = bytes_to_num(key, sizeof(key)), .family = family, .pos = *count };
+        (*count)++;
+        in_keys = true;
+    }
+    fclose(f);
+
+    // drop the families which are just long lists
+    uint32_t *sizes = calloc(family + 1, sizeof(uint32_t));
+    if (sizes == NULL) {
+        free(keys);
+        return PM3_EMALLOC;
+    }
+    for (size_t i = 0; i < *count; i++) {
+        sizes[keys[i].family]++;
+    }
+    for (size_t i = 0; i < *count; i++) {
+        if (sizes[keys[i].family] > KEYORDER_MAX_FAMILY) {
+            keys[i].family = 0;
+        }
+    }
+    free(sizes);
+
+    *out = keys;
+    *families = family;
+    return PM3_SUCCESS;
+}
+
+static uint32_t keyfam_get(const keyfam_t *sorted, size_t count, uint64_t key) {
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (sorted[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < count && sorted[lo].key == key) ? sorted[lo].family : 0;
+}
+
+//-----------------------------------------------------------------------------
+// scheduler
+//-----------------------------------------------------------------------------
+static int u64_cmp(const void *a, const void *b) {
+    uint64_t ka = *(const uint64_t *)a;
+    uint64_t kb = *(const uint64_t *)b;
+    return (ka > kb) - (ka < kb);
+}
+
+static int keyorder_key_cmp(const void *a, const void *b) {
+    const keyorder_key_t *ka = (const keyorder_key_t *)a;
+    const keyorder_key_t *kb = (const keyorder_key_t *)b;
+    if (ka->class != kb->class) {
+        return ka->class - kb->class;
+    }
+    // pinned and found keys keep their order, the others go on rank
+    if (ka->class >= KO_FAMILY) {
+        if (ka->rank != kb->rank) {
+            return (ka->rank < kb->rank) - (ka->rank > kb->rank);
+        }
+    }
+    return (ka->index > kb->index) - (ka->index < kb->index);
+}
+
+static uint64_t keyorder_score(uint32_t a, uint32_t b, uint32_t c) {
+    return ((uint64_t)MIN(a, 0xFFFFF) << 40) | ((uint64_t)MIN(b, 0xFFFFF) << 20) | MIN(c, 0xFFFFF);
+}
+
+static keyorder_t *keyorder_new_ex(const uint8_t *keys, uint32_t count, uint32_t pinned, const keystats_t *stats, const keyfam_t *fams, size_t nfams, uint32_t families) {
+
+    keyorder_t *ko = calloc(1, sizeof(keyorder_t));
+    if (ko == NULL) {
+        return NULL;
+    }
+    ko->keys = calloc(count + 1, sizeof(keyorder_key_t));
+    ko->found = calloc(KEYORDER_SIM_MAX_SECTOR * 2, sizeof(uint64_t));
+    ko->hot = calloc(families + 1, sizeof(bool));
+    if (ko->keys == NULL || ko->found == NULL || ko->hot == NULL) {
+        keyorder_free(ko);
+        return NULL;
+    }
+    ko->families = families;
+    ko->strategy = 1;
+    ko->pinned_index = pinned;
+
+    // distinct keys, the first copy keeps its place
+    uint64_t *seen = calloc(count + 1, sizeof(uint64_t));
+    if (seen == NULL) {
+        keyorder_free(ko);
+        return NULL;
+    }
+    uint32_t nseen = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t key = bytes_to_num(keys + (i * MIFARE_KEY_SIZE), MIFARE_KEY_SIZE);
+        if (bsearch(&key, seen, nseen, sizeof(uint64_t), u64_cmp)) {
+            continue;
+        }
+        uint32_t j = nseen++;
+        while (j > 0 && seen[j - 1] > key) {
+            seen[j] = seen[j - 1];
+            j--;
+        }
+        seen[j] = key;
+
+        keyorder_key_t *k = &ko->keys[ko->count++];
+        k->key = key;
+        k->index = i;
+        k->family = keyfam_get(fams, nfams, key);
+
+        const keystats_entry_t *e = keystats_get(stats, key);
+        if (e && e->cards) {
+            k->score[0] = keyorder_score(e->sector0, e->cards, e->sectors);
+            k->score[1] = keyorder_score(e->cards, e->sectors, e->sector0);
+            ko->ranked++;
+        }
+    }
+    free(seen);
+    return ko;
+}
+
+keyorder_t *keyorder_new(const uint8_t *keys, uint32_t count, uint32_t pinned, const keystats_t *stats, const char *dictionary) {
+    keyfam_t *fams = NULL;
+    size_t nfams = 0;
+    uint32_t families = 0;
+    keyorder_parse(dictionary, &fams, &nfams, &families);
+    qsort(fams, nfams, sizeof(keyfam_t), keyfam_cmp);
+
+    keyorder_t *ko = keyorder_new_ex(keys, count, pinned, stats, fams, nfams, families);
+    free(fams);
+    return ko;
+}
+
+void keyorder_free(keyorder_t *ko) {
+    if (ko == NULL) {
+        return;
+    }
+    free(ko->keys);
+    free(ko->found);
+    free(ko->hot);
+    free(ko);
+}
+
+uint32_t keyorder_count(const keyorder_t *ko) {
+    return ko->count;
+}
+
+uint32_t keyorder_ranked(const keyorder_t *ko) {
+    return ko->ranked;
+}
+
+uint32_t keyorder_families(const keyorder_t *ko) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < ko->count; i++) {
+        n += (ko->keys[i].family != 0);
+    }
+    return n;
+}
+
+uint32_t keyorder_sent(const keyorder_t *ko) {
+    return ko->pos;
+}
+
+// collects keys found since the last call, true when there were any
+static bool keyorder_collect(keyorder_t *ko, const sector_t *e_sector, uint8_t sectors) {
+    bool added = false;
+    for (uint8_t s = 0; s < MIN(sectors, KEYORDER_SIM_MAX_SECTOR); s++) {
+        for (uint8_t kt = 0; kt < 2; kt++) {
+            if (e_sector[s].foundKey[kt] == false) {
+                continue;
+            }
+            uint64_t key = e_sector[s].Key[kt];
+            if (bsearch(&key, ko->found, ko->nfound, sizeof(uint64_t), u64_cmp)) {
+                continue;
+            }
+            uint32_t j = ko->nfound++;
+            while (j > 0 && ko->found[j - 1] > key) {
+                ko->found[j] = ko->found[j - 1];
+                j--;
+            }
+            ko->found[j] = key;
+            added = true;
+        }
+    }
+    if (added == false) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < ko->count; i++) {
+        const keyorder_key_t *k = &ko->keys[i];
+        if (k->family && bsearch(&k->key, ko->found, ko->nfound, sizeof(uint64_t), u64_cmp)) {
+            ko->hot[k->family] = true;
+        }
+    }
+    return true;
+}
+
+// classes and order of the keys not sent yet, returns how many moved up
+static uint32_t keyorder_sort(keyorder_t *ko) {
+    uint32_t moved = 0;
+    for (uint32_t i = ko->pos; i < ko->count; i++) {
+        keyorder_key_t *k = &ko->keys[i];
+        k->rank = k->score[ko->strategy - 1];
+        if (k->class == KO_PINNED) {
+            continue;
+        }
+
+        uint8_t class = KO_RANKED;
+        if (bsearch(&k->key, ko->found, ko->nfound, sizeof(uint64_t), u64_cmp)) {
+            class = KO_FOUND;
+        } else if (k->family && ko->hot[k->family]) {
+            class = KO_FAMILY;
+        }
+        if (class < k->class) {
+            moved++;
+        }
+        k->class = class;
+    }
+    qsort(ko->keys + ko->pos, ko->count - ko->pos, sizeof(keyorder_key_t), keyorder_key_cmp);
+    return moved;
+}
+
+void keyorder_begin(keyorder_t *ko, uint8_t strategy, const sector_t *e_sector, uint8_t sectors) {
+    ko->strategy = (strategy == 2) ? 2 : 1;
+    ko->pos = 0;
+
+    // user keys first, in their order
+    for (uint32_t i = 0; i < ko->count; i++) {
+        ko->keys[i].class = (ko->keys[i].index < ko->pinned_index) ? KO_PINNED : KO_RANKED;
+    }
+
+    if (e_sector) {
+        keyorder_collect(ko, e_sector, sectors);
+    }
+    keyorder_sort(ko);
+}
+
+uint32_t keyorder_next(keyorder_t *ko, uint8_t *chunk, uint32_t max) {
+    uint32_t n = MIN(max, ko->count - ko->pos);
+    for (uint32_t i = 0; i < n; i++) {
+        num_to_bytes(ko->keys[ko->pos + i].key, MIFARE_KEY_SIZE, chunk + (i * MIFARE_KEY_SIZE));
+    }
+    ko->pos += n;
+    return n;
+}
+
+uint32_t keyorder_update(keyorder_t *ko, const sector_t *e_sector, uint8_t sectors) {
+    if (keyorder_collect(ko, e_sector, sectors) == false || ko->pos == ko->count) {
+        return 0;
+    }
+    return keyorder_sort(ko);
+}
+
+//-----------------------------------------------------------------------------
+// simulator
+//-----------------------------------------------------------------------------
+typedef struct {
+    uint64_t key[KEYORDER_SIM_MAX_SECTOR][2];
+} sim_card_t;
+
+typedef struct {
+    uint8_t found[KEYORDER_SIM_MAX_SECTOR * 2];
+    uint8_t foundkeys;
+    uint64_t auths;
+} sim_state_t;
+
+static uint32_t sim_rand(uint32_t *x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+// one authentication, like chkKey() on the device
+static bool sim_auth(const sim_card_t *card, sim_state_t *st, uint8_t s, uint8_t kt, uint64_t key) {
+    st->auths++;
+    return card->key[s][kt] == key;
+}
+
+// chkKey_scanA / chkKey_scanB
+static void sim_scan(const sim_card_t *card, sim_state_t *st, uint8_t sectors, uint8_t kt, uint64_t key) {
+    for (uint8_t s = 0; s < sectors; s++) {
+        if (st->found[(s * 2) + kt]) {
+            continue;
+        }
+        if (sim_auth(card, st, s, kt, key)) {
+            st->found[(s * 2) + kt] = 1;
+            st->foundkeys++;
+        }
+    }
+}
+
+// one chunk the way MifareChkKeys_fast() in armsrc/mifarecmd.c runs it
+static void sim_chunk(const sim_card_t *card, sim_state_t *st, uint8_t sectors, uint8_t strategy, const uint8_t *keys, uint32_t n) {
+    uint8_t allkeys = sectors * 2;
+
+    if (strategy == 1) {
+        uint8_t newfound = st->foundkeys;
+        for (uint8_t s = 0; s < sectors; s++) {
+            if (st->found[s * 2] && st->found[(s * 2) + 1]) {
+                continue;
+            }
+            for (uint32_t i = 0; i < n; i++) {
+                if (st->foundkeys == allkeys) {
+                    return;
+                }
+                uint64_t key = bytes_to_num(keys + (i * MIFARE_KEY_SIZE), MIFARE_KEY_SIZE);
+                if (st->found[s * 2] == 0 && sim_auth(card, st, s, 0, key)) {
+                    st->found[s * 2] = 1;
+                    st->foundkeys++;
+                    sim_scan(card, st, sectors, 0, key);
+                    sim_scan(card, st, sectors, 1, key);
+                }
+                if (st->found[(s * 2) + 1] == 0 && sim_auth(card, st, s, 1, key)) {
+                    st->found[(s * 2) + 1] = 1;
+                    st->foundkeys++;
+                    sim_scan(card, st, sectors, 1, key);
+                }
+                if (st->found[s * 2] && st->found[(s * 2) + 1]) {
+                    break;
+                }
+            }
+            // nothing found, next chunk
+            if (newfound == st->foundkeys) {
+                return;
+            }
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t key = bytes_to_num(keys + (i * MIFARE_KEY_SIZE), MIFARE_KEY_SIZE);
+        for (uint8_t s = 0; s < sectors; s++) {
+            if (st->found[s * 2] && st->found[(s * 2) + 1]) {
+                continue;
+            }
+            if (st->foundkeys == allkeys) {
+                return;
+            }
+            if (st->found[s * 2] == 0 && sim_auth(card, st, s, 0, key)) {
+                st->found[s * 2] = 1;
+                st->foundkeys++;
+                sim_scan(card, st, sectors, 0, key);
+            }
+            if (st->found[(s * 2) + 1] == 0 && sim_auth(card, st, s, 1, key)) {
+                st->found[(s * 2) + 1] = 1;
+                st->foundkeys++;
+                sim_scan(card, st, sectors, 1, key);
+            }
+        }
+    }
+}
+
+static void sim_table(const sim_card_t *card, const sim_state_t *st, uint8_t sectors, sector_t *e_sector) {
+    for (uint8_t s = 0; s < sectors; s++) {
+        for (uint8_t kt = 0; kt < 2; kt++) {
+            if (st->found[(s * 2) + kt] && e_sector[s].foundKey[kt] == false) {
+                e_sector[s].Key[kt] = card->key[s][kt];
+                e_sector[s].foundKey[kt] = true;
+            }
+        }
+    }
+}
+
+// fchk with the keys in the order given, returns round trips
+static uint32_t sim_fchk_plain(const sim_card_t *card, uint8_t sectors, const uint8_t *keys, uint32_t count, uint64_t *auths) {
+    uint32_t chunks = 0;
+    sim_state_t st;
+    for (uint8_t strategy = 1; strategy < 3; strategy++) {
+        memset(&st, 0, sizeof(st));
+        for (uint32_t i = 0; i < count; i += KEYORDER_SIM_CHUNK) {
+            uint32_t n = MIN(KEYORDER_SIM_CHUNK, count - i);
+            sim_chunk(card, &st, sectors, strategy, keys + (i * MIFARE_KEY_SIZE), n);
+            chunks++;
+            if (st.foundkeys == sectors * 2) {
+                *auths += st.auths;
+                return chunks;
+            }
+        }
+        *auths += st.auths;
+    }
+    return chunks;
+}
+
+// fchk through the scheduler, e_sector gets the keys found
+static uint32_t sim_fchk_adaptive(const sim_card_t *card, uint8_t sectors, keyorder_t *ko, sector_t *e_sector, uint64_t *auths) {
+    uint8_t chunk[KEYORDER_SIM_CHUNK * MIFARE_KEY_SIZE];
+    uint32_t chunks = 0;
+    sim_state_t st;
+    for (uint8_t strategy = 1; strategy < 3; strategy++) {
+        memset(&st, 0, sizeof(st));
+        keyorder_begin(ko, strategy, e_sector, sectors);
+        uint32_t n;
+        while ((n = keyorder_next(ko, chunk, KEYORDER_SIM_CHUNK)) > 0) {
+            sim_chunk(card, &st, sectors, strategy, chunk, n);
+            chunks++;
+            sim_table(card, &st, sectors, e_sector);
+            if (st.foundkeys == sectors * 2) {
+                *auths += st.auths;
+                return chunks;
+            }
+            keyorder_update(ko, e_sector, sectors);
+        }
+        *auths += st.auths;
+    }
+    return chunks;
+}
+
+typedef struct {
+    uint64_t a;
+    uint64_t b;
+    bool mad;
+    uint64_t sectors;       // bitmap of sectors left on the transport keys
+} sim_site_t;
+
+static void sim_make_card(sim_card_t *card, const sim_site_t *site, uint8_t sectors, bool unknown, uint32_t *rnd) {
+    for (uint8_t s = 0; s < sectors; s++) {
+        if ((site->sectors >> s) & 1) {
+            card->key[s][0] = 0xFFFFFFFFFFFF;
+            card->key[s][1] = 0xFFFFFFFFFFFF;
+        } else if (unknown) {
+            // diversified keys, no dictionary finds them
+            card->key[s][0] = (((uint64_t)sim_rand(rnd) << 16) ^ sim_rand(rnd)) & 0xFFFFFFFFFFFF;
+            card->key[s][1] = (((uint64_t)sim_rand(rnd) << 16) ^ sim_rand(rnd)) & 0xFFFFFFFFFFFF;
+        } else {
+            card->key[s][0] = site->a;
+            card->key[s][1] = site->b;
+        }
+    }
+    if (site->mad) {
+        card->key[0][0] = 0xA0A1A2A3A4A5;
+        card->key[0][1] = site->b;
+    }
+}
+
+int keyorder_simulate(const uint8_t *keys, uint32_t count, const char *dictionary, uint32_t cards, uint8_t sectors, uint32_t seed, keyorder_sim_t *res) {
+    memset(res, 0, sizeof(keyorder_sim_t));
+    if (count == 0 || sectors == 0 || sectors > KEYORDER_SIM_MAX_SECTOR) {
+        return PM3_EINVARG;
+    }
+
+    keyfam_t *fams = NULL;
+    size_t nfams = 0;
+    uint32_t families = 0;
+    int ret = keyorder_parse(dictionary, &fams, &nfams, &families);
+    if (ret != PM3_SUCCESS || nfams < 2) {
+        free(fams);
+        return (ret == PM3_SUCCESS) ? PM3_EINVARG : ret;
+    }
+
+    uint32_t rnd = seed ? seed : 1;
+
+    // sites keyed from dictionary blocks with an A and a B key, some with
+    // a MAD and some sectors still on the transport keys
+    sim_site_t sites[KEYORDER_SIM_SITES];
+    for (uint8_t i = 0; i < KEYORDER_SIM_SITES; i++) {
+        size_t p = 0;
+        for (uint32_t tries = 0; tries < 1000; tries++) {
+            p = sim_rand(&rnd) % (nfams - 1);
+            if (fams[p].family && fams[p].family == fams[p + 1].family) {
+                break;
+            }
+        }
+        sites[i].a = fams[p].key;
+        sites[i].b = fams[p + 1].key;
+        sites[i].mad = sim_rand(&rnd) & 1;
+        sites[i].sectors = 0;
+        for (uint8_t s = 1; s < sectors; s++) {
+            if ((sim_rand(&rnd) & 7) == 0) {
+                sites[i].sectors |= (1ULL << s);
+            }
+        }
+    }
+
+    qsort(fams, nfams, sizeof(keyfam_t), keyfam_cmp);
+
+    keystats_t stats = {0};
+    sector_t *e_sector = calloc(sectors, sizeof(sector_t));
+    if (e_sector == NULL) {
+        free(fams);
+        return PM3_EMALLOC;
+    }
+
+    for (uint32_t c = 0; c < cards; c++) {
+
+        // a few sites make most of the cards
+        uint32_t w = sim_rand(&rnd) % 1000;
+        uint8_t site = 0;
+        while (site < KEYORDER_SIM_SITES - 1 && w >= 400) {
+            w = (w - 400) * 10 / 6;
+            site++;
+        }
+
+        sim_card_t card;
+        sim_make_card(&card, &sites[site], sectors, (sim_rand(&rnd) % 10) == 0, &rnd);
+
+        res->chunks[0] += sim_fchk_plain(&card, sectors, keys, count, &res->auths[0]);
+
+        keyorder_t *ko = keyorder_new_ex(keys, count, 0, &stats, fams, nfams, families);
+        if (ko == NULL) {
+            ret = PM3_EMALLOC;
+            break;
+        }
+        memset(e_sector, 0, sectors * sizeof(sector_t));
+        res->chunks[1] += sim_fchk_adaptive(&card, sectors, ko, e_sector, &res->auths[1]);
+        keyorder_free(ko);
+
+        bool all = true;
+        for (uint8_t s = 0; s < sectors; s++) {
+            all &= e_sector[s].foundKey[0] && e_sector[s].foundKey[1];
+        }
+        res->opened += all;
+        res->cards++;
+
+        keystats_add_card(&stats, NULL, 0, e_sector, sectors);
+    }
+
+    free(e_sector);
+    keystats_free(&stats);
+    free(fams);
+    return ret;
+}
@@ -0,0 +1,98 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Adaptive key order for `hf mf fchk`
+//
+// Keys on a card cluster: a site key opens most sectors, the MAD key opens
+// sector 0 and vendors hand out keys in groups, which the dictionary keeps
+// together between comment lines.  Keys are sent in that spirit: keys already
+// found on the card first, then the rest of their dictionary block, then the
+// keys that opened most cards before.  The ranking is kept per user in
+// ~/.proxmark3/mfc_key_stats.json
+//-----------------------------------------------------------------------------
+
+#ifndef KEYORDER_H__
+#define KEYORDER_H__
+
+#include "common.h"
+#include "mifarehost.h"
+
+#define KEYSTATS_FILE       "mfc_key_stats.json"
+// cards remembered so a card checked again is not counted twice
+#define KEYSTATS_MAX_UIDS   1024
+#define KEYSTATS_UID_LEN    10
+
+typedef struct {
+    uint64_t key;
+    uint32_t cards;         // cards with at least one sector opened by the key
+    uint32_t sectors;       // key slots opened
+    uint32_t sector0;       // cards whose sector 0 it opened
+} keystats_entry_t;
+
+typedef struct {
+    uint8_t uid[KEYSTATS_UID_LEN];
+    uint8_t uidlen;
+} keystats_uid_t;
+
+typedef struct {
+    keystats_entry_t *keys; // sorted on key
+    size_t count;
+    uint32_t cards;
+    keystats_uid_t *uids;   // cards counted, oldest first
+    size_t nuids;
+} keystats_t;
+
+// empty statistics when there is no file yet
+int keystats_load(keystats_t *st);
+int keystats_save(const keystats_t *st);
+void keystats_free(keystats_t *st);
+const keystats_entry_t *keystats_get(const keystats_t *st, uint64_t key);
+// record the keys found on one card. A card whose uid was recorded before is
+// skipped with PM3_EOPABORTED, without a uid every call counts
+int keystats_add_card(keystats_t *st, const uint8_t *uid, uint8_t uidlen, const sector_t *e_sector, uint8_t sectors);
+
+typedef struct keyorder_s keyorder_t;
+
+// the first `pinned` keys are the user's and are always sent first.
+// dictionary names the file whose comment blocks make the key families, NULL for none
+keyorder_t *keyorder_new(const uint8_t *keys, uint32_t count, uint32_t pinned, const keystats_t *stats, const char *dictionary);
+void keyorder_free(keyorder_t *ko);
+
+// distinct keys, the length of a pass
+uint32_t keyorder_count(const keyorder_t *ko);
+uint32_t keyorder_ranked(const keyorder_t *ko);
+uint32_t keyorder_families(const keyorder_t *ko);
+
+// start a pass of fchk strategy 1 (depth first) or 2 (width first)
+void keyorder_begin(keyorder_t *ko, uint8_t strategy, const sector_t *e_sector, uint8_t sectors);
+// next chunk of at most max keys, 0 once the pass is done
+uint32_t keyorder_next(keyorder_t *ko, uint8_t *chunk, uint32_t max);
+uint32_t keyorder_sent(const keyorder_t *ko);
+// after a chunk, moves up the keys related to keys found since the last call.
+// Returns how many keys moved
+uint32_t keyorder_update(keyorder_t *ko, const sector_t *e_sector, uint8_t sectors);
+
+typedef struct {
+    uint32_t cards;
+    uint32_t opened;        // cards with every key found
+    uint64_t chunks[2];     // dictionary order, adaptive order
+    uint64_t auths[2];
+} keyorder_sim_t;
+
+// replays fchk against synthetic cards of sites keyed from the dictionary,
+// once in the order given and once adaptively, learning as it goes
+int keyorder_simulate(const uint8_t *keys, uint32_t count, const char *dictionary, uint32_t cards, uint8_t sectors, uint32_t seed, keyorder_sim_t *res);
+
+#endif
@@ -23,6 +23,7 @@
 #include "crc.h"
 #include "util.h"
 #include "fileutils.h"
+#include "rescache.h"
 #include "jansson.h"
 #include "mifaredefault.h"
 #include "mifare4.h"
@@ -48,28 +49,20 @@ static const char *aid_admin[] = {
 };
 
 static int open_mad_file(json_t **root, bool verbose) {
-    char *path;
-    int res = searchFile(&path, RESOURCES_SUBDIR, "mad", ".json", true);
-    if (res != PM3_SUCCESS) {
+    // parsed once per session, see rescache.c
+    *root = rescache_json_load("mad", ".json", true);
+    if (*root == NULL) {
         return PM3_EFILE;
     }
 
-    int retval = PM3_SUCCESS;
-    json_error_t error;
-
-    *root = json_load_file(path, 0, &error);
-    if (!*root) {
-        PrintAndLogEx(ERR, "json (%s) error on line %d: %s", path, error.line, error.text);
-        retval = PM3_ESOFT;
-        goto out;
-    }
+    char path[FILE_PATH_SIZE];
+    rescache_json_path(*root, path, sizeof(path));
 
     if (!json_is_array(*root)) {
         PrintAndLogEx(ERR, "Invalid json (%s) format. root must be an array.", path);
         json_decref(*root);
         *root = NULL;
-        retval = PM3_ESOFT;
-        goto out;
+        return PM3_ESOFT;
     }
 
     if (verbose) {
@@ -78,10 +71,7 @@ static int open_mad_file(json_t **root, bool verbose) {
                       , json_array_size(*root)
                      );
     }
-
-out:
-    free(path);
-    return retval;
+    return PM3_SUCCESS;
 }
 
 static int close_mad_file(json_t *root) {
@@ -115,31 +105,7 @@ static uint16_t madGetAID(uint16_t raw, bool swapmad) {
 static json_t *mad_lookup_aid(json_t *root, uint16_t aid) {
     char lmad[7] = {0};
     snprintf(lmad, sizeof(lmad), "0x%04x", aid);
-
-    for (uint32_t idx = 0; idx < json_array_size(root); idx++) {
-
-        json_t *data = json_array_get(root, idx);
-        if (!json_is_object(data)) {
-            PrintAndLogEx(ERR, "data [%u] is not an object", idx);
-            continue;
-        }
-
-        const char *fmad = mad_json_get_str(data, "mad");
-        if (fmad == NULL) {
-            continue;
-        }
-
-        char lfmad[16];
-        strncpy(lfmad, fmad, sizeof(lfmad) - 1);
-        lfmad[sizeof(lfmad) - 1] = '\0';
-
-        str_lower(lfmad);
-
-        if (strcmp(lmad, lfmad) == 0) {
-            return data;
-        }
-    }
-    return NULL;
+    return rescache_json_find(root, "mad", lmad, 0);
 }
 
 static const char *mad_aid_description(json_t *elm) {
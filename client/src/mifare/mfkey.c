@@ -19,6 +19,7 @@
 #include "mfkey.h"
 
 #include "crapto1/crapto1.h"
+#include "perf.h"
 
 // MIFARE
 int inline compare_uint64(const void *a, const void *b) {
@@ -106,7 +107,9 @@ bool mfkey32(nonces_t *data, uint64_t *outputkey) {
 
     uint32_t p640 = prng_successor(data->nonce, 64);
 
+    uint64_t perf_t0 = perf_start();
     s = lfsr_recovery32(data->ar ^ p640, 0);
+    perf_stop(PERF_CRYPTO1_RECOVERY, perf_t0);
 
     for (t = s; t->odd | t->even; ++t) {
         lfsr_rollback_word(t, 0, 0);
@@ -138,7 +141,9 @@ bool mfkey32_moebius(nonces_t *data, uint64_t *outputkey) {
     uint32_t p640 = prng_successor(data->nonce, 64);
     uint32_t p641 = prng_successor(data->nonce2, 64);
 
+    uint64_t perf_t0 = perf_start();
     s = lfsr_recovery32(data->ar ^ p640, 0);
+    perf_stop(PERF_CRYPTO1_RECOVERY, perf_t0);
 
     for (t = s; t->odd | t->even; ++t) {
         lfsr_rollback_word(t, 0, 0);
@@ -175,7 +180,9 @@ bool mfkey32_nested(nonces_t *data, uint64_t *outputkey) {
     uint32_t ar_enc = data->ar;
     uint32_t ks0 = nt_enc ^ nt;
     uint32_t ks2 = ar_enc ^ ar;
+    uint64_t perf_t0 = perf_start();
     s = lfsr_recovery32(ks0, uid ^ nt);
+    perf_stop(PERF_CRYPTO1_RECOVERY, perf_t0);
     for (t = s; t->odd | t->even; ++t) {
         crypto1_word(t, nr_enc, 1);
         if (ks2 == crypto1_word(t, 0, 0)) {
@@ -202,7 +209,9 @@ int mfkey64(nonces_t *data, uint64_t *outputkey) {
     // Extract the keystream from the messages
     ks2 = data->ar ^ prng_successor(data->nonce, 64);
     ks3 = data->at ^ prng_successor(data->nonce, 96);
+    uint64_t perf_t0 = perf_start();
     revstate = lfsr_recovery64(ks2, ks3);
+    perf_stop(PERF_CRYPTO1_RECOVERY, perf_t0);
     lfsr_rollback_word(revstate, 0, 0);
     lfsr_rollback_word(revstate, 0, 0);
     lfsr_rollback_word(revstate, data->nr, 1);
@@ -0,0 +1,252 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// `hf mf autopwn` session state
+//-----------------------------------------------------------------------------
+
+#include "mfsession.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "commonutil.h"
+#include "fileutils.h"
+#include "ui.h"
+#include "util.h"
+#include "jansson.h"
+
+// `hf-mf-<UID><suffix>` in the dump folder
+static void mfsession_filename(const mfsession_t *s, const char *suffix, char *out, size_t outlen) {
+    char name[64] = "hf-mf-";
+    FillFileNameByUID(name, s->uid, "", s->uidlen);
+
+    const char *dir = g_session.defaultPaths[spDump];
+    if (dir != NULL && strlen(dir) > 0) {
+        snprintf(out, outlen, "%s%s%s%s", dir, PATHSEP, name, suffix);
+    } else {
+        snprintf(out, outlen, "%s%s", name, suffix);
+    }
+}
+
+void mfsession_init(mfsession_t *s, const uint8_t *uid, uint8_t uidlen, uint8_t sectors, bool enabled) {
+    memset(s, 0, sizeof(mfsession_t));
+    s->enabled = enabled;
+    s->uidlen = MIN(uidlen, sizeof(s->uid));
+    memcpy(s->uid, uid, s->uidlen);
+    s->sectors = MIN(sectors, MFSESSION_MAX_SECTORS);
+    mfsession_filename(s, "-session.json", s->path, sizeof(s->path));
+}
+
+void mfsession_nonce_file(const mfsession_t *s, uint8_t sector, uint8_t keytype, char *out, size_t outlen) {
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "-nonces-%02u%c.bin", sector, (keytype == MF_KEY_B) ? 'B' : 'A');
+    mfsession_filename(s, suffix, out, outlen);
+}
+
+static void mfsession_load_slot(mfsession_t *s, uint8_t sector, uint8_t keytype, json_t *elm) {
+    if (json_is_object(elm) == false) {
+        return;
+    }
+
+    const char *hex = json_string_value(json_object_get(elm, "key"));
+    const char *found = json_string_value(json_object_get(elm, "found"));
+    uint8_t key[MIFARE_KEY_SIZE];
+    if (hex && found && strlen(found) == 1 && strlen(hex) == MIFARE_KEY_SIZE * 2 && hex_to_bytes(hex, key, sizeof(key)) == sizeof(key)) {
+        s->keys[sector].Key[keytype] = bytes_to_num(key, sizeof(key));
+        s->keys[sector].foundKey[keytype] = found[0];
+    }
+
+    mfsession_slot_t *slot = &s->slots[sector][keytype];
+    slot->nested = json_integer_value(json_object_get(elm, "nested"));
+    slot->hardnested = json_integer_value(json_object_get(elm, "hardnested"));
+    slot->staticnested = json_integer_value(json_object_get(elm, "staticnested"));
+
+    // only count nonce files still around
+    if (json_is_true(json_object_get(elm, "nonces"))) {
+        char fn[FILE_PATH_SIZE];
+        mfsession_nonce_file(s, sector, keytype, fn, sizeof(fn));
+        slot->nonces = fileExists(fn);
+    }
+}
+
+int mfsession_load(mfsession_t *s) {
+    if (s->enabled == false || fileExists(s->path) == false) {
+        return PM3_ENODATA;
+    }
+
+    json_error_t error;
+    json_t *root = json_load_file(s->path, 0, &error);
+    if (root == NULL) {
+        PrintAndLogEx(ERR, "json (%s) error on line %d: %s", s->path, error.line, error.text);
+        return PM3_EFILE;
+    }
+
+    // the file name holds the UID but it could be copied around
+    const char *uid = sprint_hex_inrow(s->uid, s->uidlen);
+    const char *file_uid = json_string_value(json_object_get(root, "uid"));
+    if (file_uid == NULL || strcasecmp(file_uid, uid) != 0 || json_integer_value(json_object_get(root, "sectors")) != s->sectors) {
+        PrintAndLogEx(WARNING, "Session " _YELLOW_("%s") " is for another card or card type, ignored", s->path);
+        json_decref(root);
+        return PM3_ENODATA;
+    }
+
+    s->runs = json_integer_value(json_object_get(root, "runs"));
+    s->darkside = json_integer_value(json_object_get(root, "darkside"));
+    s->nested_failed = json_is_true(json_object_get(root, "nested_failed"));
+
+    json_t *dict = json_object_get(root, "dictionary");
+    s->dictionary_done = json_is_true(json_object_get(dict, "done"));
+    s->dictionary_keys = json_integer_value(json_object_get(dict, "keys"));
+    const char *name = json_string_value(json_object_get(dict, "name"));
+    if (name) {
+        strncpy(s->dictionary, name, sizeof(s->dictionary) - 1);
+    }
+
+    json_t *keys = json_object_get(root, "keys");
+    for (size_t i = 0; i < json_array_size(keys); i++) {
+        json_t *elm = json_array_get(keys, i);
+        json_int_t sector = json_integer_value(json_object_get(elm, "sector"));
+        if (sector < 0 || sector >= s->sectors) {
+            continue;
+        }
+        mfsession_load_slot(s, sector, MF_KEY_A, json_object_get(elm, "A"));
+        mfsession_load_slot(s, sector, MF_KEY_B, json_object_get(elm, "B"));
+    }
+    json_decref(root);
+
+    s->resumed = true;
+    return PM3_SUCCESS;
+}
+
+static json_t *mfsession_save_slot(const mfsession_t *s, uint8_t sector, uint8_t keytype) {
+    json_t *elm = json_object();
+    uint8_t found = s->keys[sector].foundKey[keytype];
+    if (found) {
+        char hex[MIFARE_KEY_SIZE * 2 + 1];
+        snprintf(hex, sizeof(hex), "%012" PRIX64, s->keys[sector].Key[keytype]);
+        // plain found flag from a key check counts as dictionary
+        char letter[2] = { (found < 'A') ? 'D' : (char)found, 0 };
+        json_object_set_new(elm, "key", json_string(hex));
+        json_object_set_new(elm, "found", json_string(letter));
+    }
+
+    const mfsession_slot_t *slot = &s->slots[sector][keytype];
+    json_object_set_new(elm, "nested", json_integer(slot->nested));
+    json_object_set_new(elm, "hardnested", json_integer(slot->hardnested));
+    json_object_set_new(elm, "staticnested", json_integer(slot->staticnested));
+    json_object_set_new(elm, "nonces", json_boolean(slot->nonces));
+    return elm;
+}
+
+int mfsession_save(mfsession_t *s, const sector_t *e_sector) {
+    if (s->enabled == false) {
+        return PM3_SUCCESS;
+    }
+
+    if (e_sector) {
+        memcpy(s->keys, e_sector, s->sectors * sizeof(sector_t));
+    }
+
+    json_t *root = json_object();
+    json_object_set_new(root, "Created", json_string("proxmark3"));
+    json_object_set_new(root, "FileType", json_string("mfc autopwn session"));
+    json_object_set_new(root, "uid", json_string(sprint_hex_inrow(s->uid, s->uidlen)));
+    json_object_set_new(root, "sectors", json_integer(s->sectors));
+    json_object_set_new(root, "runs", json_integer(s->runs));
+
+    json_t *dict = json_object();
+    json_object_set_new(dict, "done", json_boolean(s->dictionary_done));
+    json_object_set_new(dict, "name", json_string(s->dictionary));
+    json_object_set_new(dict, "keys", json_integer(s->dictionary_keys));
+    json_object_set_new(root, "dictionary", dict);
+
+    json_object_set_new(root, "darkside", json_integer(s->darkside));
+    json_object_set_new(root, "nested_failed", json_boolean(s->nested_failed));
+
+    json_t *keys = json_array();
+    for (uint8_t i = 0; i < s->sectors; i++) {
+        json_t *elm = json_object();
+        json_object_set_new(elm, "sector", json_integer(i));
+        json_object_set_new(elm, "A", mfsession_save_slot(s, i, MF_KEY_A));
+        json_object_set_new(elm, "B", mfsession_save_slot(s, i, MF_KEY_B));
+        json_array_append_new(keys, elm);
+    }
+    json_object_set_new(root, "keys", keys);
+
+    int res = PM3_SUCCESS;
+    if (json_dump_file(root, s->path, JSON_INDENT(2)) != 0) {
+        PrintAndLogEx(WARNING, "Failed to save autopwn session to " _YELLOW_("%s"), s->path);
+        res = PM3_EFILE;
+    }
+    json_decref(root);
+    return res;
+}
+
+void mfsession_remove(mfsession_t *s) {
+    if (s->enabled == false) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < s->sectors; i++) {
+        for (uint8_t j = MF_KEY_A; j <= MF_KEY_B; j++) {
+            char fn[FILE_PATH_SIZE];
+            mfsession_nonce_file(s, i, j, fn, sizeof(fn));
+            if (fileExists(fn)) {
+                remove(fn);
+            }
+            s->slots[i][j].nonces = false;
+        }
+    }
+
+    if (fileExists(s->path)) {
+        remove(s->path);
+    }
+}
+
+uint8_t mfsession_found(const mfsession_t *s) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < s->sectors; i++) {
+        n += (s->keys[i].foundKey[MF_KEY_A] != 0) + (s->keys[i].foundKey[MF_KEY_B] != 0);
+    }
+    return n;
+}
+
+uint32_t mfsession_keys(const mfsession_t *s, uint8_t **keys) {
+    *keys = calloc(s->sectors * 2 + 1, MIFARE_KEY_SIZE);
+    if (*keys == NULL) {
+        return 0;
+    }
+
+    uint32_t n = 0;
+    for (uint8_t i = 0; i < s->sectors; i++) {
+        for (uint8_t j = MF_KEY_A; j <= MF_KEY_B; j++) {
+            if (s->keys[i].foundKey[j] == 0) {
+                continue;
+            }
+
+            uint8_t key[MIFARE_KEY_SIZE];
+            num_to_bytes(s->keys[i].Key[j], MIFARE_KEY_SIZE, key);
+
+            bool seen = false;
+            for (uint32_t k = 0; k < n && seen == false; k++) {
+                seen = (memcmp(*keys + (k * MIFARE_KEY_SIZE), key, MIFARE_KEY_SIZE) == 0);
+            }
+            if (seen == false) {
+                memcpy(*keys + (n++ * MIFARE_KEY_SIZE), key, MIFARE_KEY_SIZE);
+            }
+        }
+    }
+    return n;
+}
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// `hf mf autopwn` session state
+//
+// Progress of an autopwn run is kept in `hf-mf-<UID>-session.json` next to the
+// dumps: the keys found and how, whether the dictionary pass is done, the
+// attacks tried per key slot and the hardnested nonce files.  A run on the
+// same card picks it up again, so a card pulled away halfway costs only the
+// sector being worked on.
+//-----------------------------------------------------------------------------
+
+#ifndef MFSESSION_H__
+#define MFSESSION_H__
+
+#include "common.h"
+#include "mifarehost.h"
+
+// 4K plus the two hidden sectors of EV1
+#define MFSESSION_MAX_SECTORS   (MIFARE_4K_MAXSECTOR + 2)
+
+typedef struct {
+    uint8_t nested;         // nested runs
+    uint8_t hardnested;     // hardnested runs
+    uint8_t staticnested;   // static nested runs
+    bool nonces;            // hardnested nonces kept on file
+} mfsession_slot_t;
+
+typedef struct {
+    bool enabled;           // false, nothing gets loaded or saved
+    bool resumed;
+    char path[FILE_PATH_SIZE];
+    uint8_t uid[10];
+    uint8_t uidlen;
+    uint8_t sectors;
+    uint32_t runs;
+    // dictionary pass, done for the dictionary named
+    bool dictionary_done;
+    char dictionary[FILE_PATH_SIZE];
+    uint32_t dictionary_keys;
+    uint8_t darkside;       // darkside runs
+    bool nested_failed;     // PRNG not predictable or nested gave up
+    // foundKey holds the attack letter, see printKeyTable
+    sector_t keys[MFSESSION_MAX_SECTORS];
+    mfsession_slot_t slots[MFSESSION_MAX_SECTORS][2];
+} mfsession_t;
+
+void mfsession_init(mfsession_t *s, const uint8_t *uid, uint8_t uidlen, uint8_t sectors, bool enabled);
+// PM3_SUCCESS when a session of this card was loaded, PM3_ENODATA when there is none
+int mfsession_load(mfsession_t *s);
+// takes the keys from e_sector before writing
+int mfsession_save(mfsession_t *s, const sector_t *e_sector);
+// removes the session file and its nonce files
+void mfsession_remove(mfsession_t *s);
+
+uint8_t mfsession_found(const mfsession_t *s);
+// distinct keys of the session, allocated, caller frees
+uint32_t mfsession_keys(const mfsession_t *s, uint8_t **keys);
+// the hardnested nonce file of a key slot
+void mfsession_nonce_file(const mfsession_t *s, uint8_t sector, uint8_t keytype, char *out, size_t outlen);
+
+#endif
@@ -45,6 +45,7 @@
 #include "parity.h"
 #include "pmflash.h"
 #include "preferences.h"        // setDeviceDebugLevel
+#include "perf.h"
 
 int mf_dark_side(uint8_t blockno, uint8_t key_type, uint64_t *key) {
     uint32_t uid = 0;
@@ -334,8 +335,9 @@ int mf_check_keys_fast_ex(uint8_t sectorsCnt, uint8_t firstChunk, uint8_t lastCh
         PrintAndLogEx(INFO, "Chunk %.1fs | found %u/%u keys (%u)", (float)(t2 / 1000.0), curr_keys, (sectorsCnt << 1), size);
     }
 
-    // all keys?
-    if (curr_keys == sectorsCnt * 2 || lastChunk) {
+    // all keys?  Newer firmware sends the table with every chunk, it lets
+    // the caller reorder the keys still to send
+    if (curr_keys == sectorsCnt * 2 || lastChunk || resp.length >= 480 + 10) {
 
         // success array. each byte is status of key
         uint8_t arr[80];
@@ -381,7 +383,7 @@ int mf_check_keys_fast_ex(uint8_t sectorsCnt, uint8_t firstChunk, uint8_t lastCh
         }
 
         // if some keys was found
-        if (curr_keys > 0)  {
+        if (curr_keys > 0 && lastChunk)  {
             return PM3_EPARTIAL;
         }
 
@@ -516,7 +518,9 @@ __attribute__((force_align_arg_pointer))
 *nested_worker_thread(void *arg) {
     struct Crypto1State *p1;
     StateList_t *statelist = arg;
+    uint64_t perf_t0 = perf_start();
     statelist->head.slhead = lfsr_recovery32(statelist->ks1, statelist->nt_enc ^ statelist->uid);
+    perf_stop(PERF_CRYPTO1_RECOVERY, perf_t0);
 
     for (p1 = statelist->head.slhead; p1->odd | p1->even; p1++) {};
 
@@ -1382,7 +1386,9 @@ int try_decrypt_word(uint32_t nt, uint32_t ar_enc, uint32_t at_enc, uint8_t *dat
     uint32_t ks2 = ar_enc ^ prng_successor(nt, 64);
     uint32_t ks3 = at_enc ^ prng_successor(nt, 96);
 
+    uint64_t perf_t0 = perf_start();
     struct Crypto1State *s = lfsr_recovery64(ks2, ks3);
+    perf_stop(PERF_CRYPTO1_RECOVERY, perf_t0);
     mf_crypto1_decrypt(s, data, len, false);
     PrintAndLogEx(SUCCESS, "decrypted data... " _YELLOW_("%s"), sprint_hex(data, len));
     PrintAndLogEx(NORMAL, "");
@@ -0,0 +1,394 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Client performance counters
+//-----------------------------------------------------------------------------
+
+#include "perf.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "jansson.h"
+#include "ui.h"
+#include "fileutils.h"
+
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+#include <malloc.h>
+#define PERF_HAVE_MALLINFO2 1
+#endif
+
+// bucket 0 holds zeroes, bucket b holds [2^(b-1), 2^b - 1]
+#define PERF_HIST_BUCKETS  65
+// open addressed, must be a power of two
+#define PERF_CMD_SLOTS     256
+
+typedef enum {
+    PERF_UNIT_US,
+    PERF_UNIT_BYTES,
+    PERF_UNIT_COUNT,
+} perf_unit_t;
+
+typedef struct {
+    const char *name;
+    perf_unit_t unit;
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t hist[PERF_HIST_BUCKETS];
+} perf_stat_t;
+
+typedef struct {
+    uint32_t key;           // cmd + 1, zero for a free slot
+    uint64_t tx_frames;
+    uint64_t tx_bytes;
+    uint64_t rx_frames;
+    uint64_t rx_bytes;
+} perf_cmd_t;
+
+#define PERF_STAT(n, u) { .name = (n), .unit = (u), .min = UINT64_MAX }
+
+bool g_perf_enabled = false;
+
+static perf_stat_t perf_stats[PERF_MAX] = {
+    [PERF_COMMS_TXQUEUE]    = PERF_STAT("comms.txqueue",     PERF_UNIT_US),
+    [PERF_COMMS_ROUNDTRIP]  = PERF_STAT("comms.roundtrip",   PERF_UNIT_US),
+    [PERF_COMMS_TIMEOUT]    = PERF_STAT("comms.timeout",     PERF_UNIT_COUNT),
+    [PERF_COMMS_BULK]       = PERF_STAT("comms.bulk",        PERF_UNIT_US),
+    [PERF_COMMS_BULK_BYTES] = PERF_STAT("comms.bulk.bytes",  PERF_UNIT_BYTES),
+    [PERF_PRINT]            = PERF_STAT("ui.print",          PERF_UNIT_US),
+    [PERF_FILE_LOAD]        = PERF_STAT("file.load",         PERF_UNIT_US),
+    [PERF_FILE_LOAD_BYTES]  = PERF_STAT("file.load.bytes",   PERF_UNIT_BYTES),
+    [PERF_FILE_SAVE]        = PERF_STAT("file.save",         PERF_UNIT_US),
+    [PERF_FILE_SAVE_BYTES]  = PERF_STAT("file.save.bytes",   PERF_UNIT_BYTES),
+    [PERF_CRYPTO1_RECOVERY] = PERF_STAT("crypto1.recovery",  PERF_UNIT_US),
+    [PERF_HARDNESTED_BRUTE] = PERF_STAT("hardnested.brute",  PERF_UNIT_US),
+    [PERF_ICLASS_LOOKUP]    = PERF_STAT("iclass.lookup",     PERF_UNIT_US),
+    [PERF_LOCLASS_RECOVERY] = PERF_STAT("loclass.recovery",  PERF_UNIT_US),
+};
+
+static perf_cmd_t perf_cmds[PERF_CMD_SLOTS];
+
+// heap in use at the last reset, -1 before the first one
+static int64_t perf_heap_base = -1;
+
+static const char *perf_unit_str(perf_unit_t unit) {
+    switch (unit) {
+        case PERF_UNIT_US:
+            return "us";
+        case PERF_UNIT_BYTES:
+            return "bytes";
+        case PERF_UNIT_COUNT:
+        default:
+            return "";
+    }
+}
+
+// bytes of heap in use, -1 where the C library can't tell
+static int64_t perf_heap_inuse(void) {
+#if defined(PERF_HAVE_MALLINFO2)
+    struct mallinfo2 mi = mallinfo2();
+    return (int64_t)(mi.uordblks + mi.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+static uint32_t perf_bucket(uint64_t value) {
+    return (value == 0) ? 0 : 64 - __builtin_clzll(value);
+}
+
+void perf_record(perf_id_t id, uint64_t value) {
+    if (id >= PERF_MAX) {
+        return;
+    }
+
+    perf_stat_t *s = &perf_stats[id];
+    __atomic_add_fetch(&s->count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s->sum, value, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s->hist[perf_bucket(value)], 1, __ATOMIC_RELAXED);
+
+    uint64_t cur = __atomic_load_n(&s->min, __ATOMIC_RELAXED);
+    while (value < cur && __atomic_compare_exchange_n(&s->min, &cur, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == false) {}
+
+    cur = __atomic_load_n(&s->max, __ATOMIC_RELAXED);
+    while (value > cur && __atomic_compare_exchange_n(&s->max, &cur, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == false) {}
+}
+
+static perf_cmd_t *perf_cmd_slot(uint16_t cmd) {
+    uint32_t key = (uint32_t)cmd + 1;
+    uint32_t h = ((uint32_t)cmd * 0x9E3779B1u) >> 24;
+
+    for (uint32_t i = 0; i < PERF_CMD_SLOTS; i++) {
+        perf_cmd_t *s = &perf_cmds[(h + i) & (PERF_CMD_SLOTS - 1)];
+        uint32_t k = __atomic_load_n(&s->key, __ATOMIC_ACQUIRE);
+        if (k == key) {
+            return s;
+        }
+        if (k == 0) {
+            if (__atomic_compare_exchange_n(&s->key, &k, key, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) || k == key) {
+                return s;
+            }
+        }
+    }
+    return NULL;
+}
+
+void perf_comms_tx(uint16_t cmd, size_t bytes) {
+    perf_cmd_t *s = perf_cmd_slot(cmd);
+    if (s) {
+        __atomic_add_fetch(&s->tx_frames, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&s->tx_bytes, bytes, __ATOMIC_RELAXED);
+    }
+}
+
+void perf_comms_rx(uint16_t cmd, size_t bytes) {
+    perf_cmd_t *s = perf_cmd_slot(cmd);
+    if (s) {
+        __atomic_add_fetch(&s->rx_frames, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&s->rx_bytes, bytes, __ATOMIC_RELAXED);
+    }
+}
+
+void perf_reset(void) {
+    for (int i = 0; i < PERF_MAX; i++) {
+        perf_stat_t *s = &perf_stats[i];
+        __atomic_store_n(&s->count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->sum, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->min, UINT64_MAX, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->max, 0, __ATOMIC_RELAXED);
+        for (int b = 0; b < PERF_HIST_BUCKETS; b++) {
+            __atomic_store_n(&s->hist[b], 0, __ATOMIC_RELAXED);
+        }
+    }
+    for (int i = 0; i < PERF_CMD_SLOTS; i++) {
+        perf_cmd_t *s = &perf_cmds[i];
+        __atomic_store_n(&s->tx_frames, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->tx_bytes, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->rx_frames, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->rx_bytes, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->key, 0, __ATOMIC_RELEASE);
+    }
+    perf_heap_base = perf_heap_inuse();
+}
+
+void perf_set_enabled(bool enable) {
+    if (enable && g_perf_enabled == false) {
+        perf_reset();
+    }
+    __atomic_store_n(&g_perf_enabled, enable, __ATOMIC_RELAXED);
+}
+
+// upper bound of the bucket holding the p'th permille, clamped to min / max
+static uint64_t perf_percentile(const perf_stat_t *s, uint32_t permille) {
+    uint64_t count = __atomic_load_n(&s->count, __ATOMIC_RELAXED);
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = ((count * permille) + 999) / 1000;
+    uint64_t seen = 0;
+    uint64_t v = 0;
+    for (uint32_t b = 0; b < PERF_HIST_BUCKETS; b++) {
+        seen += __atomic_load_n(&s->hist[b], __ATOMIC_RELAXED);
+        if (seen >= rank) {
+            v = (b == 0) ? 0 : (b == 64) ? UINT64_MAX : ((1ULL << b) - 1);
+            break;
+        }
+    }
+
+    uint64_t lo = __atomic_load_n(&s->min, __ATOMIC_RELAXED);
+    uint64_t hi = __atomic_load_n(&s->max, __ATOMIC_RELAXED);
+    if (v < lo) v = lo;
+    if (v > hi) v = hi;
+    return v;
+}
+
+static int perf_cmd_cmp(const void *a, const void *b) {
+    const perf_cmd_t *x = (const perf_cmd_t *)a;
+    const perf_cmd_t *y = (const perf_cmd_t *)b;
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+// snapshot of the used command slots, sorted by command id
+static size_t perf_cmd_snapshot(perf_cmd_t *out) {
+    size_t n = 0;
+    for (int i = 0; i < PERF_CMD_SLOTS; i++) {
+        const perf_cmd_t *s = &perf_cmds[i];
+        uint32_t key = __atomic_load_n(&s->key, __ATOMIC_ACQUIRE);
+        if (key == 0) {
+            continue;
+        }
+        out[n].key = key;
+        out[n].tx_frames = __atomic_load_n(&s->tx_frames, __ATOMIC_RELAXED);
+        out[n].tx_bytes = __atomic_load_n(&s->tx_bytes, __ATOMIC_RELAXED);
+        out[n].rx_frames = __atomic_load_n(&s->rx_frames, __ATOMIC_RELAXED);
+        out[n].rx_bytes = __atomic_load_n(&s->rx_bytes, __ATOMIC_RELAXED);
+        n++;
+    }
+    qsort(out, n, sizeof(perf_cmd_t), perf_cmd_cmp);
+    return n;
+}
+
+void perf_print_table(void) {
+
+    PrintAndLogEx(INFO, "%-18s | %5s | %10s | %14s | %10s | %10s | %10s | %10s | %10s"
+                  , "stat", "unit", "count", "total", "mean", "min", "~p50", "~p99", "max");
+    PrintAndLogEx(INFO, "-------------------+-------+------------+----------------+------------+------------+------------+------------+-----------");
+
+    for (int i = 0; i < PERF_MAX; i++) {
+        const perf_stat_t *s = &perf_stats[i];
+        uint64_t count = __atomic_load_n(&s->count, __ATOMIC_RELAXED);
+        if (count == 0) {
+            PrintAndLogEx(INFO, "%-18s | %5s | %10u |", s->name, perf_unit_str(s->unit), 0);
+            continue;
+        }
+        uint64_t sum = __atomic_load_n(&s->sum, __ATOMIC_RELAXED);
+        PrintAndLogEx(INFO, "%-18s | %5s | " _YELLOW_("%10" PRIu64) " | %14" PRIu64 " | %10" PRIu64 " | %10" PRIu64 " | %10" PRIu64 " | %10" PRIu64 " | %10" PRIu64
+                      , s->name
+                      , perf_unit_str(s->unit)
+                      , count
+                      , sum
+                      , sum / count
+                      , __atomic_load_n(&s->min, __ATOMIC_RELAXED)
+                      , perf_percentile(s, 500)
+                      , perf_percentile(s, 990)
+                      , __atomic_load_n(&s->max, __ATOMIC_RELAXED)
+                     );
+    }
+
+    int64_t heap = perf_heap_inuse();
+    if (heap >= 0) {
+        PrintAndLogEx(NORMAL, "");
+        if (perf_heap_base >= 0) {
+            PrintAndLogEx(INFO, "heap in use... " _YELLOW_("%" PRId64) " bytes ( %+" PRId64 " since reset )", heap, heap - perf_heap_base);
+        } else {
+            PrintAndLogEx(INFO, "heap in use... " _YELLOW_("%" PRId64) " bytes", heap);
+        }
+    }
+
+    perf_cmd_t cmds[PERF_CMD_SLOTS];
+    size_t n = perf_cmd_snapshot(cmds);
+    if (n == 0) {
+        return;
+    }
+
+    PrintAndLogEx(NORMAL, "");
+    PrintAndLogEx(INFO, "%-6s | %10s | %12s | %10s | %12s", "cmd", "tx frames", "tx bytes", "rx frames", "rx bytes");
+    PrintAndLogEx(INFO, "-------+------------+--------------+------------+-------------");
+    for (size_t i = 0; i < n; i++) {
+        PrintAndLogEx(INFO, "0x%04X | %10" PRIu64 " | %12" PRIu64 " | %10" PRIu64 " | %12" PRIu64
+                      , cmds[i].key - 1
+                      , cmds[i].tx_frames
+                      , cmds[i].tx_bytes
+                      , cmds[i].rx_frames
+                      , cmds[i].rx_bytes
+                     );
+    }
+}
+
+static json_t *perf_json(void) {
+    json_t *root = json_object();
+    json_object_set_new(root, "enabled", json_boolean(g_perf_enabled));
+
+    json_t *stats = json_object();
+    for (int i = 0; i < PERF_MAX; i++) {
+        const perf_stat_t *s = &perf_stats[i];
+        uint64_t count = __atomic_load_n(&s->count, __ATOMIC_RELAXED);
+        uint64_t sum = __atomic_load_n(&s->sum, __ATOMIC_RELAXED);
+
+        json_t *j = json_object();
+        json_object_set_new(j, "unit", json_string(perf_unit_str(s->unit)));
+        json_object_set_new(j, "count", json_integer(count));
+        json_object_set_new(j, "sum", json_integer(sum));
+        if (count) {
+            json_object_set_new(j, "min", json_integer(__atomic_load_n(&s->min, __ATOMIC_RELAXED)));
+            json_object_set_new(j, "max", json_integer(__atomic_load_n(&s->max, __ATOMIC_RELAXED)));
+            json_object_set_new(j, "mean", json_real((double)sum / count));
+            json_object_set_new(j, "p50", json_integer(perf_percentile(s, 500)));
+            json_object_set_new(j, "p99", json_integer(perf_percentile(s, 990)));
+
+            // log2 buckets, trailing empty ones dropped
+            int last = 0;
+            for (int b = 0; b < PERF_HIST_BUCKETS; b++) {
+                if (__atomic_load_n(&s->hist[b], __ATOMIC_RELAXED)) {
+                    last = b;
+                }
+            }
+            json_t *hist = json_array();
+            for (int b = 0; b <= last; b++) {
+                json_array_append_new(hist, json_integer(__atomic_load_n(&s->hist[b], __ATOMIC_RELAXED)));
+            }
+            json_object_set_new(j, "hist_log2", hist);
+        }
+        json_object_set_new(stats, s->name, j);
+    }
+    json_object_set_new(root, "stats", stats);
+
+    perf_cmd_t cmds[PERF_CMD_SLOTS];
+    size_t n = perf_cmd_snapshot(cmds);
+    json_t *jcmds = json_object();
+    for (size_t i = 0; i < n; i++) {
+        char id[8];
+        snprintf(id, sizeof(id), "0x%04X", cmds[i].key - 1);
+        json_t *j = json_object();
+        json_object_set_new(j, "tx_frames", json_integer(cmds[i].tx_frames));
+        json_object_set_new(j, "tx_bytes", json_integer(cmds[i].tx_bytes));
+        json_object_set_new(j, "rx_frames", json_integer(cmds[i].rx_frames));
+        json_object_set_new(j, "rx_bytes", json_integer(cmds[i].rx_bytes));
+        json_object_set_new(jcmds, id, j);
+    }
+    json_object_set_new(root, "cmds", jcmds);
+
+    int64_t heap = perf_heap_inuse();
+    if (heap >= 0) {
+        json_t *j = json_object();
+        json_object_set_new(j, "inuse", json_integer(heap));
+        if (perf_heap_base >= 0) {
+            json_object_set_new(j, "delta", json_integer(heap - perf_heap_base));
+        }
+        json_object_set_new(root, "heap", j);
+    }
+    return root;
+}
+
+void perf_print_json(void) {
+    json_t *root = perf_json();
+    char *s = json_dumps(root, JSON_INDENT(2));
+    json_decref(root);
+    if (s == NULL) {
+        return;
+    }
+
+    // line by line, the whole document can exceed the print buffer
+    char *line = s;
+    while (line) {
+        char *nl = strchr(line, '\n');
+        if (nl) {
+            *nl++ = '\0';
+        }
+        PrintAndLogEx(NORMAL, "%s", line);
+        line = nl;
+    }
+    free(s);
+}
+
+int perf_save_json(const char *fn) {
+    json_t *root = perf_json();
+    int res = saveFileJSONrootEx(fn, root, JSON_INDENT(2), true, true, spDefault);
+    json_decref(root);
+    return res;
+}
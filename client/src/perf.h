@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Client performance counters
+//
+// Every stat keeps count, sum, min, max and a log2 histogram of the values
+// it was fed.  Updates are lock free and the hooks cost one predicted branch
+// when perf is disabled ('prefs set perf --off', the default).
+//-----------------------------------------------------------------------------
+
+#ifndef PERF_H__
+#define PERF_H__
+
+#include "common.h"
+#include "util_posix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PERF_COMMS_TXQUEUE = 0,  // us, command queued until written to the port
+    PERF_COMMS_ROUNDTRIP,    // us, command written until its reply is taken
+    PERF_COMMS_TIMEOUT,      // WaitForResponse calls that gave up
+    PERF_COMMS_BULK,         // us, whole GetFromDevice downloads
+    PERF_COMMS_BULK_BYTES,
+    PERF_PRINT,              // us inside PrintAndLogEx
+    PERF_FILE_LOAD,          // us, successful loads
+    PERF_FILE_LOAD_BYTES,
+    PERF_FILE_SAVE,          // us, successful saves
+    PERF_FILE_SAVE_BYTES,
+    PERF_CRYPTO1_RECOVERY,   // us in lfsr_recovery32 / lfsr_recovery64
+    PERF_HARDNESTED_BRUTE,   // us in the hardnested bitsliced brute force
+    PERF_ICLASS_LOOKUP,      // us in the iclass dictionary attack
+    PERF_LOCLASS_RECOVERY,   // us in loclass key recovery
+    PERF_MAX
+} perf_id_t;
+
+extern bool g_perf_enabled;
+
+void perf_record(perf_id_t id, uint64_t value);
+void perf_comms_tx(uint16_t cmd, size_t bytes);
+void perf_comms_rx(uint16_t cmd, size_t bytes);
+void perf_reset(void);
+void perf_set_enabled(bool enable);
+
+void perf_print_table(void);
+void perf_print_json(void);
+int perf_save_json(const char *fn);
+
+static inline bool perf_enabled(void) {
+    return __builtin_expect(__atomic_load_n(&g_perf_enabled, __ATOMIC_RELAXED), 0);
+}
+
+// start of a timed section, 0 when perf is disabled
+static inline uint64_t perf_start(void) {
+    return perf_enabled() ? usclock() : 0;
+}
+
+static inline void perf_stop(perf_id_t id, uint64_t t0) {
+    if (t0) {
+        perf_record(id, usclock() - t0);
+    }
+}
+
+static inline void perf_add(perf_id_t id, uint64_t value) {
+    if (perf_enabled()) {
+        perf_record(id, value);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -22,28 +22,21 @@
 #include "ui.h"
 #include "util.h"
 #include "fileutils.h"
+#include "rescache.h"
 
 // Load ecplist.json file
 json_t *pla_load_ecplist(void) {
-    json_error_t error;
-    char *path;
-
-    int res = searchFile(&path, RESOURCES_SUBDIR, "ecplist", ".json", false);
-    if (res != PM3_SUCCESS) {
-        PrintAndLogEx(ERR, "Cannot find ecplist.json");
-        return NULL;
-    }
-
-    json_t *root = json_load_file(path, 0, &error);
-    free(path);
-
-    if (root == false) {
-        PrintAndLogEx(ERR, "json error on line %d: %s", error.line, error.text);
+    // parsed once per session, see rescache.c
+    json_t *root = rescache_json_load("ecplist", ".json", false);
+    if (root == NULL) {
+        PrintAndLogEx(ERR, "Cannot load ecplist.json");
         return NULL;
     }
 
     if (!json_is_array(root)) {
-        PrintAndLogEx(ERR, "Invalid ecplist.json format. Root must be an array.");
+        char path[FILE_PATH_SIZE];
+        rescache_json_path(root, path, sizeof(path));
+        PrintAndLogEx(ERR, "Invalid %s format. Root must be an array.", path);
         json_decref(root);
         return NULL;
     }
@@ -0,0 +1,1205 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Offline benchmarks of the client kernels on fixed inputs
+//-----------------------------------------------------------------------------
+
+#include "pm3_bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include <dirent.h>
+#include <lz4frame.h>
+#include "jansson.h"
+#include "commonutil.h"      // ARRAYLEN
+#include "ui.h"
+#include "util.h"            // num_CPUs
+#include "util_posix.h"      // usclock
+#include "fileutils.h"
+#include "rescache.h"
+#include "emv/tlv.h"
+#include "emv/emv_roca.h"
+#include "lfdemod.h"
+#include "lfdemod_kernels.h"
+#include "mifare/mfkey.h"
+#include "loclass/cipher.h"
+#include "loclass/ikeys.h"
+#include "loclass/cipher_bs_dispatch.h"
+#include "crypto/libpcrypto.h"
+#include "hardnested_bruteforce.h"
+
+#ifdef _WIN32
+#include "scandir.h"
+#endif
+
+#define PM3_BENCH_MAX_REPS   50
+
+typedef struct {
+    const char *name;
+    const char *unit;       // what one op is
+    bool macro;             // one call per repetition
+    bool self_timed;        // run returns ops/s it measured itself
+    const char *desc;
+    int (*setup)(void **ctx);
+    // runs the kernel iters times, returns the number of ops done or 0 when the result was wrong
+    uint64_t (*run)(void *ctx, uint64_t iters);
+    void (*teardown)(void *ctx);
+} pm3_bench_case_t;
+
+//-----------------------------------------------------------------------------
+// fixed inputs
+//-----------------------------------------------------------------------------
+
+// pm3 trace file, one signed sample per line, as the unsigned samples lfdemod works on
+typedef struct {
+    uint8_t *samples;
+    uint8_t *work;
+    size_t len;
+    uint32_t hi;
+    uint64_t lo;
+} bench_trace_t;
+
+static int bench_trace_load(const char *name, bench_trace_t **out) {
+
+    char *path = NULL;
+    if (searchFile(&path, TRACES_SUBDIR, name, ".pm3", true) != PM3_SUCCESS) {
+        return PM3_EFILE;
+    }
+
+    FILE *f = fopen(path, "r");
+    free(path);
+    if (f == NULL) {
+        return PM3_EFILE;
+    }
+
+    bench_trace_t *t = calloc(1, sizeof(bench_trace_t));
+    size_t cap = 0x4000;
+    if (t) {
+        t->samples = calloc(cap, sizeof(uint8_t));
+    }
+    if (t == NULL || t->samples == NULL) {
+        free(t);
+        fclose(f);
+        return PM3_EMALLOC;
+    }
+
+    char line[32];
+    while (fgets(line, sizeof(line), f)) {
+        if (t->len == cap) {
+            cap *= 2;
+            uint8_t *tmp = realloc(t->samples, cap);
+            if (tmp == NULL) {
+                break;
+            }
+            t->samples = tmp;
+        }
+        int v = atoi(line) + 128;
+        t->samples[t->len++] = (v < 0) ? 0 : (v > 255) ? 255 : v;
+    }
+    fclose(f);
+
+    t->work = calloc(t->len, sizeof(uint8_t));
+    if (t->len == 0 || t->work == NULL) {
+        free(t->work);
+        free(t->samples);
+        free(t);
+        return PM3_ESOFT;
+    }
+    *out = t;
+    return PM3_SUCCESS;
+}
+
+static void bench_trace_free(void *ctx) {
+    bench_trace_t *t = (bench_trace_t *)ctx;
+    if (t) {
+        free(t->work);
+        free(t->samples);
+        free(t);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// crapto1, test vectors of tools/mfc/card_reader mfkey32v2 and mfkey64
+//-----------------------------------------------------------------------------
+
+static uint64_t bench_mfkey32(void *ctx, uint64_t iters) {
+    (void)ctx;
+    nonces_t data = {
+        .cuid = 0x12345678,
+        .nonce = 0x1AD8DF2B, .nr = 0x1D316024, .ar = 0x620EF048,
+        .nonce2 = 0x30D6CB07, .nr2 = 0xC52077E2, .ar2 = 0x837AC61A,
+    };
+    for (uint64_t i = 0; i < iters; i++) {
+        uint64_t key = 0;
+        if (mfkey32_moebius(&data, &key) == false || key != 0xA0A1A2A3A4A5) {
+            return 0;
+        }
+    }
+    return iters;
+}
+
+static uint64_t bench_mfkey64(void *ctx, uint64_t iters) {
+    (void)ctx;
+    nonces_t data = {
+        .cuid = 0x9C599B32,
+        .nonce = 0x82A4166C, .nr = 0xA1E458CE, .ar = 0x6EEA41E0, .at = 0x5CADF439,
+    };
+    for (uint64_t i = 0; i < iters; i++) {
+        uint64_t key = 0;
+        mfkey64(&data, &key);
+        if (key != 0xFFFFFFFFFFFF) {
+            return 0;
+        }
+    }
+    return iters;
+}
+
+//-----------------------------------------------------------------------------
+// hardnested, the brute force benchmark hf mf hardnested uses for its estimates
+//-----------------------------------------------------------------------------
+
+static int bench_hardnested_setup(void **ctx) {
+    (void)ctx;
+    char *path = NULL;
+    if (searchFile(&path, RESOURCES_SUBDIR, "hardnested_bf_bench_data.bin", "", true) != PM3_SUCCESS) {
+        return PM3_EFILE;
+    }
+    free(path);
+    return PM3_SUCCESS;
+}
+
+static uint64_t bench_hardnested(void *ctx, uint64_t iters) {
+    (void)ctx;
+    (void)iters;
+    float rate = brute_force_benchmark();
+    return (rate > 0) ? (uint64_t)rate : 0;
+}
+
+//-----------------------------------------------------------------------------
+// iCLASS / loclass, MAC vector of the "Dismantling iClass" paper
+//-----------------------------------------------------------------------------
+
+static const uint8_t bench_cc_nr[12] = {0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0};
+static const uint8_t bench_div_key[8] = {0xE0, 0x33, 0xCA, 0x41, 0x9A, 0xEE, 0x43, 0xF9};
+static const uint8_t bench_mac[4] = {0x1D, 0x49, 0xC9, 0xDA};
+
+static uint64_t bench_domac(void *ctx, uint64_t iters) {
+    (void)ctx;
+    uint8_t cc_nr[12], div_key[8], mac[4] = {0};
+    memcpy(cc_nr, bench_cc_nr, sizeof(cc_nr));
+    memcpy(div_key, bench_div_key, sizeof(div_key));
+    for (uint64_t i = 0; i < iters; i++) {
+        doMAC(cc_nr, div_key, mac);
+        if (memcmp(mac, bench_mac, sizeof(mac)) != 0) {
+            return 0;
+        }
+    }
+    return iters;
+}
+
+static uint64_t bench_domac_brute(void *ctx, uint64_t iters) {
+    (void)ctx;
+    uint8_t mac[4] = {0};
+    for (uint64_t i = 0; i < iters; i++) {
+        doMAC_brute(bench_cc_nr, bench_div_key, mac);
+        if (memcmp(mac, bench_mac, sizeof(mac)) != 0) {
+            return 0;
+        }
+    }
+    return iters;
+}
+
+static uint64_t bench_diversify(void *ctx, uint64_t iters) {
+    (void)ctx;
+    uint8_t csn[8] = {0x01, 0x0A, 0x0F, 0xFF, 0xF7, 0xFF, 0x12, 0xE0};
+    uint8_t key[8] = {0xAE, 0xA6, 0x84, 0xA6, 0xDA, 0xB2, 0x32, 0x78};
+    uint8_t first[8] = {0}, div_key[8] = {0};
+    diversifyKey(csn, key, first);
+    for (uint64_t i = 0; i < iters; i++) {
+        diversifyKey(csn, key, div_key);
+        if (memcmp(div_key, first, sizeof(div_key)) != 0) {
+            return 0;
+        }
+    }
+    return iters;
+}
+
+// the paper's diversified key must match in the first batch of candidates
+typedef struct {
+    const bs_backend_t *bs;
+    uint64_t y_bits_bs[96 * BS_MAX_WORDS];
+    uint64_t target_mac_bs[32 * BS_MAX_WORDS];
+} bench_bs_t;
+
+static int bench_bs_setup(int width, void **ctx) {
+    const bs_backend_t *bs = bs_backend_by_width(width);
+    if (bs == NULL) {
+        return PM3_ENOTIMPL;
+    }
+    bench_bs_t *b = calloc(1, sizeof(bench_bs_t));
+    if (b == NULL) {
+        return PM3_EMALLOC;
+    }
+    b->bs = bs;
+    bs->prepare_ccnr(bench_cc_nr, b->y_bits_bs);
+    bs->prepare_mac(bench_mac, b->target_mac_bs);
+    *ctx = b;
+    return PM3_SUCCESS;
+}
+
+static int bench_bs64_setup(void **ctx) {
+    return bench_bs_setup(64, ctx);
+}
+static int bench_bs128_setup(void **ctx) {
+    return bench_bs_setup(128, ctx);
+}
+static int bench_bs256_setup(void **ctx) {
+    return bench_bs_setup(256, ctx);
+}
+static int bench_bs512_setup(void **ctx) {
+    return bench_bs_setup(512, ctx);
+}
+
+static uint64_t bench_bs(void *ctx, uint64_t iters) {
+    const bench_bs_t *b = (const bench_bs_t *)ctx;
+    const bs_backend_t *bs = b->bs;
+
+    // low 3 bits of each byte fixed by the key, the 40 bit index walks the rest
+    uint8_t partial[8];
+    uint64_t index = 0;
+    for (int j = 0; j < 8; j++) {
+        partial[j] = bench_div_key[j] & 0x07;
+        index |= (uint64_t)(bench_div_key[j] >> 3) << (5 * (7 - j));
+    }
+    uint64_t lane = index % (uint64_t)bs->width;
+    uint64_t start = index - lane;
+
+    uint64_t kb[64 * BS_MAX_WORDS];
+    uint64_t match[BS_MAX_WORDS];
+    uint64_t hits = 0;
+    for (uint64_t i = 0; i < iters; i++) {
+        bs->build_key(partial, start, kb);
+        bs->match(b->y_bits_bs, kb, b->target_mac_bs, match);
+        hits += (match[lane / 64] >> (lane % 64)) & 1;
+    }
+    return (hits == iters) ? iters * bs->width : 0;
+}
+
+//-----------------------------------------------------------------------------
+// DES / 3DES / AES, one key schedule per block like the brute forcers
+//-----------------------------------------------------------------------------
+
+static int bench_des_setup(void **ctx) {
+    (void)ctx;
+    // FIPS 81 style vector
+    const uint8_t key[8] = {0x13, 0x34, 0x57, 0x79, 0x9B, 0xBC, 0xDF, 0xF1};
+    const uint8_t pt[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    const uint8_t ct[8] = {0x85, 0xE8, 0x13, 0x54, 0x0F, 0x0A, 0xB4, 0x05};
+    uint8_t out[8] = {0};
+    des_encrypt(out, pt, key);
+    return (memcmp(out, ct, sizeof(ct)) == 0) ? PM3_SUCCESS : PM3_ESOFT;
+}
+
+static uint64_t bench_des(void *ctx, uint64_t iters) {
+    (void)ctx;
+    uint8_t key[8] = {0};
+    uint8_t block[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    uint8_t out[8];
+    for (uint64_t i = 0; i < iters; i++) {
+        memcpy(key, &i, sizeof(key));
+        des_encrypt(out, block, key);
+        block[0] ^= out[0];
+    }
+    return iters;
+}
+
+static uint64_t bench_3des(void *ctx, uint64_t iters) {
+    (void)ctx;
+    uint8_t key[16] = {0x49, 0x45, 0x4D, 0x4B, 0x41, 0x45, 0x52, 0x42, 0x21, 0x4E, 0x41, 0x43, 0x55, 0x4F, 0x59, 0x46};
+    const uint8_t pt[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    uint8_t ct[8], back[8];
+    for (uint64_t i = 0; i < iters; i++) {
+        key[0] = i & 0xFF;
+        des3_encrypt(ct, pt, key, 2);
+        des3_decrypt(back, ct, key, 2);
+        if (memcmp(back, pt, sizeof(pt)) != 0) {
+            return 0;
+        }
+    }
+    return iters * 2;
+}
+
+static int bench_aes_setup(void **ctx) {
+    (void)ctx;
+    // FIPS 197 appendix C.1
+    uint8_t key[16], pt[16], iv[16] = {0}, out[16] = {0};
+    const uint8_t ct[16] = {0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30, 0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A};
+    for (int i = 0; i < 16; i++) {
+        key[i] = i;
+        pt[i] = (i << 4) | i;
+    }
+    aes_encode(iv, key, pt, out, sizeof(pt));
+    return (memcmp(out, ct, sizeof(ct)) == 0) ? PM3_SUCCESS : PM3_ESOFT;
+}
+
+static uint64_t bench_aes(void *ctx, uint64_t iters) {
+    (void)ctx;
+    uint8_t key[16] = {0}, block[16] = {0}, out[16];
+    for (uint64_t i = 0; i < iters; i++) {
+        uint8_t iv[16] = {0};
+        memcpy(key, &i, sizeof(i));
+        aes_encode(iv, key, block, out, sizeof(block));
+        block[0] ^= out[0];
+    }
+    return iters;
+}
+
+//-----------------------------------------------------------------------------
+// LZ4, one of the hardnested bitflip tables
+//-----------------------------------------------------------------------------
+
+typedef struct {
+    uint8_t *in;
+    size_t in_len;
+    uint8_t *out;
+    size_t out_len;
+} bench_lz4_t;
+
+static int bench_lz4_setup(void **ctx) {
+    char *path = NULL;
+    if (searchFile(&path, RESOURCES_SUBDIR, "hardnested_tables/bitflip_0_001_states.bin.lz4", "", true) != PM3_SUCCESS) {
+        return PM3_EFILE;
+    }
+
+    FILE *f = fopen(path, "rb");
+    free(path);
+    if (f == NULL) {
+        return PM3_EFILE;
+    }
+    fseek(f, 0, SEEK_END);
+    long fsize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    bench_lz4_t *b = calloc(1, sizeof(bench_lz4_t));
+    if (b == NULL || fsize <= 0) {
+        free(b);
+        fclose(f);
+        return PM3_EMALLOC;
+    }
+    b->in_len = fsize;
+    b->out_len = (sizeof(uint32_t) * (1 << 19)) + sizeof(uint32_t);
+    b->in = calloc(b->in_len, sizeof(uint8_t));
+    b->out = calloc(b->out_len, sizeof(uint8_t));
+    size_t n = (b->in) ? fread(b->in, 1, b->in_len, f) : 0;
+    fclose(f);
+
+    if (b->out == NULL || n != b->in_len) {
+        free(b->in);
+        free(b->out);
+        free(b);
+        return PM3_EFILE;
+    }
+    *ctx = b;
+    return PM3_SUCCESS;
+}
+
+static uint64_t bench_lz4(void *ctx, uint64_t iters) {
+    bench_lz4_t *b = (bench_lz4_t *)ctx;
+    for (uint64_t i = 0; i < iters; i++) {
+        LZ4F_decompressionContext_t dctx;
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION))) {
+            return 0;
+        }
+        size_t consumed = b->in_len;
+        size_t generated = b->out_len;
+        LZ4F_errorCode_t res = LZ4F_decompress(dctx, b->out, &generated, b->in, &consumed, NULL);
+        LZ4F_freeDecompressionContext(dctx);
+        if (LZ4F_isError(res) || generated != b->out_len) {
+            return 0;
+        }
+    }
+    return iters * b->out_len;
+}
+
+static void bench_lz4_teardown(void *ctx) {
+    bench_lz4_t *b = (bench_lz4_t *)ctx;
+    if (b) {
+        free(b->in);
+        free(b->out);
+        free(b);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// lfdemod, signal properties + clock detection + demod on the test traces
+//-----------------------------------------------------------------------------
+
+static int bench_em410x_setup(void **ctx) {
+    bench_trace_t *t = NULL;
+    int res = bench_trace_load("lf_ATA5577_em410x", &t);
+    if (res != PM3_SUCCESS) {
+        return res;
+    }
+    t->hi = 0;
+    t->lo = 0x0F0368568B;
+    *ctx = t;
+    return PM3_SUCCESS;
+}
+
+static uint64_t bench_em410x(void *ctx, uint64_t iters) {
+    bench_trace_t *t = (bench_trace_t *)ctx;
+    for (uint64_t i = 0; i < iters; i++) {
+        memcpy(t->work, t->samples, t->len);
+        size_t size = t->len;
+        int clk = 0, invert = 0, start = 0;
+        computeSignalProperties(t->work, size);
+        if (askdemod_ext(t->work, &size, &clk, &invert, 100, 0, 1, &start) < 0) {
+            return 0;
+        }
+        size_t idx = 0;
+        uint32_t hi = 0;
+        uint64_t lo = 0;
+        if (Em410xDecode(t->work, &size, &idx, &hi, &lo) < 0 || hi != t->hi || lo != t->lo) {
+            return 0;
+        }
+    }
+    return iters * t->len;
+}
+
+static int bench_hid_setup(void **ctx) {
+    bench_trace_t *t = NULL;
+    int res = bench_trace_load("lf_ATA5577_hid", &t);
+    if (res != PM3_SUCCESS) {
+        return res;
+    }
+
+    // the reference decode, every run must agree with it
+    memcpy(t->work, t->samples, t->len);
+    size_t size = t->len;
+    uint32_t hi2 = 0, hi = 0, lo = 0;
+    int wave = 0;
+    computeSignalProperties(t->work, size);
+    if (HIDdemodFSK(t->work, &size, &hi2, &hi, &lo, &wave) < 0 || lo == 0) {
+        bench_trace_free(t);
+        return PM3_ESOFT;
+    }
+    t->hi = hi;
+    t->lo = lo;
+    *ctx = t;
+    return PM3_SUCCESS;
+}
+
+static uint64_t bench_hid(void *ctx, uint64_t iters) {
+    bench_trace_t *t = (bench_trace_t *)ctx;
+    for (uint64_t i = 0; i < iters; i++) {
+        memcpy(t->work, t->samples, t->len);
+        size_t size = t->len;
+        uint32_t hi2 = 0, hi = 0, lo = 0;
+        int wave = 0;
+        computeSignalProperties(t->work, size);
+        if (HIDdemodFSK(t->work, &size, &hi2, &hi, &lo, &wave) < 0 || hi != t->hi || lo != t->lo) {
+            return 0;
+        }
+    }
+    return iters * t->len;
+}
+
+static int bench_psk_setup(void **ctx) {
+    bench_trace_t *t = NULL;
+    int res = bench_trace_load("lf_ATA5577_indala", &t);
+    if (res != PM3_SUCCESS) {
+        return res;
+    }
+
+    memcpy(t->work, t->samples, t->len);
+    size_t size = t->len;
+    int clk = 32, invert = 0;
+    computeSignalProperties(t->work, size);
+    if (pskRawDemod(t->work, &size, &clk, &invert) < 0 || size == 0) {
+        bench_trace_free(t);
+        return PM3_ESOFT;
+    }
+    // demodulated length stands in for the decoded id
+    t->lo = size;
+    *ctx = t;
+    return PM3_SUCCESS;
+}
+
+static uint64_t bench_psk(void *ctx, uint64_t iters) {
+    bench_trace_t *t = (bench_trace_t *)ctx;
+    for (uint64_t i = 0; i < iters; i++) {
+        memcpy(t->work, t->samples, t->len);
+        size_t size = t->len;
+        int clk = 32, invert = 0;
+        computeSignalProperties(t->work, size);
+        if (pskRawDemod(t->work, &size, &clk, &invert) < 0 || size != t->lo) {
+            return 0;
+        }
+    }
+    return iters * t->len;
+}
+
+// every lf_*.pm3 trace through ASK, FSK and PSK demod with one lfdemod kernel.
+// The demod output is hashed, it must match the scalar kernel's
+typedef struct {
+    const lfdemod_kernel_t *k;
+    bench_trace_t **traces;
+    size_t count;
+    uint64_t samples;
+    uint64_t digest;
+} bench_traces_t;
+
+static void bench_fnv(uint64_t *h, const void *data, size_t n) {
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < n; i++) {
+        *h = (*h ^ p[i]) * 0x100000001B3ULL;
+    }
+}
+
+static void bench_fnv_int(uint64_t *h, int64_t v) {
+    bench_fnv(h, &v, sizeof(v));
+}
+
+static void bench_traces_prepare(bench_trace_t *t) {
+    memcpy(t->work, t->samples, t->len);
+    removeSignalOffset(t->work, t->len);
+    computeSignalProperties(t->work, t->len);
+}
+
+static void bench_traces_one(bench_trace_t *t, uint64_t *h) {
+
+    // ASK/manchester + EM410x, then ASK/raw + manchester decode
+    for (uint8_t ask = 0; ask < 2; ask++) {
+        bench_traces_prepare(t);
+        size_t size = t->len;
+        int clk = 0, invert = 0, start = 0;
+        int res = askdemod_ext(t->work, &size, &clk, &invert, 100, 0, ask ^ 1, &start);
+        bench_fnv_int(h, res);
+        bench_fnv_int(h, clk);
+        bench_fnv_int(h, invert);
+        bench_fnv_int(h, start);
+        if (res < 0) {
+            continue;
+        }
+        bench_fnv(h, t->work, size);
+
+        if (ask == 0) {
+            size_t idx = 0;
+            uint32_t hi = 0;
+            uint64_t lo = 0;
+            bench_fnv_int(h, Em410xDecode(t->work, &size, &idx, &hi, &lo));
+            bench_fnv_int(h, idx);
+            bench_fnv_int(h, lo);
+        } else {
+            uint8_t align = 0;
+            bench_fnv_int(h, manrawdecode(t->work, &size, 0, &align));
+            bench_fnv_int(h, align);
+            bench_fnv(h, t->work, size);
+        }
+    }
+
+    // FSK2a RF/50 + HID preamble
+    bench_traces_prepare(t);
+    int start = 0;
+    size_t size = fskdemod(t->work, t->len, 50, 0, 10, 8, &start);
+    bench_fnv_int(h, start);
+    bench_fnv(h, t->work, size);
+    uint8_t preamble[] = {0, 0, 0, 1, 1, 1, 0, 1};
+    size_t idx = 0;
+    bench_fnv_int(h, preambleSearch(t->work, preamble, sizeof(preamble), &size, &idx));
+    bench_fnv_int(h, idx);
+
+    // PSK1
+    bench_traces_prepare(t);
+    size = t->len;
+    int clk = 0, invert = 0;
+    bench_fnv_int(h, pskRawDemod(t->work, &size, &clk, &invert));
+    bench_fnv_int(h, clk);
+    bench_fnv(h, t->work, size);
+}
+
+static uint64_t bench_traces_digest(bench_traces_t *b, const lfdemod_kernel_t *k) {
+    const lfdemod_kernel_t *prev = lfdemod_kernel();
+    lfdemod_kernel_set(k);
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < b->count; i++) {
+        bench_traces_one(b->traces[i], &h);
+    }
+    lfdemod_kernel_set(prev);
+    return h;
+}
+
+static void bench_traces_free(void *ctx) {
+    bench_traces_t *b = (bench_traces_t *)ctx;
+    if (b) {
+        for (size_t i = 0; i < b->count; i++) {
+            bench_trace_free(b->traces[i]);
+        }
+        free(b->traces);
+        free(b);
+    }
+}
+
+static int bench_traces_select(const struct dirent *d) {
+    size_t n = strlen(d->d_name);
+    return (strncmp(d->d_name, "lf_", 3) == 0 && n > 4 && strcmp(d->d_name + n - 4, ".pm3") == 0);
+}
+
+static int bench_traces_setup(const char *kernel, void **ctx) {
+    const lfdemod_kernel_t *k = lfdemod_kernel_by_name(kernel);
+    if (k == NULL) {
+        return PM3_ENOTIMPL;
+    }
+
+    // the traces folder, from one of its files
+    char *path = NULL;
+    if (searchFile(&path, TRACES_SUBDIR, "lf_EM4102-1", ".pm3", true) != PM3_SUCCESS) {
+        return PM3_EFILE;
+    }
+    char *sep = strrchr(path, '/');
+#ifdef _WIN32
+    char *bsep = strrchr(path, '\\');
+    if (bsep > sep) {
+        sep = bsep;
+    }
+#endif
+    if (sep) {
+        *sep = '\0';
+    }
+
+    struct dirent **names = NULL;
+    int n = scandir(path, &names, bench_traces_select, alphasort);
+    free(path);
+    if (n <= 0) {
+        return PM3_EFILE;
+    }
+
+    bench_traces_t *b = calloc(1, sizeof(bench_traces_t));
+    if (b) {
+        b->traces = calloc(n, sizeof(bench_trace_t *));
+    }
+    int res = (b && b->traces) ? PM3_SUCCESS : PM3_EMALLOC;
+
+    for (int i = 0; i < n; i++) {
+        if (res == PM3_SUCCESS) {
+            // searchFile wants the name without the extension
+            names[i]->d_name[strlen(names[i]->d_name) - 4] = '\0';
+            res = bench_trace_load(names[i]->d_name, &b->traces[b->count]);
+            if (res == PM3_SUCCESS) {
+                b->samples += b->traces[b->count++]->len;
+            }
+        }
+        free(names[i]);
+    }
+    free(names);
+
+    if (res != PM3_SUCCESS) {
+        bench_traces_free(b);
+        return res;
+    }
+
+    b->k = k;
+    b->digest = bench_traces_digest(b, lfdemod_kernel_by_name("scalar"));
+    *ctx = b;
+    return PM3_SUCCESS;
+}
+
+static int bench_traces_scalar_setup(void **ctx) {
+    return bench_traces_setup("scalar", ctx);
+}
+static int bench_traces_sse2_setup(void **ctx) {
+    return bench_traces_setup("sse2", ctx);
+}
+static int bench_traces_avx2_setup(void **ctx) {
+    return bench_traces_setup("avx2", ctx);
+}
+static int bench_traces_neon_setup(void **ctx) {
+    return bench_traces_setup("neon", ctx);
+}
+
+static uint64_t bench_traces(void *ctx, uint64_t iters) {
+    bench_traces_t *b = (bench_traces_t *)ctx;
+    for (uint64_t i = 0; i < iters; i++) {
+        if (bench_traces_digest(b, b->k) != b->digest) {
+            return 0;
+        }
+    }
+    return iters * b->samples;
+}
+
+//-----------------------------------------------------------------------------
+// resource lookups through the session cache, as `hf mf mad` and asn1 dumps do
+//-----------------------------------------------------------------------------
+
+static int bench_rescache_setup(void **ctx) {
+    (void) ctx;
+    json_t *mad = rescache_json_load("mad", ".json", true);
+    json_t *oids = rescache_json_load("oids", ".json", true);
+    int res = (json_is_array(mad) && json_is_object(oids)) ? PM3_SUCCESS : PM3_EFILE;
+    json_decref(mad);
+    json_decref(oids);
+    return res;
+}
+
+static uint64_t bench_rescache(void *ctx, uint64_t iters) {
+    (void) ctx;
+    for (uint64_t i = 0; i < iters; i++) {
+        json_t *mad = rescache_json_load("mad", ".json", true);
+        json_t *oids = rescache_json_load("oids", ".json", true);
+        json_t *app = rescache_json_find(mad, "mad", "0x0004", 0);
+        json_t *oid = json_object_get(oids, "1.3.6.1.4.1.41482");
+        bool ok = json_is_string(json_object_get(app, "application")) && json_is_string(json_object_get(oid, "d"));
+        json_decref(mad);
+        json_decref(oids);
+        if (ok == false) {
+            return 0;
+        }
+    }
+    return iters * 2;
+}
+
+//-----------------------------------------------------------------------------
+// EMV TLV parsing, the responses of a Visa test card transaction chained under
+// one root the way `emv exec` keeps them, then searched for the tags it uses
+//-----------------------------------------------------------------------------
+
+static const char *bench_emv_responses[] = {
+    // SELECT 2PAY.SYS.DDF01
+    "6F30840E325041592E5359532E4444463031A51EBF0C1B61194F07A000000003"
+    "1010500B5649534120435245444954870101",
+    // SELECT A0000000031010
+    "6F488407A0000000031010A53D500B56495341204352454449548701019F3818"
+    "9F66049F02069F03069F1A0295055F2A029A039C019F37045F2D04656E6672BF"
+    "0C089F5A053108400840",
+    // GET PROCESSING OPTIONS, format 2
+    "7767820220009410080101001001020118010300200102005713476173900101"
+    "0010D22122011143804400000F5F200F43415244484F4C4445522F564953419F"
+    "100706010A03A000009F26081E1C2B3A4D5E6F709F2701809F360200159F6C02"
+    "16009F6E0420700000",
+    // READ RECORD SFI 1 record 1
+    "703A57134761739001010010D22122011143804400000F5F200F43415244484F"
+    "4C4445522F564953419F1F1031313433383030343430303030303030",
+    // READ RECORD SFI 2 record 1, issuer certificate
+    "7081E09081B0A31C06BD463E3923BC1AADBDE48B16976C080717373B819A068F"
+    "32B7A6B38B6B38729647CFDE01C2CE28B26C57472737F5C3561A1761185BD858"
+    "9A43CE0BBA75891FF9EC60148D4BD4A09EE2DC5C9331B4110BA93AC54AFC14DA"
+    "3BDD19614774A2D55D295E5A35AB44B3EFAEA5129BA22B88BA3E29766145FDEC"
+    "A3B08E38AF53D7C4C60E3AD208CE5066441036E9F191E0B75036A77F65E2EAA4"
+    "752443233FBE8F8943BF956DE595665C38FFFF23827E9F320103922417C10CDC"
+    "1C27A028CAAE6C9810626198FF778740F88DDCF102AEB81DAEE289C044C4A457"
+    "8F0192",
+    // READ RECORD SFI 3 record 1
+    "7081865A0847617390010100105F24032212315F25031901015F280208405F34"
+    "01018C219F02069F03069F1A0295055F2A029A039C019F37049F35019F45029F"
+    "4C089F34038D0C910A8A0295059F37049F4C088E0E000000000000000042031E"
+    "031F039F0702FF009F080200969F0D05F0406420009F0E0500108000009F0F05"
+    "F0406498009F4A0182",
+};
+
+// tag and expected length, 0 for absent
+static const uint32_t bench_emv_tags[][2] = {
+    {0x4f, 7}, {0x50, 11}, {0x9f38, 24}, {0x82, 2}, {0x94, 16}, {0x57, 19},
+    {0x5a, 8}, {0x5f24, 3}, {0x5f34, 1}, {0x8c, 33}, {0x8d, 12}, {0x8e, 14},
+    {0x8f, 1}, {0x90, 176}, {0x92, 36}, {0x9f32, 1}, {0x9f4a, 1}, {0x9f26, 8},
+    {0x9f27, 1}, {0x9f36, 2}, {0x9f46, 0}, {0x9f47, 0}, {0x9f4b, 0}, {0x93, 0},
+};
+
+typedef struct {
+    uint8_t data[ARRAYLEN(bench_emv_responses)][256];
+    size_t len[ARRAYLEN(bench_emv_responses)];
+} bench_emv_t;
+
+static int bench_emv_setup(void **ctx) {
+    bench_emv_t *e = calloc(1, sizeof(bench_emv_t));
+    if (e == NULL) {
+        return PM3_EMALLOC;
+    }
+    for (size_t i = 0; i < ARRAYLEN(bench_emv_responses); i++) {
+        int len = hex_to_bytes(bench_emv_responses[i], e->data[i], sizeof(e->data[i]));
+        if (len <= 0) {
+            free(e);
+            return PM3_EINVARG;
+        }
+        e->len[i] = len;
+    }
+    *ctx = e;
+    return PM3_SUCCESS;
+}
+
+static uint64_t bench_emv(void *ctx, uint64_t iters) {
+    const bench_emv_t *e = (const bench_emv_t *)ctx;
+    for (uint64_t i = 0; i < iters; i++) {
+        struct tlvdb *root = tlvdb_fixed(1, 4, (const uint8_t *)"VISA");
+        for (size_t j = 0; j < ARRAYLEN(bench_emv_responses); j++) {
+            tlvdb_add(root, tlvdb_parse_multi(e->data[j], e->len[j]));
+        }
+
+        bool ok = true;
+        for (size_t j = 0; j < ARRAYLEN(bench_emv_tags); j++) {
+            const struct tlv *t = tlvdb_get(root, bench_emv_tags[j][0], NULL);
+            ok &= (t ? t->len : 0) == bench_emv_tags[j][1];
+        }
+        tlvdb_free(root);
+        if (ok == false) {
+            return 0;
+        }
+    }
+    return iters * ARRAYLEN(bench_emv_responses);
+}
+
+//-----------------------------------------------------------------------------
+// ROCA fingerprint test of 2048 bit moduli, pseudo random ones and the weak
+// 512 bit modulus of `emv roca --test` which has to be the only one found
+//-----------------------------------------------------------------------------
+
+#define BENCH_ROCA_KEYS  1024
+#define BENCH_ROCA_LEN   256
+
+static const char *bench_roca_weak =
+    "944E13208A280C37EFC31C3114485E590192ADBB8E11C87CAD60CDEF0037CE99"
+    "278330D3F471A2538FA667802ED2A3C44A8B7DEA826E888D0AA341FD664F7FA7";
+
+typedef struct {
+    uint8_t data[BENCH_ROCA_KEYS][BENCH_ROCA_LEN];
+    size_t len[BENCH_ROCA_KEYS];
+} bench_roca_t;
+
+static int bench_roca_setup(void **ctx) {
+    bench_roca_t *r = calloc(1, sizeof(bench_roca_t));
+    if (r == NULL) {
+        return PM3_EMALLOC;
+    }
+
+    // xorshift32, the same keys on every run
+    uint32_t x = 0x524f4341;
+    for (size_t i = 0; i < BENCH_ROCA_KEYS; i++) {
+        for (size_t j = 0; j < BENCH_ROCA_LEN; j++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            r->data[i][j] = x;
+        }
+        r->data[i][0] |= 0x80;
+        r->data[i][BENCH_ROCA_LEN - 1] |= 0x01;
+        r->len[i] = BENCH_ROCA_LEN;
+    }
+
+    int len = hex_to_bytes(bench_roca_weak, r->data[BENCH_ROCA_KEYS / 2], BENCH_ROCA_LEN);
+    if (len <= 0) {
+        free(r);
+        return PM3_EINVARG;
+    }
+    r->len[BENCH_ROCA_KEYS / 2] = len;
+    *ctx = r;
+    return PM3_SUCCESS;
+}
+
+static uint64_t bench_roca(void *ctx, uint64_t iters) {
+    const bench_roca_t *r = (const bench_roca_t *)ctx;
+    for (uint64_t i = 0; i < iters; i++) {
+        size_t found = 0;
+        for (size_t j = 0; j < BENCH_ROCA_KEYS; j++) {
+            found += emv_rocacheck(r->data[j], r->len[j], false);
+        }
+        if (found != 1 || emv_rocacheck(r->data[BENCH_ROCA_KEYS / 2], r->len[BENCH_ROCA_KEYS / 2], false) == false) {
+            return 0;
+        }
+    }
+    return iters * BENCH_ROCA_KEYS;
+}
+
+//-----------------------------------------------------------------------------
+
+static const pm3_bench_case_t bench_cases[] = {
+    {"crapto1.mfkey32",   "keys",    false, false, "mfkey32 moebius, lfsr_recovery32 + rollback", NULL, bench_mfkey32, NULL},
+    {"crapto1.mfkey64",   "keys",    false, false, "mfkey64, lfsr_recovery64 + rollback", NULL, bench_mfkey64, NULL},
+    {"hardnested.brute",  "states",  true,  true,  "hardnested brute_force_benchmark(), all threads", bench_hardnested_setup, bench_hardnested, NULL},
+    {"iclass.domac",      "macs",    false, false, "iCLASS doMAC", NULL, bench_domac, NULL},
+    {"iclass.domac_brute", "macs",   false, false, "iCLASS doMAC_brute", NULL, bench_domac_brute, NULL},
+    {"iclass.diversify",  "keys",    false, false, "iCLASS key diversification (DES + hash0)", NULL, bench_diversify, NULL},
+    {"loclass.bs64",      "macs",    false, false, "loclass bitsliced MAC, u64 backend", bench_bs64_setup, bench_bs, free},
+    {"loclass.bs128",     "macs",    false, false, "loclass bitsliced MAC, NEON backend", bench_bs128_setup, bench_bs, free},
+    {"loclass.bs256",     "macs",    false, false, "loclass bitsliced MAC, AVX2 backend", bench_bs256_setup, bench_bs, free},
+    {"loclass.bs512",     "macs",    false, false, "loclass bitsliced MAC, AVX-512 backend", bench_bs512_setup, bench_bs, free},
+    {"crypto.des",        "keys",    false, false, "DES key schedule + block", bench_des_setup, bench_des, NULL},
+    {"crypto.3des",       "blocks",  false, false, "2 key 3DES, encrypt + decrypt", NULL, bench_3des, NULL},
+    {"crypto.aes128",     "keys",    false, false, "AES-128 key schedule + block", bench_aes_setup, bench_aes, NULL},
+    {"lz4.table",         "bytes",   true,  false, "LZ4 frame decompression of a hardnested table", bench_lz4_setup, bench_lz4, bench_lz4_teardown},
+    {"lfdemod.em410x",    "samples", false, false, "ASK clock detect + demod + EM410x decode", bench_em410x_setup, bench_em410x, bench_trace_free},
+    {"lfdemod.hid",       "samples", false, false, "FSK demod + HID decode", bench_hid_setup, bench_hid, bench_trace_free},
+    {"lfdemod.psk",       "samples", false, false, "PSK1 raw demod, Indala trace", bench_psk_setup, bench_psk, bench_trace_free},
+    {"lfdemod.all.scalar", "samples", false, false, "all lf traces, ASK + FSK + PSK demod, scalar kernel", bench_traces_scalar_setup, bench_traces, bench_traces_free},
+    {"lfdemod.all.sse2",   "samples", false, false, "all lf traces, ASK + FSK + PSK demod, SSE2 kernel", bench_traces_sse2_setup, bench_traces, bench_traces_free},
+    {"lfdemod.all.avx2",   "samples", false, false, "all lf traces, ASK + FSK + PSK demod, AVX2 kernel", bench_traces_avx2_setup, bench_traces, bench_traces_free},
+    {"lfdemod.all.neon",   "samples", false, false, "all lf traces, ASK + FSK + PSK demod, NEON kernel", bench_traces_neon_setup, bench_traces, bench_traces_free},
+    {"rescache.lookup",   "lookups", false, false, "cached mad.json + oids.json lookups", bench_rescache_setup, bench_rescache, NULL},
+    {"emv.tlv",           "apdus",   false, false, "EMV TLV parse + 24 tag lookups", bench_emv_setup, bench_emv, free},
+    {"emv.roca",          "keys",    false, false, "ROCA fingerprint test, 2048 bit moduli", bench_roca_setup, bench_roca, free},
+};
+
+typedef struct {
+    const pm3_bench_case_t *c;
+    const char *status;     // ok, fail, skipped
+    uint32_t reps;
+    uint64_t iters;
+    double rate[PM3_BENCH_MAX_REPS];
+    double mean;
+    double stddev;
+    double min;
+    double max;
+} pm3_bench_result_t;
+
+static bool bench_selected(const pm3_bench_case_t *c, const char *filter) {
+    return (filter == NULL || filter[0] == '\0' || strstr(c->name, filter) != NULL);
+}
+
+// one repetition, ops/s or a negative value when the result was wrong
+static double bench_rep(const pm3_bench_case_t *c, void *ctx, uint64_t iters) {
+    uint64_t t0 = usclock();
+    uint64_t ops = c->run(ctx, iters);
+    uint64_t dt = usclock() - t0;
+    if (ops == 0) {
+        return -1;
+    }
+    if (c->self_timed) {
+        return (double)ops;
+    }
+    return (double)ops * 1000000.0 / (double)(dt ? dt : 1);
+}
+
+// smallest power of two iteration count running at least min_ms
+static uint64_t bench_calibrate(const pm3_bench_case_t *c, void *ctx, uint32_t min_ms) {
+    uint64_t iters = 1;
+    while (iters < (1ULL << 40)) {
+        uint64_t t0 = usclock();
+        if (c->run(ctx, iters) == 0) {
+            return 0;
+        }
+        uint64_t dt = usclock() - t0;
+        if (dt >= (uint64_t)min_ms * 1000) {
+            break;
+        }
+        // jump close to the target, at most 64x at a time
+        uint64_t mul = 2;
+        while (mul < 64 && (dt * mul) < ((uint64_t)min_ms * 1000)) {
+            mul <<= 1;
+        }
+        iters *= mul;
+    }
+    return iters;
+}
+
+static void bench_one(const pm3_bench_case_t *c, const pm3_bench_opts_t *opts, pm3_bench_result_t *r) {
+
+    memset(r, 0, sizeof(*r));
+    r->c = c;
+    r->status = "ok";
+
+    void *ctx = NULL;
+    if (c->setup) {
+        int res = c->setup(&ctx);
+        if (res == PM3_ENOTIMPL || res == PM3_EFILE) {
+            r->status = "skipped";
+            return;
+        }
+        if (res != PM3_SUCCESS) {
+            r->status = "fail";
+            return;
+        }
+    }
+
+    r->iters = (c->macro) ? 1 : bench_calibrate(c, ctx, opts->min_ms);
+    if (r->iters == 0) {
+        r->status = "fail";
+    }
+
+    for (uint32_t i = 0; i < opts->reps && r->iters; i++) {
+        double rate = bench_rep(c, ctx, r->iters);
+        if (rate < 0) {
+            r->status = "fail";
+            break;
+        }
+        r->rate[r->reps++] = rate;
+    }
+
+    if (c->teardown) {
+        c->teardown(ctx);
+    }
+
+    if (r->reps == 0) {
+        return;
+    }
+
+    r->min = r->max = r->rate[0];
+    double sum = 0;
+    for (uint32_t i = 0; i < r->reps; i++) {
+        sum += r->rate[i];
+        if (r->rate[i] < r->min) r->min = r->rate[i];
+        if (r->rate[i] > r->max) r->max = r->rate[i];
+    }
+    r->mean = sum / r->reps;
+
+    double var = 0;
+    for (uint32_t i = 0; i < r->reps; i++) {
+        var += (r->rate[i] - r->mean) * (r->rate[i] - r->mean);
+    }
+    r->stddev = (r->reps > 1) ? sqrt(var / (r->reps - 1)) : 0;
+}
+
+static const char *bench_sprint_rate(double v, char *s, size_t n) {
+    const char *sfx[] = {"", "k", "M", "G", "T"};
+    int i = 0;
+    while (v >= 1000.0 && i < 4) {
+        v /= 1000.0;
+        i++;
+    }
+    snprintf(s, n, "%7.2f %s", v, sfx[i]);
+    return s;
+}
+
+static json_t *bench_json(const pm3_bench_result_t *res, size_t n, const pm3_bench_opts_t *opts) {
+    json_t *root = json_object();
+    json_object_set_new(root, "FileType", json_string("pm3 bench"));
+    json_object_set_new(root, "reps", json_integer(opts->reps));
+    json_object_set_new(root, "min_ms", json_integer(opts->min_ms));
+    json_object_set_new(root, "cpus", json_integer(num_CPUs()));
+
+    json_t *cases = json_array();
+    for (size_t i = 0; i < n; i++) {
+        const pm3_bench_result_t *r = &res[i];
+        json_t *j = json_object();
+        json_object_set_new(j, "name", json_string(r->c->name));
+        json_object_set_new(j, "unit", json_string(r->c->unit));
+        json_object_set_new(j, "kind", json_string(r->c->macro ? "macro" : "micro"));
+        json_object_set_new(j, "status", json_string(r->status));
+        if (r->reps) {
+            json_object_set_new(j, "iters", json_integer(r->iters));
+            json_object_set_new(j, "mean", json_real(r->mean));
+            json_object_set_new(j, "stddev", json_real(r->stddev));
+            json_object_set_new(j, "min", json_real(r->min));
+            json_object_set_new(j, "max", json_real(r->max));
+            json_t *samples = json_array();
+            for (uint32_t k = 0; k < r->reps; k++) {
+                json_array_append_new(samples, json_real(r->rate[k]));
+            }
+            json_object_set_new(j, "samples", samples);
+        }
+        json_array_append_new(cases, j);
+    }
+    json_object_set_new(root, "cases", cases);
+    return root;
+}
+
+void pm3_bench_list(void) {
+    PrintAndLogEx(INFO, "%-20s | %-7s | %-5s | %s", "case", "unit", "kind", "description");
+    PrintAndLogEx(INFO, "---------------------+---------+-------+-------------------------------------------");
+    for (size_t i = 0; i < ARRAYLEN(bench_cases); i++) {
+        const pm3_bench_case_t *c = &bench_cases[i];
+        PrintAndLogEx(INFO, "%-20s | %-7s | %-5s | %s", c->name, c->unit, c->macro ? "macro" : "micro", c->desc);
+    }
+}
+
+int pm3_bench_run(const pm3_bench_opts_t *opts_in) {
+
+    pm3_bench_opts_t opts = *opts_in;
+    if (opts.reps == 0) opts.reps = 5;
+    if (opts.reps > PM3_BENCH_MAX_REPS) opts.reps = PM3_BENCH_MAX_REPS;
+    if (opts.min_ms == 0) opts.min_ms = 200;
+
+    pm3_bench_result_t *res = calloc(ARRAYLEN(bench_cases), sizeof(pm3_bench_result_t));
+    if (res == NULL) {
+        PrintAndLogEx(WARNING, "Failed to allocate memory");
+        return PM3_EMALLOC;
+    }
+
+    if (opts.json == false) {
+        PrintAndLogEx(INFO, "%u reps, micro cases calibrated to >= %u ms per rep", opts.reps, opts.min_ms);
+        PrintAndLogEx(NORMAL, "");
+        PrintAndLogEx(INFO, "%-20s | %-7s | %13s | %8s | %13s | %s", "case", "unit", "ops/s", "stddev", "best", "status");
+        PrintAndLogEx(INFO, "---------------------+---------+---------------+----------+---------------+--------");
+    }
+
+    size_t n = 0;
+    bool failed = false;
+    for (size_t i = 0; i < ARRAYLEN(bench_cases); i++) {
+        const pm3_bench_case_t *c = &bench_cases[i];
+        if (bench_selected(c, opts.filter) == false) {
+            continue;
+        }
+
+        pm3_bench_result_t *r = &res[n++];
+        bench_one(c, &opts, r);
+        failed |= (strcmp(r->status, "fail") == 0);
+
+        if (opts.json) {
+            continue;
+        }
+
+        if (r->reps && strcmp(r->status, "ok") == 0) {
+            char mean[20], best[20];
+            PrintAndLogEx(INFO, "%-20s | %-7s | " _YELLOW_("%13s") " | %7.2f%% | %13s | " _GREEN_("ok")
+                          , c->name
+                          , c->unit
+                          , bench_sprint_rate(r->mean, mean, sizeof(mean))
+                          , (r->mean > 0) ? 100.0 * r->stddev / r->mean : 0.0
+                          , bench_sprint_rate(r->max, best, sizeof(best))
+                         );
+        } else if (strcmp(r->status, "skipped") == 0) {
+            PrintAndLogEx(INFO, "%-20s | %-7s | %13s | %8s | %13s | skipped", c->name, c->unit, "", "", "");
+        } else {
+            PrintAndLogEx(INFO, "%-20s | %-7s | %13s | %8s | %13s | " _RED_("fail"), c->name, c->unit, "", "", "");
+        }
+    }
+
+    if (n == 0) {
+        PrintAndLogEx(FAILED, "No case matches `" _YELLOW_("%s") "`", opts.filter);
+        free(res);
+        return PM3_EINVARG;
+    }
+
+    json_t *root = bench_json(res, n, &opts);
+    if (opts.json) {
+        char *s = json_dumps(root, JSON_INDENT(2));
+        char *line = s;
+        while (line) {
+            char *nl = strchr(line, '\n');
+            if (nl) {
+                *nl++ = '\0';
+            }
+            PrintAndLogEx(NORMAL, "%s", line);
+            line = nl;
+        }
+        free(s);
+    } else {
+        PrintAndLogEx(NORMAL, "");
+    }
+
+    if (opts.filename) {
+        saveFileJSONrootEx(opts.filename, root, JSON_INDENT(2), true, true, spDefault);
+    }
+    json_decref(root);
+    free(res);
+
+    if (failed) {
+        PrintAndLogEx(FAILED, "Benchmarks ( " _RED_("fail") " )");
+        return PM3_ESOFT;
+    }
+    if (opts.json == false) {
+        PrintAndLogEx(SUCCESS, "Benchmarks ( " _GREEN_("ok") " )");
+    }
+    return PM3_SUCCESS;
+}
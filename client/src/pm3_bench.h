@@ -0,0 +1,47 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Offline benchmarks of the client kernels on fixed inputs
+//
+// Each case runs its kernel on the same input every time and checks the
+// result, so a wrong answer shows as a failure instead of a fast number.
+// Micro cases are calibrated to run at least the given time per repetition,
+// macro cases run a whole pipeline stage once per repetition.
+//-----------------------------------------------------------------------------
+
+#ifndef PM3_BENCH_H__
+#define PM3_BENCH_H__
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *filter;     // substring of the case names to run, NULL for all
+    uint32_t reps;          // repetitions per case
+    uint32_t min_ms;        // minimum time of one micro repetition
+    bool json;              // print JSON instead of a table
+    const char *filename;   // also save JSON to this file, NULL for none
+} pm3_bench_opts_t;
+
+void pm3_bench_list(void);
+int pm3_bench_run(const pm3_bench_opts_t *opts);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -21,9 +21,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "pm3_cmd.h"
 #include "commonutil.h"    // ARRAYLEN
+#include "util.h"          // num_CPUs
+#include "pm3_fft_kernels.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -31,6 +34,8 @@
 
 // refuse to allocate a spectrogram larger than this, in doubles
 #define PM3_DSP_MAX_STFT_CELLS  (8 * 1024 * 1024)
+// STFT frames handed to a worker per claim
+#define PM3_DSP_STFT_BATCH      32
 
 // peaks closer together than this many bins are treated as the same peak
 #define PM3_DSP_PEAK_SEP        3
@@ -71,6 +76,43 @@ static bool is_pow2(size_t v) {
     return (v != 0) && ((v & (v - 1)) == 0);
 }
 
+static const pm3_fft_kernel_t fft_kernels[] = {
+    { "scalar", pm3_fft_pass_scalar },
+    { "NEON", pm3_fft_pass_neon },
+    { "AVX2", pm3_fft_pass_avx2 },
+};
+
+static pm3_fft_kernel_t fft_usable[ARRAYLEN(fft_kernels)];
+static size_t fft_usable_count = 0;
+static pthread_once_t fft_usable_once = PTHREAD_ONCE_INIT;
+
+static void fft_usable_init(void) {
+    fft_usable[fft_usable_count++] = fft_kernels[0];
+    if (pm3_fft_neon_supported()) {
+        fft_usable[fft_usable_count++] = fft_kernels[1];
+    }
+    if (pm3_fft_avx2_supported()) {
+        fft_usable[fft_usable_count++] = fft_kernels[2];
+    }
+}
+
+size_t pm3_fft_kernels(const pm3_fft_kernel_t **list) {
+
+    // callers may be STFT worker threads
+    pthread_once(&fft_usable_once, fft_usable_init);
+
+    if (list != NULL) {
+        *list = fft_usable;
+    }
+    return fft_usable_count;
+}
+
+static pm3_cplx_t unit_root(size_t k, size_t n) {
+    const double ang = -2.0 * M_PI * (double)k / (double)n;
+    pm3_cplx_t w = { cos(ang), sin(ang) };
+    return w;
+}
+
 pm3_fft_plan_t *pm3_fft_plan_create(size_t n) {
 
     if (is_pow2(n) == false || n < 2 || n > PM3_DSP_MAX_FFT) {
@@ -85,15 +127,14 @@ pm3_fft_plan_t *pm3_fft_plan_create(size_t n) {
     plan->n = n;
     plan->twiddle = calloc(n / 2, sizeof(pm3_cplx_t));
     plan->rev = calloc(n, sizeof(uint32_t));
-    if (plan->twiddle == NULL || plan->rev == NULL) {
+    plan->stage = calloc(n, sizeof(pm3_cplx_t));
+    if (plan->twiddle == NULL || plan->rev == NULL || plan->stage == NULL) {
         pm3_fft_plan_destroy(plan);
         return NULL;
     }
 
     for (size_t k = 0; k < n / 2; k++) {
-        double ang = -2.0 * M_PI * (double)k / (double)n;
-        plan->twiddle[k].re = cos(ang);
-        plan->twiddle[k].im = sin(ang);
+        plan->twiddle[k] = unit_root(k, n);
     }
 
     // bit reversal permutation, built incrementally so we never need to know the width
@@ -114,6 +155,25 @@ pm3_fft_plan_t *pm3_fft_plan_create(size_t n) {
         plan->rev[i] = (uint32_t)r;
     }
 
+    // Radix-4 passes, in the order pm3_fft runs them.  An odd log2(n) starts
+    // with a single radix-2 pass which needs no twiddles.  The three tables of
+    // a pass are computed directly rather than by stepping through the big
+    // table, W^3k runs past its end.  Sum of 3 * len / 4 stays below n.
+    pm3_cplx_t *tw = plan->stage;
+    for (size_t len = (shift & 1) ? 8 : 4; len <= n; len <<= 2) {
+        const size_t q = len / 4;
+        for (size_t k = 0; k < q; k++) {
+            tw[k] = unit_root(2 * k, len);
+            tw[q + k] = unit_root(k, len);
+            tw[(2 * q) + k] = unit_root(3 * k, len);
+        }
+        tw += 3 * q;
+    }
+
+    const pm3_fft_kernel_t *kernels = NULL;
+    const size_t nkernels = pm3_fft_kernels(&kernels);
+    plan->pass = kernels[nkernels - 1].pass;
+
     return plan;
 }
 
@@ -123,9 +183,35 @@ void pm3_fft_plan_destroy(pm3_fft_plan_t *plan) {
     }
     free(plan->twiddle);
     free(plan->rev);
+    free(plan->stage);
     free(plan);
 }
 
+static void fft_conj(pm3_cplx_t *data, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        data[i].im = -data[i].im;
+    }
+}
+
+static void fft_bitrev(const pm3_fft_plan_t *plan, pm3_cplx_t *data) {
+    for (size_t i = 0; i < plan->n; i++) {
+        size_t j = plan->rev[i];
+        if (j > i) {
+            pm3_cplx_t tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    }
+}
+
+static void fft_unscale(pm3_cplx_t *data, size_t n) {
+    const double scale = 1.0 / (double)n;
+    for (size_t i = 0; i < n; i++) {
+        data[i].re *= scale;
+        data[i].im *= -scale;
+    }
+}
+
 void pm3_fft(const pm3_fft_plan_t *plan, pm3_cplx_t *data, bool inverse) {
 
     if (plan == NULL || data == NULL) {
@@ -135,22 +221,52 @@ void pm3_fft(const pm3_fft_plan_t *plan, pm3_cplx_t *data, bool inverse) {
     const size_t n = plan->n;
 
     // the inverse transform is the forward transform of the conjugate,
-    // conjugated again and scaled.  Keeps a single twiddle table.
+    // conjugated again and scaled.  Keeps a single set of twiddles.
     if (inverse) {
-        for (size_t i = 0; i < n; i++) {
-            data[i].im = -data[i].im;
-        }
+        fft_conj(data, n);
     }
 
-    for (size_t i = 0; i < n; i++) {
-        size_t j = plan->rev[i];
-        if (j > i) {
-            pm3_cplx_t tmp = data[i];
-            data[i] = data[j];
-            data[j] = tmp;
+    fft_bitrev(plan, data);
+
+    size_t len = 4;
+    if ((n & 0x5555555555555555ULL) == 0) {
+        // odd log2(n), one radix-2 pass of trivial butterflies first
+        for (size_t i = 0; i < n; i += 2) {
+            const pm3_cplx_t a = data[i];
+            const pm3_cplx_t b = data[i + 1];
+            data[i].re = a.re + b.re;
+            data[i].im = a.im + b.im;
+            data[i + 1].re = a.re - b.re;
+            data[i + 1].im = a.im - b.im;
         }
+        len = 8;
+    }
+
+    const pm3_cplx_t *tw = plan->stage;
+    for (; len <= n; len <<= 2) {
+        plan->pass(data, n, len / 4, tw);
+        tw += 3 * (len / 4);
+    }
+
+    if (inverse) {
+        fft_unscale(data, n);
+    }
+}
+
+void pm3_fft_radix2(const pm3_fft_plan_t *plan, pm3_cplx_t *data, bool inverse) {
+
+    if (plan == NULL || data == NULL) {
+        return;
     }
 
+    const size_t n = plan->n;
+
+    if (inverse) {
+        fft_conj(data, n);
+    }
+
+    fft_bitrev(plan, data);
+
     for (size_t span = 2; span <= n; span <<= 1) {
 
         const size_t half = span / 2;
@@ -175,12 +291,145 @@ void pm3_fft(const pm3_fft_plan_t *plan, pm3_cplx_t *data, bool inverse) {
     }
 
     if (inverse) {
-        const double scale = 1.0 / (double)n;
-        for (size_t i = 0; i < n; i++) {
-            data[i].re *= scale;
-            data[i].im *= -scale;
+        fft_unscale(data, n);
+    }
+}
+
+pm3_rfft_plan_t *pm3_rfft_plan_create(size_t n) {
+
+    if (is_pow2(n) == false || n < 2 || n > PM3_DSP_MAX_FFT) {
+        return NULL;
+    }
+
+    pm3_rfft_plan_t *plan = calloc(1, sizeof(pm3_rfft_plan_t));
+    if (plan == NULL) {
+        return NULL;
+    }
+
+    plan->n = n;
+    if (n == 2) {
+        return plan;
+    }
+
+    plan->half = pm3_fft_plan_create(n / 2);
+    plan->post = calloc((n / 4) + 1, sizeof(pm3_cplx_t));
+    if (plan->half == NULL || plan->post == NULL) {
+        pm3_rfft_plan_destroy(plan);
+        return NULL;
+    }
+
+    for (size_t k = 0; k <= n / 4; k++) {
+        plan->post[k] = unit_root(k, n);
+    }
+    return plan;
+}
+
+void pm3_rfft_plan_destroy(pm3_rfft_plan_t *plan) {
+    if (plan == NULL) {
+        return;
+    }
+    pm3_fft_plan_destroy(plan->half);
+    free(plan->post);
+    free(plan);
+}
+
+void pm3_rfft(const pm3_rfft_plan_t *plan, const double *in, pm3_cplx_t *out) {
+
+    if (plan == NULL || in == NULL || out == NULL) {
+        return;
+    }
+
+    const size_t n = plan->n;
+    const size_t h = n / 2;
+
+    if (plan->half == NULL) {
+        out[0].re = in[0] + in[1];
+        out[0].im = 0.0;
+        out[1].re = in[0] - in[1];
+        out[1].im = 0.0;
+        return;
+    }
+
+    // even samples go to the real part, odd samples to the imaginary part.
+    // pm3_cplx_t is two doubles, so that is a straight copy.
+    memcpy(out, in, n * sizeof(double));
+    pm3_fft(plan->half, out, false);
+
+    // Split Z into the spectra of the even and odd samples and recombine:
+    //   E = (Z[k] + conj(Z[h-k])) / 2,  O = -i * (Z[k] - conj(Z[h-k])) / 2
+    //   X[k] = E + W^k O,  X[h-k] = conj(E - W^k O)
+    const pm3_cplx_t z0 = out[0];
+    out[0].re = z0.re + z0.im;
+    out[0].im = 0.0;
+    out[h].re = z0.re - z0.im;
+    out[h].im = 0.0;
+
+    for (size_t k = 1; k <= h / 2; k++) {
+
+        const pm3_cplx_t a = out[k];
+        const pm3_cplx_t b = out[h - k];
+
+        const double er = 0.5 * (a.re + b.re);
+        const double ei = 0.5 * (a.im - b.im);
+        const double orr = 0.5 * (a.im + b.im);
+        const double oi = -0.5 * (a.re - b.re);
+
+        const pm3_cplx_t w = plan->post[k];
+        const double wr = (orr * w.re) - (oi * w.im);
+        const double wi = (orr * w.im) + (oi * w.re);
+
+        out[k].re = er + wr;
+        out[k].im = ei + wi;
+        out[h - k].re = er - wr;
+        out[h - k].im = wi - ei;
+    }
+}
+
+void pm3_irfft(const pm3_rfft_plan_t *plan, pm3_cplx_t *in, double *out) {
+
+    if (plan == NULL || in == NULL || out == NULL) {
+        return;
+    }
+
+    const size_t n = plan->n;
+    const size_t h = n / 2;
+
+    if (plan->half == NULL) {
+        const double x0 = 0.5 * (in[0].re + in[1].re);
+        const double x1 = 0.5 * (in[0].re - in[1].re);
+        out[0] = x0;
+        out[1] = x1;
+        return;
+    }
+
+    // pm3_rfft run backwards:  E = (X[k] + conj(X[h-k])) / 2 is the spectrum
+    // of the even samples, O = (X[k] - conj(X[h-k])) * conj(W^k) / 2 that of
+    // the odd ones.  Z = E + i O transforms back to them interleaved.
+    for (size_t k = 0; k <= h / 2; k++) {
+
+        const pm3_cplx_t a = in[k];
+        const pm3_cplx_t b = in[h - k];
+
+        const double er = 0.5 * (a.re + b.re);
+        const double ei = 0.5 * (a.im - b.im);
+        const double dr = 0.5 * (a.re - b.re);
+        const double di = 0.5 * (a.im + b.im);
+
+        const pm3_cplx_t w = plan->post[k];
+        const double orr = (dr * w.re) + (di * w.im);
+        const double oi = (di * w.re) - (dr * w.im);
+
+        // the pair shares E and O, conjugated, so i O turns into (-oi, orr)
+        in[k].re = er - oi;
+        in[k].im = ei + orr;
+        if (k > 0) {
+            in[h - k].re = er + oi;
+            in[h - k].im = orr - ei;
         }
     }
+
+    pm3_fft(plan->half, in, true);
+    memmove(out, in, n * sizeof(double));
 }
 
 bool pm3_window_from_str(const char *str, pm3_window_t *out) {
@@ -330,17 +579,17 @@ int pm3_spectrum(const double *sig, size_t len, size_t n, pm3_window_t win, pm3_
 
     memset(out, 0, sizeof(pm3_spectrum_t));
 
-    pm3_fft_plan_t *plan = pm3_fft_plan_create(n);
+    pm3_rfft_plan_t *plan = pm3_rfft_plan_create(n);
     if (plan == NULL) {
         return PM3_EMALLOC;
     }
 
-    pm3_cplx_t *buf = calloc(n, sizeof(pm3_cplx_t));
+    pm3_cplx_t *buf = calloc((n / 2) + 1, sizeof(pm3_cplx_t));
     double *win_buf = calloc(n, sizeof(double));
     if (buf == NULL || win_buf == NULL) {
         free(buf);
         free(win_buf);
-        pm3_fft_plan_destroy(plan);
+        pm3_rfft_plan_destroy(plan);
         return PM3_EMALLOC;
     }
 
@@ -348,15 +597,10 @@ int pm3_spectrum(const double *sig, size_t len, size_t n, pm3_window_t win, pm3_
     memcpy(win_buf, sig, take * sizeof(double));
     pm3_apply_window(win_buf, n, win);
 
-    for (size_t i = 0; i < n; i++) {
-        buf[i].re = win_buf[i];
-        buf[i].im = 0.0;
-    }
+    pm3_rfft(plan, win_buf, buf);
+    pm3_rfft_plan_destroy(plan);
     free(win_buf);
 
-    pm3_fft(plan, buf, false);
-    pm3_fft_plan_destroy(plan);
-
     out->n = n;
     out->nbins = (n / 2) + 1;
     out->mag = calloc(out->nbins, sizeof(double));
@@ -497,7 +741,145 @@ size_t pm3_find_peaks(const pm3_spectrum_t *spec, pm3_peak_t *peaks, size_t max_
     return found;
 }
 
+typedef struct {
+    const double *sig;
+    const double *window;           // n coefficients, computed once
+    const pm3_rfft_plan_t *plan;    // read only, shared by all workers
+    double anchor;
+    pm3_stft_t *out;
+    size_t next;                    // next unclaimed frame
+} stft_job_t;
+
+static void stft_frame(stft_job_t *job, size_t f, double *frame, pm3_cplx_t *buf) {
+
+    pm3_stft_t *out = job->out;
+    const size_t n = out->n;
+    const size_t nbins = out->nbins;
+    const size_t off = f * out->hop;
+    out->frame_start[f] = off;
+
+    memcpy(frame, job->sig + off, n * sizeof(double));
+    pm3_remove_mean(frame, n);
+    for (size_t i = 0; i < n; i++) {
+        frame[i] *= job->window[i];
+    }
+
+    pm3_rfft(job->plan, frame, buf);
+
+    double best = 0.0;
+    size_t best_bin = 0;
+    double energy = 0.0;
+
+    size_t search_lo = PM3_DSP_DC_GUARD;
+    size_t search_hi = nbins;
+
+    if (job->anchor > 0.0) {
+
+        const double lo = (job->anchor / 1.2) * (double)n;
+        const double hi = (job->anchor * 1.2) * (double)n;
+
+        if (lo > (double)search_lo) {
+            search_lo = (size_t)lo;
+        }
+
+        if (hi < (double)search_hi) {
+            search_hi = (size_t)hi + 1;
+        }
+
+        if (search_hi <= search_lo + 2) {
+            search_lo = PM3_DSP_DC_GUARD;
+            search_hi = nbins;
+        }
+    }
+
+    double *row = &out->ridge[f * nbins];
+
+    for (size_t i = 0; i < nbins; i++) {
+
+        const double m = sqrt(buf[i].re * buf[i].re + buf[i].im * buf[i].im);
+
+        row[i] = m;
+
+        if (i >= PM3_DSP_DC_GUARD) {
+            energy += m * m;
+        }
+
+        if (i >= search_lo && i < search_hi && m > best) {
+            best = m;
+            best_bin = i;
+        }
+    }
+
+    // sub bin refine the dominant line so drift shows up as a smooth curve
+    // rather than a staircase of whole bins
+    double delta = 0.0;
+    if (best_bin > 0 && best_bin + 1 < nbins) {
+
+        const double a = 20.0 * log10(row[best_bin - 1] + 1e-30);
+        const double b = 20.0 * log10(row[best_bin] + 1e-30);
+        const double c = 20.0 * log10(row[best_bin + 1] + 1e-30);
+        const double denom = a - (2.0 * b) + c;
+
+        if (fabs(denom) > 1e-12) {
+            delta = 0.5 * (a - c) / denom;
+        }
+
+        if (delta > 0.5) {
+            delta = 0.5;
+        }
+
+        if (delta < -0.5) {
+            delta = -0.5;
+        }
+    }
+
+    out->peak_mag[f] = best;
+    out->peak_freq[f] = ((double)best_bin + delta) / (double)n;
+    out->frame_energy[f] = sqrt(energy);
+}
+
+// Frames are claimed PM3_DSP_STFT_BATCH at a time, every frame writes its
+// own row of the output so workers never touch the same memory.
+static void *stft_worker(void *arg) {
+
+    stft_job_t *job = (stft_job_t *)arg;
+    const size_t n = job->out->n;
+
+    double *frame = calloc(n, sizeof(double));
+    pm3_cplx_t *buf = calloc((n / 2) + 1, sizeof(pm3_cplx_t));
+    if (frame == NULL || buf == NULL) {
+        free(frame);
+        free(buf);
+        return NULL;
+    }
+
+    for (;;) {
+        size_t f = __atomic_fetch_add(&job->next, PM3_DSP_STFT_BATCH, __ATOMIC_SEQ_CST);
+        if (f >= job->out->nframes) {
+            break;
+        }
+
+        size_t end = f + PM3_DSP_STFT_BATCH;
+        if (end > job->out->nframes) {
+            end = job->out->nframes;
+        }
+
+        for (; f < end; f++) {
+            stft_frame(job, f, frame, buf);
+        }
+    }
+
+    free(frame);
+    free(buf);
+    return NULL;
+}
+
 int pm3_stft(const double *sig, size_t len, size_t n, size_t hop, pm3_window_t win, double anchor, pm3_stft_t *out) {
+    return pm3_stft_threads(sig, len, n, hop, win, anchor, 0, out);
+}
+
+int pm3_stft_threads(const double *sig, size_t len, size_t n, size_t hop, pm3_window_t win, double anchor,
+                     int threads, pm3_stft_t *out) {
 
     if (sig == NULL || out == NULL || hop == 0 || is_pow2(n) == false || n < 2) {
         return PM3_EINVARG;
@@ -530,107 +912,66 @@ int pm3_stft(const double *sig, size_t len, size_t n, size_t hop, pm3_window_t w
         return PM3_EMALLOC;
     }
 
-    pm3_fft_plan_t *plan = pm3_fft_plan_create(n);
-    pm3_cplx_t *buf = calloc(n, sizeof(pm3_cplx_t));
-    double *frame = calloc(n, sizeof(double));
+    pm3_rfft_plan_t *plan = pm3_rfft_plan_create(n);
+    double *window = calloc(n, sizeof(double));
 
-    if (plan == NULL || buf == NULL || frame == NULL) {
-        pm3_fft_plan_destroy(plan);
-        free(buf);
-        free(frame);
+    if (plan == NULL || window == NULL) {
+        pm3_rfft_plan_destroy(plan);
+        free(window);
         pm3_stft_free(out);
         return PM3_EMALLOC;
     }
 
-    for (size_t f = 0; f < nframes; f++) {
-
-        const size_t off = f * hop;
-        out->frame_start[f] = off;
-
-        memcpy(frame, sig + off, n * sizeof(double));
-        pm3_remove_mean(frame, n);
-        pm3_apply_window(frame, n, win);
-
-        for (size_t i = 0; i < n; i++) {
-            buf[i].re = frame[i];
-            buf[i].im = 0.0;
-        }
-
-        pm3_fft(plan, buf, false);
-
-        double best = 0.0;
-        size_t best_bin = 0;
-        double energy = 0.0;
-
-        size_t search_lo = PM3_DSP_DC_GUARD;
-        size_t search_hi = nbins;
-
-        if (anchor > 0.0) {
-
-            const double lo = (anchor / 1.2) * (double)n;
-            const double hi = (anchor * 1.2) * (double)n;
-
-            if (lo > (double)search_lo) {
-                search_lo = (size_t)lo;
-            }
-
-            if (hi < (double)search_hi) {
-                search_hi = (size_t)hi + 1;
-            }
-
-            if (search_hi <= search_lo + 2) {
-                search_lo = PM3_DSP_DC_GUARD;
-                search_hi = nbins;
-            }
-        }
+    // the window is the same for every frame, no point in redoing the cosines
+    for (size_t i = 0; i < n; i++) {
+        window[i] = 1.0;
+    }
+    pm3_apply_window(window, n, win);
 
-        for (size_t i = 0; i < nbins; i++) {
+    stft_job_t job = {
+        .sig = sig,
+        .window = window,
+        .plan = plan,
+        .anchor = anchor,
+        .out = out,
+    };
 
-            const double m = sqrt(buf[i].re * buf[i].re + buf[i].im * buf[i].im);
+    if (threads <= 0) {
+        threads = num_CPUs();
+    }
 
-            out->ridge[(f * nbins) + i] = m;
+    // not worth a thread unless it gets a couple of batches
+    const size_t useful = (nframes / (2 * PM3_DSP_STFT_BATCH)) + 1;
+    if ((size_t)threads > useful) {
+        threads = (int)useful;
+    }
 
-            if (i >= PM3_DSP_DC_GUARD) {
-                energy += m * m;
-            }
+    int started = 0;
+    pthread_t th[threads];
 
-            if (i >= search_lo && i < search_hi && m > best) {
-                best = m;
-                best_bin = i;
-            }
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&th[i], NULL, stft_worker, &job)) {
+            break;
         }
+        started++;
+    }
 
-        // sub bin refine the dominant line so drift shows up as a smooth curve
-        // rather than a staircase of whole bins
-        double delta = 0.0;
-        if (best_bin > 0 && best_bin + 1 < nbins) {
-
-            const double a = 20.0 * log10(out->ridge[(f * nbins) + best_bin - 1] + 1e-30);
-            const double b = 20.0 * log10(out->ridge[(f * nbins) + best_bin] + 1e-30);
-            const double c = 20.0 * log10(out->ridge[(f * nbins) + best_bin + 1] + 1e-30);
-            const double denom = a - (2.0 * b) + c;
-
-            if (fabs(denom) > 1e-12) {
-                delta = 0.5 * (a - c) / denom;
-            }
+    // the calling thread takes its share as well
+    stft_worker(&job);
 
-            if (delta > 0.5) {
-                delta = 0.5;
-            }
+    for (int i = 0; i < started; i++) {
+        pthread_join(th[i], NULL);
+    }
 
-            if (delta < -0.5) {
-                delta = -0.5;
-            }
-        }
+    pm3_rfft_plan_destroy(plan);
+    free(window);
 
-        out->peak_mag[f] = best;
-        out->peak_freq[f] = ((double)best_bin + delta) / (double)n;
-        out->frame_energy[f] = sqrt(energy);
+    // a worker short of memory simply leaves its frames to the others,
+    // only give up when nobody got to run at all
+    if (job.next < nframes) {
+        pm3_stft_free(out);
+        return PM3_EMALLOC;
     }
-
-    pm3_fft_plan_destroy(plan);
-    free(buf);
-    free(frame);
     return PM3_SUCCESS;
 }
 
@@ -1435,30 +1776,36 @@ double pm3_autocorr_period(const double *sig, size_t len, double *strength) {
         n = PM3_DSP_MAX_FFT;
     }
 
-    pm3_fft_plan_t *plan = pm3_fft_plan_create(n);
-    pm3_cplx_t *buf = calloc(n, sizeof(pm3_cplx_t));
-    if (plan == NULL || buf == NULL) {
-        pm3_fft_plan_destroy(plan);
+    pm3_rfft_plan_t *plan = pm3_rfft_plan_create(n);
+    pm3_cplx_t *buf = calloc((n / 2) + 1, sizeof(pm3_cplx_t));
+    double *pad = calloc(n, sizeof(double));
+    if (plan == NULL || buf == NULL || pad == NULL) {
+        pm3_rfft_plan_destroy(plan);
         free(buf);
+        free(pad);
         return 0.0;
     }
 
     const size_t take = (len < n / 2) ? len : n / 2;
-    for (size_t i = 0; i < take; i++) {
-        buf[i].re = sig[i];
-    }
-
-    pm3_fft(plan, buf, false);
-
-    // Wiener-Khinchin: the autocorrelation is the inverse transform of the power spectrum
-    for (size_t i = 0; i < n; i++) {
-        const double p = (buf[i].re * buf[i].re) + (buf[i].im * buf[i].im);
-        buf[i].re = p;
-        buf[i].im = 0.0;
+    memcpy(pad, sig, take * sizeof(double));
+
+    pm3_rfft(plan, pad, buf);
+
+    // Wiener-Khinchin: the autocorrelation is the inverse transform of the
+    // power spectrum.  That spectrum is real and even, so its inverse is
+    // the real part of its forward transform over n.
+    const double scale = 1.0 / (double)n;
+    for (size_t i = 0; i <= n / 2; i++) {
+        const double p = ((buf[i].re * buf[i].re) + (buf[i].im * buf[i].im)) * scale;
+        pad[i] = p;
+        if (i > 0 && i < n / 2) {
+            pad[n - i] = p;
+        }
     }
 
-    pm3_fft(plan, buf, true);
-    pm3_fft_plan_destroy(plan);
+    pm3_rfft(plan, pad, buf);
+    pm3_rfft_plan_destroy(plan);
+    free(pad);
 
     const double energy = buf[0].re;
     if (energy <= 0.0) {
@@ -47,12 +47,30 @@ typedef struct {
     double im;
 } pm3_cplx_t;
 
+// one radix-4 pass over blocks of 4 * q points, see pm3_fft_kernels.h
+typedef void (*pm3_fft_pass_t)(pm3_cplx_t *data, size_t n, size_t q, const pm3_cplx_t *tw);
+
+typedef struct {
+    const char *name;
+    pm3_fft_pass_t pass;
+} pm3_fft_kernel_t;
+
 typedef struct {
     size_t n;
     pm3_cplx_t *twiddle;    // n / 2 entries, exp(-2*pi*i*k/n)
     uint32_t *rev;          // n entries, bit reversal permutation
+    pm3_cplx_t *stage;      // radix-4 twiddles, contiguous per pass
+    pm3_fft_pass_t pass;    // best kernel for this CPU, picked at plan time
 } pm3_fft_plan_t;
 
+// real input transform of length n, done as an n / 2 point complex transform
+// of the even / odd samples followed by a post twiddle pass
+typedef struct {
+    size_t n;
+    pm3_fft_plan_t *half;   // n / 2 point complex plan, NULL when n == 2
+    pm3_cplx_t *post;       // n / 4 + 1 entries, exp(-2*pi*i*k/n)
+} pm3_rfft_plan_t;
+
 typedef struct {
     size_t n;               // transform length
     size_t nbins;           // n / 2 + 1, input is real
@@ -144,6 +162,18 @@ int pm3_analyse(const double *sig, size_t len, size_t n, pm3_window_t win, pm3_s
 pm3_fft_plan_t *pm3_fft_plan_create(size_t n);
 void pm3_fft_plan_destroy(pm3_fft_plan_t *plan);
 void pm3_fft(const pm3_fft_plan_t *plan, pm3_cplx_t *data, bool inverse);
+// plain radix-2 transform, kept as the reference for the self test
+void pm3_fft_radix2(const pm3_fft_plan_t *plan, pm3_cplx_t *data, bool inverse);
+// kernels usable on this CPU, the scalar one first and the best one last
+size_t pm3_fft_kernels(const pm3_fft_kernel_t **list);
+
+pm3_rfft_plan_t *pm3_rfft_plan_create(size_t n);
+void pm3_rfft_plan_destroy(pm3_rfft_plan_t *plan);
+// forward transform of n real samples into n / 2 + 1 bins
+void pm3_rfft(const pm3_rfft_plan_t *plan, const double *in, pm3_cplx_t *out);
+// inverse of pm3_rfft, n / 2 + 1 bins back to n real samples.  in is used as
+// scratch and left garbled, out may be in itself.
+void pm3_irfft(const pm3_rfft_plan_t *plan, pm3_cplx_t *in, double *out);
 
 size_t pm3_next_pow2(size_t v);
 bool pm3_window_from_str(const char *str, pm3_window_t *out);
@@ -171,6 +201,9 @@ int pm3_spectrum(const double *sig, size_t len, size_t n, pm3_window_t win, pm3_
 void pm3_spectrum_free(pm3_spectrum_t *spec);
 size_t pm3_find_peaks(const pm3_spectrum_t *spec, pm3_peak_t *peaks, size_t max_peaks);
 int pm3_stft(const double *sig, size_t len, size_t n, size_t hop, pm3_window_t win, double anchor, pm3_stft_t *out);
+// same, frames shared out over threads workers, threads <= 0 uses all CPUs
+int pm3_stft_threads(const double *sig, size_t len, size_t n, size_t hop, pm3_window_t win, double anchor,
+                     int threads, pm3_stft_t *out);
 void pm3_stft_free(pm3_stft_t *st);
 
 typedef struct {
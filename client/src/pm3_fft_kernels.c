@@ -0,0 +1,224 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Radix-4 butterfly passes for pm3_fft, scalar, AVX2 and NEON
+//-----------------------------------------------------------------------------
+
+#include "pm3_fft_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define PM3_FFT_HAVE_X86 1
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define PM3_FFT_HAVE_NEON 1
+#endif
+
+static inline pm3_cplx_t cmul(pm3_cplx_t a, pm3_cplx_t w) {
+    pm3_cplx_t r = {
+        .re = (a.re * w.re) - (a.im * w.im),
+        .im = (a.re * w.im) + (a.im * w.re),
+    };
+    return r;
+}
+
+static inline void butterfly4(pm3_cplx_t *x, size_t q, pm3_cplx_t w1, pm3_cplx_t w2, pm3_cplx_t w3) {
+
+    const pm3_cplx_t a0 = x[0];
+    const pm3_cplx_t t1 = cmul(x[q], w1);
+    const pm3_cplx_t p = cmul(x[2 * q], w2);
+    const pm3_cplx_t r = cmul(x[3 * q], w3);
+
+    const pm3_cplx_t b0 = { a0.re + t1.re, a0.im + t1.im };
+    const pm3_cplx_t b1 = { a0.re - t1.re, a0.im - t1.im };
+    const pm3_cplx_t u2 = { p.re + r.re, p.im + r.im };
+    // -i * (p - r)
+    const pm3_cplx_t v = { p.im - r.im, r.re - p.re };
+
+    x[0].re = b0.re + u2.re;
+    x[0].im = b0.im + u2.im;
+    x[2 * q].re = b0.re - u2.re;
+    x[2 * q].im = b0.im - u2.im;
+    x[q].re = b1.re + v.re;
+    x[q].im = b1.im + v.im;
+    x[3 * q].re = b1.re - v.re;
+    x[3 * q].im = b1.im - v.im;
+}
+
+void pm3_fft_pass_scalar(pm3_cplx_t *data, size_t n, size_t q, const pm3_cplx_t *tw) {
+
+    const size_t len = 4 * q;
+
+    for (size_t base = 0; base < n; base += len) {
+        for (size_t k = 0; k < q; k++) {
+            butterfly4(&data[base + k], q, tw[k], tw[q + k], tw[(2 * q) + k]);
+        }
+    }
+}
+
+#if defined(PM3_FFT_HAVE_X86)
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+// two interleaved complex numbers per register, re0 im0 re1 im1
+static inline __m256d cmul_avx2(__m256d a, __m256d w) {
+    const __m256d wr = _mm256_movedup_pd(w);
+    const __m256d wi = _mm256_permute_pd(w, 0xF);
+    const __m256d as = _mm256_permute_pd(a, 0x5);
+    return _mm256_addsub_pd(_mm256_mul_pd(a, wr), _mm256_mul_pd(as, wi));
+}
+
+void pm3_fft_pass_avx2(pm3_cplx_t *data, size_t n, size_t q, const pm3_cplx_t *tw) {
+
+    if (q < 2) {
+        pm3_fft_pass_scalar(data, n, q, tw);
+        return;
+    }
+
+    const size_t len = 4 * q;
+    const __m256d neg_im = _mm256_set_pd(-0.0, 0.0, -0.0, 0.0);
+
+    for (size_t base = 0; base < n; base += len) {
+
+        double *x0 = (double *)&data[base];
+        double *x1 = (double *)&data[base + q];
+        double *x2 = (double *)&data[base + (2 * q)];
+        double *x3 = (double *)&data[base + (3 * q)];
+
+        for (size_t k = 0; k < q; k += 2) {
+
+            const __m256d w1 = _mm256_loadu_pd((const double *)&tw[k]);
+            const __m256d w2 = _mm256_loadu_pd((const double *)&tw[q + k]);
+            const __m256d w3 = _mm256_loadu_pd((const double *)&tw[(2 * q) + k]);
+
+            const __m256d a0 = _mm256_loadu_pd(x0 + (2 * k));
+            const __m256d t1 = cmul_avx2(_mm256_loadu_pd(x1 + (2 * k)), w1);
+            const __m256d p = cmul_avx2(_mm256_loadu_pd(x2 + (2 * k)), w2);
+            const __m256d r = cmul_avx2(_mm256_loadu_pd(x3 + (2 * k)), w3);
+
+            const __m256d b0 = _mm256_add_pd(a0, t1);
+            const __m256d b1 = _mm256_sub_pd(a0, t1);
+            const __m256d u2 = _mm256_add_pd(p, r);
+            const __m256d d = _mm256_sub_pd(p, r);
+            const __m256d v = _mm256_xor_pd(_mm256_permute_pd(d, 0x5), neg_im);
+
+            _mm256_storeu_pd(x0 + (2 * k), _mm256_add_pd(b0, u2));
+            _mm256_storeu_pd(x2 + (2 * k), _mm256_sub_pd(b0, u2));
+            _mm256_storeu_pd(x1 + (2 * k), _mm256_add_pd(b1, v));
+            _mm256_storeu_pd(x3 + (2 * k), _mm256_sub_pd(b1, v));
+        }
+    }
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+bool pm3_fft_avx2_supported(void) {
+    static int cached = -1;
+    if (cached < 0) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+        cached = 0;
+#endif
+    }
+    return cached != 0;
+}
+
+#else
+
+void pm3_fft_pass_avx2(pm3_cplx_t *data, size_t n, size_t q, const pm3_cplx_t *tw) {
+    pm3_fft_pass_scalar(data, n, q, tw);
+}
+
+bool pm3_fft_avx2_supported(void) {
+    return false;
+}
+
+#endif
+
+#if defined(PM3_FFT_HAVE_NEON)
+
+// one complex number per register, re im
+static inline float64x2_t cmul_neon(float64x2_t a, float64x2_t w) {
+    const float64x2_t sign = { -1.0, 1.0 };
+    const float64x2_t as = vextq_f64(a, a, 1);
+    const float64x2_t t = vmulq_f64(as, vdupq_laneq_f64(w, 1));
+    return vfmaq_f64(vmulq_f64(a, vdupq_laneq_f64(w, 0)), t, sign);
+}
+
+void pm3_fft_pass_neon(pm3_cplx_t *data, size_t n, size_t q, const pm3_cplx_t *tw) {
+
+    const size_t len = 4 * q;
+    const float64x2_t neg_im = { 1.0, -1.0 };
+
+    for (size_t base = 0; base < n; base += len) {
+
+        double *x0 = (double *)&data[base];
+        double *x1 = (double *)&data[base + q];
+        double *x2 = (double *)&data[base + (2 * q)];
+        double *x3 = (double *)&data[base + (3 * q)];
+
+        for (size_t k = 0; k < q; k++) {
+
+            const float64x2_t w1 = vld1q_f64((const double *)&tw[k]);
+            const float64x2_t w2 = vld1q_f64((const double *)&tw[q + k]);
+            const float64x2_t w3 = vld1q_f64((const double *)&tw[(2 * q) + k]);
+
+            const float64x2_t a0 = vld1q_f64(x0 + (2 * k));
+            const float64x2_t t1 = cmul_neon(vld1q_f64(x1 + (2 * k)), w1);
+            const float64x2_t p = cmul_neon(vld1q_f64(x2 + (2 * k)), w2);
+            const float64x2_t r = cmul_neon(vld1q_f64(x3 + (2 * k)), w3);
+
+            const float64x2_t b0 = vaddq_f64(a0, t1);
+            const float64x2_t b1 = vsubq_f64(a0, t1);
+            const float64x2_t u2 = vaddq_f64(p, r);
+            const float64x2_t d = vsubq_f64(p, r);
+            const float64x2_t v = vmulq_f64(vextq_f64(d, d, 1), neg_im);
+
+            vst1q_f64(x0 + (2 * k), vaddq_f64(b0, u2));
+            vst1q_f64(x2 + (2 * k), vsubq_f64(b0, u2));
+            vst1q_f64(x1 + (2 * k), vaddq_f64(b1, v));
+            vst1q_f64(x3 + (2 * k), vsubq_f64(b1, v));
+        }
+    }
+}
+
+bool pm3_fft_neon_supported(void) {
+    return true;
+}
+
+#else
+
+void pm3_fft_pass_neon(pm3_cplx_t *data, size_t n, size_t q, const pm3_cplx_t *tw) {
+    pm3_fft_pass_scalar(data, n, q, tw);
+}
+
+bool pm3_fft_neon_supported(void) {
+    return false;
+}
+
+#endif
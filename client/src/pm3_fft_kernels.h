@@ -0,0 +1,42 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Radix-4 butterfly passes for pm3_fft, scalar, AVX2 and NEON
+//
+// A pass works on blocks of 4 * q points.  Point k of each quarter is
+// combined with the twiddles w1 = W^2k, w2 = W^k and w3 = W^3k of the block
+// length, stored back to back in tw as q entries each.
+//-----------------------------------------------------------------------------
+
+#ifndef PM3_FFT_KERNELS_H__
+#define PM3_FFT_KERNELS_H__
+
+#include "pm3_dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void pm3_fft_pass_scalar(pm3_cplx_t *data, size_t n, size_t q, const pm3_cplx_t *tw);
+void pm3_fft_pass_avx2(pm3_cplx_t *data, size_t n, size_t q, const pm3_cplx_t *tw);
+void pm3_fft_pass_neon(pm3_cplx_t *data, size_t n, size_t q, const pm3_cplx_t *tw);
+
+bool pm3_fft_avx2_supported(void);
+bool pm3_fft_neon_supported(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
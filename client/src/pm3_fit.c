@@ -21,10 +21,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "pm3_cmd.h"
 #include "commonutil.h"     // ARRAYLEN
 #include "pm3_dsp.h"
+#include "util.h"           // num_CPUs
+#include "util_posix.h"     // usclock
 
 #define PM3_FIT_VAR_FLOOR       0.01
 #define PM3_FIT_MIN_CONTRAST    0.15
@@ -40,6 +43,9 @@
 #define PM3_FIT_CHIP_PAIR       0.90
 #define PM3_FIT_STRUCT_MIN_CLK  16.0
 #define PM3_FIT_STRUCT_TOL      0.25
+// template spectra kept across runs, see tpl_cache_get
+#define PM3_FIT_CACHE_BYTES     (64 * 1024 * 1024)
+#define PM3_FIT_CACHE_ENTRIES   2048
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -176,32 +182,319 @@ static bool build_template(const pm3_hyp_t *hyp, double *tpl, size_t len, int va
     return normalise_energy(tpl, len);
 }
 
-// Correlate the whole trace against a single symbol.
-static int correlate(const pm3_fft_plan_t *plan, const pm3_cplx_t *sig_fft,
-                     const double *tpl, size_t tpl_len, pm3_cplx_t *scratch, double *out) {
+//-----------------------------------------------------------------------------
+// Template spectrum cache
+//
+// A template only depends on its shape, clock, Q and the transform length, so
+// a batch of captures of the same size keeps transforming the same few
+// hundred templates.  Entries are reference counted; one dropped to stay
+// inside the budget while a worker still reads it is freed on release.
+//-----------------------------------------------------------------------------
+typedef struct {
+    pm3_tpl_t tpl;
+    int period;             // subcarrier / tone period of this variant, 0 for none
+    int clk;
+    int q;
+    size_t n;
+    pm3_cplx_t *spec;       // n / 2 + 1 bins, NULL when build_template rejected it
+    int refs;
+    bool dropped;
+} fit_tpl_entry_t;
+
+static struct {
+    pthread_mutex_t lock;
+    fit_tpl_entry_t **items;    // oldest first
+    size_t count;
+    size_t cap;
+    size_t bytes;
+} g_tpl_cache = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static int tpl_period(const pm3_hyp_t *hyp, int variant) {
+    switch (hyp->tpl) {
+        case PM3_TPL_PSK:
+            return hyp->fc;
+        case PM3_TPL_FSK:
+            return (variant == 0) ? hyp->fc_hi : hyp->fc_lo;
+        case PM3_TPL_FLAT:
+        case PM3_TPL_HALF:
+            break;
+    }
+    return 0;
+}
+
+static bool tpl_same(const fit_tpl_entry_t *a, const fit_tpl_entry_t *b) {
+    return a->tpl == b->tpl && a->period == b->period && a->clk == b->clk && a->q == b->q && a->n == b->n;
+}
+
+static size_t tpl_bytes(const fit_tpl_entry_t *e) {
+    return (e->spec != NULL) ? ((e->n / 2) + 1) * sizeof(pm3_cplx_t) : 0;
+}
+
+static void tpl_entry_free(fit_tpl_entry_t *e) {
+    free(e->spec);
+    free(e);
+}
+
+// caller holds the lock
+static void tpl_cache_drop(size_t i) {
+    fit_tpl_entry_t *e = g_tpl_cache.items[i];
+    g_tpl_cache.bytes -= tpl_bytes(e);
+    g_tpl_cache.count--;
+    memmove(&g_tpl_cache.items[i], &g_tpl_cache.items[i + 1], (g_tpl_cache.count - i) * sizeof(fit_tpl_entry_t *));
+    if (e->refs == 0) {
+        tpl_entry_free(e);
+    } else {
+        e->dropped = true;
+    }
+}
+
+// a referenced entry, or NULL on a miss.  Hand it back with tpl_cache_release
+static fit_tpl_entry_t *tpl_cache_get(const fit_tpl_entry_t *key) {
+
+    fit_tpl_entry_t *found = NULL;
+    pthread_mutex_lock(&g_tpl_cache.lock);
+
+    for (size_t i = 0; i < g_tpl_cache.count; i++) {
+        if (tpl_same(g_tpl_cache.items[i], key)) {
+            found = g_tpl_cache.items[i];
+            found->refs++;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&g_tpl_cache.lock);
+    return found;
+}
+
+static void tpl_cache_release(fit_tpl_entry_t *e) {
+
+    pthread_mutex_lock(&g_tpl_cache.lock);
+    const bool gone = (--e->refs == 0) && e->dropped;
+    pthread_mutex_unlock(&g_tpl_cache.lock);
+
+    if (gone) {
+        tpl_entry_free(e);
+    }
+}
+
+// Takes ownership of spec.  Returns the referenced cache entry, which may be
+// one another worker put there first, or NULL when it could not be stored.
+static fit_tpl_entry_t *tpl_cache_put(const fit_tpl_entry_t *key, pm3_cplx_t *spec) {
+
+    fit_tpl_entry_t *e = calloc(1, sizeof(fit_tpl_entry_t));
+    if (e == NULL) {
+        free(spec);
+        return NULL;
+    }
+    *e = *key;
+    e->spec = spec;
+    e->refs = 1;
+
+    const size_t size = tpl_bytes(e);
+
+    pthread_mutex_lock(&g_tpl_cache.lock);
+
+    for (size_t i = 0; i < g_tpl_cache.count; i++) {
+        if (tpl_same(g_tpl_cache.items[i], key)) {
+            fit_tpl_entry_t *other = g_tpl_cache.items[i];
+            other->refs++;
+            pthread_mutex_unlock(&g_tpl_cache.lock);
+            tpl_entry_free(e);
+            return other;
+        }
+    }
+
+    while (g_tpl_cache.count > 0 && (g_tpl_cache.bytes + size > PM3_FIT_CACHE_BYTES || g_tpl_cache.count >= PM3_FIT_CACHE_ENTRIES)) {
+        tpl_cache_drop(0);
+    }
+
+    if (g_tpl_cache.count == g_tpl_cache.cap) {
+        const size_t cap = g_tpl_cache.cap ? g_tpl_cache.cap * 2 : 64;
+        fit_tpl_entry_t **items = realloc(g_tpl_cache.items, cap * sizeof(fit_tpl_entry_t *));
+        if (items == NULL) {
+            // not cached, but still good for the caller
+            e->dropped = true;
+            pthread_mutex_unlock(&g_tpl_cache.lock);
+            return e;
+        }
+        g_tpl_cache.items = items;
+        g_tpl_cache.cap = cap;
+    }
+
+    g_tpl_cache.items[g_tpl_cache.count++] = e;
+    g_tpl_cache.bytes += size;
+
+    pthread_mutex_unlock(&g_tpl_cache.lock);
+    return e;
+}
 
+void pm3_fit_cache_clear(void) {
+    pthread_mutex_lock(&g_tpl_cache.lock);
+    while (g_tpl_cache.count > 0) {
+        tpl_cache_drop(g_tpl_cache.count - 1);
+    }
+    free(g_tpl_cache.items);
+    g_tpl_cache.items = NULL;
+    g_tpl_cache.cap = 0;
+    pthread_mutex_unlock(&g_tpl_cache.lock);
+}
+
+//-----------------------------------------------------------------------------
+// Hypothesis scoring, shared out over worker threads
+//-----------------------------------------------------------------------------
+
+// per worker scratch, one allocation carved up
+typedef struct {
+    void *base;
+    pm3_cplx_t *spec;       // n / 2 + 1, correlation product
+    double *tpl;            // longest clock + 1
+    double *corr;           // n each from here on
+    double *corr_b;
+    double *stat;
+    double *zwork;
+    double *aux;
+    double *sgn;
+    double *agc;
+} fit_arena_t;
+
+typedef struct {
+    const pm3_rfft_plan_t *plan;
+    const pm3_cplx_t *sig_fft;  // n / 2 + 1 bins of the trace
+    size_t len;
+    size_t longest;
+    pm3_hyp_t *list;
+    bool *kept;
+    size_t nhyp;
+    size_t next;                // next unclaimed hypothesis
+    pm3_fit_timing_t *timing;
+} fit_job_t;
+
+static bool fit_arena_init(fit_arena_t *a, size_t n, size_t longest) {
+
+    const size_t nbins = (n / 2) + 1;
+    a->base = calloc(1, (nbins * sizeof(pm3_cplx_t)) + ((longest + 1 + (7 * n)) * sizeof(double)));
+    if (a->base == NULL) {
+        return false;
+    }
+
+    a->spec = (pm3_cplx_t *)a->base;
+    a->tpl = (double *)&a->spec[nbins];
+    a->corr = a->tpl + longest + 1;
+    a->corr_b = a->corr + n;
+    a->stat = a->corr_b + n;
+    a->zwork = a->stat + n;
+    a->aux = a->zwork + n;
+    a->sgn = a->aux + n;
+    a->agc = a->sgn + n;
+    return true;
+}
+
+static void fit_arena_free(fit_arena_t *a) {
+    free(a->base);
+    a->base = NULL;
+}
+
+// Correlate the whole trace against a single symbol.  The template spectrum
+// comes from the cache when it can, the product is conjugated on the fly.
+static bool correlate(const fit_job_t *job, fit_arena_t *a, const pm3_hyp_t *hyp, int variant,
+                      double *out, pm3_fit_timing_t *t) {
+
+    const pm3_rfft_plan_t *plan = job->plan;
     const size_t n = plan->n;
+    const size_t nbins = (n / 2) + 1;
+    const size_t tlen = (size_t)hyp->clk;
+
+    uint64_t t0 = usclock();
+
+    const fit_tpl_entry_t key = {
+        .tpl = hyp->tpl,
+        .period = tpl_period(hyp, variant),
+        .clk = hyp->clk,
+        .q = hyp->q,
+        .n = n,
+    };
+
+    fit_tpl_entry_t *e = tpl_cache_get(&key);
+
+    if (e != NULL) {
+        t->cache_hits++;
+    } else {
+        t->cache_misses++;
+
+        pm3_cplx_t *spec = NULL;
+        if (build_template(hyp, a->tpl, tlen, variant)) {
+            spec = malloc(nbins * sizeof(pm3_cplx_t));
+            if (spec == NULL) {
+                t->tpl_us += usclock() - t0;
+                return false;
+            }
+            // zero padded in out, which is free until the inverse below
+            memset(out, 0, n * sizeof(double));
+            memcpy(out, a->tpl, tlen * sizeof(double));
+            pm3_rfft(plan, out, spec);
+        }
 
-    memset(scratch, 0, n * sizeof(pm3_cplx_t));
-    for (size_t i = 0; i < tpl_len; i++) {
-        scratch[i].re = tpl[i];
+        // a rejected template is remembered as well, as an empty entry
+        e = tpl_cache_put(&key, spec);
+        if (e == NULL) {
+            t->tpl_us += usclock() - t0;
+            return false;
+        }
     }
 
-    pm3_fft(plan, scratch, false);
+    const uint64_t t1 = usclock();
+    t->tpl_us += t1 - t0;
 
-    for (size_t i = 0; i < n; i++) {
-        const double xr = sig_fft[i].re, xi = sig_fft[i].im;
-        const double tr = scratch[i].re, ti = -scratch[i].im;   // conjugate
-        scratch[i].re = (xr * tr) - (xi * ti);
-        scratch[i].im = (xr * ti) + (xi * tr);
+    if (e->spec == NULL) {
+        tpl_cache_release(e);
+        return false;
     }
 
-    pm3_fft(plan, scratch, true);
+    for (size_t i = 0; i < nbins; i++) {
+        const double xr = job->sig_fft[i].re, xi = job->sig_fft[i].im;
+        const double tr = e->spec[i].re, ti = -e->spec[i].im;   // conjugate
+        a->spec[i].re = (xr * tr) - (xi * ti);
+        a->spec[i].im = (xr * ti) + (xi * tr);
+    }
+    tpl_cache_release(e);
+
+    pm3_irfft(plan, a->spec, out);
+
+    t->corr_us += usclock() - t1;
+    return true;
+}
+
+// correlator output of one hypothesis turned into the statistic scored
+static bool fit_statistic(const fit_job_t *job, fit_arena_t *a, const pm3_hyp_t *h, size_t valid, pm3_fit_timing_t *t) {
+
+    if (h->tpl == PM3_TPL_FSK) {
+
+        if (correlate(job, a, h, 0, a->corr, t) == false) {
+            return false;
+        }
+        if (correlate(job, a, h, 1, a->corr_b, t) == false) {
+            return false;
+        }
+
+        for (size_t k = 0; k < valid; k++) {
+            const double d = fabs(a->corr[k]) - fabs(a->corr_b[k]);
+            a->stat[k] = fabs(d);
+            a->aux[k] = fabs(a->corr[k]) + fabs(a->corr_b[k]);
+            a->sgn[k] = d;
+        }
+
+    } else {
 
-    for (size_t i = 0; i < n; i++) {
-        out[i] = scratch[i].re;
+        if (correlate(job, a, h, 0, a->corr, t) == false) {
+            return false;
+        }
+
+        for (size_t k = 0; k < valid; k++) {
+            a->stat[k] = fabs(a->corr[k]);
+            a->sgn[k] = a->corr[k];
+        }
     }
-    return PM3_SUCCESS;
+    return true;
 }
 
 static double eye_mean(const double *work, size_t limit, double clk, double phase, size_t *count) {
@@ -617,6 +910,53 @@ static size_t enumerate(const pm3_fit_opts_t *opts, pm3_hyp_t *list) {
     return n;
 }
 
+static void timing_merge(pm3_fit_timing_t *dst, const pm3_fit_timing_t *src) {
+    __atomic_fetch_add(&dst->tpl_us, src->tpl_us, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&dst->corr_us, src->corr_us, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&dst->score_us, src->score_us, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&dst->cache_hits, src->cache_hits, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&dst->cache_misses, src->cache_misses, __ATOMIC_SEQ_CST);
+}
+
+static void *fit_worker(void *arg) {
+
+    fit_job_t *job = (fit_job_t *)arg;
+    pm3_fit_timing_t t = {0};
+
+    fit_arena_t a;
+    if (fit_arena_init(&a, job->plan->n, job->longest) == false) {
+        return NULL;
+    }
+
+    for (;;) {
+        const size_t i = __atomic_fetch_add(&job->next, 1, __ATOMIC_SEQ_CST);
+        if (i >= job->nhyp) {
+            break;
+        }
+
+        pm3_hyp_t *h = &job->list[i];
+        const size_t tlen = (size_t)h->clk;
+        const size_t valid = (job->len > tlen) ? (job->len - tlen) : 0;
+
+        if (valid < tlen * PM3_FIT_MIN_SYMBOLS) {
+            continue;
+        }
+
+        if (fit_statistic(job, &a, h, valid, &t) == false) {
+            continue;
+        }
+
+        const uint64_t t0 = usclock();
+        const bool is_fsk = (h->tpl == PM3_TPL_FSK);
+        job->kept[i] = score_hypothesis(h, a.stat, is_fsk ? a.aux : NULL, a.sgn, valid, a.zwork, a.agc);
+        t.score_us += usclock() - t0;
+    }
+
+    timing_merge(job->timing, &t);
+    fit_arena_free(&a);
+    return NULL;
+}
+
 int pm3_fit_run(const double *sig, size_t len, const pm3_fit_opts_t *opts, pm3_fit_t *out) {
 
     if (sig == NULL || opts == NULL || out == NULL || len < 64) {
@@ -624,6 +964,7 @@ int pm3_fit_run(const double *sig, size_t len, const pm3_fit_opts_t *opts, pm3_f
     }
 
     memset(out, 0, sizeof(pm3_fit_t));
+    const uint64_t t_start = usclock();
 
     const size_t nhyp = enumerate(opts, NULL);
     if (nhyp == 0) {
@@ -632,119 +973,105 @@ int pm3_fit_run(const double *sig, size_t len, const pm3_fit_opts_t *opts, pm3_f
 
     const size_t longest = (size_t)g_fit_clocks[ARRAYLEN(g_fit_clocks) - 1];
     const size_t n = pm3_next_pow2(len + longest);
-    if (n > PM3_DSP_MAX_FFT) {
+    if (n > PM3_DSP_MAX_FFT || n < len + longest) {
         return PM3_EINVARG;
     }
 
-    pm3_fft_plan_t *plan = pm3_fft_plan_create(n);
-    pm3_cplx_t *sig_fft = calloc(n, sizeof(pm3_cplx_t));
-    pm3_cplx_t *scratch = calloc(n, sizeof(pm3_cplx_t));
-    double *corr = calloc(n, sizeof(double));
-    double *corr_b = calloc(n, sizeof(double));
-    double *stat = calloc(n, sizeof(double));
-    double *zwork = calloc(n, sizeof(double));
-    double *aux = calloc(n, sizeof(double));
-    double *sgn = calloc(n, sizeof(double));
-    double *agcbuf = calloc(n, sizeof(double));
-    double *tpl = calloc(longest + 1, sizeof(double));
+    pm3_rfft_plan_t *plan = pm3_rfft_plan_create(n);
+    pm3_cplx_t *sig_fft = calloc((n / 2) + 1, sizeof(pm3_cplx_t));
+    double *padded = calloc(n, sizeof(double));
     pm3_hyp_t *list = calloc(nhyp, sizeof(pm3_hyp_t));
+    bool *kept_flag = calloc(nhyp, sizeof(bool));
 
-    if (plan == NULL || sig_fft == NULL || scratch == NULL || corr == NULL
-            || corr_b == NULL || stat == NULL || zwork == NULL || aux == NULL || sgn == NULL
-            || agcbuf == NULL || tpl == NULL || list == NULL) {
-        pm3_fft_plan_destroy(plan);
+    if (plan == NULL || sig_fft == NULL || padded == NULL || list == NULL || kept_flag == NULL) {
+        pm3_rfft_plan_destroy(plan);
         free(sig_fft);
-        free(scratch);
-        free(corr);
-        free(corr_b);
-        free(stat);
-        free(zwork);
-        free(aux);
-        free(sgn);
-        free(agcbuf);
-        free(tpl);
+        free(padded);
         free(list);
+        free(kept_flag);
         return PM3_EMALLOC;
     }
 
+    pm3_fit_timing_t *timing = &out->timing;
+
+    uint64_t t0 = usclock();
     pm3_signal_stats(sig, len, &out->stats);
+    timing->stats_us = usclock() - t0;
 
     enumerate(opts, list);
 
     // FFT of the trace
-    for (size_t i = 0; i < len; i++) {
-        sig_fft[i].re = sig[i];
-    }
-    pm3_fft(plan, sig_fft, false);
-
-    size_t kept = 0;
-
-    for (size_t i = 0; i < nhyp; i++) {
-
-        pm3_hyp_t *h = &list[i];
-        const size_t tlen = (size_t)h->clk;
-        const size_t valid = (len > tlen) ? (len - tlen) : 0;
-
-        if (valid < tlen * PM3_FIT_MIN_SYMBOLS) {
-            continue;
+    t0 = usclock();
+    memcpy(padded, sig, len * sizeof(double));
+    pm3_rfft(plan, padded, sig_fft);
+    free(padded);
+    timing->sig_fft_us = usclock() - t0;
+
+    fit_job_t job = {
+        .plan = plan,
+        .sig_fft = sig_fft,
+        .len = len,
+        .longest = longest,
+        .list = list,
+        .kept = kept_flag,
+        .nhyp = nhyp,
+        .timing = timing,
+    };
+
+    int threads = (opts->threads > 0) ? opts->threads : num_CPUs();
+    if ((size_t)threads > nhyp) {
+        threads = (int)nhyp;
+    }
+
+    t0 = usclock();
+
+    int started = 0;
+    pthread_t th[threads];
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&th[i], NULL, fit_worker, &job)) {
+            break;
         }
+        started++;
+    }
 
-        if (h->tpl == PM3_TPL_FSK) {
-
-            if (build_template(h, tpl, tlen, 0) == false) {
-                continue;
-            }
-            correlate(plan, sig_fft, tpl, tlen, scratch, corr);
-
-            if (build_template(h, tpl, tlen, 1) == false) {
-                continue;
-            }
-            correlate(plan, sig_fft, tpl, tlen, scratch, corr_b);
+    // the calling thread scores its share as well
+    fit_worker(&job);
 
-            for (size_t k = 0; k < valid; k++) {
-                const double d = fabs(corr[k]) - fabs(corr_b[k]);
-                stat[k] = fabs(d);
-                aux[k] = fabs(corr[k]) + fabs(corr_b[k]);
-                sgn[k] = d;
-            }
+    for (int i = 0; i < started; i++) {
+        pthread_join(th[i], NULL);
+    }
 
-        } else {
+    timing->threads = started + 1;
+    timing->bank_us = usclock() - t0;
 
-            if (build_template(h, tpl, tlen, 0) == false) {
-                continue;
-            }
-            correlate(plan, sig_fft, tpl, tlen, scratch, corr);
-
-            for (size_t k = 0; k < valid; k++) {
-                stat[k] = fabs(corr[k]);
-                sgn[k] = corr[k];
-            }
-        }
+    // every worker ran out of memory before it could claim anything
+    if (job.next < nhyp) {
+        pm3_rfft_plan_destroy(plan);
+        free(sig_fft);
+        free(list);
+        free(kept_flag);
+        return PM3_EMALLOC;
+    }
 
-        const bool is_fsk = (h->tpl == PM3_TPL_FSK);
-        if (score_hypothesis(h, stat, is_fsk ? aux : NULL, sgn, valid, zwork, agcbuf) == false) {
-            continue;
+    // compact in bank order, so the ranking does not depend on which worker
+    // finished first
+    size_t kept = 0;
+    for (size_t i = 0; i < nhyp; i++) {
+        if (kept_flag[i]) {
+            list[kept++] = list[i];
         }
-
-        list[kept++] = *h;
     }
+    free(kept_flag);
 
     if (kept == 0) {
-        pm3_fft_plan_destroy(plan);
+        pm3_rfft_plan_destroy(plan);
         free(sig_fft);
-        free(scratch);
-        free(corr);
-        free(corr_b);
-        free(stat);
-        free(zwork);
-        free(aux);
-        free(sgn);
-        free(agcbuf);
-        free(tpl);
         free(list);
         return PM3_ESOFT;
     }
 
+    t0 = usclock();
+
     qsort(list, kept, sizeof(pm3_hyp_t), cmp_hyp);
 
     // Octave correction.
@@ -838,50 +1165,34 @@ int pm3_fit_run(const double *sig, size_t len, const pm3_fit_opts_t *opts, pm3_f
         }
     }
 
+    timing->rank_us = usclock() - t0;
+
     if (opts->keep_corr) {
 
         const pm3_hyp_t *best = &list[0];
-        const size_t tlen = (size_t)best->clk;
-        const size_t valid = len - tlen;
-
-        if (best->tpl == PM3_TPL_FSK) {
-            build_template(best, tpl, tlen, 0);
-            correlate(plan, sig_fft, tpl, tlen, scratch, corr);
-            build_template(best, tpl, tlen, 1);
-            correlate(plan, sig_fft, tpl, tlen, scratch, corr_b);
-            for (size_t k = 0; k < valid; k++) {
-                stat[k] = fabs(fabs(corr[k]) - fabs(corr_b[k]));
-            }
-        } else {
-            build_template(best, tpl, tlen, 0);
-            correlate(plan, sig_fft, tpl, tlen, scratch, corr);
-            for (size_t k = 0; k < valid; k++) {
-                stat[k] = fabs(corr[k]);
-                sgn[k] = corr[k];
+        const size_t valid = len - (size_t)best->clk;
+
+        fit_arena_t a;
+        if (fit_arena_init(&a, n, longest)) {
+            pm3_fit_timing_t t = {0};
+            if (fit_statistic(&job, &a, best, valid, &t)) {
+                out->corr = calloc(valid, sizeof(double));
+                if (out->corr != NULL) {
+                    memcpy(out->corr, a.stat, valid * sizeof(double));
+                    out->corr_len = valid;
+                }
             }
-        }
-
-        out->corr = calloc(valid, sizeof(double));
-        if (out->corr != NULL) {
-            memcpy(out->corr, stat, valid * sizeof(double));
-            out->corr_len = valid;
+            fit_arena_free(&a);
         }
     }
 
     out->items = list;
     out->count = kept;
 
-    pm3_fft_plan_destroy(plan);
+    pm3_rfft_plan_destroy(plan);
     free(sig_fft);
-    free(scratch);
-    free(corr);
-    free(corr_b);
-    free(stat);
-    free(zwork);
-    free(aux);
-    free(sgn);
-    free(agcbuf);
-    free(tpl);
+
+    timing->total_us = usclock() - t_start;
     return PM3_SUCCESS;
 }
 
@@ -76,8 +76,26 @@ typedef struct {
     int mod_mask;           // bitmask of (1 << pm3_mod_t), 0 means all
     int clk_only;           // restrict to this clock, 0 means all candidates
     bool keep_corr;         // hand back the rank 1 correlator output
+    int threads;            // scoring threads, 0 means one per CPU
 } pm3_fit_opts_t;
 
+// Where pm3_fit_run spent its time, microseconds.  The template, correlation
+// and scoring figures are summed over all workers, so with more than one
+// thread they add up to more than bank_us.
+typedef struct {
+    uint64_t total_us;
+    uint64_t stats_us;      // run length and autocorrelation statistics
+    uint64_t sig_fft_us;    // transform of the trace
+    uint64_t bank_us;       // wall clock of the threaded part
+    uint64_t tpl_us;        // template build and transform, or cache copy
+    uint64_t corr_us;       // spectrum product and inverse transform
+    uint64_t score_us;      // timing recovery and decision statistics
+    uint64_t rank_us;       // sort, octave and structural corrections
+    uint32_t cache_hits;    // template spectra found in the cache
+    uint32_t cache_misses;
+    int threads;
+} pm3_fit_timing_t;
+
 typedef struct {
     pm3_hyp_t *items;       // ranked, best first
     size_t count;
@@ -85,6 +103,7 @@ typedef struct {
     bool promoted;          // rank 1 was chosen on structural evidence rather
     double *corr;           // rank 1 decision statistic, when requested
     size_t corr_len;
+    pm3_fit_timing_t timing;
 } pm3_fit_t;
 
 const char *pm3_mod_name(pm3_mod_t mod);
@@ -93,6 +112,9 @@ const char *pm3_enc_name(pm3_enc_t enc);
 size_t pm3_fit_clocks(const int **clocks);
 int pm3_fit_run(const double *sig, size_t len, const pm3_fit_opts_t *opts, pm3_fit_t *out);
 void pm3_fit_free(pm3_fit_t *fit);
+// drop every template spectrum kept between runs, callers do it once their
+// command is done with pm3_fit_run
+void pm3_fit_cache_clear(void);
 
 typedef struct {
     pm3_mod_t mod;
@@ -51,6 +51,7 @@ const static vocabulary_t vocabulary[] = {
     { 1, "prefs get emoji" },
     { 1, "prefs get hints" },
     { 1, "prefs get output" },
+    { 1, "prefs get perf" },
     { 1, "prefs get plotsliders" },
     { 1, "prefs get mqtt" },
     { 1, "prefs set help" },
@@ -64,11 +65,14 @@ const static vocabulary_t vocabulary[] = {
     { 1, "prefs set hints" },
     { 1, "prefs set savepaths" },
     { 1, "prefs set output" },
+    { 1, "prefs set perf" },
     { 1, "prefs set plotsliders" },
     { 1, "prefs set mqtt" },
     { 1, "analyse help" },
+    { 1, "analyse bench" },
     { 1, "analyse lrc" },
     { 1, "analyse crc" },
+    { 1, "analyse crcsearch" },
     { 1, "analyse chksum" },
     { 1, "analyse dates" },
     { 1, "analyse lfsr" },
@@ -77,6 +81,7 @@ const static vocabulary_t vocabulary[] = {
     { 1, "analyse demodbuff" },
     { 1, "analyse freq" },
     { 1, "analyse foo" },
+    { 1, "analyse roca" },
     { 1, "analyse regex" },
     { 1, "analyse units" },
     { 1, "data help" },
@@ -134,6 +139,7 @@ const static vocabulary_t vocabulary[] = {
     { 0, "data test_ss32s" },
     { 1, "emv help" },
     { 1, "emv list" },
+    { 1, "emv oda" },
     { 1, "emv test" },
     { 0, "emv challenge" },
     { 0, "emv exec" },
@@ -431,6 +437,7 @@ const static vocabulary_t vocabulary[] = {
     { 0, "hf mf nack" },
     { 0, "hf mf chk" },
     { 0, "hf mf fchk" },
+    { 1, "hf mf keystats" },
     { 1, "hf mf decrypt" },
     { 0, "hf mf supercard" },
     { 1, "hf mf keygen" },
@@ -670,6 +677,7 @@ const static vocabulary_t vocabulary[] = {
     { 0, "hf xerox rdbl" },
     { 1, "hw help" },
     { 0, "hw detectreader" },
+    { 1, "hw perf" },
     { 0, "hw status" },
     { 0, "hw tearoff" },
     { 1, "hw timeout" },
@@ -698,6 +706,7 @@ const static vocabulary_t vocabulary[] = {
     { 1, "lf help" },
     { 0, "lf config" },
     { 0, "lf cmdread" },
+    { 1, "lf monitor" },
     { 0, "lf read" },
     { 0, "lf relay" },
     { 1, "lf search" },
@@ -811,6 +820,7 @@ const static vocabulary_t vocabulary[] = {
     { 0, "lf hitag sim" },
     { 0, "lf hitag cc" },
     { 0, "lf hitag crack2" },
+    { 1, "lf hitag crack5" },
     { 0, "lf hitag chk" },
     { 1, "lf hitag lookup" },
     { 0, "lf hitag ta" },
@@ -926,7 +936,7 @@ const static vocabulary_t vocabulary[] = {
     { 0, "lf t55xx wakeup" },
     { 1, "lf t55xx view" },
     { 0, "lf t55xx write" },
-    { 0, "lf t55xx bruteforce" },
+    { 1, "lf t55xx bruteforce" },
     { 0, "lf t55xx chk" },
     { 0, "lf t55xx protect" },
     { 0, "lf t55xx recoverpw" },
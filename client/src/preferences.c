@@ -35,6 +35,7 @@
 #include "cmdparser.h"
 #include "cliparser.h"
 #include "uart/uart.h" // uart_reconfigure_timeouts
+#include "perf.h"
 
 static int CmdHelp(const char *Cmd);
 static int setCmdHelp(const char *Cmd);
@@ -258,6 +259,8 @@ void preferences_save_callback(json_t *root) {
 
     JsonSaveBoolean(root, "show.hints", g_session.show_hints);
 
+    JsonSaveBoolean(root, "client.perf", g_perf_enabled);
+
     JsonSaveBoolean(root, "output.dense", g_session.dense_output);
 
     JsonSaveBoolean(root, "os.supports.colors", g_session.supports_colors);
@@ -407,6 +410,9 @@ void preferences_load_callback(json_t *root) {
     if (json_unpack_ex(root, &up_error, 0, "{s:b}", "show.hints", &b1) == 0)
         g_session.show_hints = (bool)b1;
 
+    if (json_unpack_ex(root, &up_error, 0, "{s:b}", "client.perf", &b1) == 0)
+        perf_set_enabled((bool)b1);
+
     if (json_unpack_ex(root, &up_error, 0, "{s:b}", "output.dense", &b1) == 0)
         g_session.dense_output = (bool)b1;
 
@@ -638,6 +644,13 @@ static void showHintsState(prefShowOpt_t opt) {
                  );
 }
 
+static void showPerfState(prefShowOpt_t opt) {
+    PrintAndLogEx(INFO, "   %s perf counters........... %s"
+                  , pref_show_status_msg(opt)
+                  , (g_perf_enabled) ? pref_show_value(opt, "on") : pref_show_value(opt, "off")
+                 );
+}
+
 static void showPlotSliderState(prefShowOpt_t opt) {
     PrintAndLogEx(INFO, "   %s show plot sliders....... %s"
                   , pref_show_status_msg(opt)
@@ -1169,6 +1182,50 @@ static int setCmdHint(const char *Cmd) {
     return PM3_SUCCESS;
 }
 
+static int setCmdPerf(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "prefs set perf",
+                  "Set persistent preference of collecting client performance counters.\n"
+                  "Use `hw perf` to show them",
+                  "prefs set perf --on"
+                 );
+
+    void *argtable[] = {
+        arg_param_begin,
+        arg_lit0(NULL, "off", "don't collect counters"),
+        arg_lit0(NULL, "on", "collect counters"),
+        arg_param_end
+    };
+    CLIExecWithReturn(ctx, Cmd, argtable, true);
+    bool use_off = arg_get_lit(ctx, 1);
+    bool use_on = arg_get_lit(ctx, 2);
+    CLIParserFree(ctx);
+
+    if ((use_off + use_on) > 1) {
+        PrintAndLogEx(FAILED, "Can only set one option");
+        return PM3_EINVARG;
+    }
+
+    bool new_value = g_perf_enabled;
+    if (use_off) {
+        new_value = false;
+    }
+    if (use_on) {
+        new_value = true;
+    }
+
+    if (g_perf_enabled != new_value) {
+        showPerfState(prefShowOLD);
+        perf_set_enabled(new_value);
+        showPerfState(prefShowNEW);
+        preferences_save();
+    } else {
+        showPerfState(prefShowNone);
+    }
+
+    return PM3_SUCCESS;
+}
+
 static int setCmdPlotSliders(const char *Cmd) {
     CLIParserContext *ctx;
     CLIParserInit(&ctx, "prefs set plotsliders",
@@ -1445,6 +1502,22 @@ static int getCmdHint(const char *Cmd) {
     return PM3_SUCCESS;
 }
 
+static int getCmdPerf(const char *Cmd) {
+    CLIParserContext *ctx;
+    CLIParserInit(&ctx, "prefs get perf",
+                  "Get preference of collecting client performance counters",
+                  "prefs get perf"
+                 );
+    void *argtable[] = {
+        arg_param_begin,
+        arg_param_end
+    };
+    CLIExecWithReturn(ctx, Cmd, argtable, true);
+    CLIParserFree(ctx);
+    showPerfState(prefShowNone);
+    return PM3_SUCCESS;
+}
+
 static int getCmdColor(const char *Cmd) {
     CLIParserContext *ctx;
     CLIParserInit(&ctx, "prefs get color",
@@ -1621,6 +1694,7 @@ static command_t CommandTableGet[] = {
     {"emoji",            getCmdEmoji,         AlwaysAvailable, "Get emoji display preference"},
     {"hints",            getCmdHint,          AlwaysAvailable, "Get hint display preference"},
     {"output",           getCmdOutput,        AlwaysAvailable, "Get dump output style preference"},
+    {"perf",             getCmdPerf,          AlwaysAvailable, "Get performance counters preference"},
     {"plotsliders",      getCmdPlotSlider,    AlwaysAvailable, "Get plot slider display preference"},
     {"mqtt",             getCmdMqtt,          AlwaysAvailable, "Get MQTT preference"},
     {NULL, NULL, NULL, NULL}
@@ -1640,6 +1714,7 @@ static command_t CommandTableSet[] = {
     {"savepaths",        setCmdSavePaths,     AlwaysAvailable, "... to be adjusted next ... "},
     //  {"devicedebug",      setCmdDeviceDebug,   AlwaysAvailable, "Set device debug level"},
     {"output",           setCmdOutput,        AlwaysAvailable, "Set dump output style"},
+    {"perf",             setCmdPerf,          AlwaysAvailable, "Set performance counters collection"},
     {"plotsliders",      setCmdPlotSliders,   AlwaysAvailable, "Set plot slider display"},
     {"mqtt",             setCmdMqtt,          AlwaysAvailable, "Set MQTT default values"},
     {NULL, NULL, NULL, NULL}
@@ -1701,6 +1776,7 @@ static int CmdPrefShow(const char *Cmd) {
     showSavePathState(spTrace, prefShowNone);
     showClientDebugState(prefShowNone);
     showPlotSliderState(prefShowNone);
+    showPerfState(prefShowNone);
 //    showDeviceDebugState(prefShowNone);
     showBarModeState(prefShowNone);
     showClientExeDelayState();
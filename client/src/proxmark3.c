@@ -33,6 +33,8 @@
 #include "whereami.h"
 #include "comms.h"
 #include "fileutils.h"
+#include "rescache.h"
+#include "emv/emv_pk.h"
 #include "flash.h"
 #include "preferences.h"
 #include "commonutil.h"
@@ -1554,6 +1556,8 @@ int main(int argc, char *argv[]) {
     }
 
     free_grabber();
+    rescache_free();
+    emv_pk_free_ca_cache();
 
     return mainret;
 }
@@ -0,0 +1,289 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Session wide cache of the JSON resource files
+//-----------------------------------------------------------------------------
+
+#include "rescache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "fileutils.h"
+#include "ui.h"
+
+#define RESCACHE_MAX_INDEXES 4
+
+typedef struct {
+    const char *key;
+    size_t pos;             // position in the array, keeps duplicates in file order
+    json_t *elm;
+} rescache_key_t;
+
+typedef struct {
+    char *field;
+    rescache_key_t *keys;
+    size_t count;
+} rescache_index_t;
+
+typedef struct {
+    char *name;
+    char *suffix;
+    char *path;
+    time_t mtime;
+    off_t size;
+    json_t *root;
+    rescache_index_t indexes[RESCACHE_MAX_INDEXES];
+    size_t nindexes;
+} rescache_entry_t;
+
+static pthread_mutex_t rescache_lock = PTHREAD_MUTEX_INITIALIZER;
+static rescache_entry_t *rescache_entries = NULL;
+static size_t rescache_count = 0;
+
+static bool file_stamp(const char *path, time_t *mtime, off_t *size) {
+#ifdef _WIN32
+    struct _stat st;
+    if (_stat(path, &st) != 0) {
+        return false;
+    }
+#else
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+#endif
+    *mtime = st.st_mtime;
+    *size = st.st_size;
+    return true;
+}
+
+static void entry_drop(rescache_entry_t *e) {
+    for (size_t i = 0; i < e->nindexes; i++) {
+        free(e->indexes[i].field);
+        free(e->indexes[i].keys);
+    }
+    e->nindexes = 0;
+    json_decref(e->root);
+    e->root = NULL;
+    free(e->path);
+    e->path = NULL;
+}
+
+static rescache_entry_t *entry_get(const char *name, const char *suffix) {
+    for (size_t i = 0; i < rescache_count; i++) {
+        rescache_entry_t *e = &rescache_entries[i];
+        if (strcmp(e->name, name) == 0 && strcmp(e->suffix, suffix) == 0) {
+            return e;
+        }
+    }
+
+    rescache_entry_t *tmp = realloc(rescache_entries, (rescache_count + 1) * sizeof(rescache_entry_t));
+    if (tmp == NULL) {
+        return NULL;
+    }
+    rescache_entries = tmp;
+
+    rescache_entry_t *e = &rescache_entries[rescache_count];
+    memset(e, 0, sizeof(rescache_entry_t));
+    e->name = strdup(name);
+    e->suffix = strdup(suffix);
+    if (e->name == NULL || e->suffix == NULL) {
+        free(e->name);
+        free(e->suffix);
+        return NULL;
+    }
+    rescache_count++;
+    return e;
+}
+
+json_t *rescache_json_load(const char *name, const char *suffix, bool silent) {
+    if (name == NULL) {
+        return NULL;
+    }
+    if (suffix == NULL) {
+        suffix = "";
+    }
+
+    json_t *root = NULL;
+    pthread_mutex_lock(&rescache_lock);
+
+    rescache_entry_t *e = entry_get(name, suffix);
+    if (e == NULL) {
+        goto out;
+    }
+
+    // still the file we parsed?
+    time_t mtime = 0;
+    off_t size = 0;
+    if (e->root && file_stamp(e->path, &mtime, &size) && mtime == e->mtime && size == e->size) {
+        root = json_incref(e->root);
+        goto out;
+    }
+    entry_drop(e);
+
+    if (searchFile(&e->path, RESOURCES_SUBDIR, name, suffix, silent) != PM3_SUCCESS) {
+        e->path = NULL;
+        goto out;
+    }
+    if (file_stamp(e->path, &e->mtime, &e->size) == false) {
+        goto out;
+    }
+
+    json_error_t error;
+    e->root = json_load_file(e->path, 0, &error);
+    if (e->root == NULL) {
+        PrintAndLogEx(ERR, "json (%s) error on line %d: %s", e->path, error.line, error.text);
+        goto out;
+    }
+    PrintAndLogEx(DEBUG, "Cached resource " _YELLOW_("%s"), e->path);
+    root = json_incref(e->root);
+
+out:
+    pthread_mutex_unlock(&rescache_lock);
+    return root;
+}
+
+static int key_cmp(const void *a, const void *b) {
+    const rescache_key_t *ka = (const rescache_key_t *)a;
+    const rescache_key_t *kb = (const rescache_key_t *)b;
+    int res = strcasecmp(ka->key, kb->key);
+    if (res) {
+        return res;
+    }
+    return (ka->pos > kb->pos) - (ka->pos < kb->pos);
+}
+
+static rescache_index_t *index_get(rescache_entry_t *e, const char *field) {
+    for (size_t i = 0; i < e->nindexes; i++) {
+        if (strcmp(e->indexes[i].field, field) == 0) {
+            return &e->indexes[i];
+        }
+    }
+    if (e->nindexes == RESCACHE_MAX_INDEXES) {
+        return NULL;
+    }
+
+    size_t n = json_array_size(e->root);
+    rescache_index_t *idx = &e->indexes[e->nindexes];
+    idx->keys = calloc(n ? n : 1, sizeof(rescache_key_t));
+    idx->field = strdup(field);
+    if (idx->keys == NULL || idx->field == NULL) {
+        free(idx->keys);
+        free(idx->field);
+        return NULL;
+    }
+
+    idx->count = 0;
+    for (size_t i = 0; i < n; i++) {
+        json_t *elm = json_array_get(e->root, i);
+        const char *key = json_string_value(json_object_get(elm, field));
+        if (key == NULL) {
+            continue;
+        }
+        idx->keys[idx->count++] = (rescache_key_t) { .key = key, .pos = i, .elm = elm };
+    }
+    qsort(idx->keys, idx->count, sizeof(rescache_key_t), key_cmp);
+    e->nindexes++;
+    return idx;
+}
+
+bool rescache_json_path(json_t *root, char *path, size_t len) {
+    if (path == NULL || len == 0) {
+        return false;
+    }
+    path[0] = '\0';
+
+    bool found = false;
+    pthread_mutex_lock(&rescache_lock);
+    for (size_t i = 0; i < rescache_count; i++) {
+        if (root && rescache_entries[i].root == root && rescache_entries[i].path) {
+            snprintf(path, len, "%s", rescache_entries[i].path);
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&rescache_lock);
+    return found;
+}
+
+// roots not (or no longer) in the cache are searched the slow way
+static json_t *find_linear(json_t *root, const char *field, const char *key, size_t nth) {
+    for (size_t i = 0; i < json_array_size(root); i++) {
+        json_t *elm = json_array_get(root, i);
+        const char *k = json_string_value(json_object_get(elm, field));
+        if (k && strcasecmp(k, key) == 0 && nth-- == 0) {
+            return elm;
+        }
+    }
+    return NULL;
+}
+
+json_t *rescache_json_find(json_t *root, const char *field, const char *key, size_t nth) {
+    if (json_is_array(root) == false || field == NULL || key == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&rescache_lock);
+
+    rescache_index_t *idx = NULL;
+    for (size_t i = 0; i < rescache_count; i++) {
+        if (rescache_entries[i].root == root) {
+            idx = index_get(&rescache_entries[i], field);
+            break;
+        }
+    }
+
+    json_t *res = NULL;
+    if (idx == NULL) {
+        res = find_linear(root, field, key, nth);
+        goto out;
+    }
+
+    // first key not below the searched one
+    size_t lo = 0, hi = idx->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strcasecmp(idx->keys[mid].key, key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    lo += nth;
+    if (lo < idx->count && strcasecmp(idx->keys[lo].key, key) == 0) {
+        res = idx->keys[lo].elm;
+    }
+
+out:
+    pthread_mutex_unlock(&rescache_lock);
+    return res;
+}
+
+void rescache_free(void) {
+    pthread_mutex_lock(&rescache_lock);
+    for (size_t i = 0; i < rescache_count; i++) {
+        entry_drop(&rescache_entries[i]);
+        free(rescache_entries[i].name);
+        free(rescache_entries[i].suffix);
+    }
+    free(rescache_entries);
+    rescache_entries = NULL;
+    rescache_count = 0;
+    pthread_mutex_unlock(&rescache_lock);
+}
@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Session wide cache of the JSON resource files
+//
+// A resource is parsed the first time it is asked for and kept for the rest
+// of the session.  It is parsed again when its file changes on disk.  Array
+// resources get a sorted index per looked up member, built on first use.
+//-----------------------------------------------------------------------------
+
+#ifndef RESCACHE_H__
+#define RESCACHE_H__
+
+#include "common.h"
+#include "jansson.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// parsed resource, searched for like searchFile(RESOURCES_SUBDIR, name, suffix).
+// Returns a new reference, release it with json_decref().  NULL when the file
+// is missing or not valid JSON
+json_t *rescache_json_load(const char *name, const char *suffix, bool silent);
+
+// file a root from rescache_json_load() was parsed from, copied into path.
+// false, and path set to "", when the root is not (or no longer) cached
+bool rescache_json_path(json_t *root, char *path, size_t len);
+
+// element of an array resource whose string member `field` equals `key`,
+// ignoring case.  nth picks among several matches, in file order.
+// root must come from rescache_json_load(), the element is borrowed from it
+json_t *rescache_json_find(json_t *root, const char *field, const char *key, size_t nth);
+
+// drop every cached resource, references still held stay valid
+void rescache_free(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
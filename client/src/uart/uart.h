@@ -62,6 +62,16 @@ void uart_close(const serial_port sp);
  */
 int uart_receive(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uint32_t *pszRxLen);
 
+/* Same as uart_receive(), but returns PM3_ENODATA early when uart_wakeup()
+ * is called before any byte arrived.  Only use it where a frame starts.
+ */
+int uart_receive_wakeable(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uint32_t *pszRxLen);
+
+/* Wakes up a pending uart_receive_wakeable(), so a queued command does not
+ * wait for the receive timeout.  Safe to call from any thread.
+ */
+void uart_wakeup(void);
+
 /* Sends a buffer to a given serial port.
  *   pbtTx: A pointer to a buffer containing the data to send.
  *   len: The amount of data to be sent.
@@ -68,6 +68,9 @@ struct timeval timeout = {
     .tv_usec = UART_FPC_CLIENT_RX_TIMEOUT_MS * 1000
 };
 
+// self pipe waking up uart_receive_wakeable(), shared by all ports
+static int wakeup_pipe[2] = {-1, -1};
+
 static uint32_t newtimeout_value = 0;
 static bool newtimeout_pending = false;
 static uint8_t rx_empty_counter = 0;
@@ -92,6 +95,15 @@ serial_port uart_open(const char *pcPortName, uint32_t speed, bool slient) {
 
     sp->udpBuffer = NULL;
     rx_empty_counter = 0;
+
+    if (wakeup_pipe[0] < 0) {
+        if (pipe(wakeup_pipe) == 0) {
+            fcntl(wakeup_pipe[0], F_SETFL, fcntl(wakeup_pipe[0], F_GETFL) | O_NONBLOCK);
+            fcntl(wakeup_pipe[1], F_SETFL, fcntl(wakeup_pipe[1], F_GETFL) | O_NONBLOCK);
+        } else {
+            wakeup_pipe[0] = wakeup_pipe[1] = -1;
+        }
+    }
     // init timeouts
     timeout.tv_usec = UART_FPC_CLIENT_RX_TIMEOUT_MS * 1000;
     g_conn.send_via_local_ip = false;
@@ -471,7 +483,17 @@ void uart_close(const serial_port sp) {
     free(sp);
 }
 
-int uart_receive(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uint32_t *pszRxLen) {
+void uart_wakeup(void) {
+    if (wakeup_pipe[1] >= 0) {
+        uint8_t b = 0;
+        // a full pipe means a wake up is pending already
+        if (write(wakeup_pipe[1], &b, sizeof(b)) < 0) {
+            return;
+        }
+    }
+}
+
+static int uart_receive_internal(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uint32_t *pszRxLen, bool wakeable) {
     uint32_t byteCount;  // FIONREAD returns size on 32b
     fd_set rfds;
     struct timeval tv;
@@ -506,14 +528,32 @@ int uart_receive(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uin
         // Reset file descriptor
         FD_ZERO(&rfds);
         FD_SET(spu->fd, &rfds);
+        int nfds = spu->fd + 1;
+
+        // only wake up before the first byte, never in the middle of a frame
+        bool wake = wakeable && (*pszRxLen == 0) && (wakeup_pipe[0] >= 0);
+        if (wake) {
+            FD_SET(wakeup_pipe[0], &rfds);
+            nfds = MAX(nfds, wakeup_pipe[0] + 1);
+        }
+
         tv = timeout;
-        res = select(spu->fd + 1, &rfds, NULL, NULL, &tv);
+        res = select(nfds, &rfds, NULL, NULL, &tv);
 
         // Read error
         if (res < 0) {
             return PM3_EIO;
         }
 
+        if (wake && (res > 0) && FD_ISSET(wakeup_pipe[0], &rfds)) {
+            uint8_t drain[16];
+            while (read(wakeup_pipe[0], drain, sizeof(drain)) > 0) {}
+
+            if (FD_ISSET(spu->fd, &rfds) == false) {
+                return PM3_ENODATA;
+            }
+        }
+
         // Read time-out
         if (res == 0) {
             if (*pszRxLen == 0) {
@@ -590,6 +630,14 @@ int uart_receive(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uin
     return PM3_SUCCESS;
 }
 
+int uart_receive(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uint32_t *pszRxLen) {
+    return uart_receive_internal(sp, pbtRx, pszMaxRxLen, pszRxLen, false);
+}
+
+int uart_receive_wakeable(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uint32_t *pszRxLen) {
+    return uart_receive_internal(sp, pbtRx, pszMaxRxLen, pszRxLen, true);
+}
+
 int uart_send(const serial_port sp, const uint8_t *pbtTx, const uint32_t len) {
     uint32_t pos = 0;
     fd_set rfds;
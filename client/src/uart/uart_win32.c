@@ -503,6 +503,14 @@ int uart_receive(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uin
     }
 }
 
+// ReadFile / select timeouts are short enough, no wake up on Windows
+int uart_receive_wakeable(const serial_port sp, uint8_t *pbtRx, uint32_t pszMaxRxLen, uint32_t *pszRxLen) {
+    return uart_receive(sp, pbtRx, pszMaxRxLen, pszRxLen);
+}
+
+void uart_wakeup(void) {
+}
+
 int uart_send(const serial_port sp, const uint8_t *p_tx, const uint32_t len) {
     const serial_port_windows_t *spw = (serial_port_windows_t *)sp;
     if (spw->hSocket == INVALID_SOCKET) { // serial port
@@ -37,6 +37,7 @@
 #include "proxmark3.h"  // PROXLOG
 #include "fileutils.h"
 #include "pm3_cmd.h"
+#include "perf.h"
 
 #ifdef _WIN32
 # include <direct.h>    // _mkdir
@@ -282,6 +283,8 @@ void PrintAndLogEx(logLevel_t level, const char *fmt, ...) {
         return;
     }
 
+    uint64_t perf_t0 = perf_start();
+
     char prefix[40] = {0};
     char buffer[MAX_PRINT_BUFFER] = {0};
     char buffer2[MAX_PRINT_BUFFER + sizeof(prefix)] = {0};
@@ -355,6 +358,7 @@ void PrintAndLogEx(logLevel_t level, const char *fmt, ...) {
     // no prefixes for normal & inplace
     if (level == NORMAL) {
         fPrintAndLog(stream, "%s", buffer);
+        perf_stop(PERF_PRINT, perf_t0);
         return;
     }
 
@@ -402,6 +406,7 @@ void PrintAndLogEx(logLevel_t level, const char *fmt, ...) {
             fPrintAndLog(stream, "%s", buffer2);
         }
     }
+    perf_stop(PERF_PRINT, perf_t0);
 }
 
 static void fPrintAndLog(FILE *stream, const char *fmt, ...) {
@@ -0,0 +1,17 @@
+#include "common.h"
+/* Generated file, do not edit */
+#ifndef ON_DEVICE
+#define SECTVERSINFO
+#else
+#define SECTVERSINFO __attribute__((section(".version_information")))
+#endif
+
+const struct version_information_t SECTVERSINFO g_version_information = {
+    VERSION_INFORMATION_MAGIC,
+    1,
+    1,
+    2,
+    "Iceman/master/095820d",
+    "2026-10-19 04:31:40",
+    "57abd597e"
+};
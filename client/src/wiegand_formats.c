@@ -1746,6 +1746,27 @@ bool HIDTryUnpack(wiegand_message_t *packed) {
     return ((found_cnt - found_invalid_par) > 0);
 }
 
+int HIDFindUnpack(wiegand_message_t *packed, wiegand_card_t *card) {
+    int found = -1;
+    for (int i = 0; FormatTable[i].Name; i++) {
+        wiegand_card_t c;
+        memset(&c, 0, sizeof(wiegand_card_t));
+        if (FormatTable[i].Unpack(packed, &c) == false) {
+            continue;
+        }
+        // a format whose parity checks out beats one without
+        bool valid = (FormatTable[i].Fields.hasParity == false) || c.ParityValid;
+        if (found < 0 || valid) {
+            found = i;
+            *card = c;
+        }
+        if (valid) {
+            break;
+        }
+    }
+    return found;
+}
+
 void HIDUnpack(int idx, wiegand_message_t *packed) {
     wiegand_card_t card;
     memset(&card, 0, sizeof(wiegand_card_t));
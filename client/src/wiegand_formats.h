@@ -58,6 +58,8 @@ int HIDFindCardFormat(const char *format);
 cardformat_t HIDGetCardFormat(int idx);
 bool HIDPack(int format_idx, wiegand_card_t *card, wiegand_message_t *packed, bool preamble);
 bool HIDTryUnpack(wiegand_message_t *packed);
+// first format that unpacks it, preferring valid parity, without printing. -1 when none
+int HIDFindUnpack(wiegand_message_t *packed, wiegand_card_t *card);
 void HIDPackTryAll(wiegand_card_t *card, bool preamble);
 void HIDUnpack(int idx, wiegand_message_t *packed);
 bool decode_wiegand(uint32_t top, uint32_t mid, uint32_t bot, int n);
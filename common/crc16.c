@@ -20,24 +20,28 @@
 #include <string.h>
 #include "commonutil.h"
 
-static uint16_t crc_table[256];
-static bool crc_table_init = false;
+#ifndef ON_DEVICE
+#include <pthread.h>
+// slicing-by-8, eight 256 entry tables per polynomial
+#define CRC16_SLICES 8
+#else
+// firmware keeps a single byte table, regenerated when the polynomial changes
+#define CRC16_SLICES 1
+#endif
+
+// one table set per polynomial and bit order, several CrcType_t share one
+typedef enum {
+    CRC16_TAB_CCITT_REFLECTED,
+    CRC16_TAB_CCITT,
+    CRC16_TAB_LEGIC,
+    CRC16_TAB_LEGIC_16,
+    CRC16_TAB_COUNT,
+} crc16_tab_t;
+
+// CRC type selected by init_table(), only used by crc16_fast() and crc16_legic()
 static CrcType_t current_crc_type = CRC_NONE;
 
-void init_table(CrcType_t crctype) {
-
-    // same crc algo, and initialised already
-    if (crctype == current_crc_type && crc_table_init) {
-        return;
-    }
-
-    // not the same crc algo. reset table.
-    if (crctype != current_crc_type) {
-        reset_table();
-    }
-
-    current_crc_type = crctype;
-
+static crc16_tab_t crc16_tab_of(CrcType_t crctype, bool refin) {
     switch (crctype) {
         case CRC_14443_A:
         case CRC_14443_B:
@@ -45,29 +49,25 @@ void init_table(CrcType_t crctype) {
         case CRC_ICLASS:
         case CRC_CRYPTORF:
         case CRC_KERMIT:
-            generate_table(CRC16_POLY_CCITT, true);
-            break;
+            return CRC16_TAB_CCITT_REFLECTED;
         case CRC_FELICA:
         case CRC_XMODEM:
         case CRC_CCITT:
         case CRC_11784:
         case CRC_PHILIPS:
-            generate_table(CRC16_POLY_CCITT, false);
-            break;
+            return CRC16_TAB_CCITT;
         case CRC_LEGIC:
-            generate_table(CRC16_POLY_LEGIC, true);
-            break;
+            return CRC16_TAB_LEGIC;
         case CRC_LEGIC_16:
-            generate_table(CRC16_POLY_LEGIC_16, true);
-            break;
+            return CRC16_TAB_LEGIC_16;
         case CRC_NONE:
-            crc_table_init = false;
-            current_crc_type = CRC_NONE;
+        default:
             break;
     }
+    return (refin) ? CRC16_TAB_CCITT_REFLECTED : CRC16_TAB_CCITT;
 }
 
-void generate_table(uint16_t polynomial, bool refin) {
+static void generate_table(uint16_t *table, uint16_t polynomial, bool refin) {
 
     for (uint16_t i = 0; i < 256; i++) {
 
@@ -94,19 +94,114 @@ void generate_table(uint16_t polynomial, bool refin) {
             crc = reflect16(crc);
         }
 
-        crc_table[i] = crc;
+        table[i] = crc;
+    }
+
+    // table k holds the crc of a byte followed by k zero bytes
+    for (uint8_t k = 1; k < CRC16_SLICES; k++) {
+        for (uint16_t i = 0; i < 256; i++) {
+            uint16_t prev = table[(k - 1) * 256 + i];
+            if (refin) {
+                table[k * 256 + i] = (prev >> 8) ^ table[prev & 0xFF];
+            } else {
+                table[k * 256 + i] = (prev << 8) ^ table[prev >> 8];
+            }
+        }
+    }
+}
+
+static void generate_tab(uint16_t *table, crc16_tab_t tab) {
+    switch (tab) {
+        case CRC16_TAB_CCITT_REFLECTED:
+            generate_table(table, CRC16_POLY_CCITT, true);
+            break;
+        case CRC16_TAB_CCITT:
+            generate_table(table, CRC16_POLY_CCITT, false);
+            break;
+        case CRC16_TAB_LEGIC:
+            generate_table(table, CRC16_POLY_LEGIC, true);
+            break;
+        case CRC16_TAB_LEGIC_16:
+        case CRC16_TAB_COUNT:
+        default:
+            generate_table(table, CRC16_POLY_LEGIC_16, true);
+            break;
+    }
+}
+
+#ifndef ON_DEVICE
+
+// generated once, read only afterwards. Safe to use from any thread.
+static uint16_t crc_tables[CRC16_TAB_COUNT][CRC16_SLICES * 256];
+static pthread_once_t crc_tables_once = PTHREAD_ONCE_INIT;
+
+static void generate_tables(void) {
+    for (int tab = 0; tab < CRC16_TAB_COUNT; tab++) {
+        generate_tab(crc_tables[tab], tab);
+    }
+}
+
+static const uint16_t *get_table(crc16_tab_t tab) {
+    pthread_once(&crc_tables_once, generate_tables);
+    return crc_tables[tab];
+}
+
+#else
+
+static uint16_t crc_table[256];
+static crc16_tab_t crc_table_tab = CRC16_TAB_COUNT;
+
+static const uint16_t *get_table(crc16_tab_t tab) {
+    if (tab != crc_table_tab) {
+        generate_tab(crc_table, tab);
+        crc_table_tab = tab;
+    }
+    return crc_table;
+}
+
+#endif
+
+void init_table(CrcType_t crctype) {
+    current_crc_type = crctype;
+    if (crctype != CRC_NONE) {
+        get_table(crc16_tab_of(crctype, true));
     }
-    crc_table_init = true;
 }
 
 void reset_table(void) {
-    memset(crc_table, 0, sizeof(crc_table));
-    crc_table_init = false;
     current_crc_type = CRC_NONE;
 }
 
+static uint16_t crc16_update(const uint16_t *t, uint16_t crc, uint8_t const *d, size_t n, bool refin) {
+
+#if CRC16_SLICES == 8
+    if (refin) {
+        for (; n >= 8; n -= 8, d += 8) {
+            crc ^= d[0] | (d[1] << 8);
+            crc = t[7 * 256 + (crc & 0xFF)] ^ t[6 * 256 + (crc >> 8)]
+                  ^ t[5 * 256 + d[2]] ^ t[4 * 256 + d[3]] ^ t[3 * 256 + d[4]]
+                  ^ t[2 * 256 + d[5]] ^ t[1 * 256 + d[6]] ^ t[d[7]];
+        }
+    } else {
+        for (; n >= 8; n -= 8, d += 8) {
+            crc ^= (d[0] << 8) | d[1];
+            crc = t[7 * 256 + (crc >> 8)] ^ t[6 * 256 + (crc & 0xFF)]
+                  ^ t[5 * 256 + d[2]] ^ t[4 * 256 + d[3]] ^ t[3 * 256 + d[4]]
+                  ^ t[2 * 256 + d[5]] ^ t[1 * 256 + d[6]] ^ t[d[7]];
+        }
+    }
+#endif
+
+    if (refin == false) {
+        while (n--) crc = (crc << 8) ^ t[((crc >> 8) ^ *d++) & 0xFF ];
+    } else {
+        while (n--) crc = (crc >> 8) ^ t[(crc & 0xFF) ^ *d++];
+    }
+    return crc;
+}
+
 // table lookup LUT solution
-uint16_t crc16_fast(uint8_t const *d, size_t n, uint16_t initval, bool refin, bool refout) {
+uint16_t crc16_fast_ex(CrcType_t ct, uint8_t const *d, size_t n, uint16_t initval, bool refin, bool refout) {
 
     // fast lookup table algorithm without augmented zero bytes, e.g. used in pkzip.
     // only usable with polynom orders of 8, 16, 24 or 32.
@@ -120,11 +215,7 @@ uint16_t crc16_fast(uint8_t const *d, size_t n, uint16_t initval, bool refin, bo
         crc = reflect16(crc);
     }
 
-    if (refin == false) {
-        while (n--) crc = (crc << 8) ^ crc_table[((crc >> 8) ^ *d++) & 0xFF ];
-    } else {
-        while (n--) crc = (crc >> 8) ^ crc_table[(crc & 0xFF) ^ *d++];
-    }
+    crc = crc16_update(get_table(crc16_tab_of(ct, refin)), crc, d, n, refin);
 
     if (refout ^ refin) {
         crc = reflect16(crc);
@@ -133,6 +224,10 @@ uint16_t crc16_fast(uint8_t const *d, size_t n, uint16_t initval, bool refin, bo
     return crc;
 }
 
+uint16_t crc16_fast(uint8_t const *d, size_t n, uint16_t initval, bool refin, bool refout) {
+    return crc16_fast_ex(current_crc_type, d, n, initval, refin, refout);
+}
+
 // bit looped solution  TODO REMOVED
 uint16_t update_crc16_ex(uint16_t crc, uint8_t c, uint16_t polynomial) {
     uint16_t tmp = 0;
@@ -195,8 +290,6 @@ void compute_crc(CrcType_t ct, const uint8_t *d, size_t n, uint8_t *first, uint8
     // can't calc a crc on less than 1 byte
     if (n == 0) return;
 
-    init_table(ct);
-
     uint16_t crc = 0;
     switch (ct) {
         case CRC_14443_A:
@@ -240,8 +333,6 @@ uint16_t Crc16ex(CrcType_t ct, const uint8_t *d, size_t n) {
 
     // can't calc a crc on less than 3 byte. (1byte + 2 crc bytes)
     if (n < 3) return 0;
-
-    init_table(ct);
     switch (ct) {
         case CRC_14443_A:
             return crc16_a(d, n);
@@ -287,8 +378,6 @@ bool check_crc(CrcType_t ct, const uint8_t *d, size_t n) {
     // can't calc a crc on less than 3 byte. (1byte + 2 crc bytes)
     if (n < 3) return false;
 
-    init_table(ct);
-
     switch (ct) {
         case CRC_14443_A:
             return (crc16_a(d, n) == 0);
@@ -323,24 +412,24 @@ bool check_crc(CrcType_t ct, const uint8_t *d, size_t n) {
 
 // poly=0x1021  init=0xffff  refin=false  refout=false  xorout=0x0000  check=0x29b1  residue=0x0000  name="CRC-16/CCITT-FALSE"
 uint16_t crc16_ccitt(uint8_t const *d, size_t n) {
-    return crc16_fast(d, n, 0xffff, false, false);
+    return crc16_fast_ex(CRC_CCITT, d, n, 0xffff, false, false);
 }
 
 // FDX-B ISO11784/85) uses KERMIT/CCITT
 // poly 0x xx  init=0x000  refin=false  refout=true  xorout=0x0000 ...
 uint16_t crc16_fdxb(uint8_t const *d, size_t n) {
-    return crc16_fast(d, n, 0x0000, false, true);
+    return crc16_fast_ex(CRC_11784, d, n, 0x0000, false, true);
 }
 
 // poly=0x1021  init=0x0000  refin=true  refout=true  xorout=0x0000 name="KERMIT"
 uint16_t crc16_kermit(uint8_t const *d, size_t n) {
-    return crc16_fast(d, n, 0x0000, true, true);
+    return crc16_fast_ex(CRC_KERMIT, d, n, 0x0000, true, true);
 }
 
 // FeliCa uses XMODEM
 // poly=0x1021  init=0x0000  refin=false  refout=false  xorout=0x0000 name="XMODEM"
 uint16_t crc16_xmodem(uint8_t const *d, size_t n) {
-    return crc16_fast(d, n, 0x0000, false, false);
+    return crc16_fast_ex(CRC_XMODEM, d, n, 0x0000, false, false);
 }
 
 // Following standards uses X-25
@@ -349,14 +438,14 @@ uint16_t crc16_xmodem(uint8_t const *d, size_t n) {
 //   ISO/IEC 13239 (formerly ISO/IEC 3309)
 // poly=0x1021  init=0xffff  refin=true  refout=true  xorout=0xffff name="X-25"
 uint16_t crc16_x25(uint8_t const *d, size_t n) {
-    uint16_t crc = crc16_fast(d, n, 0xffff, true, true);
+    uint16_t crc = crc16_fast_ex(CRC_15693, d, n, 0xffff, true, true);
     crc = ~crc;
     return crc;
 }
 // CRC-A (14443-3)
 // poly=0x1021 init=0xc6c6 refin=true refout=true xorout=0x0000 name="CRC-A"
 uint16_t crc16_a(uint8_t const *d, size_t n) {
-    return crc16_fast(d, n, 0xC6C6, true, true);
+    return crc16_fast_ex(CRC_14443_A, d, n, 0xC6C6, true, true);
 }
 
 // iClass crc
@@ -364,16 +453,18 @@ uint16_t crc16_a(uint8_t const *d, size_t n) {
 // poly       0x1021 reflected 0x8408
 // poly=0x1021  init=0x4807  refin=true  refout=true  xorout=0x0BC3  check=0xF0B8  name="CRC-16/ICLASS"
 uint16_t crc16_iclass(uint8_t const *d, size_t n) {
-    return crc16_fast(d, n, 0x4807, true, true);
+    return crc16_fast_ex(CRC_ICLASS, d, n, 0x4807, true, true);
 }
 
 // This CRC-16 is used in Legic Advant systems.
 // poly=0xB400,  init=depends  refin=true  refout=true  xorout=0x0000  check=  name="CRC-16/LEGIC"
 uint16_t crc16_legic(uint8_t const *d, size_t n, uint8_t uidcrc) {
     uint16_t initial = (uidcrc << 8 | uidcrc);
-    return crc16_fast(d, n, initial, true, false);
+    // legic variant picked by init_table(), CRC_LEGIC unless CRC_LEGIC_16 was set
+    CrcType_t ct = (current_crc_type == CRC_LEGIC_16) ? CRC_LEGIC_16 : CRC_LEGIC;
+    return crc16_fast_ex(ct, d, n, initial, true, false);
 }
 
 uint16_t crc16_philips(uint8_t const *d, size_t n) {
-    return crc16_fast(d, n, 0x49A3, false, false);
+    return crc16_fast_ex(CRC_PHILIPS, d, n, 0x49A3, false, false);
 }
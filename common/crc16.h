@@ -84,9 +84,13 @@ uint16_t crc16_legic(uint8_t const *d, size_t n, uint8_t uidcrc);
 uint16_t crc16_philips(uint8_t const *d, size_t n);
 
 // table implementation
+// The tables are per polynomial and read only once generated, the named crc16_* functions,
+// Crc16ex, compute_crc and check_crc don't depend on init_table() anymore.
+// init_table() only selects the table crc16_fast() and crc16_legic() use.
 void init_table(CrcType_t crctype);
 void reset_table(void);
-void generate_table(uint16_t polynomial, bool refin);
 uint16_t crc16_fast(uint8_t const *d, size_t n, uint16_t initval, bool refin, bool refout);
+// crc16_fast with the table of the given crc type. refin has to match the bit order of that type.
+uint16_t crc16_fast_ex(CrcType_t ct, uint8_t const *d, size_t n, uint16_t initval, bool refin, bool refout);
 
 #endif
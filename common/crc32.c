@@ -18,26 +18,72 @@
 #define htole32(x) (x)
 #define CRC32_PRESET 0xFFFFFFFF
 
-static void crc32_byte(uint32_t *crc, const uint8_t value);
-
-static void crc32_byte(uint32_t *crc, const uint8_t value) {
-    /* x32 + x26 + x23 + x22 + x16 + x12 + x11 + x10 + x8 + x7 + x5 + x4 + x2 + x + 1 */
-    const uint32_t poly = 0xEDB88320;
-
-    *crc ^= value;
-    for (int current_bit = 7; current_bit >= 0; current_bit--) {
-        int bit_out = (*crc) & 0x00000001;
-        *crc >>= 1;
-        if (bit_out)
-            *crc ^= poly;
+/* x32 + x26 + x23 + x22 + x16 + x12 + x11 + x10 + x8 + x7 + x5 + x4 + x2 + x + 1 */
+#define CRC32_POLY 0xEDB88320
+
+#ifndef ON_DEVICE
+
+#include <pthread.h>
+
+// slicing-by-8, table k is the crc of a byte followed by k zero bytes
+static uint32_t crc32_table[8][256];
+static pthread_once_t crc32_table_once = PTHREAD_ONCE_INIT;
+
+static void crc32_generate_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int j = 0; j < 8; j++) {
+            c = (c >> 1) ^ ((c & 1) ? CRC32_POLY : 0);
+        }
+        crc32_table[0][i] = c;
+    }
+    for (int k = 1; k < 8; k++) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t prev = crc32_table[k - 1][i];
+            crc32_table[k][i] = (prev >> 8) ^ crc32_table[0][prev & 0xFF];
+        }
     }
 }
 
-void crc32_ex(const uint8_t *d, const size_t n, uint8_t *crc) {
-    uint32_t c = CRC32_PRESET;
-    for (size_t i = 0; i < n; i++) {
-        crc32_byte(&c, d[i]);
+static uint32_t crc32_update(uint32_t c, const uint8_t *d, size_t n) {
+
+    pthread_once(&crc32_table_once, crc32_generate_table);
+
+    for (; n >= 8; n -= 8, d += 8) {
+        c ^= (uint32_t)d[0] | ((uint32_t)d[1] << 8) | ((uint32_t)d[2] << 16) | ((uint32_t)d[3] << 24);
+        c = crc32_table[7][c & 0xFF] ^ crc32_table[6][(c >> 8) & 0xFF]
+            ^ crc32_table[5][(c >> 16) & 0xFF] ^ crc32_table[4][c >> 24]
+            ^ crc32_table[3][d[4]] ^ crc32_table[2][d[5]]
+            ^ crc32_table[1][d[6]] ^ crc32_table[0][d[7]];
+    }
+
+    while (n--) {
+        c = (c >> 8) ^ crc32_table[0][(c ^ *d++) & 0xFF];
     }
+    return c;
+}
+
+#else
+
+// 16 entry nibble table, 64 bytes of flash instead of 8 shifts per byte
+static const uint32_t crc32_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t crc32_update(uint32_t c, const uint8_t *d, size_t n) {
+    while (n--) {
+        c ^= *d++;
+        c = (c >> 4) ^ crc32_nibble[c & 0x0F];
+        c = (c >> 4) ^ crc32_nibble[c & 0x0F];
+    }
+    return c;
+}
+
+#endif
+
+void crc32_ex(const uint8_t *d, const size_t n, uint8_t *crc) {
+    uint32_t c = crc32_update(CRC32_PRESET, d, n);
     crc[0] = (uint8_t) c;
     crc[1] = (uint8_t)(c >> 8);
     crc[2] = (uint8_t)(c >> 16);
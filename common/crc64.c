@@ -85,12 +85,48 @@ static const uint64_t crc64_table[] = {
     0x5DEDC41A34BBEEB2, 0x1F1D25F19D51D821, 0xD80C07CD676F8394, 0x9AFCE626CE85B507
 };
 
-void crc64(const uint8_t *data, const size_t len, uint64_t *crc) {
+#ifndef ON_DEVICE
+
+#include <pthread.h>
+
+// slicing-by-8, crc64_slices[k] is the crc of a byte followed by k + 1 zero bytes
+static uint64_t crc64_slices[7][256];
+static pthread_once_t crc64_slices_once = PTHREAD_ONCE_INIT;
 
-    for (size_t i = 0; i < len; i++) {
-        uint8_t tableIndex = (((uint8_t)(*crc >> 56)) ^ data[i]) & 0xff;
-        *crc = crc64_table[tableIndex] ^ (*crc << 8);
+static void crc64_generate_slices(void) {
+    const uint64_t *prev = crc64_table;
+    for (int k = 0; k < 7; k++) {
+        for (int i = 0; i < 256; i++) {
+            crc64_slices[k][i] = (prev[i] << 8) ^ crc64_table[prev[i] >> 56];
+        }
+        prev = crc64_slices[k];
     }
 }
 
-//suint8_t x = (c & 0xFF00000000000000 ) >> 56;
+#endif
+
+void crc64(const uint8_t *data, const size_t len, uint64_t *crc) {
+
+    size_t n = len;
+    uint64_t c = *crc;
+
+#ifndef ON_DEVICE
+    pthread_once(&crc64_slices_once, crc64_generate_slices);
+
+    for (; n >= 8; n -= 8, data += 8) {
+        for (int i = 0; i < 8; i++) {
+            c ^= (uint64_t)data[i] << (56 - (8 * i));
+        }
+        c = crc64_slices[6][c >> 56] ^ crc64_slices[5][(c >> 48) & 0xFF]
+            ^ crc64_slices[4][(c >> 40) & 0xFF] ^ crc64_slices[3][(c >> 32) & 0xFF]
+            ^ crc64_slices[2][(c >> 24) & 0xFF] ^ crc64_slices[1][(c >> 16) & 0xFF]
+            ^ crc64_slices[0][(c >> 8) & 0xFF] ^ crc64_table[c & 0xFF];
+    }
+#endif
+
+    for (size_t i = 0; i < n; i++) {
+        uint8_t tableIndex = (((uint8_t)(c >> 56)) ^ data[i]) & 0xff;
+        c = crc64_table[tableIndex] ^ (c << 8);
+    }
+    *crc = c;
+}
@@ -206,11 +206,10 @@ uint32_t ul_ev1_pwdgenF(const uint8_t *uid) {
 // Philips Sonicare toothbrush NFC head
 uint32_t ul_ev1_pwdgenG(const uint8_t *uid, const uint8_t *mfg) {
 
-    init_table(CRC_PHILIPS);
     // UID
     uint32_t crc1 = crc16_philips(uid, 7);
     // MFG string
-    uint32_t crc2 = crc16_fast(mfg, 10, crc1, false, false);
+    uint32_t crc2 = crc16_fast_ex(CRC_PHILIPS, mfg, 10, crc1, false, false);
 
     return (BSWAP_16(crc2) << 16 | BSWAP_16(crc1));
 }
@@ -251,17 +250,16 @@ uint16_t ul_ev1_packgenE(const uint8_t *uid) {
 }
 
 uint16_t ul_ev1_packgenG(const uint8_t *uid, const uint8_t *mfg) {
-    init_table(CRC_PHILIPS);
     // UID
     uint32_t crc1 = crc16_philips(uid, 7);
     // MFG string
-    uint32_t crc2 = crc16_fast(mfg, 10, crc1, false, false);
+    uint32_t crc2 = crc16_fast_ex(CRC_PHILIPS, mfg, 10, crc1, false, false);
     // PWD
     uint32_t pwd = (BSWAP_16(crc2) << 16 | BSWAP_16(crc1));
 
     uint8_t pb[4];
     num_to_bytes(pwd, 4, pb);
-    return BSWAP_16(crc16_fast(pb, 4, crc2, false, false));
+    return BSWAP_16(crc16_fast_ex(CRC_PHILIPS, pb, 4, crc2, false, false));
 }
 
 
@@ -737,7 +735,7 @@ int mfc_generate4b_nuid(uint8_t *uid, uint8_t *nuid) {
     nuid[1] = b1;
     crc = b1;
     crc |= b2 << 8;
-    crc = crc16_fast(&uid[3], 4, reflect16(crc), true, true);
+    crc = crc16_fast_ex(CRC_14443_A, &uid[3], 4, reflect16(crc), true, true);
     nuid[2] = (crc >> 8) & 0xFF ;
     nuid[3] = crc & 0xFF;
     return PM3_SUCCESS;
@@ -62,6 +62,7 @@
 #include "ui.h"
 #include "util.h"
 # include "cmddata.h"
+# include "lfdemod_kernels.h"
 # define prnt(args...) PrintAndLogEx(DEBUG, ## args );
 #else
 # include "dbprint.h"
@@ -93,11 +94,34 @@ static void printSignal(void) {
 }
 
 #ifndef ON_DEVICE
-static int cmp_uint8(const void *a, const void *b) {
-    if (*(const uint8_t *)a < * (const uint8_t *)b)
-        return -1;
-    else
-        return *(const uint8_t *)a > *(const uint8_t *)b;
+// value at rank k of the sorted samples, from their histogram.
+// Same result as sorting a copy, without the copy and the sort
+static uint8_t hist_rank(const uint32_t *hist, uint32_t k) {
+    uint32_t acc = 0;
+    for (uint16_t v = 0; v < 256; v++) {
+        acc += hist[v];
+        if (acc > k)
+            return v;
+    }
+    return 255;
+}
+
+static void sample_hist(const uint8_t *samples, uint32_t size, uint32_t *hist) {
+    // four tables, a run of equal samples doesn't wait on one counter
+    uint32_t part[4][256];
+    memset(part, 0, sizeof(part));
+    uint32_t i = SIGNAL_IGNORE_FIRST_SAMPLES;
+    for (; i + 4 <= size; i += 4) {
+        part[0][samples[i]]++;
+        part[1][samples[i + 1]]++;
+        part[2][samples[i + 2]]++;
+        part[3][samples[i + 3]]++;
+    }
+    for (; i < size; i++)
+        part[0][samples[i]]++;
+
+    for (uint16_t v = 0; v < 256; v++)
+        hist[v] = part[0][v] + part[1][v] + part[2][v] + part[3][v];
 }
 #endif
 
@@ -110,27 +134,27 @@ void computeSignalProperties(const uint8_t *samples, uint32_t size) {
     uint32_t offset_size = size - SIGNAL_IGNORE_FIRST_SAMPLES;
 
 #ifndef ON_DEVICE
-    uint8_t *tmp = calloc(offset_size, sizeof(uint8_t));
-    if (tmp == NULL)
-        return;
-    memcpy(tmp, samples + SIGNAL_IGNORE_FIRST_SAMPLES, offset_size);
-    qsort(tmp, offset_size, sizeof(uint8_t), cmp_uint8);
+    uint32_t hist[256];
+    sample_hist(samples, size, hist);
 
-    uint8_t low10 = 0.5 * (tmp[(int)(offset_size * 0.1)] + tmp[(int)((offset_size - 1) * 0.1)]);
-    uint8_t hi90 =  0.5 * (tmp[(int)(offset_size * 0.9)] + tmp[(int)((offset_size - 1) * 0.9)]);
-    free(tmp);
+    uint8_t low10 = 0.5 * (hist_rank(hist, (int)(offset_size * 0.1)) + hist_rank(hist, (int)((offset_size - 1) * 0.1)));
+    uint8_t hi90 =  0.5 * (hist_rank(hist, (int)(offset_size * 0.9)) + hist_rank(hist, (int)((offset_size - 1) * 0.9)));
 
+    // low, high and the mean between the ranks, from the histogram too
     uint32_t cnt = 0;
-    for (uint32_t i = SIGNAL_IGNORE_FIRST_SAMPLES; i < size; i++) {
+    for (uint16_t v = 0; v < 256; v++) {
 
-        if (samples[i] < signalprop.low) signalprop.low = samples[i];
-        if (samples[i] > signalprop.high) signalprop.high = samples[i];
+        if (hist[v] == 0)
+            continue;
+
+        if (v < signalprop.low) signalprop.low = v;
+        if (v > signalprop.high) signalprop.high = v;
 
-        if (samples[i] < low10 || samples[i] > hi90)
+        if (v < low10 || v > hi90)
             continue;
 
-        sum += samples[i];
-        cnt++;
+        sum += v * hist[v];
+        cnt += hist[v];
     }
     if (cnt > 0)
         signalprop.mean = sum / cnt;
@@ -165,35 +189,28 @@ void removeSignalOffset(uint8_t *samples, uint32_t size) {
 
 #ifndef ON_DEVICE
 
-    uint8_t *tmp = calloc(offset_size, sizeof(uint8_t));
-    if (tmp == NULL)
-        return;
-    memcpy(tmp, samples + SIGNAL_IGNORE_FIRST_SAMPLES, offset_size);
-    qsort(tmp, offset_size, sizeof(uint8_t), cmp_uint8);
+    uint32_t hist[256];
+    sample_hist(samples, size, hist);
 
-    uint8_t low10 = 0.5 * (tmp[(int)(offset_size * 0.05)] + tmp[(int)((offset_size - 1) * 0.05)]);
-    uint8_t hi90 =  0.5 * (tmp[(int)(offset_size * 0.95)] + tmp[(int)((offset_size - 1) * 0.95)]);
-    free(tmp);
+    uint8_t low10 = 0.5 * (hist_rank(hist, (int)(offset_size * 0.05)) + hist_rank(hist, (int)((offset_size - 1) * 0.05)));
+    uint8_t hi90 =  0.5 * (hist_rank(hist, (int)(offset_size * 0.95)) + hist_rank(hist, (int)((offset_size - 1) * 0.95)));
 
     int32_t cnt = 0;
-    for (uint32_t i = SIGNAL_IGNORE_FIRST_SAMPLES; i < size; i++) {
-
-        if (samples[i] < low10 || samples[i] > hi90)
-            continue;
-
-        acc_off += samples[i] - 128;
-        cnt++;
+    for (uint16_t v = low10; v <= hi90; v++) {
+        acc_off += (v - 128) * (int)hist[v];
+        cnt += hist[v];
     }
     if (cnt > 0)
         acc_off /= cnt;
     else
         acc_off = 0;
+
+    lfdemod_kernel()->offset(samples, size, acc_off);
 #else
     for (uint32_t i = SIGNAL_IGNORE_FIRST_SAMPLES; i < size; i++)
         acc_off += samples[i] - 128;
 
     acc_off /= (int)offset_size;
-#endif
 
     // shift and saturate samples to center the mean
     for (uint32_t i = 0; i < size; i++) {
@@ -204,6 +221,7 @@ void removeSignalOffset(uint8_t *samples, uint32_t size) {
             samples[i] = (255 - samples[i] >=  -acc_off) ? samples[i] - acc_off : 255;
         }
     }
+#endif
 }
 
 // get high and low values of a wave with passed in fuzz factor. also return noise test = 1 for passed or 0 for only noise
@@ -405,6 +423,68 @@ uint32_t bytebits_to_byteLSBF(uint8_t *src, size_t numbits) {
     return num;
 }
 
+#ifndef ON_DEVICE
+// preambleSearchEx on bits packed 64 to a word, plus a word marking the bytes
+// that are neither 0 nor 1 so they never match.  -1 when it can't, the
+// preamble is too long, holds other values or there is no memory
+static int preambleSearchPacked(const uint8_t *bits, const uint8_t *preamble, size_t pLen, size_t *size, size_t *startIdx, bool findone) {
+
+    if (pLen == 0 || pLen > 64)
+        return -1;
+
+    uint64_t pat = 0;
+    for (size_t i = 0; i < pLen; i++) {
+        if (preamble[i] > 1)
+            return -1;
+        pat |= (uint64_t)preamble[i] << i;
+    }
+    const uint64_t mask = (pLen == 64) ? UINT64_MAX : ((1ULL << pLen) - 1);
+
+    // one spare word, a window reads into the next
+    size_t words = ((*size + 63) / 64) + 1;
+    uint64_t *val = calloc(words * 2, sizeof(uint64_t));
+    if (val == NULL)
+        return -1;
+
+    uint64_t *bad = val + words;
+    lfdemod_kernel()->pack_bits(bits, *size, val, bad);
+
+    uint8_t foundCnt = 0;
+    for (size_t idx = 0; idx < *size - pLen; idx++) {
+
+        size_t q = idx / 64, r = idx % 64;
+        uint64_t v = val[q] >> r;
+        uint64_t b = bad[q] >> r;
+        if (r) {
+            v |= val[q + 1] << (64 - r);
+            b |= bad[q + 1] << (64 - r);
+        }
+
+        if ((((v ^ pat) | b) & mask) != 0)
+            continue;
+
+        //first index found
+        foundCnt++;
+        if (foundCnt == 1) {
+            if (g_debugMode >= 1) prnt("DEBUG: (preambleSearchEx) preamble found at %zu", idx);
+            *startIdx = idx;
+            if (findone) {
+                free(val);
+                return true;
+            }
+        }
+        if (foundCnt == 2) {
+            if (g_debugMode >= 1) prnt("DEBUG: (preambleSearchEx) preamble 2 found at %zu", idx);
+            *size = idx - *startIdx;
+            free(val);
+            return true;
+        }
+    }
+    free(val);
+    return (foundCnt > 0);
+}
+#endif
+
 // search for given preamble in given BitStream and return success = TRUE or fail = FALSE and startIndex and length
 bool preambleSearch(uint8_t *bits, uint8_t *preamble, size_t pLen, size_t *size, size_t *startIdx) {
     return preambleSearchEx(bits, preamble, pLen, size, startIdx, false);
@@ -418,6 +498,12 @@ bool preambleSearchEx(uint8_t *bits, uint8_t *preamble, size_t pLen, size_t *siz
         return false;
 
     uint8_t foundCnt = 0;
+#ifndef ON_DEVICE
+    // up to 64 bits compared at once on the packed stream
+    int res = preambleSearchPacked(bits, preamble, pLen, size, startIdx, findone);
+    if (res >= 0)
+        return res;
+#endif
     for (size_t idx = 0; idx < *size - pLen; idx++) {
         if (memcmp(bits + idx, preamble, pLen) == 0) {
             //first index found
@@ -492,11 +578,23 @@ static int getClosestClock(int testclk) {
 }
 
 void getNextLow(const uint8_t *samples, size_t size, int low, size_t *i) {
+#ifndef ON_DEVICE
+    if (low >= 0 && low <= 255 && *i < size) {
+        *i = lfdemod_kernel()->find_le(samples, *i, size, low);
+        return;
+    }
+#endif
     while ((samples[*i] > low) && (*i < size))
         *i += 1;
 }
 
 void getNextHigh(const uint8_t *samples, size_t size, int high, size_t *i) {
+#ifndef ON_DEVICE
+    if (high >= 0 && high <= 255 && *i < size) {
+        *i = lfdemod_kernel()->find_ge(samples, *i, size, high);
+        return;
+    }
+#endif
     while ((samples[*i] < high) && (*i < size))
         *i += 1;
 }
@@ -631,6 +729,17 @@ bool DetectCleanAskWave(const uint8_t *dest, size_t size, uint8_t high, uint8_t
     // sanity check
     if (loopEnd > size) loopEnd = size;
 
+#ifndef ON_DEVICE
+    if (loopEnd <= 160)
+        return true;
+
+    size_t peaks = lfdemod_kernel()->count_peaks(dest + 160, loopEnd - 160, high, low);
+    if (peaks > 200)
+        return true;
+
+    allArePeaks = (peaks == loopEnd - 160);
+    cntPeaks = peaks;
+#else
     for (size_t i = 160; i < loopEnd; i++) {
 
         if (dest[i] > low && dest[i] < high)
@@ -641,6 +750,7 @@ bool DetectCleanAskWave(const uint8_t *dest, size_t size, uint8_t high, uint8_t
             if (cntPeaks > 200) return true;
         }
     }
+#endif
 
     if (allArePeaks == false) {
         if (g_debugMode == 2) prnt("DEBUG DetectCleanAskWave: peaks (200) %u", cntPeaks);
@@ -756,6 +866,29 @@ int DetectStrongAskClock(uint8_t *dest, size_t size, int high, int low, int *clo
     return shortestWaveIdx;
 }
 
+#ifndef ON_DEVICE
+// errors of the DetectASKClock loop for the starts j .. j + n - 1 of one clock,
+// the clock positions without a peak within tol, from the peak misses.
+// Returns how many starts it did, 0 when it can't do them
+static size_t askClockErrors(const uint8_t *miss, size_t size, size_t j, size_t n, uint16_t clk, uint8_t tol, uint32_t *errs) {
+
+    // the last start has the fewest clock positions
+    size_t last = j + n - 1;
+    if (j < tol || (size - last - tol) / clk == 0)
+        return 0;
+
+    size_t terms = ((size - last - tol) / clk) - 1;
+    lfdemod_kernel()->stride_sum(miss + j, n, clk, terms, errs);
+
+    for (size_t l = 0; l < n; l++) {
+        size_t loopEnd = ((size - (j + l) - tol) / clk) - 1;
+        for (size_t t = terms; t < loopEnd; t++)
+            errs[l] += miss[j + l + (t * clk)];
+    }
+    return n;
+}
+#endif
+
 // not perfect especially with lower clocks or VERY good antennas (heavy wave clipping)
 // maybe somehow adjust peak trimming value based on samples to fix?
 // return start index of best starting position for that clock and return clock (by reference)
@@ -831,6 +964,14 @@ int DetectASKClock(uint8_t *dest, size_t size, int *clock, int maxErr) {
         clkCnt = 1;
     }
 
+#ifndef ON_DEVICE
+    // samples without a peak at, and within 1 of, them.  Made when first needed
+    uint8_t *miss[2] = { NULL, NULL };
+    bool use_miss = (peak_hi >= 0 && peak_hi <= 255 && peak_low >= 0 && peak_low <= 255);
+    uint32_t errs[128];
+    size_t errs_first = 0, errs_count = 0;
+#endif
+
     //test each valid clock from smallest to greatest to see which lines up
     for (; clkCnt < num_clks; clkCnt++) {
         if (clk[clkCnt] <= 32) {
@@ -844,6 +985,15 @@ int DetectASKClock(uint8_t *dest, size_t size, int *clock, int maxErr) {
 
         bestErr[clkCnt] = 1000;
 
+#ifndef ON_DEVICE
+        errs_count = 0;
+        if (use_miss && miss[tol] == NULL) {
+            miss[tol] = calloc(size, sizeof(uint8_t));
+            if (miss[tol] != NULL)
+                lfdemod_kernel()->peak_miss(dest, size, peak_hi, peak_low, tol, miss[tol]);
+        }
+#endif
+
         //try lining up the peaks by moving starting point (try first few clocks)
 
         // get to first full low to prime loop and skip incomplete first pulse
@@ -852,9 +1002,21 @@ int DetectASKClock(uint8_t *dest, size_t size, int *clock, int maxErr) {
 
         for (; j < loopCnt; j++) {
             errCnt = 0;
+            bool counted = false;
+#ifndef ON_DEVICE
+            // a block of starts at once
+            if (miss[tol] != NULL && (j < errs_first || j >= errs_first + errs_count)) {
+                errs_first = j;
+                errs_count = askClockErrors(miss[tol], size, j, MIN(ARRAYLEN(errs), loopCnt - j), clk[clkCnt], tol, errs);
+            }
+            if (j >= errs_first && j < errs_first + errs_count) {
+                errCnt = errs[j - errs_first];
+                counted = true;
+            }
+#endif
             // now that we have the first one lined up test rest of wave array
             loopEnd = ((size - j - tol) / clk[clkCnt]) - 1;
-            for (i = 0; i < loopEnd; ++i) {
+            for (i = 0; i < loopEnd && counted == false; ++i) {
                 arrLoc = j + (i * clk[clkCnt]);
                 if (dest[arrLoc] >= peak_hi || dest[arrLoc] <= peak_low) {
                 } else if (dest[arrLoc - tol] >= peak_hi || dest[arrLoc - tol] <= peak_low) {
@@ -869,6 +1031,10 @@ int DetectASKClock(uint8_t *dest, size_t size, int *clock, int maxErr) {
             if (errCnt == 0 && clkCnt < 7) {
                 if (!found_clk)
                     *clock = clk[clkCnt];
+#ifndef ON_DEVICE
+                free(miss[0]);
+                free(miss[1]);
+#endif
                 return j;
             }
             // if we found errors see if it is lowest so far and save it as best run
@@ -892,6 +1058,11 @@ int DetectASKClock(uint8_t *dest, size_t size, int *clock, int maxErr) {
         //if (g_debugMode == 2) prnt("DEBUG ASK: clk %d, # Errors %d, Current Best Clk %d, bestStart %d", clk[k], bestErr[k], clk[best], bestStart[best]);
     }
 
+#ifndef ON_DEVICE
+    free(miss[0]);
+    free(miss[1]);
+#endif
+
     bool chg = false;
     for (i = 0; i < ARRAYLEN(bestErr); i++) {
         chg = (bestErr[i] != 1000);
@@ -1633,6 +1804,9 @@ uint16_t manrawdecode(uint8_t *bits, size_t *size, uint8_t invert, uint8_t *alig
     // find correct start position [alignment]
     for (uint8_t k = 0; k < 2; k++) {
 
+#ifndef ON_DEVICE
+        errCnt = lfdemod_kernel()->pair_equal(bits, k, *size - 1, 50);
+#else
         for (i = k; i < *size - 1; i += 2) {
 
             if (bits[i] == bits[i + 1]) {
@@ -1643,6 +1817,7 @@ uint16_t manrawdecode(uint8_t *bits, size_t *size, uint8_t invert, uint8_t *alig
                 break;
             }
         }
+#endif
 
         if (bestErr > errCnt) {
 
@@ -1656,8 +1831,15 @@ uint16_t manrawdecode(uint8_t *bits, size_t *size, uint8_t invert, uint8_t *alig
     }
 
     *alignPos = bestRun;
+    i = bestRun;
+#ifndef ON_DEVICE
+    // whole pairs at once, the loop does an odd last sample
+    bitnum = MIN((*size - bestRun) / 2, maxBits + 1);
+    lfdemod_kernel()->man_decode(bits + bestRun, bitnum, invert, bits);
+    i += bitnum * 2;
+#endif
     // decode
-    for (i = bestRun; i < *size; i += 2) {
+    for (; i < *size && bitnum <= maxBits; i += 2) {
 
         if (bits[i] == 1 && (bits[i + 1] == 0)) {
             bits[bitnum++] = invert;
@@ -1676,6 +1858,22 @@ uint16_t manrawdecode(uint8_t *bits, size_t *size, uint8_t invert, uint8_t *alig
     return bestErr;
 }
 
+// next sample from i that can end the current half wave, the ones before it only count
+static size_t askWaveEnd(const uint8_t *bits, size_t size, size_t i, bool waveHigh, int high, int low) {
+#ifndef ON_DEVICE
+    if (high >= 0 && high <= 255 && low >= 0 && low <= 255) {
+        return (waveHigh) ? lfdemod_kernel()->find_le(bits, i, size, low) : lfdemod_kernel()->find_ge(bits, i, size, high);
+    }
+#else
+    (void)bits;
+    (void)size;
+    (void)waveHigh;
+    (void)high;
+    (void)low;
+#endif
+    return i;
+}
+
 // demodulates strong heavily clipped samples
 // RETURN: num of errors.  if 0, is ok.
 static uint16_t cleanAskRawDemod(uint8_t *bits, size_t *size, int clk, int invert, int high, int low, int *startIdx) {
@@ -1695,6 +1893,13 @@ static uint16_t cleanAskRawDemod(uint8_t *bits, size_t *size, int clk, int inver
 
     // sample counts,   like clock = 32.. it tries to find  32/4 = 8,  32/2 = 16
     for (size_t i = pos; i < *size; i++) {
+        size_t next = askWaveEnd(bits, *size, i, waveHigh, high, low);
+        smplCnt += next - i;
+        i = next;
+        if (i == *size) {
+            break;
+        }
+
         if (bits[i] >= high && waveHigh) {
             smplCnt++;
         } else if (bits[i] <= low && !waveHigh) {
@@ -1825,6 +2030,13 @@ int askdemod_ext(uint8_t *bits, size_t *size, int *clk, int *invert, int maxErr,
     lastBit = start - *clk;
 
     for (i = start; i < *size; ++i) {
+        // nothing happens before the next half or full clock
+        int next = lastBit + ((!midBit && !askType) ? (*clk / 2) - tol : *clk - tol);
+        if (next > 0 && i < (size_t)next) {
+            i = next - 1;
+            continue;
+        }
+
         if (i - lastBit >= *clk - tol) {
             if (bits[i] >= high) {
                 bits[bitnum++] = *invert;
@@ -1914,6 +2126,32 @@ int nrzRawDemod(uint8_t *dest, size_t *size, int *clk, const int *invert, int *s
     return 0;
 }
 
+// threshold dest[from .. to) against the mean up front, false when it is left to the caller
+static bool fskThreshold(uint8_t *dest, size_t from, size_t to) {
+#ifndef ON_DEVICE
+    if (from < to && signalprop.mean >= 0 && signalprop.mean <= 255) {
+        lfdemod_kernel()->threshold(dest + from, to - from, signalprop.mean);
+        return true;
+    }
+#else
+    (void)dest;
+    (void)from;
+    (void)to;
+#endif
+    return false;
+}
+
+// next 0->1 transition of thresholded samples from i
+static size_t fskNextRise(const uint8_t *dest, size_t i, size_t to) {
+#ifndef ON_DEVICE
+    return lfdemod_kernel()->find_rise(dest, i, to);
+#else
+    (void)dest;
+    (void)to;
+    return i;
+#endif
+}
+
 // translate wave to 11111100000 (1 for each short wave [higher freq] 0 for each long wave [lower freq])
 static size_t fsk_wave_demod(uint8_t *dest, size_t size, uint8_t fchigh, uint8_t fclow, int *startIdx) {
 
@@ -1965,10 +2203,20 @@ static size_t fsk_wave_demod(uint8_t *dest, size_t size, uint8_t fchigh, uint8_t
     // width should be divided with exp_one.  i:e 6+7+6+2=21,  21/5 = 4,
     // the 1-0 to 0-1  width should be divided with exp_zero.   Ie: 3+5+6+7 = 21/6 = 3
 
+    // the bits written go well behind idx, the samples ahead can be thresholded first
+    bool thresholded = fskThreshold(dest, idx, size - 20);
+
     for (; idx < size - 20; idx++) {
 
-        // threshold current value
-        dest[idx] = (dest[idx] < signalprop.mean) ? 0 : 1;
+        if (thresholded) {
+            idx = fskNextRise(dest, idx, size - 20);
+            if (idx == size - 20) {
+                break;
+            }
+        } else {
+            // threshold current value
+            dest[idx] = (dest[idx] < signalprop.mean) ? 0 : 1;
+        }
 
         // Check for 0->1 transition
         if (dest[idx - 1] < dest[idx]) {
@@ -2010,6 +2258,18 @@ static size_t fsk_wave_demod(uint8_t *dest, size_t size, uint8_t fchigh, uint8_t
 
 // translate 11111100000 to 10
 //rfLen = clock, fchigh = larger field clock, fclow = smaller field clock
+// next sample from i that is not v
+static size_t nextChange(const uint8_t *dest, size_t i, size_t size, uint8_t v) {
+#ifndef ON_DEVICE
+    return lfdemod_kernel()->find_ne(dest, i, size, v);
+#else
+    (void)dest;
+    (void)size;
+    (void)v;
+    return i;
+#endif
+}
+
 static size_t aggregate_bits(uint8_t *dest, size_t size, uint8_t clk, uint8_t invert, uint8_t fchigh, uint8_t fclow, int *startIdx) {
 
     uint8_t lastval = dest[0];
@@ -2019,6 +2279,13 @@ static size_t aggregate_bits(uint8_t *dest, size_t size, uint8_t clk, uint8_t in
     uint8_t hclk = clk / 2;
 
     for (i = 1; i < size; i++) {
+        size_t next = nextChange(dest, i, size, lastval);
+        n += next - i;
+        i = next;
+        if (i == size) {
+            break;
+        }
+
         n++;
         if (dest[i] == lastval) continue; //skip until we hit a transition
 
@@ -2110,6 +2377,18 @@ void psk2TOpsk1(uint8_t *bits, size_t size) {
     }
 }
 
+// next top edge of a wave from i
+static size_t pskNextTop(const uint8_t *dest, size_t i, size_t to, uint8_t fc) {
+#ifndef ON_DEVICE
+    return lfdemod_kernel()->find_top(dest, i, to, fc);
+#else
+    (void)dest;
+    (void)to;
+    (void)fc;
+    return i;
+#endif
+}
+
 // demodulate PSK1 wave
 // uses wave lengths (# Samples)
 // TODO: Iceman - hard coded value 7,  should be #define
@@ -2157,7 +2436,7 @@ int pskRawDemod_ext(uint8_t *dest, size_t *size, int *clock, const int *invert,
 
     waveStart = 0;
     dest[numBits++] = curPhase; //set first read bit
-    for (i = firstFullWave + fullWaveLen - 1; i < *size - 3; i++) {
+    for (i = pskNextTop(dest, firstFullWave + fullWaveLen - 1, *size - 3, fc); i < *size - 3; i = pskNextTop(dest, i + 1, *size - 3, fc)) {
         //top edge of wave = start of new wave
         if (dest[i] + fc < dest[i + 1] && dest[i + 1] >= dest[i + 2]) {
             if (waveStart == 0) {
@@ -152,7 +152,7 @@ uint64_t usclock(void) {
 #include <sys/timeb.h>
     struct _timeb t;
     _ftime(&t);
-    return 1000 * (uint64_t)t.time + t.millitm;
+    return 1000 * (1000 * (uint64_t)t.time + t.millitm);
 
 // NORMAL CODE (use _ftime_s)
     //struct _timeb t;
@@ -164,8 +164,7 @@ uint64_t usclock(void) {
 #else
     struct timespec t;
     clock_gettime(CLOCK_MONOTONIC, &t);
-    //return (1000 * (uint64_t)t.tv_sec + t.tv_nsec / 1000);
-    return (1000 * (uint64_t)t.tv_sec + (t.tv_nsec / 1000));
+    return (1000000 * (uint64_t)t.tv_sec + (t.tv_nsec / 1000));
 #endif
 }
 
@@ -350,6 +350,20 @@ typedef struct {
     uint8_t key[6];
 } PACKED mf_readblock_t;
 
+// consecutive blocks of one sector after a single authentication
+typedef struct {
+    uint8_t blockno;
+    uint8_t keytype;
+    uint8_t key[6];
+    uint8_t count;
+} PACKED mf_readblocks_t;
+
+typedef struct {
+    uint8_t blockno;    // echoed, so pipelined replies can be matched
+    uint8_t count;      // 0 on failure
+    uint8_t data[16 * 16];
+} PACKED mf_readblocks_resp_t;
+
 typedef enum {
     MF_WAKE_NONE,
     MF_WAKE_WUPA,    // 52(7) + anticoll
@@ -863,6 +877,7 @@ typedef struct {
 
 #define CMD_HF_MIFARE_READBL 0x0620
 #define CMD_HF_MIFARE_READBL_EX 0x0628
+#define CMD_HF_MIFARE_READBLS 0x062A
 #define CMD_HF_MIFAREU_READBL 0x0720
 #define CMD_HF_MIFARE_READSC 0x0621
 #define CMD_HF_MIFAREU_READCARD 0x0721
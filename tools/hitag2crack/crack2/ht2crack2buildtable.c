@@ -4,31 +4,28 @@
  */
 
 #include "ht2crackutils.h"
+#include "ht2crack2table.h"
 #include <stdlib.h>
+#include <inttypes.h>
+#include <getopt.h>
 
-// DATAMAX is the size of each bucket (bytes).  There are 65536 buckets so choose a value such that
-// DATAMAX * 65536 < RAM available.  For ex, if you want to use 12GB of RAM (for a 16GB machine
-// leaving some RAM free for OS and other stuff), DATAMAX = 12GB / 65536 = 196608.  Round this down
-// to a power of 10; DATAMAX = 196600.
-#define DATAMAX 196600 // around 192K rounded down to a power of 10
+// datamax is the size of each bucket buffer (bytes).  There are 65536 buckets so by default it
+// is sized so that all of them use about 3/4 of the physical RAM, rounded down to a whole number
+// of entries.  Override with -m.
+static uint64_t datamax = 196600;
 
-// NUM_BUILD_THREADS and NUM_SORT_THREADS are the number of threads to run concurrently.  These should
-// ideally be equal to the number of virtual cores you have available.  A quad-core machine will
-// likely have 8 virtual cores, so set them to 8.
+// build_threads and sort_threads are the number of threads to run concurrently.  They default
+// to the number of online cores.
 //
 // If sorting fails with a 'bus error' then that is likely because your disk I/O can't keep up with
 // the read/write demands of the multi-threaded sorting.  In this case, reduce the number of sorting
-// threads.  This will most likely only be a problem with network disks; SATA should be okay;
+// threads with -s.  This will most likely only be a problem with network disks; SATA should be okay;
 // USB2/3 should keep up.
-//
-// These MUST be a power of 2 for the maths to work - you have been warned!
-// Also, sort threads MUST be <= build threads or a horrible buffer overflow will happen!
-#define NUM_BUILD_THREADS 8
-#define NUM_SORT_THREADS 8
+static int build_threads = 8;
+static int sort_threads = 8;
 
-// DATASIZE is the number of bytes in an entry.  This is 10; 4 bytes of keystream (2 are in the filepath) +
-// 6 bytes of PRNG state.
-#define DATASIZE 10
+// log2 of the number of table entries, only lowered for testing
+static int entrybits = 37;
 
 int debug = 0;
 
@@ -60,7 +57,7 @@ static void create_table(struct table *tt, int d_1, int d_2) {
     }
 
     // create some space
-    tt->data = (unsigned char *)calloc(1, DATAMAX);
+    tt->data = (unsigned char *)calloc(1, datamax);
     if (!(tt->data)) {
         printf("create_table: cannot calloc data\n");
         exit(1);
@@ -171,7 +168,7 @@ static void store(unsigned char *data) {
     t1->ptr += 10;
 
     // check if table is full
-    if ((t1->ptr - t1->data) >= DATAMAX) {
+    if ((t1->ptr - t1->data) >= datamax) {
         // write the table to disk
         writetable(t1);
         // reset ptr
@@ -276,9 +273,7 @@ static void jumpnsteps(Hitag_State *hstate, int table) {
 static void *buildtable(void *dd) {
     Hitag_State hstate;
     Hitag_State hstate2;
-    unsigned long long maxentries = 1ULL;
     int index = (int)(long)dd;
-    int tnum = NUM_BUILD_THREADS;
 
     /* set random state */
     hstate.shiftreg = 0x123456789abc;
@@ -289,18 +284,11 @@ static void *buildtable(void *dd) {
         jumpnsteps(&hstate, 2);
     }
 
-    /* set max entries - this is a fraction of 2^37 depending on how many threads we are running.
-       1 thread  = 2^37
-       2 threads = 2^36
-       4 threads = 2^35
-       8 threads = 2^34
-       etc
+    /* set max entries - thread n makes entries n, n + build_threads, n + 2 * build_threads, ...
+       of the 2^37 entries, so any number of threads covers the table exactly once.
     */
-    maxentries = maxentries << 37;
-    while (!(tnum & 0x1)) {
-        maxentries = maxentries >> 1;
-        tnum = tnum >> 1;
-    }
+    unsigned long long total = 1ULL << entrybits;
+    unsigned long long maxentries = (total - index + build_threads - 1) / build_threads;
 
     /* make the entries */
     for (unsigned long long i = 0; i < maxentries; i++) {
@@ -316,8 +304,8 @@ static void *buildtable(void *dd) {
 
         write_ks_s(ks1, ks2, hstate.shiftreg);
 
-        // jump hstate forward 2048 * NUM_BUILD_THREADS states using di table
-        // this is because we're running NUM_BUILD_THREADS threads at once, from NUM_BUILD_THREADS
+        // jump hstate forward 2048 * build_threads states using di table
+        // this is because we're running build_threads threads at once, from build_threads
         // different offsets that are 2048 states apart.
         jumpnsteps(&hstate, 1);
     }
@@ -346,11 +334,6 @@ static void makedirs(void) {
             printf("cannot make dir %s\n", path);
             exit(1);
         }
-        snprintf(path, sizeof(path), "sorted/%02x", i);
-        if (mkdir(path, 0755)) {
-            printf("cannot make dir %s\n", path);
-            exit(1);
-        }
     }
 }
 
@@ -361,94 +344,251 @@ static int datacmp(const void *p1, const void *p2) {
     return memcmp(d_1, d_2, DATASIZE);
 }
 
-static void *sorttable(void *dd) {
-    int i, j;
-    int fdin;
-    int fdout;
-    char infile[64];
-    char outfile[64];
-    unsigned char *data = NULL;
+// entry counts of all buckets, for the shard index
+static uint64_t *bucketcount;
+
+// next shard to sort or convert, shared between the sort threads
+static int nextshard;
+
+// read a whole file into *buf, growing it if needed. Returns the number of bytes read.
+static uint64_t readfile(const char *infile, unsigned char **buf, uint64_t *bufsize) {
     struct stat filestat;
-    int index = (int)(long)dd;
-    int space = 0x100 / NUM_SORT_THREADS;
 
-    // create table - 50MB should be enough
-    unsigned char *table = (unsigned char *)calloc(1, 50UL * 1024UL * 1024UL);
-    if (!table) {
-        printf("sorttable: cannot calloc table\n");
+    int fdin = open(infile, O_RDONLY);
+    if (fdin <= 0) {
+        printf("cannot open file %s\n", infile);
         exit(1);
     }
 
-    // loop over our first byte values
-    for (i = (index * space); i < ((index + 1) * space); i++) {
-        // loop over all second byte values
-        for (j = 0; j < 0x100; j++) {
+    if (fstat(fdin, &filestat)) {
+        printf("cannot stat file %s\n", infile);
+        exit(1);
+    }
 
-            printf("sorttable: processing bytes 0x%02x/0x%02x\n", i, j);
+    uint64_t size = filestat.st_size;
+    if (size > *bufsize) {
+        free(*buf);
+        *bufsize = size;
+        *buf = (unsigned char *)malloc(size);
+        if (!*buf) {
+            printf("cannot malloc %" PRIu64 " bytes for %s\n", size, infile);
+            exit(1);
+        }
+    }
 
-            // open file, stat it and mmap it
-            snprintf(infile, sizeof(infile), "table/%02x/%02x.bin", i, j);
+    uint64_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fdin, *buf + done, size - done);
+        if (n <= 0) {
+            printf("cannot read file %s\n", infile);
+            exit(1);
+        }
+        done += n;
+    }
 
-            fdin = open(infile, O_RDONLY);
-            if (fdin <= 0) {
-                printf("cannot open file %s\n", infile);
-                exit(1);
-            }
+    close(fdin);
+    return size;
+}
 
-            if (fstat(fdin, &filestat)) {
-                printf("cannot stat file %s\n", infile);
-                exit(1);
-            }
+// sort the buckets of each shard and write them one after the other to sorted/XX.bin
+static void *sorttable(void *dd) {
+    (void)dd;
+    char infile[64];
+    char outfile[64];
+    unsigned char *table = NULL;
+    uint64_t tablesize = 0;
 
-            data = mmap((caddr_t)0, filestat.st_size, PROT_READ, MAP_PRIVATE, fdin, 0);
-            if (data == MAP_FAILED) {
-                printf("cannot mmap file %s\n", infile);
-                exit(1);
-            }
+    int i;
+    while ((i = __atomic_fetch_add(&nextshard, 1, __ATOMIC_RELAXED)) < 0x100) {
 
-            // copy data into table
-            memcpy(table, data, filestat.st_size);
+        snprintf(outfile, sizeof(outfile), HT2C2_SHARDFILE, "sorted", i);
+        int fdout = open(outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fdout <= 0) {
+            printf("cannot create outfile %s\n", outfile);
+            exit(1);
+        }
 
-            uint64_t numentries = filestat.st_size / DATASIZE;
+        // loop over all second byte values
+        for (int j = 0; j < 0x100; j++) {
 
-            // unmap file and close it
-            if (munmap(data, filestat.st_size)) {
-                printf("cannot munmap %s\n", infile);
-                exit(1);
-            }
+            printf("sorttable: processing bytes 0x%02x/0x%02x\n", i, j);
+
+            snprintf(infile, sizeof(infile), HT2C2_BUCKETFILE, "table", i, j);
 
-            close(fdin);
+            uint64_t numentries = 0;
+            bool exists = (access(infile, F_OK) == 0);
+            if (exists) {
+                numentries = readfile(infile, &table, &tablesize) / DATASIZE;
+            }
 
             // sort it
             qsort(table, numentries, DATASIZE, datacmp);
 
-            // write to file
-            snprintf(outfile, sizeof(outfile), "sorted/%02x/%02x.bin", i, j);
-            fdout = open(outfile, O_WRONLY | O_CREAT, 0644);
-            if (fdout <= 0) {
-                printf("cannot create outfile %s\n", outfile);
-                exit(1);
-            }
+            // append to the shard
             if (write(fdout, table, numentries * DATASIZE) != (numentries * DATASIZE)) {
                 printf("writetable cannot write all of the data\n");
                 exit(1);
             }
-            close(fdout);
+            bucketcount[(i << 8) | j] = numentries;
 
-            // remove input file
-            if (unlink(infile)) {
+            // remove input file, empty ones too
+            if (exists && unlink(infile)) {
                 printf("cannot remove file %s\n", infile);
                 exit(1);
             }
         }
+        close(fdout);
+    }
+
+    free(table);
+    return NULL;
+}
+
+// convert a legacy sorted/XX/YY.bin table into shards, the bucket files are left in place
+static void *converttable(void *dd) {
+    (void)dd;
+    char infile[64];
+    char outfile[64];
+    unsigned char *table = NULL;
+    uint64_t tablesize = 0;
+
+    int i;
+    while ((i = __atomic_fetch_add(&nextshard, 1, __ATOMIC_RELAXED)) < 0x100) {
+
+        printf("converttable: processing shard 0x%02x\n", i);
+
+        snprintf(outfile, sizeof(outfile), HT2C2_SHARDFILE, "sorted", i);
+        int fdout = open(outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fdout <= 0) {
+            printf("cannot create outfile %s\n", outfile);
+            exit(1);
+        }
+
+        for (int j = 0; j < 0x100; j++) {
+            snprintf(infile, sizeof(infile), HT2C2_BUCKETFILE, "sorted", i, j);
+            uint64_t size = readfile(infile, &table, &tablesize);
+            if (write(fdout, table, size) != size) {
+                printf("cannot write all of the data to %s\n", outfile);
+                exit(1);
+            }
+            bucketcount[(i << 8) | j] = size / DATASIZE;
+        }
+        close(fdout);
     }
 
+    free(table);
     return NULL;
 }
 
+static void runthreads(int n, void *(*fn)(void *), const char *name) {
+    pthread_t *threads = calloc(n, sizeof(pthread_t));
+    if (threads == NULL) {
+        printf("calloc failed\n");
+        exit(1);
+    }
+
+    for (long i = 0; i < n; i++) {
+        int ret = pthread_create(&(threads[i]), NULL, fn, (void *)(i));
+        if (ret) {
+            printf("cannot start %s thread %ld\n", name, i);
+            exit(1);
+        }
+    }
+
+    if (debug) printf("main, started %s threads\n", name);
+
+    // wait for threads to finish
+    for (long i = 0; i < n; i++) {
+        int ret = pthread_join(threads[i], NULL);
+        if (ret) {
+            printf("cannot join %s thread %ld\n", name, i);
+            exit(1);
+        }
+        printf("%s thread %ld finished\n", name, i);
+    }
+    free(threads);
+}
+
+static void usage(void) {
+    printf("ht2crack2buildtable - builds the sorted ht2crack2 table in ./sorted\n\n");
+    printf(" -m MB         RAM for the bucket buffers (defaults to 3/4 of physical RAM)\n");
+    printf(" -b THREADS    build threads (defaults to number of cores)\n");
+    printf(" -s THREADS    sort threads (defaults to number of cores)\n");
+    printf(" -c            convert an existing legacy sorted/XX/YY.bin table to shards\n");
+    printf(" -n BITS       log2 of the number of entries (defaults to 37, lower for testing only)\n");
+    exit(1);
+}
+
+// size the defaults from the machine we are running on
+static void setdefaults(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 0) {
+        build_threads = cores;
+        sort_threads = cores;
+    }
+
+#ifdef _SC_PHYS_PAGES
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long pagesize = sysconf(_SC_PAGE_SIZE);
+    if (pages > 0 && pagesize > 0) {
+        datamax = ((uint64_t)pages * pagesize / 4 * 3) / HT2C2_BUCKETS;
+    }
+#endif
+}
+
 int main(int argc, char *argv[]) {
-    pthread_t threads[NUM_BUILD_THREADS];
-    void *status;
+    int c;
+    bool convert = false;
+
+    setdefaults();
+
+    while ((c = getopt(argc, argv, "m:b:s:n:ch")) != -1) {
+        switch (c) {
+            case 'm':
+                datamax = (strtoull(optarg, NULL, 0) << 20) / HT2C2_BUCKETS;
+                break;
+            case 'b':
+                build_threads = atoi(optarg);
+                break;
+            case 's':
+                sort_threads = atoi(optarg);
+                break;
+            case 'n':
+                entrybits = atoi(optarg);
+                break;
+            case 'c':
+                convert = true;
+                break;
+            case 'h':
+            default:
+                usage();
+        }
+    }
+
+    // whole entries only, store() fills the buffer exactly up to datamax
+    datamax -= datamax % DATASIZE;
+
+    if (datamax < DATASIZE || build_threads < 1 || sort_threads < 1 || entrybits < 1 || entrybits > 37) {
+        usage();
+    }
+
+    bucketcount = calloc(HT2C2_BUCKETS, sizeof(uint64_t));
+    if (bucketcount == NULL) {
+        printf("calloc failed\n");
+        exit(1);
+    }
+
+    if (convert) {
+        runthreads(sort_threads, converttable, "converttable");
+        if (!ht2c2_write_index("sorted", bucketcount)) {
+            exit(1);
+        }
+        free(bucketcount);
+        return 0;
+    }
+
+    printf("bucket buffers %" PRIu64 " bytes ( %" PRIu64 " MB total ), %d build / %d sort threads\n",
+           datamax, (datamax * HT2C2_BUCKETS) >> 20, build_threads, sort_threads);
 
     // make the table of tables
     t = (struct table *)calloc(sizeof(struct table) * 65536, sizeof(uint8_t));
@@ -464,31 +604,12 @@ int main(int argc, char *argv[]) {
     makedirs();
 
     // build the jump table for incremental steps
-    builddi(2048 * NUM_BUILD_THREADS, 1);
+    builddi(2048 * build_threads, 1);
 
     // build the jump table for setting the offset
     builddi(2048, 2);
 
-    // start the threads
-    for (long i = 0; i < NUM_BUILD_THREADS; i++) {
-        int ret = pthread_create(&(threads[i]), NULL, buildtable, (void *)(i));
-        if (ret) {
-            printf("cannot start buildtable thread %ld\n", i);
-            exit(1);
-        }
-    }
-
-    if (debug) printf("main, started buildtable threads\n");
-
-    // wait for threads to finish
-    for (long i = 0; i < NUM_BUILD_THREADS; i++) {
-        int ret = pthread_join(threads[i], &status);
-        if (ret) {
-            printf("cannot join buildtable thread %ld\n", i);
-            exit(1);
-        }
-        printf("buildtable thread %ld finished\n", i);
-    }
+    runthreads(build_threads, buildtable, "buildtable");
 
     // write all remaining files
     for (long i = 0; i < 0x10000; i++) {
@@ -503,33 +624,12 @@ int main(int argc, char *argv[]) {
     free(t);
 
     // now for the sorting
+    runthreads(sort_threads, sorttable, "sorttable");
 
-    // start the threads
-    for (long i = 0; i < NUM_SORT_THREADS; i++) {
-        int ret = pthread_create(&(threads[i]), NULL, sorttable, (void *)(i));
-        if (ret) {
-            printf("cannot start sorttable thread %ld\n", i);
-            exit(1);
-        }
-    }
-
-    if (debug) printf("main, started sorttable threads\n");
-
-    // wait for threads to finish
-    for (long i = 0; i < NUM_SORT_THREADS; i++) {
-        int ret = pthread_join(threads[i], &status);
-        if (ret) {
-            printf("cannot join sorttable thread %ld\n", i);
-            exit(1);
-        }
-        printf("sorttable thread %ld finished\n", i);
+    if (!ht2c2_write_index("sorted", bucketcount)) {
+        exit(1);
     }
-
-    pthread_exit(NULL);
+    free(bucketcount);
 
     return 0;
 }
-
-
-
-
@@ -5,9 +5,10 @@
  */
 
 #include "ht2crackutils.h"
+#include "ht2crack2table.h"
+#include <getopt.h>
 
-#define INPUTFILE "sorted/%02x/%02x.bin"
-#define DATASIZE 10
+static ht2c2_table_t table;
 
 struct rngdata {
     unsigned char *data;
@@ -153,12 +154,10 @@ static int testcand(const unsigned char *f, unsigned char *rt, int fwd) {
 }
 
 static int searchcand(unsigned char *c, unsigned char *rt, int fwd, unsigned char *m, unsigned char *s) {
-    int fd;
-    struct stat filestat;
-    char file[64];
-    unsigned char *data;
+    const unsigned char *data;
+    uint64_t count;
     unsigned char item[10];
-    unsigned char *found = NULL;
+    const unsigned char *found = NULL;
 
 
     if (!c || !rt || !m || !s) {
@@ -166,28 +165,11 @@ static int searchcand(unsigned char *c, unsigned char *rt, int fwd, unsigned cha
         return 0;
     }
 
-    snprintf(file, sizeof(file), INPUTFILE, c[0], c[1]);
-
-    fd = open(file, O_RDONLY);
-    if (fd <= 0) {
-        printf("cannot open table file %s\n", file);
-        exit(1);
-    }
-
-    if (fstat(fd, &filestat)) {
-        printf("cannot stat file %s\n", file);
-        exit(1);
-    }
-
-    data = mmap((caddr_t)0, filestat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-    if (data == MAP_FAILED) {
-        printf("cannot mmap file %s\n", file);
-        exit(1);
-    }
+    data = ht2c2_bucket(&table, c[0], c[1], &count);
 
     memcpy(item, c + 2, 4);
 
-    found = (unsigned char *)bsearch(item, data, filestat.st_size / DATASIZE, DATASIZE, datacmp);
+    found = (const unsigned char *)bsearch(item, data, count, DATASIZE, datacmp);
 
     if (found) {
 
@@ -198,14 +180,11 @@ static int searchcand(unsigned char *c, unsigned char *rt, int fwd, unsigned cha
         }
 
         // now test all matches
-        while (((found - data) <= (filestat.st_size - DATASIZE)) && (!memcmp(found, item, 4))) {
+        while (((found - data) <= ((count - 1) * DATASIZE)) && (!memcmp(found, item, 4))) {
             if (testcand(found, rt, fwd)) {
                 memcpy(m, c, 2);
                 memcpy(m + 2, found, 4);
                 memcpy(s, found + 4, 6);
-
-                munmap(data, filestat.st_size);
-                close(fd);
                 return 1;
             }
 
@@ -213,9 +192,6 @@ static int searchcand(unsigned char *c, unsigned char *rt, int fwd, unsigned cha
         }
     }
 
-    munmap(data, filestat.st_size);
-    close(fd);
-
     return 0;
 
 }
@@ -360,10 +336,25 @@ int main(int argc, char *argv[]) {
     char *nRstr;
     uint64_t keyrev;
     uint64_t key;
+    const char *tabledir = "sorted";
     int i;
 
+    while ((i = getopt(argc, argv, "d:h")) != -1) {
+        switch (i) {
+            case 'd':
+                tabledir = optarg;
+                break;
+            case 'h':
+            default:
+                printf("%s [-d tabledir] rngdatafile UID nR\n", argv[0]);
+                exit(1);
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
     if (argc < 4) {
-        printf("%s rngdatafile UID nR\n", argv[0]);
+        printf("%s [-d tabledir] rngdatafile UID nR\n", argv[0]);
         exit(1);
     }
 
@@ -384,11 +375,17 @@ int main(int argc, char *argv[]) {
         nRstr = argv[3];
     }
 
+    if (!ht2c2_open(&table, tabledir)) {
+        printf("cannot open table %s\n", tabledir);
+        exit(1);
+    }
+
 
     if (!findmatch(&rng, rngmatch, rngstate, &bitoffset)) {
         printf("couldn't find a match\n");
         exit(1);
     }
+    ht2c2_close(&table);
 
     printf("found match:\n");
     printf("rngmatch = %02x %02x %02x %02x %02x %02x\n", rngmatch[0], rngmatch[1], rngmatch[2], rngmatch[3], rngmatch[4], rngmatch[5]);
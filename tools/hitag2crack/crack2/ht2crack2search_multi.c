@@ -9,19 +9,26 @@
  * rather we can put each file to search in each thread instead. Come up with ways to make it faster!
  *
  * When testing remember OS cache fiddles with your mind and results. Running same test values will be much faster second run
+ *
+ * The table is opened once and shared by all threads, see ht2crack2table.h.  Threads take the next keystream bit
+ * offset from a shared cursor so a slow probe (cold pages) on one thread doesn't hold back the others.
  */
 
 #include "ht2crackutils.h"
+#include "ht2crack2table.h"
 #include <pthread.h>
 #include <stdbool.h>
 #include <strings.h>
+#include <getopt.h>
 
 // a global mutex to prevent interlaced printing from different threads
 pthread_mutex_t print_lock;
 
 static int global_found = 0;
 static int thread_count = 2;
+static int g_next_bitoffset = 0;
 static int g_bitoffset = 0;
+static ht2c2_table_t g_table;
 static uint8_t g_rngmatch[6];
 static uint8_t g_rngstate[6];
 
@@ -42,9 +49,6 @@ typedef struct thread_args {
 #define _YELLOW_(s)     "\x1b[33m" s AEND
 #define _CYAN_(s)       "\x1b[36m" s AEND
 
-#define INPUTFILE       "sorted/%02x/%02x.bin"
-#define DATASIZE        10
-
 static void print_hex(const uint8_t *data, const size_t len) {
     if (data == NULL || len == 0) return;
 
@@ -198,34 +202,15 @@ static int searchcand(unsigned char *c, unsigned char *rt, int fwd, unsigned cha
         return 0;
     }
 
-    char file[64];
-    unsigned char *data;
+    uint64_t count;
     unsigned char item[10];
-    unsigned char *found = NULL;
-
-    snprintf(file, sizeof(file), INPUTFILE, c[0], c[1]);
+    const unsigned char *found = NULL;
 
-    int fd = open(file, O_RDONLY);
-    if (fd <= 0) {
-        printf("cannot open table file %s\n", file);
-        exit(1);
-    }
-
-    struct stat filestat;
-    if (fstat(fd, &filestat)) {
-        printf("cannot stat file %s\n", file);
-        exit(1);
-    }
-
-    data = mmap((caddr_t)0, filestat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-    if (data == MAP_FAILED) {
-        printf("cannot mmap file %s\n", file);
-        exit(1);
-    }
+    const unsigned char *data = ht2c2_bucket(&g_table, c[0], c[1], &count);
 
     memcpy(item, c + 2, 4);
 
-    found = (unsigned char *)bsearch(item, data, filestat.st_size / DATASIZE, DATASIZE, datacmp);
+    found = (const unsigned char *)bsearch(item, data, count, DATASIZE, datacmp);
 
     if (found) {
 
@@ -236,14 +221,11 @@ static int searchcand(unsigned char *c, unsigned char *rt, int fwd, unsigned cha
         }
 
         // now test all matches
-        while (((found - data) <= (filestat.st_size - DATASIZE)) && (!memcmp(found, item, 4))) {
+        while (((found - data) <= ((count - 1) * DATASIZE)) && (!memcmp(found, item, 4))) {
             if (testcand(found, rt, fwd)) {
                 memcpy(m, c, 2);
                 memcpy(m + 2, found, 4);
                 memcpy(s, found + 4, 6);
-
-                munmap(data, filestat.st_size);
-                close(fd);
                 return 1;
             }
 
@@ -251,9 +233,6 @@ static int searchcand(unsigned char *c, unsigned char *rt, int fwd, unsigned cha
         }
     }
 
-    munmap(data, filestat.st_size);
-    close(fd);
-
     return 0;
 
 }
@@ -269,7 +248,12 @@ static void *brute_thread(void *arguments) {
 
     int bitlen = (r.len * 8);
 
-    for (int i = args->idx; i <= bitlen - 48; i += thread_count) {
+    while (1) {
+
+        int i = __atomic_fetch_add(&g_next_bitoffset, 1, __ATOMIC_RELAXED);
+        if (i > bitlen - 48) {
+            break;
+        }
 
         // print progress
         if ((i % 100) == 0) {
@@ -319,10 +303,15 @@ static void *brute_thread(void *arguments) {
         uint8_t l_match[6] ;
         uint8_t l_state[6] ;
         if (searchcand(l_cand, l_rngtest, fwd, l_match, l_state)) {
-            __sync_fetch_and_add(&global_found, 1);
-            __sync_fetch_and_add(&g_bitoffset, i);
-            memcpy(g_rngmatch, l_match, sizeof(l_match));
-            memcpy(g_rngstate, l_state, sizeof(l_state));
+            // first thread to find a match wins
+            pthread_mutex_lock(&print_lock);
+            if (global_found == 0) {
+                g_bitoffset = i;
+                memcpy(g_rngmatch, l_match, sizeof(l_match));
+                memcpy(g_rngstate, l_state, sizeof(l_state));
+                __atomic_store_n(&global_found, 1, __ATOMIC_RELEASE);
+            }
+            pthread_mutex_unlock(&print_lock);
             break;
         }
     }
@@ -412,11 +401,43 @@ static uint64_t recoverkey(Hitag_State *hstate, char *uidstr, char *nRstr) {
 }
 
 
+static void usage(const char *name) {
+    printf("%s [-d tabledir] [-t threads] rngdatafile UID nR\n", name);
+    exit(1);
+}
+
 int main(int argc, char *argv[]) {
 
+    const char *tabledir = "sorted";
+    int opt;
+
+#if !defined(_WIN32) || !defined(__WIN32__)
+    thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (thread_count < 2)
+        thread_count = 2;
+#endif  /* _WIN32 */
+
+    while ((opt = getopt(argc, argv, "d:t:h")) != -1) {
+        switch (opt) {
+            case 'd':
+                tabledir = optarg;
+                break;
+            case 't':
+                thread_count = atoi(optarg);
+                if (thread_count < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'h':
+            default:
+                usage(argv[0]);
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
     if (argc < 4) {
-        printf("%s rngdatafile UID nR\n", argv[0]);
-        exit(1);
+        usage(argv[0]);
     }
 
     rngdata_t rng;
@@ -439,11 +460,10 @@ int main(int argc, char *argv[]) {
         nRstr = argv[3];
     }
 
-#if !defined(_WIN32) || !defined(__WIN32__)
-    thread_count = sysconf(_SC_NPROCESSORS_CONF);
-    if (thread_count < 2)
-        thread_count = 2;
-#endif  /* _WIN32 */
+    if (!ht2c2_open(&g_table, tabledir)) {
+        printf("cannot open table %s\n", tabledir);
+        exit(1);
+    }
 
     printf("\nBruteforce using " _YELLOW_("%d") " threads\n", thread_count);
 
@@ -514,6 +534,7 @@ int main(int argc, char *argv[]) {
     }
     // clean up mutex
     pthread_mutex_destroy(&print_lock);
+    ht2c2_close(&g_table);
 
     free(rng.data);
     return 0;
@@ -0,0 +1,189 @@
+/*
+ * ht2crack2table.c
+ * Access to the sorted ht2crack2 table, see ht2crack2table.h
+ */
+
+#include "ht2crack2table.h"
+#include "ht2crackutils.h"
+
+static int loadindex(ht2c2_table_t *t, const char *file) {
+    FILE *fp = fopen(file, "rb");
+    if (!fp) {
+        return 0;
+    }
+
+    ht2c2_index_hdr_t hdr;
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+            memcmp(hdr.magic, HT2C2_INDEX_MAGIC, sizeof(hdr.magic)) ||
+            hdr.version != HT2C2_INDEX_VERSION ||
+            hdr.datasize != DATASIZE) {
+        printf("invalid table index %s\n", file);
+        fclose(fp);
+        return 0;
+    }
+
+    if (fread(t->count, sizeof(uint64_t), HT2C2_BUCKETS, fp) != HT2C2_BUCKETS) {
+        printf("truncated table index %s\n", file);
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+
+    // bucket offsets restart at every shard
+    for (int i = 0; i < HT2C2_BUCKETS; i++) {
+        t->start[i] = ((i & 0xff) == 0) ? 0 : t->start[i - 1] + t->count[i - 1];
+    }
+    return 1;
+}
+
+int ht2c2_open(ht2c2_table_t *t, const char *dir) {
+    char file[300];
+
+    if (!t || !dir) {
+        printf("ht2c2_open: invalid params\n");
+        return 0;
+    }
+
+    memset(t, 0, sizeof(ht2c2_table_t));
+    snprintf(t->dir, sizeof(t->dir), "%s", dir);
+
+    t->start = calloc(HT2C2_BUCKETS, sizeof(uint64_t));
+    t->count = calloc(HT2C2_BUCKETS, sizeof(uint64_t));
+    if (!t->start || !t->count) {
+        printf("ht2c2_open: cannot calloc\n");
+        exit(1);
+    }
+
+    snprintf(file, sizeof(file), HT2C2_INDEXFILE, dir);
+    if (access(file, R_OK) == 0) {
+        if (!loadindex(t, file)) {
+            return 0;
+        }
+        t->sharded = true;
+    }
+
+    t->maps = calloc(t->sharded ? HT2C2_SHARDS : HT2C2_BUCKETS, sizeof(ht2c2_map_t));
+    if (!t->maps) {
+        printf("ht2c2_open: cannot calloc\n");
+        exit(1);
+    }
+
+    if (pthread_mutex_init(&t->lock, NULL)) {
+        printf("ht2c2_open: cannot init mutex\n");
+        exit(1);
+    }
+
+    printf("table %s, %s layout\n", dir, t->sharded ? "sharded" : "legacy");
+    return 1;
+}
+
+static void mapfile(ht2c2_map_t *m, const char *file) {
+    struct stat filestat;
+
+    int fd = open(file, O_RDONLY);
+    if (fd <= 0) {
+        printf("cannot open table file %s\n", file);
+        exit(1);
+    }
+
+    if (fstat(fd, &filestat)) {
+        printf("cannot stat file %s\n", file);
+        exit(1);
+    }
+
+    // keep an empty bucket distinguishable from an unmapped one
+    if (filestat.st_size == 0) {
+        m->data = (uint8_t *)"";
+        m->size = 0;
+        close(fd);
+        return;
+    }
+
+    uint8_t *data = mmap((caddr_t)0, filestat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        printf("cannot mmap file %s\n", file);
+        exit(1);
+    }
+    close(fd);
+
+    // probes are bsearches, read ahead only pulls in pages we never look at
+    madvise(data, filestat.st_size, MADV_RANDOM);
+
+    m->size = filestat.st_size;
+    __atomic_store_n(&m->data, data, __ATOMIC_RELEASE);
+}
+
+const uint8_t *ht2c2_bucket(ht2c2_table_t *t, uint8_t b0, uint8_t b1, uint64_t *count) {
+    char file[300];
+
+    int idx = (t->sharded) ? b0 : (b0 << 8) | b1;
+    ht2c2_map_t *m = t->maps + idx;
+
+    if (__atomic_load_n(&m->data, __ATOMIC_ACQUIRE) == NULL) {
+        pthread_mutex_lock(&t->lock);
+        if (m->data == NULL) {
+            if (t->sharded) {
+                snprintf(file, sizeof(file), HT2C2_SHARDFILE, t->dir, b0);
+            } else {
+                snprintf(file, sizeof(file), HT2C2_BUCKETFILE, t->dir, b0, b1);
+            }
+            mapfile(m, file);
+        }
+        pthread_mutex_unlock(&t->lock);
+    }
+
+    if (t->sharded == false) {
+        *count = m->size / DATASIZE;
+        return m->data;
+    }
+
+    int bucket = (b0 << 8) | b1;
+    if ((t->start[bucket] + t->count[bucket]) * DATASIZE > m->size) {
+        printf("shard %02x is shorter than its index\n", b0);
+        exit(1);
+    }
+
+    *count = t->count[bucket];
+    return m->data + (t->start[bucket] * DATASIZE);
+}
+
+void ht2c2_close(ht2c2_table_t *t) {
+    int n = t->sharded ? HT2C2_SHARDS : HT2C2_BUCKETS;
+    for (int i = 0; t->maps && i < n; i++) {
+        if (t->maps[i].size) {
+            munmap(t->maps[i].data, t->maps[i].size);
+        }
+    }
+    free(t->maps);
+    free(t->start);
+    free(t->count);
+    pthread_mutex_destroy(&t->lock);
+    memset(t, 0, sizeof(ht2c2_table_t));
+}
+
+int ht2c2_write_index(const char *dir, const uint64_t *count) {
+    char file[300];
+    ht2c2_index_hdr_t hdr;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, HT2C2_INDEX_MAGIC, sizeof(hdr.magic));
+    hdr.version = HT2C2_INDEX_VERSION;
+    hdr.datasize = DATASIZE;
+
+    snprintf(file, sizeof(file), HT2C2_INDEXFILE, dir);
+    FILE *fp = fopen(file, "wb");
+    if (!fp) {
+        printf("cannot create index %s\n", file);
+        return 0;
+    }
+
+    if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+            fwrite(count, sizeof(uint64_t), HT2C2_BUCKETS, fp) != HT2C2_BUCKETS) {
+        printf("cannot write index %s\n", file);
+        fclose(fp);
+        return 0;
+    }
+
+    fclose(fp);
+    return 1;
+}
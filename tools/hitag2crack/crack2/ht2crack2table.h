@@ -0,0 +1,75 @@
+/*
+ * ht2crack2table.h
+ * Access to the sorted ht2crack2 table.
+ *
+ * The table holds 2^37 entries of DATASIZE bytes: 4 bytes of keystream and
+ * 6 bytes of PRNG state.  The first 2 keystream bytes are not stored, they
+ * select one of 65536 buckets instead.
+ *
+ * Two on-disk layouts are supported:
+ *
+ *  - legacy:  sorted/XX/YY.bin, one file per bucket
+ *  - sharded: sorted/XX.bin, the 256 buckets XX/00..XX/ff concatenated,
+ *             plus sorted/index.bin holding the entry count of every bucket
+ *
+ * The sharded layout lets a search mmap each shard once and only fault in
+ * the pages that the bsearch actually touches, instead of open/mmap/munmap
+ * of a bucket file per probe.
+ */
+
+#ifndef HT2CRACK2TABLE_H
+#define HT2CRACK2TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define DATASIZE            10
+#define HT2C2_BUCKETS       0x10000
+#define HT2C2_SHARDS        0x100
+
+#define HT2C2_INDEX_MAGIC   "HT2C2IDX"
+#define HT2C2_INDEX_VERSION 1
+#define HT2C2_INDEXFILE     "%s/index.bin"
+#define HT2C2_SHARDFILE     "%s/%02x.bin"
+#define HT2C2_BUCKETFILE    "%s/%02x/%02x.bin"
+
+// on-disk index header, followed by HT2C2_BUCKETS uint64_t entry counts (host byte order)
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t datasize;
+} ht2c2_index_hdr_t;
+
+typedef struct {
+    uint8_t *data;
+    uint64_t size;
+} ht2c2_map_t;
+
+typedef struct {
+    char dir[256];
+    bool sharded;
+
+    // sharded: entry offset within its shard and entry count of each bucket
+    uint64_t *start;
+    uint64_t *count;
+
+    // mappings are created on first use and kept until ht2c2_close
+    pthread_mutex_t lock;
+    ht2c2_map_t *maps;      // HT2C2_SHARDS (sharded) or HT2C2_BUCKETS (legacy)
+} ht2c2_table_t;
+
+// Opens the table in dir, the sharded layout is used when dir/index.bin exists.
+// Returns 1 on success.
+int ht2c2_open(ht2c2_table_t *t, const char *dir);
+
+// Returns the sorted entries of bucket b0/b1 and their number in *count.
+// Safe to call from several threads.
+const uint8_t *ht2c2_bucket(ht2c2_table_t *t, uint8_t b0, uint8_t b1, uint64_t *count);
+
+void ht2c2_close(ht2c2_table_t *t);
+
+// Writes dir/index.bin from the per bucket entry counts.
+int ht2c2_write_index(const char *dir, const uint64_t *count);
+
+#endif /* HT2CRACK2TABLE_H */
@@ -0,0 +1,322 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Bitsliced Crypto1 key filter, portable backends, dispatcher and self test.
+//-----------------------------------------------------------------------------
+
+#define __STDC_FORMAT_MACROS
+
+#include "crypto1_bs.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "crypto1_bs_x86.h"
+#include "crapto1/crapto1.h"
+#include "util_posix.h"
+
+#define AEND  "\x1b[0m"
+#define _RED_(s) "\x1b[31m" s AEND
+#define _GREEN_(s) "\x1b[32m" s AEND
+#define _YELLOW_(s) "\x1b[33m" s AEND
+
+#define C1_BS_T         uint64_t
+#define C1_BS_WORDS     1
+#define C1_BS_ANY(x)    ((x) != 0)
+#define C1_BS_FN        crypto1_bs_match_64
+#include "crypto1_bs_kernel.h"
+#undef C1_BS_T
+#undef C1_BS_WORDS
+#undef C1_BS_ANY
+#undef C1_BS_FN
+
+static const crypto1_bs_backend_t backend_u64 = {
+    .width = 64,
+    .words = 1,
+    .name  = "u64",
+    .match = crypto1_bs_match_64,
+};
+
+#if defined(__aarch64__)
+// ARM64 always has NEON, a 128 bit GCC vector type maps straight onto it
+typedef uint64_t c1_bs128_t __attribute__((vector_size(16)));
+
+#define C1_BS_T         c1_bs128_t
+#define C1_BS_WORDS     2
+#define C1_BS_ANY(x)    (((x)[0] | (x)[1]) != 0)
+#define C1_BS_FN        crypto1_bs_match_128
+#include "crypto1_bs_kernel.h"
+
+static const crypto1_bs_backend_t backend_neon = {
+    .width = 128,
+    .words = 2,
+    .name  = "NEON",
+    .match = crypto1_bs_match_128,
+};
+#endif
+
+static const crypto1_bs_backend_t backend_avx2 = {
+    .width = 256,
+    .words = 4,
+    .name  = "AVX2",
+    .match = crypto1_bs_match_256,
+};
+
+static const crypto1_bs_backend_t backend_avx512 = {
+    .width = 512,
+    .words = 8,
+    .name  = "AVX512",
+    .match = crypto1_bs_match_512,
+};
+
+const crypto1_bs_backend_t *crypto1_bs_best_backend(void) {
+    static const crypto1_bs_backend_t *cached = NULL;
+    if (cached != NULL) {
+        return cached;
+    }
+
+    if (crypto1_bs_avx512_supported()) {
+        cached = &backend_avx512;
+    } else if (crypto1_bs_avx2_supported()) {
+        cached = &backend_avx2;
+    } else {
+#if defined(__aarch64__)
+        cached = &backend_neon;
+#else
+        cached = &backend_u64;
+#endif
+    }
+    return cached;
+}
+
+// Classic 64x64 bit matrix transpose. Row r of the input is key r, after the
+// transpose row b holds bit b of every key.
+static void crypto1_bs_transpose64(const uint64_t *keys, uint32_t n, uint64_t planes[48]) {
+    uint64_t m[64] = {0};
+    if (n > 64) {
+        n = 64;
+    }
+    memcpy(m, keys, n * sizeof(uint64_t));
+
+    uint64_t mask = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, mask ^= (mask << j)) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            const uint64_t t = ((m[k] >> j) ^ m[k | j]) & mask;
+            m[k] ^= t << j;
+            m[k | j] ^= t;
+        }
+    }
+    memcpy(planes, m, 48 * sizeof(uint64_t));
+}
+
+uint32_t crypto1_bs_filter(const crypto1_bs_backend_t *be, const uint64_t *keys, uint32_t n,
+                           const crypto1_bs_job_t *job, uint32_t *survivors) {
+
+    // vector lanes need their natural alignment
+    uint64_t kb[48 * CRYPTO1_BS_MAX_WORDS] __attribute__((aligned(64)));
+    uint64_t match[CRYPTO1_BS_MAX_WORDS] __attribute__((aligned(64)));
+    uint64_t planes[48];
+    uint32_t found = 0;
+
+    for (uint32_t base = 0; base < n; base += be->width) {
+
+        uint32_t cnt = n - base;
+        if (cnt > (uint32_t)be->width) {
+            cnt = be->width;
+        }
+
+        for (int w = 0; w < be->words; w++) {
+            uint32_t start = w * 64;
+            uint32_t wcnt = (cnt > start) ? cnt - start : 0;
+            crypto1_bs_transpose64(keys + base + start, wcnt, planes);
+            for (int b = 0; b < 48; b++) {
+                kb[b * be->words + w] = planes[b];
+            }
+        }
+
+        be->match(kb, job, match);
+
+        for (int w = 0; w < be->words; w++) {
+            uint64_t m = match[w];
+            while (m) {
+                uint32_t lane = (w * 64) + __builtin_ctzll(m);
+                m &= m - 1;
+                // padding lanes are all-zero keys
+                if (lane < cnt) {
+                    survivors[found++] = base + lane;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+// parity error bit of encrypted nt byte k given the nt keystream word. The
+// byte's keystream parity xor the first keystream bit of the next byte.
+static uint16_t crypto1_bs_nt_par_err(uint32_t ks, int k) {
+    return __builtin_parity((ks >> (24 - (8 * k))) & 0xFF) ^ ((ks >> (16 - (8 * k))) & 1);
+}
+
+// scalar reference of the filter
+static bool crypto1_bs_check_scalar(uint64_t key, const crypto1_bs_job_t *job) {
+    struct Crypto1State *pcs = crypto1_create(key);
+    if (pcs == NULL) {
+        return false;
+    }
+
+    uint32_t ks = crypto1_word(pcs, job->nt_enc ^ job->uid, job->is_nt_encrypted);
+    crypto1_word(pcs, job->nr_enc, 1);
+    crypto1_word(pcs, 0, 0);
+    crypto1_word(pcs, 0, 0);
+    uint8_t dec = crypto1_byte(pcs, 0x00, 0) ^ job->enc0;
+    crypto1_destroy(pcs);
+
+    if (job->check_nt_par) {
+        for (int k = 0; k < 3; k++) {
+            if (crypto1_bs_nt_par_err(ks, k) != ((job->nt_par_err >> (12 - (4 * k))) & 1)) {
+                return false;
+            }
+        }
+    }
+
+    for (int i = 0; i < job->accept_len; i++) {
+        if (dec == job->accept[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t xorshift64(uint64_t *x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+int crypto1_bs_selftest(bool bench) {
+
+    static const uint8_t accept[] = { 0x30, 0xA0, 0x60, 0x61, 0xC0, 0xC1, 0xC2, 0xB0 };
+
+    const crypto1_bs_backend_t *backends[] = {
+        &backend_u64,
+#if defined(__aarch64__)
+        &backend_neon,
+#endif
+        &backend_avx2,
+        &backend_avx512,
+    };
+
+    uint64_t keys[CRYPTO1_BS_MAX_WIDTH * 4];
+    uint32_t surv[CRYPTO1_BS_MAX_WIDTH * 4];
+    const uint32_t nkeys = sizeof(keys) / sizeof(keys[0]);
+
+    uint64_t x = 0x0123456789ABULL;
+    for (uint32_t i = 0; i < nkeys; i++) {
+        keys[i] = xorshift64(&x) & 0xFFFFFFFFFFFFULL;
+    }
+
+    // plant a key that decrypts the first byte to a READ and has valid nt parity
+    const uint64_t secret = 0x3B7E4FD575ADULL;
+    keys[nkeys - 7] = secret;
+
+    crypto1_bs_job_t job = {
+        .uid = 0x96519578,
+        .nt_enc = 0xD7E3C6AC,
+        .nr_enc = 0xCD311951,
+        .is_nt_encrypted = true,
+        .check_nt_par = false,
+        .accept = accept,
+        .accept_len = sizeof(accept),
+    };
+
+    struct Crypto1State *pcs = crypto1_create(secret);
+    uint32_t ks = crypto1_word(pcs, job.nt_enc ^ job.uid, 1);
+    crypto1_word(pcs, job.nr_enc, 1);
+    crypto1_word(pcs, 0, 0);
+    crypto1_word(pcs, 0, 0);
+    job.enc0 = crypto1_byte(pcs, 0x00, 0) ^ 0x30;
+    crypto1_destroy(pcs);
+
+    for (int k = 0; k < 3; k++) {
+        job.nt_par_err |= crypto1_bs_nt_par_err(ks, k) << (12 - (4 * k));
+    }
+
+    bool isok = true;
+
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        const crypto1_bs_backend_t *be = backends[i];
+        if ((be == &backend_avx2 && crypto1_bs_avx2_supported() == false) ||
+                (be == &backend_avx512 && crypto1_bs_avx512_supported() == false)) {
+            continue;
+        }
+
+        bool beok = true;
+        for (int par = 0; par < 2; par++) {
+            job.check_nt_par = par;
+
+            uint32_t n = crypto1_bs_filter(be, keys, nkeys, &job, surv);
+            uint32_t j = 0;
+            for (uint32_t k = 0; k < nkeys; k++) {
+                bool want = crypto1_bs_check_scalar(keys[k], &job);
+                bool got = (j < n && surv[j] == k);
+                if (got) {
+                    j++;
+                }
+                if (want != got) {
+                    beok = false;
+                }
+            }
+        }
+        isok &= beok;
+        printf("bitslice %-6s ( %s )\n", be->name, beok ? _GREEN_("ok") : _RED_("fail"));
+    }
+
+    if (bench == false) {
+        return isok ? 0 : 1;
+    }
+
+    job.check_nt_par = false;
+
+    printf("\nbenchmark, single thread\n");
+
+    // scalar crypto1, what the tools did per key before
+    uint64_t t1 = msclock();
+    uint32_t cnt = 0;
+    for (uint32_t r = 0; r < 16; r++) {
+        for (uint32_t k = 0; k < nkeys; k++) {
+            cnt += crypto1_bs_check_scalar(keys[k] ^ r, &job);
+        }
+    }
+    t1 = msclock() - t1;
+    double scalar_rate = (double)(16 * nkeys) / (t1 ? t1 : 1) / 1000.0;
+    printf("scalar   " _YELLOW_("%8.2f") " Mkeys/s  ( %u )\n", scalar_rate, cnt);
+
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        const crypto1_bs_backend_t *be = backends[i];
+        if ((be == &backend_avx2 && crypto1_bs_avx2_supported() == false) ||
+                (be == &backend_avx512 && crypto1_bs_avx512_supported() == false)) {
+            continue;
+        }
+
+        t1 = msclock();
+        cnt = 0;
+        for (uint32_t r = 0; r < 256; r++) {
+            keys[0] ^= r;
+            cnt += crypto1_bs_filter(be, keys, nkeys, &job, surv);
+        }
+        t1 = msclock() - t1;
+        double rate = (double)(256 * nkeys) / (t1 ? t1 : 1) / 1000.0;
+        printf("%-8s " _YELLOW_("%8.2f") " Mkeys/s  x%.1f\n", be->name, rate, rate / scalar_rate);
+    }
+    printf("\n");
+    return isok ? 0 : 1;
+}
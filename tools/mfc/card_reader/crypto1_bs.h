@@ -0,0 +1,65 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Bitsliced Crypto1 key filter for the offline nested auth tools.
+//
+// Runs a nested authentication (encrypted nt, encrypted nr, ar, at) for up to
+// 512 keys at once and keeps the keys whose nt parity and first decrypted
+// byte after the auth are plausible. Survivors are few (about 1 in 32 for the
+// 8 MIFARE commands, 1 in 256 with nt parity) and must be confirmed with the
+// scalar crypto1 functions.
+//
+// Backends are picked at runtime: AVX-512 / AVX2 on x86, 128 bit NEON on
+// ARM64, plain u64 everywhere.
+//-----------------------------------------------------------------------------
+
+#ifndef CRYPTO1_BS_H__
+#define CRYPTO1_BS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CRYPTO1_BS_MAX_WIDTH    512
+#define CRYPTO1_BS_MAX_WORDS    (CRYPTO1_BS_MAX_WIDTH / 64)
+
+typedef struct {
+    uint32_t uid;
+    uint32_t nt_enc;
+    uint32_t nr_enc;
+    bool is_nt_encrypted;
+    bool check_nt_par;          // nt_par_err is known, needs is_nt_encrypted
+    uint16_t nt_par_err;        // one bit per nibble, as mf_nonce_brute takes it
+    uint8_t enc0;               // first encrypted byte after the auth
+    const uint8_t *accept;      // plausible plaintext values of that byte
+    uint8_t accept_len;
+} crypto1_bs_job_t;
+
+typedef struct {
+    int width;                  // keys per call
+    int words;                  // uint64_t per bit plane
+    const char *name;
+    // kb: 48 key bit planes of `words` uint64_t each (lane L = bit L % 64 of
+    // word L / 64). match_out receives `words` uint64_t of surviving lanes.
+    void (*match)(const uint64_t *kb, const crypto1_bs_job_t *job, uint64_t *match_out);
+} crypto1_bs_backend_t;
+
+// Widest backend the running CPU supports. Cached after first call.
+const crypto1_bs_backend_t *crypto1_bs_best_backend(void);
+
+// Runs keys[0..n) through the backend and stores the indexes of the
+// surviving keys in survivors. Returns the number of survivors.
+uint32_t crypto1_bs_filter(const crypto1_bs_backend_t *be, const uint64_t *keys, uint32_t n,
+                           const crypto1_bs_job_t *job, uint32_t *survivors);
+
+// Checks every available backend against the scalar crypto1 code, with
+// bench also measures their key rate. Returns 0 when all backends agree.
+int crypto1_bs_selftest(bool bench);
+
+#endif
@@ -0,0 +1,120 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Bitsliced Crypto1 kernel body, shared by all backends.
+//
+// Not a regular header: the including file defines
+//   C1_BS_T        lane type (uint64_t or a GCC vector type)
+//   C1_BS_WORDS    number of uint64_t per lane word
+//   C1_BS_ANY(x)   non-zero iff any lane of x is set
+//   C1_BS_FN       name of the generated match function
+// and gets a function with the crypto1_bs_backend_t match signature.
+//
+// The LFSR is kept as a sliding window: bit j of the register at step t
+// lives in s[t + j], bit 0 being the oldest, so shifting costs nothing.
+// The filter taps are the odd bits 9..47.
+//-----------------------------------------------------------------------------
+
+// the filter functions, arguments in ascending register bit order
+#define C1_BS_FA(a,b,c,d)       (((a|b)^(a&d))^(c&((a^b)|d)))
+#define C1_BS_FB(a,b,c,d)       (((a&b)|c)^((a^b)&(c|d)))
+#define C1_BS_FC(a,b,c,d,e)     ((a|((b|e)&(d^e)))^((a^(b&d))&((c^d)|(b&e))))
+
+#define C1_BS_F20(s, w) C1_BS_FC( \
+        C1_BS_FA((s)[(w) +  9], (s)[(w) + 11], (s)[(w) + 13], (s)[(w) + 15]), \
+        C1_BS_FB((s)[(w) + 17], (s)[(w) + 19], (s)[(w) + 21], (s)[(w) + 23]), \
+        C1_BS_FB((s)[(w) + 25], (s)[(w) + 27], (s)[(w) + 29], (s)[(w) + 31]), \
+        C1_BS_FA((s)[(w) + 33], (s)[(w) + 35], (s)[(w) + 37], (s)[(w) + 39]), \
+        C1_BS_FB((s)[(w) + 41], (s)[(w) + 43], (s)[(w) + 45], (s)[(w) + 47]))
+
+#define C1_BS_LFSR(s, w) ( \
+        (s)[(w) +  0] ^ (s)[(w) +  5] ^ (s)[(w) +  9] ^ (s)[(w) + 10] ^ \
+        (s)[(w) + 12] ^ (s)[(w) + 14] ^ (s)[(w) + 15] ^ (s)[(w) + 17] ^ \
+        (s)[(w) + 19] ^ (s)[(w) + 24] ^ (s)[(w) + 25] ^ (s)[(w) + 27] ^ \
+        (s)[(w) + 29] ^ (s)[(w) + 35] ^ (s)[(w) + 39] ^ (s)[(w) + 41] ^ \
+        (s)[(w) + 42] ^ (s)[(w) + 43])
+
+static void C1_BS_FN(const uint64_t *kb, const crypto1_bs_job_t *job, uint64_t *match_out) {
+
+    const C1_BS_T zero = (C1_BS_T) {0};
+    const C1_BS_T ones = ~zero;
+
+    // 48 bit key, nt + nr words, two idle words, first data byte
+    C1_BS_T s[48 + 32 + 32 + 64 + 8];
+    C1_BS_T ks[32];
+    C1_BS_T match = ones;
+
+    memset(match_out, 0, C1_BS_WORDS * sizeof(uint64_t));
+
+    // crypto1_init() order, register bit j is key bit (47 - j) ^ 7
+    for (int j = 0; j < 48; j++) {
+        memcpy(&s[j], kb + (((47 - j) ^ 7) * C1_BS_WORDS), sizeof(C1_BS_T));
+    }
+
+    // nt ^ uid, fed MSB byte first like crypto1_word()
+    const uint32_t ntin = job->nt_enc ^ job->uid;
+    for (int t = 0; t < 32; t++) {
+        ks[t] = C1_BS_F20(s, t);
+        const C1_BS_T in = ((ntin >> (t ^ 24)) & 1) ? ones : zero;
+        s[t + 48] = C1_BS_LFSR(s, t) ^ in;
+        if (job->is_nt_encrypted) {
+            s[t + 48] ^= ks[t];
+        }
+    }
+
+    // parity of the encrypted nt, each parity bit reuses the first keystream
+    // bit of the next byte. Same three bits mf_nonce_brute's xored_bits() uses.
+    if (job->check_nt_par) {
+        for (int k = 0; k < 3; k++) {
+            C1_BS_T p = ks[(8 * k) + 8];
+            for (int i = 0; i < 8; i++) {
+                p ^= ks[(8 * k) + i];
+            }
+            const C1_BS_T want = ((job->nt_par_err >> (12 - (4 * k))) & 1) ? ones : zero;
+            match &= ~(p ^ want);
+        }
+        if (C1_BS_ANY(match) == 0) {
+            return;
+        }
+    }
+
+    // encrypted nr
+    for (int t = 32; t < 64; t++) {
+        const C1_BS_T out = C1_BS_F20(s, t);
+        const C1_BS_T in = ((job->nr_enc >> ((t - 32) ^ 24)) & 1) ? ones : zero;
+        s[t + 48] = C1_BS_LFSR(s, t) ^ in ^ out;
+    }
+
+    // ar and at, no input
+    for (int t = 64; t < 128; t++) {
+        s[t + 48] = C1_BS_LFSR(s, t);
+    }
+
+    // keystream of the first byte after the auth, LSB first like crypto1_byte()
+    C1_BS_T dec[8];
+    for (int i = 0; i < 8; i++) {
+        const int t = 128 + i;
+        s[t + 48] = C1_BS_LFSR(s, t);
+        dec[i] = C1_BS_F20(s, t) ^ (((job->enc0 >> i) & 1) ? ones : zero);
+    }
+
+    // the decrypted byte has to be one of the accepted values
+    C1_BS_T any = zero;
+    for (int c = 0; c < job->accept_len; c++) {
+        C1_BS_T eq = ones;
+        for (int i = 0; i < 8; i++) {
+            eq &= ~(dec[i] ^ (((job->accept[c] >> i) & 1) ? ones : zero));
+        }
+        any |= eq;
+    }
+    match &= any;
+
+    memcpy(match_out, &match, sizeof(C1_BS_T));
+}
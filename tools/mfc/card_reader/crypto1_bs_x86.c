@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// AVX2 and AVX-512 bitsliced Crypto1. Same kernel as the u64 backend, with
+// 256 / 512 bit GCC vector types as lane word.
+//-----------------------------------------------------------------------------
+
+#include "crypto1_bs_x86.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+// ---------------- AVX2 ----------------
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+typedef uint64_t c1_bs256_t __attribute__((vector_size(32)));
+
+static inline int c1_bs256_any(c1_bs256_t v) {
+    return (v[0] | v[1] | v[2] | v[3]) != 0;
+}
+
+#define C1_BS_T         c1_bs256_t
+#define C1_BS_WORDS     4
+#define C1_BS_ANY(x)    c1_bs256_any(x)
+#define C1_BS_FN        crypto1_bs_match_256_impl
+#include "crypto1_bs_kernel.h"
+#undef C1_BS_T
+#undef C1_BS_WORDS
+#undef C1_BS_ANY
+#undef C1_BS_FN
+
+void crypto1_bs_match_256(const uint64_t *kb, const crypto1_bs_job_t *job, uint64_t *match_out) {
+    crypto1_bs_match_256_impl(kb, job, match_out);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+// ---------------- AVX-512 ----------------
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+
+typedef uint64_t c1_bs512_t __attribute__((vector_size(64)));
+
+static inline int c1_bs512_any(c1_bs512_t v) {
+    return (v[0] | v[1] | v[2] | v[3] | v[4] | v[5] | v[6] | v[7]) != 0;
+}
+
+#define C1_BS_T         c1_bs512_t
+#define C1_BS_WORDS     8
+#define C1_BS_ANY(x)    c1_bs512_any(x)
+#define C1_BS_FN        crypto1_bs_match_512_impl
+#include "crypto1_bs_kernel.h"
+
+void crypto1_bs_match_512(const uint64_t *kb, const crypto1_bs_job_t *job, uint64_t *match_out) {
+    crypto1_bs_match_512_impl(kb, job, match_out);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+bool crypto1_bs_avx2_supported(void) {
+    static int cached = -1;
+    if (cached < 0) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+        cached = 0;
+#endif
+    }
+    return cached != 0;
+}
+
+bool crypto1_bs_avx512_supported(void) {
+    static int cached = -1;
+    if (cached < 0) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx512f") ? 1 : 0;
+#else
+        cached = 0;
+#endif
+    }
+    return cached != 0;
+}
+
+#else // non-x86 build: no-op, the support checks return false.
+
+bool crypto1_bs_avx2_supported(void) { return false; }
+bool crypto1_bs_avx512_supported(void) { return false; }
+
+void crypto1_bs_match_256(const uint64_t *kb, const crypto1_bs_job_t *job, uint64_t *match_out) {
+    (void)kb;
+    (void)job;
+    memset(match_out, 0, 4 * sizeof(uint64_t));
+}
+
+void crypto1_bs_match_512(const uint64_t *kb, const crypto1_bs_job_t *job, uint64_t *match_out) {
+    (void)kb;
+    (void)job;
+    memset(match_out, 0, 8 * sizeof(uint64_t));
+}
+
+#endif
@@ -0,0 +1,28 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// AVX2 (256 wide) and AVX-512 (512 wide) bitsliced Crypto1 backends.
+//
+// On non-x86 builds the match functions are safe no-ops and the support
+// checks return false.
+//-----------------------------------------------------------------------------
+
+#ifndef CRYPTO1_BS_X86_H__
+#define CRYPTO1_BS_X86_H__
+
+#include "crypto1_bs.h"
+
+bool crypto1_bs_avx2_supported(void);
+bool crypto1_bs_avx512_supported(void);
+
+void crypto1_bs_match_256(const uint64_t *kb, const crypto1_bs_job_t *job, uint64_t *match_out);
+void crypto1_bs_match_512(const uint64_t *kb, const crypto1_bs_job_t *job, uint64_t *match_out);
+
+#endif
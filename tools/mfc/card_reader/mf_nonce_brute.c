@@ -8,7 +8,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <ctype.h>
+#include <getopt.h>
 #include "crapto1/crapto1.h"
+#include "crypto1_bs.h"
 #include "protocol.h"
 #include "iso14443crc.h"
 #include "util_posix.h"
@@ -33,6 +35,7 @@ uint32_t ar_enc = 0;  // encrypted reader response
 uint32_t at_enc = 0;  // encrypted tag response
 uint32_t cmd_enc = 0; // next encrypted command to sector
 bool is_nt_encrypted = 1;
+bool is_ev1 = false;  // nt parity of the first two bytes is not usable
 
 uint32_t nt_par_err = 0;
 uint32_t ar_par_err = 0;
@@ -136,6 +139,7 @@ static int global_found = 0;
 static int global_found_candidate = 0;
 static uint64_t global_candidate_key = 0;
 static int thread_count = 2;
+static uint32_t global_key_next = 0;
 
 static int param_getptr(const char *line, int *bg, int *en, int paramnum) {
     int i;
@@ -594,52 +598,90 @@ static void *brute_thread(void *arguments) {
 }
 
 // Bruteforce the upper 16 bits of the key
+// Keys are run through the bitsliced filter a batch at a time, only the few keys
+// with a plausible first command byte (and nt parity) are decrypted in full.
 static void *brute_key_thread(void *arguments) {
 
     struct thread_key_args *args = (struct thread_key_args *) arguments;
     uint8_t local_enc[args->enc_len];
     memcpy(local_enc, args->enc, args->enc_len);
 
-    for (uint64_t count = args->idx; count <= 0xFFFF; count += thread_count) {
+    uint8_t accept[ARRAYLEN(cmds)];
+    for (size_t i = 0; i < ARRAYLEN(cmds); i++) {
+        accept[i] = cmds[i][0];
+    }
 
-        uint64_t key = args->part_key | (count << 32);
+    crypto1_bs_job_t job = {
+        .uid = args->uid,
+        .nt_enc = args->nt_enc,
+        .nr_enc = args->nr_enc,
+        .is_nt_encrypted = args->is_nt_encrypted,
+        .check_nt_par = args->is_nt_encrypted && (is_ev1 == false),
+        .nt_par_err = nt_par_err,
+        .enc0 = local_enc[0],
+        .accept = accept,
+        .accept_len = ARRAYLEN(accept),
+    };
 
-        // Init cipher with key
-        struct Crypto1State *pcs = crypto1_create(key);
+    const crypto1_bs_backend_t *be = crypto1_bs_best_backend();
+    uint64_t keys[CRYPTO1_BS_MAX_WIDTH];
+    uint32_t survivors[CRYPTO1_BS_MAX_WIDTH];
 
-        // NESTED decrypt nt with help of new key
-        crypto1_word(pcs, args->nt_enc ^ args->uid, args->is_nt_encrypted);
-        crypto1_word(pcs, args->nr_enc, 1);
-        crypto1_word(pcs, 0, 0);
-        crypto1_word(pcs, 0, 0);
+    while (1) {
 
-        // decrypt 22 bytes
-        uint8_t dec[args->enc_len];
-        for (int i = 0; i < args->enc_len; i++) {
-            dec[i] = crypto1_byte(pcs, 0x00, 0) ^ local_enc[i];
+        uint32_t start = __atomic_fetch_add(&global_key_next, be->width, __ATOMIC_RELAXED);
+        if (start > 0xFFFF) {
+            break;
         }
 
-        crypto1_destroy(pcs);
-
-        // check if cmd exists
-        if (checkValidCmdByte(dec, args->enc_len) == false) {
-            continue;
+        uint32_t n = 0;
+        for (uint64_t count = start; count <= 0xFFFF && n < (uint32_t)be->width; count++) {
+            keys[n++] = args->part_key | (count << 32);
         }
 
-        __sync_fetch_and_add(&global_found_candidate, 1);
+        uint32_t found = crypto1_bs_filter(be, keys, n, &job, survivors);
 
-        // lock this section to avoid interlacing prints from different threats
-        pthread_mutex_lock(&print_lock);
-        printf("\nenc:  %s\n", sprint_hex_inrow_ex(local_enc, args->enc_len, 0));
-        printf("dec:  %s\n", sprint_hex_inrow_ex(dec, args->enc_len, 0));
+        for (uint32_t f = 0; f < found; f++) {
 
-        if (key == global_candidate_key) {
-            printf("\nValid Key found [ " _GREEN_("%012" PRIx64) " ] - " _YELLOW_("matches candidate")  "\n\n", key);
-        } else {
-            printf("\nValid Key found [ " _GREEN_("%012" PRIx64) " ]\n\n", key);
-        }
+            uint64_t key = keys[survivors[f]];
 
-        pthread_mutex_unlock(&print_lock);
+            // Init cipher with key
+            struct Crypto1State *pcs = crypto1_create(key);
+
+            // NESTED decrypt nt with help of new key
+            crypto1_word(pcs, args->nt_enc ^ args->uid, args->is_nt_encrypted);
+            crypto1_word(pcs, args->nr_enc, 1);
+            crypto1_word(pcs, 0, 0);
+            crypto1_word(pcs, 0, 0);
+
+            // decrypt 22 bytes
+            uint8_t dec[args->enc_len];
+            for (int i = 0; i < args->enc_len; i++) {
+                dec[i] = crypto1_byte(pcs, 0x00, 0) ^ local_enc[i];
+            }
+
+            crypto1_destroy(pcs);
+
+            // check if cmd exists
+            if (checkValidCmdByte(dec, args->enc_len) == false) {
+                continue;
+            }
+
+            __sync_fetch_and_add(&global_found_candidate, 1);
+
+            // lock this section to avoid interlacing prints from different threats
+            pthread_mutex_lock(&print_lock);
+            printf("\nenc:  %s\n", sprint_hex_inrow_ex(local_enc, args->enc_len, 0));
+            printf("dec:  %s\n", sprint_hex_inrow_ex(dec, args->enc_len, 0));
+
+            if (key == global_candidate_key) {
+                printf("\nValid Key found [ " _GREEN_("%012" PRIx64) " ] - " _YELLOW_("matches candidate")  "\n\n", key);
+            } else {
+                printf("\nValid Key found [ " _GREEN_("%012" PRIx64) " ]\n\n", key);
+            }
+
+            pthread_mutex_unlock(&print_lock);
+        }
     }
     free(args);
     return NULL;
@@ -647,7 +689,10 @@ static void *brute_key_thread(void *arguments) {
 
 static int usage(void) {
     printf("\n");
-    printf("syntax:  mf_nonce_brute <uid> <{nt}> <nt_par_err> <{nr}> <{ar}> <ar_par_err> <{at}> <at_par_err> [<{next_command}>]\n\n");
+    printf("syntax:  mf_nonce_brute [-t <threads>] <uid> <{nt}> <nt_par_err> <{nr}> <{ar}> <ar_par_err> <{at}> <at_par_err> [<{next_command}>]\n");
+    printf("         mf_nonce_brute --bench\n\n");
+    printf("  -t, --threads <n>   number of threads, defaults to the number of cores\n");
+    printf("      --bench         check and benchmark the bitsliced crypto1 backends\n\n");
     printf("alternatively, you can provide a clear nt:\n");
     printf("syntax:  mf_nonce_brute <uid> <nt> clear <{nr}> <{ar}> <ar_par_err> <{at}> <at_par_err> [<{next_command}>]\n\n");
     printf("how to convert trace data to needed input:\n");
@@ -670,9 +715,39 @@ static int usage(void) {
     return 1;
 }
 
-int main(int argc, const char *argv[]) {
+int main(int argc, char *argv[]) {
     printf("\nMifare classic nested auth key recovery\n\n");
 
+#if !defined(_WIN32) || !defined(__WIN32__)
+    thread_count = sysconf(_SC_NPROCESSORS_CONF);
+    if (thread_count < 2)
+        thread_count = 2;
+#endif  /* _WIN32 */
+
+    static const struct option long_options[] = {
+        {"threads", required_argument, NULL, 't'},
+        {"bench",   no_argument,       NULL, 'b'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "t:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 't':
+                thread_count = atoi(optarg);
+                if (thread_count < 1) {
+                    return usage();
+                }
+                break;
+            case 'b':
+                return crypto1_bs_selftest(true);
+            default:
+                return usage();
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
     if (argc < 9) return usage();
 
     sscanf(argv[1], "%x", &uid);
@@ -719,13 +794,7 @@ int main(int argc, const char *argv[]) {
     // calc (parity XOR corresponding nonce bit encoded with the same keystream bit)
     uint16_t xored = xored_bits(nt_par, nt_enc, ar_par, ar_enc, at_par, at_enc);
 
-#if !defined(_WIN32) || !defined(__WIN32__)
-    thread_count = sysconf(_SC_NPROCESSORS_CONF);
-    if (thread_count < 2)
-        thread_count = 2;
-#endif  /* _WIN32 */
-
-    printf("\nBruteforce using " _YELLOW_("%d") " threads\n\n", thread_count);
+    printf("\nBruteforce using " _YELLOW_("%d") " threads, " _YELLOW_("%s") " crypto1\n\n", thread_count, crypto1_bs_best_backend()->name);
 
     pthread_t threads[thread_count];
 
@@ -785,6 +854,7 @@ int main(int argc, const char *argv[]) {
         printf("\nTarget MFC Ev1...\n");
 
         t1 = msclock();
+        is_ev1 = true;
         // the rest of available threads to EV1 scenario
         for (int i = 0; i < thread_count; ++i) {
             struct thread_args *a = calloc(1, sizeof(struct thread_args));
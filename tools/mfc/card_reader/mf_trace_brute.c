@@ -17,7 +17,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include "ctype.h"
+#include <getopt.h>
 #include "crapto1/crapto1.h"
+#include "crypto1_bs.h"
 #include "protocol.h"
 #include "iso14443crc.h"
 #include <util_posix.h>
@@ -59,6 +61,7 @@ uint8_t cmds[8][2] = {
 
 static int global_found = 0;
 static int thread_count = 2;
+static uint32_t global_key_next = 0;
 
 static int param_getptr(const char *line, int *bg, int *en, int paramnum) {
     int i;
@@ -193,49 +196,84 @@ static bool checkValidCmdByte(uint8_t *cmd, uint16_t n) {
     return false;
 }
 
+// Keys are run through the bitsliced filter a batch at a time, only the few keys
+// with a plausible first command byte are decrypted in full.
 static void *brute_thread(void *arguments) {
 
     struct thread_args *args = (struct thread_args *) arguments;
-    uint64_t key = args->part_key;
     uint8_t local_enc[args->enc_len];
     memcpy(local_enc, args->enc, args->enc_len);
 
-    for (uint64_t count = args->idx; count < 0xFFFF; count += thread_count) {
+    uint8_t accept[8];
+    for (int i = 0; i < 8; i++) {
+        accept[i] = cmds[i][0];
+    }
+
+    crypto1_bs_job_t job = {
+        .uid = args->uid,
+        .nt_enc = args->nt_enc,
+        .nr_enc = args->nr_enc,
+        .is_nt_encrypted = true,
+        .enc0 = local_enc[0],
+        .accept = accept,
+        .accept_len = sizeof(accept),
+    };
+
+    const crypto1_bs_backend_t *be = crypto1_bs_best_backend();
+    uint64_t keys[CRYPTO1_BS_MAX_WIDTH];
+    uint32_t survivors[CRYPTO1_BS_MAX_WIDTH];
+
+    while (__atomic_load_n(&global_found, __ATOMIC_ACQUIRE) == 0) {
 
-        if (__atomic_load_n(&global_found, __ATOMIC_ACQUIRE) == 1) {
+        uint32_t start = __atomic_fetch_add(&global_key_next, be->width, __ATOMIC_RELAXED);
+        if (start > 0xFFFF) {
             break;
         }
 
-        key |= count << 32;
+        uint32_t n = 0;
+        for (uint64_t count = start; count <= 0xFFFF && n < (uint32_t)be->width; count++) {
+            keys[n++] = args->part_key | (count << 32);
+        }
 
-        // Init cipher with key
-        struct Crypto1State *pcs = crypto1_create(key);
+        uint32_t found = crypto1_bs_filter(be, keys, n, &job, survivors);
 
-        // NESTED decrypt nt with help of new key
-        crypto1_word(pcs, args->nt_enc ^ args->uid, 1);
-        crypto1_word(pcs, args->nr_enc, 1);
-        crypto1_word(pcs, 0, 0);
-        crypto1_word(pcs, 0, 0);
+        for (uint32_t f = 0; f < found; f++) {
 
-        // decrypt 22 bytes
-        uint8_t dec[args->enc_len];
-        for (int i = 0; i < args->enc_len; i++)
-            dec[i] = crypto1_byte(pcs, 0x00, 0) ^ local_enc[i];
+            uint64_t key = keys[survivors[f]];
 
-        crypto1_destroy(pcs);
+            // Init cipher with key
+            struct Crypto1State *pcs = crypto1_create(key);
 
-        if (checkValidCmdByte(dec, args->enc_len) == false) {
-            continue;
+            // NESTED decrypt nt with help of new key
+            crypto1_word(pcs, args->nt_enc ^ args->uid, 1);
+            crypto1_word(pcs, args->nr_enc, 1);
+            crypto1_word(pcs, 0, 0);
+            crypto1_word(pcs, 0, 0);
+
+            // decrypt 22 bytes
+            uint8_t dec[args->enc_len];
+            for (int i = 0; i < args->enc_len; i++)
+                dec[i] = crypto1_byte(pcs, 0x00, 0) ^ local_enc[i];
+
+            crypto1_destroy(pcs);
+
+            if (checkValidCmdByte(dec, args->enc_len) == false) {
+                continue;
+            }
+
+            // only report the first key found
+            if (__sync_fetch_and_add(&global_found, 1) != 0) {
+                break;
+            }
+
+            // lock this section to avoid interlacing prints from different threats
+            pthread_mutex_lock(&print_lock);
+            printf("\nenc:  %s\n", sprint_hex_inrow_ex(local_enc, args->enc_len, 0));
+            printf("dec:  %s\n", sprint_hex_inrow_ex(dec, args->enc_len, 0));
+            printf("\nValid Key found [ " _GREEN_("%012" PRIx64) " ]\n\n", key);
+            pthread_mutex_unlock(&print_lock);
+            break;
         }
-        __sync_fetch_and_add(&global_found, 1);
-
-        // lock this section to avoid interlacing prints from different threats
-        pthread_mutex_lock(&print_lock);
-        printf("\nenc:  %s\n", sprint_hex_inrow_ex(local_enc, args->enc_len, 0));
-        printf("dec:  %s\n", sprint_hex_inrow_ex(dec, args->enc_len, 0));
-        printf("\nValid Key found [ " _GREEN_("%012" PRIx64) " ]\n\n", key);
-        pthread_mutex_unlock(&print_lock);
-        break;
     }
 
     free(args);
@@ -243,13 +281,47 @@ static void *brute_thread(void *arguments) {
 }
 
 static int usage(void) {
-    printf(" syntax: mf_trace_brute <uid> <partial key> <{nt}> <{nr}> [<{next_command + 18 bytes}>]\n\n");
+    printf(" syntax: mf_trace_brute [-t <threads>] <uid> <partial key> <{nt}> <{nr}> [<{next_command + 18 bytes}>]\n");
+    printf("         mf_trace_brute --bench\n\n");
+    printf("  -t, --threads <n>   number of threads, defaults to the number of cores\n");
+    printf("      --bench         check and benchmark the bitsliced crypto1 backends\n\n");
     return 1;
 }
 
-int main(int argc, const char *argv[]) {
+int main(int argc, char *argv[]) {
     printf("Mifare classic nested auth key recovery Phase 2\n");
-    if (argc < 3) return usage();
+
+#if !defined(_WIN32) || !defined(__WIN32__)
+    thread_count = sysconf(_SC_NPROCESSORS_CONF);
+    if (thread_count < 2)
+        thread_count = 2;
+#endif  /* _WIN32 */
+
+    static const struct option long_options[] = {
+        {"threads", required_argument, NULL, 't'},
+        {"bench",   no_argument,       NULL, 'b'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "t:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 't':
+                thread_count = atoi(optarg);
+                if (thread_count < 1) {
+                    return usage();
+                }
+                break;
+            case 'b':
+                return crypto1_bs_selftest(true);
+            default:
+                return usage();
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    if (argc < 6) return usage();
 
     uint32_t uid = 0;      // serial number
     uint32_t part_key = 0; // last 4 keys of key
@@ -274,13 +346,7 @@ int main(int argc, const char *argv[]) {
 
     uint64_t t1 = msclock();
 
-#if !defined(_WIN32) || !defined(__WIN32__)
-    thread_count = sysconf(_SC_NPROCESSORS_CONF);
-    if (thread_count < 2)
-        thread_count = 2;
-#endif  /* _WIN32 */
-
-    printf("\nBruteforce using %d threads to find upper 16bits of key\n", thread_count);
+    printf("\nBruteforce using %d threads ( %s crypto1 ) to find upper 16bits of key\n", thread_count, crypto1_bs_best_backend()->name);
 
     pthread_t threads[thread_count];
 
@@ -0,0 +1,630 @@
+#!/usr/bin/env python3
+
+# Offline MIFARE Classic key recovery queue over many cards.
+#
+# Reads every nonce JSON file of a directory, turns the nonces into jobs for
+# the host tools of tools/mfc and runs them on all cores, cheapest first:
+#
+#   mfkey32v2                  reader nonces collected by `hf mf sim`
+#   staticnested_1nt, _2x1nt   FM11RF08S backdoor nonces, `hf mf isen --collect_fm11rf08s`
+#   _rf08s_1key                the other key of a sector once one is known
+#   mf_nonce_brute             sniffed nested authentications
+#
+# Jobs are deduplicated on their input and on the key slot (UID, sector,
+# key type): a slot that is solved, by a job or by an existing key file, gets
+# no more jobs and its running brute force is stopped.  Results go to
+# `hf-mf-<UID>-key.bin`, like autopwn writes them, and the key candidates of
+# the static nested attack to `hf-mf-<UID>-candidates.dic` for
+# `hf mf fchk -f`.  Running again on the same directory picks the keys up and
+# only does what is left.  The key file can't tell a real FFFFFFFFFFFF key from
+# an unknown one, `hf-mf-<UID>-key-unknown.json` lists the slots still open.
+#
+# Input formats
+#   FileType "fm11rf08s_nonces" or "fm11rf08s_nonces_with_data", as saved by
+#   the client.  The UID is taken from block 0 or from the file name.
+#
+#   FileType "mfkey_nonces":
+#   { "FileType": "mfkey_nonces", "uid": "12345678",
+#     "nonces": [
+#       { "sector": 1, "keytype": "A",          <- mfkey32v2, two authentications
+#         "nt": "..", "nr": "..", "ar": "..", "nt1": "..", "nr1": "..", "ar1": ".." },
+#       { "sector": 2, "keytype": "B",          <- mf_nonce_brute, one nested authentication
+#         "nt": "..", "nt_par_err": "1011", "nr": "..", "ar": "..", "ar_par_err": "..",
+#         "at": "..", "at_par_err": "..", "next": "<encrypted next command, optional>" } ] }
+#
+# Usage:
+#   pm3_crack_queue.py <dir> [-o outdir] [-j cores] [--brute-threads n] [--no-brute] [-v]
+#   pm3_crack_queue.py --selftest
+
+import argparse
+import glob
+import heapq
+import json
+import os
+import queue
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+TOOLSPATH = os.path.dirname(os.path.abspath(__file__))
+
+# job classes, lower runs first
+PRIO_MFKEY = 0
+PRIO_STATICNESTED = 1
+PRIO_BRUTE = 2
+
+KIND_NAMES = {
+    'mfkey32v2': 'mfkey32v2',
+    '1nt': 'staticnested_1nt',
+    '2x1nt': 'staticnested_2x1nt_rf08s',
+    '1key': 'staticnested_2x1nt_rf08s_1key',
+    'brute': 'mf_nonce_brute',
+}
+
+# result letters of the key table, like `hf mf autopwn` prints them
+RES_LETTERS = {'file': 'F', 'mfkey32v2': 'M', '1key': 'S', 'brute': 'B'}
+
+ANSI = re.compile(r'(\x9B|\x1B\[)[0-?]*[ -/]*[@-~]')
+
+
+def find_tool(name, tools_dir=None):
+    paths = [tools_dir] if tools_dir else []
+    paths += [os.path.join(TOOLSPATH, 'card_only'), os.path.join(TOOLSPATH, 'card_reader')]
+    for p in paths:
+        for fn in (name, name + '.exe'):
+            if os.path.isfile(os.path.join(p, fn)):
+                return os.path.join(p, fn)
+    return shutil.which(name)
+
+
+def keytype_index(kt):
+    return 1 if str(kt).upper() in ('B', '1', '0X61') else 0
+
+
+def sectors_for(max_sector):
+    # key files hold 16, 32 or 40 sectors, like 1k, 2k and 4k cards
+    for n in (16, 32, 40):
+        if max_sector < n:
+            return n
+    return 40
+
+
+class Card:
+    def __init__(self, uid):
+        self.uid = uid.upper()
+        self.sectors = 16
+        self.keys = {}          # (sector, keytype) -> key, lower case hex
+        self.sources = {}       # (sector, keytype) -> job kind or 'file'
+        self.candidates = {}    # (sector, keytype) -> dictionary in the work dir
+        self.nt = {}            # (sector, keytype) -> static nonce of the FM11RF08S
+        self.loaded = set()     # slots already in the key file
+
+    @property
+    def cuid(self):
+        return self.uid[-8:].lower()
+
+    def missing(self):
+        return self.sectors * 2 - sum(1 for s, _ in self.keys if s < self.sectors)
+
+    def keyfile(self, outdir):
+        return os.path.join(outdir, f'hf-mf-{self.uid}-key.bin')
+
+    def dicfile(self, outdir):
+        return os.path.join(outdir, f'hf-mf-{self.uid}-candidates.dic')
+
+    def unknownfile(self, outdir):
+        return os.path.join(outdir, f'hf-mf-{self.uid}-key-unknown.json')
+
+    def load_keyfile(self, outdir):
+        fn = self.keyfile(outdir)
+        if os.path.isfile(fn) is False:
+            return
+        data = open(fn, 'rb').read()
+        n = len(data) // 12
+        self.sectors = max(self.sectors, n)
+
+        # without our list of open slots, FFFFFFFFFFFF stands in for unknown keys, like the client writes them
+        unknown = None
+        try:
+            with open(self.unknownfile(outdir)) as f:
+                unknown = {(e['sector'], keytype_index(e['keytype'])) for e in json.load(f)['unknown']}
+        except (OSError, ValueError, KeyError, TypeError):
+            pass
+
+        for kt in (0, 1):
+            for sec in range(n):
+                key = data[(kt * n + sec) * 6:(kt * n + sec + 1) * 6].hex()
+                if unknown is None:
+                    known = (key != 'ffffffffffff')
+                else:
+                    known = (sec, kt) not in unknown
+                if len(key) == 12 and known:
+                    self.keys[(sec, kt)] = key
+                    self.sources[(sec, kt)] = 'file'
+                    self.loaded.add((sec, kt))
+
+    def save(self, outdir):
+        if any(s < self.sectors for s, _ in self.keys):
+            with open(self.keyfile(outdir), 'wb') as f:
+                for kt in (0, 1):
+                    for sec in range(self.sectors):
+                        f.write(bytes.fromhex(self.keys.get((sec, kt), 'ffffffffffff')))
+            unknown = [{'sector': sec, 'keytype': 'AB'[kt]} for sec in range(self.sectors) for kt in (0, 1)
+                       if (sec, kt) not in self.keys]
+            with open(self.unknownfile(outdir), 'w') as f:
+                json.dump({'Created': 'pm3_crack_queue', 'FileType': 'mfc_key_unknown', 'unknown': unknown}, f, indent=2)
+
+        # the found keys, then the candidates of each slot still open
+        if self.candidates:
+            seen = set()
+            with open(self.dicfile(outdir), 'w') as f:
+                f.write(f'# keys and key candidates of {self.uid}\n')
+                for slot in sorted(self.keys):
+                    if self.keys[slot] not in seen:
+                        seen.add(self.keys[slot])
+                        f.write(self.keys[slot] + '\n')
+                for (sec, kt), fn in sorted(self.candidates.items()):
+                    if (sec, kt) in self.keys or os.path.isfile(fn) is False:
+                        continue
+                    f.write(f'# sector {sec} key {"AB"[kt]}\n')
+                    with open(fn) as c:
+                        for line in c:
+                            k = line.strip().lower()
+                            if len(k) == 12 and k not in seen:
+                                seen.add(k)
+                                f.write(k + '\n')
+
+
+class Job:
+    seq = 0
+
+    def __init__(self, kind, prio, card, slots, args, cores=1, cwd=None, on_done=None):
+        self.kind = kind
+        self.prio = prio
+        self.card = card
+        self.slots = slots      # key slots the job can solve
+        self.args = args
+        self.cores = cores
+        self.cwd = cwd
+        self.on_done = on_done
+        self.proc = None
+        self.cancelled = False
+        self.elapsed = 0.0
+        Job.seq += 1
+        self.seq = Job.seq
+
+    def dedup_key(self):
+        return (self.kind, tuple(self.args[1:]))
+
+    def order(self):
+        slot = min(self.slots) if self.slots else (0, 0)
+        return (self.prio, self.card.missing(), self.card.uid, slot, self.seq)
+
+
+class CrackQueue:
+    def __init__(self, outdir, workdir, cores, brute_threads, tools_dir=None, verbose=False):
+        self.outdir = outdir
+        self.workdir = workdir
+        self.cores = max(1, cores)
+        # 0 leaves the mf_nonce_brute jobs out
+        self.brute_threads = min(brute_threads, self.cores) if brute_threads > 0 else 0
+        self.tools_dir = tools_dir
+        self.verbose = verbose
+        self.cards = {}
+        self.heap = []
+        self.seen = set()
+        self.running = {}
+        self.done = queue.Queue()
+        self.stats = {}
+        self.skipped = 0
+        self.deduped = 0
+        self.cancelled = 0
+        self.found = 0
+        self.missing_tools = set()
+        self.lock = threading.Lock()
+
+    def log(self, msg):
+        print(msg, flush=True)
+
+    def card(self, uid):
+        uid = uid.upper()
+        if uid not in self.cards:
+            c = Card(uid)
+            c.load_keyfile(self.outdir)
+            self.cards[uid] = c
+        return self.cards[uid]
+
+    def tool(self, kind):
+        path = find_tool(KIND_NAMES[kind], self.tools_dir)
+        if path is None and kind not in self.missing_tools:
+            self.missing_tools.add(kind)
+            self.log(f'[!] {KIND_NAMES[kind]} not found, its jobs are skipped')
+        return path
+
+    def push(self, job):
+        key = job.dedup_key()
+        if key in self.seen:
+            self.deduped += 1
+            return
+        self.seen.add(key)
+        heapq.heappush(self.heap, (job.order(), job))
+
+    # ---- input ------------------------------------------------------------
+
+    def add_file(self, fn):
+        try:
+            with open(fn) as f:
+                js = json.load(f)
+        except (OSError, ValueError) as e:
+            self.log(f'[!] {fn}: {e}')
+            return
+        ftype = js.get('FileType', '')
+        if ftype.startswith('fm11rf08s_nonces'):
+            self.add_fm11rf08s(fn, js)
+        elif ftype == 'mfkey_nonces':
+            self.add_mfkey(fn, js)
+        elif self.verbose:
+            self.log(f'[=] {fn}: skipped, file type {ftype or "unknown"}')
+
+    def add_fm11rf08s(self, fn, js):
+        uid = None
+        blocks = js.get('blocks', {})
+        if '0' in blocks:
+            uid = blocks['0'][:8]
+        else:
+            m = re.search(r'hf-mf-([0-9A-Fa-f]{8,14})-nonces', os.path.basename(fn))
+            if m:
+                uid = m.group(1)
+        if uid is None:
+            self.log(f'[!] {fn}: no UID in file or file name')
+            return
+        card = self.card(uid)
+        nt, nt_enc, par = js.get('nt', {}), js.get('nt_enc', {}), js.get('par_err', {})
+        for s in sorted(nt, key=int):
+            sec = int(s)
+            try:
+                pair = [(nt[s][k].lower(), nt_enc[s][k].lower(), par[s][k]) for k in ('a', 'b')]
+            except (KeyError, AttributeError):
+                continue
+            if sec < 32:
+                card.sectors = max(card.sectors, sectors_for(sec))
+            self.add_staticnested(card, sec, pair)
+
+    def add_staticnested(self, card, sec, pair):
+        for kt in (0, 1):
+            card.nt[(sec, kt)] = pair[kt][0]
+        if (sec, 0) in card.keys and (sec, 1) in card.keys:
+            self.skipped += 1
+            return
+
+        tool = self.tool('1nt')
+        if tool is None:
+            return
+
+        dics = {}
+        pending = set()
+
+        def one_done(job, ok, out):
+            pending.discard(job.seq)
+            if pending:
+                return
+            self.after_1nt(card, sec, pair, dics)
+
+        # the same nonce for A and B, one set of candidates for both
+        kts = (0,) if pair[0][0] == pair[1][0] else [kt for kt in (0, 1) if (sec, kt) not in card.keys]
+        jobs = []
+        for kt in kts:
+            dics[kt] = f'keys_{card.cuid}_{sec:02}_{pair[kt][0]}.dic'
+            # no slots, the candidates are wanted even once the key is found
+            job = Job('1nt', PRIO_STATICNESTED, card, [],
+                      [tool, card.cuid, str(sec), pair[kt][0], pair[kt][1], pair[kt][2]],
+                      cwd=self.workdir, on_done=one_done)
+            jobs.append(job)
+            pending.add(job.seq)
+        if pair[0][0] == pair[1][0]:
+            dics[1] = dics[0]
+        for job in jobs:
+            self.push(job)
+
+    def after_1nt(self, card, sec, pair, dics):
+        for kt in dics:
+            card.candidates[(sec, kt)] = os.path.join(self.workdir, dics[kt])
+
+        if len(dics) == 2 and dics[0] != dics[1] and not ((sec, 0) in card.keys or (sec, 1) in card.keys):
+            tool = self.tool('2x1nt')
+            if tool:
+                def filtered(job, ok, out):
+                    for kt in (0, 1):
+                        fn = os.path.join(self.workdir, dics[kt][:-4] + '_filtered.dic')
+                        if ok and os.path.isfile(fn):
+                            card.candidates[(sec, kt)] = fn
+                    self.try_1key(card, sec)
+                self.push(Job('2x1nt', PRIO_STATICNESTED, card, [(sec, 0), (sec, 1)],
+                              [tool, dics[0], dics[1]], cwd=self.workdir, on_done=filtered))
+                return
+        self.try_1key(card, sec)
+
+    def try_1key(self, card, sec):
+        # one key known, its nonce finds the other among the candidates
+        for known, target in ((0, 1), (1, 0)):
+            if (sec, known) not in card.keys or (sec, target) in card.keys:
+                continue
+            dic = card.candidates.get((sec, target))
+            nt_known = card.nt.get((sec, known))
+            if dic is None or nt_known is None or nt_known == card.nt.get((sec, target)):
+                continue
+            tool = self.tool('1key')
+            if tool is None:
+                return
+
+            def matched(job, ok, out, target=target):
+                keys = re.findall(r'MATCH: key2=([0-9a-f]{12})', out)
+                if len(keys) == 1:
+                    self.solved(card, (sec, target), keys[0], '1key')
+                elif len(keys) > 1:
+                    fn = os.path.join(self.workdir, f'keys_{card.cuid}_{sec:02}_{card.nt[(sec, target)]}_1key.dic')
+                    with open(fn, 'w') as f:
+                        f.write('\n'.join(keys) + '\n')
+                    card.candidates[(sec, target)] = fn
+            self.push(Job('1key', PRIO_STATICNESTED, card, [(sec, target)],
+                          [tool, nt_known, card.keys[(sec, known)], os.path.basename(dic)],
+                          cwd=os.path.dirname(dic), on_done=matched))
+
+    def add_mfkey(self, fn, js):
+        for n in js.get('nonces', []):
+            uid = n.get('uid', js.get('uid'))
+            if uid is None or 'sector' not in n:
+                self.log(f'[!] {fn}: nonce without UID or sector')
+                continue
+            card = self.card(uid)
+            sec = int(n['sector'])
+            slot = (sec, keytype_index(n.get('keytype', 'A')))
+            card.sectors = max(card.sectors, sectors_for(sec))
+            if slot in card.keys:
+                self.skipped += 1
+                continue
+
+            def found(job, ok, out, slot=slot, card=card):
+                m = re.search(r'(?:Found Key|Valid Key found):? \[ *([0-9a-fA-F]{12}) *\]', out)
+                if m:
+                    self.solved(card, slot, m.group(1).lower(), job.kind)
+
+            if 'nt1' in n:
+                tool = self.tool('mfkey32v2')
+                if tool:
+                    self.push(Job('mfkey32v2', PRIO_MFKEY, card, [slot],
+                                  [tool, card.cuid] + [n[k] for k in ('nt', 'nr', 'ar', 'nt1', 'nr1', 'ar1')],
+                                  on_done=found))
+            elif 'at' in n:
+                if self.brute_threads == 0:
+                    continue
+                tool = self.tool('brute')
+                if tool:
+                    args = [tool, '-t', str(self.brute_threads), card.cuid] + \
+                           [n[k] for k in ('nt', 'nt_par_err', 'nr', 'ar', 'ar_par_err', 'at', 'at_par_err')]
+                    if n.get('next'):
+                        args.append(n['next'])
+                    self.push(Job('brute', PRIO_BRUTE, card, [slot], args, cores=self.brute_threads, on_done=found))
+            else:
+                self.log(f'[!] {fn}: sector {sec} has neither two authentications nor a nested one')
+
+    # ---- results ----------------------------------------------------------
+
+    def solved(self, card, slot, key, source):
+        if slot in card.keys:
+            return
+        card.keys[slot] = key
+        card.sources[slot] = source
+        self.found += 1
+        self.log(f'[+] {card.uid} sector {slot[0]:3} key {"AB"[slot[1]]} [ {key.upper()} ] ({KIND_NAMES.get(source, source)})')
+
+        # nobody else needs to work on it
+        for job in list(self.running):
+            if job.slots and all(s in card.keys for s in job.slots) and job.card is card and job.kind == 'brute':
+                job.cancelled = True
+                if job.proc:
+                    job.proc.terminate()
+        self.try_1key(card, slot[0])
+
+    # ---- scheduling -------------------------------------------------------
+
+    def run_job(self, job):
+        t0 = time.monotonic()
+        out = ''
+        ok = False
+        try:
+            job.proc = subprocess.Popen(job.args, cwd=job.cwd, stdout=subprocess.PIPE,
+                                        stderr=subprocess.STDOUT, text=True, errors='replace')
+            if job.cancelled:
+                job.proc.terminate()
+            out = job.proc.communicate()[0]
+            ok = (job.proc.returncode == 0)
+        except OSError as e:
+            out = str(e)
+        job.elapsed = time.monotonic() - t0
+        self.done.put((job, ok, ANSI.sub('', out)))
+
+    def stale(self, job):
+        return job.slots and all(s in job.card.keys for s in job.slots)
+
+    def run(self):
+        t0 = time.monotonic()
+        free = self.cores
+        while self.heap or self.running:
+            while self.heap:
+                _, job = self.heap[0]
+                if self.stale(job):
+                    heapq.heappop(self.heap)
+                    self.skipped += 1
+                    continue
+                if job.cores > free and self.running:
+                    break
+                heapq.heappop(self.heap)
+                free -= job.cores
+                self.running[job] = True
+                if self.verbose:
+                    self.log(f'[=] start {" ".join(os.path.basename(a) if i == 0 else a for i, a in enumerate(job.args))}')
+                threading.Thread(target=self.run_job, args=(job,), daemon=True).start()
+
+            job, ok, out = self.done.get()
+            del self.running[job]
+            free += job.cores
+            st = self.stats.setdefault(job.kind, {'jobs': 0, 'seconds': 0.0, 'core_seconds': 0.0})
+            st['jobs'] += 1
+            st['seconds'] += job.elapsed
+            st['core_seconds'] += job.elapsed * job.cores
+            if job.cancelled:
+                self.cancelled += 1
+                continue
+            if self.verbose and ok is False:
+                self.log(f'[-] {KIND_NAMES[job.kind]} failed: {out.strip().splitlines()[-1:] if out.strip() else ""}')
+            if job.on_done:
+                job.on_done(job, ok, out)
+        return time.monotonic() - t0
+
+    # ---- report -----------------------------------------------------------
+
+    def report(self, wall):
+        for uid in sorted(self.cards):
+            card = self.cards[uid]
+            card.save(self.outdir)
+            self.log('')
+            self.log(f'[=] {uid}')
+            self.log('[=]  Sec | key A        | res | key B        | res')
+            for sec in sorted({s for s, _ in card.keys} | {s for s, _ in card.candidates}):
+                row = []
+                for kt in (0, 1):
+                    if (sec, kt) in card.keys:
+                        row.append(f'{card.keys[(sec, kt)].upper()} |  {RES_LETTERS.get(card.sources[(sec, kt)], "?")} ')
+                    elif (sec, kt) in card.candidates and os.path.isfile(card.candidates[(sec, kt)]):
+                        with open(card.candidates[(sec, kt)]) as f:
+                            n = sum(1 for line in f if len(line.strip()) == 12)
+                        row.append(f'{n:>7} cand |    ')
+                    else:
+                        row.append('------------ |    ')
+                self.log(f'[=]  {sec:3} | {row[0]} | {row[1]}')
+            self.log('[=] ( F:key file, M:mfkey32v2, S:static nested, B:nonce brute )')
+            if any(s < card.sectors for s, _ in card.keys):
+                self.log(f'[+] keys saved to `{card.keyfile(self.outdir)}`')
+            if card.candidates:
+                self.log(f'[+] candidates saved to `{card.dicfile(self.outdir)}`, try `hf mf fchk -f {os.path.basename(card.dicfile(self.outdir))} --no-default`')
+
+        jobs = sum(s['jobs'] for s in self.stats.values())
+        core_seconds = sum(s['core_seconds'] for s in self.stats.values())
+        self.log('')
+        self.log('[=] job                            | jobs |  seconds | mean s')
+        for kind in sorted(self.stats, key=lambda k: list(KIND_NAMES).index(k)):
+            st = self.stats[kind]
+            self.log(f'[=] {KIND_NAMES[kind]:30} | {st["jobs"]:4} | {st["seconds"]:8.2f} | {st["seconds"] / st["jobs"]:6.2f}')
+        self.log(f'[=] cards {len(self.cards)}, keys found {self.found}, jobs {jobs}, '
+                 f'skipped {self.skipped}, duplicates {self.deduped}, stopped {self.cancelled}')
+        if wall > 0:
+            self.log(f'[=] throughput {jobs / wall:.1f} jobs/s, {self.found * 60 / wall:.1f} keys/min, '
+                     f'{len(self.cards) * 60 / wall:.1f} cards/min, {self.cores} cores '
+                     f'{100 * core_seconds / (wall * self.cores):.0f} % busy, {wall:.2f} s')
+
+
+def crack(indir, outdir, workdir, cores, brute_threads, tools_dir=None, verbose=False):
+    os.makedirs(outdir, exist_ok=True)
+    os.makedirs(workdir, exist_ok=True)
+    q = CrackQueue(outdir, workdir, cores, brute_threads, tools_dir, verbose)
+    files = sorted(glob.glob(os.path.join(indir, '*.json')))
+    for fn in files:
+        q.add_file(fn)
+    q.log(f'[=] {len(files)} files, {len(q.cards)} cards, {len(q.heap)} jobs queued, {q.cores} cores')
+    wall = q.run()
+    q.report(wall)
+    return q
+
+
+def selftest(tools_dir=None):
+    tmp = tempfile.mkdtemp(prefix='pm3_crack_queue_')
+    indir = os.path.join(tmp, 'in')
+    outdir = os.path.join(tmp, 'out')
+    os.makedirs(indir)
+    try:
+        # inputs of the mfkey32v2, mf_nonce_brute and staticnested tests of tools/pm3_tests.sh
+        mfkey = {'Created': 'proxmark3', 'FileType': 'mfkey_nonces', 'uid': '12345678',
+                 'nonces': [{'sector': 1, 'keytype': 'A', 'nt': '1AD8DF2B', 'nr': '1D316024', 'ar': '620EF048',
+                             'nt1': '30D6CB07', 'nr1': 'C52077E2', 'ar1': '837AC61A'}]}
+        for fn in ('mfkey-1.json', 'mfkey-2.json'):
+            with open(os.path.join(indir, fn), 'w') as f:
+                json.dump(mfkey, f)
+        sniff = {'Created': 'proxmark3', 'FileType': 'mfkey_nonces', 'uid': '11223344',
+                 'nonces': [{'sector': 2, 'keytype': 'B', 'nt': 'b8cb192e', 'nt_par_err': '1101', 'nr': '783a458b',
+                             'ar': '3fb52e3f', 'ar_par_err': '0111', 'at': '5227344d', 'at_par_err': '1111',
+                             'next': '7d19b485'}]}
+        with open(os.path.join(indir, 'sniff.json'), 'w') as f:
+            json.dump(sniff, f)
+        rf08s = {'Created': 'proxmark3', 'FileType': 'fm11rf08s_nonces',
+                 'nt': {'0': {'a': '456ace4e', 'b': 'e56f9fa2'}},
+                 'nt_enc': {'0': {'a': 'da53428d', 'b': '7a9616b6'}},
+                 'par_err': {'0': {'a': '1001', 'b': '1110'}}}
+        with open(os.path.join(indir, 'hf-mf-5C467F63-nonces.json'), 'w') as f:
+            json.dump(rf08s, f)
+
+        checks = []
+        q = crack(indir, outdir, os.path.join(tmp, 'work'), 2, 2, tools_dir)
+        checks.append(('mfkey32v2 key', q.cards['12345678'].keys.get((1, 0)) == 'a0a1a2a3a4a5'))
+        checks.append(('mf_nonce_brute key', q.cards['11223344'].keys.get((2, 1)) == '4a6f1d2c3b5e'))
+        checks.append(('duplicate dropped', q.deduped == 1))
+        dic = open(os.path.join(outdir, 'hf-mf-5C467F63-candidates.dic')).read().split()
+        checks.append(('staticnested candidates', 'fffffffffff1' in dic and 'fffffffffff2' in dic))
+
+        # key A found on the card since, key B from it. A real FFFFFFFFFFFF key is no unknown one
+        card = q.cards['5C467F63']
+        card.keys[(0, 0)] = 'fffffffffff1'
+        card.keys[(1, 0)] = 'ffffffffffff'
+        card.save(outdir)
+        q = crack(indir, outdir, os.path.join(tmp, 'work'), 2, 2, tools_dir)
+        checks.append(('key file resumed', q.stats.get('mfkey32v2') is None))
+        checks.append(('1key key B', q.cards['5C467F63'].keys.get((0, 1)) == 'fffffffffff2'))
+        checks.append(('FFFFFFFFFFFF key kept', q.cards['5C467F63'].keys.get((1, 0)) == 'ffffffffffff'))
+        checks.append(('unknown slot open', (1, 1) not in q.cards['5C467F63'].keys))
+
+        # --no-brute
+        q = CrackQueue(outdir, os.path.join(tmp, 'work'), 2, 0, tools_dir)
+        checks.append(('no brute threads', q.brute_threads == 0))
+
+        print('')
+        for name, ok in checks:
+            print(f'[{"+" if ok else "-"}] {name:30} ( {"ok" if ok else "fail"} )')
+        ok = all(ok for _, ok in checks)
+        print(f'Selftest ( {"ok" if ok else "fail"} )')
+        return ok
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Offline MIFARE Classic key recovery queue over a directory of nonce files')
+    parser.add_argument('indir', nargs='?', help='directory with nonce JSON files')
+    parser.add_argument('-o', '--out', help='where the key files go, default the input directory')
+    parser.add_argument('-w', '--work', help='work directory for the candidate dictionaries, default <out>/crack-work')
+    parser.add_argument('-j', '--cores', type=int, default=os.cpu_count() or 1, help='cores to use, default all')
+    parser.add_argument('--brute-threads', type=int, default=0, help='threads of one mf_nonce_brute job, default all cores')
+    parser.add_argument('--no-brute', action='store_true', help='skip the mf_nonce_brute jobs')
+    parser.add_argument('--tools', help='directory of the tools, default tools/mfc/card_only and card_reader')
+    parser.add_argument('--selftest', action='store_true', help='run against the test vectors of tools/pm3_tests.sh')
+    parser.add_argument('-v', '--verbose', action='store_true')
+    args = parser.parse_args()
+
+    if args.selftest:
+        return 0 if selftest(args.tools) else 1
+
+    if args.indir is None or os.path.isdir(args.indir) is False:
+        parser.error('a directory of nonce files is needed')
+
+    outdir = args.out or args.indir
+    workdir = args.work or os.path.join(outdir, 'crack-work')
+    brute_threads = 0 if args.no_brute else (args.brute_threads or args.cores)
+    crack(args.indir, outdir, workdir, args.cores, brute_threads, args.tools, args.verbose)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
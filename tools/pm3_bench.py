@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+
+# Offline benchmarks of the client kernels and the host brute force tools.
+#
+# Runs `analyse bench` of the client, times the host tools on the inputs of
+# tools/pm3_tests.sh and writes everything to one JSON report, tagged with
+# the build it came from.  Two reports, or two builds, can be compared: a
+# case counts as a regression when it is slower by more than the threshold
+# and by more than twice the combined standard deviation.
+#
+# Usage:
+#   pm3_bench.py [-r reps] [-n filter] [-o report.json] [--clientbin bin] [--no-host]
+#   pm3_bench.py --baseline /other/tree/client/proxmark3 [...]
+#   pm3_bench.py --compare old.json new.json [-t threshold%]
+
+import argparse
+import json
+import math
+import os
+import re
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+PM3PATH = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+# name, binary, args, expected output
+HOST_CASES = [
+    ('host.mfkey32v2', 'tools/mfc/card_reader/mfkey32v2',
+     ['12345678', '1AD8DF2B', '1D316024', '620EF048', '30D6CB07', 'C52077E2', '837AC61A'],
+     r'Found Key: \[a0a1a2a3a4a5\]'),
+    ('host.mfkey64', 'tools/mfc/card_reader/mfkey64',
+     ['9c599b32', '82a4166c', 'a1e458ce', '6eea41e0', '5cadf439'],
+     r'Found Key: \[ffffffffffff\]'),
+    ('host.mfulc_des_brute', 'tools/mfulc_des_brute/mfulc_des_brute',
+     ['-c', 'F35C740106ECED87', 'E9E0DC67B35919FC', '00000000000000000000000000000000', '2', '4'],
+     r'00000000404452420000000000000000'),
+    ('host.mfd_aes_brute', 'tools/mfd_aes_brute/mfd_aes_brute',
+     ['1629394800', 'bb6aea729414a5b1eff7b16328ce37fd',
+      '82f5f498dbc29f7570102397a2e5ef2b6dc14a864f665b3c54d11765af81e95c'],
+     r'key\.+ .*261C07A23F2BC8262F69F10A5BDF3764'),
+]
+
+
+def git_describe():
+    try:
+        return subprocess.run(['git', '-C', PM3PATH, 'describe', '--always', '--dirty'],
+                              stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                              text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return 'unknown'
+
+
+def summary(samples):
+    mean = statistics.mean(samples)
+    stddev = statistics.stdev(samples) if len(samples) > 1 else 0.0
+    return {'mean': mean, 'stddev': stddev, 'min': min(samples), 'max': max(samples), 'samples': samples}
+
+
+def run_client(clientbin, reps, min_ms, name):
+    with tempfile.TemporaryDirectory() as tmp:
+        fn = os.path.join(tmp, 'bench.json')
+        cmd = 'analyse bench -r {} -t {} -f {}'.format(reps, min_ms, fn)
+        if name:
+            cmd += ' -n {}'.format(name)
+        p = subprocess.run([clientbin, '--incognito', '-c', cmd], cwd=PM3PATH,
+                           stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        if not os.path.exists(fn):
+            sys.stderr.write(p.stdout)
+            raise RuntimeError('{} did not write a report'.format(clientbin))
+        with open(fn) as f:
+            report = json.load(f)
+    for c in report['cases']:
+        c['source'] = 'client'
+    return report
+
+
+def run_host(reps, name):
+    cases = []
+    for cname, binary, args, expect in HOST_CASES:
+        if name and name not in cname:
+            continue
+        case = {'name': cname, 'unit': 'runs', 'kind': 'macro', 'source': 'host'}
+        path = os.path.join(PM3PATH, binary)
+        if not os.access(path, os.X_OK):
+            case['status'] = 'skipped'
+            cases.append(case)
+            continue
+        samples = []
+        case['status'] = 'ok'
+        for _ in range(reps):
+            t0 = time.perf_counter()
+            p = subprocess.run([path] + args, cwd=PM3PATH,
+                               stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+            dt = time.perf_counter() - t0
+            if not re.search(expect, p.stdout):
+                case['status'] = 'fail'
+                break
+            samples.append(1.0 / dt)
+        if samples:
+            case.update(summary(samples))
+        cases.append(case)
+    return cases
+
+
+def collect(args, clientbin):
+    report = run_client(clientbin, args.reps, args.time, args.name)
+    if not args.no_host and clientbin == args.clientbin:
+        report['cases'] += run_host(args.reps, args.name)
+    report['build'] = git_describe() if clientbin == args.clientbin else os.path.abspath(clientbin)
+    report['clientbin'] = os.path.abspath(clientbin)
+    report['date'] = time.strftime('%Y-%m-%dT%H:%M:%S')
+    return report
+
+
+def fmt_rate(v):
+    for sfx in ('', 'k', 'M', 'G'):
+        if abs(v) < 1000.0:
+            return '{:7.2f} {}'.format(v, sfx)
+        v /= 1000.0
+    return '{:7.2f} T'.format(v)
+
+
+def print_report(report):
+    print('{}  {}  {} cpus'.format(report.get('build', '?'), report.get('date', '?'), report.get('cpus', '?')))
+    print('  {:<22} {:<8} {:>11} {:>8}  {}'.format('case', 'unit', 'ops/s', 'stddev', 'status'))
+    for c in report['cases']:
+        if 'mean' in c:
+            cv = 100.0 * c['stddev'] / c['mean'] if c['mean'] else 0.0
+            print('  {:<22} {:<8} {:>11} {:7.2f}%  {}'.format(c['name'], c['unit'], fmt_rate(c['mean']), cv, c['status']))
+        else:
+            print('  {:<22} {:<8} {:>11} {:>8}  {}'.format(c['name'], c['unit'], '', '', c['status']))
+
+
+def compare(old, new, threshold):
+    print('old: {}  {}'.format(old.get('build', '?'), old.get('date', '?')))
+    print('new: {}  {}'.format(new.get('build', '?'), new.get('date', '?')))
+    print('  {:<22} {:>11} {:>11} {:>9}  {}'.format('case', 'old ops/s', 'new ops/s', 'change', ''))
+    oldcases = {c['name']: c for c in old['cases']}
+    regressions = 0
+    for n in new['cases']:
+        o = oldcases.get(n['name'])
+        if o is None or 'mean' not in o or 'mean' not in n:
+            print('  {:<22} {:>11} {:>11} {:>9}  {}'.format(n['name'], '', '', '', 'n/a'))
+            continue
+        change = 100.0 * (n['mean'] - o['mean']) / o['mean']
+        noise = 2.0 * math.sqrt(o['stddev'] ** 2 + n['stddev'] ** 2)
+        verdict = ''
+        if change < -threshold and (o['mean'] - n['mean']) > noise:
+            verdict = 'REGRESSION'
+            regressions += 1
+        elif change > threshold and (n['mean'] - o['mean']) > noise:
+            verdict = 'faster'
+        print('  {:<22} {:>11} {:>11} {:>8.1f}%  {}'.format(n['name'], fmt_rate(o['mean']), fmt_rate(n['mean']), change, verdict))
+    print('{} regression(s) beyond {}%'.format(regressions, threshold))
+    return 1 if regressions else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Proxmark3 client offline benchmarks')
+    parser.add_argument('-r', '--reps', type=int, default=5, help='repetitions per case (default 5)')
+    parser.add_argument('-t', '--time', type=int, default=200, help='minimum ms of a micro repetition (default 200)')
+    parser.add_argument('-n', '--name', help='only cases whose name contains this')
+    parser.add_argument('-o', '--output', help='write the JSON report here')
+    parser.add_argument('--clientbin', default=os.path.join(PM3PATH, 'client', 'proxmark3'))
+    parser.add_argument('--no-host', action='store_true', help='skip the host tools')
+    parser.add_argument('--baseline', metavar='CLIENTBIN', help='also run this client and compare against it')
+    parser.add_argument('--compare', nargs=2, metavar=('OLD', 'NEW'), help='compare two reports')
+    parser.add_argument('--threshold', type=float, default=5.0, help='regression threshold in %% (default 5)')
+    args = parser.parse_args()
+
+    if args.compare:
+        with open(args.compare[0]) as f:
+            old = json.load(f)
+        with open(args.compare[1]) as f:
+            new = json.load(f)
+        return compare(old, new, args.threshold)
+
+    if not os.access(args.clientbin, os.X_OK):
+        sys.stderr.write('Error: {} not found, build the client first\n'.format(args.clientbin))
+        return 2
+
+    new = collect(args, args.clientbin)
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(new, f, indent=2)
+        print('report written to {}'.format(args.output))
+
+    failed = any(c['status'] == 'fail' for c in new['cases'])
+    if args.baseline:
+        old = collect(args, args.baseline)
+        res = compare(old, new, args.threshold)
+    else:
+        print_report(new)
+        res = 0
+    return 1 if failed else res
+
+
+if __name__ == '__main__':
+    sys.exit(main())
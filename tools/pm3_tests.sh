@@ -27,6 +27,7 @@ TESTNONCE2KEY=false
 TESTMFNONCEBRUTE=false
 TESTMFDAESBRUTE=false
 TESTMFULCDESBRUTE=false
+TESTPM3VIRTUAL=false
 TESTHITAG2CRACK=false
 TESTCRYPTORF=false
 TESTFPGACOMPRESS=false
@@ -42,7 +43,7 @@ while (( "$#" )); do
   case "$1" in
     -h|--help)
       echo """
-Usage: $0 [--long] [--opencl] [--clientbin /path/to/proxmark3] [mfkey|nonce2key|mf_nonce_brute|staticnested|mfd_aes_brute|mfulc_des_brute|cryptorf|fpga_compress|bootrom|armsrc|client|recovery|common]
+Usage: $0 [--long] [--opencl] [--clientbin /path/to/proxmark3] [mfkey|nonce2key|mf_nonce_brute|staticnested|mfd_aes_brute|mfulc_des_brute|pm3_virtual|cryptorf|fpga_compress|bootrom|armsrc|client|recovery|common]
     --long:          Enable slow tests
     --opencl:        Enable tests requiring OpenCL (preferably a Nvidia GPU)
     --clientbin ...: Specify path to proxmark3 binary to test
@@ -102,6 +103,11 @@ Usage: $0 [--long] [--opencl] [--clientbin /path/to/proxmark3] [mfkey|nonce2key|
       TESTMFULCDESBRUTE=true
       shift
       ;;
+    pm3_virtual)
+      TESTALL=false
+      TESTPM3VIRTUAL=true
+      shift
+      ;;
     fpga_compress)
       TESTALL=false
       TESTFPGACOMPRESS=true
@@ -343,6 +349,7 @@ while true; do
       if ! CheckExecute "staticnested_2nt test"                "$STATICNESTED2NTBIN 461dce03 7eef3586 7fa28c7e 322bc14d 7f62b3d6" "\[ 2 \].*ffffffffff40.*"; then break; fi
       if ! CheckExecute "staticnested_2x1nt_rf08s test"        "$STATICNESTED2X1NTBIN keys_5c467f63_00_456ace4e.dic keys_5c467f63_00_e56f9fa2.dic; rm keys_5c467f63_00_456ace4e.dic keys_5c467f63_00_e56f9fa2.dic; grep ffffffffff keys_5c467f63_00_456ace4e_filtered.dic" "fffffffffff1"; then break; fi
       if ! CheckExecute "staticnested_2x1nt_rf08s_1key test"        "$STATICNESTED2X11KNTBIN 456ace4e fffffffffff1 keys_5c467f63_00_e56f9fa2_filtered.dic; rm keys_5c467f63_00_456ace4e_filtered.dic keys_5c467f63_00_e56f9fa2_filtered.dic" "MATCH: key2=fffffffffff2"; then break; fi
+      if ! CheckExecute "pm3_crack_queue test"                "$PYTHON tools/mfc/pm3_crack_queue.py --selftest 2>&1" "Selftest.*\(.*ok.*\)"; then break; fi
     fi
     if $TESTALL || $TESTNONCE2KEY; then
       echo -e "\n${C_BLUE}Testing nonce2key:${C_NC} ${NONCE2KEYBIN:=./tools/mfc/card_only/nonce2key}"
@@ -352,8 +359,10 @@ while true; do
     if $TESTALL || $TESTMFNONCEBRUTE; then
       echo -e "\n${C_BLUE}Testing mf_nonce_brute:${C_NC} ${MFNONCEBRUTEBIN:=./tools/mfc/card_reader/mf_nonce_brute}"
       if ! CheckFileExist "mf_nonce_brute exists"          "$MFNONCEBRUTEBIN"; then break; fi
-      if ! CheckExecute slow "mf_nonce_brute test 1/2"         "$MFNONCEBRUTEBIN 9c599b32 5a920d85 1011 98d76b77 d6c6e870 0000 ca7e0b63 0111 3e709c8a" "Key found \[.*ffffffffffff.*\]"; then break; fi
-      if ! CheckExecute slow "mf_nonce_brute test 2/2"         "$MFNONCEBRUTEBIN 96519578 d7e3c6ac 0011 cd311951 9da49e49 0010 2bb22e00 0100 a4f7f398" "Key found \[.*3b7e4fd575ad.*\]"; then break; fi
+      if ! CheckExecute "mf_nonce_brute bitslice test"       "$MFNONCEBRUTEBIN --bench" "bitslice u64 .*ok"; then break; fi
+      if ! CheckExecute slow "mf_nonce_brute test 1/3"         "$MFNONCEBRUTEBIN 9c599b32 5a920d85 1011 98d76b77 d6c6e870 0000 ca7e0b63 0111 3e709c8a" "Key found \[.*ffffffffffff.*\]"; then break; fi
+      if ! CheckExecute slow "mf_nonce_brute test 2/3"         "$MFNONCEBRUTEBIN 96519578 d7e3c6ac 0011 cd311951 9da49e49 0010 2bb22e00 0100 a4f7f398" "Key found \[.*3b7e4fd575ad.*\]"; then break; fi
+      if ! CheckExecute slow "mf_nonce_brute test 3/3"         "$MFNONCEBRUTEBIN 11223344 b8cb192e 1101 783a458b 3fb52e3f 0111 5227344d 1111 7d19b485" "Key found \[.*4a6f1d2c3b5e.*\] - .*matches candidate"; then break; fi
     fi
     if $TESTALL || $TESTMFDAESBRUTE; then
       echo -e "\n${C_BLUE}Testing mfd_aes_brute:${C_NC} ${MFDASEBRUTEBIN:=./tools/mfd_aes_brute/mfd_aes_brute}"
@@ -371,6 +380,21 @@ while true; do
       # Reader RndB nonce key recovery
       if ! CheckExecute "mfulc_des_brute test 2/3"        "$MFULCDESBRUTEBIN -r EC9C5CF763244367 2283BFE8DEBE1780922327794D0706EF 48444C4A4044524200000000544E5846 3 4" "48444C4A40445242204E4042544E5846"; then break; fi
     fi
+    if $TESTALL || $TESTPM3VIRTUAL; then
+      echo -e "\n${C_BLUE}Testing pm3_virtual:${C_NC} ${PM3VIRTUALBIN:=./tools/pm3_virtual/pm3_virtual}"
+      if ! CheckFileExist "pm3_virtual exists"            "$PM3VIRTUALBIN"; then break; fi
+      if ! CheckFileExist "proxmark3 exists"              "${CLIENTBIN:=./client/proxmark3}"; then break; fi
+      if ! CheckExecute "pm3_virtual ping"                "$PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hw ping -l 512'" "Ping response received.*content \( ok \)"; then break; fi
+      if ! CheckExecute "pm3_virtual bigbuf download"     "$PM3VIRTUALBIN -b traces/lf_ATA5577_em410x.pm3 -- $CLIENTBIN -p %p -c 'data samples -n 10000; lf em 410x demod'" "EM 410x ID 0F0368568B"; then break; fi
+      if ! CheckExecute "pm3_virtual hf mf fchk"          "H=\$(mktemp -d); HOME=\$H $PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hf mf fchk --1k -f mfc_default_keys'; rm -rf \$H" "015 \| 063 \| AABBCCDDEEFF \| 1 \| 714C5C886E97 \| 1"; then break; fi
+      if ! CheckExecute "pm3_virtual hf mf fchk adaptive"  "H=\$(mktemp -d); T=\$(HOME=\$H $PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hf mf fchk --1k -f mfc_default_keys --no-adapt' | grep -E '^\[\+\]  0[0-9]{2} \| '); A=\$(HOME=\$H $PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hf mf fchk --1k -f mfc_default_keys; hf mf fchk --1k -f mfc_default_keys' | grep -E '^\[\+\]  0[0-9]{2} \| ' | tail -n 16); rm -rf \$H; [ -n \"\$T\" ] && [ \"\$T\" == \"\$A\" ] && echo 'same key table'" "same key table"; then break; fi
+      if ! CheckExecute "pm3_virtual hw perf"             "$PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hw perf --on; hf mf fchk --1k -f mfc_default_keys --no-adapt; hw perf'" "comms.roundtrip +\| +us \| +[1-9]"; then break; fi
+      if ! CheckExecute "pm3_virtual bulk download stats" "$PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hw perf --on; data samples -n 20000; hw perf'" "comms.bulk.bytes +\| bytes \| +1 \| +20000 \|"; then break; fi
+      if ! CheckExecute "pm3_virtual hf mf rdsc"          "$PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hf mf rdsc -s 15 -k AABBCCDDEEFF'" "63 \| AA BB CC DD EE FF FF 07 80 69 71 4C 5C 88 6E 97"; then break; fi
+      if ! CheckExecute "pm3_virtual hf mf dump --fast"   "$PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hf mf dump --1k --fast --ns -k tools/pm3_virtual/hf-mf-11223344-key.bin'" "Read 64 blocks in 16 requests"; then break; fi
+      if ! CheckExecute "pm3_virtual hf mf autopwn resume"  "H=\$(mktemp -d); HOME=\$H $PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hf mf autopwn --1k' >/dev/null; HOME=\$H $PM3VIRTUALBIN -- $CLIENTBIN -p %p -c 'hf mf autopwn --1k'; rm -rf \$H" \
+                                                                     "Resuming session .*hf-mf-11223344-session.json, 32 of 32 keys known"; then break; fi
+    fi
     if $TESTALL || $TESTCRYPTORF; then
       echo -e "\n${C_BLUE}Testing CryptoRF sma:${C_NC} ${CRYPTRFBRUTEBIN:=./tools/cryptorf/sma} ${CRYPTRF_MULTI_BRUTEBIN:=./tools/cryptorf/sma_multi}"
       if ! CheckFileExist "sma exists"               "$CRYPTRFBRUTEBIN"; then break; fi
@@ -468,10 +492,23 @@ while true; do
       if ! CheckExecute "data qrcode invalid hex" "$CLIENTBIN -c 'data qrcode -d zz' 2>&1" "QR data must contain only hex characters"; then break; fi
       if ! CheckExecute "data qrcode odd hex"     "$CLIENTBIN -c 'data qrcode -d a' 2>&1" "QR data must contain an even number of hex digits"; then break; fi
       if ! CheckExecute "data qrcode spaced hex"  "$CLIENTBIN -c 'data qrcode -d \"aa bb\"' 2>&1" "Spaces are not supported; encode a space byte as 20"; then break; fi
+      if ! CheckExecute "data fft kernel test"    "$CLIENTBIN -c 'data fft --test'" "DSP self test \( ok \)"; then break; fi
+      if ! CheckExecute "data fitscore threaded"  "$CLIENTBIN -c 'data load -f traces/lf_ATA5577_hid.pm3; data fitscore --threads 4 --top 1'" "best fit... FSK / raw at clock 50.00"; then break; fi
+      if ! CheckExecute "lf t55xx bruteforce quick check" "$CLIENTBIN -c 'lf t55xx bruteforce --test'" "bruteforce quick check \( ok \)"; then break; fi
       if ! CheckExecute "mfu pwdgen test"         "$CLIENTBIN -c 'hf mfu pwdgen --test'" "Selftest ok"; then break; fi
       if ! CheckExecute "mfu keygen test"         "$CLIENTBIN -c 'hf mfu keygen --uid 11223344556677'" "80 B1 C2 71 D8 A0"; then break; fi
       if ! CheckExecute "jooki encode test"       "$CLIENTBIN -c 'hf jooki encode --test'" "04 28 F4 DA F0 4A 81  \( ok \)"; then break; fi
       if ! CheckExecute "analyse regex selftest"  "$CLIENTBIN -c 'analyse regex --test'" "Tests \( ok \)"; then break; fi
+      if ! CheckExecute "analyse crc selftest"    "$CLIENTBIN -c 'analyse crc --bench'" "CRC tables \( ok \)"; then break; fi
+      if ! CheckExecute "analyse crcsearch test"  "$CLIENTBIN -c 'analyse crcsearch --test'" "CRC search \( ok \)"; then break; fi
+      if ! CheckExecute "hw perf crypto1 counter" "$CLIENTBIN -c 'hw perf --on; hf mf decrypt --nt b830049b --ar 9248314a --at 9280e203 -d 41e586f9; hw perf'" "crypto1.recovery +\| +us \| +1 \|"; then break; fi
+      if ! CheckExecute "analyse bench verified kernels" "$CLIENTBIN -c 'analyse bench -n iclass -r 2 -t 20'" "Benchmarks \( ok \)"; then break; fi
+      if ! CheckExecute "resource cache lookups"         "$CLIENTBIN -c 'analyse bench -n rescache -r 2 -t 20'" "Benchmarks \( ok \)"; then break; fi
+      if ! CheckExecute "emv tlv parse and lookup"       "$CLIENTBIN -c 'analyse bench -n emv.tlv -r 2 -t 20'" "Benchmarks \( ok \)"; then break; fi
+      if ! CheckExecute "emv roca fingerprint test"      "$CLIENTBIN -c 'analyse bench -n emv.roca -r 2 -t 20'" "Benchmarks \( ok \)"; then break; fi
+      if ! CheckExecute "lfdemod kernels on all traces"  "$CLIENTBIN -c 'analyse bench -n lfdemod.all -r 2 -t 20'" "Benchmarks \( ok \)"; then break; fi
+      if ! CheckExecute "reveng search test"      "$CLIENTBIN -c 'reveng -g 3132333435363738393dbb'" "CRC-16/ARC"; then break; fi
+      if ! CheckExecute "reveng sweep test"       "$CLIENTBIN -c 'reveng -w 8 -F -s 00112233445566777b a1b2c3d4e5f6071898 5a5a5a5a00ff00ff9a'" "poly=0x07  init=0x00"; then break; fi
       if ! CheckExecute "trace load/list 14a"     "$CLIENTBIN -c 'trace load -f traces/hf_14a_mfu.trace; trace list -1 -t 14a;'" "READBLOCK\(8\)"; then break; fi
       if ! CheckExecute "trace load/list x"       "$CLIENTBIN -c 'trace load -f traces/hf_14a_mfu.trace; trace list -x1 -t 14a;'" "0.0101840425"; then break; fi
       if ! CheckExecute "nfc decode test oob"             "$CLIENTBIN -c 'nfc decode -d DA2010016170706C69636174696F6E2F766E642E626C7565746F6F74682E65702E6F6F62301000649201B96DFB0709466C65782032'" "Flex 2"; then break; fi
@@ -511,6 +548,8 @@ while true; do
 
       echo -e "\n${C_BLUE}Testing LF:${C_NC}"
       if ! CheckExecute "lf hitag2 test"             "$CLIENTBIN -c 'lf hitag test'" "Tests \( ok"; then break; fi
+      if ! CheckExecute "lf hitag2 lookup test"      "$CLIENTBIN -c 'lf hitag lookup --uid 11223344 --nrar 73AA5A628039693D --nrar 0102030406EA1777'" "Found valid key \[ 4F4E4D494B52 \]"; then break; fi
+      if ! CheckExecute slow "lf hitag2 crack5 test"      "$CLIENTBIN -c 'lf hitag crack5 --uid 12345678 --nrar 71DA20AA7EFDF3FA --nrar 2A4265F959653B07'" "Found valid key \[ AABBCCDDEEFF \]"; then break; fi
       if ! CheckExecute "lf cotag demod test 1/4"    "$CLIENTBIN -c 'data load -f traces/lf_cotag_220_8331.pm3; lf cotag demod -c 272 -v'" \
                                                                      "data hex:     0    0    0    0    0    0    0    0    0    0    0    0    0    1    0    5    8    2    4    E    0    0    0    0    8    0    2    3    D    F    7    7"; then break; fi
       if ! CheckExecute "lf cotag demod test 2/4"    "$CLIENTBIN -c 'data load -f traces/cotag/lf_cotag_passive_02402447_700000.pm3; lf cotag demod -v'" \
@@ -630,9 +669,14 @@ while true; do
       if ! CheckExecute "lf T55 visa2000 test"              "$CLIENTBIN -c 'data load -f traces/lf_ATA5577_visa2000.pm3; lf search -1'" "Visa2000 ID found"; then break; fi
       if ! CheckExecute "lf T55 visa2000 test 2"            "$CLIENTBIN -c 'data load -f traces/lf_ATA5577_visa2000.pm3; lf visa2000 demod'" \
                                                                      "Visa2000 - Card 112233, Raw: 564953320001B66900000183"; then break; fi
+      if ! CheckExecute "lf monitor streamed traces"        "$CLIENTBIN -c 'lf monitor -f traces/lf_ATA5577_em410x.pm3 -f traces/lf_ATA5577_hid.pm3 -f traces/lf_ATA5577_io.pm3 -c 333'" \
+                                                                     "3 ID\(s\) reported"; then break; fi
+      if ! CheckExecute "lf monitor streamed hid"           "$CLIENTBIN -c 'lf monitor -f traces/lf_ATA5577_em410x.pm3 -f traces/lf_ATA5577_hid.pm3 --hid'" \
+                                                                     "HID Prox raw 2006ec0c86 - 26 bit H10301, FC: 118  CN: 1603"; then break; fi
 
       echo -e "\n${C_BLUE}Testing HF:${C_NC}"
       if ! CheckExecute "hf mf offline text"               "$CLIENTBIN -c 'hf mf'" "content from tag dump file"; then break; fi
+      if ! CheckExecute "hf mf keystats simulation"        "$CLIENTBIN -c 'hf mf keystats --sim 100'" "Round trips saved [1-9][0-9.]* %"; then break; fi
       if ! CheckExecute slow retry ignore "hf mf hardnested long test"  "$CLIENTBIN -c 'hf mf hardnested -t --tk 000000000000'" "found:"; then break; fi
       if ! CheckExecute slow "hf iclass loclass long test" "$CLIENTBIN -c 'hf iclass loclass --long'" "verified \( ok \)"; then break; fi
       if ! CheckExecute slow "emv long test"               "$CLIENTBIN -c 'emv test -l'" "Tests \( ok"; then break; fi
@@ -640,6 +684,7 @@ while true; do
                                                                 "valid key AEA684A6DAB23278"; then break; fi
       if ! CheckExecute "hf iclass loclass test"         "$CLIENTBIN -c 'hf iclass loclass --test'" "Key diversification \( ok \)"; then break; fi
       if ! CheckExecute "emv test"                       "$CLIENTBIN -c 'emv test'" "Tests \( ok"; then break; fi
+      if ! CheckExecute "hf emrtd test"                  "$CLIENTBIN -c 'hf emrtd test'" "Tests \( ok"; then break; fi
       if ! CheckExecute "hf cipurse test"                "$CLIENTBIN -c 'hf cipurse test'" "Tests \( ok"; then break; fi
       if ! CheckExecute "hf mfdes test"                  "$CLIENTBIN -c 'hf mfdes test'"   "Tests \( ok"; then break; fi
       if ! CheckExecute "hf gst test"                    "$CLIENTBIN -c 'hf gst test'"     "Tests \( ok"; then break; fi
@@ -0,0 +1,1137 @@
+//-----------------------------------------------------------------------------
+// Copyright (C) Proxmark3 contributors. See AUTHORS.md for details.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// See LICENSE.txt for the text of the license.
+//-----------------------------------------------------------------------------
+// Virtual Proxmark3
+//
+// Speaks the NG / OLD frame protocol of include/pm3_cmd.h over a TCP socket
+// or a pty, so the client, its transports and its scripts can be run and
+// timed without a device.  Emulated are ping, capabilities, version, BigBuf
+// and emulator memory downloads, the trace log, and a MIFARE Classic card
+// behind the ISO14443A reader, `hf mf chk`, `hf mf fchk` and block reads,
+// single or batched after one authentication.
+//
+// The card model does not run Crypto1, keys are compared in plain and the
+// trace log holds plain frames.
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "common.h"
+#include "pm3_cmd.h"
+#include "mifare.h"
+#include "protocols.h"
+#include "crc16.h"
+#include "commonutil.h"
+#include "parity.h"
+#include "util_posix.h"
+
+#define VPM3_BIGBUF_SIZE        40000
+#define VPM3_MAX_SECTORS        40
+#define VPM3_CHIP_ID            0x270B0A40      // AT91SAM7S512 Rev A
+#define VPM3_SELECT_NO_ATS      2
+
+#define MIFARE_KEY_SIZE         6
+#define MIFARE_BLOCK_SIZE       16
+
+// per sector keys as the firmware returns them from fast chk
+typedef struct {
+    uint8_t keyA[MIFARE_KEY_SIZE];
+    uint8_t keyB[MIFARE_KEY_SIZE];
+} PACKED vpm3_sector_t;
+
+typedef struct {
+    uint8_t bigbuf[VPM3_BIGBUF_SIZE];
+    uint32_t tracelen;
+    uint32_t ticks;                 // trace clock, carrier periods
+    uint8_t eml[4096];
+    sample_config lfconfig;
+
+    // card
+    uint8_t card[4096];
+    uint8_t sectors;
+    iso14a_card_select_t sel;
+
+    // hf mf fchk, kept across key chunks like the firmware does
+    vpm3_sector_t k_sector[VPM3_MAX_SECTORS];
+    uint8_t found[2 * VPM3_MAX_SECTORS];
+    uint8_t foundkeys;
+
+    // options
+    uint32_t cmd_delay_us;
+    uint32_t auth_delay_us;
+    bool verbose;
+
+    // statistics
+    uint64_t frames_in;
+    uint64_t frames_out;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t auths;
+} vpm3_t;
+
+static vpm3_t g_vpm3;
+static int g_conn = -1;
+static volatile sig_atomic_t g_stop = 0;
+
+// Default card keys, taken from different depths of mfc_default_keys.dic
+static const uint64_t default_keys[] = {
+    0xFFFFFFFFFFFF, 0xA0A1A2A3A4A5, 0xD3F7D3F7D3F7, 0xB0B1B2B3B4B5,
+    0x4D3A99C351DD, 0x1A982C7E459A, 0xAABBCCDDEEFF, 0x714C5C886E97,
+    0x587EE5F9350F, 0xA0478CC39091, 0x533CB6C723F6, 0x8FD0A4F256E9,
+};
+
+//-----------------------------------------------------------------------------
+// transport
+//-----------------------------------------------------------------------------
+static bool io_read(int fd, void *buf, size_t len) {
+    uint8_t *p = buf;
+    while (len) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool io_write(int fd, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    while (len) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static int reply_raw(const void *buf, size_t len) {
+    if (io_write(g_conn, buf, len) == false) {
+        return PM3_EIO;
+    }
+    g_vpm3.frames_out++;
+    g_vpm3.bytes_out += len;
+    return PM3_SUCCESS;
+}
+
+// NG frames carry the placeholder postamble, the client accepts it like it
+// does on USB.
+static int reply_ng_internal(uint16_t cmd, int8_t status, const uint8_t *data, size_t len, bool ng) {
+    PacketResponseNGRaw tx;
+
+    if (len > PM3_CMD_DATA_SIZE) {
+        len = PM3_CMD_DATA_SIZE;
+    }
+
+    tx.pre.magic = RESPONSENG_PREAMBLE_MAGIC;
+    tx.pre.cmd = cmd;
+    tx.pre.status = status;
+    tx.pre.reason = 0;
+    tx.pre.ng = ng;
+    tx.pre.length = len;
+    if (data && len) {
+        memcpy(tx.data, data, len);
+    }
+
+    PacketResponseNGPostamble *post = (PacketResponseNGPostamble *)(tx.data + len);
+    post->crc = RESPONSENG_POSTAMBLE_MAGIC;
+    return reply_raw(&tx, sizeof(PacketResponseNGPreamble) + len + sizeof(PacketResponseNGPostamble));
+}
+
+static int reply_ng(uint16_t cmd, int8_t status, const uint8_t *data, size_t len) {
+    return reply_ng_internal(cmd, status, data, len, true);
+}
+
+static int reply_mix(uint64_t cmd, uint64_t arg0, uint64_t arg1, uint64_t arg2, const void *data, size_t len) {
+    uint64_t buf[PM3_CMD_DATA_SIZE / sizeof(uint64_t)] = {0};
+    buf[0] = arg0;
+    buf[1] = arg1;
+    buf[2] = arg2;
+    if (len > PM3_CMD_DATA_SIZE_MIX) {
+        len = PM3_CMD_DATA_SIZE_MIX;
+    }
+    if (data && len) {
+        memcpy(buf + 3, data, len);
+    }
+    return reply_ng_internal(cmd, PM3_SUCCESS, (uint8_t *)buf, len + (3 * sizeof(uint64_t)), false);
+}
+
+static int reply_old(uint64_t cmd, uint64_t arg0, uint64_t arg1, uint64_t arg2, const void *data, size_t len) {
+    PacketResponseOLD tx = {cmd, {arg0, arg1, arg2}, {{0}}};
+    if (len > PM3_CMD_DATA_SIZE) {
+        len = PM3_CMD_DATA_SIZE;
+    }
+    if (data && len) {
+        memcpy(tx.d.asBytes, data, len);
+    }
+    return reply_raw(&tx, sizeof(tx));
+}
+
+// Same framing rules as receive_ng() in armsrc/cmd.c
+static int receive_ng(PacketCommandNG *rx) {
+    PacketCommandNGRaw raw;
+
+    if (io_read(g_conn, &raw.pre, sizeof(PacketCommandNGPreamble)) == false) {
+        return PM3_EIO;
+    }
+
+    memset(rx, 0, sizeof(PacketCommandNG));
+
+    if (raw.pre.magic == COMMANDNG_PREAMBLE_MAGIC) {
+        uint16_t length = raw.pre.length;
+        if (length > PM3_CMD_DATA_SIZE) {
+            return PM3_EOVFLOW;
+        }
+        if (io_read(g_conn, raw.data, length + sizeof(PacketCommandNGPostamble)) == false) {
+            return PM3_EIO;
+        }
+
+        PacketCommandNGPostamble post;
+        memcpy(&post, raw.data + length, sizeof(post));
+        if (post.crc != COMMANDNG_POSTAMBLE_MAGIC) {
+            uint8_t first, second;
+            compute_crc(CRC_14443_A, (uint8_t *)&raw, sizeof(PacketCommandNGPreamble) + length, &first, &second);
+            if ((first << 8) + second != post.crc) {
+                return PM3_ECRC;
+            }
+        }
+
+        rx->magic = raw.pre.magic;
+        rx->ng = raw.pre.ng;
+        rx->cmd = raw.pre.cmd;
+        rx->crc = post.crc;
+        g_vpm3.bytes_in += sizeof(PacketCommandNGPreamble) + length + sizeof(PacketCommandNGPostamble);
+
+        if (rx->ng) {
+            rx->length = length;
+            memcpy(rx->data.asBytes, raw.data, length);
+        } else {
+            if (length < 3 * sizeof(uint64_t)) {
+                return PM3_EIO;
+            }
+            memcpy(rx->oldarg, raw.data, 3 * sizeof(uint64_t));
+            rx->length = length - (3 * sizeof(uint64_t));
+            memcpy(rx->data.asBytes, raw.data + (3 * sizeof(uint64_t)), rx->length);
+        }
+    } else {
+        PacketCommandOLD old;
+        memcpy(&old, &raw.pre, sizeof(PacketCommandNGPreamble));
+        if (io_read(g_conn, ((uint8_t *)&old) + sizeof(PacketCommandNGPreamble), sizeof(old) - sizeof(PacketCommandNGPreamble)) == false) {
+            return PM3_EIO;
+        }
+        rx->ng = false;
+        rx->magic = 0;
+        rx->crc = 0;
+        rx->cmd = old.cmd;
+        memcpy(rx->oldarg, old.arg, sizeof(old.arg));
+        rx->length = PM3_CMD_DATA_SIZE;
+        memcpy(rx->data.asBytes, old.d.asBytes, rx->length);
+        g_vpm3.bytes_in += sizeof(old);
+    }
+    g_vpm3.frames_in++;
+    return PM3_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+// trace log, same layout as LogTrace() in armsrc/BigBuf.c
+//-----------------------------------------------------------------------------
+static void trace_clear(void) {
+    g_vpm3.tracelen = 0;
+    g_vpm3.ticks = 0;
+}
+
+static void trace_log(const uint8_t *frame, uint16_t len, bool reader2tag) {
+    uint16_t num_par = ((len - 1) / 8) + 1;
+    uint32_t entry = sizeof(tracelog_hdr_t) + len + num_par;
+
+    if (len == 0 || g_vpm3.tracelen + entry >= VPM3_BIGBUF_SIZE) {
+        return;
+    }
+
+    // 9 bits a byte at 106 kbit/s, 128 carrier periods a bit
+    uint32_t duration = len * 9 * 128;
+
+    tracelog_hdr_t *hdr = (tracelog_hdr_t *)(g_vpm3.bigbuf + g_vpm3.tracelen);
+    hdr->timestamp = g_vpm3.ticks;
+    hdr->duration = (duration > 0xFFFF) ? 0xFFFF : duration;
+    hdr->data_len = len;
+    hdr->isResponse = (reader2tag == false);
+    memcpy(hdr->frame, frame, len);
+
+    uint8_t *par = hdr->frame + len;
+    memset(par, 0, num_par);
+    for (uint16_t i = 0; i < len; i++) {
+        par[i >> 3] |= oddparity8(frame[i]) << (7 - (i & 7));
+    }
+
+    g_vpm3.tracelen += entry;
+    g_vpm3.ticks += duration + 1172;
+}
+
+static void trace_log_crc(uint8_t *frame, uint16_t len, bool reader2tag) {
+    compute_crc(CRC_14443_A, frame, len, &frame[len], &frame[len + 1]);
+    trace_log(frame, len + 2, reader2tag);
+}
+
+//-----------------------------------------------------------------------------
+// MIFARE Classic card model
+//-----------------------------------------------------------------------------
+static uint16_t mf_first_block(uint8_t sector) {
+    return (sector < 32) ? (sector * 4) : (128 + ((sector - 32) * 16));
+}
+
+static uint8_t mf_blocks_in(uint8_t sector) {
+    return (sector < 32) ? 4 : 16;
+}
+
+static uint8_t mf_sector_of(uint16_t block) {
+    return (block < 128) ? (block / 4) : (32 + ((block - 128) / 16));
+}
+
+static uint16_t mf_block_count(void) {
+    return mf_first_block(g_vpm3.sectors);
+}
+
+static uint8_t *mf_trailer(uint8_t sector) {
+    return g_vpm3.card + ((mf_first_block(sector) + mf_blocks_in(sector) - 1) * 16);
+}
+
+// C1 C2 C3 of a block, as a three bit number
+static uint8_t mf_acl(uint16_t block) {
+    uint8_t sector = mf_sector_of(block);
+    uint8_t n = block - mf_first_block(sector);
+    uint8_t group = (sector < 32) ? n : ((n == 15) ? 3 : n / 5);
+    const uint8_t *t = mf_trailer(sector);
+
+    return (((t[7] >> (4 + group)) & 1) << 2) | (((t[8] >> group) & 1) << 1) | ((t[8] >> (4 + group)) & 1);
+}
+
+static void mf_select(void) {
+    uint8_t f[8];
+
+    f[0] = ISO14443A_CMD_WUPA;
+    trace_log(f, 1, true);
+    trace_log(g_vpm3.sel.atqa, 2, false);
+
+    f[0] = ISO14443A_CMD_ANTICOLL_OR_SELECT;
+    f[1] = 0x20;
+    trace_log(f, 2, true);
+    memcpy(f, g_vpm3.sel.uid, 4);
+    f[4] = f[0] ^ f[1] ^ f[2] ^ f[3];
+    trace_log(f, 5, false);
+
+    uint8_t sel[9] = { ISO14443A_CMD_ANTICOLL_OR_SELECT, 0x70 };
+    memcpy(sel + 2, f, 5);
+    trace_log_crc(sel, 7, true);
+    f[0] = g_vpm3.sel.sak;
+    trace_log_crc(f, 1, false);
+}
+
+static bool mf_auth(uint16_t block, uint8_t keytype, const uint8_t *key) {
+
+    g_vpm3.auths++;
+    if (g_vpm3.auth_delay_us) {
+        usleep(g_vpm3.auth_delay_us);
+    }
+
+    if (block >= mf_block_count()) {
+        return false;
+    }
+
+    uint8_t f[4] = { MIFARE_AUTH_KEYA + (keytype & 1), block };
+    trace_log_crc(f, 2, true);
+
+    const uint8_t *t = mf_trailer(mf_sector_of(block));
+    if (memcmp(t + ((keytype & 1) ? 10 : 0), key, MIFARE_KEY_SIZE) != 0) {
+        return false;
+    }
+
+    // tag nonce, derived from the block so traces are reproducible
+    uint8_t nt[4] = { 0x01, 0x20, 0x14, block };
+    trace_log(nt, sizeof(nt), false);
+    return true;
+}
+
+// one READ inside an authenticated session
+static int mf_read_authed(uint16_t block, uint8_t keytype, uint8_t *out) {
+
+    memset(out, 0, 16);
+
+    uint8_t f[4] = { ISO14443A_CMD_READBLOCK, block };
+    trace_log_crc(f, 2, true);
+
+    uint8_t sector = mf_sector_of(block);
+    uint8_t trailer_acl = mf_acl(mf_first_block(sector) + mf_blocks_in(sector) - 1);
+    // key B is readable, so it can not be used for data access
+    bool keyb_readable = (trailer_acl == 0 || trailer_acl == 1 || trailer_acl == 2);
+    const uint8_t *src = g_vpm3.card + (block * 16);
+
+    if (src == mf_trailer(sector)) {
+        memcpy(out + 6, src + 6, 4);
+        if (keyb_readable && keytype == MF_KEY_A) {
+            memcpy(out + 10, src + 10, 6);
+        }
+    } else {
+        uint8_t acl = mf_acl(block);
+        bool ok = (acl == 7) ? false : (acl == 3 || acl == 5) ? (keytype == MF_KEY_B) : true;
+        if (keytype == MF_KEY_B && keyb_readable) {
+            ok = false;
+        }
+        if (ok == false) {
+            f[0] = 0x04;
+            trace_log(f, 1, false);
+            return PM3_ESOFT;
+        }
+        memcpy(out, src, 16);
+    }
+
+    uint8_t resp[18];
+    memcpy(resp, out, 16);
+    trace_log_crc(resp, 16, false);
+    return PM3_SUCCESS;
+}
+
+// consecutive blocks after one select and authentication, like mifare_cmd_readblocks()
+static int mf_read(uint16_t block, uint8_t count, uint8_t keytype, const uint8_t *key, uint8_t *out) {
+
+    memset(out, 0, count * 16);
+
+    mf_select();
+    if (mf_auth(block, keytype, key) == false) {
+        return PM3_ESOFT;
+    }
+    if (mf_sector_of(block) != mf_sector_of(block + count - 1)) {
+        return PM3_ESOFT;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (mf_read_authed(block + i, keytype, out + (i * 16)) != PM3_SUCCESS) {
+            return PM3_ESOFT;
+        }
+    }
+    return PM3_SUCCESS;
+}
+
+static void card_set_uid(const uint8_t *uid) {
+    memset(&g_vpm3.sel, 0, sizeof(g_vpm3.sel));
+    memcpy(g_vpm3.sel.uid, uid, 4);
+    g_vpm3.sel.uidlen = 4;
+    g_vpm3.sel.atqa[0] = g_vpm3.card[6];
+    g_vpm3.sel.atqa[1] = g_vpm3.card[7];
+    g_vpm3.sel.sak = g_vpm3.card[5];
+}
+
+static void card_default(const uint8_t *uid) {
+
+    memset(g_vpm3.card, 0, sizeof(g_vpm3.card));
+
+    for (uint16_t b = 1; b < mf_block_count(); b++) {
+        for (int i = 0; i < 16; i++) {
+            g_vpm3.card[(b * 16) + i] = (b * 7) ^ (i * 29);
+        }
+    }
+
+    for (uint8_t s = 0; s < g_vpm3.sectors; s++) {
+        uint8_t *t = mf_trailer(s);
+        num_to_bytes(default_keys[(2 * s) % ARRAYLEN(default_keys)], 6, t);
+        num_to_bytes(default_keys[((2 * s) + 1) % ARRAYLEN(default_keys)], 6, t + 10);
+        t[6] = 0xFF;
+        t[7] = 0x07;
+        t[8] = 0x80;
+        t[9] = 0x69;
+    }
+
+    uint8_t *b0 = g_vpm3.card;
+    memcpy(b0, uid, 4);
+    b0[4] = uid[0] ^ uid[1] ^ uid[2] ^ uid[3];
+    b0[5] = (g_vpm3.sectors == 5) ? 0x09 : (g_vpm3.sectors == 16) ? 0x08 : 0x18;
+    b0[6] = (g_vpm3.sectors > 16) ? 0x02 : 0x04;
+    b0[7] = 0x00;
+    memcpy(b0 + 8, "bcdefghi", 8);
+    card_set_uid(uid);
+}
+
+static int card_load(const char *fn) {
+    FILE *f = fopen(fn, "rb");
+    if (f == NULL) {
+        printf("[!] can't open %s\n", fn);
+        return PM3_EFILE;
+    }
+    size_t n = fread(g_vpm3.card, 1, sizeof(g_vpm3.card), f);
+    fclose(f);
+
+    switch (n) {
+        case 320:
+            g_vpm3.sectors = 5;
+            break;
+        case 1024:
+            g_vpm3.sectors = 16;
+            break;
+        case 2048:
+            g_vpm3.sectors = 32;
+            break;
+        case 4096:
+            g_vpm3.sectors = 40;
+            break;
+        default:
+            printf("[!] %s: %zu bytes is not a MIFARE Classic binary dump\n", fn, n);
+            return PM3_EFILE;
+    }
+    card_set_uid(g_vpm3.card);
+    return PM3_SUCCESS;
+}
+
+// Graph values, one per line, as written by `data save`
+static int bigbuf_load(const char *fn) {
+    FILE *f = fopen(fn, "r");
+    if (f == NULL) {
+        printf("[!] can't open %s\n", fn);
+        return PM3_EFILE;
+    }
+    uint32_t n = 0;
+    int v;
+    while (n < VPM3_BIGBUF_SIZE && fscanf(f, "%d", &v) == 1) {
+        if (v < -128) {
+            v = -128;
+        }
+        if (v > 127) {
+            v = 127;
+        }
+        g_vpm3.bigbuf[n++] = v + 128;
+    }
+    fclose(f);
+    printf("[=] loaded %u samples into BigBuf\n", n);
+    return PM3_SUCCESS;
+}
+
+static void eml_clear(void) {
+    static const uint8_t trailer[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x07, 0x80, 0x69, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    memset(g_vpm3.eml, 0, sizeof(g_vpm3.eml));
+    for (uint8_t s = 0; s < VPM3_MAX_SECTORS; s++) {
+        memcpy(g_vpm3.eml + ((mf_first_block(s) + mf_blocks_in(s) - 1) * 16), trailer, sizeof(trailer));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// commands
+//-----------------------------------------------------------------------------
+static void send_capabilities(void) {
+    capabilities_t c;
+    memset(&c, 0, sizeof(c));
+    c.version = CAPABILITIES_VERSION;
+    c.baudrate = 0;
+    c.bigbuf_size = VPM3_BIGBUF_SIZE;
+    c.via_usb = true;
+    c.compiled_with_lf = true;
+    c.compiled_with_hfsniff = true;
+    c.compiled_with_iso14443a = true;
+    reply_ng(CMD_CAPABILITIES, PM3_SUCCESS, (uint8_t *)&c, sizeof(c));
+}
+
+static void send_version(void) {
+    struct {
+        uint32_t id;
+        uint32_t section_size;
+        uint32_t versionstr_len;
+        char versionstr[PM3_CMD_DATA_SIZE - 12];
+    } PACKED payload;
+
+    const char *v = " [ ARM ]\n"
+                    "  bootrom: virtual\n"
+                    "       os: virtual\n"
+                    "  compiled with GCC, host side pm3_virtual";
+    memset(&payload, 0, sizeof(payload));
+    payload.id = VPM3_CHIP_ID;
+    payload.section_size = 0;
+    payload.versionstr_len = strlen(v) + 1;
+    memcpy(payload.versionstr, v, payload.versionstr_len);
+    reply_ng(CMD_VERSION, PM3_SUCCESS, (uint8_t *)&payload, 12 + payload.versionstr_len);
+}
+
+static void download(uint16_t cmd, const uint8_t *mem, uint32_t size, uint32_t start, uint32_t len, uint32_t tracelen) {
+    if (start > size) {
+        start = size;
+    }
+    if (len > size - start) {
+        len = size - start;
+    }
+    for (uint32_t offset = 0; offset < len; offset += PM3_CMD_DATA_SIZE) {
+        uint32_t n = MIN(len - offset, PM3_CMD_DATA_SIZE);
+        if (reply_old(cmd, offset, n, tracelen, mem + start + offset, n) != PM3_SUCCESS) {
+            return;
+        }
+    }
+    reply_mix(CMD_ACK, 1, 0, tracelen, NULL, 0);
+}
+
+static void reader_14a(const PacketCommandNG *p) {
+    uint64_t flags = p->oldarg[0];
+
+    if (flags & ISO14A_CLEARTRACE) {
+        trace_clear();
+    }
+
+    if (flags & ISO14A_CONNECT) {
+        mf_select();
+        reply_mix(CMD_ACK, VPM3_SELECT_NO_ATS, g_vpm3.sel.uidlen, 0, &g_vpm3.sel, sizeof(iso14a_card_select_t));
+        if ((flags & (ISO14A_RAW | ISO14A_APDU)) == 0) {
+            return;
+        }
+    }
+
+    if (flags & ISO14A_RAW) {
+        uint16_t len = MIN(p->oldarg[1] & 0xFFFF, p->length);
+        trace_log(p->data.asBytes, len, true);
+        // a MIFARE Classic ignores RATS, GET_VERSION and friends
+        reply_mix(CMD_ACK, 0, 0, 0, NULL, 0);
+    } else if (flags & ISO14A_APDU) {
+        reply_mix(CMD_ACK, 0, 0, 0, NULL, 0);
+    }
+}
+
+static void mf_readbl(const PacketCommandNG *p) {
+    const mf_readblock_t *payload = (const mf_readblock_t *)p->data.asBytes;
+    uint8_t out[16];
+    int res = mf_read(payload->blockno, 1, payload->keytype, payload->key, out);
+    reply_ng(CMD_HF_MIFARE_READBL, res, out, sizeof(out));
+}
+
+static void mf_readbls(const PacketCommandNG *p) {
+    const mf_readblocks_t *payload = (const mf_readblocks_t *)p->data.asBytes;
+    mf_readblocks_resp_t resp = { .blockno = payload->blockno, .count = 0 };
+    int res = PM3_EINVARG;
+    if (payload->count > 0 && payload->count <= sizeof(resp.data) / 16) {
+        res = mf_read(payload->blockno, payload->count, payload->keytype, payload->key, resp.data);
+    }
+    if (res == PM3_SUCCESS) {
+        resp.count = payload->count;
+    }
+    reply_ng(CMD_HF_MIFARE_READBLS, res, (uint8_t *)&resp, 2 + (resp.count * 16));
+}
+
+static void mf_readsc(const PacketCommandNG *p) {
+    uint8_t sector = p->oldarg[0] & 0xFF;
+    uint8_t keytype = p->oldarg[1] & 0xF;
+    uint8_t out[16 * 16] = {0};
+    bool ok = (sector < g_vpm3.sectors);
+
+    uint8_t n = ok ? mf_blocks_in(sector) : 4;
+    if (ok) {
+        ok = (mf_read(mf_first_block(sector), n, keytype, p->data.asBytes, out) == PM3_SUCCESS);
+    }
+    reply_old(CMD_ACK, ok, 0, 0, out, n * 16);
+}
+
+static void mf_chkkeys(const PacketCommandNG *p) {
+    const uint8_t *d = p->data.asBytes;
+    uint8_t keytype = d[0] & 1;
+    uint8_t block = d[1];
+    uint16_t count = (d[3] << 8) | d[4];
+
+    count = MIN(count, (PM3_CMD_DATA_SIZE - 5) / MIFARE_KEY_SIZE);
+
+    if (d[2]) {
+        trace_clear();
+    }
+
+    struct {
+        uint8_t key[MIFARE_KEY_SIZE];
+        bool found;
+    } PACKED res;
+    memset(&res, 0, sizeof(res));
+
+    mf_select();
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t *key = d + 5 + (i * MIFARE_KEY_SIZE);
+        if (mf_auth(block, keytype, key)) {
+            memcpy(res.key, key, MIFARE_KEY_SIZE);
+            res.found = true;
+            break;
+        }
+    }
+    reply_ng(CMD_HF_MIFARE_CHKKEYS, PM3_SUCCESS, (uint8_t *)&res, sizeof(res));
+}
+
+// CMD_HF_MIFARE_CHKKEYS_FAST, same arguments and replies as
+// MifareChkKeys_fast() in armsrc/mifarecmd.c
+static void mf_chkkeys_fast(const PacketCommandNG *p) {
+    uint8_t sectorcnt = MIN(p->oldarg[0] & 0xFF, g_vpm3.sectors);
+    bool firstchunk = (p->oldarg[0] >> 8) & 0xF;
+    uint16_t single = (p->oldarg[0] >> 16) & 0xFFFF;
+    uint16_t count = MIN(p->oldarg[2] & 0xFF, PM3_CMD_DATA_SIZE / MIFARE_KEY_SIZE);
+    const uint8_t *keys = p->data.asBytes;
+
+    mf_select();
+
+    if ((single >> 15) & 1) {
+        for (uint16_t i = 0; i < count; i++) {
+            if (mf_auth(single & 0xFF, (single >> 8) & 1, keys + (i * MIFARE_KEY_SIZE))) {
+                reply_old(CMD_ACK, 1, 0, 0, keys + (i * MIFARE_KEY_SIZE), MIFARE_KEY_SIZE);
+                return;
+            }
+        }
+        reply_mix(CMD_ACK, 0, 0, 0, NULL, 0);
+        return;
+    }
+
+    if (firstchunk) {
+        memset(g_vpm3.k_sector, 0, sizeof(g_vpm3.k_sector));
+        memset(g_vpm3.found, 0, sizeof(g_vpm3.found));
+        g_vpm3.foundkeys = 0;
+    }
+
+    for (uint16_t i = 0; i < count && g_vpm3.foundkeys < (sectorcnt * 2); i++) {
+        const uint8_t *key = keys + (i * MIFARE_KEY_SIZE);
+        for (uint8_t s = 0; s < sectorcnt; s++) {
+            for (uint8_t kt = 0; kt < 2; kt++) {
+                if (g_vpm3.found[(s * 2) + kt]) {
+                    continue;
+                }
+                if (mf_auth(mf_first_block(s), kt, key)) {
+                    memcpy(kt ? g_vpm3.k_sector[s].keyB : g_vpm3.k_sector[s].keyA, key, MIFARE_KEY_SIZE);
+                    g_vpm3.found[(s * 2) + kt] = 1;
+                    g_vpm3.foundkeys++;
+                }
+            }
+        }
+    }
+
+    // like the firmware, every chunk reply carries the keys found so far
+    uint64_t foo = 0;
+    for (uint8_t m = 0; m < 64; m++) {
+        foo |= ((uint64_t)(g_vpm3.found[m] & 1) << m);
+    }
+    uint16_t bar = 0;
+    for (uint8_t m = 64; m < ARRAYLEN(g_vpm3.found); m++) {
+        bar |= ((uint16_t)(g_vpm3.found[m] & 1) << (m - 64));
+    }
+
+    uint8_t tmp[480 + 10] = {0};
+    memcpy(tmp, g_vpm3.k_sector, sectorcnt * sizeof(vpm3_sector_t));
+    num_to_bytes(foo, 8, tmp + 480);
+    tmp[488] = bar & 0xFF;
+    tmp[489] = (bar >> 8) & 0xFF;
+    reply_old(CMD_ACK, g_vpm3.foundkeys, 0, 0, tmp, sizeof(tmp));
+}
+
+static void eml_memset(const PacketCommandNG *p) {
+    struct p {
+        uint16_t blockno;
+        uint8_t blockcnt;
+        uint8_t blockwidth;
+        uint8_t data[];
+    } PACKED;
+    const struct p *payload = (const struct p *)p->data.asBytes;
+    uint8_t width = payload->blockwidth ? payload->blockwidth : MIFARE_BLOCK_SIZE;
+    uint32_t offset = payload->blockno * width;
+    uint32_t len = payload->blockcnt * width;
+
+    if (offset + len <= sizeof(g_vpm3.eml) && len <= PM3_CMD_DATA_SIZE - 4) {
+        memcpy(g_vpm3.eml + offset, payload->data, len);
+    }
+}
+
+static void eml_memget(const PacketCommandNG *p) {
+    struct p {
+        uint16_t blockno;
+        uint8_t blockcnt;
+        uint8_t blockwidth;
+    } PACKED;
+    const struct p *payload = (const struct p *)p->data.asBytes;
+    uint32_t offset = payload->blockno * payload->blockwidth;
+    uint32_t len = payload->blockcnt * payload->blockwidth;
+
+    if (len > PM3_CMD_DATA_SIZE || offset + len > sizeof(g_vpm3.eml)) {
+        reply_ng(CMD_HF_MIFARE_EML_MEMGET, PM3_EMALLOC, NULL, 0);
+        return;
+    }
+    reply_ng(CMD_HF_MIFARE_EML_MEMGET, PM3_SUCCESS, g_vpm3.eml + offset, len);
+}
+
+static void packet_received(const PacketCommandNG *p) {
+
+    if (g_vpm3.verbose) {
+        printf("[#] %s cmd 0x%04x len %u\n", p->ng ? "NG " : "OLD", p->cmd, p->length);
+    }
+
+    if (g_vpm3.cmd_delay_us) {
+        usleep(g_vpm3.cmd_delay_us);
+    }
+
+    switch (p->cmd) {
+        case CMD_PING:
+            reply_ng(CMD_PING, PM3_SUCCESS, p->data.asBytes, p->length);
+            break;
+        case CMD_CAPABILITIES:
+            send_capabilities();
+            break;
+        case CMD_VERSION:
+            send_version();
+            break;
+        case CMD_QUIT_SESSION:
+        case CMD_BREAK_LOOP:
+        case CMD_HF_DROPFIELD:
+        case CMD_LF_SAMPLING_SET_CONFIG:
+            break;
+        case CMD_SET_DBGMODE:
+            reply_ng(CMD_SET_DBGMODE, PM3_SUCCESS, NULL, 0);
+            break;
+        case CMD_LF_SAMPLING_GET_CONFIG:
+            reply_ng(CMD_LF_SAMPLING_GET_CONFIG, PM3_SUCCESS, (uint8_t *)&g_vpm3.lfconfig, sizeof(sample_config));
+            break;
+        case CMD_DOWNLOAD_BIGBUF:
+            download(CMD_DOWNLOADED_BIGBUF, g_vpm3.bigbuf, VPM3_BIGBUF_SIZE, p->oldarg[0], p->oldarg[1], g_vpm3.tracelen);
+            break;
+        case CMD_DOWNLOAD_EML_BIGBUF:
+            download(CMD_DOWNLOADED_EML_BIGBUF, g_vpm3.eml, sizeof(g_vpm3.eml), p->oldarg[0], p->oldarg[1], 0);
+            break;
+        case CMD_HF_MIFARE_EML_MEMCLR:
+            eml_clear();
+            reply_ng(CMD_HF_MIFARE_EML_MEMCLR, PM3_SUCCESS, NULL, 0);
+            break;
+        case CMD_HF_MIFARE_EML_MEMSET:
+            eml_memset(p);
+            break;
+        case CMD_HF_MIFARE_EML_MEMGET:
+            eml_memget(p);
+            break;
+        case CMD_HF_ISO14443A_READER:
+            reader_14a(p);
+            break;
+        case CMD_HF_MIFARE_READBL:
+            mf_readbl(p);
+            break;
+        case CMD_HF_MIFARE_READBLS:
+            mf_readbls(p);
+            break;
+        case CMD_HF_MIFARE_READSC:
+            mf_readsc(p);
+            break;
+        case CMD_HF_MIFARE_CHKKEYS:
+            mf_chkkeys(p);
+            break;
+        case CMD_HF_MIFARE_CHKKEYS_FAST:
+            mf_chkkeys_fast(p);
+            break;
+        default:
+            if (g_vpm3.verbose) {
+                printf("[!] cmd 0x%04x not emulated\n", p->cmd);
+            }
+            if (p->ng) {
+                reply_ng(p->cmd, PM3_ENOTIMPL, NULL, 0);
+            }
+            break;
+    }
+}
+
+static void serve_connection(void) {
+    PacketCommandNG rx;
+    for (;;) {
+        int res = receive_ng(&rx);
+        if (res == PM3_EIO) {
+            break;
+        }
+        if (res != PM3_SUCCESS) {
+            if (g_vpm3.verbose) {
+                printf("[!] dropped frame ( %d )\n", res);
+            }
+            continue;
+        }
+        packet_received(&rx);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// setup
+//-----------------------------------------------------------------------------
+static int open_tcp(uint16_t port, char *dev, size_t devlen) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    socklen_t alen = sizeof(addr);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+            listen(fd, 1) < 0 ||
+            getsockname(fd, (struct sockaddr *)&addr, &alen) < 0) {
+        close(fd);
+        return -1;
+    }
+    snprintf(dev, devlen, "tcp:127.0.0.1:%u", ntohs(addr.sin_port));
+    return fd;
+}
+
+static int open_pty(char *dev, size_t devlen, int *slave) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+        return -1;
+    }
+    const char *name = ptsname(fd);
+    if (name == NULL) {
+        close(fd);
+        return -1;
+    }
+    snprintf(dev, devlen, "%s", name);
+
+    // keep the slave open, the master would see EIO between two clients
+    *slave = open(name, O_RDWR | O_NOCTTY);
+    if (*slave < 0) {
+        close(fd);
+        return -1;
+    }
+    struct termios tio;
+    tcgetattr(*slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(*slave, TCSANOW, &tio);
+    return fd;
+}
+
+static pid_t spawn(char **argv, const char *dev) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+
+    for (int i = 0; argv[i]; i++) {
+        char *at = strstr(argv[i], "%p");
+        if (at == NULL) {
+            continue;
+        }
+        char *s = calloc(strlen(argv[i]) + strlen(dev) + 1, sizeof(char));
+        if (s == NULL) {
+            _exit(127);
+        }
+        memcpy(s, argv[i], at - argv[i]);
+        strcat(s, dev);
+        strcat(s, at + 2);
+        argv[i] = s;
+    }
+    execvp(argv[0], argv);
+    printf("[!] can't run %s: %s\n", argv[0], strerror(errno));
+    _exit(127);
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+static void print_help_and_exit(const char *name) {
+    printf("Virtual Proxmark3, serves the client protocol without a device\n\n");
+    printf("Usage: %s [options] [-- command ...]\n\n", name);
+    printf("  -t <port>   listen on tcp 127.0.0.1:<port>, 0 picks a free port (default)\n");
+    printf("  -p          use a pty instead of tcp\n");
+    printf("  -u <uid>    4 byte UID of the generated card, hex (default 11223344)\n");
+    printf("  -c <size>   generated card: mini, 1k, 2k or 4k (default 1k)\n");
+    printf("  -d <file>   load the card from a MIFARE Classic binary dump\n");
+    printf("  -b <file>   fill BigBuf with the samples of a .pm3 trace\n");
+    printf("  -l <us>     extra latency for every command, microseconds\n");
+    printf("  -a <us>     cost of every MIFARE authentication, microseconds\n");
+    printf("  -v          print every command received\n\n");
+    printf("With a command, %%p in its arguments is replaced by the device and the\n");
+    printf("simulator exits with the command's exit status when it ends.\n\n");
+    printf("Example:\n");
+    printf("  %s -- ./client/proxmark3 -p %%p -c \"hf mf chk --1k\"\n", name);
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+
+    int port = 0;
+    bool use_pty = false;
+    const char *dumpfn = NULL;
+    const char *tracefn = NULL;
+    uint8_t uid[4] = { 0x11, 0x22, 0x33, 0x44 };
+
+    memset(&g_vpm3, 0, sizeof(g_vpm3));
+    g_vpm3.sectors = 16;
+    g_vpm3.lfconfig = (sample_config) {
+        .decimation = 1, .bits_per_sample = 8, .averaging = 1, .divisor = 95,
+        .trigger_threshold = 0, .samples_to_skip = 0, .verbose = false,
+    };
+    memset(g_vpm3.bigbuf, 128, sizeof(g_vpm3.bigbuf));
+
+    int opt;
+    while ((opt = getopt(argc, argv, "t:pu:c:d:b:l:a:vh")) != -1) {
+        switch (opt) {
+            case 't':
+                port = atoi(optarg);
+                break;
+            case 'p':
+                use_pty = true;
+                break;
+            case 'u': {
+                uint32_t v;
+                if (strlen(optarg) != 8 || sscanf(optarg, "%08x", &v) != 1) {
+                    print_help_and_exit(argv[0]);
+                }
+                num_to_bytes(v, 4, uid);
+                break;
+            }
+            case 'c':
+                if (strcmp(optarg, "mini") == 0) {
+                    g_vpm3.sectors = 5;
+                } else if (strcmp(optarg, "1k") == 0) {
+                    g_vpm3.sectors = 16;
+                } else if (strcmp(optarg, "2k") == 0) {
+                    g_vpm3.sectors = 32;
+                } else if (strcmp(optarg, "4k") == 0) {
+                    g_vpm3.sectors = 40;
+                } else {
+                    print_help_and_exit(argv[0]);
+                }
+                break;
+            case 'd':
+                dumpfn = optarg;
+                break;
+            case 'b':
+                tracefn = optarg;
+                break;
+            case 'l':
+                g_vpm3.cmd_delay_us = strtoul(optarg, NULL, 0);
+                break;
+            case 'a':
+                g_vpm3.auth_delay_us = strtoul(optarg, NULL, 0);
+                break;
+            case 'v':
+                g_vpm3.verbose = true;
+                break;
+            default:
+                print_help_and_exit(argv[0]);
+        }
+    }
+
+    card_default(uid);
+    eml_clear();
+    if (dumpfn && card_load(dumpfn) != PM3_SUCCESS) {
+        exit(1);
+    }
+    if (tracefn && bigbuf_load(tracefn) != PM3_SUCCESS) {
+        exit(1);
+    }
+
+    char dev[64];
+    int lfd, slave = -1;
+    if (use_pty) {
+        lfd = open_pty(dev, sizeof(dev), &slave);
+    } else {
+        lfd = open_tcp(port, dev, sizeof(dev));
+    }
+    if (lfd < 0) {
+        printf("[!] can't open %s: %s\n", use_pty ? "pty" : "tcp port", strerror(errno));
+        exit(1);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    printf("[=] virtual pm3 on %s, MIFARE Classic %u sectors, UID %02X%02X%02X%02X\n", dev, g_vpm3.sectors,
+           g_vpm3.sel.uid[0], g_vpm3.sel.uid[1], g_vpm3.sel.uid[2], g_vpm3.sel.uid[3]);
+    fflush(stdout);
+
+    pid_t child = -1;
+    if (optind < argc) {
+        child = spawn(argv + optind, dev);
+        if (child < 0) {
+            printf("[!] fork failed: %s\n", strerror(errno));
+            exit(1);
+        }
+    }
+
+    int status = 0;
+    while (g_stop == 0) {
+
+        if (child > 0 && waitpid(child, &status, WNOHANG) == child) {
+            break;
+        }
+
+        struct pollfd pfd = { .fd = lfd, .events = POLLIN };
+        if (poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+
+        if (use_pty) {
+            g_conn = lfd;
+            PacketCommandNG rx;
+            if (receive_ng(&rx) == PM3_SUCCESS) {
+                packet_received(&rx);
+            }
+            continue;
+        }
+
+        g_conn = accept(lfd, NULL, NULL);
+        if (g_conn < 0) {
+            continue;
+        }
+        int one = 1;
+        setsockopt(g_conn, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        serve_connection();
+        close(g_conn);
+        g_conn = -1;
+    }
+
+    if (g_vpm3.verbose) {
+        printf("[=] frames in %" PRIu64 " out %" PRIu64 ", bytes in %" PRIu64 " out %" PRIu64 ", auths %" PRIu64 "\n",
+               g_vpm3.frames_in, g_vpm3.frames_out, g_vpm3.bytes_in, g_vpm3.bytes_out, g_vpm3.auths);
+    }
+
+    close(lfd);
+    if (slave >= 0) {
+        close(slave);
+    }
+
+    if (child > 0) {
+        if (g_stop) {
+            kill(child, SIGTERM);
+            waitpid(child, &status, 0);
+        }
+        return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+    }
+    return 0;
+}
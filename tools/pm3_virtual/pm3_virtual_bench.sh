@@ -0,0 +1,138 @@
+#!/usr/bin/env bash
+
+# Host side benchmarks of the client against the virtual Proxmark3.
+#
+# Every figure is taken from whole client sessions, so process start,
+# connection setup and the handshake are removed by subtracting a session
+# that does the least possible work.
+#
+# Usage: pm3_virtual_bench.sh [-n runs] [-p] [-l us] [-a us] [--clientbin /path/to/proxmark3]
+#    -n runs      runs per measure, the median is reported (default 5)
+#    -p           use a pty instead of tcp
+#    -l us        simulated latency for every command
+#    -a us        simulated cost of every MIFARE authentication
+
+LANG=C.UTF-8
+
+PM3PATH="$(dirname "$0")/../.."
+cd "$PM3PATH" || exit 1
+
+CLIENTBIN=./client/proxmark3
+VPM3BIN=./tools/pm3_virtual/pm3_virtual
+RUNS=5
+VPM3OPTS=""
+
+while (( "$#" )); do
+  case "$1" in
+    -h|--help)
+      sed -n '3,14p' "$0" | sed 's/^# \{0,1\}//'
+      exit 0
+      ;;
+    -n)
+      RUNS=$2
+      shift 2
+      ;;
+    -p)
+      VPM3OPTS="$VPM3OPTS -p"
+      shift
+      ;;
+    -l|-a)
+      VPM3OPTS="$VPM3OPTS $1 $2"
+      shift 2
+      ;;
+    --clientbin)
+      CLIENTBIN=$2
+      shift 2
+      ;;
+    *)
+      echo "Error: unsupported argument $1" >&2
+      exit 1
+      ;;
+  esac
+done
+
+for bin in "$CLIENTBIN" "$VPM3BIN"; do
+  if [ ! -x "$bin" ]; then
+    echo "Error: $bin not found, build it first" >&2
+    exit 1
+  fi
+done
+
+TMPDIR=$(mktemp -d)
+trap 'rm -rf "$TMPDIR"' EXIT
+KEYFILE="$TMPDIR/keys.bin"
+
+# repeat <n> <command>, joined into one client script line
+function repeat() {
+  local s="$2"
+  for ((i = 1; i < $1; i++)); do s="$s; $2"; done
+  echo "$s"
+}
+
+# session <commands> -> wall time of a whole client session, ns
+function session() {
+  local t0 t1
+  t0=$(date +%s%N)
+  # shellcheck disable=SC2086
+  if ! $VPM3BIN $VPM3OPTS -- "$CLIENTBIN" -p %p -c "$1" > "$TMPDIR/out.txt" 2>&1; then
+    echo "Error: session failed: $1" >&2
+    tail -5 "$TMPDIR/out.txt" >&2
+    exit 1
+  fi
+  t1=$(date +%s%N)
+  echo $((t1 - t0))
+}
+
+# median of <runs> sessions, ns
+function measure() {
+  local v=()
+  for ((r = 0; r < RUNS; r++)); do
+    v+=("$(session "$1")")
+  done
+  printf "%s\n" "${v[@]}" | sort -n | sed -n "$(( (RUNS + 1) / 2 ))p"
+}
+
+function row() {
+  printf "  %-30s %14s %s\n" "$1" "$2" "$3"
+}
+
+PINGS=50
+SAMPLES=40000
+DOWNLOADS=10
+
+echo "virtual pm3 bench, $RUNS runs per measure, median  ( ${VPM3OPTS:-tcp, no added latency} )"
+echo
+
+BASE=$(measure "hw ping")
+PING=$(measure "$(repeat $((PINGS + 1)) "hw ping")")
+PING512=$(measure "$(repeat $((PINGS + 1)) "hw ping -l 512")")
+DL=$(measure "$(repeat $DOWNLOADS "data samples -n $SAMPLES")")
+
+# key file for the dump, written by chk --dump
+session "hf mf chk --1k -f mfc_default_keys --dump" > /dev/null
+KEYSRC=$(sed -n 's/.*keys have been dumped to `\([^`]*\)`.*/\1/p' "$TMPDIR/out.txt" | tail -1)
+if [ -z "$KEYSRC" ] || [ ! -f "$KEYSRC" ]; then
+  echo "Error: hf mf chk did not write a key file" >&2
+  exit 1
+fi
+mv "$KEYSRC" "$KEYFILE"
+
+CHK=$(measure "hf mf chk --1k -f mfc_default_keys")
+FCHK=$(measure "hf mf fchk --1k -f mfc_default_keys")
+DUMP=$(measure "hf mf dump --1k -k $KEYFILE --ns")
+FASTDUMP=$(measure "hf mf dump --1k -k $KEYFILE --ns --fast")
+
+echo "  -------------------------------+---------------+-----------------"
+row "session, connect + hw ping" "$((BASE / 1000000)) ms"
+row "hw ping round trip" "$(( (PING - BASE) / PINGS / 1000 )) us"
+row "hw ping -l 512 round trip" "$(( (PING512 - BASE) / PINGS / 1000 )) us"
+DLUS=$(( (DL - BASE) / 1000 ))
+if [ $DLUS -le 0 ]; then DLUS=1; fi
+row "data samples -n $SAMPLES" "$(( DLUS / DOWNLOADS / 1000 )) ms" "$(( SAMPLES * DOWNLOADS * 1000 / DLUS )) kB/s"
+row "hf mf chk --1k, dictionary" "$(( (CHK - BASE) / 1000000 )) ms"
+row "hf mf fchk --1k, dictionary" "$(( (FCHK - BASE) / 1000000 )) ms"
+row "hf mf dump --1k" "$(( (DUMP - BASE) / 1000000 )) ms"
+FASTUS=$(( (FASTDUMP - BASE) / 1000 ))
+if [ $FASTUS -le 0 ]; then FASTUS=1; fi
+row "hf mf dump --1k --fast" "$(( FASTUS / 1000 )) ms" "$(( 64 * 1000000 / FASTUS )) blocks/s"
+echo "  -------------------------------+---------------+-----------------"